@@ -154,6 +154,9 @@ typedef struct xqc_demo_svr_env_config_s {
     /* key export */
     int     key_output_flag;
     char    key_out_path[PATH_LEN];
+
+    /* interval of printing engine perf stats in seconds, 0 for disable */
+    int     perf_stats_interval;
 } xqc_demo_svr_env_config_t;
 
 
@@ -194,6 +197,10 @@ typedef struct xqc_demo_svr_ctx_s {
     int                 log_fd;
     int                 keylog_fd;
 
+    /* periodical print of engine perf stats */
+    struct event            *ev_perf_stats;
+    xqc_engine_perf_stats_t  last_perf_stats;
+
     xqc_demo_svr_args_t *args;
 } xqc_demo_svr_ctx_t;
 
@@ -1206,6 +1213,50 @@ xqc_demo_svr_engine_callback(int fd, short what, void *arg)
     xqc_engine_main_logic(ctx->engine);
 }
 
+/* average ticks per operation, 0 if no operation */
+#define xqc_demo_svr_perf_avg(ticks, cnt) ((cnt) > 0 ? (ticks) / (cnt) : 0)
+
+static void
+xqc_demo_svr_perf_stats_callback(int fd, short what, void *arg)
+{
+    xqc_demo_svr_ctx_t *ctx = (xqc_demo_svr_ctx_t *) arg;
+    xqc_engine_perf_stats_t cur, *last = &ctx->last_perf_stats;
+    uint64_t intvl = ctx->args->env_cfg.perf_stats_interval;
+
+    xqc_engine_get_perf_stats(ctx->engine, &cur);
+
+    printf("[perf] recv:%"PRIu64" pkt/s %"PRIu64" B/s|send:%"PRIu64" pkt/s %"PRIu64" B/s|"
+           "conns:+%"PRIu64" -%"PRIu64"|main_logic:%"PRIu64"/s|timers:%"PRIu64"/s|"
+           "sched:%"PRIu64"/s|po_alloc:%"PRIu64" po_reuse:%"PRIu64"|\n",
+           (cur.datagrams_recv - last->datagrams_recv) / intvl,
+           (cur.bytes_recv - last->bytes_recv) / intvl,
+           (cur.datagrams_sent - last->datagrams_sent) / intvl,
+           (cur.bytes_sent - last->bytes_sent) / intvl,
+           cur.conns_created - last->conns_created,
+           cur.conns_destroyed - last->conns_destroyed,
+           (cur.main_logic_calls - last->main_logic_calls) / intvl,
+           (cur.timer_fires - last->timer_fires) / intvl,
+           (cur.scheduler_calls - last->scheduler_calls) / intvl,
+           cur.packet_out_allocs - last->packet_out_allocs,
+           cur.packet_out_reuses - last->packet_out_reuses);
+
+    printf("[perf] ticks/op|encrypt:%"PRIu64"|decrypt:%"PRIu64"|ack:%"PRIu64"|"
+           "fec_enc:%"PRIu64"|fec_dec:%"PRIu64"|fec_recovered:%"PRIu64"|\n",
+           xqc_demo_svr_perf_avg(cur.encrypt_ticks - last->encrypt_ticks,
+                                 cur.packets_encrypted - last->packets_encrypted),
+           xqc_demo_svr_perf_avg(cur.decrypt_ticks - last->decrypt_ticks,
+                                 cur.packets_decrypted - last->packets_decrypted),
+           xqc_demo_svr_perf_avg(cur.ack_process_ticks - last->ack_process_ticks,
+                                 cur.acks_processed - last->acks_processed),
+           xqc_demo_svr_perf_avg(cur.fec_encode_ticks - last->fec_encode_ticks,
+                                 cur.fec_encodes - last->fec_encodes),
+           xqc_demo_svr_perf_avg(cur.fec_decode_ticks - last->fec_decode_ticks,
+                                 cur.fec_decodes - last->fec_decodes),
+           cur.fec_recovered_packets - last->fec_recovered_packets);
+
+    *last = cur;
+}
+
 
 void
 xqc_demo_svr_usage(int argc, char *argv[])
@@ -1235,6 +1286,7 @@ xqc_demo_svr_usage(int argc, char *argv[])
             "   -R    Reinjection (1,2,4) \n"
             "   -u    Keyupdate packet threshold\n"
             "   -F    MTU size (default: 1200)\n"
+            "   -S    Interval of printing engine perf stats in seconds, 0 for disable (default: 10)\n"
             , prog);
 }
 
@@ -1274,13 +1326,14 @@ xqc_demo_svr_init_args(xqc_demo_svr_args_t *args)
     args->quic_cfg.keyupdate_pkt_threshold = UINT64_MAX;
     args->quic_cfg.least_available_cid_count = 1;
     args->quic_cfg.max_pkt_sz = 1200;
+    args->env_cfg.perf_stats_interval = 10;
 }
 
 void
 xqc_demo_svr_parse_args(int argc, char *argv[], xqc_demo_svr_args_t *args)
 {
     int ch = 0;
-    while ((ch = getopt(argc, argv, "p:c:CD:l:L:6k:rdMiPs:R:u:a:F:f:")) != -1) {
+    while ((ch = getopt(argc, argv, "p:c:CD:l:L:6k:rdMiPs:R:u:a:F:f:S:")) != -1) {
         switch (ch) {
         /* listen port */
         case 'p':
@@ -1403,6 +1456,11 @@ xqc_demo_svr_parse_args(int argc, char *argv[], xqc_demo_svr_args_t *args)
             args->quic_cfg.max_initial_paths = atoi(optarg);
             break;
 
+        case 'S':
+            printf("option perf stats interval: %s\n", optarg);
+            args->env_cfg.perf_stats_interval = atoi(optarg);
+            break;
+
         default:
             printf("other option :%c\n", ch);
             xqc_demo_svr_usage(argc, argv);
@@ -1722,6 +1780,13 @@ main(int argc, char *argv[])
         xqc_demo_svr_socket_event_callback, ctx);
     event_add(ctx->ev_socket6, NULL);
 
+    /* perf stats event */
+    if (args->env_cfg.perf_stats_interval > 0) {
+        struct timeval tv = {.tv_sec = args->env_cfg.perf_stats_interval, .tv_usec = 0};
+        ctx->ev_perf_stats = event_new(eb, -1, EV_PERSIST, xqc_demo_svr_perf_stats_callback, ctx);
+        event_add(ctx->ev_perf_stats, &tv);
+    }
+
     event_base_dispatch(eb);
 
     xqc_engine_destroy(ctx->engine);
@@ -279,6 +279,13 @@ typedef struct xqc_h3_conn_settings_s {
     /** MAX_BLOCKED_STREAMS */
     uint64_t qpack_blocked_streams;
 
+    /**
+     * frequency threshold of qpack dynamic table insertion. field lines are inserted into dynamic
+     * table only if they are seen at least qpack_insert_threshold times recently, which keeps
+     * frequent entries from being evicted by those seen once. 0 for inserting every field line.
+     */
+    uint32_t qpack_insert_threshold;
+
 #ifdef XQC_COMPAT_DUPLICATE
     /** compat with the original qpack encoder's duplicate strategy */
     xqc_bool_t  qpack_compat_duplicate;
@@ -526,6 +533,17 @@ void xqc_h3_engine_set_max_field_section_size(xqc_engine_t *engine, size_t size)
 XQC_EXPORT_PUBLIC_API
 void xqc_h3_engine_set_qpack_blocked_streams(xqc_engine_t *engine, size_t value);
 
+/**
+ * @brief set the frequency threshold of qpack dynamic table insertion, see
+ *        qpack_insert_threshold in xqc_h3_conn_settings_t.
+ *        It MUST only be called after xqc_h3_ctx_init.
+ *
+ * @param engine the engine handler created by xqc_engine_create
+ * @param threshold min count of recent occurrences before a field line is inserted, 0 for none
+ */
+XQC_EXPORT_PUBLIC_API
+void xqc_h3_engine_set_qpack_insert_threshold(xqc_engine_t *engine, uint32_t threshold);
+
 #ifdef XQC_COMPAT_DUPLICATE
 /**
  * @brief It MUST only be called after xqc_h3_ctx_init.
@@ -758,6 +776,38 @@ XQC_EXPORT_PUBLIC_API
 ssize_t xqc_h3_request_send_headers(xqc_h3_request_t *h3_request, xqc_http_headers_t *headers,
     uint8_t fin);
 
+/**
+ * @brief create a header template from a set of headers which are repeated across responses or
+ * requests, e.g. content-type, server, cache-control. the static table and literal parts of the
+ * template are encoded only once, and copied to the HEADERS frame with each request.
+ *
+ * @param headers headers of template, copied into the template, pseudo headers are put first
+ * @return handler of header template, NULL for error
+ */
+XQC_EXPORT_PUBLIC_API
+xqc_h3_hdr_tmpl_t *xqc_h3_hdr_tmpl_create(xqc_http_headers_t *headers);
+
+/**
+ * @brief destroy a header template. the template MUST NOT be in use by any request.
+ */
+XQC_EXPORT_PUBLIC_API
+void xqc_h3_hdr_tmpl_destroy(xqc_h3_hdr_tmpl_t *tmpl);
+
+/**
+ * @brief send http headers to peer with a header template. the HEADERS frame contains the pseudo
+ * headers in headers, followed by field lines of template and other field lines in headers. a
+ * template might be shared by requests of different connections.
+ *
+ * @param h3_request handler of http3 request
+ * @param tmpl header template created by xqc_h3_hdr_tmpl_create
+ * @param headers per-request headers, NULL if all field lines are from template
+ * @param fin request finish flag, 1 for finish. if set here, it means request has no body
+ * @return > 0 for Bytes sent，-XQC_EAGAIN try next time, < 0 for error, 0 for request finished
+ */
+XQC_EXPORT_PUBLIC_API
+ssize_t xqc_h3_request_send_headers_tmpl(xqc_h3_request_t *h3_request, xqc_h3_hdr_tmpl_t *tmpl,
+    xqc_http_headers_t *headers, uint8_t fin);
+
 /**
  * @brief send http body to peer
  * 
@@ -839,6 +889,19 @@ XQC_EXPORT_PUBLIC_API
 xqc_int_t xqc_h3_request_set_priority(xqc_h3_request_t *h3r,
     xqc_h3_priority_t *prio);
 
+/**
+ * @brief reprioritize a request with urgency and incremental after it was created.
+ * the local write scheduler is updated immediately, and a client will also send
+ * PRIORITY_UPDATE frame to server on control stream.
+ *
+ * @param h3r handler of http3 request
+ * @param prio new priority, only urgency and incremental are used
+ * @return XQC_OK for success, others for failure
+ */
+XQC_EXPORT_PUBLIC_API
+xqc_int_t xqc_h3_request_update_priority(xqc_h3_request_t *h3r,
+    xqc_h3_priority_t *prio);
+
 /****************************/
 /* New APIs for extended H3 */
 /****************************/
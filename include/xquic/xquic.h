@@ -85,6 +85,20 @@ extern "C"
 
 #define XQC_FEC_MAX_SCHEME_NUM 5
 
+/* max count of per-connection log override rules, see xqc_engine_add_log_override */
+#define XQC_LOG_OVERRIDE_MAX 8
+
+/* max count of session ticket keys kept by server, the current one and the previous ones */
+#define XQC_SESSION_TICKET_KEY_MAX 4
+
+/* max length of session ticket or transport parameters cached in session store */
+#define XQC_SESSION_STORE_DATA_MAX_LEN 16384
+
+/**
+ * size of each record of binary event log, see xqc_engine_enable_binlog
+ */
+#define XQC_BINLOG_RECORD_SIZE 64
+
     /**
      * @brief get timestamp callback function. this might be useful on different platforms
      * @return timestamp in microsecond
@@ -477,6 +491,48 @@ extern "C"
                                            const struct sockaddr *peer_addr, socklen_t peer_addrlen,
                                            void *conn_user_data);
 
+    /**
+     * @brief multi-path write socket callback function with release time, for earliest departure
+     * time pacing. the implementation shall hand txtime to socket layer, e.g. with SO_TXTIME and
+     * SCM_TXTIME on linux, and the packet shall not leave the host before txtime
+     *
+     * @param txtime release time of packet, in microseconds of the clock of xqc_monotonic_timestamp,
+     * which shall be converted to the clock of socket by implementation. 0 for sending immediately
+     * @return same as xqc_socket_write_ex_pt
+     */
+    typedef ssize_t (*xqc_socket_write_txtime_pt)(uint64_t path_id,
+                                                  const unsigned char *buf, size_t size,
+                                                  const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+                                                  xqc_usec_t txtime, void *conn_user_data);
+
+    /**
+     * @brief multi-path write socket callback function with sendmmsg and release times, messages
+     * are sorted by release time
+     *
+     * @param txtimes release time of each message, see xqc_socket_write_txtime_pt
+     * @return same as xqc_send_mmsg_ex_pt
+     */
+    typedef ssize_t (*xqc_send_mmsg_txtime_pt)(uint64_t path_id,
+                                               const struct iovec *msg_iov, const xqc_usec_t *txtimes,
+                                               unsigned int vlen,
+                                               const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+                                               void *conn_user_data);
+
+    /**
+     * @brief multi-path write socket callback function with ECN codepoint, the implementation
+     * shall set the ECN field of IP header, e.g. with IP_TOS or IPV6_TCLASS on linux
+     *
+     * @param ecn ECN codepoint of packet, see xqc_ecn_codepoint_t
+     * @param txtime release time of packet, see xqc_socket_write_txtime_pt. as all packets are sent
+     * with this callback once ECN is on, it carries the release times of earliest departure time
+     * pacing too. always 0 unless write_socket_txtime or write_mmsg_txtime is set
+     * @return same as xqc_socket_write_ex_pt
+     */
+    typedef ssize_t (*xqc_socket_write_ecn_pt)(uint64_t path_id,
+                                               const unsigned char *buf, size_t size,
+                                               const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+                                               uint8_t ecn, xqc_usec_t txtime, void *conn_user_data);
+
     /**
      * @brief general callback function definition for stream create, close, read and write.
      *
@@ -631,6 +687,27 @@ extern "C"
          */
         xqc_send_mmsg_ex_pt write_mmsg_ex;
 
+        /**
+         * write socket callback with release time, ALTERNATIVE with write_socket and write_socket_ex.
+         * if set, packets paced in XQC_PACING_MODE_EDT are handed to socket ahead of their release
+         * time, and the socket layer is responsible for holding them until then
+         */
+        xqc_socket_write_txtime_pt write_socket_txtime;
+
+        /**
+         * write socket with send_mmsg callback and release times, ALTERNATIVE with write_mmsg and
+         * write_mmsg_ex
+         */
+        xqc_send_mmsg_txtime_pt write_mmsg_txtime;
+
+        /**
+         * write socket callback with ECN codepoint, ALTERNATIVE with write_socket and
+         * write_socket_ex. MUST be set if ecn_on is set in conn settings, packets are sent one by
+         * one with it, and write_mmsg series will not be used. it takes the place of
+         * write_socket_txtime, and is handed the release times if write_socket_txtime is set
+         */
+        xqc_socket_write_ecn_pt write_socket_ecn;
+
         /**
          * QUIC connection cid update callback, REQUIRED for both server and client
          */
@@ -850,6 +927,19 @@ extern "C"
         XQC_DATA_QOS_PROBING = 7,
     } xqc_data_qos_level_t;
 
+    /**
+     * @brief window coupling algorithm of xqc_coupled_cb
+     */
+    typedef enum xqc_coupled_algo_e
+    {
+        /** Linked Increases Algorithm, RFC 6356 */
+        XQC_COUPLED_LIA = 0,
+        /** Opportunistic Linked Increases Algorithm */
+        XQC_COUPLED_OLIA = 1,
+        /** Balanced Linked Adaptation */
+        XQC_COUPLED_BALIA = 2,
+    } xqc_coupled_algo_t;
+
     /**
      * @brief congestion control algorithm parameters
      */
@@ -872,6 +962,10 @@ extern "C"
          * when Copa competes with loss-based CCAs.
          */
         double copa_delta_ai_unit;
+        /** window coupling of xqc_coupled_cb among paths, default XQC_COUPLED_LIA */
+        xqc_coupled_algo_t coupled_algo;
+        /** exit slow start of cubic and reno with HyStart++ (RFC 9406) before loss, default off */
+        uint8_t hystart_enable;
     } xqc_cc_params_t;
 
     /**
@@ -896,6 +990,8 @@ extern "C"
         XQC_XOR_CODE = 11,
         XQC_PACKET_MASK_CODE = 12,
         XQC_RAPTORQ_CODE = 13,
+        XQC_RLC_CODE = 14,
+        XQC_REED_SOLOMON_16_CODE = 15,
     } xqc_fec_schemes_e;
 
     typedef enum
@@ -990,6 +1086,15 @@ extern "C"
         uint32_t (*xqc_cong_ctl_get_bandwidth_estimate)(void *cong_ctl);
 
         xqc_bbr_info_interface_t *xqc_cong_ctl_info_cb;
+
+        /**
+         * Callback when the CE count reported by peer increases, with the sent time of the largest
+         * newly acknowledged packet, and ce_delta of the acked_delta ECN-capable packets newly
+         * reported by peer are marked CE. OPTIONAL, xqc_cong_ctl_on_lost is called instead if not
+         * set, which reduces the window once per round trip like a loss (RFC 9002 Section 7.1)
+         */
+        void (*xqc_cong_ctl_on_ecn_ce)(void *cong_ctl, xqc_usec_t largest_acked_sent_time,
+                                       uint64_t ce_delta, uint64_t acked_delta);
     } xqc_cong_ctrl_callback_t;
 
 #ifdef XQC_ENABLE_RENO
@@ -1000,6 +1105,10 @@ extern "C"
 #endif
     XQC_EXPORT_PUBLIC_API XQC_EXTERN const xqc_cong_ctrl_callback_t xqc_bbr_cb;
     XQC_EXPORT_PUBLIC_API XQC_EXTERN const xqc_cong_ctrl_callback_t xqc_cubic_cb;
+    /** coupled congestion control for multipath, see xqc_cc_params_t.coupled_algo */
+    XQC_EXPORT_PUBLIC_API XQC_EXTERN const xqc_cong_ctrl_callback_t xqc_coupled_cb;
+    /** L4S scalable congestion control, falls back to cubic until ECN is validated, see ecn_l4s */
+    XQC_EXPORT_PUBLIC_API XQC_EXTERN const xqc_cong_ctrl_callback_t xqc_prague_cb;
 #ifdef XQC_ENABLE_UNLIMITED
     XQC_EXPORT_PUBLIC_API XQC_EXTERN const xqc_cong_ctrl_callback_t xqc_unlimited_cc_cb;
 #endif
@@ -1090,6 +1199,8 @@ extern "C"
     XQC_EXPORT_PUBLIC_API extern const xqc_fec_code_callback_t xqc_reed_solomon_code_cb;
     XQC_EXPORT_PUBLIC_API extern const xqc_fec_code_callback_t xqc_packet_mask_code_cb;
     XQC_EXPORT_PUBLIC_API extern const xqc_fec_code_callback_t xqc_fountain_code_cb;
+    XQC_EXPORT_PUBLIC_API extern const xqc_fec_code_callback_t xqc_rlc_code_cb;
+    XQC_EXPORT_PUBLIC_API extern const xqc_fec_code_callback_t xqc_reed_solomon16_code_cb;
 
     /**
      * @struct xqc_config_t
@@ -1118,7 +1229,10 @@ extern "C"
         /** bucket size of stream hash table in xqc_connection_t */
         size_t streams_hash_bucket_size;
 
-        /** bucket size of connection hash table in engine */
+        /**
+         * initial capacity of connection hash table in engine. the table grows incrementally when
+         * necessary, and the initial capacity is limited to 65536
+         */
         size_t conns_hash_bucket_size;
 
         /** capacity of connection priority queue in engine */
@@ -1170,10 +1284,176 @@ extern "C"
          */
         uint8_t manually_triggered_send;
 
-        /** for warning when the number of elements in one bucket exceeds the value of hash_conflict_threshold*/
+        /** for warning when the probed slots of inserting a connection id exceeds the value of hash_conflict_threshold*/
         uint32_t hash_conflict_threshold;
+
+        /**
+         * max count of destroyed connections whose memory is kept by engine for new connections,
+         * which saves the allocation of xqc_connection_t and its memory pool during bursts of
+         * handshakes. 0 for disable
+         */
+        uint32_t conn_cache_size;
+
+        /**
+         * count of SSL objects created in advance, which are taken by new connections instead of
+         * creating one during handshake. the pool is refilled in xqc_engine_main_logic. 0 for
+         * disable
+         */
+        uint32_t ssl_prewarm_cnt;
     } xqc_config_t;
 
+    /**
+     * @brief engine-wide performance counters, see xqc_engine_get_perf_stats. counters are
+     * cumulative since engine creation, rates shall be calculated by the difference of snapshots
+     */
+    typedef struct xqc_engine_perf_stats_s {
+        /** udp datagrams and bytes passed to xqc_engine_packet_process */
+        uint64_t    datagrams_recv;
+        uint64_t    bytes_recv;
+
+        /** udp datagrams and bytes written with write_socket or write_mmsg callbacks */
+        uint64_t    datagrams_sent;
+        uint64_t    bytes_sent;
+
+        /** quic packets protected and unprotected successfully */
+        uint64_t    packets_encrypted;
+        uint64_t    packets_decrypted;
+
+        /** ack frames processed */
+        uint64_t    acks_processed;
+
+        /** invocations of multipath scheduler */
+        uint64_t    scheduler_calls;
+
+        /** connection and path timers fired, and invocations of xqc_engine_main_logic */
+        uint64_t    timer_fires;
+        uint64_t    main_logic_calls;
+
+        /** packet_out allocated from heap, and reused from free list of send queue */
+        uint64_t    packet_out_allocs;
+        uint64_t    packet_out_reuses;
+
+        uint64_t    conns_created;
+        uint64_t    conns_destroyed;
+
+        /** connections created with memory kept from destroyed ones, see conn_cache_size */
+        uint64_t    conns_reused;
+
+        /** successful fec encode and decode calls, and packets recovered by fec */
+        uint64_t    fec_encodes;
+        uint64_t    fec_decodes;
+        uint64_t    fec_recovered_packets;
+
+        /** handshakes completed, and those resumed with session ticket */
+        uint64_t    handshakes_completed;
+        uint64_t    handshakes_resumed;
+
+        /** 0-RTT accepted and rejected */
+        uint64_t    early_data_accepted;
+        uint64_t    early_data_rejected;
+
+        /** session store lookups of client in xqc_connect, and those found a session ticket */
+        uint64_t    session_store_lookups;
+        uint64_t    session_store_hits;
+
+        /** SSL objects taken from the pre-warmed pool, see ssl_prewarm_cnt */
+        uint64_t    ssl_prewarm_hits;
+
+        /**
+         * time spent in stages, which are 0 unless xquic is built with XQC_ENABLE_PERF_TIMING.
+         * in cpu cycles on x86-64, virtual counter ticks on aarch64 and nanoseconds elsewhere
+         */
+        uint64_t    encrypt_ticks;
+        uint64_t    decrypt_ticks;
+        uint64_t    ack_process_ticks;
+        uint64_t    fec_encode_ticks;
+        uint64_t    fec_decode_ticks;
+
+        /**
+         * handshake phases: creation of xqc_connection_t, creation of tls instance, tls init which
+         * derives initial keys (and generates ClientHello on client), and processing of crypto data
+         */
+        uint64_t    conn_create_ticks;
+        uint64_t    tls_create_ticks;
+        uint64_t    tls_init_ticks;
+        uint64_t    tls_process_ticks;
+    } xqc_engine_perf_stats_t;
+
+    /**
+     * @brief per-connection log override rule, see xqc_engine_add_log_override. connections
+     * selected by a rule use log_level and qlog_importance of the rule instead of the ones of
+     * engine, others are not affected
+     */
+    typedef struct xqc_log_override_s {
+        /**
+         * select connections whose peer address is in the prefix of peer_addr with prefix_len
+         * bits. NULL for any peer
+         */
+        const struct sockaddr  *peer_addr;
+        socklen_t               peer_addrlen;
+        uint8_t                 prefix_len;
+
+        /**
+         * select 1 of every sample_rate connections which match peer_addr, e.g. 10000 for
+         * sampling 1 of every 10000 connections. 0 or 1 for all of them
+         */
+        uint32_t                sample_rate;
+
+        /** log level of selected connections */
+        xqc_log_level_t         log_level;
+
+        /** qlog event importance of selected connections, qlog events are enabled with it */
+        qlog_event_importance_t qlog_importance;
+    } xqc_log_override_t;
+
+    typedef enum xqc_session_data_type_e {
+        /** session ticket, the same as the one passed to save_session_cb */
+        XQC_SESSION_DATA_TICKET     = 0,
+
+        /** transport parameters of server, the same as the one passed to save_tp_cb */
+        XQC_SESSION_DATA_TP         = 1,
+
+        XQC_SESSION_DATA_TYPE_MAX,
+    } xqc_session_data_type_t;
+
+    /**
+     * @brief session store of client, see xqc_engine_set_session_store. when xqc_connect is
+     * called without session_ticket_data, session ticket and transport parameters are looked
+     * up with server_host and alpn, and new ones received from server are put into the store.
+     * callbacks might be invoked by engines on different threads if the store is shared
+     */
+    typedef struct xqc_session_store_callbacks_s {
+        /**
+         * copy data of key to buf. a session ticket SHOULD be handed out only once and removed
+         * from the store then, as connections resumed with the same ticket could be linked by
+         * observers, see RFC 8446 appendix C.4
+         * @return length of data, 0 if not found or buf_cap is not enough
+         */
+        size_t (*get)(void *store, const char *key, size_t key_len,
+            xqc_session_data_type_t type, char *buf, size_t buf_cap);
+
+        /**
+         * replace transport parameters of key, or add a session ticket of key. servers may
+         * issue several tickets, and the store could keep some of them for later connections
+         * @return XQC_OK for success, others for failure
+         */
+        xqc_int_t (*put)(void *store, const char *key, size_t key_len,
+            xqc_session_data_type_t type, const char *data, size_t data_len);
+    } xqc_session_store_callbacks_t;
+
+    /**
+     * @brief statistics of the built-in lru session store, see xqc_session_lru_get_stats
+     */
+    typedef struct xqc_session_lru_stats_s {
+        uint64_t    lookups;
+        uint64_t    hits;
+        uint64_t    inserts;
+        uint64_t    evictions;
+
+        /** count of servers cached */
+        size_t      count;
+    } xqc_session_lru_stats_t;
+
     /**
      * @brief engine callback functions.
      */
@@ -1294,6 +1574,28 @@ extern "C"
         XQC_FEC_02 = 0x02,
     } xqc_fec_version_t;
 
+    /**
+     * @brief ECN codepoints in the IP header, RFC 3168
+     */
+    typedef enum
+    {
+        XQC_ECN_NOT_ECT = 0x00,
+        XQC_ECN_ECT1    = 0x01,
+        XQC_ECN_ECT0    = 0x02,
+        XQC_ECN_CE      = 0x03,
+    } xqc_ecn_codepoint_t;
+
+    typedef enum
+    {
+        /** limit bursts with a byte budget, which is refilled by pacing rate */
+        XQC_PACING_MODE_BUDGET = 0,
+        /**
+         * earliest departure time, every packet is stamped with its release time calculated
+         * from pacing rate, and packets released within a short horizon are sent in one batch
+         */
+        XQC_PACING_MODE_EDT = 1,
+    } xqc_pacing_mode_t;
+
     /**
      * @brief structures of connection settings
      */
@@ -1504,6 +1806,39 @@ extern "C"
         uint64_t receive_timestamps_exponent;
 
         uint8_t disable_pn_skipping;
+
+        /**
+         * @brief pacing mode, takes effect if pacing is on. default: XQC_PACING_MODE_BUDGET
+         */
+        xqc_pacing_mode_t pacing_mode;
+
+        /**
+         * @brief mark packets with ECN-capable codepoint and validate the ECN counts of peer (RFC 9000 Section
+         * 13.4). packets are marked only if write_socket_ecn is set, received codepoints are
+         * counted only if they are passed in with xqc_engine_packet_process_ecn. default: 0, off
+         */
+        uint8_t ecn_on;
+
+        /**
+         * @brief mark packets with ECT(1) instead of ECT(0) if ecn_on is set, which identifies
+         * L4S traffic (RFC 9331) and SHOULD be used only with a scalable congestion controller,
+         * e.g. xqc_prague_cb. default: 0, ECT(0)
+         */
+        uint8_t ecn_l4s;
+
+        /**
+         * @brief min_ack_delay transport parameter in microseconds (draft-ietf-quic-ack-frequency),
+         * the advertisement of which allows the peer to change the ack rate of this endpoint with
+         * ACK_FREQUENCY frames. MUST NOT be larger than max_ack_delay. default: 0, not supported
+         */
+        uint32_t min_ack_delay;
+
+        /**
+         * @brief ask the peer to acknowledge about 4 times per round trip with ACK_FREQUENCY frames
+         * when the congestion window allows, which cuts the ACK processing cost of bulk transfers.
+         * takes effect only if the peer advertised min_ack_delay. default: 0, off
+         */
+        uint8_t ack_frequency_on;
     } xqc_conn_settings_t;
 
     typedef enum
@@ -1611,6 +1946,34 @@ extern "C"
         uint64_t inflight_bytes;
     } xqc_conn_qos_stats_t;
 
+    /**
+     * @brief config of sharded engine mode. in sharded mode, a server runs one engine on each
+     * worker thread (shard), and every cid generated by an engine encodes its shard id in the
+     * layout of load balance cid: config id octet | shard id | nonce. a front dispatcher routes
+     * each received datagram to the owning shard by the dcid, hence no state is shared between
+     * shards, each shard has its own connections, timers and tables.
+     */
+    typedef struct xqc_shard_config_s
+    {
+        /** count of shards, MUST be in [1, 65535]. shard id takes 1 byte in cid if not more than
+            256 shards, 2 bytes otherwise */
+        uint32_t    shard_count;
+
+        /** max count of pending datagrams of each shard, default 4096 if 0 */
+        size_t      queue_capacity;
+
+        /** first octet of generated cids, datagrams with other first octets are routed by hash */
+        uint8_t     conf_id;
+
+        /** length of generated cids, MUST be the same as cid_len of engines. if lb_cid_enc_on is
+            set, MUST be 17, as only single-pass encryption can be decrypted by dispatcher */
+        uint8_t     cid_len;
+
+        /** encrypt shard id and nonce with lb_cid_key */
+        uint8_t     lb_cid_enc_on;
+        uint8_t     lb_cid_key[XQC_LB_CID_KEY_LEN];
+    } xqc_shard_config_t;
+
     /*************************************************************
      *  engine layer APIs
      *************************************************************/
@@ -1710,6 +2073,18 @@ extern "C"
                                         const struct sockaddr *peer_addr, socklen_t peer_addrlen,
                                         xqc_usec_t recv_time, void *user_data);
 
+    /**
+     * Pass received UDP packet payload into xquic engine, together with the ECN codepoint of the
+     * IP header, which could be retrieved with IP_RECVTOS or IPV6_RECVTCLASS on linux.
+     * @param ecn   ECN codepoint of the UDP packet, see xqc_ecn_codepoint_t
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_engine_packet_process_ecn(xqc_engine_t *engine,
+                                            const unsigned char *packet_in_buf, size_t packet_in_size,
+                                            const struct sockaddr *local_addr, socklen_t local_addrlen,
+                                            const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+                                            xqc_usec_t recv_time, uint8_t ecn, void *user_data);
+
     /**
      * @brief Process all connections, application implements MUST call this function in timer callback
      */
@@ -1754,6 +2129,101 @@ extern "C"
     XQC_EXPORT_PUBLIC_API
     void xqc_log_disable(xqc_bool_t disable);
 
+    /**
+     * @brief add a per-connection log override rule, which will take effect on new created
+     * connections. rules are matched in the order of adding, and the first matched one is used.
+     * use xqc_conn_set_log_level for connections already created
+     *
+     * @return XQC_OK for success, -XQC_ELIMIT if XQC_LOG_OVERRIDE_MAX rules are added already
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_engine_add_log_override(xqc_engine_t *engine, const xqc_log_override_t *rule);
+
+    /**
+     * @brief remove all log override rules of engine. connections already selected keep their
+     * log level
+     */
+    XQC_EXPORT_PUBLIC_API
+    void xqc_engine_clear_log_overrides(xqc_engine_t *engine);
+
+    /**
+     * @brief enable/disable binary event log of engine. when enabled, qlog events are written
+     * as fixed-layout records of XQC_BINLOG_RECORD_SIZE bytes into a lock-free ring instead of
+     * being formatted to text, records are dropped if the ring is full. events shall still be
+     * enabled with log_event and filtered with qlog_importance in xqc_config_t.
+     * @note records shall be drained with xqc_engine_read_binlog, and could be converted to
+     * text or qlog JSON with scripts/qlog_parser.py
+     *
+     * @param capacity max count of records in ring, rounded up to power of 2. 0 for disable,
+     * which shall not be called while xqc_engine_read_binlog is running
+     * @return XQC_OK for success, others for failure
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_engine_enable_binlog(xqc_engine_t *engine, size_t capacity);
+
+    /**
+     * @brief move binary event log records of engine to buf. could be called from a thread other
+     * than the one engine runs on, but not from more than one thread at the same time
+     *
+     * @param buf buffer for records
+     * @param buf_len length of buf, records are moved as a whole
+     * @return bytes of records moved, multiple of XQC_BINLOG_RECORD_SIZE
+     */
+    XQC_EXPORT_PUBLIC_API
+    size_t xqc_engine_read_binlog(xqc_engine_t *engine, uint8_t *buf, size_t buf_len);
+
+    /**
+     * @brief get a snapshot of engine-wide performance counters
+     */
+    XQC_EXPORT_PUBLIC_API
+    void xqc_engine_get_perf_stats(xqc_engine_t *engine, xqc_engine_perf_stats_t *stats);
+
+    /**
+     * @brief set session store of client engine, which takes effect on connections created
+     * later. the store shall outlive the engine
+     *
+     * @param cbs callbacks of store, NULL for disable
+     * @param store the first parameter of callbacks
+     */
+    XQC_EXPORT_PUBLIC_API
+    void xqc_engine_set_session_store(xqc_engine_t *engine,
+        const xqc_session_store_callbacks_t *cbs, void *store);
+
+    /**
+     * @brief rotate session ticket key of server engine. the new key is used to encrypt session
+     * tickets, while tickets encrypted with XQC_SESSION_TICKET_KEY_MAX - 1 previous keys are
+     * still accepted and renewed with the new key. tickets encrypted with older keys fall back
+     * to full handshake
+     *
+     * @param key_data the same format as session_ticket_key_data in xqc_engine_ssl_config_t,
+     * 48 or 80 bytes
+     * @return XQC_OK for success, -XQC_EPARAM if engine is not server or key_data is invalid
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_engine_rotate_session_ticket_key(xqc_engine_t *engine,
+        const char *key_data, size_t key_len);
+
+    /**
+     * @brief create the built-in session store, an in-memory lru cache sharded with a lock for
+     * each shard, which could be shared by engines in the same process with the callbacks from
+     * xqc_session_lru_callbacks. a few of the newest session tickets are kept for each server,
+     * and each of them is handed out only once
+     *
+     * @param shard_cnt count of shards, rounded up to power of 2
+     * @param capacity max count of servers cached, 0 for default
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_session_lru_t *xqc_session_lru_create(size_t shard_cnt, size_t capacity);
+
+    XQC_EXPORT_PUBLIC_API
+    void xqc_session_lru_destroy(xqc_session_lru_t *lru);
+
+    XQC_EXPORT_PUBLIC_API
+    const xqc_session_store_callbacks_t *xqc_session_lru_callbacks(void);
+
+    XQC_EXPORT_PUBLIC_API
+    void xqc_session_lru_get_stats(xqc_session_lru_t *lru, xqc_session_lru_stats_t *stats);
+
     /**
      * user should call after a number of packet processed in xqc_engine_packet_process
      * call after recv a batch packets, may destroy connection when error
@@ -1774,6 +2244,67 @@ extern "C"
     xqc_connection_t *xqc_engine_get_conn_by_scid(xqc_engine_t *engine,
                                                   const xqc_cid_t *cid);
 
+    /*************************************************************
+     *  sharded engine APIs
+     *************************************************************/
+
+    /**
+     * @brief create a dispatcher for sharded engine mode
+     * @return dispatcher, NULL if config is illegal or failed to allocate queues
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_shard_dispatcher_t *xqc_shard_dispatcher_create(const xqc_shard_config_t *config);
+
+    /**
+     * @brief destroy dispatcher. MUST be called after all bound engines are destroyed
+     */
+    XQC_EXPORT_PUBLIC_API
+    void xqc_shard_dispatcher_destroy(xqc_shard_dispatcher_t *dispatcher);
+
+    /**
+     * @brief bind a server engine to a shard, cids generated by engine will encode the shard id,
+     * and cid_generate_cb of engine will be ignored. MUST be called before any packet is
+     * processed by engine
+     * @return XQC_OK for success, -XQC_EPARAM if shard_id is out of range or cid_len mismatches
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_shard_dispatcher_bind_engine(xqc_shard_dispatcher_t *dispatcher,
+                                               uint32_t shard_id, xqc_engine_t *engine);
+
+    /**
+     * @brief get the shard which owns a datagram, by the shard id encoded in dcid, or by the
+     * hash of dcid if no shard id is encoded. MUST be called on the single dispatcher thread,
+     * like xqc_shard_dispatch, as encrypted cids are decrypted with the cipher context owned by
+     * dispatcher
+     * @return shard id, -XQC_EPARAM if dcid can't be parsed
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_shard_get_shard_id(xqc_shard_dispatcher_t *dispatcher,
+                                     const unsigned char *packet_in_buf, size_t packet_in_size);
+
+    /**
+     * @brief copy a received datagram into the queue of its owning shard. MUST be called on a
+     * single producer thread, like the thread reading the socket
+     * @return shard id for success, -XQC_EAGAIN if the queue is full, -XQC_EPARAM if dcid can't
+     * be parsed or datagram is too long
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_shard_dispatch(xqc_shard_dispatcher_t *dispatcher,
+                                 const unsigned char *packet_in_buf, size_t packet_in_size,
+                                 const struct sockaddr *local_addr, socklen_t local_addrlen,
+                                 const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+                                 xqc_usec_t recv_time);
+
+    /**
+     * @brief pass at most max_count queued datagrams into the engine bound to shard, and call
+     * xqc_engine_finish_recv if any was processed. MUST be called on the thread of shard
+     * @param max_count 0 for no limit
+     * @return count of datagrams processed, -XQC_EPARAM if no engine bound to shard
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_shard_process(xqc_shard_dispatcher_t *dispatcher, uint32_t shard_id,
+                                size_t max_count);
+
     /*************************************************************
      *  QUIC layer APIs
      *************************************************************/
@@ -2098,6 +2629,17 @@ extern "C"
     XQC_EXPORT_PUBLIC_API
     xqc_conn_stats_t xqc_conn_get_stats(xqc_engine_t *engine, const xqc_cid_t *cid);
 
+    /**
+     * @brief override log level and qlog event importance of a connection at runtime, e.g. for
+     * diagnosing a single client without enabling debug logs of all connections
+     *
+     * @param cid scid of connection
+     * @return XQC_OK for success, -XQC_ECONN_NFOUND if connection is not found
+     */
+    XQC_EXPORT_PUBLIC_API
+    xqc_int_t xqc_conn_set_log_level(xqc_engine_t *engine, const xqc_cid_t *cid,
+        xqc_log_level_t log_level, qlog_event_importance_t qlog_importance);
+
     /**
      * User can get xqc_conn_qos_stats_t by cid
      */
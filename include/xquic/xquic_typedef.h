@@ -64,6 +64,7 @@ typedef struct xqc_stream_s                 xqc_stream_t;
 typedef struct xqc_connection_s             xqc_connection_t;
 typedef struct xqc_conn_settings_s          xqc_conn_settings_t;
 typedef struct xqc_engine_s                 xqc_engine_t;
+typedef struct xqc_session_lru_s            xqc_session_lru_t;
 typedef struct xqc_log_callbacks_s          xqc_log_callbacks_t;
 typedef struct xqc_transport_callbacks_s    xqc_transport_callbacks_t;
 typedef struct xqc_h3_conn_callbacks_s      xqc_h3_conn_callbacks_t;
@@ -71,6 +72,8 @@ typedef struct xqc_random_generator_s       xqc_random_generator_t;
 typedef struct xqc_client_connection_s      xqc_client_connection_t;
 typedef struct xqc_id_hash_table_s          xqc_id_hash_table_t;
 typedef struct xqc_str_hash_table_s         xqc_str_hash_table_t;
+typedef struct xqc_oa_hash_table_s          xqc_oa_hash_table_t;
+typedef struct xqc_shard_dispatcher_s       xqc_shard_dispatcher_t;
 typedef struct xqc_priority_queue_s         xqc_pq_t;
 typedef struct xqc_wakeup_pq_s              xqc_wakeup_pq_t;
 typedef struct xqc_log_s                    xqc_log_t;
@@ -85,6 +88,7 @@ typedef struct xqc_h3_request_s             xqc_h3_request_t;
 typedef struct xqc_h3_conn_s                xqc_h3_conn_t;
 typedef struct xqc_h3_stream_s              xqc_h3_stream_t;
 typedef struct xqc_h3_frame_s               xqc_h3_frame_t;
+typedef struct xqc_h3_hdr_tmpl_s            xqc_h3_hdr_tmpl_t;
 typedef struct xqc_qpack_s                  xqc_qpack_t;
 typedef struct xqc_dtable_s                 xqc_dtable_t;
 typedef struct xqc_sample_s                 xqc_sample_t;
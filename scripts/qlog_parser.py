@@ -4,6 +4,7 @@ import sys
 import json
 import re
 import datetime
+import struct
 
 connectivity_event_list_ = ["server_listening",      "connection_started",  "connection_closed",
                             "connection_id_updated", "spin_bit_updated",   "connection_state_updated",
@@ -940,16 +941,148 @@ def parse_http_frame_parsed(line):
     return (data, event_scid)
     
 
+# binary event log, keep in sync with src/common/xqc_binlog.h and xqc_log_event_callback.c
+binlog_version_ = 1
+binlog_record_fmt_ = "<QQHBBI5Q"
+binlog_record_size_ = struct.calcsize(binlog_record_fmt_)
+
+# event id is the value of xqc_log_type_t
+binlog_events_ = {
+    2:  ("connection_closed",      ["err", "mtu_updated_count", "pkt_dropped"]),
+    14: ("packet_sent",            ["pkt_num", "pkt_type", "size", "frame_flag", "path_id"]),
+    15: ("packet_received",        ["pkt_num", "pkt_type", "size", "frame_flag", "path_id"]),
+    18: ("packets_acked",          ["pkt_space", "high", "low", "path_id"]),
+    19: ("datagrams_sent",         ["size", "path_id"]),
+    20: ("datagrams_received",     ["size", "path_id"]),
+    22: ("stream_state_updated",   ["stream_id", "side", "old", "new"]),
+    24: ("stream_data_moved",      ["stream_id", "is_recv", "offset", "length", "fin"]),
+    28: ("rec_metrics_updated",    ["cwnd", "inflight", "srtt", "latest_rtt", "lost"]),
+    30: ("loss_timer_updated",     ["event_type", "expire_time", "inter_time"]),
+    31: ("packet_lost",            ["pkt_num", "pkt_type", "lost_pn", "loss_delay", "path_id"]),
+}
+
+binlog_timer_events_ = ["set", "expired", "cancelled"]
+
+
+def binlog_records(file_name):
+    with open(file_name, 'rb') as file:
+        while True:
+            buf = file.read(binlog_record_size_)
+            if len(buf) < binlog_record_size_:
+                return
+            (time, cid, event, argc, version, dropped,
+             a0, a1, a2, a3, a4) = struct.unpack(binlog_record_fmt_, buf)
+            if version != binlog_version_:
+                print(f"Error: binlog version {version} is not supported.")
+                sys.exit(1)
+            yield time, struct.pack("<Q", cid).hex(), event, dropped, [a0, a1, a2, a3, a4][:argc]
+
+
+def binlog_event_data(name, arg_names, args):
+    if name == "packet_sent" or name == "packet_received":
+        data = {
+            "header": {
+                "packet_number": "unknown" if args[0] == 0xffffffffffffffff else args[0],
+                "packet_type": packet_type_.get(args[1] >> 8, "unknown")
+            },
+            "raw": {"length": args[2]}
+        }
+    elif name == "packets_acked":
+        data = {"packet_number_space": packet_number_namespace_.get(args[0], "unknown"),
+                "packet_numbers": [args[2], args[1]]}
+    elif name == "datagrams_sent" or name == "datagrams_received":
+        data = {"raw": {"length": args[0]}}
+    elif name == "stream_state_updated":
+        states = send_stream_states_ if args[1] == 0 else recv_stream_states_
+        data = {"stream_id": args[0],
+                "stream_side": "sending" if args[1] == 0 else "receiving",
+                "old": states[args[2]] if args[2] < len(states) else "unknown",
+                "new": states[args[3]] if args[3] < len(states) else "unknown"}
+    elif name == "stream_data_moved":
+        data = {"stream_id": args[0], "offset": args[2], "length": args[3],
+                "from": "transport" if args[1] else "application",
+                "to": "application" if args[1] else "transport"}
+    elif name == "rec_metrics_updated":
+        data = {"congestion_window": args[0], "bytes_in_flight": args[1],
+                "smoothed_rtt": args[2], "latest_rtt": args[3]}
+    elif name == "loss_timer_updated":
+        data = {"event_type": binlog_timer_events_[args[0]] if args[0] < 3 else "unknown",
+                "expire_time": args[1], "inter_time": args[2]}
+    elif name == "packet_lost":
+        data = {"header": {"packet_number": args[0],
+                           "packet_type": packet_type_.get(args[1] >> 8, "unknown")}}
+    else:
+        data = dict(zip(arg_names, args))
+    return data
+
+
+def endpoint_binlog_extraction(file_name, vantagepoint, text_out=None):
+    assert(vantagepoint == "server" or vantagepoint == "client")
+    traces_log = {}
+    for (time, scid, event_id, dropped, args) in binlog_records(file_name):
+        if dropped > 0:
+            print(f"Warning: {dropped} records dropped before {time} in {file_name}")
+        if event_id not in binlog_events_:
+            continue
+        (name, arg_names) = binlog_events_[event_id]
+        if text_out is not None:
+            dt_object = datetime.datetime.fromtimestamp(time / 1000000)
+            fields = "|".join([f"{k}:{v}" for k, v in zip(arg_names, args)])
+            text_out.write(f"[{dt_object.strftime('%Y/%m/%d %H:%M:%S %f')}] [{name}] "
+                           f"|scid:{scid}|{fields}|\n")
+            continue
+
+        event = {"time": time / 1000, "name": name}
+        if name in connectivity_event_list_:
+            event["name"] = "connectivity:" + name
+        elif name in quic_event_list_:
+            event["name"] = "quic:" + name
+        elif name == "rec_metrics_updated":
+            event["name"] = "recovery:" + name[4:]
+        else:
+            event["name"] = "recovery:" + name
+        if "path_id" in arg_names:
+            event["path"] = args[arg_names.index("path_id")]
+        event["data"] = binlog_event_data(name, arg_names, args)
+
+        if scid not in traces_log:
+            traces_log[scid] = {
+                "title": "xquic-qlog json: " + vantagepoint,
+                "description": "",
+                "common_fields": { "ODCID": scid, "time_format": "absolute" },
+                "vantage_point" :  {"name": vantagepoint + "-view",
+                         "type": vantagepoint
+                },
+                "events": []
+            }
+        traces_log[scid]["events"].append(event)
+    return list(traces_log.values())
+
+
 def main():
     global last_scid_
     parser = argparse.ArgumentParser()
     parser.add_argument("--clog", help="xquic client log file")
     parser.add_argument("--slog", help="xquic server log file")
+    parser.add_argument("--cbin", help="xquic client binary event log file, drained by xqc_engine_read_binlog")
+    parser.add_argument("--sbin", help="xquic server binary event log file, drained by xqc_engine_read_binlog")
+    parser.add_argument("--text_path", help="convert binary event log to text log instead of qlog json")
     parser.add_argument("--qlog_path", help="output json file, endswith .json", default="demo_qlog.json")
     args = parser.parse_args()
-    if (args.clog is None) and (args.slog is None):
-        print("Usage: must provide either --clog or --slog argument")
+    if (args.clog is None) and (args.slog is None) and (args.cbin is None) and (args.sbin is None):
+        print("Usage: must provide either --clog, --slog, --cbin or --sbin argument")
         sys.exit(1)
+    for bin_file in [args.cbin, args.sbin]:
+        if (bin_file is not None) and (not os.path.isfile(bin_file)):
+            print(f"Error: The binary log '{bin_file}' does not exist.")
+            sys.exit(1)
+    if args.text_path is not None:
+        with open(args.text_path, 'w') as text_out:
+            if args.sbin is not None:
+                endpoint_binlog_extraction(args.sbin, "server", text_out)
+            if args.cbin is not None:
+                endpoint_binlog_extraction(args.cbin, "client", text_out)
+        return
     if (args.clog is not None) and (not os.path.isfile(args.clog)):
         print(f"Error: The log '{args.clog}' does not exist.")
         sys.exit(1)
@@ -974,6 +1107,12 @@ def main():
         client_traces = endpoint_events_extraction(args.clog, "client")
         data["traces"] += client_traces
 
+    if(args.sbin is not None):
+        data["traces"] += endpoint_binlog_extraction(args.sbin, "server")
+
+    if(args.cbin is not None):
+        data["traces"] += endpoint_binlog_extraction(args.cbin, "client")
+
     json_output = json.dumps(data, indent=4)
     
     with open(args.qlog_path, 'w') as out_file:
@@ -0,0 +1,134 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "xqc_cm_sketch.h"
+#include "src/common/xqc_malloc.h"
+#include "src/common/xqc_common.h"
+
+
+/*
+ * finalizer of splitmix64. every bit of key affects both halves of the result, hence keys which
+ * share one half, like name-value pairs with the same name, are still spread in all rows
+ */
+static inline uint64_t
+xqc_cm_sketch_mix(uint64_t hash)
+{
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+/*
+ * index of key in row i, derived from 2 halves of the mixed hash with double hashing. the step
+ * is odd, hence 2 keys colliding in one row are unlikely to collide in the others.
+ */
+static inline size_t
+xqc_cm_sketch_index(xqc_cm_sketch_t *cms, uint64_t mixed, size_t row)
+{
+    uint32_t h1 = (uint32_t)mixed;
+    uint32_t h2 = (uint32_t)(mixed >> 32) | 1;
+
+    return row * (cms->mask + 1) + ((h1 + row * h2) & cms->mask);
+}
+
+
+xqc_cm_sketch_t *
+xqc_cm_sketch_create(size_t width)
+{
+    xqc_cm_sketch_t *cms;
+
+    width = width ? xqc_pow2_upper(width) : XQC_POW2_UPPER_ERROR;
+    if (width == XQC_POW2_UPPER_ERROR || width > SIZE_MAX / XQC_CM_SKETCH_DEPTH) {
+        return NULL;
+    }
+
+    cms = xqc_calloc(1, sizeof(xqc_cm_sketch_t));
+    if (cms == NULL) {
+        return NULL;
+    }
+
+    cms->counters = xqc_calloc(width * XQC_CM_SKETCH_DEPTH, sizeof(uint8_t));
+    if (cms->counters == NULL) {
+        xqc_free(cms);
+        return NULL;
+    }
+
+    cms->mask = width - 1;
+    cms->sample_size = width * XQC_CM_SKETCH_SAMPLE_FACTOR;
+    return cms;
+}
+
+
+void
+xqc_cm_sketch_destroy(xqc_cm_sketch_t *cms)
+{
+    if (cms == NULL) {
+        return;
+    }
+
+    xqc_free(cms->counters);
+    xqc_free(cms);
+}
+
+
+uint32_t
+xqc_cm_sketch_estimate(xqc_cm_sketch_t *cms, uint64_t hash)
+{
+    uint32_t min = XQC_CM_SKETCH_COUNTER_MAX;
+
+    hash = xqc_cm_sketch_mix(hash);
+    for (size_t i = 0; i < XQC_CM_SKETCH_DEPTH; i++) {
+        min = xqc_min(min, cms->counters[xqc_cm_sketch_index(cms, hash, i)]);
+    }
+
+    return min;
+}
+
+
+uint32_t
+xqc_cm_sketch_add(xqc_cm_sketch_t *cms, uint64_t hash)
+{
+    size_t idx[XQC_CM_SKETCH_DEPTH];
+    uint32_t min = XQC_CM_SKETCH_COUNTER_MAX;
+    size_t i;
+
+    hash = xqc_cm_sketch_mix(hash);
+    for (i = 0; i < XQC_CM_SKETCH_DEPTH; i++) {
+        idx[i] = xqc_cm_sketch_index(cms, hash, i);
+        min = xqc_min(min, cms->counters[idx[i]]);
+    }
+
+    if (min == XQC_CM_SKETCH_COUNTER_MAX) {
+        return min;
+    }
+
+    /* conservative update, counters larger than the estimation are left unchanged */
+    for (i = 0; i < XQC_CM_SKETCH_DEPTH; i++) {
+        if (cms->counters[idx[i]] == min) {
+            cms->counters[idx[i]]++;
+        }
+    }
+
+    if (++cms->additions >= cms->sample_size) {
+        xqc_cm_sketch_age(cms);
+    }
+
+    return min + 1;
+}
+
+
+void
+xqc_cm_sketch_age(xqc_cm_sketch_t *cms)
+{
+    size_t cnt = (cms->mask + 1) * XQC_CM_SKETCH_DEPTH;
+
+    for (size_t i = 0; i < cnt; i++) {
+        cms->counters[i] >>= 1;
+    }
+
+    cms->additions = 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_CM_SKETCH_H_
+#define _XQC_CM_SKETCH_H_
+
+#include "src/common/xqc_common_inc.h"
+
+/*
+ * count-min sketch, which estimates the frequency of keys in a small and fixed memory. a key is
+ * counted in one counter of each row, and the estimation is the min of them, which never
+ * underestimates. counters are updated conservatively, only the min ones are increased, which
+ * reduces overestimation caused by collisions. all counters are halved after a sample of
+ * additions, hence the estimation follows the recent frequency rather than the history.
+ */
+
+/* rows of sketch, each row is indexed by a different hash of key */
+#define XQC_CM_SKETCH_DEPTH         4
+
+/* max value of counters */
+#define XQC_CM_SKETCH_COUNTER_MAX   UINT8_MAX
+
+/* counters are halved after (width * XQC_CM_SKETCH_SAMPLE_FACTOR) additions */
+#define XQC_CM_SKETCH_SAMPLE_FACTOR 2
+
+typedef struct xqc_cm_sketch_s {
+    /* XQC_CM_SKETCH_DEPTH rows of counters */
+    uint8_t        *counters;
+    size_t          mask;
+
+    /* additions since last halving */
+    size_t          additions;
+    size_t          sample_size;
+} xqc_cm_sketch_t;
+
+
+/**
+ * @brief create a count-min sketch
+ * @param width counters in each row, rounded up to power of 2
+ */
+xqc_cm_sketch_t *xqc_cm_sketch_create(size_t width);
+
+void xqc_cm_sketch_destroy(xqc_cm_sketch_t *cms);
+
+/**
+ * @brief count a key, and return its estimated frequency including this one
+ * @param hash 64-bit hash of key
+ */
+uint32_t xqc_cm_sketch_add(xqc_cm_sketch_t *cms, uint64_t hash);
+
+/**
+ * @brief estimated frequency of a key
+ */
+uint32_t xqc_cm_sketch_estimate(xqc_cm_sketch_t *cms, uint64_t hash);
+
+/**
+ * @brief halve all counters
+ */
+void xqc_cm_sketch_age(xqc_cm_sketch_t *cms);
+
+#endif
@@ -23,70 +23,59 @@ xqc_huffman_enc_len(const uint8_t *src, size_t len)
 }
 
 
+/* each code is at most 30 bits, hence 4 bytes for each symbol is always enough */
+#define XQC_HUFFMAN_ENC_MAX_BYTES   4
+
+
 /**
- * encode one symbol
- * @param dest destination buffer
- * @param prembits count of the least bits which is not used
- * of the first byte from dest
- * @param ec the huffman encode code
- * @return the pointer of unused buffer
+ * encode bytes with a 64-bit accumulator, codes are appended with shifts and flushed
+ * in 32-bit words. the accumulator never holds more than 31 + 30 bits
+ * @param dest_end the end of destination buffer
+ * @return end point of encoded buffer, NULL if dest is not long enough
  */
 static inline uint8_t *
-xqc_huffman_encode_sym(uint8_t *dest, 
-    size_t *prembits, const xqc_huffman_enc_code_t *ec)
+xqc_huffman_enc_acc(uint8_t *dest, const uint8_t *dest_end, const uint8_t *src, size_t srclen)
 {
-    size_t nbits = ec->bits;
-    size_t rembits = *prembits;
-    uint32_t code = ec->lsb;
-
-    if (rembits > nbits) {
-        *dest |= (uint8_t)(code << (rembits - nbits));
-        *prembits = rembits - nbits;
-        return dest;
-    }
-
-    if (rembits == nbits) {
-        *dest++ |= (uint8_t)code;
-        *prembits = 8;
-        return dest;
-    }
+    const xqc_huffman_enc_code_t *sym;
+    uint64_t acc = 0;
+    size_t nbits = 0;
+    size_t pad;
+    uint32_t word;
 
-    *dest++ |= (uint8_t)(code >> (nbits - rembits));
+    for (size_t i = 0; i < srclen; ++i) {
+        sym = &xqc_huffman_enc_code_table[src[i]];
+        acc = (acc << sym->bits) | sym->lsb;
+        nbits += sym->bits;
 
-    nbits -= rembits;
-    if (nbits & 0x7) {
-        code <<= 8 - (nbits & 0x7);
-    }
+        if (nbits >= 32) {
+            if (dest_end - dest < 4) {
+                return NULL;
+            }
 
-    if (nbits < 8) {
-        *dest = (uint8_t)code;
-        *prembits = 8 - nbits;
-        return dest;
+            nbits -= 32;
+            word = (uint32_t)(acc >> nbits);
+            dest[0] = (uint8_t)(word >> 24);
+            dest[1] = (uint8_t)(word >> 16);
+            dest[2] = (uint8_t)(word >> 8);
+            dest[3] = (uint8_t)word;
+            dest += 4;
+        }
     }
 
-    if (nbits > 24) {
-        *dest++ = (uint8_t)(code >> 24);
-        nbits -= 8;
-    }
+    /* 256 is special terminal symbol, pad with its prefix, which is all 1 */
+    pad = (8 - (nbits & 0x7)) & 0x7;
+    acc = (acc << pad) | ((1u << pad) - 1);
+    nbits += pad;
 
-    if (nbits > 16) {
-        *dest++ = (uint8_t)(code >> 16);
-        nbits -= 8;
+    if ((size_t)(dest_end - dest) < nbits / 8) {
+        return NULL;
     }
 
-    if (nbits > 8) {
-        *dest++ = (uint8_t)(code >> 8);
+    while (nbits > 0) {
         nbits -= 8;
+        *dest++ = (uint8_t)(acc >> nbits);
     }
 
-    if (nbits == 8) {
-        *dest++ = (uint8_t)code;
-        *prembits = 8;
-        return dest;
-    }
-
-    *dest = (uint8_t)code;
-    *prembits = 8 - nbits;
     return dest;
 }
 
@@ -94,57 +83,83 @@ xqc_huffman_encode_sym(uint8_t *dest,
 uint8_t *
 xqc_huffman_enc(uint8_t *dest, const uint8_t *src, size_t srclen)
 {
-    size_t rembits = 8;
-    const xqc_huffman_enc_code_t *sym;
+    return xqc_huffman_enc_acc(dest, dest + srclen * XQC_HUFFMAN_ENC_MAX_BYTES, src, srclen);
+}
 
-    for (size_t i = 0; i < srclen; ++i) {
-        sym = &xqc_huffman_enc_code_table[src[i]];
-        if (rembits == 8) {
-            *dest = 0;
-        }
-        dest = xqc_huffman_encode_sym(dest, &rembits, sym);
+
+size_t
+xqc_huffman_enc_if_shorter(uint8_t *dest, const uint8_t *src, size_t srclen)
+{
+    uint8_t *end;
+
+    if (srclen == 0) {
+        return 0;
     }
-    /* 256 is special terminal symbol, pad with its prefix */
-    if (rembits < 8) {
-        sym = &xqc_huffman_enc_code_table[256];
-        *dest++ |= (uint8_t)(sym->lsb >> (sym->bits - rembits));
+
+    /* encoding is aborted as soon as it reaches the length of src */
+    end = xqc_huffman_enc_acc(dest, dest + srclen - 1, src, srclen);
+    if (end == NULL) {
+        return 0;
     }
 
-    return dest;
+    return end - dest;
 }
 
 
 void
 xqc_huffman_dec_ctx_init(xqc_huffman_dec_ctx *ctx)
 {
-    ctx->state = 0;
-    ctx->pre_state = 0;
-    ctx->end = 1;
-    ctx->high_bits = XQC_TRUE;
-    ctx->bit = 0;
+    ctx->acc = 0;
+    ctx->nbits = 0;
+    ctx->end = XQC_TRUE;
 }
 
 
-/* decode 4 bits */
+/* accumulator is refilled with whole bytes until it holds more than 56 bits */
+#define XQC_HUFFMAN_DEC_ACC_REFILL  56
+
+#define XQC_HUFFMAN_DEC_FAST_MASK   ((1 << XQC_HUFFMAN_DEC_FAST_BITS) - 1)
+
+
+/**
+ * decode one symbol from the MSB of valid bits in accumulator
+ * @param bits output, the length of code
+ * @return 1 if decoded, 0 if more bits are needed, < 0 if EOS is decoded
+ */
 static inline ssize_t
-xqc_huffman_dec_bits(xqc_huffman_dec_ctx *ctx, uint8_t bits, uint8_t *dst)
+xqc_huffman_dec_sym(uint64_t acc, size_t nbits, uint8_t *sym, size_t *bits)
 {
-    ssize_t ret = 0;
-    const xqc_huffman_dec_code_t *code = &xqc_huffman_dec_code_table[ctx->state][bits];
-    if (code->flags & XQC_HUFFMAN_FAIL) {
-        return -XQC_QPACK_HUFFMAN_DEC_ERROR;
-    }
+    const xqc_huffman_dec_canon_t *canon;
+    uint64_t v;
+    uint16_t s;
+
+    /* align the first 32 bits to MSB, padded with 0 if not enough */
+    v = nbits >= 32 ? acc >> (nbits - 32) : acc << (32 - nbits);
+    v &= 0xffffffff;
+
+    for (size_t i = 0; i < XQC_HUFFMAN_DEC_CANON_LENS; i++) {
+        canon = &xqc_huffman_dec_canon_table[i];
+        if (v >= canon->limit) {
+            continue;
+        }
+
+        /* the code is truncated */
+        if (canon->bits > nbits) {
+            return 0;
+        }
+
+        s = xqc_huffman_dec_canon_syms[canon->offset + (v >> (32 - canon->bits)) - canon->first];
+        if (s == 256) {
+            return -XQC_QPACK_HUFFMAN_DEC_ERROR;
+        }
 
-    if (code->flags & XQC_HUFFMAN_SYM) {
-        *dst = code->sym;
-        ret = 1;
+        *sym = (uint8_t)s;
+        *bits = canon->bits;
+        return 1;
     }
 
-    ctx->bit = bits;
-    ctx->pre_state = ctx->state;
-    ctx->state = code->state;
-    ctx->end = (code->flags & XQC_HUFFMAN_END) ? XQC_TRUE : XQC_FALSE;
-    return ret;
+    /* unreachable, the limit of the longest code covers all 32-bit values */
+    return -XQC_QPACK_HUFFMAN_DEC_ERROR;
 }
 
 
@@ -157,41 +172,67 @@ xqc_huffman_dec(xqc_huffman_dec_ctx *ctx,
     const uint8_t *end = src + srclen;
     uint8_t *pchar = dest;
     const uint8_t *dst_end = dest + dstlen;
+    uint64_t acc = ctx->acc;
+    size_t nbits = ctx->nbits;
+    size_t bits;
+    uint64_t pad;
+    const xqc_huffman_dec_fast_t *entry;
+
+    for (;;) {
+        while (pos < end && nbits <= XQC_HUFFMAN_DEC_ACC_REFILL) {
+            acc = (acc << 8) | *pos++;
+            nbits += 8;
+        }
 
-    while (pos < end) {
-        /* process high bits first */
-        if (ctx->high_bits == XQC_TRUE) {
-            ret = xqc_huffman_dec_bits(ctx, *pos >> 4, pchar);
-            if (ret < 0) {
-                return ret;
+        /* fast path, look up XQC_HUFFMAN_DEC_FAST_BITS bits and get up to 2 symbols at once */
+        while (nbits >= XQC_HUFFMAN_DEC_FAST_BITS
+               && dst_end - pchar >= XQC_HUFFMAN_DEC_FAST_SYMS)
+        {
+            entry = &xqc_huffman_dec_fast_table[(acc >> (nbits - XQC_HUFFMAN_DEC_FAST_BITS))
+                                                & XQC_HUFFMAN_DEC_FAST_MASK];
+            if (entry->nsym == 0) {
+                break;
             }
-            pchar += ret;
-            ctx->high_bits = XQC_FALSE;
 
-            /* dest full */
-            if (pchar == dst_end) {
-                return pchar - dest;
-            }
+            pchar[0] = entry->sym[0];
+            pchar[1] = entry->sym[1];
+            pchar += entry->nsym;
+            nbits -= entry->bits;
         }
 
-        /* process low bits */
-        ret = xqc_huffman_dec_bits(ctx, *pos & 0x0f, pchar);
-        if (ret < 0) {
-            return ret;
+        /* refill before taking the slow path, unless input is exhausted */
+        if (pos < end && nbits <= XQC_HUFFMAN_DEC_ACC_REFILL) {
+            continue;
         }
-        pchar += ret;
-        ctx->high_bits = XQC_TRUE;
-
-        pos++;
 
         /* dest full */
         if (pchar == dst_end) {
-            return pchar - dest;
+            break;
         }
+
+        /* slow path for long codes, the tail of input, or the last byte of dest */
+        ret = xqc_huffman_dec_sym(acc, nbits, pchar, &bits);
+        if (ret < 0) {
+            return ret;
+        }
+
+        /* all complete codes are decoded */
+        if (ret == 0) {
+            break;
+        }
+
+        pchar++;
+        nbits -= bits;
     }
 
+    /* the remaining bits shall be the padding with the prefix of EOS, which is all 1 */
+    pad = (1ULL << (nbits & 0x7)) - 1;
+    ctx->acc = acc;
+    ctx->nbits = nbits;
+    ctx->end = nbits < 8 && (acc & pad) == pad;
+
     /* the end flag shall be set if all input buff is decoded */
-    if (fin && !ctx->end) {
+    if (fin && pos == end && !ctx->end) {
         return -XQC_QPACK_HUFFMAN_DEC_STATE_ERROR;
     }
 
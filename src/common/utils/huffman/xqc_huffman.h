@@ -33,21 +33,29 @@ size_t xqc_huffman_enc_len(const uint8_t *src, size_t len);
 uint8_t *xqc_huffman_enc(uint8_t *dest, const uint8_t *src, size_t srclen);
 
 
+/**
+ * encode bytes only if the encoded string is shorter than the original one, which saves
+ * the sizing pass of xqc_huffman_enc_len
+ * @param dest the destination buffer, which shall be at least srclen bytes
+ * @param src the bytes to be encoded
+ * @param srclen length of src
+ * @return length of encoded huffman bytes, 0 if it is not shorter than srclen, and the
+ * content of dest is undefined
+ */
+size_t xqc_huffman_enc_if_shorter(uint8_t *dest, const uint8_t *src, size_t srclen);
+
+
 
 typedef struct {
-    /* huffman decoding state. We stripped leaf nodes, so the
-       value range is [0..255], inclusive. */
-    uint8_t    state;
+    /* input bits which are not decoded yet, aligned to the LSB. a code might be
+       truncated at the end of input, its bits are kept until next input arrives */
+    uint64_t   acc;
+
+    /* count of valid bits in acc */
+    uint8_t    nbits;
 
     /* true if decode finished */
     xqc_bool_t end;
-
-    /* whether processing high_bits now. when */
-    xqc_bool_t high_bits;
-
-    /* use for debug */
-    uint8_t    pre_state;
-    uint8_t    bit;
 } xqc_huffman_dec_ctx;
 
 
@@ -22,34 +22,46 @@ typedef struct {
 extern const xqc_huffman_enc_code_t xqc_huffman_enc_code_table[];
 
 
-
 /**
- * huffman decode table
+ * multi-symbol huffman decode table
  */
 
-typedef enum {
-    /* the end of huffman encoded bytes. */
-    XQC_HUFFMAN_END = 0x01,
+/* bits looked up in one step, 12 bits keeps the table in L1 cache and holds up to 2 symbols */
+#define XQC_HUFFMAN_DEC_FAST_BITS   12
+#define XQC_HUFFMAN_DEC_FAST_SYMS   2
+
+typedef struct {
+    /* count of bits taken by the symbols, 0 if the first code is longer than lookup bits */
+    uint8_t bits;
+
+    /* count of symbols */
+    uint8_t nsym;
 
-    /* symbol is available */
-    XQC_HUFFMAN_SYM = 0x02,
+    uint8_t sym[XQC_HUFFMAN_DEC_FAST_SYMS];
+} xqc_huffman_dec_fast_t;
 
-    /* decoding failure. */
-    XQC_HUFFMAN_FAIL = 0x04
-} xqc_huffman_dec_flag;
+extern const xqc_huffman_dec_fast_t xqc_huffman_dec_fast_table[1 << XQC_HUFFMAN_DEC_FAST_BITS];
 
+
+/* count of different code lengths */
+#define XQC_HUFFMAN_DEC_CANON_LENS  21
+
+/* the huffman code of HPACK is canonical, codes with the same length are consecutive */
 typedef struct {
-    /* huffman decoding state, which is 
-       the index of next decode code */
-    uint8_t state;
+    /* code length */
+    uint8_t  bits;
+
+    /* the upper bound of codes with this length or shorter, aligned to the MSB of 32 bits */
+    uint64_t limit;
 
-    /* xqc_huffman_dec_flag */
-    uint8_t flags;
+    /* the first code of this length */
+    uint32_t first;
 
-    /* symbol */
-    uint8_t sym;
-} xqc_huffman_dec_code_t;
+    /* index of the symbol of first code in xqc_huffman_dec_canon_syms */
+    uint16_t offset;
+} xqc_huffman_dec_canon_t;
 
-extern const xqc_huffman_dec_code_t xqc_huffman_dec_code_table[256][16];
+extern const xqc_huffman_dec_canon_t xqc_huffman_dec_canon_table[XQC_HUFFMAN_DEC_CANON_LENS];
+extern const uint16_t xqc_huffman_dec_canon_syms[257];
 
 #endif
\ No newline at end of file
@@ -0,0 +1,388 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "xqc_oa_hash.h"
+#include "src/common/xqc_common.h"
+
+
+/* control bytes, full slots store the lower 7 bits of hash value */
+#define XQC_OA_HASH_CTRL_EMPTY      0x80
+#define XQC_OA_HASH_CTRL_DELETED    0xfe
+
+#define XQC_OA_HASH_LSBS            0x0101010101010101ULL
+#define XQC_OA_HASH_MSBS            0x8080808080808080ULL
+
+#define XQC_OA_HASH_H2(hash)        ((uint8_t)((hash) & 0x7f))
+#define XQC_OA_HASH_H1(hash)        ((hash) >> 7)
+
+
+static inline uint64_t
+xqc_oa_hash_load_group(const uint8_t *ctrl)
+{
+    uint64_t group;
+    memcpy(&group, ctrl, sizeof(group));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    group = __builtin_bswap64(group);
+#endif
+    return group;
+}
+
+/* the msb of byte is set if control byte might be equal to h2, false positive is possible */
+static inline uint64_t
+xqc_oa_hash_match_h2(uint64_t group, uint8_t h2)
+{
+    uint64_t x = group ^ (XQC_OA_HASH_LSBS * h2);
+    return (x - XQC_OA_HASH_LSBS) & ~x & XQC_OA_HASH_MSBS;
+}
+
+static inline uint64_t
+xqc_oa_hash_match_empty(uint64_t group)
+{
+    return group & (~group << 6) & XQC_OA_HASH_MSBS;
+}
+
+static inline uint64_t
+xqc_oa_hash_match_empty_or_deleted(uint64_t group)
+{
+    return group & (~group << 7) & XQC_OA_HASH_MSBS;
+}
+
+/* index of the first matched byte in group */
+static inline size_t
+xqc_oa_hash_first_match(uint64_t match)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(match) >> 3;
+#else
+    size_t i = 0;
+    while (!(match & 0x80)) {
+        match >>= 8;
+        i++;
+    }
+    return i;
+#endif
+}
+
+
+static xqc_int_t
+xqc_oa_hash_array_create(xqc_oa_hash_array_t *arr, xqc_allocator_t *a, size_t capacity)
+{
+    arr->ctrl = a->malloc(a->opaque, capacity);
+    if (arr->ctrl == NULL) {
+        return -XQC_EMALLOC;
+    }
+
+    arr->slots = a->malloc(a->opaque, capacity * sizeof(xqc_oa_hash_slot_t));
+    if (arr->slots == NULL) {
+        a->free(a->opaque, arr->ctrl);
+        arr->ctrl = NULL;
+        return -XQC_EMALLOC;
+    }
+
+    memset(arr->ctrl, XQC_OA_HASH_CTRL_EMPTY, capacity);
+    arr->capacity = capacity;
+    arr->size = 0;
+    arr->deleted = 0;
+    return XQC_OK;
+}
+
+static void
+xqc_oa_hash_array_destroy(xqc_oa_hash_array_t *arr, xqc_allocator_t *a)
+{
+    if (arr->capacity) {
+        a->free(a->opaque, arr->ctrl);
+        a->free(a->opaque, arr->slots);
+    }
+    xqc_memzero(arr, sizeof(xqc_oa_hash_array_t));
+}
+
+/* return the index of slot, or capacity if not found */
+static size_t
+xqc_oa_hash_array_find(xqc_oa_hash_array_t *arr, uint64_t hash, const uint8_t *key, size_t len)
+{
+    size_t gmask, g, idx;
+    uint64_t group, match;
+    xqc_oa_hash_slot_t *slot;
+    uint8_t h2 = XQC_OA_HASH_H2(hash);
+
+    if (arr->size == 0) {
+        return arr->capacity;
+    }
+
+    gmask = arr->capacity / XQC_OA_HASH_GROUP_WIDTH - 1;
+    g = XQC_OA_HASH_H1(hash) & gmask;
+
+    for (size_t step = 0; step <= gmask; step++) {
+        group = xqc_oa_hash_load_group(arr->ctrl + g * XQC_OA_HASH_GROUP_WIDTH);
+
+        match = xqc_oa_hash_match_h2(group, h2);
+        while (match) {
+            idx = g * XQC_OA_HASH_GROUP_WIDTH + xqc_oa_hash_first_match(match);
+            match &= match - 1;
+
+            slot = &arr->slots[idx];
+            if (arr->ctrl[idx] == h2 && slot->hash == hash
+                && slot->key_len == len && memcmp(slot->key, key, len) == 0)
+            {
+                return idx;
+            }
+        }
+
+        /* the probe sequence never goes beyond a group with empty slot */
+        if (xqc_oa_hash_match_empty(group)) {
+            break;
+        }
+
+        /* triangular probing visits all groups when group count is power of 2 */
+        g = (g + step + 1) & gmask;
+    }
+
+    return arr->capacity;
+}
+
+/* return the count of probed slots */
+static size_t
+xqc_oa_hash_array_insert(xqc_oa_hash_array_t *arr, uint64_t hash, const uint8_t *key, size_t len,
+    void *value)
+{
+    size_t gmask, g, idx, step;
+    uint64_t group, match;
+    xqc_oa_hash_slot_t *slot;
+
+    gmask = arr->capacity / XQC_OA_HASH_GROUP_WIDTH - 1;
+    g = XQC_OA_HASH_H1(hash) & gmask;
+
+    for (step = 0; ; step++) {
+        group = xqc_oa_hash_load_group(arr->ctrl + g * XQC_OA_HASH_GROUP_WIDTH);
+        match = xqc_oa_hash_match_empty_or_deleted(group);
+        if (match) {
+            idx = g * XQC_OA_HASH_GROUP_WIDTH + xqc_oa_hash_first_match(match);
+            break;
+        }
+        g = (g + step + 1) & gmask;
+    }
+
+    if (arr->ctrl[idx] == XQC_OA_HASH_CTRL_DELETED) {
+        arr->deleted--;
+    }
+
+    arr->ctrl[idx] = XQC_OA_HASH_H2(hash);
+    slot = &arr->slots[idx];
+    slot->hash = hash;
+    slot->value = value;
+    slot->key_len = len;
+    memcpy(slot->key, key, len);
+    arr->size++;
+
+    return (step + 1) * XQC_OA_HASH_GROUP_WIDTH;
+}
+
+static void
+xqc_oa_hash_array_erase(xqc_oa_hash_array_t *arr, size_t idx)
+{
+    uint64_t group = xqc_oa_hash_load_group(arr->ctrl + (idx & ~(size_t)(XQC_OA_HASH_GROUP_WIDTH - 1)));
+
+    /*
+     * if there is still an empty slot in group, no probe sequence has ever gone beyond this
+     * group, the slot could be reused as empty. otherwise, a tombstone is necessary.
+     */
+    if (xqc_oa_hash_match_empty(group)) {
+        arr->ctrl[idx] = XQC_OA_HASH_CTRL_EMPTY;
+
+    } else {
+        arr->ctrl[idx] = XQC_OA_HASH_CTRL_DELETED;
+        arr->deleted++;
+    }
+
+    arr->size--;
+}
+
+/* move several groups from old array to current array */
+static void
+xqc_oa_hash_migrate(xqc_oa_hash_table_t *tab, size_t groups)
+{
+    size_t end, idx;
+    xqc_oa_hash_slot_t *slot;
+    xqc_oa_hash_array_t *old = &tab->old;
+
+    if (old->capacity == 0) {
+        return;
+    }
+
+    end = xqc_min(old->capacity, tab->migrate_pos + groups * XQC_OA_HASH_GROUP_WIDTH);
+    for (idx = tab->migrate_pos; idx < end; idx++) {
+        if (old->ctrl[idx] & XQC_OA_HASH_CTRL_EMPTY) {
+            /* empty or deleted */
+            continue;
+        }
+
+        slot = &old->slots[idx];
+        xqc_oa_hash_array_insert(&tab->cur, slot->hash, slot->key, slot->key_len, slot->value);
+
+        /* keep the probe sequence of elements which are not migrated yet */
+        old->ctrl[idx] = XQC_OA_HASH_CTRL_DELETED;
+        old->deleted++;
+        old->size--;
+    }
+
+    tab->migrate_pos = end;
+    if (tab->migrate_pos == old->capacity || old->size == 0) {
+        xqc_oa_hash_array_destroy(old, &tab->allocator);
+        tab->migrate_pos = 0;
+    }
+}
+
+static xqc_int_t
+xqc_oa_hash_grow(xqc_oa_hash_table_t *tab)
+{
+    xqc_int_t ret;
+    size_t capacity;
+    xqc_oa_hash_array_t arr;
+
+    /* finish the last resizing, which seldom happens */
+    if (tab->old.capacity) {
+        xqc_oa_hash_migrate(tab, tab->old.capacity / XQC_OA_HASH_GROUP_WIDTH);
+    }
+
+    /* double the capacity if it is nearly half full, otherwise just purge tombstones */
+    capacity = tab->cur.capacity;
+    if ((tab->cur.size + 1) * 16 > capacity * 7) {
+        capacity *= 2;
+    }
+
+    ret = xqc_oa_hash_array_create(&arr, &tab->allocator, capacity);
+    if (ret != XQC_OK) {
+        return ret;
+    }
+
+    tab->old = tab->cur;
+    tab->cur = arr;
+    tab->migrate_pos = 0;
+
+    xqc_log(tab->log, XQC_LOG_INFO, "|oa hash resize|capacity:%uz|size:%uz|",
+            capacity, tab->old.size);
+    return XQC_OK;
+}
+
+
+xqc_int_t
+xqc_oa_hash_init(xqc_oa_hash_table_t *tab, xqc_allocator_t allocator, size_t capacity,
+    uint32_t probe_thres, uint8_t *key, size_t key_len, xqc_log_t *log)
+{
+    if (key_len != XQC_SIPHASH_KEY_SIZE) { /* siphash key length must be 16 */
+        return XQC_ERROR;
+    }
+    if (log == NULL) {
+        return XQC_ERROR;
+    }
+
+    xqc_memzero(tab, sizeof(xqc_oa_hash_table_t));
+    tab->allocator = allocator;
+    tab->log = log;
+    tab->probe_thres = probe_thres > 0 ? probe_thres : XQC_OA_HASH_DEFAULT_PROBE_THRESHOLD;
+
+    capacity = xqc_max(capacity, XQC_OA_HASH_MIN_CAPACITY);
+    capacity = xqc_min(capacity, XQC_OA_HASH_MAX_INIT_CAPACITY);
+    capacity = xqc_pow2_upper(capacity);
+
+    if (xqc_siphash_init(&tab->siphash_ctx, key, key_len,
+                         XQC_DEFAULT_HASH_SIZE, XQC_SIPHASH_C_ROUNDS,
+                         XQC_SIPHASH_D_ROUNDS) != XQC_OK)
+    {
+        return XQC_ERROR;
+    }
+
+    if (xqc_oa_hash_array_create(&tab->cur, &tab->allocator, capacity) != XQC_OK) {
+        return XQC_ERROR;
+    }
+
+    return XQC_OK;
+}
+
+void
+xqc_oa_hash_release(xqc_oa_hash_table_t *tab)
+{
+    xqc_oa_hash_array_destroy(&tab->cur, &tab->allocator);
+    xqc_oa_hash_array_destroy(&tab->old, &tab->allocator);
+}
+
+void *
+xqc_oa_hash_find(xqc_oa_hash_table_t *tab, uint64_t hash, const uint8_t *key, size_t len)
+{
+    size_t idx;
+
+    xqc_oa_hash_migrate(tab, XQC_OA_HASH_MIGRATE_GROUPS);
+
+    idx = xqc_oa_hash_array_find(&tab->cur, hash, key, len);
+    if (idx != tab->cur.capacity) {
+        return tab->cur.slots[idx].value;
+    }
+
+    if (tab->old.capacity) {
+        idx = xqc_oa_hash_array_find(&tab->old, hash, key, len);
+        if (idx != tab->old.capacity) {
+            return tab->old.slots[idx].value;
+        }
+    }
+
+    return NULL;
+}
+
+xqc_int_t
+xqc_oa_hash_add(xqc_oa_hash_table_t *tab, uint64_t hash, const uint8_t *key, size_t len,
+    void *value)
+{
+    xqc_int_t ret;
+    size_t probed;
+
+    if (len > XQC_OA_HASH_MAX_KEY_LEN) {
+        return -XQC_EPARAM;
+    }
+
+    xqc_oa_hash_migrate(tab, XQC_OA_HASH_MIGRATE_GROUPS);
+
+    /* keep load factor (including tombstones) below 7/8 */
+    if ((tab->cur.size + tab->cur.deleted + 1) * 8 > tab->cur.capacity * 7) {
+        ret = xqc_oa_hash_grow(tab);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+    }
+
+    probed = xqc_oa_hash_array_insert(&tab->cur, hash, key, len, value);
+    if (probed > tab->probe_thres) {
+        time_t now_sec = time(NULL);
+        if (now_sec >= tab->last_log_time + XQC_OA_HASH_PROBE_LOG_INTERVAL) {
+            xqc_log(tab->log, XQC_LOG_WARN, "|oa hash probe length exceed|probed:%uz|size:%uz|",
+                    probed, xqc_oa_hash_size(tab));
+            tab->last_log_time = now_sec;
+        }
+    }
+
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_oa_hash_delete(xqc_oa_hash_table_t *tab, uint64_t hash, const uint8_t *key, size_t len)
+{
+    size_t idx;
+
+    xqc_oa_hash_migrate(tab, XQC_OA_HASH_MIGRATE_GROUPS);
+
+    idx = xqc_oa_hash_array_find(&tab->cur, hash, key, len);
+    if (idx != tab->cur.capacity) {
+        xqc_oa_hash_array_erase(&tab->cur, idx);
+        return XQC_OK;
+    }
+
+    if (tab->old.capacity) {
+        idx = xqc_oa_hash_array_find(&tab->old, hash, key, len);
+        if (idx != tab->old.capacity) {
+            xqc_oa_hash_array_erase(&tab->old, idx);
+            return XQC_OK;
+        }
+    }
+
+    return XQC_ERROR;
+}
@@ -0,0 +1,129 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef XQC_OA_HASH_H
+#define XQC_OA_HASH_H
+
+#include <time.h>
+
+#include "src/common/xqc_common_inc.h"
+#include "src/common/xqc_siphash.h"
+
+
+/**
+ * @brief open addressing hash table for short keys, like connection ids and stateless reset
+ * tokens. keys are stored inline in slots, and every slot owns a control byte with 7 bits of
+ * the hash value as fingerprint. control bytes are probed in groups of 8 with SWAR, hence most
+ * of the misses are resolved without touching the slots. the table grows incrementally, a
+ * small part of the old slots are migrated into the new array with each operation.
+ */
+
+/* max key length, which is the max length of connection id */
+#define XQC_OA_HASH_MAX_KEY_LEN         20
+
+/* slots in a probe group */
+#define XQC_OA_HASH_GROUP_WIDTH         8
+
+/* min and max initial capacity, table will grow when necessary */
+#define XQC_OA_HASH_MIN_CAPACITY        16
+#define XQC_OA_HASH_MAX_INIT_CAPACITY   (1 << 16)
+
+/* groups migrated from old array in each operation during resizing */
+#define XQC_OA_HASH_MIGRATE_GROUPS      2
+
+/* default log threshold of probed slots in one insertion */
+#define XQC_OA_HASH_DEFAULT_PROBE_THRESHOLD     256
+/* 10 second, log interval must not less then 10 second */
+#define XQC_OA_HASH_PROBE_LOG_INTERVAL  10
+
+typedef struct xqc_oa_hash_slot_s {
+    uint64_t                hash;
+    void                   *value;
+    uint8_t                 key_len;
+    uint8_t                 key[XQC_OA_HASH_MAX_KEY_LEN];
+} xqc_oa_hash_slot_t;
+
+typedef struct xqc_oa_hash_array_s {
+    /* control bytes, one for each slot */
+    uint8_t                *ctrl;
+    xqc_oa_hash_slot_t     *slots;
+
+    /* count of slots, power of 2 and not less than XQC_OA_HASH_GROUP_WIDTH */
+    size_t                  capacity;
+
+    /* count of elements and tombstones */
+    size_t                  size;
+    size_t                  deleted;
+} xqc_oa_hash_array_t;
+
+typedef struct xqc_oa_hash_table_s {
+    xqc_oa_hash_array_t     cur;
+
+    /* the array being migrated during resizing, capacity is 0 if not resizing */
+    xqc_oa_hash_array_t     old;
+    size_t                  migrate_pos;
+
+    xqc_allocator_t         allocator;
+    xqc_siphash_ctx_t       siphash_ctx;    /* siphash context */
+    uint32_t                probe_thres;    /* probed slots threshold in insertion, warning if exceeded */
+    time_t                  last_log_time;  /* last timestamp(second) for logging the max probe length */
+    xqc_log_t              *log;
+} xqc_oa_hash_table_t;
+
+
+/**
+ * @brief init an open addressing hash table
+ * @param capacity initial capacity, will be rounded up to power of 2 and limited to
+ * XQC_OA_HASH_MAX_INIT_CAPACITY
+ * @param probe_thres probe length threshold in slots for warning, 0 for default value
+ * @param key siphash key, MUST be XQC_SIPHASH_KEY_SIZE bytes
+ * @return XQC_OK for success, others for failure
+ */
+xqc_int_t xqc_oa_hash_init(xqc_oa_hash_table_t *tab, xqc_allocator_t allocator, size_t capacity,
+    uint32_t probe_thres, uint8_t *key, size_t key_len, xqc_log_t *log);
+
+void xqc_oa_hash_release(xqc_oa_hash_table_t *tab);
+
+/**
+ * @brief find the value of key
+ * @param hash hash value of key, calculated with xqc_oa_hash_get_hash
+ * @return value of key, NULL if not found
+ */
+void *xqc_oa_hash_find(xqc_oa_hash_table_t *tab, uint64_t hash, const uint8_t *key, size_t len);
+
+/**
+ * @brief add a key-value pair, key is copied into table. duplicated keys are not checked
+ * @return XQC_OK for success, -XQC_EPARAM if key is too long, -XQC_EMALLOC if failed to grow
+ */
+xqc_int_t xqc_oa_hash_add(xqc_oa_hash_table_t *tab, uint64_t hash, const uint8_t *key, size_t len,
+    void *value);
+
+/**
+ * @brief delete a key from table
+ * @return XQC_OK for success, XQC_ERROR if not found
+ */
+xqc_int_t xqc_oa_hash_delete(xqc_oa_hash_table_t *tab, uint64_t hash, const uint8_t *key,
+    size_t len);
+
+/* calculate the hash value of key with the siphash context of table */
+static inline uint64_t
+xqc_oa_hash_get_hash(xqc_oa_hash_table_t *tab, const uint8_t *key, size_t len)
+{
+    uint64_t hash_value;
+    if (xqc_siphash(&tab->siphash_ctx, key, len, (uint8_t *)(&hash_value),
+                    sizeof(hash_value)) == XQC_OK)
+    {
+        return hash_value;
+    }
+    return 0;
+}
+
+/* count of elements */
+static inline size_t
+xqc_oa_hash_size(xqc_oa_hash_table_t *tab)
+{
+    return tab->cur.size + tab->old.size;
+}
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "xqc_spsc_queue.h"
+#include "src/common/xqc_malloc.h"
+#include "src/common/xqc_common.h"
+
+
+xqc_spsc_queue_t *
+xqc_spsc_queue_create(size_t capacity, size_t elem_size)
+{
+    xqc_spsc_queue_t *q;
+
+    capacity = xqc_pow2_upper(capacity);
+    if (capacity == XQC_POW2_UPPER_ERROR || elem_size == 0
+        || capacity > SIZE_MAX / elem_size)
+    {
+        return NULL;
+    }
+
+    q = xqc_calloc(1, sizeof(xqc_spsc_queue_t));
+    if (q == NULL) {
+        return NULL;
+    }
+
+    q->elems = xqc_malloc(capacity * elem_size);
+    if (q->elems == NULL) {
+        xqc_free(q);
+        return NULL;
+    }
+
+    q->elem_size = elem_size;
+    q->mask = capacity - 1;
+    return q;
+}
+
+void
+xqc_spsc_queue_destroy(xqc_spsc_queue_t *q)
+{
+    if (q == NULL) {
+        return;
+    }
+
+    xqc_free(q->elems);
+    xqc_free(q);
+}
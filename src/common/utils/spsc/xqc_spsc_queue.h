@@ -0,0 +1,128 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_SPSC_QUEUE_H_
+#define _XQC_SPSC_QUEUE_H_
+
+#include "src/common/xqc_common_inc.h"
+
+/*
+ * lock-free single-producer single-consumer ring of fixed-size elements. the
+ * producer owns tail and the consumer owns head, each side only reads the
+ * index of the other one with acquire semantics, and publishes its own with
+ * release semantics. elements are written and read in place, which saves a
+ * copy for large elements like datagrams.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define xqc_spsc_load_acquire(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define xqc_spsc_store_release(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+/* volatile accesses have acquire/release semantics with msvc on x86/x64 */
+#define xqc_spsc_load_acquire(p)        (*(volatile size_t *)(p))
+#define xqc_spsc_store_release(p, v)    (*(volatile size_t *)(p) = (v))
+#endif
+
+/* padding between fields written by different threads, avoids false sharing */
+#define XQC_SPSC_CACHE_LINE_SIZE        64
+
+typedef struct xqc_spsc_queue_s {
+    /* read-only after creation */
+    uint8_t        *elems;
+    size_t          elem_size;
+    size_t          mask;
+    uint8_t         pad0[XQC_SPSC_CACHE_LINE_SIZE];
+
+    /* consumer side, tail_cache is the latest tail seen by consumer */
+    size_t          head;
+    size_t          tail_cache;
+    uint8_t         pad1[XQC_SPSC_CACHE_LINE_SIZE];
+
+    /* producer side, head_cache is the latest head seen by producer */
+    size_t          tail;
+    size_t          head_cache;
+    uint8_t         pad2[XQC_SPSC_CACHE_LINE_SIZE];
+} xqc_spsc_queue_t;
+
+
+/**
+ * @brief create a spsc queue
+ * @param capacity max count of elements, rounded up to power of 2
+ * @param elem_size size of each element
+ */
+xqc_spsc_queue_t *xqc_spsc_queue_create(size_t capacity, size_t elem_size);
+
+void xqc_spsc_queue_destroy(xqc_spsc_queue_t *q);
+
+
+/**
+ * @brief producer side, get the next free element to write in place
+ * @return NULL if queue is full
+ */
+static inline void *
+xqc_spsc_queue_reserve(xqc_spsc_queue_t *q)
+{
+    size_t tail = q->tail;
+
+    if (tail - q->head_cache > q->mask) {
+        q->head_cache = xqc_spsc_load_acquire(&q->head);
+        if (tail - q->head_cache > q->mask) {
+            return NULL;
+        }
+    }
+
+    return q->elems + (tail & q->mask) * q->elem_size;
+}
+
+/**
+ * @brief producer side, publish the element got from xqc_spsc_queue_reserve
+ */
+static inline void
+xqc_spsc_queue_commit(xqc_spsc_queue_t *q)
+{
+    xqc_spsc_store_release(&q->tail, q->tail + 1);
+}
+
+/**
+ * @brief consumer side, get the oldest element without removing it
+ * @return NULL if queue is empty
+ */
+static inline void *
+xqc_spsc_queue_front(xqc_spsc_queue_t *q)
+{
+    size_t head = q->head;
+
+    if (head == q->tail_cache) {
+        q->tail_cache = xqc_spsc_load_acquire(&q->tail);
+        if (head == q->tail_cache) {
+            return NULL;
+        }
+    }
+
+    return q->elems + (head & q->mask) * q->elem_size;
+}
+
+/**
+ * @brief consumer side, release the element got from xqc_spsc_queue_front
+ */
+static inline void
+xqc_spsc_queue_pop(xqc_spsc_queue_t *q)
+{
+    xqc_spsc_store_release(&q->head, q->head + 1);
+}
+
+/* approximate count of elements, exact if called by producer or consumer while the other is idle */
+static inline size_t
+xqc_spsc_queue_size(xqc_spsc_queue_t *q)
+{
+    return xqc_spsc_load_acquire(&q->tail) - xqc_spsc_load_acquire(&q->head);
+}
+
+static inline size_t
+xqc_spsc_queue_capacity(xqc_spsc_queue_t *q)
+{
+    return q->mask + 1;
+}
+
+#endif
@@ -0,0 +1,247 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "xqc_timer_wheel.h"
+#include "src/common/xqc_malloc.h"
+
+
+static inline uint32_t
+xqc_timer_wheel_fls(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#else
+    uint32_t n = 0;
+    while (v >>= 1) {
+        n++;
+    }
+    return n;
+#endif
+}
+
+static inline uint32_t
+xqc_timer_wheel_ctz(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#else
+    uint32_t n = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* bitmap of slots [lo, hi] */
+static inline uint64_t
+xqc_timer_wheel_slot_range(uint32_t lo, uint32_t hi)
+{
+    uint64_t upper = (hi >= XQC_TIMER_WHEEL_MASK) ? ~(uint64_t)0 : (((uint64_t)1 << (hi + 1)) - 1);
+    return upper & ~(((uint64_t)1 << lo) - 1);
+}
+
+
+xqc_timer_wheel_t *
+xqc_timer_wheel_create(xqc_usec_t now)
+{
+    xqc_timer_wheel_t *tw = xqc_calloc(1, sizeof(xqc_timer_wheel_t));
+    if (tw == NULL) {
+        return NULL;
+    }
+
+    for (int level = 0; level < XQC_TIMER_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < XQC_TIMER_WHEEL_SLOTS; slot++) {
+            xqc_init_list_head(&tw->slots[level][slot]);
+        }
+    }
+
+    xqc_init_list_head(&tw->due);
+    tw->curtime = now;
+    return tw;
+}
+
+void
+xqc_timer_wheel_destroy(xqc_timer_wheel_t *tw)
+{
+    xqc_free(tw);
+}
+
+void
+xqc_timer_wheel_add(xqc_timer_wheel_t *tw, xqc_timer_wheel_node_t *node,
+    xqc_usec_t expire_time)
+{
+    uint32_t level, slot;
+
+    node->expire_time = expire_time;
+    tw->count++;
+
+    if (expire_time <= tw->curtime) {
+        node->level = XQC_TIMER_WHEEL_LEVEL_DUE;
+        node->slot = 0;
+        xqc_list_add_tail(&node->list, &tw->due);
+        return;
+    }
+
+    level = xqc_timer_wheel_fls(expire_time ^ tw->curtime) / XQC_TIMER_WHEEL_BITS;
+    if (level >= XQC_TIMER_WHEEL_LEVELS) {
+        level = XQC_TIMER_WHEEL_LEVELS - 1;
+    }
+    slot = (expire_time >> (level * XQC_TIMER_WHEEL_BITS)) & XQC_TIMER_WHEEL_MASK;
+
+    node->level = level;
+    node->slot = slot;
+    xqc_list_add_tail(&node->list, &tw->slots[level][slot]);
+    tw->pending[level] |= (uint64_t)1 << slot;
+}
+
+void
+xqc_timer_wheel_del(xqc_timer_wheel_t *tw, xqc_timer_wheel_node_t *node)
+{
+    xqc_list_del_init(&node->list);
+
+    if (node->level == XQC_TIMER_WHEEL_LEVEL_NONE) {
+        /* node was already taken out by advance */
+        return;
+    }
+
+    if (node->level < XQC_TIMER_WHEEL_LEVELS
+        && xqc_list_empty(&tw->slots[node->level][node->slot]))
+    {
+        tw->pending[node->level] &= ~((uint64_t)1 << node->slot);
+    }
+
+    node->level = XQC_TIMER_WHEEL_LEVEL_NONE;
+    tw->count--;
+}
+
+static inline void
+xqc_timer_wheel_detach(xqc_timer_wheel_t *tw, xqc_timer_wheel_node_t *node,
+    xqc_list_head_t *expired)
+{
+    xqc_list_del_init(&node->list);
+    node->level = XQC_TIMER_WHEEL_LEVEL_NONE;
+    tw->count--;
+    xqc_list_add_tail(&node->list, expired);
+}
+
+void
+xqc_timer_wheel_advance(xqc_timer_wheel_t *tw, xqc_usec_t now,
+    xqc_list_head_t *expired)
+{
+    xqc_list_head_t todo, *pos, *next;
+    xqc_timer_wheel_node_t *node;
+    uint64_t mask, ocur, onow, blocks;
+    uint32_t level, shift, oslot, nslot, slot;
+
+    xqc_init_list_head(&todo);
+
+    if (now > tw->curtime) {
+        for (level = 0; level < XQC_TIMER_WHEEL_LEVELS; level++) {
+            shift = level * XQC_TIMER_WHEEL_BITS;
+            ocur = tw->curtime >> shift;
+            onow = now >> shift;
+            if (ocur == onow) {
+                /* higher levels are not moved either */
+                break;
+            }
+
+            oslot = ocur & XQC_TIMER_WHEEL_MASK;
+            nslot = onow & XQC_TIMER_WHEEL_MASK;
+            blocks = (onow >> XQC_TIMER_WHEEL_BITS) - (ocur >> XQC_TIMER_WHEEL_BITS);
+
+            /* slots passed by at this level, which is (oslot, nslot] */
+            if (blocks == 0) {
+                mask = xqc_timer_wheel_slot_range(oslot + 1, nslot);
+
+            } else if (blocks == 1) {
+                mask = xqc_timer_wheel_slot_range(0, nslot);
+                if (oslot < XQC_TIMER_WHEEL_MASK) {
+                    mask |= xqc_timer_wheel_slot_range(oslot + 1, XQC_TIMER_WHEEL_MASK);
+                }
+
+            } else {
+                mask = ~(uint64_t)0;
+            }
+
+            mask &= tw->pending[level];
+            tw->pending[level] &= ~mask;
+            while (mask) {
+                slot = xqc_timer_wheel_ctz(mask);
+                mask &= mask - 1;
+                xqc_list_splice_tail_init(&tw->slots[level][slot], &todo);
+            }
+        }
+
+        tw->curtime = now;
+    }
+
+    xqc_list_for_each_safe(pos, next, &tw->due) {
+        node = xqc_list_entry(pos, xqc_timer_wheel_node_t, list);
+        xqc_timer_wheel_detach(tw, node, expired);
+    }
+
+    /* expire or cascade the nodes in passed slots */
+    xqc_list_for_each_safe(pos, next, &todo) {
+        node = xqc_list_entry(pos, xqc_timer_wheel_node_t, list);
+        if (node->expire_time <= now) {
+            xqc_timer_wheel_detach(tw, node, expired);
+
+        } else {
+            xqc_list_del_init(&node->list);
+            tw->count--;
+            xqc_timer_wheel_add(tw, node, node->expire_time);
+        }
+    }
+}
+
+static inline xqc_usec_t
+xqc_timer_wheel_slot_min(xqc_list_head_t *head, xqc_usec_t min_time)
+{
+    xqc_list_head_t *pos;
+    xqc_timer_wheel_node_t *node;
+
+    xqc_list_for_each(pos, head) {
+        node = xqc_list_entry(pos, xqc_timer_wheel_node_t, list);
+        min_time = xqc_min(min_time, node->expire_time);
+    }
+
+    return min_time;
+}
+
+xqc_usec_t
+xqc_timer_wheel_next_expire_time(xqc_timer_wheel_t *tw)
+{
+    xqc_usec_t min_time = XQC_MAX_UINT64_VALUE;
+    uint64_t pending;
+    uint32_t level, slot;
+
+    if (tw->count == 0) {
+        return 0;
+    }
+
+    if (!xqc_list_empty(&tw->due)) {
+        return xqc_timer_wheel_slot_min(&tw->due, min_time);
+    }
+
+    /* nodes on lower levels always expire earlier than nodes on higher ones */
+    for (level = 0; level < XQC_TIMER_WHEEL_LEVELS - 1; level++) {
+        if (tw->pending[level]) {
+            slot = xqc_timer_wheel_ctz(tw->pending[level]);
+            return xqc_timer_wheel_slot_min(&tw->slots[level][slot], min_time);
+        }
+    }
+
+    /* top level might hold wrapped nodes, scan all non-empty slots */
+    pending = tw->pending[XQC_TIMER_WHEEL_LEVELS - 1];
+    while (pending) {
+        slot = xqc_timer_wheel_ctz(pending);
+        pending &= pending - 1;
+        min_time = xqc_timer_wheel_slot_min(&tw->slots[XQC_TIMER_WHEEL_LEVELS - 1][slot],
+                                            min_time);
+    }
+
+    return min_time == XQC_MAX_UINT64_VALUE ? 0 : min_time;
+}
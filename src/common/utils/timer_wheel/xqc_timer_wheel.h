@@ -0,0 +1,106 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_TIMER_WHEEL_H_
+#define _XQC_TIMER_WHEEL_H_
+
+#include "src/common/xqc_common_inc.h"
+#include "src/common/xqc_list.h"
+#include "src/common/xqc_time.h"
+#include "src/common/xqc_config.h"
+
+/*
+ * hierarchical timing wheel with microsecond ticks. each level has 64 slots, a
+ * node is placed on the level of the highest 6-bit group in which its expire
+ * time differs from the current time of the wheel, hence all nodes on a lower
+ * level expire earlier than any node on a higher level. nodes beyond the range
+ * of the top level wrap around and will be re-placed when their slot is passed.
+ */
+#define XQC_TIMER_WHEEL_BITS        6
+#define XQC_TIMER_WHEEL_SLOTS       (1 << XQC_TIMER_WHEEL_BITS)
+#define XQC_TIMER_WHEEL_MASK        (XQC_TIMER_WHEEL_SLOTS - 1)
+#define XQC_TIMER_WHEEL_LEVELS      4
+
+/* level of nodes which are already due, but not yet taken by advance */
+#define XQC_TIMER_WHEEL_LEVEL_DUE   XQC_TIMER_WHEEL_LEVELS
+
+/* level of nodes which are not attached to wheel */
+#define XQC_TIMER_WHEEL_LEVEL_NONE  0xff
+
+typedef struct xqc_timer_wheel_node_s {
+    xqc_list_head_t             list;
+    xqc_usec_t                  expire_time;
+    uint8_t                     level;
+    uint8_t                     slot;
+} xqc_timer_wheel_node_t;
+
+typedef struct xqc_timer_wheel_s {
+    /* the time when wheel was advanced last time */
+    xqc_usec_t                  curtime;
+
+    /* bitmap of non-empty slots on each level */
+    uint64_t                    pending[XQC_TIMER_WHEEL_LEVELS];
+    xqc_list_head_t             slots[XQC_TIMER_WHEEL_LEVELS][XQC_TIMER_WHEEL_SLOTS];
+
+    /* nodes which were added with an expire time not later than curtime */
+    xqc_list_head_t             due;
+
+    size_t                      count;
+} xqc_timer_wheel_t;
+
+
+/**
+ * @brief create a timer wheel
+ * @param now the start time of wheel
+ */
+xqc_timer_wheel_t *xqc_timer_wheel_create(xqc_usec_t now);
+
+void xqc_timer_wheel_destroy(xqc_timer_wheel_t *tw);
+
+static inline void
+xqc_timer_wheel_node_init(xqc_timer_wheel_node_t *node)
+{
+    xqc_init_list_head(&node->list);
+    node->expire_time = 0;
+    node->level = XQC_TIMER_WHEEL_LEVEL_NONE;
+    node->slot = 0;
+}
+
+static inline xqc_bool_t
+xqc_timer_wheel_node_pending(xqc_timer_wheel_node_t *node)
+{
+    return !xqc_list_empty(&node->list);
+}
+
+/**
+ * @brief add a node to wheel, O(1). node MUST NOT be pending
+ */
+void xqc_timer_wheel_add(xqc_timer_wheel_t *tw, xqc_timer_wheel_node_t *node,
+    xqc_usec_t expire_time);
+
+/**
+ * @brief remove a pending node from wheel, O(1)
+ */
+void xqc_timer_wheel_del(xqc_timer_wheel_t *tw, xqc_timer_wheel_node_t *node);
+
+/**
+ * @brief advance the wheel to now, and move all nodes with expire_time <= now to
+ * the tail of expired list. nodes in the expired list are detached from wheel
+ */
+void xqc_timer_wheel_advance(xqc_timer_wheel_t *tw, xqc_usec_t now,
+    xqc_list_head_t *expired);
+
+/**
+ * @brief get the earliest expire time of nodes in wheel, 0 if wheel is empty.
+ * only the first non-empty slot is scanned
+ */
+xqc_usec_t xqc_timer_wheel_next_expire_time(xqc_timer_wheel_t *tw);
+
+static inline size_t
+xqc_timer_wheel_count(xqc_timer_wheel_t *tw)
+{
+    return tw->count;
+}
+
+#endif
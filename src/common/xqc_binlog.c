@@ -0,0 +1,87 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "src/common/xqc_binlog.h"
+#include "src/common/xqc_malloc.h"
+#include "src/common/xqc_time.h"
+
+
+xqc_binlog_t *
+xqc_binlog_create(size_t capacity)
+{
+    xqc_binlog_t *binlog = xqc_calloc(1, sizeof(xqc_binlog_t));
+    if (binlog == NULL) {
+        return NULL;
+    }
+
+    binlog->ring = xqc_spsc_queue_create(capacity, sizeof(xqc_binlog_record_t));
+    if (binlog->ring == NULL) {
+        xqc_free(binlog);
+        return NULL;
+    }
+
+    return binlog;
+}
+
+void
+xqc_binlog_destroy(xqc_binlog_t *binlog)
+{
+    if (binlog == NULL) {
+        return;
+    }
+
+    xqc_spsc_queue_destroy(binlog->ring);
+    xqc_free(binlog);
+}
+
+void
+xqc_binlog_write(xqc_binlog_t *binlog, uint16_t event, uint64_t cid,
+    const uint64_t *args, uint8_t argc)
+{
+    xqc_binlog_record_t *rec = xqc_spsc_queue_reserve(binlog->ring);
+    if (rec == NULL) {
+        /* never block the engine, the gap is reported with the next record */
+        if (binlog->dropped < UINT32_MAX) {
+            binlog->dropped++;
+        }
+        return;
+    }
+
+    if (argc > XQC_BINLOG_MAX_ARGS) {
+        argc = XQC_BINLOG_MAX_ARGS;
+    }
+
+    rec->time = xqc_realtime_timestamp();
+    rec->cid = cid;
+    rec->event = event;
+    rec->argc = argc;
+    rec->version = XQC_BINLOG_VERSION;
+    rec->dropped = binlog->dropped;
+    for (uint8_t i = 0; i < XQC_BINLOG_MAX_ARGS; i++) {
+        rec->args[i] = i < argc ? args[i] : 0;
+    }
+
+    xqc_spsc_queue_commit(binlog->ring);
+    binlog->dropped = 0;
+}
+
+size_t
+xqc_binlog_read(xqc_binlog_t *binlog, uint8_t *buf, size_t buf_len)
+{
+    size_t read = 0;
+    xqc_binlog_record_t *rec;
+
+    while (buf_len - read >= sizeof(xqc_binlog_record_t)) {
+        rec = xqc_spsc_queue_front(binlog->ring);
+        if (rec == NULL) {
+            break;
+        }
+
+        memcpy(buf + read, rec, sizeof(xqc_binlog_record_t));
+        xqc_spsc_queue_pop(binlog->ring);
+        read += sizeof(xqc_binlog_record_t);
+    }
+
+    return read;
+}
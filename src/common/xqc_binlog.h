@@ -0,0 +1,66 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_BINLOG_H_INCLUDED_
+#define _XQC_BINLOG_H_INCLUDED_
+
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/common/utils/spsc/xqc_spsc_queue.h"
+
+/*
+ * binary event log. events are written to a per-engine lock-free ring as fixed-layout
+ * records, instead of being formatted to text on the hot path. records are drained by
+ * xqc_engine_read_binlog, and converted to text or qlog JSON offline with
+ * scripts/qlog_parser.py, which shall be kept in sync with the layout and the arguments
+ * of each event.
+ */
+
+#define XQC_BINLOG_VERSION      1
+#define XQC_BINLOG_MAX_ARGS     5
+
+/* XQC_BINLOG_RECORD_SIZE bytes, never change the layout without bumping XQC_BINLOG_VERSION */
+typedef struct xqc_binlog_record_s {
+    /* realtime timestamp in microseconds */
+    uint64_t            time;
+
+    /* first 8 bytes of original scid, 0 for events out of connection */
+    uint64_t            cid;
+
+    /* xqc_log_type_t */
+    uint16_t            event;
+    uint8_t             argc;
+    uint8_t             version;
+
+    /* count of records dropped right before this one as the ring was full */
+    uint32_t            dropped;
+
+    uint64_t            args[XQC_BINLOG_MAX_ARGS];
+} xqc_binlog_record_t;
+
+typedef struct xqc_binlog_s {
+    xqc_spsc_queue_t   *ring;
+
+    /* records dropped since the last record written, producer side only */
+    uint32_t            dropped;
+} xqc_binlog_t;
+
+
+xqc_binlog_t *xqc_binlog_create(size_t capacity);
+
+void xqc_binlog_destroy(xqc_binlog_t *binlog);
+
+/**
+ * @brief producer side, write an event record. the record is dropped if the ring is full
+ */
+void xqc_binlog_write(xqc_binlog_t *binlog, uint16_t event, uint64_t cid,
+    const uint64_t *args, uint8_t argc);
+
+/**
+ * @brief consumer side, move whole records to buf
+ * @return bytes of records moved
+ */
+size_t xqc_binlog_read(xqc_binlog_t *binlog, uint8_t *buf, size_t buf_len);
+
+#endif /* _XQC_BINLOG_H_INCLUDED_ */
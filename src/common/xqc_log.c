@@ -9,6 +9,10 @@
 FILE *g_malloc_info_fp;
 #endif
 
+#ifdef XQC_ENABLE_ALLOC_COUNT
+size_t xqc_alloc_count;
+#endif
+
 static xqc_bool_t log_disable = XQC_FALSE;
 
 void
@@ -276,7 +280,7 @@ xqc_log_implement(xqc_log_t *log, xqc_log_type_t type, const char *func, const c
         return;
     }
 
-    unsigned char   buf[XQC_MAX_LOG_LEN] = {0};
+    unsigned char   buf[XQC_MAX_LOG_LEN];
     unsigned char  *p = buf;
     unsigned char  *last = buf + sizeof(buf);
 
@@ -305,7 +309,7 @@ xqc_log_implement(xqc_log_t *log, xqc_log_type_t type, const char *func, const c
     p = xqc_vsprintf(p, last, fmt, args);
     va_end(args);
 
-    if (p + 1 < last) {
+    if (p < last) {
         /* may use printf("%s") outside, add '\0' and don't count into size */
         *p = '\0';
     }
@@ -345,7 +349,7 @@ xqc_qlog_implement(xqc_log_t *log, xqc_log_type_t type, const char *func, const
         }
     }
 
-    unsigned char   buf[XQC_MAX_LOG_LEN] = {0};
+    unsigned char   buf[XQC_MAX_LOG_LEN];
     unsigned char  *p = buf;
     unsigned char  *last = buf + sizeof(buf);
 
@@ -374,7 +378,7 @@ xqc_qlog_implement(xqc_log_t *log, xqc_log_type_t type, const char *func, const
     p = xqc_vsprintf(p, last, fmt, args);
     va_end(args);
 
-    if (p + 1 < last) {
+    if (p < last) {
         /* may use printf("%s") outside, add '\0' and don't count into size */
         *p = '\0';
     }
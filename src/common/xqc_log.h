@@ -128,6 +128,7 @@ typedef struct xqc_log_s {
     xqc_flag_t                      log_timestamp; /* 1:add timestamp before log, 0:don't need timestamp */
     xqc_flag_t                      log_level_name; /* 1:add level name before log, 0:don't need level name */
     unsigned char                  *scid;
+    uint64_t                        binlog_cid; /* connection identifier in binary event log */
     xqc_engine_t                   *engine;
     xqc_log_callbacks_t            *log_callbacks;
     void                           *user_data;
@@ -145,6 +146,7 @@ xqc_log_init(xqc_log_level_t log_level, xqc_flag_t log_event, qlog_event_importa
     log->log_level = log_level;
     log->user_data = user_data;
     log->scid = NULL;
+    log->binlog_cid = 0;
     log->log_event = log_event;
     log->log_timestamp = log_timestamp;
     log->log_level_name = log_level_name;
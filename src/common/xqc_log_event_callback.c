@@ -8,6 +8,19 @@
 #include "src/transport/xqc_send_ctl.h"
 #include "src/congestion_control/xqc_bbr_common.h"
 #include "src/http3/xqc_h3_conn.h"
+#include "src/transport/xqc_engine.h"
+
+
+/*
+ * with binary event log enabled, hot events are written as fixed-layout records instead of
+ * text. arguments of each event shall be kept in sync with scripts/qlog_parser.py
+ */
+#define xqc_log_binlog_enabled(log) ((log)->engine != NULL && (log)->engine->binlog != NULL)
+
+#define xqc_log_binlog_write(log, type, args) \
+    xqc_binlog_write((log)->engine->binlog, type, (log)->binlog_cid, \
+                     args, sizeof(args) / sizeof(uint64_t))
+
 
 void 
 xqc_log_CON_SERVER_LISTENING_callback(xqc_log_t *log, const char *func, const struct sockaddr *peer_addr, 
@@ -50,6 +63,12 @@ xqc_log_CON_CONNECTION_STARTED_callback(xqc_log_t *log, const char *func, xqc_co
 void
 xqc_log_CON_CONNECTION_CLOSED_callback(xqc_log_t *log, const char *func, xqc_connection_t *conn)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {conn->conn_err, conn->MTU_updated_count, conn->packet_dropped_count};
+        xqc_log_binlog_write(log, CON_CONNECTION_CLOSED, args);
+        return;
+    }
+
     if (conn->conn_err != 0){
         xqc_list_head_t *pos, *next;
         xqc_path_ctx_t *path = NULL;
@@ -208,6 +227,14 @@ xqc_log_TRA_PARAMETERS_SET_callback(xqc_log_t *log, const char *func, xqc_connec
 void
 xqc_log_TRA_PACKET_RECEIVED_callback(xqc_log_t *log, const char *func, xqc_packet_in_t *packet_in)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {packet_in->pi_pkt.pkt_num,
+                           (uint64_t)packet_in->pi_pkt.pkt_type << 8 | packet_in->pi_pkt.pkt_pns,
+                           packet_in->buf_size, packet_in->pi_frame_types, packet_in->pi_path_id};
+        xqc_log_binlog_write(log, TRA_PACKET_RECEIVED, args);
+        return;
+    }
+
     xqc_qlog_implement(log, TRA_PACKET_RECEIVED, func,
                       "|pkt_pns:%d|pkt_type:%s|pkt_num:%ui|len:%uz|frame_flag:%s|path_id:%ui|",
                       packet_in->pi_pkt.pkt_pns, xqc_pkt_type_2_str(packet_in->pi_pkt.pkt_type), packet_in->pi_pkt.pkt_num,
@@ -227,6 +254,15 @@ void
 xqc_log_TRA_PACKET_SENT_callback(xqc_log_t *log, const char *func, xqc_connection_t *conn,
     xqc_packet_out_t *packet_out, xqc_path_ctx_t *path, xqc_usec_t send_time, ssize_t sent, xqc_bool_t with_pn)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        /* packet number is not assigned yet without with_pn */
+        uint64_t args[] = {with_pn ? packet_out->po_pkt.pkt_num : XQC_MAX_UINT64_VALUE,
+                           (uint64_t)packet_out->po_pkt.pkt_type << 8 | packet_out->po_pkt.pkt_pns,
+                           packet_out->po_used_size, packet_out->po_frame_types, path->path_id};
+        xqc_log_binlog_write(log, TRA_PACKET_SENT, args);
+        return;
+    }
+
     if (with_pn) {
         xqc_qlog_implement(log, TRA_PACKET_SENT, func,
                         "|<==|conn:%p|path_id:%ui|pkt_pns:%d|pkt_type:%s|pkt_num:%ui|size:%d|frame_flag:%s|"
@@ -256,6 +292,12 @@ void
 xqc_log_TRA_PACKETS_ACKED_callback(xqc_log_t *log, const char *func, xqc_packet_in_t *packet_in,
     xqc_packet_number_t high, xqc_packet_number_t low, uint64_t path_id)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {packet_in->pi_pkt.pkt_pns, high, low, path_id};
+        xqc_log_binlog_write(log, TRA_PACKETS_ACKED, args);
+        return;
+    }
+
     xqc_qlog_implement(log, TRA_PACKETS_ACKED, func,
                       "|pkt_space:%d|high:%d|low:%d|path_id:%ui|",
                       packet_in->pi_pkt.pkt_pns, high, low, path_id);
@@ -264,6 +306,12 @@ xqc_log_TRA_PACKETS_ACKED_callback(xqc_log_t *log, const char *func, xqc_packet_
 void
 xqc_log_TRA_DATAGRAMS_SENT_callback(xqc_log_t *log, const char *func, ssize_t size, uint64_t path_id)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {size, path_id};
+        xqc_log_binlog_write(log, TRA_DATAGRAMS_SENT, args);
+        return;
+    }
+
     xqc_qlog_implement(log, TRA_DATAGRAMS_SENT, func,
                       "|size:%z|path_id:%ui|", size, path_id);
 }
@@ -271,6 +319,12 @@ xqc_log_TRA_DATAGRAMS_SENT_callback(xqc_log_t *log, const char *func, ssize_t si
 void
 xqc_log_TRA_DATAGRAMS_RECEIVED_callback(xqc_log_t *log, const char *func, ssize_t size, uint64_t path_id)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {size, path_id};
+        xqc_log_binlog_write(log, TRA_DATAGRAMS_RECEIVED, args);
+        return;
+    }
+
     xqc_qlog_implement(log, TRA_DATAGRAMS_RECEIVED, func,
                       "|size:%d|path_id:%ui|", size, path_id);
 }
@@ -279,6 +333,15 @@ void
 xqc_log_TRA_STREAM_STATE_UPDATED_callback(xqc_log_t *log, const char *func, xqc_stream_t *stream,
     xqc_int_t stream_type, xqc_int_t state)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {stream->stream_id, stream_type,
+                           stream_type == XQC_LOG_STREAM_SEND
+                           ? stream->stream_state_send : stream->stream_state_recv,
+                           state};
+        xqc_log_binlog_write(log, TRA_STREAM_STATE_UPDATED, args);
+        return;
+    }
+
     if (stream_type == XQC_LOG_STREAM_SEND) {
         xqc_qlog_implement(log, TRA_STREAM_STATE_UPDATED, func,
                           "|stream_id:%d|send_stream|old:%d|new:%d|",
@@ -468,10 +531,23 @@ xqc_log_TRA_FRAMES_PROCESSED_callback(xqc_log_t *log, const char *func, ...)
     }
 
     case XQC_FRAME_HANDSHAKE_DONE:
+    case XQC_FRAME_IMMEDIATE_ACK:
         xqc_qlog_implement(log, TRA_FRAMES_PROCESSED, func,
                           "|type:%d|", frame_type);
         break;
 
+    case XQC_FRAME_ACK_FREQUENCY: {
+        uint64_t seq_num = va_arg(args, uint64_t);
+        uint64_t threshold = va_arg(args, uint64_t);
+        uint64_t max_ack_delay = va_arg(args, uint64_t);
+        uint64_t reordering_threshold = va_arg(args, uint64_t);
+        xqc_qlog_implement(log, TRA_FRAMES_PROCESSED, func,
+                          "|type:%d|sequence_number:%ui|ack_eliciting_threshold:%ui|"
+                          "request_max_ack_delay:%ui|reordering_threshold:%ui|",
+                          frame_type, seq_num, threshold, max_ack_delay, reordering_threshold);
+        break;
+    }
+
     /* TODO: add log */
     case XQC_FRAME_RETIRE_CONNECTION_ID:
     case XQC_FRAME_PATH_CHALLENGE:
@@ -494,6 +570,15 @@ xqc_log_TRA_STREAM_DATA_MOVED_callback(xqc_log_t *log, const char *func, xqc_str
                                         xqc_bool_t is_recv, size_t read_or_write_size, size_t recv_buf_size,
                                         uint8_t fin, int ret, int pkt_type, int buff_1rtt, size_t offset)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {stream->stream_id, is_recv,
+                           is_recv ? stream->stream_data_in.next_read_offset
+                                   : stream->stream_send_offset,
+                           is_recv ? read_or_write_size : offset, fin};
+        xqc_log_binlog_write(log, TRA_STREAM_DATA_MOVED, args);
+        return;
+    }
+
     if (is_recv) {
         xqc_qlog_implement(log, TRA_STREAM_DATA_MOVED, func,
                           "|stream_id:%ui|read:%uz|recv_buf_size:%uz|fin:%d|stream_length:%ui|next_read_offset:%ui|conn:%p"
@@ -550,6 +635,13 @@ xqc_log_REC_METRICS_UPDATED_callback(xqc_log_t *log, const char *func, xqc_send_
     int mode = 0;
     xqc_usec_t min_rtt = 0;
 
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {cwnd, send_ctl->ctl_bytes_in_flight, send_ctl->ctl_srtt,
+                           send_ctl->ctl_latest_rtt, send_ctl->ctl_lost_count};
+        xqc_log_binlog_write(log, REC_METRICS_UPDATED, args);
+        return;
+    }
+
     if (send_ctl->ctl_cong_callback->xqc_cong_ctl_init_bbr) {
         bw = send_ctl->ctl_cong_callback->
                 xqc_cong_ctl_get_bandwidth_estimate(send_ctl->ctl_cong);
@@ -587,6 +679,13 @@ xqc_log_REC_LOSS_TIMER_UPDATED_callback(xqc_log_t *log, const char *func,
     if (type != XQC_TIMER_LOSS_DETECTION){
         return ;
     }
+
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {event, timer_manager->timer[type].expire_time, inter_time};
+        xqc_log_binlog_write(log, REC_LOSS_TIMER_UPDATED, args);
+        return;
+    }
+
     if (event == XQC_LOG_TIMER_SET) {
         xqc_qlog_implement(log, REC_LOSS_TIMER_UPDATED, func,
                           "|event_type:set|type:%s|expire:%ui|interv:%ui|",
@@ -607,6 +706,14 @@ void
 xqc_log_REC_PACKET_LOST_callback(xqc_log_t *log, const char *func, xqc_packet_out_t *packet_out, 
                                 xqc_packet_number_t lost_pn, xqc_usec_t lost_send_time, xqc_usec_t loss_delay)
 {
+    if (xqc_log_binlog_enabled(log)) {
+        uint64_t args[] = {packet_out->po_pkt.pkt_num,
+                           (uint64_t)packet_out->po_pkt.pkt_type << 8 | packet_out->po_pkt.pkt_pns,
+                           lost_pn, loss_delay, packet_out->po_path_id};
+        xqc_log_binlog_write(log, REC_PACKET_LOST, args);
+        return;
+    }
+
     xqc_qlog_implement(log, REC_PACKET_LOST, func,
                       "|pkt_pns:%d|pkt_type:%d|pkt_num:%d|lost_pn:%ui|po_sent_time:%ui|"
                       "lost_send_time:%ui|loss_delay:%ui|frame:%s|repair:%d|path_id:%ui|",
@@ -22,9 +22,19 @@ do { \
 #endif
 
 
+#ifdef XQC_ENABLE_ALLOC_COUNT
+/* count of xqc_malloc, xqc_calloc and xqc_realloc calls, not thread safe, used by tests only */
+extern size_t xqc_alloc_count;
+#define xqc_alloc_count_inc() (xqc_alloc_count++)
+#else
+#define xqc_alloc_count_inc()
+#endif
+
+
 #ifdef PRINT_MALLOC
 #define xqc_malloc(size) ({\
     xqc_init_print();\
+    xqc_alloc_count_inc();\
     void *p = malloc((size));\
     fprintf(g_malloc_info_fp, "PRINT_MALLOC %p %zu %s:%d\n", p, (size_t)(size), __FILE__, __LINE__);\
     (p);\
@@ -33,6 +43,7 @@ do { \
 static inline void *
 xqc_malloc(size_t size)
 {
+    xqc_alloc_count_inc();
     return malloc(size);
 }
 #endif
@@ -40,6 +51,7 @@ xqc_malloc(size_t size)
 #ifdef PRINT_MALLOC
 #define xqc_calloc(count, size) ({\
     xqc_init_print();\
+    xqc_alloc_count_inc();\
     void *p = calloc(count, size);\
     fprintf(g_malloc_info_fp, "PRINT_MALLOC %p %zu %s:%d\n", p, size, __FILE__, __LINE__);\
     (p);\
@@ -48,6 +60,7 @@ xqc_malloc(size_t size)
 static inline void *
 xqc_calloc(size_t count, size_t size)
 {
+    xqc_alloc_count_inc();
     return calloc(count, size);
 }
 #endif
@@ -55,6 +68,7 @@ xqc_calloc(size_t count, size_t size)
 #ifdef PRINT_MALLOC
 #define xqc_realloc(ptr, size) ({\
     xqc_init_print();\
+    xqc_alloc_count_inc();\
     void *p = realloc(ptr, size); \
     fprintf(g_malloc_info_fp, "PRINT_FREE %p\n", ptr); \
     fprintf(g_malloc_info_fp, "PRINT_MALLOC %p %zu %s:%d\n", p, size, __FILE__, __LINE__);\
@@ -64,6 +78,7 @@ xqc_calloc(size_t count, size_t size)
 static inline void *
 xqc_realloc(void *ptr, size_t size)
 {
+    xqc_alloc_count_inc();
     return realloc(ptr, size);
 }
 #endif
@@ -23,6 +23,7 @@
 /* Interfaces:
  * xqc_memory_pool_t *xqc_create_pool(size_t size)
  * void xqc_destroy_pool(xqc_memory_pool_t* pool)
+ * void xqc_reset_pool(xqc_memory_pool_t* pool)
  * void* xqc_palloc(xqc_memory_pool_t *pool, size_t size)
  * void* xqc_pnalloc(xqc_memory_pool_t *pool, size_t size)
  * void* xqc_pcalloc(xqc_memory_pool_t *pool, size_t size)
@@ -143,7 +144,7 @@ xqc_create_pool(size_t size)
 }
 
 static inline void
-xqc_destroy_pool(xqc_memory_pool_t *pool)
+xqc_release_pool_chunks(xqc_memory_pool_t *pool)
 {
     xqc_memory_block_t *block = pool->block.next;
     while (block) {
@@ -176,6 +177,25 @@ xqc_destroy_pool(xqc_memory_pool_t *pool)
         xqc_free(p);
 #endif
     }
+}
+
+/* free all blocks except the first one and all large chunks, leaving an empty pool for reuse */
+static inline void
+xqc_reset_pool(xqc_memory_pool_t *pool)
+{
+    xqc_release_pool_chunks(pool);
+
+    pool->block.last = (char *)pool + sizeof(xqc_memory_pool_t);
+    pool->block.failed = 0;
+    pool->block.next = NULL;
+    pool->current = &pool->block;
+    pool->large = NULL;
+}
+
+static inline void
+xqc_destroy_pool(xqc_memory_pool_t *pool)
+{
+    xqc_release_pool_chunks(pool);
 
 #ifdef XQC_PROTECT_POOL_MEM
     if (pool->protect_block) {
@@ -0,0 +1,49 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_PERF_H_INCLUDED_
+#define _XQC_PERF_H_INCLUDED_
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * timing of hot-path stages for xqc_engine_perf_stats_t, compiled in only with
+ * XQC_ENABLE_PERF_TIMING. ticks are cpu cycles on x86-64, counter ticks of the virtual
+ * timer on aarch64, and nanoseconds elsewhere.
+ */
+
+#ifdef XQC_ENABLE_PERF_TIMING
+
+static inline uint64_t
+xqc_perf_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+
+#elif defined(__aarch64__)
+    uint64_t val;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(val));
+    return val;
+
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+#define xqc_perf_timing_begin(t)            uint64_t t = xqc_perf_ticks()
+#define xqc_perf_timing_end(t, counter)     ((counter) += xqc_perf_ticks() - (t))
+
+#else
+
+#define xqc_perf_timing_begin(t)
+#define xqc_perf_timing_end(t, counter)
+
+#endif
+
+#endif /* _XQC_PERF_H_INCLUDED_ */
@@ -0,0 +1,376 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <xquic/xquic.h>
+#include "src/congestion_control/xqc_coupled.h"
+#include "src/common/xqc_time.h"
+#include "src/transport/xqc_packet.h"
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_multipath.h"
+
+/*
+ * LIA:   https://datatracker.ietf.org/doc/html/rfc6356
+ * OLIA:  https://datatracker.ietf.org/doc/html/draft-khalili-mptcp-congestion-control-05
+ * BALIA: https://datatracker.ietf.org/doc/html/draft-walid-mptcp-congestion-control-04
+ *
+ * windows are in bytes, the increase of each algorithm per acked byte is multiplied by MSS,
+ * which makes all of them the same as NewReno congestion avoidance on a single path.
+ */
+
+#define XQC_COUPLED_MSS             XQC_MSS
+#define XQC_COUPLED_MIN_WIN         (2 * XQC_COUPLED_MSS)
+#define XQC_COUPLED_INIT_WIN        (10 * XQC_COUPLED_MSS)
+#define XQC_COUPLED_MAX_INIT_WIN    (100 * XQC_COUPLED_MSS)
+#define XQC_COUPLED_MAX_SSTHRESH    0xffffffff
+
+/* BALIA caps the multiplicative decrease at w * 3/4 */
+#define XQC_COUPLED_BALIA_MAX_BETA  1.5
+
+#define xqc_coupled_max(a, b) ((a) > (b) ? (a) : (b))
+#define xqc_coupled_min(a, b) ((a) < (b) ? (a) : (b))
+
+
+static size_t
+xqc_coupled_size()
+{
+    return sizeof(xqc_coupled_t);
+}
+
+static void
+xqc_coupled_init(void *cong_ctl, xqc_send_ctl_t *ctl_ctx, xqc_cc_params_t cc_params)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)cong_ctl;
+
+    cc->init_cwnd = XQC_COUPLED_INIT_WIN;
+    cc->min_cwnd = XQC_COUPLED_MIN_WIN;
+
+    if (cc_params.customize_on) {
+        cc_params.init_cwnd *= XQC_COUPLED_MSS;
+        cc_params.min_cwnd *= XQC_COUPLED_MSS;
+        cc->init_cwnd =
+                cc_params.init_cwnd >= XQC_COUPLED_MIN_WIN && cc_params.init_cwnd <= XQC_COUPLED_MAX_INIT_WIN ?
+                cc_params.init_cwnd : XQC_COUPLED_INIT_WIN;
+        cc->min_cwnd =
+                cc_params.min_cwnd >= XQC_COUPLED_MIN_WIN && cc_params.min_cwnd <= cc->init_cwnd ?
+                cc_params.min_cwnd : XQC_COUPLED_MIN_WIN;
+    }
+
+    cc->algo = cc_params.coupled_algo <= XQC_COUPLED_BALIA ? cc_params.coupled_algo : XQC_COUPLED_LIA;
+    cc->cwnd = cc->init_cwnd;
+    cc->ssthresh = XQC_COUPLED_MAX_SSTHRESH;
+    cc->cwnd_frac = 0;
+    cc->recovery_start_time = 0;
+    cc->acked_since_loss = 0;
+    cc->acked_between_losses = 0;
+    cc->ctl_ctx = ctl_ctx;
+}
+
+/* smoothed rtt of the path, 0 before its first rtt sample */
+static xqc_usec_t
+xqc_coupled_srtt(xqc_coupled_t *cc)
+{
+    if (cc->ctl_ctx == NULL || cc->ctl_ctx->ctl_first_rtt_sample_time == 0) {
+        return 0;
+    }
+
+    return cc->ctl_ctx->ctl_srtt;
+}
+
+/*
+ * collect instances of coupled congestion control on active paths of the connection, the
+ * instance itself is always the first one. paths without rtt sample are not coupled yet.
+ */
+static int
+xqc_coupled_get_members(xqc_coupled_t *cc, xqc_coupled_t **members)
+{
+    int cnt = 0;
+    xqc_list_head_t *pos, *next;
+    xqc_path_ctx_t *path;
+    xqc_send_ctl_t *ctl;
+    xqc_coupled_t *member;
+
+    members[cnt++] = cc;
+
+    if (cc->ctl_ctx == NULL || cc->ctl_ctx->ctl_conn == NULL) {
+        return cnt;
+    }
+
+    xqc_list_for_each_safe(pos, next, &cc->ctl_ctx->ctl_conn->conn_paths_list) {
+        path = xqc_list_entry(pos, xqc_path_ctx_t, path_list);
+        ctl = path->path_send_ctl;
+        if (path->path_state != XQC_PATH_STATE_ACTIVE || ctl == NULL || ctl->ctl_cong == cc
+            || ctl->ctl_cong_callback == NULL
+            || ctl->ctl_cong_callback->xqc_cong_ctl_on_ack != xqc_coupled_cb.xqc_cong_ctl_on_ack)
+        {
+            continue;
+        }
+
+        member = (xqc_coupled_t *)ctl->ctl_cong;
+        if (xqc_coupled_srtt(member) == 0) {
+            continue;
+        }
+
+        members[cnt++] = member;
+        if (cnt >= XQC_MAX_PATHS_COUNT) {
+            break;
+        }
+    }
+
+    return cnt;
+}
+
+/* LIA: min(alpha * MSS * acked / cwnd_total, MSS * acked / cwnd) */
+static double
+xqc_coupled_lia_increase(xqc_coupled_t *cc, xqc_coupled_t **members, int cnt, uint32_t acked)
+{
+    double total = 0, sum_rate = 0, max_ratio = 0, rtt, alpha, inc;
+
+    for (int i = 0; i < cnt; i++) {
+        rtt = (double)xqc_coupled_srtt(members[i]);
+        total += members[i]->cwnd;
+        sum_rate += members[i]->cwnd / rtt;
+        max_ratio = xqc_coupled_max(max_ratio, members[i]->cwnd / (rtt * rtt));
+    }
+
+    alpha = total * max_ratio / (sum_rate * sum_rate);
+    inc = alpha * XQC_COUPLED_MSS * acked / total;
+
+    return xqc_coupled_min(inc, (double)XQC_COUPLED_MSS * acked / cc->cwnd);
+}
+
+/*
+ * OLIA: MSS * acked * ((w_r / rtt_r^2) / (sum(w_p / rtt_p))^2 + alpha_r / w_r), alpha_r moves
+ * window from paths with the largest window to the presumably best paths which are not.
+ */
+static double
+xqc_coupled_olia_increase(xqc_coupled_t *cc, xqc_coupled_t **members, int cnt, uint32_t acked)
+{
+    int i, max_w_cnt = 0, collected_cnt = 0;
+    int is_best = 0, is_max_w = 0;
+    uint64_t max_w = 0, l;
+    double sum_rate = 0, best_quality = 0, quality, rtt, alpha = 0;
+
+    for (i = 0; i < cnt; i++) {
+        rtt = (double)xqc_coupled_srtt(members[i]);
+        sum_rate += members[i]->cwnd / rtt;
+        max_w = xqc_coupled_max(max_w, members[i]->cwnd);
+
+        l = xqc_coupled_max(members[i]->acked_since_loss, members[i]->acked_between_losses);
+        best_quality = xqc_coupled_max(best_quality, l / (rtt * rtt));
+    }
+
+    for (i = 0; i < cnt; i++) {
+        rtt = (double)xqc_coupled_srtt(members[i]);
+        l = xqc_coupled_max(members[i]->acked_since_loss, members[i]->acked_between_losses);
+        quality = l / (rtt * rtt);
+
+        if (members[i]->cwnd == max_w) {
+            max_w_cnt++;
+            is_max_w |= (members[i] == cc);
+
+        } else if (quality >= best_quality) {
+            /* best paths without the largest window */
+            collected_cnt++;
+            is_best |= (members[i] == cc);
+        }
+    }
+
+    if (collected_cnt > 0) {
+        if (is_best) {
+            alpha = 1.0 / (cnt * collected_cnt);
+
+        } else if (is_max_w) {
+            alpha = -1.0 / (cnt * max_w_cnt);
+        }
+    }
+
+    rtt = (double)xqc_coupled_srtt(cc);
+    return XQC_COUPLED_MSS * (double)acked
+           * ((cc->cwnd / (rtt * rtt)) / (sum_rate * sum_rate) + alpha / cc->cwnd);
+}
+
+/* BALIA: MSS * acked * x_r / (rtt_r * sum(x)^2) * (1 + a_r) / 2 * (4 + a_r) / 5, x = w / rtt */
+static double
+xqc_coupled_balia_alpha(xqc_coupled_t *cc, xqc_coupled_t **members, int cnt, double *sum_rate)
+{
+    double rate, max_rate = 0;
+
+    *sum_rate = 0;
+    for (int i = 0; i < cnt; i++) {
+        rate = members[i]->cwnd / (double)xqc_coupled_srtt(members[i]);
+        *sum_rate += rate;
+        max_rate = xqc_coupled_max(max_rate, rate);
+    }
+
+    return max_rate / (cc->cwnd / (double)xqc_coupled_srtt(cc));
+}
+
+static double
+xqc_coupled_balia_increase(xqc_coupled_t *cc, xqc_coupled_t **members, int cnt, uint32_t acked)
+{
+    double sum_rate, rate, alpha;
+
+    alpha = xqc_coupled_balia_alpha(cc, members, cnt, &sum_rate);
+    rate = cc->cwnd / (double)xqc_coupled_srtt(cc);
+
+    return XQC_COUPLED_MSS * (double)acked * rate
+           / (xqc_coupled_srtt(cc) * sum_rate * sum_rate) * ((1 + alpha) / 2) * ((4 + alpha) / 5);
+}
+
+static int
+xqc_coupled_was_pkt_sent_in_recovery(void *cong_ctl, xqc_usec_t sent_time)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)(cong_ctl);
+    return sent_time <= cc->recovery_start_time;
+}
+
+static void
+xqc_coupled_on_lost(void *cong_ctl, xqc_usec_t lost_sent_time)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)(cong_ctl);
+    xqc_coupled_t *members[XQC_MAX_PATHS_COUNT];
+    double sum_rate, alpha;
+    uint64_t reduction;
+    int cnt;
+
+    /* one window reduction per congestion event */
+    if (xqc_coupled_was_pkt_sent_in_recovery(cong_ctl, lost_sent_time)) {
+        return;
+    }
+
+    cc->recovery_start_time = xqc_monotonic_timestamp();
+    cc->acked_between_losses = cc->acked_since_loss;
+    cc->acked_since_loss = 0;
+    cc->cwnd_frac = 0;
+
+    reduction = cc->cwnd / 2;
+    if (cc->algo == XQC_COUPLED_BALIA && xqc_coupled_srtt(cc) > 0) {
+        cnt = xqc_coupled_get_members(cc, members);
+        alpha = xqc_coupled_balia_alpha(cc, members, cnt, &sum_rate);
+        reduction = cc->cwnd / 2 * xqc_coupled_min(alpha, XQC_COUPLED_BALIA_MAX_BETA);
+    }
+
+    cc->cwnd = cc->cwnd > reduction ? cc->cwnd - reduction : 0;
+    cc->cwnd = xqc_coupled_max(cc->cwnd, cc->min_cwnd);
+    cc->ssthresh = cc->cwnd;
+}
+
+static void
+xqc_coupled_on_ack(void *cong_ctl, xqc_packet_out_t *po, xqc_usec_t now)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)(cong_ctl);
+    xqc_coupled_t *members[XQC_MAX_PATHS_COUNT];
+    xqc_usec_t sent_time = po->po_sent_time;
+    uint32_t acked_bytes = po->po_used_size;
+    double inc;
+    int cnt;
+
+    cc->acked_since_loss += acked_bytes;
+
+    if (xqc_coupled_was_pkt_sent_in_recovery(cong_ctl, sent_time)) {
+        /* do not increase congestion window in recovery period */
+        return;
+    }
+
+    if (sent_time > cc->recovery_start_time) {
+        cc->recovery_start_time = 0;
+    }
+
+    if (cc->ctl_ctx && !xqc_send_ctl_is_cwnd_limited(cc->ctl_ctx)) {
+        return;
+    }
+
+    if (cc->cwnd < cc->ssthresh) {
+        /* slow start on each path is not coupled */
+        cc->cwnd += acked_bytes;
+        return;
+    }
+
+    if (xqc_coupled_srtt(cc) == 0) {
+        cc->cwnd += XQC_COUPLED_MSS * acked_bytes / cc->cwnd;
+        return;
+    }
+
+    cnt = xqc_coupled_get_members(cc, members);
+    switch (cc->algo) {
+    case XQC_COUPLED_OLIA:
+        inc = xqc_coupled_olia_increase(cc, members, cnt, acked_bytes);
+        break;
+    case XQC_COUPLED_BALIA:
+        inc = xqc_coupled_balia_increase(cc, members, cnt, acked_bytes);
+        break;
+    default:
+        inc = xqc_coupled_lia_increase(cc, members, cnt, acked_bytes);
+        break;
+    }
+
+    /* keep fractions of a byte, or the increase would be lost with large windows */
+    inc += cc->cwnd_frac;
+    if (inc >= 0) {
+        cc->cwnd += (uint64_t)inc;
+        cc->cwnd_frac = inc - (uint64_t)inc;
+
+    } else {
+        cc->cwnd_frac = 0;
+        cc->cwnd = cc->cwnd > (uint64_t)(-inc) ? cc->cwnd - (uint64_t)(-inc) : 0;
+        cc->cwnd = xqc_coupled_max(cc->cwnd, cc->min_cwnd);
+    }
+}
+
+static uint64_t
+xqc_coupled_get_cwnd(void *cong_ctl)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)(cong_ctl);
+    return cc->cwnd;
+}
+
+static void
+xqc_coupled_reset_cwnd(void *cong_ctl)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)(cong_ctl);
+    cc->cwnd = cc->min_cwnd;
+    cc->cwnd_frac = 0;
+    cc->recovery_start_time = 0; /* clear recovery epoch. */
+}
+
+static int
+xqc_coupled_in_slow_start(void *cong_ctl)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)(cong_ctl);
+    return cc->cwnd < cc->ssthresh ? 1 : 0;
+}
+
+/* restart window of RFC 5681, arg is the sent time of the last packet before idle */
+static void
+xqc_coupled_restart_from_idle(void *cong_ctl, uint64_t arg)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)(cong_ctl);
+    xqc_usec_t now = xqc_monotonic_timestamp();
+
+    if (cc->ctl_ctx == NULL || now <= arg || now - arg <= xqc_send_ctl_calc_pto(cc->ctl_ctx)) {
+        return;
+    }
+
+    cc->cwnd = xqc_coupled_min(cc->cwnd, cc->init_cwnd);
+    cc->cwnd_frac = 0;
+}
+
+static int
+xqc_coupled_in_recovery(void *cong_ctl)
+{
+    xqc_coupled_t *cc = (xqc_coupled_t *)(cong_ctl);
+    return cc->recovery_start_time > 0;
+}
+
+const xqc_cong_ctrl_callback_t xqc_coupled_cb = {
+    .xqc_cong_ctl_size              = xqc_coupled_size,
+    .xqc_cong_ctl_init              = xqc_coupled_init,
+    .xqc_cong_ctl_on_lost           = xqc_coupled_on_lost,
+    .xqc_cong_ctl_on_ack            = xqc_coupled_on_ack,
+    .xqc_cong_ctl_get_cwnd          = xqc_coupled_get_cwnd,
+    .xqc_cong_ctl_reset_cwnd        = xqc_coupled_reset_cwnd,
+    .xqc_cong_ctl_in_slow_start     = xqc_coupled_in_slow_start,
+    .xqc_cong_ctl_restart_from_idle = xqc_coupled_restart_from_idle,
+    .xqc_cong_ctl_in_recovery       = xqc_coupled_in_recovery,
+};
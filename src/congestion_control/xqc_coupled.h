@@ -0,0 +1,40 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_COUPLED_H_INCLUDED_
+#define _XQC_COUPLED_H_INCLUDED_
+
+#include <xquic/xquic_typedef.h>
+#include <xquic/xquic.h>
+#include "src/transport/xqc_send_ctl.h"
+#include "src/transport/xqc_packet_out.h"
+
+/*
+ * coupled congestion control for multipath. each path has its own instance, and the window
+ * increase in congestion avoidance is computed from the windows and rtts of instances on all
+ * active paths of the connection, with LIA, OLIA or BALIA, so that a multipath connection takes
+ * no more than a single-path flow on its best path at a shared bottleneck. with only one path,
+ * all of them behave as NewReno.
+ */
+typedef struct {
+    xqc_coupled_algo_t  algo;
+
+    uint64_t            cwnd;               /* congestion window in bytes */
+    uint64_t            ssthresh;
+    uint64_t            init_cwnd;
+    uint64_t            min_cwnd;
+    double              cwnd_frac;          /* fraction of window increase less than a byte */
+
+    xqc_usec_t          recovery_start_time;
+
+    /* OLIA: bytes acked since the last loss, and between the last two losses */
+    uint64_t            acked_since_loss;
+    uint64_t            acked_between_losses;
+
+    xqc_send_ctl_t     *ctl_ctx;
+} xqc_coupled_t;
+
+extern const xqc_cong_ctrl_callback_t xqc_coupled_cb;
+
+#endif /* _XQC_COUPLED_H_INCLUDED_ */
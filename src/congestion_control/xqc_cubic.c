@@ -143,6 +143,7 @@ xqc_cubic_init(void *cong_ctl, xqc_send_ctl_t *ctl_ctx, xqc_cc_params_t cc_param
     cubic->last_max_cwnd = cubic->init_cwnd;
     cubic->ssthresh = XQC_CUBIC_MAX_SSTHRESH;
     cubic->congestion_recovery_start_time = 0;
+    xqc_hystart_init(&cubic->hystart, cc_params.hystart_enable);
 }
 
 
@@ -160,6 +161,7 @@ xqc_cubic_on_lost(void *cong_ctl, xqc_usec_t lost_sent_time)
 
     cubic->congestion_recovery_start_time = xqc_monotonic_timestamp();
     cubic->epoch_start = 0;
+    xqc_hystart_reset(&cubic->hystart);
 
     /* should we make room for others */
     if (XQC_CUBIC_FAST_CONVERGENCE && cubic->cwnd < cubic->last_max_cwnd) {
@@ -186,6 +188,7 @@ xqc_cubic_on_ack(void *cong_ctl, xqc_packet_out_t *po, xqc_usec_t now)
     uint32_t    acked_bytes = po->po_used_size;
 
     xqc_usec_t  rtt = now - sent_time;
+    uint32_t    growth_divisor;
 
     if (cubic->min_rtt == 0 || rtt < cubic->min_rtt) {
         cubic->min_rtt = rtt;
@@ -198,8 +201,15 @@ xqc_cubic_on_ack(void *cong_ctl, xqc_packet_out_t *po, xqc_usec_t now)
 
     if (cubic->cwnd < cubic->ssthresh) {
         /* slow start */
-        cubic->tcp_cwnd += acked_bytes;
-        cubic->cwnd += acked_bytes;
+        growth_divisor = xqc_hystart_on_ack(&cubic->hystart, sent_time, rtt, now);
+        if (growth_divisor == 0) {
+            /* rtt keeps increasing, exit slow start before loss */
+            cubic->ssthresh = cubic->cwnd;
+            return;
+        }
+
+        cubic->tcp_cwnd += acked_bytes / growth_divisor;
+        cubic->cwnd += acked_bytes / growth_divisor;
 
     } else {
         /* congestion avoidance */
@@ -227,6 +237,7 @@ xqc_cubic_reset_cwnd(void *cong_ctl)
     cubic->cwnd = cubic->min_cwnd;
     cubic->tcp_cwnd = cubic->min_cwnd;
     cubic->last_max_cwnd = cubic->min_cwnd;
+    xqc_hystart_reset(&cubic->hystart);
 }
 
 int32_t
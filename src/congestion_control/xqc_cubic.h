@@ -9,6 +9,7 @@
 #include <xquic/xquic.h>
 #include "src/transport/xqc_send_ctl.h"
 #include "src/transport/xqc_packet_out.h"
+#include "src/congestion_control/xqc_hystart.h"
 
 typedef struct {
     uint32_t        min_cwnd;
@@ -23,6 +24,7 @@ typedef struct {
     xqc_usec_t      epoch_start;        /* the moment when congestion switchover begins, in microseconds */
     xqc_usec_t      min_rtt;
     xqc_usec_t      congestion_recovery_start_time;
+    xqc_hystart_t   hystart;            /* HyStart++ slow start exit */
 } xqc_cubic_t;
 
 extern const xqc_cong_ctrl_callback_t xqc_cubic_cb;
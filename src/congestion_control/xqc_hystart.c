@@ -0,0 +1,89 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "src/congestion_control/xqc_hystart.h"
+#include "src/common/xqc_config.h"
+
+#define XQC_HYSTART_MIN_RTT_THRESH      4000    /* 4ms */
+#define XQC_HYSTART_MAX_RTT_THRESH      16000   /* 16ms */
+#define XQC_HYSTART_MIN_RTT_DIVISOR     8
+#define XQC_HYSTART_N_RTT_SAMPLE        8
+#define XQC_HYSTART_CSS_GROWTH_DIVISOR  4
+#define XQC_HYSTART_CSS_ROUNDS          5
+#define XQC_HYSTART_INFINITE_RTT        XQC_MAX_UINT64_VALUE
+
+
+void
+xqc_hystart_init(xqc_hystart_t *hystart, uint8_t enabled)
+{
+    hystart->enabled = enabled;
+    xqc_hystart_reset(hystart);
+}
+
+
+void
+xqc_hystart_reset(xqc_hystart_t *hystart)
+{
+    hystart->in_css = 0;
+    hystart->css_rounds = 0;
+    hystart->rtt_sample_cnt = 0;
+    hystart->window_end = 0;
+    hystart->last_round_min_rtt = XQC_HYSTART_INFINITE_RTT;
+    hystart->current_round_min_rtt = XQC_HYSTART_INFINITE_RTT;
+    hystart->css_baseline_min_rtt = XQC_HYSTART_INFINITE_RTT;
+}
+
+
+uint32_t
+xqc_hystart_on_ack(xqc_hystart_t *hystart, xqc_usec_t sent_time, xqc_usec_t rtt,
+    xqc_usec_t now)
+{
+    xqc_usec_t rtt_thresh;
+
+    if (!hystart->enabled) {
+        return 1;
+    }
+
+    /* start of a new round */
+    if (sent_time >= hystart->window_end) {
+        hystart->window_end = now;
+        hystart->last_round_min_rtt = hystart->current_round_min_rtt;
+        hystart->current_round_min_rtt = XQC_HYSTART_INFINITE_RTT;
+        hystart->rtt_sample_cnt = 0;
+
+        if (hystart->in_css && ++hystart->css_rounds >= XQC_HYSTART_CSS_ROUNDS) {
+            /* enter congestion avoidance */
+            hystart->in_css = 0;
+            return 0;
+        }
+    }
+
+    hystart->current_round_min_rtt = xqc_min(hystart->current_round_min_rtt, rtt);
+    hystart->rtt_sample_cnt++;
+
+    if (hystart->rtt_sample_cnt < XQC_HYSTART_N_RTT_SAMPLE
+        || hystart->current_round_min_rtt == XQC_HYSTART_INFINITE_RTT
+        || hystart->last_round_min_rtt == XQC_HYSTART_INFINITE_RTT)
+    {
+        return hystart->in_css ? XQC_HYSTART_CSS_GROWTH_DIVISOR : 1;
+    }
+
+    if (!hystart->in_css) {
+        rtt_thresh = hystart->last_round_min_rtt / XQC_HYSTART_MIN_RTT_DIVISOR;
+        rtt_thresh = xqc_max(XQC_HYSTART_MIN_RTT_THRESH, xqc_min(rtt_thresh, XQC_HYSTART_MAX_RTT_THRESH));
+
+        if (hystart->current_round_min_rtt >= hystart->last_round_min_rtt + rtt_thresh) {
+            hystart->in_css = 1;
+            hystart->css_rounds = 0;
+            hystart->css_baseline_min_rtt = hystart->current_round_min_rtt;
+        }
+
+    } else if (hystart->current_round_min_rtt < hystart->css_baseline_min_rtt) {
+        /* the rtt increase was spurious, resume slow start */
+        hystart->in_css = 0;
+        hystart->css_baseline_min_rtt = XQC_HYSTART_INFINITE_RTT;
+    }
+
+    return hystart->in_css ? XQC_HYSTART_CSS_GROWTH_DIVISOR : 1;
+}
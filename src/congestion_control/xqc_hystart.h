@@ -0,0 +1,46 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ *
+ * HyStart++ based on https://datatracker.ietf.org/doc/html/rfc9406
+ */
+
+#ifndef _XQC_HYSTART_H_INCLUDED_
+#define _XQC_HYSTART_H_INCLUDED_
+
+#include <xquic/xquic_typedef.h>
+#include <xquic/xquic.h>
+
+/*
+ * slow start exit by rtt increase. a round ends when a packet sent after the start of the
+ * round is acked. when the min rtt of a round grows noticeably over the last one, slow start
+ * turns into Conservative Slow Start, which grows the window by 1/CSS_GROWTH_DIVISOR. slow
+ * start resumes if the rtt drops back, otherwise it exits after CSS_ROUNDS rounds.
+ */
+typedef struct {
+    uint8_t         enabled;
+    uint8_t         in_css;
+    uint32_t        css_rounds;
+    uint32_t        rtt_sample_cnt;
+    xqc_usec_t      window_end;             /* packets sent after this moment are of next round */
+    xqc_usec_t      last_round_min_rtt;
+    xqc_usec_t      current_round_min_rtt;
+    xqc_usec_t      css_baseline_min_rtt;
+} xqc_hystart_t;
+
+void xqc_hystart_init(xqc_hystart_t *hystart, uint8_t enabled);
+
+/*
+ * forget the rounds and Conservative Slow Start of the last slow start, on loss and on collapse
+ * of the window, so that a later slow start measures its rtt increase from scratch.
+ */
+void xqc_hystart_reset(xqc_hystart_t *hystart);
+
+/**
+ * @brief feed an acked packet in slow start
+ * @return the divisor of window growth, 1 in slow start, CSS_GROWTH_DIVISOR in Conservative
+ * Slow Start, or 0 if slow start shall exit
+ */
+uint32_t xqc_hystart_on_ack(xqc_hystart_t *hystart, xqc_usec_t sent_time, xqc_usec_t rtt,
+    xqc_usec_t now);
+
+#endif /* _XQC_HYSTART_H_INCLUDED_ */
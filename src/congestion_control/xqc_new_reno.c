@@ -35,6 +35,7 @@ xqc_reno_init(void *cong_ctl, xqc_send_ctl_t *ctl_ctx, xqc_cc_params_t cc_params
     reno->reno_ssthresh = 0xffffffff;
     reno->reno_recovery_start_time = 0;
     reno->ctl_ctx = ctl_ctx;
+    xqc_hystart_init(&reno->reno_hystart, cc_params.hystart_enable);
 }
 
 /**
@@ -61,6 +62,7 @@ xqc_reno_on_lost(void *cong_ctl, xqc_usec_t lost_sent_time)
         reno->reno_congestion_window *= XQC_kLossReductionFactor;
         reno->reno_congestion_window = xqc_max(reno->reno_congestion_window, XQC_kMinimumWindow);
         reno->reno_ssthresh = reno->reno_congestion_window;
+        xqc_hystart_reset(&reno->reno_hystart);
     }
 }
 
@@ -70,6 +72,7 @@ xqc_reno_on_ack(void *cong_ctl, xqc_packet_out_t *po, xqc_usec_t now)
     xqc_new_reno_t *reno = (xqc_new_reno_t*)(cong_ctl);
     xqc_usec_t sent_time = po->po_sent_time;
     uint32_t acked_bytes = po->po_used_size;
+    uint32_t growth_divisor;
     if (xqc_reno_was_pkt_sent_in_recovery(cong_ctl, sent_time)) {
         /* Do not increase congestion window in recovery period. */
         return;
@@ -85,7 +88,13 @@ xqc_reno_on_ack(void *cong_ctl, xqc_packet_out_t *po, xqc_usec_t now)
 
     if (reno->reno_congestion_window < reno->reno_ssthresh) {
         /* Slow start. */
-        reno->reno_congestion_window += acked_bytes;
+        growth_divisor = xqc_hystart_on_ack(&reno->reno_hystart, sent_time, now - sent_time, now);
+        if (growth_divisor == 0) {
+            /* HyStart++ exits slow start on rtt increase. */
+            reno->reno_ssthresh = reno->reno_congestion_window;
+            return;
+        }
+        reno->reno_congestion_window += acked_bytes / growth_divisor;
     }
     else {
         /* Congestion avoidance. */
@@ -106,6 +115,7 @@ xqc_reno_reset_cwnd(void *cong_ctl)
     xqc_new_reno_t *reno = (xqc_new_reno_t*)(cong_ctl);
     reno->reno_congestion_window = XQC_kMinimumWindow;
     reno->reno_recovery_start_time  = 0; /* clear recovery epoch. */
+    xqc_hystart_reset(&reno->reno_hystart);
 }
 
 int
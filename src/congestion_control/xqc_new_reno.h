@@ -9,11 +9,13 @@
 #include <xquic/xquic.h>
 #include "src/transport/xqc_send_ctl.h"
 #include "src/transport/xqc_packet_out.h"
+#include "src/congestion_control/xqc_hystart.h"
 
 typedef struct {
     unsigned        reno_congestion_window;
     unsigned        reno_ssthresh;
     xqc_usec_t      reno_recovery_start_time;
+    xqc_hystart_t   reno_hystart;
     xqc_send_ctl_t *ctl_ctx;
 } xqc_new_reno_t;
 
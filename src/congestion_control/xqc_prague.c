@@ -0,0 +1,320 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ *
+ * Prague congestion control based on
+ * https://datatracker.ietf.org/doc/html/draft-briscoe-iccrg-prague-congestion-control
+ */
+
+#include "src/congestion_control/xqc_prague.h"
+#include "src/common/xqc_config.h"
+#include "src/common/xqc_time.h"
+
+#define XQC_PRAGUE_MSS              XQC_MSS
+#define XQC_PRAGUE_ALPHA_SCALE      1024
+#define XQC_PRAGUE_G_SHIFT          4           /* gain of alpha EWMA, g = 1/16 */
+#define XQC_PRAGUE_VIRTUAL_RTT      25000       /* 25ms, rtt independence below it */
+#define XQC_PRAGUE_AI_SCALE         1024
+
+/* smoothed rtt of the path, 0 before its first rtt sample */
+static xqc_usec_t
+xqc_prague_srtt(xqc_prague_t *prague)
+{
+    if (prague->ctl_ctx == NULL || prague->ctl_ctx->ctl_first_rtt_sample_time == 0) {
+        return 0;
+    }
+
+    return prague->ctl_ctx->ctl_srtt;
+}
+
+/*
+ * scale of additive increase. a flow with rtt R below the virtual rtt grows (R/R_virt)^2 MSS
+ * per round instead of 1 MSS, which increases its rate W/R as fast per unit of time as a flow
+ * with the virtual rtt, hence flows with short rtts don't starve the others on a shallow queue.
+ */
+static uint64_t
+xqc_prague_ai_scale(xqc_prague_t *prague)
+{
+    xqc_usec_t srtt = xqc_prague_srtt(prague);
+
+    if (srtt == 0 || srtt >= XQC_PRAGUE_VIRTUAL_RTT) {
+        return XQC_PRAGUE_AI_SCALE;
+    }
+
+    return xqc_max(srtt * srtt * XQC_PRAGUE_AI_SCALE
+                   / XQC_PRAGUE_VIRTUAL_RTT / XQC_PRAGUE_VIRTUAL_RTT, 1);
+}
+
+/* scalable control is used only after ECN is validated on the path */
+static void
+xqc_prague_update_mode(xqc_prague_t *prague)
+{
+    xqc_cubic_t *cubic = &prague->cubic;
+    uint8_t scalable = prague->ctl_ctx != NULL
+                       && prague->ctl_ctx->ctl_ecn_state == XQC_ECN_STATE_CAPABLE;
+
+    if (scalable == prague->scalable) {
+        return;
+    }
+
+    /* take over the window of the other mode */
+    if (scalable) {
+        prague->cwnd = cubic->cwnd;
+        prague->ssthresh = cubic->ssthresh;
+        prague->cwnd_cnt = 0;
+        prague->round_start = prague->last_ack_time;
+        prague->round_acked = 0;
+        prague->round_ce = 0;
+
+    } else {
+        cubic->cwnd = prague->cwnd;
+        cubic->tcp_cwnd = prague->cwnd;
+        cubic->tcp_cwnd_cnt = 0;
+        cubic->last_max_cwnd = prague->cwnd;
+        cubic->ssthresh = prague->ssthresh;
+        cubic->epoch_start = 0;
+    }
+
+    prague->scalable = scalable;
+}
+
+/* alpha = (1 - g) * alpha + g * F, with F the fraction of CE marked packets in the last round */
+static void
+xqc_prague_update_alpha(xqc_prague_t *prague)
+{
+    uint64_t frac = 0;
+
+    if (prague->round_acked > 0) {
+        frac = xqc_min(prague->round_ce, prague->round_acked) * XQC_PRAGUE_ALPHA_SCALE
+               / prague->round_acked;
+    }
+
+    prague->alpha = prague->alpha - (prague->alpha >> XQC_PRAGUE_G_SHIFT)
+                    + (frac >> XQC_PRAGUE_G_SHIFT);
+    prague->round_acked = 0;
+    prague->round_ce = 0;
+}
+
+/* reduce the window by alpha / 2, at most once per round trip */
+static void
+xqc_prague_reduce(xqc_prague_t *prague, xqc_usec_t sent_time, uint32_t alpha)
+{
+    if (sent_time <= prague->cwr_start_time) {
+        return;
+    }
+
+    prague->cwr_start_time = xqc_max(prague->last_ack_time, sent_time);
+    prague->in_cwr = 1;
+    prague->cwnd -= prague->cwnd * alpha / (2 * XQC_PRAGUE_ALPHA_SCALE);
+    prague->cwnd = xqc_max(prague->cwnd, prague->min_cwnd);
+    prague->ssthresh = prague->cwnd;
+    prague->cwnd_cnt = 0;
+}
+
+static size_t
+xqc_prague_size()
+{
+    return sizeof(xqc_prague_t);
+}
+
+static void
+xqc_prague_init(void *cong_ctl, xqc_send_ctl_t *ctl_ctx, xqc_cc_params_t cc_params)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+
+    xqc_cubic_cb.xqc_cong_ctl_init(&prague->cubic, ctl_ctx, cc_params);
+
+    prague->ctl_ctx = ctl_ctx;
+    prague->scalable = 0;
+    prague->cwnd = prague->cubic.cwnd;
+    prague->ssthresh = prague->cubic.ssthresh;
+    prague->min_cwnd = prague->cubic.min_cwnd;
+    prague->cwnd_cnt = 0;
+    prague->alpha = XQC_PRAGUE_ALPHA_SCALE;
+    prague->round_start = 0;
+    prague->round_acked = 0;
+    prague->round_ce = 0;
+    prague->last_ack_time = 0;
+    prague->cwr_start_time = 0;
+    prague->in_cwr = 0;
+}
+
+static void
+xqc_prague_on_lost(void *cong_ctl, xqc_usec_t lost_sent_time)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+
+    xqc_prague_update_mode(prague);
+    if (!prague->scalable) {
+        xqc_cubic_cb.xqc_cong_ctl_on_lost(&prague->cubic, lost_sent_time);
+        return;
+    }
+
+    /* loss is still a classic congestion signal, halve the window as Reno (RFC 9331) */
+    xqc_prague_reduce(prague, lost_sent_time, XQC_PRAGUE_ALPHA_SCALE);
+}
+
+static void
+xqc_prague_on_ecn_ce(void *cong_ctl, xqc_usec_t largest_acked_sent_time, uint64_t ce_delta,
+    uint64_t acked_delta)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+
+    xqc_prague_update_mode(prague);
+    if (!prague->scalable) {
+        xqc_cubic_cb.xqc_cong_ctl_on_lost(&prague->cubic, largest_acked_sent_time);
+        return;
+    }
+
+    prague->round_ce += ce_delta;
+    xqc_prague_reduce(prague, largest_acked_sent_time, prague->alpha);
+}
+
+static void
+xqc_prague_on_ack(void *cong_ctl, xqc_packet_out_t *po, xqc_usec_t now)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+    xqc_usec_t sent_time = po->po_sent_time;
+
+    prague->last_ack_time = now;
+
+    xqc_prague_update_mode(prague);
+    if (!prague->scalable) {
+        xqc_cubic_cb.xqc_cong_ctl_on_ack(&prague->cubic, po, now);
+        return;
+    }
+
+    prague->round_acked++;
+    if (sent_time > prague->round_start) {
+        xqc_prague_update_alpha(prague);
+        prague->round_start = now;
+    }
+
+    /* Do not increase congestion window in the round trip after a reduction. */
+    if (sent_time <= prague->cwr_start_time) {
+        return;
+    }
+    prague->in_cwr = 0;
+
+    if (prague->cwnd < prague->ssthresh) {
+        prague->cwnd += po->po_used_size;
+        return;
+    }
+
+    /* congestion avoidance, increase by the scaled MSS per round trip */
+    prague->cwnd_cnt += po->po_used_size * xqc_prague_ai_scale(prague);
+    if (prague->cwnd_cnt >= prague->cwnd * XQC_PRAGUE_AI_SCALE) {
+        prague->cwnd_cnt -= prague->cwnd * XQC_PRAGUE_AI_SCALE;
+        prague->cwnd += XQC_PRAGUE_MSS;
+    }
+}
+
+static uint64_t
+xqc_prague_get_cwnd(void *cong_ctl)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+    return prague->scalable ? prague->cwnd : prague->cubic.cwnd;
+}
+
+static void
+xqc_prague_reset_cwnd(void *cong_ctl)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+
+    xqc_cubic_cb.xqc_cong_ctl_reset_cwnd(&prague->cubic);
+    prague->cwnd = prague->min_cwnd;
+    prague->cwnd_cnt = 0;
+}
+
+static int
+xqc_prague_in_slow_start(void *cong_ctl)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+
+    if (!prague->scalable) {
+        return xqc_cubic_cb.xqc_cong_ctl_in_slow_start(&prague->cubic);
+    }
+    return prague->cwnd < prague->ssthresh ? 1 : 0;
+}
+
+/*
+ * the window was not validated while idle, restart from at most the initial window if the
+ * path was idle for longer than a PTO (RFC 9002, Section 7.8)
+ */
+static void
+xqc_prague_restart_from_idle(void *cong_ctl, uint64_t last_sent_time)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+    xqc_usec_t now = xqc_monotonic_timestamp();
+
+    xqc_prague_update_mode(prague);
+    if (!prague->scalable) {
+        xqc_cubic_cb.xqc_cong_ctl_restart_from_idle(&prague->cubic, last_sent_time);
+        return;
+    }
+
+    if (last_sent_time == 0 || now < last_sent_time
+        || now - last_sent_time <= xqc_send_ctl_calc_pto(prague->ctl_ctx))
+    {
+        return;
+    }
+
+    prague->cwnd = xqc_min(prague->cwnd, prague->cubic.init_cwnd);
+    prague->cwnd_cnt = 0;
+
+    /* CE marks of packets sent before the idle period say nothing about the queue now */
+    prague->round_start = now;
+    prague->round_acked = 0;
+    prague->round_ce = 0;
+}
+
+/* the window is in CWR after a reduction, until a packet sent after it is acked */
+static int
+xqc_prague_in_recovery(void *cong_ctl)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+
+    if (!prague->scalable) {
+        return xqc_cubic_cb.xqc_cong_ctl_in_recovery(&prague->cubic);
+    }
+    return prague->in_cwr;
+}
+
+/*
+ * pace the window over srtt, with the same gains as xqc_pacing_rate_calc. scalable flows keep
+ * a queue of about one ms, bursts at line rate would build it up with every window.
+ */
+static uint32_t
+xqc_prague_get_pacing_rate(void *cong_ctl)
+{
+    xqc_prague_t *prague = (xqc_prague_t *)(cong_ctl);
+    xqc_usec_t srtt = xqc_prague_srtt(prague);
+    uint64_t pacing_rate;
+
+    if (srtt == 0) {
+        srtt = XQC_kInitialRtt_us;
+    }
+    pacing_rate = xqc_prague_get_cwnd(cong_ctl) * 1000000 / srtt;
+
+    if (xqc_prague_in_slow_start(cong_ctl)) {
+        pacing_rate *= 2;
+
+    } else {
+        pacing_rate = pacing_rate * 12 / 10;
+    }
+
+    return xqc_min(pacing_rate, UINT32_MAX);
+}
+
+const xqc_cong_ctrl_callback_t xqc_prague_cb = {
+    .xqc_cong_ctl_size              = xqc_prague_size,
+    .xqc_cong_ctl_init              = xqc_prague_init,
+    .xqc_cong_ctl_on_lost           = xqc_prague_on_lost,
+    .xqc_cong_ctl_on_ack            = xqc_prague_on_ack,
+    .xqc_cong_ctl_get_cwnd          = xqc_prague_get_cwnd,
+    .xqc_cong_ctl_reset_cwnd        = xqc_prague_reset_cwnd,
+    .xqc_cong_ctl_in_slow_start     = xqc_prague_in_slow_start,
+    .xqc_cong_ctl_restart_from_idle = xqc_prague_restart_from_idle,
+    .xqc_cong_ctl_in_recovery       = xqc_prague_in_recovery,
+    .xqc_cong_ctl_get_pacing_rate   = xqc_prague_get_pacing_rate,
+    .xqc_cong_ctl_on_ecn_ce         = xqc_prague_on_ecn_ce,
+};
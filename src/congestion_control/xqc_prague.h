@@ -0,0 +1,43 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_PRAGUE_H_INCLUDED_
+#define _XQC_PRAGUE_H_INCLUDED_
+
+#include <xquic/xquic_typedef.h>
+#include <xquic/xquic.h>
+#include "src/transport/xqc_send_ctl.h"
+#include "src/transport/xqc_packet_out.h"
+#include "src/congestion_control/xqc_cubic.h"
+
+/*
+ * L4S Prague congestion control (RFC 9331, draft-briscoe-iccrg-prague-congestion-control).
+ * once ECN is validated on the path, the window is reduced in proportion to the fraction of
+ * CE marked packets like DCTCP, and the additive increase is scaled by the rtt relative to a
+ * virtual rtt, so flows with short rtts don't take over the bottleneck. until then, or if ECN
+ * fails, the window is driven by the embedded Cubic instance.
+ */
+typedef struct {
+    xqc_cubic_t         cubic;              /* classic fallback without validated ECN */
+    xqc_send_ctl_t     *ctl_ctx;
+    uint8_t             scalable;           /* ECN validated, scalable window control */
+
+    uint64_t            cwnd;               /* congestion window in bytes */
+    uint64_t            ssthresh;
+    uint64_t            min_cwnd;
+    uint64_t            cwnd_cnt;           /* scaled bytes acked towards the next MSS of increase */
+
+    uint32_t            alpha;              /* EWMA of CE marked fraction, scaled by 1024 */
+    xqc_usec_t          round_start;        /* a round ends when a packet sent after it is acked */
+    uint64_t            round_acked;        /* packets acked in this round */
+    uint64_t            round_ce;           /* packets CE marked in this round */
+
+    xqc_usec_t          last_ack_time;
+    xqc_usec_t          cwr_start_time;     /* packets sent before don't reduce window again */
+    uint8_t             in_cwr;             /* no packet sent after cwr_start_time is acked yet */
+} xqc_prague_t;
+
+extern const xqc_cong_ctrl_callback_t xqc_prague_cb;
+
+#endif /* _XQC_PRAGUE_H_INCLUDED_ */
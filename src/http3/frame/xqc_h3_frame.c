@@ -47,6 +47,10 @@ xqc_h3_frm_reset_pctx(xqc_h3_frame_pctx_t *pctx)
         break;
     case XQC_H3_EXT_FRM_BIDI_STREAM_TYPE:
         break;
+    case XQC_H3_FRM_PRIORITY_UPDATE_REQUEST:
+    case XQC_H3_FRM_PRIORITY_UPDATE_PUSH:
+        xqc_var_buf_free(pctx->frame.frame_payload.priority_update.priority_field_value);
+        break;
     case XQC_H3_FRM_UNKNOWN:
         break;
     }
@@ -163,6 +167,44 @@ xqc_h3_ext_frm_parse_bidi_stream_type(const unsigned char *p, size_t sz, xqc_h3_
     return pos - p;
 }
 
+ssize_t
+xqc_h3_frm_parse_priority_update(const unsigned char *p, size_t sz, xqc_h3_frame_t *frame, xqc_bool_t *fin)
+{
+    const unsigned char *pos = p;
+    *fin = XQC_FALSE;
+    xqc_bool_t fin_t;
+    xqc_h3_frame_priority_update_t *priority_update = &frame->frame_payload.priority_update;
+    if (priority_update->count == 0 && sz > 0) {
+        XQC_H3_DECODE_DISCRETE_VINT_VALUE(pos, sz, priority_update->prioritized_element_id, &fin_t);
+        if (fin_t) {
+            priority_update->count = 1;
+        }
+    }
+    if (priority_update->count == 1) {
+        size_t id_len = xqc_vint_len_by_val(priority_update->prioritized_element_id.vi);
+        if (frame->len < id_len) {
+            return -XQC_EVINTREAD;
+        }
+        size_t payload_len = frame->len - id_len;
+        if (priority_update->priority_field_value == NULL) {
+            /* one more byte for NUL terminator, priority field value is parsed as string */
+            priority_update->priority_field_value =
+                xqc_var_buf_create(xqc_min(payload_len, XQC_VAR_BUF_INIT_SIZE) + 1);
+            if (priority_update->priority_field_value == NULL) {
+                return -XQC_H3_EMALLOC;
+            }
+        }
+        size_t len = xqc_min(sz, payload_len - priority_update->priority_field_value->data_len);
+        xqc_int_t ret = xqc_var_buf_save_data(priority_update->priority_field_value, pos, len);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+        pos += len;
+        *fin = priority_update->priority_field_value->data_len == payload_len ? XQC_TRUE : XQC_FALSE;
+    }
+    return pos - p;
+}
+
 ssize_t
 xqc_h3_frm_parse_reserved(const unsigned char *p, size_t sz,
     xqc_h3_frame_t *frame, xqc_bool_t *fin)
@@ -257,6 +299,11 @@ xqc_h3_frm_parse(const unsigned char *p, size_t sz, xqc_h3_frame_pctx_t *pctx)
             XQC_H3_DECODE_FRM(xqc_h3_ext_frm_parse_bidi_stream_type, pos, sz, pctx->frame, &fin);
             break;
         }
+        case XQC_H3_FRM_PRIORITY_UPDATE_REQUEST:
+        case XQC_H3_FRM_PRIORITY_UPDATE_PUSH: {
+            XQC_H3_DECODE_FRM(xqc_h3_frm_parse_priority_update, pos, sz, pctx->frame, &fin);
+            break;
+        }
         default: {
             XQC_H3_DECODE_FRM(xqc_h3_frm_parse_reserved, pos, sz, pctx->frame, &fin);
             break;
@@ -334,6 +381,24 @@ xqc_h3_frm_write_headers(xqc_list_head_t *send_buf, xqc_var_buf_t *encoded_field
     return XQC_OK;
 }
 
+xqc_int_t
+xqc_h3_frm_write_headers_hdr(xqc_var_buf_t *buf)
+{
+    size_t efs_len = buf->data_len - buf->consumed_len;
+    size_t hdr_len = xqc_put_varint_len(XQC_H3_FRM_HEADERS) + xqc_put_varint_len(efs_len);
+    if (hdr_len > buf->consumed_len) {
+        return -XQC_ENOBUF;
+    }
+
+    buf->consumed_len -= hdr_len;
+
+    unsigned char *pos = buf->data + buf->consumed_len;
+    pos = xqc_put_varint(pos, XQC_H3_FRM_HEADERS);
+    xqc_put_varint(pos, efs_len);
+
+    return XQC_OK;
+}
+
 xqc_int_t
 xqc_h3_frm_write_data(xqc_list_head_t *send_buf, unsigned char *data, size_t size, uint8_t fin)
 {
@@ -529,6 +594,40 @@ xqc_h3_frm_write_max_push_id(xqc_list_head_t *send_buf, uint64_t push_id, uint8_
     return XQC_OK;
 }
 
+xqc_int_t
+xqc_h3_frm_write_priority_update(xqc_list_head_t *send_buf, uint64_t element_id,
+    const unsigned char *field_value, size_t field_value_len, uint8_t fin)
+{
+    size_t len = xqc_put_varint_len(element_id) + field_value_len;
+    xqc_var_buf_t *buf = xqc_var_buf_create(xqc_put_varint_len(XQC_H3_FRM_PRIORITY_UPDATE_REQUEST)
+                                            + xqc_put_varint_len(len)
+                                            + len);
+    if (buf == NULL) {
+        return -XQC_EMALLOC;
+    }
+
+    unsigned char *pos = buf->data;
+    pos = xqc_put_varint(pos, XQC_H3_FRM_PRIORITY_UPDATE_REQUEST);
+    pos = xqc_put_varint(pos, len);
+    pos = xqc_put_varint(pos, element_id);
+    buf->data_len = pos - buf->data;
+    buf->fin_flag = fin;
+
+    xqc_int_t ret = xqc_var_buf_save_data(buf, field_value, field_value_len);
+    if (ret != XQC_OK) {
+        xqc_var_buf_free(buf);
+        return ret;
+    }
+
+    ret = xqc_list_buf_to_tail(send_buf, buf);
+    if (ret != XQC_OK) {
+        xqc_var_buf_free(buf);
+        return ret;
+    }
+
+    return XQC_OK;
+}
+
 xqc_int_t 
 xqc_h3_ext_frm_write_bidi_stream_type(xqc_list_head_t *send_buf, 
     uint64_t stream_type, uint8_t fin)
@@ -17,6 +17,7 @@ typedef union xqc_h3_frame_payload_s {
     xqc_h3_frame_goaway_t               goaway;
     xqc_h3_frame_max_push_id_t          max_push_id;
     xqc_h3_ext_frame_bidi_stream_type_t stream_type;
+    xqc_h3_frame_priority_update_t      priority_update;
 } xqc_h3_frame_pl_t;
 
 
@@ -72,6 +73,18 @@ ssize_t xqc_h3_frm_parse_setting(xqc_var_buf_t *data, void *user_data);
 xqc_int_t xqc_h3_frm_write_headers(xqc_list_head_t *send_buf, xqc_var_buf_t *encoded_field_section,
     uint8_t fin);
 
+/**
+ * max length of HEADERS frame type and length, which shall be reserved in front of encoded
+ * field section for xqc_h3_frm_write_headers_hdr
+ */
+#define XQC_H3_FRM_HEADERS_HDR_MAX_LEN  (1 + 8)
+
+/**
+ * write HEADERS frame type and length right before the encoded field section, which starts
+ * from buf->consumed_len, and move buf->consumed_len to the beginning of the frame
+ */
+xqc_int_t xqc_h3_frm_write_headers_hdr(xqc_var_buf_t *buf);
+
 xqc_int_t xqc_h3_frm_write_data(xqc_list_head_t *send_buf, unsigned char *data, size_t size,
     uint8_t fin);
 
@@ -87,6 +100,9 @@ xqc_int_t xqc_h3_frm_write_goaway(xqc_list_head_t *send_buf, uint64_t push_id, u
 
 xqc_int_t xqc_h3_frm_write_max_push_id(xqc_list_head_t *send_buf, uint64_t push_id, uint8_t fin);
 
+xqc_int_t xqc_h3_frm_write_priority_update(xqc_list_head_t *send_buf, uint64_t element_id,
+    const unsigned char *field_value, size_t field_value_len, uint8_t fin);
+
 xqc_int_t xqc_h3_ext_frm_write_bidi_stream_type(xqc_list_head_t *send_buf, uint64_t stream_type, uint8_t fin);
 
 void xqc_h3_frm_reset_pctx(xqc_h3_frame_pctx_t *pctx);
@@ -20,6 +20,10 @@ typedef enum xqc_h3_frm_type_s {
     /* extension */
     XQC_H3_EXT_FRM_BIDI_STREAM_TYPE = 0x20,
 
+    /* RFC 9218 */
+    XQC_H3_FRM_PRIORITY_UPDATE_REQUEST  = 0xf0700,
+    XQC_H3_FRM_PRIORITY_UPDATE_PUSH     = 0xf0701,
+
     XQC_H3_FRM_UNKNOWN              = UINT64_MAX,
 } xqc_h3_frm_type_t;
 
@@ -61,6 +65,12 @@ typedef struct xqc_h3_frm_max_push_id_t {
     xqc_discrete_int_pctx_t push_id;
 } xqc_h3_frame_max_push_id_t;
 
+typedef struct xqc_h3_frm_priority_update_s {
+    xqc_discrete_int_pctx_t  prioritized_element_id;
+    xqc_var_buf_t           *priority_field_value;
+    uint8_t                  count;
+} xqc_h3_frame_priority_update_t;
+
 typedef struct xqc_h3_ext_frm_bidi_stream_type_s {
     xqc_discrete_int_pctx_t stream_type;
 } xqc_h3_ext_frame_bidi_stream_type_t;
@@ -5,11 +5,17 @@
 #include "src/http3/qpack/xqc_encoder.h"
 #include "src/http3/qpack/xqc_ins.h"
 #include "src/http3/qpack/xqc_rep.h"
+#include "src/http3/qpack/xqc_hdr_tmpl.h"
+#include "src/common/utils/cm_sketch/xqc_cm_sketch.h"
+#include "src/common/xqc_hash.h"
 
 
 double xqc_encoder_insert_limit_name = 1.0 / 16;
 double xqc_encoder_insert_limit_entry = 3.0 / 4;
 
+/* counters in each row of frequency sketch, 4KB in total */
+#define XQC_ENCODER_FREQ_SKETCH_WIDTH   1024
+
 typedef struct xqc_encoder_s {
     /* dynamic table */
     xqc_dtable_t           *dtable;
@@ -54,6 +60,18 @@ typedef struct xqc_encoder_s {
     double                  entry_limit;
     size_t                  entry_size_limit;
 
+    /*
+     * frequency-aware insertion. field lines and names are counted in a count-min sketch, and
+     * only those seen at least insert_threshold times are inserted into dtable, draining entries
+     * are duplicated only if they are still that hot. 0 for inserting every field line.
+     */
+    uint32_t                insert_threshold;
+    xqc_cm_sketch_t        *freq;
+
+    /* field section info reused by field sections, reps grows with the count of field lines */
+    struct xqc_field_section_s *fs;
+    size_t                  fs_reps_cap;
+
 #ifdef XQC_COMPAT_DUPLICATE
     /**
      * @deprecated shall be deleted in the future
@@ -111,6 +129,10 @@ typedef struct xqc_hdr_enc_rule_s {
     /* whether insert entry into dtable */
     xqc_insert_type_t   insertion;
 
+    /* estimated recent frequency of name-value and name, valid if insert_threshold is set */
+    uint32_t            nv_freq;
+    uint32_t            name_freq;
+
 } xqc_hdr_enc_rule_t;
 
 
@@ -266,6 +288,12 @@ xqc_encoder_create(xqc_log_t *log)
     enc->blocked_stream_count = 0;
     enc->krc = 0;
 
+    enc->insert_threshold = 0;
+    enc->freq = NULL;
+
+    enc->fs = NULL;
+    enc->fs_reps_cap = 0;
+
 #ifdef XQC_COMPAT_DUPLICATE
     enc->compat_dup = XQC_FALSE;
 #endif
@@ -291,6 +319,13 @@ xqc_encoder_destroy(xqc_encoder_t *enc)
         xqc_dtable_free(enc->dtable);
     }
 
+    xqc_cm_sketch_destroy(enc->freq);
+
+    if (enc->fs) {
+        xqc_free(enc->fs->reps);
+        xqc_free(enc->fs);
+    }
+
     xqc_list_head_t *pos, *next;
 
     /* free unacked section */
@@ -437,6 +472,31 @@ xqc_encoder_check_insert(xqc_encoder_t *enc, xqc_hdr_enc_rule_t *info, xqc_bool_
 }
 
 
+/* count the field line and its name, the estimations predict reuse of dtable entries */
+static inline void
+xqc_encoder_count_freq(xqc_encoder_t *enc, xqc_hdr_enc_rule_t *info)
+{
+    uint64_t nhash, vhash;
+
+    if (enc->freq == NULL) {
+        return;
+    }
+
+    nhash = xqc_murmur_hash2(info->hdr->name.iov_base, info->hdr->name.iov_len);
+    vhash = xqc_murmur_hash2(info->hdr->value.iov_base, info->hdr->value.iov_len);
+
+    /* name and name-value pair are counted as different keys in the same sketch */
+    info->name_freq = xqc_cm_sketch_add(enc->freq, nhash);
+    info->nv_freq = xqc_cm_sketch_add(enc->freq, (nhash << 32 | vhash) ^ 0x9e3779b97f4a7c15ULL);
+}
+
+static inline xqc_bool_t
+xqc_encoder_is_hot(xqc_encoder_t *enc, uint32_t freq)
+{
+    return enc->freq == NULL || freq >= enc->insert_threshold;
+}
+
+
 void
 xqc_encoder_check_never_value_index_mode(xqc_encoder_t *enc, xqc_hdr_enc_rule_t* info,
     xqc_bool_t blocked)
@@ -454,7 +514,9 @@ xqc_encoder_check_never_value_index_mode(xqc_encoder_t *enc, xqc_hdr_enc_rule_t*
      * Literal Field Line With Name Reference with never bit set to 1
      */
     if (info->ref == XQC_NV_REF_NONE) {
-        if (info->hdr->name.iov_len <= enc->name_len_limit) {
+        if (info->hdr->name.iov_len <= enc->name_len_limit
+            && xqc_encoder_is_hot(enc, info->name_freq))
+        {
             info->insertion = XQC_INSERT_NAME;
         }
     }
@@ -475,12 +537,15 @@ xqc_encoder_check_normal_index_mode(xqc_encoder_t *enc, xqc_hdr_enc_rule_t *info
     /* decide insertion mode according to lookup results */
     switch (info->ref) {
     case XQC_NV_REF_NONE:
-        /* no entry found, try to add one in dtable */
+        /*
+         * no entry found, try to add one in dtable. a cold field line is not inserted, while its
+         * name might be, if the name is hot with variant values
+         */
         if (info->hdr->name.iov_len <= enc->name_len_limit) {
-            if (esz <= enc->entry_size_limit) {
+            if (esz <= enc->entry_size_limit && xqc_encoder_is_hot(enc, info->nv_freq)) {
                 info->insertion = XQC_INSERT_LITERAL_NAME_VALUE;
 
-            } else {
+            } else if (xqc_encoder_is_hot(enc, info->name_freq)) {
                 info->insertion = XQC_INSERT_NAME;
             }
         }
@@ -491,7 +556,9 @@ xqc_encoder_check_normal_index_mode(xqc_encoder_t *enc, xqc_hdr_enc_rule_t *info
          * if name is referred in dtable, will try to decide whether an insertion with
          * value is worthy, with a more aggressive size restriction
          */
-        if (esz <= enc->entry_size_limit /* && info->ref_table == XQC_DTABLE_FLAG */) {
+        if (esz <= enc->entry_size_limit /* && info->ref_table == XQC_DTABLE_FLAG */
+            && xqc_encoder_is_hot(enc, info->nv_freq))
+        {
             info->insertion = XQC_INSERT_NAME_REF_VALUE;
         }
         break;
@@ -626,7 +693,13 @@ xqc_encoder_try_duplicate(xqc_encoder_t *enc, xqc_hdr_enc_rule_t *info, xqc_var_
         return ret;
     }
 
-    if (draining == XQC_TRUE) {
+    /*
+     * a draining entry is duplicated only if it is predicted to be referred again, otherwise the
+     * draining entry is referred for the last time and left to be evicted
+     */
+    if (draining == XQC_TRUE
+        && xqc_encoder_is_hot(enc, info->ref == XQC_NV_REF_NAME ? info->name_freq : info->nv_freq))
+    {
         uint64_t dup_idx;
 
 #ifdef XQC_COMPAT_DUPLICATE
@@ -668,91 +741,111 @@ xqc_encoder_try_duplicate(xqc_encoder_t *enc, xqc_hdr_enc_rule_t *info, xqc_var_
 
 
 /* refer a header in static table and dynamic table, and generate representation info */
-xqc_int_t
-xqc_encoder_prepare(xqc_encoder_t *enc, xqc_http_headers_t *hdrs, xqc_field_section_t *fs,
-    xqc_var_buf_t *ins, uint64_t stream_id)
+static xqc_int_t
+xqc_encoder_prepare_field_line(xqc_encoder_t *enc, xqc_field_section_t *fs,
+    xqc_hdr_enc_rule_t *info, xqc_var_buf_t *ins, xqc_bool_t limited)
 {
     xqc_int_t ret = XQC_OK;
+    xqc_http_header_t *hdr = info->hdr;
 
-    /* check if reached the block stream limit */
-    xqc_bool_t limited = xqc_encoder_check_block_stream_limit(enc, stream_id);
+    if (hdr->save_nv_hit_flags && hdr->src_header) {
+        hdr->src_header->nv_hit_flags = 0;
+    }
 
-    for (size_t i = 0; i < hdrs->count; i++) {
-        xqc_http_header_t *hdr = &hdrs->headers[i];
-        xqc_hdr_enc_rule_t *info = &fs->reps[i];
-        info->hdr = hdr;
+    /*
+     * if XQC_HTTP_HEADER_FLAG_NEVER_INDEX is set, header will be sent as Literal Filed Line
+     * With Literal Name, regardless of lookup or insertion operation with stable and dtable
+     */
+    if (hdr->flags & XQC_HTTP_HEADER_FLAG_NEVER_INDEX) {
+        info->ref = XQC_NV_REF_NONE;
+        info->never = 1;
+        return XQC_OK;
+    }
 
-        if (hdr->save_nv_hit_flags && hdr->src_header) {
-            hdr->src_header->nv_hit_flags = 0;
-        }
+    /* lookup nv from static table and dynamic table */
+    ret = xqc_encoder_lookup_nv(enc, info);
+    if (ret != XQC_OK) {
+        xqc_log(enc->log, XQC_LOG_ERROR, "|lookup failed|");
+        return ret;
+    }
 
-        /*
-         * if XQC_HTTP_HEADER_FLAG_NEVER_INDEX is set, header will be sent as Literal Filed Line
-         * With Literal Name, regardless of lookup or insertion operation with stable and dtable
-         */
-        if (hdr->flags & XQC_HTTP_HEADER_FLAG_NEVER_INDEX) {
-            info->ref = XQC_NV_REF_NONE;
-            info->never = 1;
-            continue;
-        }
+    /* static table whole matched field lines never occupy dtable, no need to count them */
+    if (!(info->ref_table == XQC_STABLE_FLAG && info->ref == XQC_NV_REF_NAME_AND_VALUE)) {
+        xqc_encoder_count_freq(enc, info);
+    }
+
+    /* decide dynamic table strategy, including never flag and insertion */
+    xqc_encoder_check_index_mode(enc, info, limited);
 
-        /* lookup nv from static table and dynamic table */
-        ret = xqc_encoder_lookup_nv(enc, info);
+    /* either insert or duplicate, prepare for dtable entry reference */
+    if (info->insertion != XQC_INSERT_NONE) {
+        ret = xqc_encoder_insert(enc, info, ins);
         if (ret != XQC_OK) {
-            xqc_log(enc->log, XQC_LOG_ERROR, "|lookup failed|");
+            xqc_log(enc->log, XQC_LOG_INFO, "|insertion failed|");
             return ret;
         }
 
-        /* decide dynamic table strategy, including never flag and insertion */
-        xqc_encoder_check_index_mode(enc, info, limited);
-
-        /* either insert or duplicate, prepare for dtable entry reference */
-        if (info->insertion != XQC_INSERT_NONE) {
-            ret = xqc_encoder_insert(enc, info, ins);
+    } else {
+        /* when insertion is not limited, and refers and dtable entry, try to duplicate */
+        if (limited == XQC_FALSE && info->ref != XQC_NV_REF_NONE
+            && info->ref_table == XQC_DTABLE_FLAG)
+        {
+            /* check and do duplicate, if it fails, send as lookup result */
+            ret = xqc_encoder_try_duplicate(enc, info, ins);
             if (ret != XQC_OK) {
-                xqc_log(enc->log, XQC_LOG_INFO, "|insertion failed|");
-                return ret;
-            }
-
-        } else {
-            /* when insertion is not limited, and refers and dtable entry, try to duplicate */
-            if (limited == XQC_FALSE && info->ref != XQC_NV_REF_NONE
-                && info->ref_table == XQC_DTABLE_FLAG)
-            {
-                /* check and do duplicate, if it fails, send as lookup result */
-                ret = xqc_encoder_try_duplicate(enc, info, ins);
-                if (ret != XQC_OK) {
-                    xqc_log(enc->log, XQC_LOG_DEBUG, "|try duplicate failed|");
-                }
+                xqc_log(enc->log, XQC_LOG_DEBUG, "|try duplicate failed|");
             }
         }
+    }
 
-        /* update min dtable referred index */
-        if (info->ref != XQC_NV_REF_NONE && info->ref_table == XQC_DTABLE_FLAG
-            && info->index < fs->min_ref_idx)
-        {
-            fs->min_ref_idx = info->index;
-
-            /* if new insertion will generate a lower bound, set the min_ref of dtable */
-            if (fs->min_ref_idx < enc->min_unack_index) {
-                ret = xqc_dtable_set_min_ref(enc->dtable, info->index);
-                if (ret != XQC_OK) {
-                    xqc_log(enc->log, XQC_LOG_ERROR, "|set min ref error|");
-                    return ret;
-                }
+    /* update min dtable referred index */
+    if (info->ref != XQC_NV_REF_NONE && info->ref_table == XQC_DTABLE_FLAG
+        && info->index < fs->min_ref_idx)
+    {
+        fs->min_ref_idx = info->index;
+
+        /* if new insertion will generate a lower bound, set the min_ref of dtable */
+        if (fs->min_ref_idx < enc->min_unack_index) {
+            ret = xqc_dtable_set_min_ref(enc->dtable, info->index);
+            if (ret != XQC_OK) {
+                xqc_log(enc->log, XQC_LOG_ERROR, "|set min ref error|");
+                return ret;
             }
         }
+    }
 
-        /* update required insert count */
-        if (info->ref != XQC_NV_REF_NONE && info->ref_table == XQC_DTABLE_FLAG
-            && fs->rqrd_insert_cnt < info->index + 1)
-        {
-            fs->rqrd_insert_cnt = info->index + 1;
-        }
+    /* update required insert count */
+    if (info->ref != XQC_NV_REF_NONE && info->ref_table == XQC_DTABLE_FLAG
+        && fs->rqrd_insert_cnt < info->index + 1)
+    {
+        fs->rqrd_insert_cnt = info->index + 1;
+    }
+
+    if (hdr->save_nv_hit_flags && info->ref != XQC_NV_ERROR
+        && hdr->src_header) {
+        hdr->src_header->nv_hit_flags = info->ref;
+    }
+
+    return XQC_OK;
+}
+
+
+xqc_int_t
+xqc_encoder_prepare(xqc_encoder_t *enc, xqc_http_headers_t *hdrs, xqc_field_section_t *fs,
+    xqc_var_buf_t *ins, uint64_t stream_id)
+{
+    xqc_int_t ret = XQC_OK;
+
+    /* check if reached the block stream limit */
+    xqc_bool_t limited = xqc_encoder_check_block_stream_limit(enc, stream_id);
 
-        if (hdr->save_nv_hit_flags && info->ref != XQC_NV_ERROR
-            && hdr->src_header) {
-            hdr->src_header->nv_hit_flags = info->ref;
+    for (size_t i = 0; i < hdrs->count; i++) {
+        xqc_hdr_enc_rule_t *info = &fs->reps[i];
+        info->hdr = &hdrs->headers[i];
+
+        ret = xqc_encoder_prepare_field_line(enc, fs, info, ins, limited);
+        if (ret != XQC_OK) {
+            return ret;
         }
     }
 
@@ -760,20 +853,42 @@ xqc_encoder_prepare(xqc_encoder_t *enc, xqc_http_headers_t *hdrs, xqc_field_sect
 }
 
 
-static inline xqc_field_section_t *
-xqc_encoder_create_fs_info(size_t hdr_cnt)
+/*
+ * get the field section info of encoder. it is reused by every field section, and is allocated
+ * only when it is used for the first time or there are more field lines than ever before
+ */
+static xqc_field_section_t *
+xqc_encoder_get_fs_info(xqc_encoder_t *enc, size_t hdr_cnt)
 {
-    xqc_field_section_t *fs = xqc_calloc(1, sizeof(xqc_field_section_t));
+    xqc_field_section_t *fs = enc->fs;
+    xqc_hdr_enc_rule_t *reps;
+    size_t cap;
+
     if (NULL == fs) {
-        return NULL;
+        fs = xqc_calloc(1, sizeof(xqc_field_section_t));
+        if (NULL == fs) {
+            return NULL;
+        }
+        enc->fs = fs;
     }
 
-    fs->reps = xqc_calloc(hdr_cnt, sizeof(xqc_hdr_enc_rule_t));
-    if (NULL == fs->reps) {
-        xqc_free(fs);
-        return NULL;
+    if (hdr_cnt > enc->fs_reps_cap) {
+        cap = xqc_max(hdr_cnt, enc->fs_reps_cap * 2);
+        reps = xqc_malloc(cap * sizeof(xqc_hdr_enc_rule_t));
+        if (NULL == reps) {
+            return NULL;
+        }
+
+        xqc_free(fs->reps);
+        fs->reps = reps;
+        enc->fs_reps_cap = cap;
     }
 
+    reps = fs->reps;
+    xqc_memzero(fs, sizeof(xqc_field_section_t));
+    xqc_memzero(reps, hdr_cnt * sizeof(xqc_hdr_enc_rule_t));
+
+    fs->reps = reps;
     fs->rep_cnt = hdr_cnt;
     fs->min_ref_idx = XQC_INVALID_INDEX; /* initialized to be max */
 
@@ -781,16 +896,8 @@ xqc_encoder_create_fs_info(size_t hdr_cnt)
 }
 
 
-static inline void
-xqc_encoder_free_fs_info(xqc_field_section_t *fs)
-{
-    xqc_free(fs->reps);
-    xqc_free(fs);
-}
-
-
-xqc_int_t
-xqc_encoder_write_efs(xqc_encoder_t *enc, xqc_field_section_t *fs, xqc_var_buf_t *buf)
+static xqc_int_t
+xqc_encoder_write_prefix(xqc_encoder_t *enc, xqc_field_section_t *fs, xqc_var_buf_t *buf)
 {
     /* write prefix */
     xqc_int_t ret = xqc_rep_write_prefix(buf, enc->max_entries, fs->rqrd_insert_cnt, fs->base);
@@ -803,73 +910,97 @@ xqc_encoder_write_efs(xqc_encoder_t *enc, xqc_field_section_t *fs, xqc_var_buf_t
     xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_BLOCK_PREFIX,
                   fs->rqrd_insert_cnt, fs->base);
 
-    uint64_t idx = XQC_INVALID_INDEX;
-    xqc_bool_t pb = XQC_FALSE;
+    return XQC_OK;
+}
 
-    /* write field lines */
-    for (size_t i = 0; i < fs->rep_cnt; i++) {
-        xqc_hdr_enc_rule_t *info = &fs->reps[i];
 
-        /* calculate field line index and dynamic table post-base */
-        if (info->ref_table == XQC_DTABLE_FLAG) {
-            if (info->index >= fs->base) {
-                idx = xqc_abs2pbrel(fs->base, info->index);
-                pb = XQC_TRUE;
+static xqc_int_t
+xqc_encoder_write_field_line(xqc_encoder_t *enc, xqc_field_section_t *fs,
+    xqc_hdr_enc_rule_t *info, xqc_var_buf_t *buf)
+{
+    xqc_int_t ret;
+    uint64_t idx = XQC_INVALID_INDEX;
+    xqc_bool_t pb = XQC_FALSE;
 
-            } else {
-                idx = xqc_abs2brel(fs->base, info->index);
-                pb = XQC_FALSE;
-            }
+    /* calculate field line index and dynamic table post-base */
+    if (info->ref_table == XQC_DTABLE_FLAG) {
+        if (info->index >= fs->base) {
+            idx = xqc_abs2pbrel(fs->base, info->index);
+            pb = XQC_TRUE;
 
         } else {
-            idx = info->index;
+            idx = xqc_abs2brel(fs->base, info->index);
             pb = XQC_FALSE;
         }
 
-        if (info->ref == XQC_NV_REF_NONE) {
-            ret = xqc_rep_write_literal_name_value(buf, info->never, info->hdr->name.iov_len,
-                                                   info->hdr->name.iov_base, info->hdr->value.iov_len,
-                                                   info->hdr->value.iov_base);
-            xqc_log(enc->log, XQC_LOG_DEBUG, "|write literal_name_value|");
+    } else {
+        idx = info->index;
+        pb = XQC_FALSE;
+    }
+
+    if (info->ref == XQC_NV_REF_NONE) {
+        ret = xqc_rep_write_literal_name_value(buf, info->never, info->hdr->name.iov_len,
+                                               info->hdr->name.iov_base, info->hdr->value.iov_len,
+                                               info->hdr->value.iov_base);
+        xqc_log(enc->log, XQC_LOG_DEBUG, "|write literal_name_value|");
+        xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
+                      XQC_REP_TYPE_LITERAL, info);
+
+    } else if (info->ref == XQC_NV_REF_NAME) {
+        if (pb == XQC_TRUE) {
+            ret = xqc_rep_write_literal_with_pb_name_ref(buf, info->never, idx,
+                                                         info->hdr->value.iov_len,
+                                                         info->hdr->value.iov_base);
+            xqc_log(enc->log, XQC_LOG_DEBUG, "|write literal_with_pb_name_ref|index:%d|", idx);
             xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
-                          XQC_REP_TYPE_LITERAL, info);
+                          XQC_REP_TYPE_POST_BASE_NAME_REFERENCE, info, idx);
 
-        } else if (info->ref == XQC_NV_REF_NAME) {
-            if (pb == XQC_TRUE) {
-                ret = xqc_rep_write_literal_with_pb_name_ref(buf, info->never, idx,
-                                                             info->hdr->value.iov_len,
-                                                             info->hdr->value.iov_base);
-                xqc_log(enc->log, XQC_LOG_DEBUG, "|write literal_with_pb_name_ref|index:%d|", idx);
-                xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
-                              XQC_REP_TYPE_POST_BASE_NAME_REFERENCE, info, idx);
+        } else {
+            ret = xqc_rep_write_literal_with_name_ref(buf, info->never, info->ref_table, idx,
+                                                      info->hdr->value.iov_len,
+                                                      info->hdr->value.iov_base);
+            xqc_log(enc->log, XQC_LOG_DEBUG, "|write literal_with_name_ref|index:%d|", idx);
+            xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
+                          XQC_REP_TYPE_NAME_REFERENCE, info, idx);
+        }
 
-            } else {
-                ret = xqc_rep_write_literal_with_name_ref(buf, info->never, info->ref_table, idx,
-                                                          info->hdr->value.iov_len,
-                                                          info->hdr->value.iov_base);
-                xqc_log(enc->log, XQC_LOG_DEBUG, "|write literal_with_name_ref|index:%d|", idx);
-                xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
-                              XQC_REP_TYPE_NAME_REFERENCE, info, idx);
-            }
+    } else {
+        if (pb == XQC_TRUE) {
+            ret = xqc_rep_write_indexed_pb(buf, idx);
+            xqc_log(enc->log, XQC_LOG_DEBUG, "|write indexed_pb|index:%d|", idx);
+            xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
+                          XQC_REP_TYPE_POST_BASE_INDEXED, info, idx);
 
         } else {
-            if (pb == XQC_TRUE) {
-                ret = xqc_rep_write_indexed_pb(buf, idx);
-                xqc_log(enc->log, XQC_LOG_DEBUG, "|write indexed_pb|index:%d|", idx);
-                xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
-                              XQC_REP_TYPE_POST_BASE_INDEXED, info, idx);
-
-            } else {
-                ret = xqc_rep_write_indexed(buf, info->ref_table, idx);
-                xqc_log(enc->log, XQC_LOG_DEBUG, "|write indexed|index:%d|", idx);
-                xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
-                              XQC_REP_TYPE_INDEXED, info, idx);
-            }
+            ret = xqc_rep_write_indexed(buf, info->ref_table, idx);
+            xqc_log(enc->log, XQC_LOG_DEBUG, "|write indexed|index:%d|", idx);
+            xqc_log_event(enc->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_BLOCK,
+                          XQC_REP_TYPE_INDEXED, info, idx);
         }
+    }
+
+    if (ret < 0) {
+        xqc_log(enc->log, XQC_LOG_ERROR, "|write field line error|ret:%d|ref:%d|pb:%d|", ret,
+                info->ref, pb);
+        return ret;
+    }
+
+    return XQC_OK;
+}
+
 
-        if (ret < 0) {
-            xqc_log(enc->log, XQC_LOG_ERROR, "|write field line error|ret:%d|ref:%d|pb:%d|", ret,
-                    info->ref, pb);
+xqc_int_t
+xqc_encoder_write_efs(xqc_encoder_t *enc, xqc_field_section_t *fs, xqc_var_buf_t *buf)
+{
+    xqc_int_t ret = xqc_encoder_write_prefix(enc, fs, buf);
+    if (ret != XQC_OK) {
+        return ret;
+    }
+
+    /* write field lines */
+    for (size_t i = 0; i < fs->rep_cnt; i++) {
+        ret = xqc_encoder_write_field_line(enc, fs, &fs->reps[i], buf);
+        if (ret != XQC_OK) {
             return ret;
         }
     }
@@ -913,7 +1044,7 @@ xqc_encoder_enc_headers(xqc_encoder_t *enc, xqc_var_buf_t *efs,
         return XQC_OK;
     }
 
-    xqc_field_section_t *fs = xqc_encoder_create_fs_info(hdrs->count);
+    xqc_field_section_t *fs = xqc_encoder_get_fs_info(enc, hdrs->count);
     if (NULL == fs) {
         xqc_log(enc->log, XQC_LOG_ERROR, "|create field section info error|");
         return -XQC_EMALLOC;
@@ -948,7 +1079,196 @@ xqc_encoder_enc_headers(xqc_encoder_t *enc, xqc_var_buf_t *efs,
 
 fail:
 
-    xqc_encoder_free_fs_info(fs);
+    return ret;
+}
+
+
+xqc_int_t
+xqc_encoder_enc_field_line_static(xqc_http_header_t *hdr, xqc_var_buf_t *buf, xqc_bool_t *dtable)
+{
+    xqc_int_t ret;
+    xqc_hdr_enc_rule_t info;
+
+    xqc_memzero(&info, sizeof(xqc_hdr_enc_rule_t));
+    info.hdr = hdr;
+    info.ref = XQC_NV_REF_NONE;
+    info.index = XQC_INVALID_INDEX;
+    *dtable = XQC_FALSE;
+
+    if (hdr->flags & XQC_HTTP_HEADER_FLAG_NEVER_INDEX) {
+        info.never = 1;
+
+    } else {
+        info.type = xqc_h3_hdr_type(hdr->name.iov_base, hdr->name.iov_len);
+        if (info.type < XQC_HDR_STATIC_TABLE_END) {
+            info.ref = xqc_stable_lookup(hdr->name.iov_base, hdr->name.iov_len,
+                                         hdr->value.iov_base, hdr->value.iov_len,
+                                         info.type, &info.index);
+            info.ref_table = XQC_STABLE_FLAG;
+        }
+        info.never = xqc_encoder_never_idx_value_hdr(&info);
+
+        /*
+         * static table whole match is always preferred, and a never indexed value with name
+         * found in static table is never inserted. others might refer to or be inserted
+         * into dynamic table
+         */
+        *dtable = !(info.ref == XQC_NV_REF_NAME_AND_VALUE
+                    || (info.never && info.ref != XQC_NV_REF_NONE));
+    }
+
+    switch (info.ref) {
+    case XQC_NV_REF_NONE:
+        ret = xqc_rep_write_literal_name_value(buf, info.never, hdr->name.iov_len,
+                                               hdr->name.iov_base, hdr->value.iov_len,
+                                               hdr->value.iov_base);
+        break;
+
+    case XQC_NV_REF_NAME:
+        ret = xqc_rep_write_literal_with_name_ref(buf, info.never, XQC_STABLE_FLAG, info.index,
+                                                  hdr->value.iov_len, hdr->value.iov_base);
+        break;
+
+    default:
+        ret = xqc_rep_write_indexed(buf, XQC_STABLE_FLAG, info.index);
+        break;
+    }
+
+    return ret < 0 ? ret : XQC_OK;
+}
+
+
+/* write the cached field lines of template in [start, end) */
+static inline xqc_int_t
+xqc_encoder_write_tmpl_lines(xqc_encoder_t *enc, xqc_h3_hdr_tmpl_t *tmpl, size_t start,
+    size_t end, xqc_var_buf_t *buf)
+{
+    size_t offset, len;
+
+    if (start >= end) {
+        return XQC_OK;
+    }
+
+    /* cached field lines are consecutive in the encoded buffer of template */
+    offset = tmpl->lines[start].offset;
+    len = tmpl->lines[end - 1].offset + tmpl->lines[end - 1].len - offset;
+    xqc_log(enc->log, XQC_LOG_DEBUG, "|write template field lines|start:%uz|end:%uz|len:%uz|",
+            start, end, len);
+
+    return xqc_var_buf_save_data(buf, tmpl->efs->data + offset, len);
+}
+
+
+xqc_int_t
+xqc_encoder_enc_headers_tmpl(xqc_encoder_t *enc, xqc_var_buf_t *efs, xqc_var_buf_t *ins,
+    uint64_t stream_id, xqc_h3_hdr_tmpl_t *tmpl, xqc_http_headers_t *hdrs)
+{
+    xqc_int_t ret = XQC_OK;
+    size_t i, start, rep_idx, hdr_cnt = hdrs ? hdrs->count : 0;
+    xqc_bool_t use_dtable, limited;
+    xqc_field_section_t *fs;
+    xqc_hdr_enc_rule_t *info;
+
+    /* without dynamic table, the cached field lines of template are always used */
+    use_dtable = enc->max_entries > 0;
+
+    /* template field lines which might refer to dynamic table are put after the request headers */
+    fs = xqc_encoder_get_fs_info(enc, hdr_cnt + (use_dtable ? tmpl->dtable_cnt : 0));
+    if (NULL == fs) {
+        xqc_log(enc->log, XQC_LOG_ERROR, "|create field section info error|");
+        return -XQC_EMALLOC;
+    }
+    fs->rep_cnt = 0;
+    fs->base = xqc_dtable_get_insert_cnt(enc->dtable);
+
+    for (i = 0; i < hdr_cnt; i++) {
+        fs->reps[fs->rep_cnt++].hdr = &hdrs->headers[i];
+    }
+
+    if (use_dtable) {
+        for (i = 0; i < tmpl->count; i++) {
+            if (tmpl->lines[i].dtable) {
+                fs->reps[fs->rep_cnt++].hdr = &tmpl->lines[i].hdr;
+            }
+        }
+    }
+
+    /* lookup nv, do dtable insertion and decide indexing mode for per-request field lines */
+    limited = xqc_encoder_check_block_stream_limit(enc, stream_id);
+    for (i = 0; i < fs->rep_cnt; i++) {
+        ret = xqc_encoder_prepare_field_line(enc, fs, &fs->reps[i], ins, limited);
+        if (ret != XQC_OK) {
+            xqc_log(enc->log, XQC_LOG_ERROR, "|prepare field line error|ret:%d|", ret);
+            goto fail;
+        }
+    }
+
+    ret = xqc_encoder_write_prefix(enc, fs, efs);
+    if (ret != XQC_OK) {
+        goto fail;
+    }
+
+    /* pseudo headers of request */
+    for (i = 0; i < hdr_cnt; i++) {
+        info = &fs->reps[i];
+        if (info->hdr->name.iov_len > 0 && *(unsigned char *)info->hdr->name.iov_base == ':') {
+            ret = xqc_encoder_write_field_line(enc, fs, info, efs);
+            if (ret != XQC_OK) {
+                goto fail;
+            }
+        }
+    }
+
+    /* field lines of template, cached ones are copied in runs */
+    rep_idx = hdr_cnt;
+    start = 0;
+    for (i = 0; i < tmpl->count; i++) {
+        if (!use_dtable || !tmpl->lines[i].dtable) {
+            continue;
+        }
+
+        ret = xqc_encoder_write_tmpl_lines(enc, tmpl, start, i, efs);
+        if (ret != XQC_OK) {
+            goto fail;
+        }
+
+        ret = xqc_encoder_write_field_line(enc, fs, &fs->reps[rep_idx++], efs);
+        if (ret != XQC_OK) {
+            goto fail;
+        }
+        start = i + 1;
+    }
+
+    ret = xqc_encoder_write_tmpl_lines(enc, tmpl, start, tmpl->count, efs);
+    if (ret != XQC_OK) {
+        goto fail;
+    }
+
+    /* other headers of request */
+    for (i = 0; i < hdr_cnt; i++) {
+        info = &fs->reps[i];
+        if (info->hdr->name.iov_len == 0 || *(unsigned char *)info->hdr->name.iov_base != ':') {
+            ret = xqc_encoder_write_field_line(enc, fs, info, efs);
+            if (ret != XQC_OK) {
+                goto fail;
+            }
+        }
+    }
+
+    /* save representation info */
+    ret = xqc_encoder_save_unacked(enc, stream_id, fs);
+    if (ret != XQC_OK) {
+        xqc_log(enc->log, XQC_LOG_ERROR, "|save unacked error|ret:%d|", ret);
+        goto fail;
+    }
+
+    /* required insert count is larger than known received count, take it as blocked stream */
+    if (fs->rqrd_insert_cnt > enc->krc) {
+        xqc_encoder_add_blocked_stream(enc, stream_id, fs->rqrd_insert_cnt);
+    }
+
+fail:
+
     return ret;
 }
 
@@ -1130,6 +1450,31 @@ xqc_encoder_set_insert_limit(xqc_encoder_t *enc, double nlimit, double elimit)
 }
 
 
+xqc_int_t
+xqc_encoder_set_insert_threshold(xqc_encoder_t *enc, uint32_t threshold)
+{
+    /* insertion of every field line needs no frequency */
+    if (threshold <= 1) {
+        xqc_cm_sketch_destroy(enc->freq);
+        enc->freq = NULL;
+        enc->insert_threshold = 0;
+        return XQC_OK;
+    }
+
+    if (enc->freq == NULL) {
+        enc->freq = xqc_cm_sketch_create(XQC_ENCODER_FREQ_SKETCH_WIDTH);
+        if (enc->freq == NULL) {
+            xqc_log(enc->log, XQC_LOG_ERROR, "|create frequency sketch error|");
+            return -XQC_EMALLOC;
+        }
+    }
+
+    enc->insert_threshold = xqc_min(threshold, XQC_CM_SKETCH_COUNTER_MAX);
+    xqc_log(enc->log, XQC_LOG_DEBUG, "|insert_threshold:%ud|", enc->insert_threshold);
+    return XQC_OK;
+}
+
+
 xqc_int_t
 xqc_encoder_set_max_dtable_cap(xqc_encoder_t *enc, size_t max_cap)
 {
@@ -29,6 +29,21 @@ void xqc_encoder_destroy(xqc_encoder_t *enc);
 xqc_int_t xqc_encoder_enc_headers(xqc_encoder_t *enc, xqc_var_buf_t *efs,
     xqc_var_buf_t *ins, uint64_t stream_id, xqc_http_headers_t *hdrs);
 
+/**
+ * @brief encode a header as field line without dynamic table, used to encode header templates
+ * @param dtable output, whether the field line might be encoded better with dynamic table
+ */
+xqc_int_t xqc_encoder_enc_field_line_static(xqc_http_header_t *hdr, xqc_var_buf_t *buf,
+    xqc_bool_t *dtable);
+
+/**
+ * @brief encode a header template and the headers of request to field section. pseudo headers
+ * of request are written first, then the template, and other headers of request at last
+ * @param hdrs headers of request, might be NULL
+ */
+xqc_int_t xqc_encoder_enc_headers_tmpl(xqc_encoder_t *enc, xqc_var_buf_t *efs,
+    xqc_var_buf_t *ins, uint64_t stream_id, xqc_h3_hdr_tmpl_t *tmpl, xqc_http_headers_t *hdrs);
+
 /**
  * @brief on section acknowledgement instruction
  */
@@ -65,6 +80,13 @@ xqc_int_t xqc_encoder_set_max_blocked_stream(xqc_encoder_t *enc, size_t max_bloc
  */
 void xqc_encoder_set_insert_limit(xqc_encoder_t *enc, double nlimit, double vlimit);
 
+/**
+ * @brief set the frequency threshold of dtable insertion. field lines are inserted only if they
+ * are seen at least threshold times recently, and draining entries are duplicated only if they
+ * are still that frequent. 0 or 1 for inserting every field line.
+ */
+xqc_int_t xqc_encoder_set_insert_threshold(xqc_encoder_t *enc, uint32_t threshold);
+
 #ifdef XQC_COMPAT_DUPLICATE
 void xqc_encoder_compat_dup(xqc_encoder_t *enc, xqc_bool_t compat);
 #endif
@@ -0,0 +1,108 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "src/http3/qpack/xqc_hdr_tmpl.h"
+#include "src/http3/qpack/xqc_encoder.h"
+#include "src/common/xqc_str.h"
+
+
+static inline xqc_bool_t
+xqc_h3_hdr_tmpl_is_pseudo(xqc_http_header_t *hdr)
+{
+    return *(unsigned char *)hdr->name.iov_base == ':';
+}
+
+
+xqc_h3_hdr_tmpl_t *
+xqc_h3_hdr_tmpl_create(xqc_http_headers_t *headers)
+{
+    xqc_h3_hdr_tmpl_t *tmpl;
+    xqc_h3_hdr_tmpl_line_t *line;
+    xqc_http_header_t *hdr;
+    unsigned char *pos;
+    size_t i, nv_len = 0;
+    xqc_int_t ret;
+    int pseudo;
+
+    if (headers == NULL || headers->count == 0) {
+        return NULL;
+    }
+
+    /* names and values are stored with terminators */
+    for (i = 0; i < headers->count; i++) {
+        nv_len += headers->headers[i].name.iov_len + headers->headers[i].value.iov_len + 2;
+    }
+
+    tmpl = xqc_calloc(1, sizeof(xqc_h3_hdr_tmpl_t));
+    if (tmpl == NULL) {
+        return NULL;
+    }
+
+    tmpl->lines = xqc_calloc(headers->count, sizeof(xqc_h3_hdr_tmpl_line_t));
+    tmpl->nv = xqc_malloc(nv_len);
+    tmpl->efs = xqc_var_buf_create(XQC_VAR_BUF_INIT_SIZE);
+    if (tmpl->lines == NULL || tmpl->nv == NULL || tmpl->efs == NULL) {
+        goto fail;
+    }
+
+    /* pseudo headers first, headers with empty name are ignored */
+    pos = tmpl->nv;
+    for (pseudo = 1; pseudo >= 0; pseudo--) {
+        for (i = 0; i < headers->count; i++) {
+            hdr = &headers->headers[i];
+            if (hdr->name.iov_len == 0 || xqc_h3_hdr_tmpl_is_pseudo(hdr) != pseudo) {
+                continue;
+            }
+
+            line = &tmpl->lines[tmpl->count++];
+            line->hdr.flags = hdr->flags;
+
+            xqc_str_tolower(pos, hdr->name.iov_base, hdr->name.iov_len);
+            line->hdr.name.iov_base = pos;
+            line->hdr.name.iov_len = hdr->name.iov_len;
+            pos += hdr->name.iov_len;
+            *pos++ = '\0';
+
+            xqc_memcpy(pos, hdr->value.iov_base, hdr->value.iov_len);
+            line->hdr.value.iov_base = pos;
+            line->hdr.value.iov_len = hdr->value.iov_len;
+            pos += hdr->value.iov_len;
+            *pos++ = '\0';
+
+            /* encode field line without dynamic table */
+            line->offset = tmpl->efs->data_len;
+            ret = xqc_encoder_enc_field_line_static(&line->hdr, tmpl->efs, &line->dtable);
+            if (ret != XQC_OK) {
+                goto fail;
+            }
+            line->len = tmpl->efs->data_len - line->offset;
+
+            tmpl->dtable_cnt += line->dtable;
+            tmpl->total_len += hdr->name.iov_len + hdr->value.iov_len;
+        }
+    }
+
+    return tmpl;
+
+fail:
+    xqc_h3_hdr_tmpl_destroy(tmpl);
+    return NULL;
+}
+
+
+void
+xqc_h3_hdr_tmpl_destroy(xqc_h3_hdr_tmpl_t *tmpl)
+{
+    if (tmpl == NULL) {
+        return;
+    }
+
+    if (tmpl->efs) {
+        xqc_var_buf_free(tmpl->efs);
+    }
+
+    xqc_free(tmpl->nv);
+    xqc_free(tmpl->lines);
+    xqc_free(tmpl);
+}
@@ -0,0 +1,51 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ *
+ * @brief header template is a set of headers which is sent on many requests. it is encoded once
+ * on creation without dynamic table, and the encoded field lines are copied into the field
+ * section of each request. only the field lines which might be encoded better with dynamic
+ * table are encoded again per request, when dynamic table is used.
+ */
+
+#ifndef _XQC_HDR_TMPL_H_
+#define _XQC_HDR_TMPL_H_
+
+#include "src/http3/qpack/xqc_qpack_defs.h"
+
+
+typedef struct xqc_h3_hdr_tmpl_line_s {
+    /* header with lowercase name, name and value are stored in template */
+    xqc_http_header_t       hdr;
+
+    /* the encoded field line without dynamic table, which is a slice of efs */
+    size_t                  offset;
+    size_t                  len;
+
+    /*
+     * whether the field line might be encoded better with dynamic table. those static-table
+     * whole matched and never indexed field lines are encoded in the same way regardless of
+     * dynamic table
+     */
+    xqc_bool_t              dtable;
+} xqc_h3_hdr_tmpl_line_t;
+
+
+struct xqc_h3_hdr_tmpl_s {
+    /* field lines, pseudo headers are put at the front */
+    xqc_h3_hdr_tmpl_line_t *lines;
+    size_t                  count;
+
+    /* count of field lines with dtable flag */
+    size_t                  dtable_cnt;
+
+    /* total length of names and values */
+    size_t                  total_len;
+
+    /* encoded field lines without dynamic table */
+    xqc_var_buf_t          *efs;
+
+    /* storage of names and values */
+    unsigned char          *nv;
+};
+
+#endif
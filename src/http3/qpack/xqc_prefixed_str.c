@@ -157,41 +157,37 @@ xqc_write_prefixed_str(xqc_var_buf_t *buf, uint8_t *str, uint64_t len, uint8_t n
     xqc_int_t   ret;
     uint8_t    *pos;
     size_t      ps_len = 0;
+    size_t      max_int_len, int_len, huff_len;
+
+    /*
+     * the length of huffman string is not known before encoding, reserve the prefixed integer
+     * for the original length, which is never shorter, and encode huffman string after it
+     */
+    max_int_len = xqc_prefixed_int_put_len(len, n);
+    ps_len = max_int_len + len;
+    ret = xqc_var_buf_save_prepare(buf, ps_len);
+    if (ret != XQC_OK) {
+        return ret;
+    }
 
-    /* write str */
-    size_t huff_len = xqc_huffman_enc_len(str, len);
-    if (huff_len < len) {
-        ps_len = xqc_prefixed_int_put_len(huff_len, n) + huff_len;
-        ret = xqc_var_buf_save_prepare(buf, ps_len);
-        if (ret != XQC_OK) {
-            return ret;
-        }
-
-        pos = buf->data + buf->data_len;
+    pos = buf->data + buf->data_len;
 
+    /* write str */
+    huff_len = xqc_huffman_enc_if_shorter(pos + max_int_len, str, len);
+    if (huff_len > 0) {
         /* write huffman flag */
         pos[0] |= 1 << n;
 
-        /* write length */
-        pos = xqc_prefixed_int_put(pos, huff_len, n);
-        buf->data_len = pos - buf->data;
-
-        /* write string */
-        pos = xqc_huffman_enc(pos, str, len);
-        buf->data_len = pos - buf->data;
-        if (buf->data_len > buf->buf_len) {
-            return XQC_ERROR;
-        }
-
-    } else {
-        ps_len = xqc_prefixed_int_put_len(len, n) + len;
-        ret = xqc_var_buf_save_prepare(buf, ps_len);
-        if (ret != XQC_OK) {
-            return ret;
+        /* write length, and move huffman string to the end of it if it is shorter */
+        int_len = xqc_prefixed_int_put_len(huff_len, n);
+        if (int_len < max_int_len) {
+            memmove(pos + int_len, pos + max_int_len, huff_len);
         }
+        xqc_prefixed_int_put(pos, huff_len, n);
 
-        pos = buf->data + buf->data_len;
+        buf->data_len += int_len + huff_len;
 
+    } else {
         /* set huffman bit to 0 */
         pos[0] &= ~(1 << n);
 
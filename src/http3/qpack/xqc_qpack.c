@@ -36,6 +36,12 @@ typedef struct xqc_qpack_s {
 
     /* max encoder's dynamic table capacity configured by local */
     uint64_t                enc_max_cap;
+
+    /*
+     * scratch buffer for encoder instructions generated while encoding headers,
+     * reused across requests and copied to encoder stream only if not empty
+     */
+    xqc_var_buf_t          *enc_ins_buf;
 } xqc_qpack_s;
 
 
@@ -47,7 +53,7 @@ xqc_qpack_create(uint64_t enc_max_cap, uint64_t dec_max_cap, xqc_log_t *log, con
         return NULL;
     }
 
-    xqc_qpack_t *qpk = xqc_malloc(sizeof(xqc_qpack_t));
+    xqc_qpack_t *qpk = xqc_calloc(1, sizeof(xqc_qpack_t));
     if (qpk == NULL) {
         return NULL;
     }
@@ -77,6 +83,7 @@ xqc_qpack_create(uint64_t enc_max_cap, uint64_t dec_max_cap, xqc_log_t *log, con
     qpk->user_data = user_data;
     qpk->enc_max_cap = enc_max_cap;
     qpk->dec_max_cap = dec_max_cap;
+    qpk->enc_ins_buf = NULL;
 
     return qpk;
 
@@ -108,6 +115,10 @@ xqc_qpack_destroy(xqc_qpack_t *qpk)
         xqc_ins_decoder_ctx_free(qpk->dctx);
     }
 
+    if (qpk->enc_ins_buf) {
+        xqc_var_buf_free(qpk->enc_ins_buf);
+    }
+
     xqc_free(qpk);
 }
 
@@ -451,20 +462,57 @@ xqc_int_t
 xqc_qpack_enc_headers(xqc_qpack_t *qpk, uint64_t stream_id,
     xqc_http_headers_t *headers, xqc_var_buf_t *data)
 {
-    xqc_var_buf_t *ins_buf = qpk->ins_cb.get_buf_cb(XQC_INS_TYPE_ENCODER, qpk->user_data);
-    if (NULL == ins_buf) {
+    return xqc_qpack_enc_headers_tmpl(qpk, stream_id, NULL, headers, data);
+}
+
+
+xqc_int_t
+xqc_qpack_enc_headers_tmpl(xqc_qpack_t *qpk, uint64_t stream_id, xqc_h3_hdr_tmpl_t *tmpl,
+    xqc_http_headers_t *headers, xqc_var_buf_t *data)
+{
+    xqc_int_t ret;
+
+    if (qpk->enc_ins_buf == NULL) {
+        qpk->enc_ins_buf = xqc_var_buf_create(XQC_VAR_BUF_INIT_SIZE);
+        if (qpk->enc_ins_buf == NULL) {
+            xqc_log(qpk->log, XQC_LOG_ERROR, "|create encoder instruction buffer error|");
+            return -XQC_EMALLOC;
+        }
+    }
+
+    xqc_var_buf_t *ins_buf = qpk->enc_ins_buf;
+    xqc_var_buf_clear(ins_buf);
+
+    if (tmpl == NULL) {
+        ret = xqc_encoder_enc_headers(qpk->enc, data, ins_buf, stream_id, headers);
+
+    } else {
+        ret = xqc_encoder_enc_headers_tmpl(qpk->enc, data, ins_buf, stream_id, tmpl, headers);
+    }
+
+    if (ret != XQC_OK) {
+        xqc_log(qpk->log, XQC_LOG_ERROR, "|encode headers error|%d|", ret);
+        return ret;
+    }
+
+    /* most requests generate no encoder instruction, nothing to write */
+    if (ins_buf->data_len == 0) {
+        return XQC_OK;
+    }
+
+    xqc_var_buf_t *buf = qpk->ins_cb.get_buf_cb(XQC_INS_TYPE_ENCODER, qpk->user_data);
+    if (NULL == buf) {
         xqc_log(qpk->log, XQC_LOG_ERROR, "|get encoder instruction error|");
         return -XQC_ENOBUF;
     }
 
-    xqc_int_t ret = xqc_encoder_enc_headers(qpk->enc, data, ins_buf, stream_id, headers);
+    ret = xqc_var_buf_save_data(buf, ins_buf->data, ins_buf->data_len);
     if (ret != XQC_OK) {
-        xqc_log(qpk->log, XQC_LOG_ERROR, "|encode headers error|%d|", ret);
+        xqc_log(qpk->log, XQC_LOG_ERROR, "|save encoder instruction error|%d|", ret);
         return ret;
     }
 
-    ssize_t processed = qpk->ins_cb.write_ins_cb(XQC_INS_TYPE_ENCODER, ins_buf,
-                                                      qpk->user_data);
+    ssize_t processed = qpk->ins_cb.write_ins_cb(XQC_INS_TYPE_ENCODER, buf, qpk->user_data);
     if (processed < 0) {
         xqc_log(qpk->log, XQC_LOG_ERROR, "|write instruction error|%d|", processed);
         return -XQC_H3_EQPACK_ENCODE;
@@ -545,6 +593,12 @@ xqc_qpack_set_enc_insert_limit(xqc_qpack_t *qpk, double name_limit, double entry
     xqc_encoder_set_insert_limit(qpk->enc, name_limit, entry_limit);
 }
 
+xqc_int_t
+xqc_qpack_set_enc_insert_threshold(xqc_qpack_t *qpk, uint32_t threshold)
+{
+    return xqc_encoder_set_insert_threshold(qpk->enc, threshold);
+}
+
 #ifdef XQC_COMPAT_DUPLICATE
 void
 xqc_qpack_set_compat_dup(xqc_qpack_t *qpk, xqc_bool_t compat)
@@ -137,6 +137,15 @@ uint64_t xqc_qpack_get_req_rqrd_insert_cnt(void *ctx);
  */
 void xqc_qpack_set_enc_insert_limit(xqc_qpack_t *qpk, double name_limit, double entry_limit);
 
+/**
+ * @brief set encoder's dtable insert threshold. field lines seen less than threshold times
+ * recently will not be inserted into dtable and be sent as Literal Field Lines, which avoids
+ * evicting frequent entries with those used only once.
+ * @param threshold min recent occurrences of a field line before insertion, 0 for no limit
+ * @return XQC_OK for success, others for failure
+ */
+xqc_int_t xqc_qpack_set_enc_insert_threshold(xqc_qpack_t *qpk, uint32_t threshold);
+
 
 /**
  * @brief decode bytes from request stream
@@ -163,6 +172,15 @@ ssize_t xqc_qpack_dec_headers(xqc_qpack_t *qpk, xqc_rep_ctx_t *req_ctx, unsigned
 xqc_int_t xqc_qpack_enc_headers(xqc_qpack_t *qpk, uint64_t stream_id,
     xqc_http_headers_t *headers, xqc_var_buf_t *rep_buf);
 
+/**
+ * @brief encode a header template and http headers to encoded field section
+ * @param tmpl header template, NULL is the same with xqc_qpack_enc_headers
+ * @param headers h3 request headers, might be NULL if tmpl is not NULL
+ * @return XQC_OK for success, < 0 for failure
+ */
+xqc_int_t xqc_qpack_enc_headers_tmpl(xqc_qpack_t *qpk, uint64_t stream_id,
+    xqc_h3_hdr_tmpl_t *tmpl, xqc_http_headers_t *headers, xqc_var_buf_t *rep_buf);
+
 #ifdef XQC_COMPAT_DUPLICATE
 /**
  * @brief compat with the duplicate operation on encoder's side, which is wrong.
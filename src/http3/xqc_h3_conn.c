@@ -4,6 +4,7 @@
 
 #include "src/http3/xqc_h3_conn.h"
 #include "src/http3/xqc_h3_ctx.h"
+#include "src/http3/xqc_h3_request.h"
 
 #include "src/transport/xqc_engine.h"
 #include "src/transport/xqc_stream.h"
@@ -17,6 +18,7 @@ const xqc_h3_conn_settings_t default_local_h3_conn_settings = {
     .qpack_blocked_streams          = XQC_QPACK_MAX_BLOCK_STREAM,
     .qpack_enc_max_table_capacity   = XQC_QPACK_MAX_TABLE_CAPACITY,
     .qpack_dec_max_table_capacity   = XQC_QPACK_MAX_TABLE_CAPACITY,
+    .qpack_insert_threshold         = 0,
 #ifdef XQC_COMPAT_DUPLICATE
     .qpack_compat_duplicate         = XQC_FALSE,
 #endif
@@ -174,6 +176,26 @@ xqc_h3_engine_set_qpack_blocked_streams(xqc_engine_t *engine, size_t value)
     }
 }
 
+void
+xqc_h3_engine_set_qpack_insert_threshold(xqc_engine_t *engine, uint32_t threshold)
+{
+    xqc_h3_conn_settings_t *settings;
+
+    if (xqc_h3_ctx_get_default_conn_settings(engine, XQC_ALPN_H3, strlen(XQC_ALPN_H3), &settings) == XQC_OK) {
+        settings->qpack_insert_threshold = threshold;
+    }
+
+    if (xqc_h3_ctx_get_default_conn_settings(engine, XQC_ALPN_H3_29, strlen(XQC_ALPN_H3_29), &settings) == XQC_OK) {
+        settings->qpack_insert_threshold = threshold;
+    }
+
+    if (engine->config->enable_h3_ext) {
+        if (xqc_h3_ctx_get_default_conn_settings(engine, XQC_ALPN_H3_EXT, strlen(XQC_ALPN_H3_EXT), &settings) == XQC_OK) {
+            settings->qpack_insert_threshold = threshold;
+        } 
+    }
+}
+
 #ifdef XQC_COMPAT_DUPLICATE
 void
 xqc_h3_engine_set_qpack_compat_duplicate(xqc_engine_t *engine, xqc_bool_t cmpt)
@@ -353,6 +375,48 @@ xqc_h3_conn_send_ins(xqc_qpack_ins_type_t type, xqc_var_buf_t *buf, void *user_d
     return sent;
 }
 
+unsigned char *
+xqc_h3_conn_get_hdr_scratch(xqc_h3_conn_t *h3c, size_t size)
+{
+    if (size > h3c->hdr_scratch_cap) {
+        /* grow geometrically, old content is discarded */
+        size_t cap = xqc_max(size, h3c->hdr_scratch_cap * 2);
+        unsigned char *scratch = xqc_malloc(cap);
+        if (scratch == NULL) {
+            xqc_log(h3c->log, XQC_LOG_ERROR, "|malloc error|size:%uz|", cap);
+            return NULL;
+        }
+
+        if (h3c->hdr_scratch) {
+            xqc_free(h3c->hdr_scratch);
+        }
+        h3c->hdr_scratch = scratch;
+        h3c->hdr_scratch_cap = cap;
+    }
+
+    return h3c->hdr_scratch;
+}
+
+xqc_var_buf_t *
+xqc_h3_conn_get_hdr_frame_buf(xqc_h3_conn_t *h3c, size_t size)
+{
+    if (h3c->hdr_frame_buf == NULL) {
+        h3c->hdr_frame_buf = xqc_var_buf_create(xqc_max(size, XQC_VAR_BUF_INIT_SIZE));
+        if (h3c->hdr_frame_buf == NULL) {
+            xqc_log(h3c->log, XQC_LOG_ERROR, "|create HEADERS frame buffer error|");
+            return NULL;
+        }
+    }
+
+    xqc_var_buf_clear(h3c->hdr_frame_buf);
+    if (xqc_var_buf_save_prepare(h3c->hdr_frame_buf, size) != XQC_OK) {
+        xqc_log(h3c->log, XQC_LOG_ERROR, "|prepare HEADERS frame buffer error|size:%uz|", size);
+        return NULL;
+    }
+
+    return h3c->hdr_frame_buf;
+}
+
 xqc_var_buf_t *
 xqc_h3_conn_get_ins_buf(xqc_qpack_ins_type_t type, void *user_data)
 {
@@ -509,6 +573,13 @@ xqc_h3_conn_create(xqc_connection_t *conn, void *user_data)
         goto fail;
     }
 
+    if (xqc_qpack_set_enc_insert_threshold(h3c->qpack,
+            h3c->local_h3_conn_settings.qpack_insert_threshold) != XQC_OK)
+    {
+        xqc_log(h3c->log, XQC_LOG_ERROR, "|set qpack insert threshold failed|");
+        goto fail;
+    }
+
 #ifdef XQC_COMPAT_DUPLICATE
     xqc_qpack_set_compat_dup(h3c->qpack, h3c->local_h3_conn_settings.qpack_compat_duplicate);
 #endif
@@ -549,6 +620,14 @@ xqc_h3_conn_destroy(xqc_h3_conn_t *h3_conn)
     xqc_h3_conn_destroy_blocked_stream_list(h3_conn);
     xqc_qpack_destroy(h3_conn->qpack);
 
+    if (h3_conn->hdr_scratch) {
+        xqc_free(h3_conn->hdr_scratch);
+    }
+
+    if (h3_conn->hdr_frame_buf) {
+        xqc_var_buf_free(h3_conn->hdr_frame_buf);
+    }
+
     xqc_log(h3_conn->log, XQC_LOG_DEBUG, "|success|");
     xqc_free(h3_conn);
 }
@@ -734,6 +813,54 @@ xqc_h3_conn_on_settings_entry_received(uint64_t identifier, uint64_t value, void
     return XQC_OK;
 }
 
+xqc_int_t
+xqc_h3_conn_on_priority_update(xqc_h3_conn_t *h3c, uint64_t element_id,
+    xqc_var_buf_t *field_value)
+{
+    xqc_int_t ret;
+    xqc_h3_priority_t prio;
+    xqc_stream_t *stream;
+    xqc_h3_stream_t *h3s;
+
+    /* prioritized element of PRIORITY_UPDATE must be a client-initiated bidirectional stream */
+    if (xqc_get_stream_type(element_id) != XQC_CLI_BID) {
+        xqc_log(h3c->log, XQC_LOG_ERROR, "|invalid prioritized element id|id:%ui|", element_id);
+        return -H3_ID_ERROR;
+    }
+
+    /* field value buffer was created with one more byte for the terminator */
+    if (field_value == NULL || xqc_var_buf_save_prepare(field_value, 1) != XQC_OK) {
+        return -H3_FRAME_ERROR;
+    }
+    field_value->data[field_value->data_len] = '\0';
+
+    ret = xqc_parse_http_priority(&prio, field_value->data, field_value->data_len);
+    if (ret != XQC_OK || xqc_h3_request_check_priority(&prio) != XQC_OK) {
+        /* malformed priority field value should be ignored */
+        xqc_log(h3c->log, XQC_LOG_WARN, "|ignore invalid priority field value|id:%ui|", element_id);
+        return XQC_OK;
+    }
+
+    stream = xqc_find_stream_by_id(element_id, h3c->conn->streams_hash);
+    if (stream == NULL || stream->user_data == NULL) {
+        /* stream not opened yet or already closed */
+        xqc_log(h3c->log, XQC_LOG_INFO, "|PRIORITY_UPDATE for unknown stream|id:%ui|", element_id);
+        return XQC_OK;
+    }
+
+    h3s = (xqc_h3_stream_t *)stream->user_data;
+    if (h3s->type != XQC_H3_STREAM_TYPE_REQUEST) {
+        xqc_log(h3c->log, XQC_LOG_INFO, "|PRIORITY_UPDATE for non-request stream|id:%ui|", element_id);
+        return XQC_OK;
+    }
+
+    xqc_log(h3c->log, XQC_LOG_DEBUG, "|PRIORITY_UPDATE|id:%ui|urgency:%ud|incremental:%ud|",
+            element_id, (unsigned int)prio.urgency, (unsigned int)prio.incremental);
+    xqc_h3_stream_update_priority(h3s, &prio);
+
+    return XQC_OK;
+}
+
 xqc_qpack_t *
 xqc_h3_conn_get_qpack(xqc_h3_conn_t *h3c)
 {
@@ -96,6 +96,14 @@ typedef struct xqc_h3_conn_s {
     /* h3 settings */
     xqc_h3_conn_settings_t       local_h3_conn_settings; /* set by user for sending to the peer */
     xqc_h3_conn_settings_t       peer_h3_conn_settings;  /* receive from peer */
+
+    /*
+     * scratch memory reused by every request on this connection when sending headers,
+     * headers normalization and encoded HEADERS frame are built here
+     */
+    unsigned char               *hdr_scratch;
+    size_t                       hdr_scratch_cap;
+    xqc_var_buf_t               *hdr_frame_buf;
 } xqc_h3_conn_t;
 
 
@@ -121,6 +129,12 @@ xqc_bool_t xqc_h3_conn_is_goaway_recved(xqc_h3_conn_t *h3c, uint64_t stream_id);
 xqc_int_t xqc_h3_conn_on_settings_entry_received(uint64_t identifier, uint64_t value,
     void *user_data);
 
+/**
+ * reprioritize request stream on PRIORITY_UPDATE frame received from control stream
+ */
+xqc_int_t xqc_h3_conn_on_priority_update(xqc_h3_conn_t *h3c, uint64_t element_id,
+    xqc_var_buf_t *field_value);
+
 /**
  * get qpack instance
  * this is used to encode or decode http headers in xqc_h3_stream_t
@@ -136,6 +150,17 @@ void xqc_h3_conn_remove_blocked_stream(xqc_h3_conn_t *h3c, xqc_h3_blocked_stream
 
 xqc_int_t xqc_h3_conn_process_blocked_stream(xqc_h3_conn_t *h3c);
 
+/**
+ * get scratch memory of at least size bytes for headers normalization, the content of the
+ * scratch is not preserved between calls
+ */
+unsigned char *xqc_h3_conn_get_hdr_scratch(xqc_h3_conn_t *h3c, size_t size);
+
+/**
+ * get the reusable buffer for building HEADERS frame, which is cleared before return
+ */
+xqc_var_buf_t *xqc_h3_conn_get_hdr_frame_buf(xqc_h3_conn_t *h3c, size_t size);
+
 xqc_var_buf_t *xqc_h3_conn_get_ins_buf(xqc_qpack_ins_type_t type, void *user_data);
 
 ssize_t xqc_h3_conn_send_ins(xqc_qpack_ins_type_t type, xqc_var_buf_t *buf, void *user_data);
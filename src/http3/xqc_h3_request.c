@@ -479,60 +479,56 @@ xqc_h3_request_set_user_data(xqc_h3_request_t *h3_request, void *user_data)
 }
 
 
-xqc_int_t
-xqc_h3_request_make_name_lowercase(xqc_http_header_t *dst, xqc_http_header_t *src,
-    xqc_var_buf_t *buf)
+static inline xqc_bool_t
+xqc_h3_request_name_has_uppercase(xqc_http_header_t *hdr)
 {
-    xqc_int_t       ret;
-    xqc_bool_t      use_original_buf    = XQC_TRUE; /* whether use memory from original header */
-
-    for (size_t i = 0; i < src->name.iov_len; i++) {
-        unsigned char c = ((char *)src->name.iov_base)[i];
+    for (size_t i = 0; i < hdr->name.iov_len; i++) {
+        unsigned char c = ((unsigned char *)hdr->name.iov_base)[i];
 
         /* uppercase character found */
         if (c >= 'A' && c <= 'Z') {
-            use_original_buf = XQC_FALSE;
-            break;
+            return XQC_TRUE;
         }
     }
 
+    return XQC_FALSE;
+}
+
+/*
+ * make lowercase name of src to dst. if src is not all lowercase, the name is copied to the
+ * memory pointed by lc_pos, which shall be large enough, and lc_pos is moved forward
+ */
+xqc_int_t
+xqc_h3_request_make_name_lowercase(xqc_http_header_t *dst, xqc_http_header_t *src,
+    unsigned char **lc_pos)
+{
     /* all lower case, do not need to copy */
-    if (use_original_buf == XQC_TRUE) {
+    if (!xqc_h3_request_name_has_uppercase(src)) {
         dst->name.iov_base = src->name.iov_base;
         dst->name.iov_len = src->name.iov_len;
         return XQC_OK;
     }
 
-    /* copy to new buffer */
-    /* check capacity */
-    if (buf->buf_len - buf->data_len < src->name.iov_len + 1) {
-        return -XQC_ELIMIT;
-    }
-    
-    /* make memory from var buf the memory of lowercase header */
-    unsigned char *lc_dst = buf->data + buf->data_len;
-    unsigned char *lc_src = lc_dst;
-    
+    unsigned char *lc_dst = *lc_pos;
+
     /* convert reset characters to lowercase */
     xqc_str_tolower(lc_dst, src->name.iov_base, src->name.iov_len);
-    lc_dst += src->name.iov_len;
-    
+
     /* add terminator */
-    *lc_dst = '\0';
-    
-    buf->data_len += (src->name.iov_len + 1);
+    lc_dst[src->name.iov_len] = '\0';
+    *lc_pos += (src->name.iov_len + 1);
 
-    dst->name.iov_base = lc_src;
+    dst->name.iov_base = lc_dst;
     dst->name.iov_len = src->name.iov_len;
 
     return XQC_OK;
 }
 
 xqc_int_t
-xqc_h3_request_copy_header(xqc_http_header_t *dst, xqc_http_header_t *src, xqc_var_buf_t *buf)
+xqc_h3_request_copy_header(xqc_http_header_t *dst, xqc_http_header_t *src, unsigned char **lc_pos)
 {
     /* try to make field name to lower-case if upper-case characters is contained */
-    xqc_int_t ret = xqc_h3_request_make_name_lowercase(dst, src, buf);
+    xqc_int_t ret = xqc_h3_request_make_name_lowercase(dst, src, lc_pos);
     if (ret != XQC_OK) {
         return ret;
     }
@@ -545,37 +541,92 @@ xqc_h3_request_copy_header(xqc_http_header_t *dst, xqc_http_header_t *src, xqc_v
     return XQC_OK;
 }
 
-ssize_t
-xqc_h3_request_send_headers(xqc_h3_request_t *h3_request, xqc_http_headers_t *headers, uint8_t fin)
+static ssize_t
+xqc_h3_request_send_headers_inner(xqc_h3_request_t *h3_request, xqc_h3_hdr_tmpl_t *tmpl,
+    xqc_http_headers_t *headers, uint8_t fin)
 {
     xqc_int_t ret;
 
     ssize_t sent = 0;
-    int i = 0;
-    int pt = 0;
+    size_t i = 0;
+    size_t pt = 0;
+    size_t lc_len = 0;
+    size_t total_len = 0;
+    xqc_bool_t pseudo = XQC_TRUE;
+    xqc_bool_t normalized = XQC_TRUE;
+    xqc_http_headers_t empty_headers = {0};
+    xqc_http_headers_t new_headers;
+    xqc_http_headers_t *headers_in = &new_headers;
 
     if (!headers) {
-        xqc_log(h3_request->h3_stream->log, XQC_LOG_ERROR, "|headers MUST NOT be NULL|");
-        return -XQC_H3_EPARAM;
+        if (tmpl == NULL) {
+            xqc_log(h3_request->h3_stream->log, XQC_LOG_ERROR, "|headers MUST NOT be NULL|");
+            return -XQC_H3_EPARAM;
+        }
+
+        /* all field lines are from template */
+        headers = &empty_headers;
+    }
+
+    /*
+     * check whether headers are already normalized, that is, all names are non-empty and
+     * lowercase, and pseudo headers are in the front of list. this is the common case, and
+     * headers could be sent without being copied.
+     */
+    for (i = 0; i < headers->count; i++) {
+        xqc_http_header_t *hdr = &headers->headers[i];
+        if (hdr->name.iov_len == 0) {
+            normalized = XQC_FALSE;
+            continue;
+        }
+
+        if (*((unsigned char *)hdr->name.iov_base) == ':') {
+            if (!pseudo) {
+                normalized = XQC_FALSE;
+            }
+
+        } else {
+            pseudo = XQC_FALSE;
+        }
+
+        if (xqc_h3_request_name_has_uppercase(hdr)) {
+            lc_len += hdr->name.iov_len + 1;
+            normalized = XQC_FALSE;
+        }
+
+        /* nv hit flags are saved to the src_header of copied headers */
+        if (hdr->save_nv_hit_flags) {
+            normalized = XQC_FALSE;
+        }
+
+        total_len += hdr->name.iov_len + hdr->value.iov_len;
     }
 
-    /* used to convert upper case filed line key to lowercase */
-    xqc_var_buf_t *lowercase_buf = xqc_var_buf_create(XQC_H3_HEADERS_LOWERCASE_BUF_SIZE);
-    if (NULL == lowercase_buf) {
-        xqc_log(h3_request->h3_stream->log, XQC_LOG_ERROR, "|malloc buf for lowercase error|");
-        return -XQC_EMALLOC;
+    if (normalized) {
+        *headers_in = *headers;
+        headers_in->total_len = total_len;
+        goto send;
     }
 
-    /*  malloc a new  move pseudo headers in the front of list */
-    xqc_http_headers_t new_headers;
-    xqc_http_headers_t *headers_in = &new_headers;
-    headers_in->headers = xqc_malloc(headers->count * sizeof(xqc_http_header_t));
-    if (headers_in->headers == NULL) {
-        xqc_log(h3_request->h3_stream->log, XQC_LOG_ERROR, "|malloc error|");
-        sent = -XQC_H3_EMALLOC;
-        goto end;
+    if (lc_len > XQC_H3_HEADERS_LOWERCASE_BUF_SIZE) {
+        xqc_log(h3_request->h3_stream->log, XQC_LOG_ERROR,
+                "|uppercase field names too large|size:%uz|", lc_len);
+        return -XQC_ELIMIT;
+    }
+
+    /*
+     * move pseudo headers in the front of list. the new list and lowercase names are
+     * built in the scratch memory of h3 connection, which is reused across requests
+     */
+    size_t hdrs_size = headers->count * sizeof(xqc_http_header_t);
+    unsigned char *scratch = xqc_h3_conn_get_hdr_scratch(h3_request->h3_stream->h3c,
+                                                         xqc_max(hdrs_size + lc_len, 1));
+    if (scratch == NULL) {
+        return -XQC_H3_EMALLOC;
     }
 
+    unsigned char *lc_pos = scratch + hdrs_size;
+    headers_in->headers = (xqc_http_header_t *)scratch;
     headers_in->capacity = headers->count;
     headers_in->total_len = 0;
 
@@ -585,15 +636,14 @@ xqc_h3_request_send_headers(xqc_h3_request_t *h3_request, xqc_http_headers_t *he
             && *((unsigned char *)headers->headers[i].name.iov_base) == ':')
         {
             ret = xqc_h3_request_copy_header(&headers_in->headers[pt],
-                                             &headers->headers[i], lowercase_buf);
+                                             &headers->headers[i], &lc_pos);
             if (ret != XQC_OK) {
                 xqc_log(h3_request->h3_stream->log, XQC_LOG_ERROR,
                         "|copy header error|ret:%d|", ret);
-                sent = ret;
-                goto end;
+                return ret;
             }
             headers_in->total_len +=
-                (headers->headers[pt].name.iov_len + headers->headers[pt].value.iov_len);
+                (headers_in->headers[pt].name.iov_len + headers_in->headers[pt].value.iov_len);
             pt++;
         }
     }
@@ -604,32 +654,46 @@ xqc_h3_request_send_headers(xqc_h3_request_t *h3_request, xqc_http_headers_t *he
             && *((unsigned char *)headers->headers[i].name.iov_base) != ':')
         {
             ret = xqc_h3_request_copy_header(&headers_in->headers[pt],
-                                             &headers->headers[i], lowercase_buf);
+                                             &headers->headers[i], &lc_pos);
             if (ret != XQC_OK) {
                 xqc_log(h3_request->h3_stream->log, XQC_LOG_ERROR,
                         "|copy header error|ret:%d|", ret);
-                sent = ret;
-                goto end;
+                return ret;
             }
 
             headers_in->total_len +=
-                (headers->headers[pt].name.iov_len + headers->headers[pt].value.iov_len);
+                (headers_in->headers[pt].name.iov_len + headers_in->headers[pt].value.iov_len);
             pt++;
         }
     }
 
     headers_in->count = pt;
-    sent = xqc_h3_stream_send_headers(h3_request->h3_stream, headers_in, fin);
-    xqc_h3_request_on_header_send(h3_request);
 
-end:
-    /* free headers_in->headers */
-    xqc_free(headers_in->headers);
-    xqc_var_buf_free(lowercase_buf);
+send:
+    sent = xqc_h3_stream_send_headers_tmpl(h3_request->h3_stream, tmpl, headers_in, fin);
+    xqc_h3_request_on_header_send(h3_request);
 
     return sent;
 }
 
+ssize_t
+xqc_h3_request_send_headers(xqc_h3_request_t *h3_request, xqc_http_headers_t *headers, uint8_t fin)
+{
+    return xqc_h3_request_send_headers_inner(h3_request, NULL, headers, fin);
+}
+
+ssize_t
+xqc_h3_request_send_headers_tmpl(xqc_h3_request_t *h3_request, xqc_h3_hdr_tmpl_t *tmpl,
+    xqc_http_headers_t *headers, uint8_t fin)
+{
+    if (tmpl == NULL) {
+        xqc_log(h3_request->h3_stream->log, XQC_LOG_ERROR, "|header template MUST NOT be NULL|");
+        return -XQC_H3_EPARAM;
+    }
+
+    return xqc_h3_request_send_headers_inner(h3_request, tmpl, headers, fin);
+}
+
 
 ssize_t
 xqc_h3_request_send_body(xqc_h3_request_t *h3_request, unsigned char *data, size_t data_size,
@@ -1171,4 +1235,41 @@ xqc_h3_request_set_priority(xqc_h3_request_t *h3r, xqc_h3_priority_t *prio)
     xqc_h3_stream_set_priority(h3r->h3_stream, prio);
     xqc_log_event(h3r->h3_stream->log, HTTP_PRIORITY_UPDATED, prio, h3r->h3_stream);
     return XQC_OK;
+}
+
+xqc_int_t
+xqc_h3_request_update_priority(xqc_h3_request_t *h3r, xqc_h3_priority_t *prio)
+{
+    xqc_h3_stream_t *h3s = h3r->h3_stream;
+    xqc_h3_conn_t *h3c = h3s->h3c;
+
+    xqc_int_t ret = xqc_h3_request_check_priority(prio);
+    if (ret != XQC_OK) {
+        xqc_log(h3s->log, XQC_LOG_ERROR,
+                "|xqc_h3_request_check_priority error|%d|stream_id:%ui|conn:%p|",
+                ret, h3s->stream_id, h3c->conn);
+        return ret;
+    }
+
+    /* reprioritize local sending */
+    xqc_h3_stream_update_priority(h3s, prio);
+
+    /* client notifies server with PRIORITY_UPDATE on control stream */
+    if (h3c->conn->conn_type == XQC_CONN_TYPE_CLIENT) {
+        if (h3c->control_stream_out == NULL) {
+            xqc_log(h3s->log, XQC_LOG_ERROR, "|control stream not created|stream_id:%ui|",
+                    h3s->stream_id);
+            return -XQC_H3_CONTROL_ERROR;
+        }
+
+        ret = xqc_h3_stream_send_priority_update(h3c->control_stream_out, h3s->stream_id, prio);
+        if (ret != XQC_OK) {
+            xqc_log(h3s->log, XQC_LOG_ERROR, "|send PRIORITY_UPDATE error|%d|stream_id:%ui|",
+                    ret, h3s->stream_id);
+            return ret;
+        }
+    }
+
+    xqc_log_event(h3s->log, HTTP_PRIORITY_UPDATED, prio, h3s);
+    return XQC_OK;
 }
\ No newline at end of file
@@ -116,4 +116,6 @@ void xqc_h3_request_begin(xqc_h3_request_t *h3r);
 void xqc_h3_request_end(xqc_h3_request_t *h3r);
 void xqc_h3_request_closing(xqc_h3_request_t *h3r, xqc_int_t err);
 
+xqc_int_t xqc_h3_request_check_priority(xqc_h3_priority_t *prio);
+
 #endif /* _XQC_H3_REQUEST_H_INCLUDED_ */
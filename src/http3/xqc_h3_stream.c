@@ -5,6 +5,7 @@
 #include "src/http3/xqc_h3_stream.h"
 #include "src/http3/xqc_h3_request.h"
 #include "src/http3/qpack/xqc_qpack.h"
+#include "src/http3/qpack/xqc_hdr_tmpl.h"
 #include "src/transport/xqc_stream.h"
 #include "src/transport/xqc_engine.h"
 #include "src/http3/xqc_h3_conn.h"
@@ -183,40 +184,98 @@ xqc_h3_uncompressed_fields_size(xqc_http_headers_t *headers)
 
 
 ssize_t
-xqc_h3_stream_write_headers(xqc_h3_stream_t *h3s, xqc_http_headers_t *headers, uint8_t fin)
+xqc_h3_stream_write_headers(xqc_h3_stream_t *h3s, xqc_h3_hdr_tmpl_t *tmpl,
+    xqc_http_headers_t *headers, uint8_t fin)
 {
     ssize_t processed = 0;
+    ssize_t sent;
 
     /* prepare buf for encoded field section size */
     size_t buf_size = xqc_max(XQC_VAR_BUF_INIT_SIZE, headers->total_len);   /* larger is better */
-    xqc_var_buf_t *data = xqc_var_buf_create(buf_size);
+    if (tmpl) {
+        buf_size += tmpl->efs->data_len;
+    }
+
+    /*
+     * HEADERS frame is built in the buffer of h3 connection which is reused across requests,
+     * with room reserved in front of encoded field section for frame type and length
+     */
+    xqc_var_buf_t *data = xqc_h3_conn_get_hdr_frame_buf(h3s->h3c,
+                                                        buf_size + XQC_H3_FRM_HEADERS_HDR_MAX_LEN);
     if (data == NULL) {
         xqc_log(h3s->log, XQC_LOG_ERROR, "|malloc error|stream_id:%ui|fin:%d|",
                 h3s->stream_id, (unsigned int)fin);
         return -XQC_EMALLOC;
     }
+    data->data_len = XQC_H3_FRM_HEADERS_HDR_MAX_LEN;
+    data->consumed_len = XQC_H3_FRM_HEADERS_HDR_MAX_LEN;
 
     /* encode headers with qpack */
-    xqc_int_t ret = xqc_qpack_enc_headers(h3s->qpack, h3s->stream_id, headers, data);
+    xqc_int_t ret = xqc_qpack_enc_headers_tmpl(h3s->qpack, h3s->stream_id, tmpl, headers, data);
     if (ret != XQC_OK) {
-        xqc_var_buf_free(data);
         return ret;
     }
-    processed += data->data_len;
-    xqc_log_event(h3s->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_FRAME, h3s->stream->stream_id, data->data_len);
+    processed += data->data_len - data->consumed_len;
+    xqc_log_event(h3s->log, QPACK_HEADERS_ENCODED, XQC_LOG_HEADER_FRAME, h3s->stream->stream_id,
+                  data->data_len - data->consumed_len);
 
     /* write HEADERS frame */
-    ret = xqc_h3_frm_write_headers(&h3s->send_buf, data, fin);
+    ret = xqc_h3_frm_write_headers_hdr(data);
     if (ret != XQC_OK) {
         xqc_log(h3s->log, XQC_LOG_ERROR, "|write HEADERS frame error|stream_id:%ui|fin:%d|",
                 h3s->stream_id, (unsigned int)fin);
-        xqc_var_buf_free(data);
         return ret;
     }
     xqc_log_event(h3s->log, HTTP_FRAME_CREATED, h3s, XQC_H3_FRM_HEADERS, headers);
 
+    /*
+     * send HEADERS frame directly if there is nothing buffered before it, only the bytes
+     * blocked by flow control or congestion control are copied to send_buf
+     */
+    xqc_bool_t direct = xqc_list_empty(&h3s->send_buf) && h3s->stream != NULL
+                        && !(h3s->flags & XQC_HTTP3_STREAM_FLAG_FIN_SENT);
+    if (direct) {
+        sent = xqc_stream_send(h3s->stream, data->data + data->consumed_len,
+                               data->data_len - data->consumed_len, fin);
+        if (sent < 0 && sent != -XQC_EAGAIN) {
+            if (sent != -XQC_ESTREAM_RESET) {
+                xqc_log(h3s->log, XQC_LOG_ERROR, "|send HEADERS frame error|%z|stream_id:%ui|"
+                        "fin:%ud|", sent, h3s->stream_id, (unsigned int)fin);
+            }
+            return sent;
+        }
+
+        if (sent > 0) {
+            data->consumed_len += sent;
+        }
+
+        if (data->consumed_len == data->data_len) {
+            if (fin) {
+                h3s->flags |= XQC_HTTP3_STREAM_FLAG_FIN_SENT;
+            }
+            return processed;
+        }
+    }
+
+    /* buffer the remained bytes of HEADERS frame */
+    xqc_var_buf_t *remain = xqc_var_buf_create(data->data_len - data->consumed_len);
+    if (remain == NULL) {
+        xqc_log(h3s->log, XQC_LOG_ERROR, "|malloc error|stream_id:%ui|fin:%d|",
+                h3s->stream_id, (unsigned int)fin);
+        return -XQC_EMALLOC;
+    }
+    xqc_var_buf_save_data(remain, data->data + data->consumed_len,
+                          data->data_len - data->consumed_len);
+    remain->fin_flag = fin;
+
+    ret = xqc_list_buf_to_tail(&h3s->send_buf, remain);
+    if (ret != XQC_OK) {
+        xqc_var_buf_free(remain);
+        return ret;
+    }
+
     /* send HEADERS frame */
-    ret = xqc_h3_stream_send_buffer(h3s);
+    ret = direct ? -XQC_EAGAIN : xqc_h3_stream_send_buffer(h3s);
     if (ret == -XQC_EAGAIN) {
         xqc_log(h3s->log, XQC_LOG_DEBUG, "|send HEADERS frame eagain|stream_id:%ui|fin:%ud|",
                 h3s->stream_id, (unsigned int)fin);
@@ -324,6 +383,39 @@ xqc_h3_stream_write_goaway_to_buffer(xqc_h3_stream_t *h3s, uint64_t push_id, uin
     return XQC_OK;
 }
 
+xqc_int_t
+xqc_h3_stream_write_priority_update_to_buffer(xqc_h3_stream_t *h3s, uint64_t element_id,
+    xqc_h3_priority_t *prio, uint8_t fin)
+{
+    /* priority field value sent in PRIORITY_UPDATE carries only urgency and incremental */
+    unsigned char field_value[16];
+    unsigned char *p = field_value;
+    p = xqc_cpymem(p, "u=", xqc_lengthof("u="));
+    *p++ = '0' + prio->urgency;
+    if (prio->incremental) {
+        p = xqc_cpymem(p, ", i", xqc_lengthof(", i"));
+    }
+
+    xqc_int_t ret = xqc_h3_frm_write_priority_update(&h3s->send_buf, element_id,
+                                                     field_value, p - field_value, fin);
+    if (ret != XQC_OK) {
+        xqc_log(h3s->log, XQC_LOG_ERROR, "|write PRIORITY_UPDATE frame error|%d|stream_id:%ui|fin:%d|",
+                ret, h3s->stream_id, (unsigned int)fin);
+        return ret;
+    }
+    xqc_log(h3s->log, XQC_LOG_DEBUG, "|write PRIORITY_UPDATE|element_id:%ui|urgency:%ud|incremental:%ud|",
+            element_id, (unsigned int)prio->urgency, (unsigned int)prio->incremental);
+
+    ret = xqc_h3_stream_send_buffer(h3s);
+    if (ret < 0 && ret != -XQC_EAGAIN) {
+        xqc_log(h3s->log, XQC_LOG_ERROR, "|send PRIORITY_UPDATE frame error|%d|stream_id:%ui|fin:%d|",
+                ret, h3s->stream_id, (unsigned int)fin);
+        return ret;
+    }
+
+    return XQC_OK;
+}
+
 xqc_int_t
 xqc_h3_stream_write_bidi_stream_type_to_buffer(xqc_h3_stream_t *h3s, uint64_t stype, uint8_t fin)
 {
@@ -350,14 +442,22 @@ xqc_h3_stream_write_bidi_stream_type_to_buffer(xqc_h3_stream_t *h3s, uint64_t st
 
 ssize_t
 xqc_h3_stream_send_headers(xqc_h3_stream_t *h3s, xqc_http_headers_t *headers, uint8_t fin)
+{
+    return xqc_h3_stream_send_headers_tmpl(h3s, NULL, headers, fin);
+}
+
+ssize_t
+xqc_h3_stream_send_headers_tmpl(xqc_h3_stream_t *h3s, xqc_h3_hdr_tmpl_t *tmpl,
+    xqc_http_headers_t *headers, uint8_t fin)
 {
     xqc_h3_conn_t  *h3c;
     uint64_t        fields_size;
     uint64_t        max_field_section_size;
     ssize_t         write;
+    size_t          total_len = headers->total_len;
 
     /* nothing to send */
-    if (headers->count == 0) {
+    if (headers->count == 0 && tmpl == NULL) {
         return 0;
     }
 
@@ -365,6 +465,10 @@ xqc_h3_stream_send_headers(xqc_h3_stream_t *h3s, xqc_http_headers_t *headers, ui
 
     /* header size constrains */
     fields_size = xqc_h3_uncompressed_fields_size(headers);
+    if (tmpl) {
+        fields_size += tmpl->total_len + tmpl->count * 32;
+        total_len += tmpl->total_len;
+    }
     max_field_section_size = h3c->peer_h3_conn_settings.max_field_section_size;
     if (fields_size > max_field_section_size) {
         xqc_log(h3c->log, XQC_LOG_ERROR, "|large nv|conn:%p|fields_size:%ui|exceed|"
@@ -376,7 +480,7 @@ xqc_h3_stream_send_headers(xqc_h3_stream_t *h3s, xqc_http_headers_t *headers, ui
     h3s->flags |= XQC_HTTP3_STREAM_NEED_WRITE_NOTIFY;
 
     /* QPACK & gen HEADERS frame */
-    write = xqc_h3_stream_write_headers(h3s, headers, fin);
+    write = xqc_h3_stream_write_headers(h3s, tmpl, headers, fin);
     if (write < 0) {
         xqc_log(h3c->log, XQC_LOG_ERROR, "|xqc_h3_stream_write_headers error|ret:%z||stream_id:%ui",
                 write, h3s->stream_id);
@@ -386,7 +490,7 @@ xqc_h3_stream_send_headers(xqc_h3_stream_t *h3s, xqc_http_headers_t *headers, ui
         h3s->h3r->compressed_header_sent += write;
     }
     /* header_sent is the sum of plaintext header name value length */
-    h3s->h3r->header_sent += headers->total_len;
+    h3s->h3r->header_sent += total_len;
 
     xqc_log(h3c->log, XQC_LOG_DEBUG, "|write:%z|stream_id:%ui|fin:%ud|conn:%p|flag:%s|", write,
             h3s->stream_id, (unsigned int)fin, h3c->conn, xqc_conn_flag_2_str(h3c->conn, h3c->conn->conn_flag));
@@ -640,6 +744,20 @@ xqc_h3_stream_send_goaway(xqc_h3_stream_t *h3s, uint64_t push_id, uint8_t fin)
     return XQC_OK;
 }
 
+xqc_int_t
+xqc_h3_stream_send_priority_update(xqc_h3_stream_t *h3s, uint64_t element_id,
+    xqc_h3_priority_t *prio)
+{
+    xqc_int_t ret = xqc_h3_stream_write_priority_update_to_buffer(h3s, element_id, prio, 0);
+    if (ret < 0) {
+        return ret;
+    }
+
+    xqc_engine_conn_logic(h3s->h3c->conn->engine, h3s->h3c->conn);
+
+    return XQC_OK;
+}
+
 xqc_int_t 
 xqc_h3_stream_send_bidi_stream_type(xqc_h3_stream_t *h3s, 
     xqc_h3_bidi_stream_type_t stype, uint8_t fin)
@@ -723,6 +841,7 @@ xqc_h3_stream_process_control(xqc_h3_stream_t *h3s, unsigned char *data, size_t
     xqc_h3_frame_pctx_t *pctx = &h3s->pctx.frame_pctx;
     xqc_h3_frame_pl_t *pl = &pctx->frame.frame_payload;
 
+    xqc_int_t ret;
     ssize_t processed = 0;
     while (processed < data_len) {
         ssize_t read = xqc_h3_frm_parse(data + processed, data_len - processed, pctx);
@@ -794,6 +913,30 @@ xqc_h3_stream_process_control(xqc_h3_stream_t *h3s, unsigned char *data, size_t
                 h3c->max_stream_id_recvd = pl->max_push_id.push_id.vi;
                 break;
 
+            case XQC_H3_FRM_PRIORITY_UPDATE_REQUEST:
+            case XQC_H3_FRM_PRIORITY_UPDATE_PUSH:
+                /* PRIORITY_UPDATE is only sent by client */
+                if (h3c->conn->conn_type == XQC_CONN_TYPE_CLIENT) {
+                    xqc_h3_frm_reset_pctx(pctx);
+                    return -H3_FRAME_UNEXPECTED;
+                }
+
+                if (pctx->frame.type == XQC_H3_FRM_PRIORITY_UPDATE_PUSH) {
+                    /* PUSH related is not implemented yet */
+                    xqc_log(h3c->log, XQC_LOG_INFO, "|ignore PRIORITY_UPDATE for push|push_id:%ui|",
+                            pl->priority_update.prioritized_element_id.vi);
+                    break;
+                }
+
+                ret = xqc_h3_conn_on_priority_update(h3c,
+                                                     pl->priority_update.prioritized_element_id.vi,
+                                                     pl->priority_update.priority_field_value);
+                if (ret != XQC_OK) {
+                    xqc_h3_frm_reset_pctx(pctx);
+                    return ret;
+                }
+                break;
+
             default:
                 /* ignore unknown h3 frame */
                 xqc_log(h3c->log, XQC_LOG_INFO, "|ignore unknown frame|"
@@ -2126,5 +2269,25 @@ xqc_h3_stream_set_priority(xqc_h3_stream_t *h3s, xqc_h3_priority_t *prio)
         xqc_stream_set_multipath_usage(h3s->stream, h3s->priority.schedule, h3s->priority.reinject);
         h3s->stream->stream_fec_blk_mode = xqc_set_stream_fec_block_mode(h3s->priority.fec);
         h3s->h3r->block_size_mode = h3s->stream->stream_fec_blk_mode;
+
+        /* PRIORITY_UPDATE frame takes precedence over priority header field */
+        if (!(h3s->flags & XQC_HTTP3_STREAM_FLAG_PRIORITY_UPDATED)) {
+            xqc_stream_set_urgency(h3s->stream, h3s->priority.urgency, h3s->priority.incremental);
+        }
     }
 }
+
+void
+xqc_h3_stream_update_priority(xqc_h3_stream_t *h3s, xqc_h3_priority_t *prio)
+{
+    h3s->flags |= XQC_HTTP3_STREAM_FLAG_PRIORITY_UPDATED;
+    h3s->priority.urgency     = prio->urgency;
+    h3s->priority.incremental = prio->incremental;
+
+    if (h3s->stream == NULL) {
+        xqc_log(h3s->log, XQC_LOG_ERROR, "|transport stream was NULL|stream_id:%ui|", h3s->stream_id);
+        return;
+    }
+
+    xqc_stream_set_urgency(h3s->stream, prio->urgency, prio->incremental);
+}
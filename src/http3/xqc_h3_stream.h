@@ -74,6 +74,10 @@ typedef enum {
     XQC_HTTP3_STREAM_FLAG_ACTIVELY_CLOSED       = 0x1000,
     /* FIN was sent and no data will be sent any more */
     XQC_HTTP3_STREAM_FLAG_FIN_SENT              = 0x2000,
+    /* XQC_HTTP3_STREAM_FLAG_PRIORITY_UPDATED indicates that urgency and
+       incremental were set by PRIORITY_UPDATE, which overrides the ones
+       from priority header field. */
+    XQC_HTTP3_STREAM_FLAG_PRIORITY_UPDATED      = 0x4000,
 } xqc_h3_stream_flag;
 
 typedef struct xqc_h3_stream_pctx_s {
@@ -178,6 +182,10 @@ xqc_int_t xqc_h3_stream_send_uni_stream_hdr(xqc_h3_stream_t *h3s);
 
 ssize_t xqc_h3_stream_send_headers(xqc_h3_stream_t *h3s, xqc_http_headers_t *headers, uint8_t fin);
 
+/* send headers with a header template, headers of request are encoded around template */
+ssize_t xqc_h3_stream_send_headers_tmpl(xqc_h3_stream_t *h3s, xqc_h3_hdr_tmpl_t *tmpl,
+    xqc_http_headers_t *headers, uint8_t fin);
+
 ssize_t xqc_h3_stream_send_data(xqc_h3_stream_t *h3s, unsigned char *data, size_t data_size,
    uint8_t fin);
 
@@ -198,6 +206,12 @@ void xqc_h3_stream_get_path_info(xqc_h3_stream_t *h3s);
 
 void xqc_h3_stream_set_priority(xqc_h3_stream_t *h3s, xqc_h3_priority_t *prio);
 
+/* reprioritize stream with urgency and incremental, e.g. on PRIORITY_UPDATE */
+void xqc_h3_stream_update_priority(xqc_h3_stream_t *h3s, xqc_h3_priority_t *prio);
+
+xqc_int_t xqc_h3_stream_send_priority_update(xqc_h3_stream_t *h3s, uint64_t element_id,
+    xqc_h3_priority_t *prio);
+
 xqc_int_t xqc_h3_stream_send_bidi_stream_type(xqc_h3_stream_t *h3s, 
    xqc_h3_bidi_stream_type_t stype, uint8_t fin);
 
@@ -3,7 +3,11 @@
  */
 
 #include "src/tls/xqc_hkdf.h"
+#include "src/common/xqc_malloc.h"
 #include <openssl/kdf.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
 
 
 xqc_int_t
@@ -93,3 +97,158 @@ err:
     return -XQC_TLS_DERIVE_KEY_ERROR;
 }
 
+
+
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+
+/* hkdf extract is a single hmac keyed with salt, keep the keyed mac state */
+struct xqc_hkdf_salt_s {
+    EVP_MAC_CTX    *mac;
+};
+
+
+xqc_hkdf_salt_t *
+xqc_hkdf_salt_create(const uint8_t *salt, size_t saltlen, const xqc_digest_t *md)
+{
+    EVP_MAC *mac;
+    OSSL_PARAM params[2];
+    xqc_hkdf_salt_t *hs = xqc_calloc(1, sizeof(xqc_hkdf_salt_t));
+    if (hs == NULL) {
+        return NULL;
+    }
+
+    mac = EVP_MAC_fetch(NULL, OSSL_MAC_NAME_HMAC, NULL);
+    if (mac == NULL) {
+        goto fail;
+    }
+
+    hs->mac = EVP_MAC_CTX_new(mac);
+    EVP_MAC_free(mac);
+    if (hs->mac == NULL) {
+        goto fail;
+    }
+
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+                                                 (char *)EVP_MD_get0_name(md->digest), 0);
+    params[1] = OSSL_PARAM_construct_end();
+    if (EVP_MAC_init(hs->mac, salt, saltlen, params) != XQC_SSL_SUCCESS) {
+        goto fail;
+    }
+
+    return hs;
+
+fail:
+    xqc_hkdf_salt_destroy(hs);
+    return NULL;
+}
+
+
+void
+xqc_hkdf_salt_destroy(xqc_hkdf_salt_t *hs)
+{
+    if (hs == NULL) {
+        return;
+    }
+
+    if (hs->mac) {
+        EVP_MAC_CTX_free(hs->mac);
+    }
+    xqc_free(hs);
+}
+
+
+xqc_int_t
+xqc_hkdf_extract_with_salt(uint8_t *dest, size_t destlen, const uint8_t *secret,
+    size_t secretlen, xqc_hkdf_salt_t *hs)
+{
+    size_t len = 0;
+
+    if (destlen < EVP_MAC_CTX_get_mac_size(hs->mac)) {
+        return -XQC_TLS_NOBUF;
+    }
+
+    /* NULL key restores the keyed state of salt */
+    if (EVP_MAC_init(hs->mac, NULL, 0, NULL) != XQC_SSL_SUCCESS
+        || EVP_MAC_update(hs->mac, secret, secretlen) != XQC_SSL_SUCCESS
+        || EVP_MAC_final(hs->mac, dest, &len, destlen) != XQC_SSL_SUCCESS)
+    {
+        return -XQC_TLS_DERIVE_KEY_ERROR;
+    }
+
+    return XQC_OK;
+}
+
+#else
+
+/* no EVP_MAC before openssl 3.0, keep a hkdf context with everything but the secret set */
+struct xqc_hkdf_salt_s {
+    EVP_PKEY_CTX   *pctx;
+    size_t          prklen;
+};
+
+
+xqc_hkdf_salt_t *
+xqc_hkdf_salt_create(const uint8_t *salt, size_t saltlen, const xqc_digest_t *md)
+{
+    xqc_hkdf_salt_t *hs = xqc_calloc(1, sizeof(xqc_hkdf_salt_t));
+    if (hs == NULL) {
+        return NULL;
+    }
+
+    hs->prklen = EVP_MD_size(md->digest);
+    hs->pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, NULL);
+    if (hs->pctx == NULL) {
+        goto fail;
+    }
+
+    if (EVP_PKEY_derive_init(hs->pctx) != XQC_SSL_SUCCESS
+        || EVP_PKEY_CTX_hkdf_mode(hs->pctx, EVP_PKEY_HKDEF_MODE_EXTRACT_ONLY) != XQC_SSL_SUCCESS
+        || EVP_PKEY_CTX_set_hkdf_md(hs->pctx, md->digest) != XQC_SSL_SUCCESS
+        || EVP_PKEY_CTX_set1_hkdf_salt(hs->pctx, salt, saltlen) != XQC_SSL_SUCCESS)
+    {
+        goto fail;
+    }
+
+    return hs;
+
+fail:
+    xqc_hkdf_salt_destroy(hs);
+    return NULL;
+}
+
+
+void
+xqc_hkdf_salt_destroy(xqc_hkdf_salt_t *hs)
+{
+    if (hs == NULL) {
+        return;
+    }
+
+    if (hs->pctx) {
+        EVP_PKEY_CTX_free(hs->pctx);
+    }
+    xqc_free(hs);
+}
+
+
+xqc_int_t
+xqc_hkdf_extract_with_salt(uint8_t *dest, size_t destlen, const uint8_t *secret,
+    size_t secretlen, xqc_hkdf_salt_t *hs)
+{
+    size_t len = hs->prklen;
+
+    if (destlen < hs->prklen) {
+        return -XQC_TLS_NOBUF;
+    }
+
+    if (EVP_PKEY_CTX_set1_hkdf_key(hs->pctx, secret, secretlen) != XQC_SSL_SUCCESS
+        || EVP_PKEY_derive(hs->pctx, dest, &len) != XQC_SSL_SUCCESS)
+    {
+        return -XQC_TLS_DERIVE_KEY_ERROR;
+    }
+
+    return XQC_OK;
+}
+
+#endif
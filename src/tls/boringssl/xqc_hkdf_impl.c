@@ -3,7 +3,9 @@
  */
 
 #include "src/tls/xqc_hkdf.h"
+#include "src/common/xqc_malloc.h"
 #include <openssl/hkdf.h>
+#include <openssl/hmac.h>
 #include <openssl/err.h>
 #include <openssl/chacha.h>
 
@@ -33,3 +35,70 @@ xqc_hkdf_expand(uint8_t *dest, size_t destlen, const uint8_t *secret, size_t sec
 
     return XQC_OK;
 }
+
+
+struct xqc_hkdf_salt_s {
+    HMAC_CTX   *hmac;
+};
+
+
+xqc_hkdf_salt_t *
+xqc_hkdf_salt_create(const uint8_t *salt, size_t saltlen, const xqc_digest_t *md)
+{
+    xqc_hkdf_salt_t *hs = xqc_calloc(1, sizeof(xqc_hkdf_salt_t));
+    if (hs == NULL) {
+        return NULL;
+    }
+
+    /* HKDF_extract is a single hmac keyed with salt, keep the keyed state */
+    hs->hmac = HMAC_CTX_new();
+    if (hs->hmac == NULL) {
+        goto fail;
+    }
+
+    if (HMAC_Init_ex(hs->hmac, salt, saltlen, md->digest, NULL) != XQC_SSL_SUCCESS) {
+        goto fail;
+    }
+
+    return hs;
+
+fail:
+    xqc_hkdf_salt_destroy(hs);
+    return NULL;
+}
+
+
+void
+xqc_hkdf_salt_destroy(xqc_hkdf_salt_t *hs)
+{
+    if (hs == NULL) {
+        return;
+    }
+
+    if (hs->hmac) {
+        HMAC_CTX_free(hs->hmac);
+    }
+    xqc_free(hs);
+}
+
+
+xqc_int_t
+xqc_hkdf_extract_with_salt(uint8_t *dest, size_t destlen, const uint8_t *secret,
+    size_t secretlen, xqc_hkdf_salt_t *hs)
+{
+    unsigned int len = 0;
+
+    if (destlen < HMAC_size(hs->hmac)) {
+        return -XQC_TLS_NOBUF;
+    }
+
+    /* NULL key and md restore the keyed state of salt */
+    if (HMAC_Init_ex(hs->hmac, NULL, 0, NULL, NULL) != XQC_SSL_SUCCESS
+        || HMAC_Update(hs->hmac, secret, secretlen) != XQC_SSL_SUCCESS
+        || HMAC_Final(hs->hmac, dest, &len) != XQC_SSL_SUCCESS)
+    {
+        return -XQC_TLS_DERIVE_KEY_ERROR;
+    }
+
+    return XQC_OK;
+}
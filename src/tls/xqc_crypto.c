@@ -588,13 +588,38 @@ xqc_crypto_is_key_ready(xqc_crypto_t *crypto, xqc_key_type_t type)
 
 /* derive initial secret (for initial encryption level) */
 
+static xqc_int_t
+xqc_crypto_expand_initial_secret(uint8_t *cli_initial_secret, size_t cli_initial_secret_len,
+    uint8_t *svr_initial_secret, size_t svr_initial_secret_len, const uint8_t *initial_secret,
+    const xqc_digest_t *md)
+{
+    static uint8_t LABEL_SVR_IN[] = "server in";
+    static uint8_t LABEL_CLI_IN[] = "client in";
+
+    /* derive client initial secret for packet protection */
+    xqc_int_t ret = xqc_hkdf_expand_label(cli_initial_secret, cli_initial_secret_len,
+                                          initial_secret, INITIAL_SECRET_MAX_LEN,
+                                          LABEL_CLI_IN, xqc_lengthof(LABEL_CLI_IN), md);
+    if (ret != XQC_OK) {
+        return ret;
+    }
+
+    /* derive server initial secret for packet protection */
+    ret = xqc_hkdf_expand_label(svr_initial_secret, svr_initial_secret_len,
+                                initial_secret, INITIAL_SECRET_MAX_LEN,
+                                LABEL_SVR_IN, xqc_lengthof(LABEL_SVR_IN), md);
+    if (ret != XQC_OK) {
+        return ret;
+    }
+
+    return XQC_OK;
+}
+
 xqc_int_t
 xqc_crypto_derive_initial_secret(uint8_t *cli_initial_secret, size_t cli_initial_secret_len,
     uint8_t *svr_initial_secret, size_t svr_initial_secret_len, const xqc_cid_t *cid,
     const uint8_t *salt, size_t saltlen)
 {
-    static uint8_t LABEL_SVR_IN[] = "server in";
-    static uint8_t LABEL_CLI_IN[] = "client in";
     uint8_t initial_secret[INITIAL_SECRET_MAX_LEN] = {0};   /* the common initial secret */
 
     xqc_digest_t md;
@@ -607,23 +632,31 @@ xqc_crypto_derive_initial_secret(uint8_t *cli_initial_secret, size_t cli_initial
         return ret;
     }
 
-    /* derive client initial secret for packet protection */
-    ret = xqc_hkdf_expand_label(cli_initial_secret, cli_initial_secret_len,
-                                initial_secret, INITIAL_SECRET_MAX_LEN,
-                                LABEL_CLI_IN, xqc_lengthof(LABEL_CLI_IN), &md);
-    if (ret != XQC_OK) {
-        return ret;
-    }
+    return xqc_crypto_expand_initial_secret(cli_initial_secret, cli_initial_secret_len,
+                                            svr_initial_secret, svr_initial_secret_len,
+                                            initial_secret, &md);
+}
 
-    /* derive server initial secret for packet protection */
-    ret = xqc_hkdf_expand_label(svr_initial_secret, svr_initial_secret_len,
-                                initial_secret, INITIAL_SECRET_MAX_LEN,
-                                LABEL_SVR_IN, xqc_lengthof(LABEL_SVR_IN), &md);
+xqc_int_t
+xqc_crypto_derive_initial_secret_with_salt(uint8_t *cli_initial_secret,
+    size_t cli_initial_secret_len, uint8_t *svr_initial_secret, size_t svr_initial_secret_len,
+    const xqc_cid_t *cid, xqc_hkdf_salt_t *salt)
+{
+    uint8_t initial_secret[INITIAL_SECRET_MAX_LEN] = {0};   /* the common initial secret */
+
+    xqc_digest_t md;
+    xqc_digest_init_to_sha256(&md);
+
+    /* initial secret, with the extract state bound to salt already */
+    xqc_int_t ret = xqc_hkdf_extract_with_salt(initial_secret, INITIAL_SECRET_MAX_LEN,
+                                               cid->cid_buf, cid->cid_len, salt);
     if (ret != XQC_OK) {
         return ret;
     }
 
-    return XQC_OK;
+    return xqc_crypto_expand_initial_secret(cli_initial_secret, cli_initial_secret_len,
+                                            svr_initial_secret, svr_initial_secret_len,
+                                            initial_secret, &md);
 }
 
 
@@ -109,6 +109,9 @@ typedef struct xqc_digest_s {
     const EVP_MD *digest ;
 } xqc_digest_t;
 
+/* hkdf extract state bound to a salt, see xqc_hkdf_salt_create */
+typedef struct xqc_hkdf_salt_s xqc_hkdf_salt_t;
+
 #define xqc_digest_init_to_sha256(obj)  ((obj)->digest = EVP_sha256())
 #define xqc_digest_init_to_sha384(obj)  ((obj)->digest = EVP_sha384())
 
@@ -255,6 +258,15 @@ xqc_int_t xqc_crypto_derive_initial_secret(
     uint8_t *svr_initial_secret, size_t svr_initial_secret_len,
     const xqc_cid_t *cid, const uint8_t *salt, size_t saltlen);
 
+/**
+ * @brief derive initial level secret with the extract state bound to initial salt, which is
+ * created with sha256 by xqc_hkdf_salt_create
+ */
+xqc_int_t xqc_crypto_derive_initial_secret_with_salt(
+    uint8_t *cli_initial_secret, size_t cli_initial_secret_len,
+    uint8_t *svr_initial_secret, size_t svr_initial_secret_len,
+    const xqc_cid_t *cid, xqc_hkdf_salt_t *salt);
+
 
 ssize_t xqc_crypto_aead_tag_len(xqc_crypto_t *crypto);
 
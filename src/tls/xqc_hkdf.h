@@ -13,6 +13,18 @@ xqc_int_t xqc_hkdf_extract(uint8_t *dest, size_t destlen, const uint8_t *secret,
 xqc_int_t xqc_hkdf_expand(uint8_t *dest, size_t destlen, const uint8_t *secret, size_t secretlen,
     const uint8_t *info, size_t infolen, const xqc_digest_t *md);
 
+/*
+ * hkdf extract state bound to a constant salt, set up once and reused by every extract with the
+ * same salt, e.g. the derivation of initial secret. implemented by each tls backend.
+ */
+xqc_hkdf_salt_t *xqc_hkdf_salt_create(const uint8_t *salt, size_t saltlen,
+    const xqc_digest_t *md);
+
+void xqc_hkdf_salt_destroy(xqc_hkdf_salt_t *hs);
+
+xqc_int_t xqc_hkdf_extract_with_salt(uint8_t *dest, size_t destlen, const uint8_t *secret,
+    size_t secretlen, xqc_hkdf_salt_t *hs);
+
 xqc_int_t xqc_hkdf_expand_label(uint8_t *dest, size_t destlen, const uint8_t *secret,
     size_t secretlen, const uint8_t *label, size_t labellen, const xqc_digest_t *md);
 
@@ -0,0 +1,360 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "src/tls/xqc_session_store.h"
+#include "src/common/xqc_malloc.h"
+#include "src/common/xqc_hash.h"
+#include "src/common/xqc_str.h"
+
+#define XQC_SESSION_LRU_DEFAULT_CAPACITY    4096
+
+/* buckets per entry of shard capacity */
+#define XQC_SESSION_LRU_BUCKET_FACTOR       2
+
+
+static size_t
+xqc_session_lru_pow2(size_t n)
+{
+    size_t v = 1;
+    while (v < n) {
+        v <<= 1;
+    }
+    return v;
+}
+
+
+static xqc_session_lru_shard_t *
+xqc_session_lru_shard(xqc_session_lru_t *lru, uint64_t hash)
+{
+    return &lru->shards[hash & lru->shard_mask];
+}
+
+
+static xqc_list_head_t *
+xqc_session_lru_bucket(xqc_session_lru_shard_t *shard, uint64_t hash)
+{
+    /* low bits are taken by shard selection */
+    return &shard->buckets[(hash >> 16) & shard->bucket_mask];
+}
+
+
+static xqc_session_lru_entry_t *
+xqc_session_lru_find(xqc_session_lru_shard_t *shard, uint64_t hash,
+    const char *key, size_t key_len)
+{
+    xqc_list_head_t *pos;
+    xqc_session_lru_entry_t *entry;
+
+    xqc_list_for_each(pos, xqc_session_lru_bucket(shard, hash)) {
+        entry = xqc_list_entry(pos, xqc_session_lru_entry_t, hash_list);
+        if (entry->hash == hash && entry->key_len == key_len
+            && memcmp(entry->key, key, key_len) == 0)
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void
+xqc_session_lru_entry_free(xqc_session_lru_entry_t *entry)
+{
+    for (size_t i = 0; i < entry->ticket_cnt; i++) {
+        xqc_free(entry->tickets[i]);
+    }
+
+    if (entry->tp) {
+        xqc_free(entry->tp);
+    }
+
+    xqc_free(entry->key);
+    xqc_free(entry);
+}
+
+
+static void
+xqc_session_lru_evict(xqc_session_lru_shard_t *shard)
+{
+    xqc_session_lru_entry_t *entry;
+
+    entry = xqc_list_entry(shard->lru.prev, xqc_session_lru_entry_t, lru_list);
+    xqc_list_del(&entry->lru_list);
+    xqc_list_del(&entry->hash_list);
+    xqc_session_lru_entry_free(entry);
+
+    shard->count--;
+    shard->evictions++;
+}
+
+
+xqc_session_lru_t *
+xqc_session_lru_create(size_t shard_cnt, size_t capacity)
+{
+    size_t i, j, bucket_cnt, shard_capacity;
+    xqc_session_lru_shard_t *shard;
+
+    if (shard_cnt == 0) {
+        shard_cnt = 1;
+    }
+
+    if (capacity == 0) {
+        capacity = XQC_SESSION_LRU_DEFAULT_CAPACITY;
+    }
+
+    shard_cnt = xqc_session_lru_pow2(shard_cnt);
+    shard_capacity = (capacity + shard_cnt - 1) / shard_cnt;
+    bucket_cnt = xqc_session_lru_pow2(shard_capacity * XQC_SESSION_LRU_BUCKET_FACTOR);
+
+    xqc_session_lru_t *lru = xqc_calloc(1, sizeof(xqc_session_lru_t));
+    if (lru == NULL) {
+        return NULL;
+    }
+
+    lru->shards = xqc_calloc(shard_cnt, sizeof(xqc_session_lru_shard_t));
+    if (lru->shards == NULL) {
+        xqc_free(lru);
+        return NULL;
+    }
+    lru->shard_mask = shard_cnt - 1;
+
+    for (i = 0; i < shard_cnt; i++) {
+        shard = &lru->shards[i];
+        shard->buckets = xqc_malloc(bucket_cnt * sizeof(xqc_list_head_t));
+        if (shard->buckets == NULL) {
+            goto fail;
+        }
+
+        for (j = 0; j < bucket_cnt; j++) {
+            xqc_init_list_head(&shard->buckets[j]);
+        }
+
+        shard->bucket_mask = bucket_cnt - 1;
+        shard->capacity = shard_capacity;
+        xqc_init_list_head(&shard->lru);
+        xqc_session_lock_init(&shard->lock);
+    }
+
+    return lru;
+
+fail:
+    /* shards are initialized in order, stop at the first one failed */
+    for (j = 0; j < i; j++) {
+        xqc_session_lock_destroy(&lru->shards[j].lock);
+        xqc_free(lru->shards[j].buckets);
+    }
+    xqc_free(lru->shards);
+    xqc_free(lru);
+    return NULL;
+}
+
+
+void
+xqc_session_lru_destroy(xqc_session_lru_t *lru)
+{
+    xqc_list_head_t *pos, *next;
+    xqc_session_lru_shard_t *shard;
+
+    if (lru == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i <= lru->shard_mask; i++) {
+        shard = &lru->shards[i];
+        xqc_list_for_each_safe(pos, next, &shard->lru) {
+            xqc_list_del(pos);
+            xqc_session_lru_entry_free(xqc_list_entry(pos, xqc_session_lru_entry_t, lru_list));
+        }
+
+        xqc_session_lock_destroy(&shard->lock);
+        xqc_free(shard->buckets);
+    }
+
+    xqc_free(lru->shards);
+    xqc_free(lru);
+}
+
+
+size_t
+xqc_session_lru_get(void *store, const char *key, size_t key_len,
+    xqc_session_data_type_t type, char *buf, size_t buf_cap)
+{
+    size_t i, len = 0;
+    xqc_session_lru_t *lru = (xqc_session_lru_t *)store;
+    xqc_session_lru_entry_t *entry;
+
+    if (type >= XQC_SESSION_DATA_TYPE_MAX) {
+        return 0;
+    }
+
+    uint64_t hash = xqc_hash_string((const u_char *)key, key_len);
+    xqc_session_lru_shard_t *shard = xqc_session_lru_shard(lru, hash);
+
+    xqc_session_lock(&shard->lock);
+
+    shard->lookups++;
+    entry = xqc_session_lru_find(shard, hash, key, key_len);
+    if (entry == NULL) {
+        goto end;
+    }
+
+    if (type == XQC_SESSION_DATA_TICKET) {
+        /* hand out the newest ticket, and take it away from the store */
+        if (entry->ticket_cnt == 0) {
+            goto end;
+        }
+
+        i = entry->ticket_cnt - 1;
+        if (entry->ticket_len[i] > buf_cap) {
+            goto end;
+        }
+
+        len = entry->ticket_len[i];
+        xqc_memcpy(buf, entry->tickets[i], len);
+        xqc_free(entry->tickets[i]);
+        entry->tickets[i] = NULL;
+        entry->ticket_cnt--;
+
+    } else {
+        if (entry->tp == NULL || entry->tp_len > buf_cap) {
+            goto end;
+        }
+
+        len = entry->tp_len;
+        xqc_memcpy(buf, entry->tp, len);
+    }
+
+    /* move to the head of lru list */
+    xqc_list_del(&entry->lru_list);
+    xqc_list_add(&entry->lru_list, &shard->lru);
+    shard->hits++;
+
+end:
+    xqc_session_unlock(&shard->lock);
+
+    return len;
+}
+
+
+xqc_int_t
+xqc_session_lru_put(void *store, const char *key, size_t key_len,
+    xqc_session_data_type_t type, const char *data, size_t data_len)
+{
+    char *copy;
+    xqc_session_lru_t *lru = (xqc_session_lru_t *)store;
+    xqc_session_lru_entry_t *entry;
+
+    if (type >= XQC_SESSION_DATA_TYPE_MAX || data_len == 0
+        || data_len > XQC_SESSION_STORE_DATA_MAX_LEN)
+    {
+        return -XQC_EPARAM;
+    }
+
+    /* copy out of lock */
+    copy = xqc_malloc(data_len);
+    if (copy == NULL) {
+        return -XQC_EMALLOC;
+    }
+    xqc_memcpy(copy, data, data_len);
+
+    uint64_t hash = xqc_hash_string((const u_char *)key, key_len);
+    xqc_session_lru_shard_t *shard = xqc_session_lru_shard(lru, hash);
+
+    xqc_session_lock(&shard->lock);
+
+    entry = xqc_session_lru_find(shard, hash, key, key_len);
+    if (entry == NULL) {
+        entry = xqc_calloc(1, sizeof(xqc_session_lru_entry_t));
+        if (entry == NULL) {
+            goto fail;
+        }
+
+        entry->key = xqc_malloc(key_len);
+        if (entry->key == NULL) {
+            xqc_free(entry);
+            goto fail;
+        }
+        xqc_memcpy(entry->key, key, key_len);
+        entry->key_len = key_len;
+        entry->hash = hash;
+
+        if (shard->count >= shard->capacity) {
+            xqc_session_lru_evict(shard);
+        }
+
+        xqc_list_add(&entry->hash_list, xqc_session_lru_bucket(shard, hash));
+        shard->count++;
+        shard->inserts++;
+
+    } else {
+        xqc_list_del(&entry->lru_list);
+    }
+
+    xqc_list_add(&entry->lru_list, &shard->lru);
+
+    if (type == XQC_SESSION_DATA_TICKET) {
+        /* servers may issue several tickets, drop the oldest one if there is no room */
+        if (entry->ticket_cnt == XQC_SESSION_LRU_TICKET_NUM) {
+            xqc_free(entry->tickets[0]);
+            memmove(&entry->tickets[0], &entry->tickets[1],
+                    (XQC_SESSION_LRU_TICKET_NUM - 1) * sizeof(entry->tickets[0]));
+            memmove(&entry->ticket_len[0], &entry->ticket_len[1],
+                    (XQC_SESSION_LRU_TICKET_NUM - 1) * sizeof(entry->ticket_len[0]));
+            entry->ticket_cnt--;
+        }
+
+        entry->tickets[entry->ticket_cnt] = copy;
+        entry->ticket_len[entry->ticket_cnt] = data_len;
+        entry->ticket_cnt++;
+
+    } else {
+        if (entry->tp) {
+            xqc_free(entry->tp);
+        }
+        entry->tp = copy;
+        entry->tp_len = data_len;
+    }
+
+    xqc_session_unlock(&shard->lock);
+    return XQC_OK;
+
+fail:
+    xqc_session_unlock(&shard->lock);
+    xqc_free(copy);
+    return -XQC_EMALLOC;
+}
+
+
+void
+xqc_session_lru_get_stats(xqc_session_lru_t *lru, xqc_session_lru_stats_t *stats)
+{
+    xqc_session_lru_shard_t *shard;
+
+    xqc_memzero(stats, sizeof(xqc_session_lru_stats_t));
+
+    for (size_t i = 0; i <= lru->shard_mask; i++) {
+        shard = &lru->shards[i];
+
+        xqc_session_lock(&shard->lock);
+        stats->lookups += shard->lookups;
+        stats->hits += shard->hits;
+        stats->inserts += shard->inserts;
+        stats->evictions += shard->evictions;
+        stats->count += shard->count;
+        xqc_session_unlock(&shard->lock);
+    }
+}
+
+
+static const xqc_session_store_callbacks_t xqc_session_lru_cbs = {
+    .get = xqc_session_lru_get,
+    .put = xqc_session_lru_put,
+};
+
+const xqc_session_store_callbacks_t *
+xqc_session_lru_callbacks(void)
+{
+    return &xqc_session_lru_cbs;
+}
@@ -0,0 +1,92 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef XQC_SESSION_STORE_H
+#define XQC_SESSION_STORE_H
+
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/common/xqc_list.h"
+
+#if defined(XQC_SYS_WINDOWS) && !defined(XQC_ON_MINGW)
+#include <windows.h>
+typedef SRWLOCK                         xqc_session_lock_t;
+#define xqc_session_lock_init(l)        InitializeSRWLock(l)
+#define xqc_session_lock_destroy(l)
+#define xqc_session_lock(l)             AcquireSRWLockExclusive(l)
+#define xqc_session_unlock(l)           ReleaseSRWLockExclusive(l)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t                 xqc_session_lock_t;
+#define xqc_session_lock_init(l)        pthread_mutex_init(l, NULL)
+#define xqc_session_lock_destroy(l)     pthread_mutex_destroy(l)
+#define xqc_session_lock(l)             pthread_mutex_lock(l)
+#define xqc_session_unlock(l)           pthread_mutex_unlock(l)
+#endif
+
+/* max count of session tickets kept for a server */
+#define XQC_SESSION_LRU_TICKET_NUM      4
+
+/*
+ * in-memory session store of client, which caches session tickets and transport parameters
+ * of servers for resumption and 0-RTT. entries are spread over shards by the hash of key, and
+ * each shard has its own lock, hash buckets and lru list, hence a store could be shared by
+ * engines running on different threads. the least recently used entry of a shard is evicted
+ * when the shard is full.
+ */
+
+typedef struct xqc_session_lru_entry_s {
+    /* node in lru list of shard, the most recently used one is the first */
+    xqc_list_head_t             lru_list;
+
+    /* node in hash bucket of shard */
+    xqc_list_head_t             hash_list;
+
+    uint64_t                    hash;
+    char                       *key;
+    size_t                      key_len;
+
+    /*
+     * session tickets not handed out yet, the newest is the last. each ticket is handed out
+     * only once, as connections resumed with the same ticket could be linked by observers,
+     * see RFC 8446 appendix C.4
+     */
+    char                       *tickets[XQC_SESSION_LRU_TICKET_NUM];
+    size_t                      ticket_len[XQC_SESSION_LRU_TICKET_NUM];
+    size_t                      ticket_cnt;
+
+    /* transport parameters of server, which are reused by all resumed connections */
+    char                       *tp;
+    size_t                      tp_len;
+} xqc_session_lru_entry_t;
+
+typedef struct xqc_session_lru_shard_s {
+    xqc_session_lock_t          lock;
+
+    xqc_list_head_t             lru;
+    xqc_list_head_t            *buckets;
+    size_t                      bucket_mask;
+
+    size_t                      count;
+    size_t                      capacity;
+
+    uint64_t                    lookups;
+    uint64_t                    hits;
+    uint64_t                    inserts;
+    uint64_t                    evictions;
+} xqc_session_lru_shard_t;
+
+struct xqc_session_lru_s {
+    xqc_session_lru_shard_t    *shards;
+    size_t                      shard_mask;
+};
+
+
+size_t xqc_session_lru_get(void *store, const char *key, size_t key_len,
+    xqc_session_data_type_t type, char *buf, size_t buf_cap);
+
+xqc_int_t xqc_session_lru_put(void *store, const char *key, size_t key_len,
+    xqc_session_data_type_t type, const char *data, size_t data_len);
+
+#endif
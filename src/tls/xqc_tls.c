@@ -259,8 +259,8 @@ xqc_tls_create_ssl(xqc_tls_t *tls, xqc_tls_config_t *cfg)
     xqc_int_t ret = XQC_OK;
     int ssl_ret;
 
-    /* create ssl instance */
-    SSL *ssl = SSL_new(xqc_tls_ctx_get_ssl_ctx(tls->ctx));
+    /* create ssl instance, or take a pre-warmed one */
+    SSL *ssl = xqc_tls_ctx_new_ssl(tls->ctx);
     if (ssl == NULL) {
         xqc_log(tls->log, XQC_LOG_ERROR, "|SSL_new return null|%s|",
                 ERR_error_string(ERR_get_error(), NULL));
@@ -424,11 +424,19 @@ xqc_tls_derive_and_install_initial_keys(xqc_tls_t *tls, const xqc_cid_t *odcid)
     uint8_t cli_initial_secret[INITIAL_SECRET_MAX_LEN] = {0};
     uint8_t svr_initial_secret[INITIAL_SECRET_MAX_LEN] = {0};
 
-    /* derive initial key */
-    ret = xqc_crypto_derive_initial_secret(cli_initial_secret, INITIAL_SECRET_MAX_LEN,
-                                           svr_initial_secret, INITIAL_SECRET_MAX_LEN,
-                                           odcid, xqc_crypto_initial_salt[tls->version],
-                                           strlen(xqc_crypto_initial_salt[tls->version]));
+    /* derive initial key, with hmac keyed by initial salt in tls context */
+    xqc_hkdf_salt_t *salt = xqc_tls_ctx_get_initial_salt(tls->ctx, tls->version);
+    if (salt != NULL) {
+        ret = xqc_crypto_derive_initial_secret_with_salt(cli_initial_secret,
+                                                         INITIAL_SECRET_MAX_LEN, svr_initial_secret,
+                                                         INITIAL_SECRET_MAX_LEN, odcid, salt);
+
+    } else {
+        ret = xqc_crypto_derive_initial_secret(cli_initial_secret, INITIAL_SECRET_MAX_LEN,
+                                               svr_initial_secret, INITIAL_SECRET_MAX_LEN,
+                                               odcid, xqc_crypto_initial_salt[tls->version],
+                                               strlen(xqc_crypto_initial_salt[tls->version]));
+    }
     if (XQC_OK != ret) {
         xqc_log(tls->log, XQC_LOG_ERROR, "|derive initial secret error|ret:%d", ret);
         return ret;
@@ -718,6 +726,12 @@ xqc_tls_is_early_data_accepted(xqc_tls_t *tls)
         ? XQC_TLS_EARLY_DATA_ACCEPT : XQC_TLS_EARLY_DATA_REJECT;
 }
 
+xqc_bool_t
+xqc_tls_is_session_resumed(xqc_tls_t *tls)
+{
+    return SSL_session_reused(tls->ssl) ? XQC_TRUE : XQC_FALSE;
+}
+
 xqc_bool_t
 xqc_tls_is_ready_to_send_early_data(xqc_tls_t *tls)
 {
@@ -880,16 +894,17 @@ xqc_ssl_session_ticket_key_cb(SSL *ssl, uint8_t *key_name, uint8_t *iv,
     const EVP_CIPHER *cipher = NULL;
     const EVP_MD *digest = EVP_sha256();
     xqc_tls_t *tls = (xqc_tls_t *)SSL_get_app_data(ssl);
-
-    /* get session ticket key */
     xqc_ssl_session_ticket_key_t *key = NULL;
-    xqc_tls_ctx_get_session_ticket_key(tls->ctx, &key);
-    if (NULL == key) {
-        xqc_log(tls->log, XQC_LOG_ERROR, "|get session ticket key failed|");
-        return -1;
-    }
+    xqc_bool_t is_current = XQC_TRUE;
 
     if (encrypt == 1) {
+        /* new tickets are always encrypted with the current key */
+        xqc_tls_ctx_get_session_ticket_key(tls->ctx, &key);
+        if (NULL == key) {
+            xqc_log(tls->log, XQC_LOG_ERROR, "|get session ticket key failed|");
+            return -1;
+        }
+
         /* encrypt session ticket, returns 1 on success and -1 on error */
         if (key->size == 48) {
             cipher = EVP_aes_128_cbc();
@@ -920,11 +935,13 @@ xqc_ssl_session_ticket_key_cb(SSL *ssl, uint8_t *key_name, uint8_t *iv,
     } else {
         /*
          * decrypt session ticket, returns -1 to abort the handshake,
-         * 0 if decrypting the ticket failed, and 1 or 2 on success
+         * 0 if decrypting the ticket failed, and 1 or 2 on success.
+         * tickets of rotated out keys fall back to full handshake
          */
-        if (memcmp(key_name, key->name, 16) != 0) {
-            xqc_log(tls->log, XQC_LOG_ERROR, "|ssl session ticket decrypt, key name not match|");
-            return -1;
+        xqc_tls_ctx_find_session_ticket_key(tls->ctx, key_name, &key, &is_current);
+        if (NULL == key) {
+            xqc_log(tls->log, XQC_LOG_INFO, "|ssl session ticket decrypt, key name not match|");
+            return 0;
         }
 
         if (key->size == 48) {
@@ -945,6 +962,12 @@ xqc_ssl_session_ticket_key_cb(SSL *ssl, uint8_t *key_name, uint8_t *iv,
             xqc_log(tls->log, XQC_LOG_ERROR, "|EVP_DecryptInit_ex() failed|");
             return 0;
         }
+
+        /* ticket of a previous key is accepted, and renewed with the current key */
+        if (!is_current) {
+            xqc_log(tls->log, XQC_LOG_DEBUG, "|ssl session ticket of previous key, renew|");
+            return 2;
+        }
     }
 
     return 1;
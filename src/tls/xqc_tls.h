@@ -49,6 +49,24 @@ xqc_int_t xqc_tls_ctx_register_alpn(xqc_tls_ctx_t *ctx, const char *alpn, size_t
  */
 xqc_int_t xqc_tls_ctx_unregister_alpn(xqc_tls_ctx_t *ctx, const char *alpn, size_t alpn_len);
 
+/**
+ * @brief make key_data the current session ticket key, and keep the previous ones for
+ * decrypting tickets issued with them, up to XQC_SESSION_TICKET_KEY_MAX keys in total
+ */
+xqc_int_t xqc_tls_ctx_rotate_session_ticket_key(xqc_tls_ctx_t *ctx, const char *key_data,
+    size_t key_len);
+
+/**
+ * @brief create SSL objects in advance until there are target ones, at most max_new in a call,
+ * which are taken by xqc_tls_create instead of creating one during handshake
+ */
+xqc_int_t xqc_tls_ctx_prewarm_ssl(xqc_tls_ctx_t *ctx, size_t target, size_t max_new);
+
+/**
+ * @brief count of SSL objects taken from pre-warmed ones
+ */
+uint64_t xqc_tls_ctx_get_prewarm_hits(xqc_tls_ctx_t *ctx);
+
 
 
 /**
@@ -176,6 +194,11 @@ xqc_bool_t xqc_tls_is_ready_to_send_early_data(xqc_tls_t *tls);
  */
 xqc_tls_early_data_accept_t xqc_tls_is_early_data_accepted(xqc_tls_t *tls);
 
+/**
+ * @brief check whether the handshake resumed a session with session ticket
+ */
+xqc_bool_t xqc_tls_is_session_resumed(xqc_tls_t *tls);
+
 /**
  * @brief get crypto aead tag length
  */
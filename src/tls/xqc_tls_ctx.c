@@ -6,6 +6,7 @@
 #include "xqc_tls_defs.h"
 #include "xqc_ssl_cbs.h"
 #include "xqc_ssl_if.h"
+#include "xqc_hkdf.h"
 #include "src/common/xqc_malloc.h"
 
 
@@ -21,8 +22,9 @@ typedef struct xqc_tls_ctx_s {
     /* callback functions for tls connection */
     xqc_tls_callbacks_t             tls_cbs;
 
-    /* session ticket key */
-    xqc_ssl_session_ticket_key_t    session_ticket_key;
+    /* session ticket keys, the first one is current and the others are previous ones */
+    xqc_ssl_session_ticket_key_t    session_ticket_keys[XQC_SESSION_TICKET_KEY_MAX];
+    size_t                          session_ticket_key_cnt;
 
     /* log handler */
     xqc_log_t                      *log;
@@ -31,6 +33,15 @@ typedef struct xqc_tls_ctx_s {
     unsigned char                  *alpn_list;
     size_t                          alpn_list_sz;
     size_t                          alpn_list_len;
+
+    /* hkdf extract states bound to initial salts, indexed by version */
+    xqc_hkdf_salt_t                *initial_salts[XQC_VERSION_MAX];
+
+    /* SSL objects created in advance, see xqc_tls_ctx_prewarm_ssl */
+    SSL                           **prewarmed_ssl;
+    size_t                          prewarmed_ssl_cnt;
+    size_t                          prewarmed_ssl_cap;
+    uint64_t                        prewarmed_ssl_hits;
 } xqc_tls_ctx_t;
 
 
@@ -131,9 +142,7 @@ xqc_create_server_ssl_ctx(xqc_tls_ctx_t *ctx)
     }
 
     /* set session ticket key callback */
-    if (ctx->cfg.session_ticket_key_len == 0
-        || ctx->cfg.session_ticket_key_data == NULL)
-    {
+    if (ctx->session_ticket_key_cnt == 0) {
         xqc_log(ctx->log, XQC_LOG_WARN, "|read ssl session ticket key error|");
 
     } else {
@@ -158,7 +167,7 @@ fail:
 
 
 xqc_int_t
-xqc_init_session_ticket_keys(xqc_ssl_session_ticket_key_t *key, char *session_key_data,
+xqc_init_session_ticket_keys(xqc_ssl_session_ticket_key_t *key, const char *session_key_data,
     size_t session_key_len)
 {
     if (session_key_len != 48 && session_key_len != 80) {
@@ -276,12 +285,14 @@ xqc_tls_ctx_set_config(xqc_tls_ctx_t *ctx, const xqc_engine_ssl_config_t *src)
                 src->session_ticket_key_len);
 
             /* init session ticket key */
-            if (xqc_init_session_ticket_keys(&ctx->session_ticket_key, dst->session_ticket_key_data,
+            if (xqc_init_session_ticket_keys(&ctx->session_ticket_keys[0],
+                                             dst->session_ticket_key_data,
                                              dst->session_ticket_key_len) < 0)
             {
                 xqc_log(ctx->log, XQC_LOG_ERROR, "|read session ticket key error|");
                 return -XQC_TLS_INVALID_ARGUMENT;
             }
+            ctx->session_ticket_key_cnt = 1;
 
         } else {
             dst->session_ticket_key_len = 0;
@@ -294,6 +305,35 @@ xqc_tls_ctx_set_config(xqc_tls_ctx_t *ctx, const xqc_engine_ssl_config_t *src)
 }
 
 
+static xqc_int_t
+xqc_tls_ctx_create_initial_salts(xqc_tls_ctx_t *ctx)
+{
+    const char *salt;
+    xqc_digest_t md;
+    xqc_digest_init_to_sha256(&md);
+
+    for (int v = 0; v < XQC_VERSION_MAX; v++) {
+        salt = xqc_crypto_initial_salt[v];
+        ctx->initial_salts[v] = xqc_hkdf_salt_create((const uint8_t *)salt, strlen(salt), &md);
+        if (ctx->initial_salts[v] == NULL) {
+            xqc_log(ctx->log, XQC_LOG_ERROR, "|create initial salt error|version:%d|", v);
+            return -XQC_TLS_INTERNAL;
+        }
+    }
+
+    return XQC_OK;
+}
+
+
+static void
+xqc_tls_ctx_free_prewarmed_ssl(xqc_tls_ctx_t *ctx)
+{
+    while (ctx->prewarmed_ssl_cnt > 0) {
+        SSL_free(ctx->prewarmed_ssl[--ctx->prewarmed_ssl_cnt]);
+    }
+}
+
+
 xqc_tls_ctx_t *
 xqc_tls_ctx_create(xqc_tls_type_t type, const xqc_engine_ssl_config_t *cfg,
     const xqc_tls_callbacks_t *cbs, xqc_log_t *log)
@@ -342,6 +382,12 @@ xqc_tls_ctx_create(xqc_tls_type_t type, const xqc_engine_ssl_config_t *cfg,
         SSL_CTX_set_keylog_callback(ctx->ssl_ctx, xqc_ssl_keylog_cb);
     }
 
+    /* initial salts are constant, key hmac with them once for all connections */
+    ret = xqc_tls_ctx_create_initial_salts(ctx);
+    if (ret != XQC_OK) {
+        goto fail;
+    }
+
     return ctx;
 
 fail:
@@ -380,6 +426,16 @@ void
 xqc_tls_ctx_destroy(xqc_tls_ctx_t *ctx)
 {
     if (ctx != NULL) {
+        /* SSL objects hold a reference of SSL_CTX, free them first */
+        xqc_tls_ctx_free_prewarmed_ssl(ctx);
+        if (ctx->prewarmed_ssl) {
+            xqc_free(ctx->prewarmed_ssl);
+        }
+
+        for (int v = 0; v < XQC_VERSION_MAX; v++) {
+            xqc_hkdf_salt_destroy(ctx->initial_salts[v]);
+        }
+
         SSL_CTX_free(ctx->ssl_ctx);
 
         /* free config memory */
@@ -420,7 +476,123 @@ xqc_tls_ctx_get_tls_callbacks(xqc_tls_ctx_t *ctx, xqc_tls_callbacks_t **tls_cbs)
 void
 xqc_tls_ctx_get_session_ticket_key(xqc_tls_ctx_t *ctx, xqc_ssl_session_ticket_key_t **stk)
 {
-    *stk = &ctx->session_ticket_key;
+    *stk = &ctx->session_ticket_keys[0];
+}
+
+
+void
+xqc_tls_ctx_find_session_ticket_key(xqc_tls_ctx_t *ctx, const uint8_t *key_name,
+    xqc_ssl_session_ticket_key_t **stk, xqc_bool_t *is_current)
+{
+    *stk = NULL;
+    *is_current = XQC_FALSE;
+
+    for (size_t i = 0; i < ctx->session_ticket_key_cnt; i++) {
+        if (memcmp(key_name, ctx->session_ticket_keys[i].name, 16) == 0) {
+            *stk = &ctx->session_ticket_keys[i];
+            *is_current = (i == 0);
+            return;
+        }
+    }
+}
+
+
+xqc_int_t
+xqc_tls_ctx_rotate_session_ticket_key(xqc_tls_ctx_t *ctx, const char *key_data, size_t key_len)
+{
+    xqc_ssl_session_ticket_key_t key;
+
+    if (ctx->type != XQC_TLS_TYPE_SERVER || key_data == NULL) {
+        return -XQC_TLS_INVALID_ARGUMENT;
+    }
+
+    if (xqc_init_session_ticket_keys(&key, key_data, key_len) != XQC_OK) {
+        xqc_log(ctx->log, XQC_LOG_ERROR, "|invalid session ticket key|len:%uz|", key_len);
+        return -XQC_TLS_INVALID_ARGUMENT;
+    }
+
+    /* shift previous keys, the oldest one is dropped if the ring is full */
+    if (ctx->session_ticket_key_cnt < XQC_SESSION_TICKET_KEY_MAX) {
+        ctx->session_ticket_key_cnt++;
+    }
+
+    memmove(&ctx->session_ticket_keys[1], &ctx->session_ticket_keys[0],
+            (ctx->session_ticket_key_cnt - 1) * sizeof(xqc_ssl_session_ticket_key_t));
+    ctx->session_ticket_keys[0] = key;
+
+    /* the first key of server configured without one, take over ticket encryption from ssl */
+    if (ctx->session_ticket_key_cnt == 1) {
+        SSL_CTX_set_tlsext_ticket_key_cb(ctx->ssl_ctx, xqc_ssl_session_ticket_key_cb);
+
+        /* SSL objects created before might have copied settings of SSL_CTX, drop them */
+        xqc_tls_ctx_free_prewarmed_ssl(ctx);
+    }
+
+    xqc_log(ctx->log, XQC_LOG_INFO, "|session ticket key rotated|key_cnt:%uz|",
+            ctx->session_ticket_key_cnt);
+    return XQC_OK;
+}
+
+
+xqc_int_t
+xqc_tls_ctx_prewarm_ssl(xqc_tls_ctx_t *ctx, size_t target, size_t max_new)
+{
+    SSL **pool;
+    SSL *ssl;
+
+    if (ctx->prewarmed_ssl_cap < target) {
+        pool = xqc_realloc(ctx->prewarmed_ssl, target * sizeof(SSL *));
+        if (pool == NULL) {
+            return -XQC_EMALLOC;
+        }
+
+        ctx->prewarmed_ssl = pool;
+        ctx->prewarmed_ssl_cap = target;
+    }
+
+    while (ctx->prewarmed_ssl_cnt < target && max_new > 0) {
+        ssl = SSL_new(ctx->ssl_ctx);
+        if (ssl == NULL) {
+            xqc_log(ctx->log, XQC_LOG_ERROR, "|SSL_new return null|%s|",
+                    ERR_error_string(ERR_get_error(), NULL));
+            return -XQC_TLS_INTERNAL;
+        }
+
+        ctx->prewarmed_ssl[ctx->prewarmed_ssl_cnt++] = ssl;
+        max_new--;
+    }
+
+    return XQC_OK;
+}
+
+
+uint64_t
+xqc_tls_ctx_get_prewarm_hits(xqc_tls_ctx_t *ctx)
+{
+    return ctx->prewarmed_ssl_hits;
+}
+
+
+SSL *
+xqc_tls_ctx_new_ssl(xqc_tls_ctx_t *ctx)
+{
+    if (ctx->prewarmed_ssl_cnt > 0) {
+        ctx->prewarmed_ssl_hits++;
+        return ctx->prewarmed_ssl[--ctx->prewarmed_ssl_cnt];
+    }
+
+    return SSL_new(ctx->ssl_ctx);
+}
+
+
+xqc_hkdf_salt_t *
+xqc_tls_ctx_get_initial_salt(xqc_tls_ctx_t *ctx, xqc_proto_version_t version)
+{
+    if (version >= XQC_VERSION_MAX) {
+        return NULL;
+    }
+
+    return ctx->initial_salts[version];
 }
 
 
@@ -7,6 +7,7 @@
 
 #include "xqc_tls.h"
 #include "xqc_tls_common.h"
+#include "xqc_crypto.h"
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 
@@ -27,10 +28,26 @@ xqc_tls_type_t xqc_tls_ctx_get_type(xqc_tls_ctx_t *ctx);
 void xqc_tls_ctx_get_tls_callbacks(xqc_tls_ctx_t *ctx, xqc_tls_callbacks_t **tls_cbs);
 
 /**
- * @brief get session ticket key
+ * @brief get current session ticket key, whose size is 0 if not configured
  */
 void xqc_tls_ctx_get_session_ticket_key(xqc_tls_ctx_t *ctx, xqc_ssl_session_ticket_key_t **stk);
 
+/**
+ * @brief find session ticket key with key name, among the current and previous ones
+ */
+void xqc_tls_ctx_find_session_ticket_key(xqc_tls_ctx_t *ctx, const uint8_t *key_name,
+    xqc_ssl_session_ticket_key_t **stk, xqc_bool_t *is_current);
+
+/**
+ * @brief take a pre-warmed SSL object, or create one if none left
+ */
+SSL *xqc_tls_ctx_new_ssl(xqc_tls_ctx_t *ctx);
+
+/**
+ * @brief get hkdf extract state bound to initial salt of version
+ */
+xqc_hkdf_salt_t *xqc_tls_ctx_get_initial_salt(xqc_tls_ctx_t *ctx, xqc_proto_version_t version);
+
 /**
  * @brief get ssl common config, basically for server
  */
@@ -1,69 +1,36 @@
 /**
- * Fountain (RaptorQ-like) FEC implementation in C for xquic
- * Based on raptorQ_impl_c implementation
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
  */
 
+
 #ifndef _XQC_FEC_FOUNTAIN_H_
 #define _XQC_FEC_FOUNTAIN_H_
 
+
 #include <xquic/xquic.h>
 #include <xquic/xqc_errno.h>
 #include <xquic/xquic_typedef.h>
-#include <stdbool.h>
-
-#include "src/transport/xqc_conn.h"
-
-#ifdef __cplusplus
-extern "C"
-{
-#endif
-
-    /* Forward declarations for RaptorQ implementation */
-    typedef struct Encoder Encoder;
-    typedef struct Decoder Decoder;
-    typedef struct Symbol Symbol;
-
-    /* Block context for Fountain Code */
-    typedef struct xqc_fountain_block_ctx_s
-    {
-        uint32_t block_id;
-        uint32_t K;          // Source symbol count
-        uint32_t T;          // Symbol size in bytes
-        uint32_t curr_count; // Current received source symbols count
-        char **src_buffers;  // K source symbol buffers, each T bytes
-        bool *src_received;  // Mark which source symbols are received
-        Encoder *encoder;    // RaptorQ encoder
-        Decoder *decoder;    // RaptorQ decoder
-        bool encoder_ready;  // Encoder ready flag
-        bool decoder_ready;  // Decoder ready flag
-    } xqc_fountain_block_ctx_t;
-
-    /* Main interface functions */
-    void xqc_fountain_init(xqc_connection_t *conn);
-    void xqc_fountain_init_one(xqc_connection_t *conn, uint8_t bm_idx);
-
-    xqc_int_t xqc_fountain_encode(xqc_connection_t *conn,
-                                  unsigned char *stream,
-                                  size_t st_size,
-                                  unsigned char **outputs,
-                                  uint8_t fec_bm_mode);
-
-    xqc_int_t xqc_fountain_decode(xqc_connection_t *conn,
-                                  unsigned char **outputs,
-                                  size_t *output_size,
-                                  xqc_int_t block_idx);
+#include "src/transport/xqc_defs.h"
+#include "src/transport/xqc_fec_codec.h"
+
+/*
+ * raptorq code of raptorQ_impl_c. the state of a connection lives in the encoders and the
+ * decoder of its fec_ctl, which are kept across blocks and only created again when the size of
+ * a block changes. symbols are coded at XQC_MAX_SYMBOL_SIZE, their zero tails are not sent.
+ *
+ * the repair key is the number of source symbols of the block, 16 bits.
+ */
 
-    /* Internal management functions */
-    xqc_fountain_block_ctx_t *xqc_fountain_get_or_create_block_ctx(xqc_connection_t *conn,
-                                                                   uint32_t block_id,
-                                                                   uint8_t bm_idx);
-    void xqc_fountain_destroy_block_ctx(xqc_fountain_block_ctx_t *ctx);
-    void xqc_fountain_cleanup_connection(xqc_connection_t *conn);
+#define XQC_FOUNTAIN_KEY_SIZE       2
 
-    extern const xqc_fec_code_callback_t xqc_fountain_code_cb;
+extern const xqc_fec_code_callback_t xqc_fountain_code_cb;
+extern const xqc_fec_codec_ops_t xqc_fountain_codec_ops;
 
-#ifdef __cplusplus
-}
-#endif
+void xqc_fountain_init(xqc_connection_t *conn);
+void xqc_fountain_init_one(xqc_connection_t *conn, uint8_t bm_idx);
+xqc_int_t xqc_fountain_decode(xqc_connection_t *conn, unsigned char **outputs, size_t *output_size,
+    xqc_int_t block_idx);
+xqc_int_t xqc_fountain_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size,
+    unsigned char **outputs, uint8_t fec_bm_mode);
 
 #endif /* _XQC_FEC_FOUNTAIN_H_ */
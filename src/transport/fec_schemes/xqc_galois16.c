@@ -0,0 +1,290 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include "src/transport/fec_schemes/xqc_galois16.h"
+#include "src/common/xqc_malloc.h"
+#include "src/common/xqc_str.h"
+
+#if defined(XQC_SYS_WINDOWS) && !defined(XQC_ON_MINGW)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(XQC_ON_x86) && defined(__GNUC__)
+#define XQC_GF16_SSSE3
+#include <tmmintrin.h>
+#endif
+
+
+static xqc_gf16_t xqc_gf16_log_table[XQC_GF16_ORDER + 1];
+/* repeated twice, so that multiply does not have to reduce the sum of logs */
+static xqc_gf16_t xqc_gf16_exp_table[2 * XQC_GF16_ORDER];
+
+#if defined(XQC_SYS_WINDOWS) && !defined(XQC_ON_MINGW)
+static INIT_ONCE xqc_gf16_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t xqc_gf16_once = PTHREAD_ONCE_INIT;
+#endif
+
+#ifdef XQC_GF16_SSSE3
+static xqc_bool_t xqc_gf16_has_ssse3 = XQC_FALSE;
+#endif
+
+
+static void
+xqc_gf16_build_tables(void)
+{
+    uint32_t i, x;
+
+    x = 1;
+    for (i = 0; i < XQC_GF16_ORDER; i++) {
+        xqc_gf16_exp_table[i] = x;
+        xqc_gf16_exp_table[i + XQC_GF16_ORDER] = x;
+        xqc_gf16_log_table[x] = i;
+        x <<= 1;
+        if (x & 0x10000) {
+            x ^= XQC_GF16_POLYNOMIAL;
+        }
+    }
+    xqc_gf16_log_table[0] = 0;
+
+#ifdef XQC_GF16_SSSE3
+    xqc_gf16_has_ssse3 = __builtin_cpu_supports("ssse3") ? XQC_TRUE : XQC_FALSE;
+#endif
+}
+
+#if defined(XQC_SYS_WINDOWS) && !defined(XQC_ON_MINGW)
+static BOOL CALLBACK
+xqc_gf16_build_tables_once(PINIT_ONCE once, PVOID param, PVOID *ctx)
+{
+    xqc_gf16_build_tables();
+    return TRUE;
+}
+#endif
+
+void
+xqc_gf16_init(void)
+{
+    /* connections of different engines may code symbols from several threads */
+#if defined(XQC_SYS_WINDOWS) && !defined(XQC_ON_MINGW)
+    InitOnceExecuteOnce(&xqc_gf16_once, xqc_gf16_build_tables_once, NULL, NULL);
+#else
+    pthread_once(&xqc_gf16_once, xqc_gf16_build_tables);
+#endif
+}
+
+xqc_gf16_t
+xqc_gf16_multiply(xqc_gf16_t a, xqc_gf16_t b)
+{
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+
+    xqc_gf16_init();
+    return xqc_gf16_exp_table[(uint32_t)xqc_gf16_log_table[a] + xqc_gf16_log_table[b]];
+}
+
+xqc_gf16_t
+xqc_gf16_inverse(xqc_gf16_t a)
+{
+    if (a == 0) {
+        return 0;
+    }
+
+    xqc_gf16_init();
+    return xqc_gf16_exp_table[XQC_GF16_ORDER - xqc_gf16_log_table[a]];
+}
+
+xqc_int_t
+xqc_gf16_divide(xqc_gf16_t a, xqc_gf16_t b, xqc_gf16_t *res)
+{
+    if (b == 0) {
+        return -XQC_EPARAM;
+    }
+    if (a == 0) {
+        *res = 0;
+        return XQC_OK;
+    }
+
+    xqc_gf16_init();
+    *res = xqc_gf16_exp_table[(uint32_t)xqc_gf16_log_table[a] + XQC_GF16_ORDER - xqc_gf16_log_table[b]];
+    return XQC_OK;
+}
+
+void
+xqc_gf16_region_muladd_ref(unsigned char *dst, const unsigned char *src, xqc_gf16_t coef, size_t len)
+{
+    size_t i;
+    uint32_t log_coef;
+    xqc_gf16_t w, p;
+
+    if (coef == 0) {
+        return;
+    }
+
+    xqc_gf16_init();
+    log_coef = xqc_gf16_log_table[coef];
+    for (i = 0; i + 1 < len; i += 2) {
+        w = src[i] | (xqc_gf16_t)src[i + 1] << 8;
+        if (w == 0) {
+            continue;
+        }
+        p = xqc_gf16_exp_table[xqc_gf16_log_table[w] + log_coef];
+        dst[i] ^= p & 0xff;
+        dst[i + 1] ^= p >> 8;
+    }
+
+    /* the odd tail byte, only the low byte of its product is inside the region */
+    if (i < len && src[i] != 0) {
+        p = xqc_gf16_exp_table[xqc_gf16_log_table[src[i]] + log_coef];
+        dst[i] ^= p & 0xff;
+    }
+}
+
+#ifdef XQC_GF16_SSSE3
+
+/*
+ * split table multiplication: the product of a word is the sum of the products of its four
+ * nibbles, each looked up in a table of 16 entries, for the low and the high byte apart.
+ */
+__attribute__((target("ssse3")))
+static size_t
+xqc_gf16_region_muladd_ssse3(unsigned char *dst, const unsigned char *src, xqc_gf16_t coef, size_t len)
+{
+    size_t i;
+    int n, v;
+    xqc_gf16_t p;
+    unsigned char tbl_lo[4][16], tbl_hi[4][16];
+    __m128i t_lo[4], t_hi[4], mask, deint, a, b, lo, hi, nib, out_lo, out_hi;
+
+    for (n = 0; n < 4; n++) {
+        for (v = 0; v < 16; v++) {
+            p = xqc_gf16_multiply(coef, (xqc_gf16_t)(v << (4 * n)));
+            tbl_lo[n][v] = p & 0xff;
+            tbl_hi[n][v] = p >> 8;
+        }
+        t_lo[n] = _mm_loadu_si128((const __m128i *)tbl_lo[n]);
+        t_hi[n] = _mm_loadu_si128((const __m128i *)tbl_hi[n]);
+    }
+
+    mask = _mm_set1_epi8(0x0f);
+    /* gather low bytes of words into the lower half, and high bytes into the upper half */
+    deint = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i)), deint);
+        b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i + 16)), deint);
+        lo = _mm_unpacklo_epi64(a, b);
+        hi = _mm_unpackhi_epi64(a, b);
+
+        nib = _mm_and_si128(lo, mask);
+        out_lo = _mm_shuffle_epi8(t_lo[0], nib);
+        out_hi = _mm_shuffle_epi8(t_hi[0], nib);
+        nib = _mm_and_si128(_mm_srli_epi16(lo, 4), mask);
+        out_lo = _mm_xor_si128(out_lo, _mm_shuffle_epi8(t_lo[1], nib));
+        out_hi = _mm_xor_si128(out_hi, _mm_shuffle_epi8(t_hi[1], nib));
+        nib = _mm_and_si128(hi, mask);
+        out_lo = _mm_xor_si128(out_lo, _mm_shuffle_epi8(t_lo[2], nib));
+        out_hi = _mm_xor_si128(out_hi, _mm_shuffle_epi8(t_hi[2], nib));
+        nib = _mm_and_si128(_mm_srli_epi16(hi, 4), mask);
+        out_lo = _mm_xor_si128(out_lo, _mm_shuffle_epi8(t_lo[3], nib));
+        out_hi = _mm_xor_si128(out_hi, _mm_shuffle_epi8(t_hi[3], nib));
+
+        a = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(dst + i)), _mm_unpacklo_epi8(out_lo, out_hi));
+        b = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(dst + i + 16)), _mm_unpackhi_epi8(out_lo, out_hi));
+        _mm_storeu_si128((__m128i *)(dst + i), a);
+        _mm_storeu_si128((__m128i *)(dst + i + 16), b);
+    }
+
+    return i;
+}
+
+#endif
+
+void
+xqc_gf16_region_muladd(unsigned char *dst, const unsigned char *src, xqc_gf16_t coef, size_t len)
+{
+    size_t done = 0;
+
+    if (coef == 0) {
+        return;
+    }
+
+    xqc_gf16_init();
+
+#ifdef XQC_GF16_SSSE3
+    /* building the tables is only worth it for long regions */
+    if (xqc_gf16_has_ssse3 && len >= 128) {
+        done = xqc_gf16_region_muladd_ssse3(dst, src, coef, len);
+    }
+#endif
+
+    xqc_gf16_region_muladd_ref(dst + done, src + done, coef, len - done);
+}
+
+xqc_int_t
+xqc_gf16_invert_cauchy(const xqc_gf16_t *x, const xqc_gf16_t *y, xqc_int_t n,
+    xqc_gf16_t *output)
+{
+    /*
+     * with c[i][j] = 1 / (x[i] + y[j]), the inverse is
+     *   b[i][j] = P[i] * Q[j] / ((x[j] + y[i]) * X[j] * Y[i])
+     * where P[i] = prod_k (y[i] + x[k]), Q[j] = prod_k (x[j] + y[k]),
+     * X[j] = prod_{k != j} (x[j] + x[k]) and Y[i] = prod_{k != i} (y[i] + y[k]).
+     * products are kept as sums of logs.
+     */
+    xqc_int_t i, j;
+    uint32_t *log_p, *log_q, *log_x, *log_y, e;
+    xqc_gf16_t s;
+
+    if (n <= 0) {
+        return -XQC_EPARAM;
+    }
+
+    log_p = xqc_calloc(4 * n, sizeof(uint32_t));
+    if (log_p == NULL) {
+        return -XQC_EMALLOC;
+    }
+    log_q = log_p + n;
+    log_x = log_q + n;
+    log_y = log_x + n;
+
+    xqc_gf16_init();
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            s = x[i] ^ y[j];
+            if (s == 0) {
+                goto cauchy_invalid;
+            }
+            log_q[i] = (log_q[i] + xqc_gf16_log_table[s]) % XQC_GF16_ORDER;
+            log_p[j] = (log_p[j] + xqc_gf16_log_table[s]) % XQC_GF16_ORDER;
+
+            if (j == i) {
+                continue;
+            }
+            if (x[i] == x[j] || y[i] == y[j]) {
+                goto cauchy_invalid;
+            }
+            log_x[i] = (log_x[i] + xqc_gf16_log_table[x[i] ^ x[j]]) % XQC_GF16_ORDER;
+            log_y[i] = (log_y[i] + xqc_gf16_log_table[y[i] ^ y[j]]) % XQC_GF16_ORDER;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            /* each subtracted log is below XQC_GF16_ORDER, so the sum never wraps below zero */
+            e = log_p[i] + log_q[j] + 3 * XQC_GF16_ORDER
+                - xqc_gf16_log_table[x[j] ^ y[i]] - log_x[j] - log_y[i];
+            output[i * n + j] = xqc_gf16_exp_table[e % XQC_GF16_ORDER];
+        }
+    }
+
+    xqc_free(log_p);
+    return XQC_OK;
+
+cauchy_invalid:
+    xqc_free(log_p);
+    return -XQC_EPARAM;
+}
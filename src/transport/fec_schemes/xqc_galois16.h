@@ -0,0 +1,53 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+
+#ifndef _XQC_GALOIS16_H_
+#define _XQC_GALOIS16_H_
+
+
+#include <xquic/xquic.h>
+#include <xquic/xqc_errno.h>
+#include <xquic/xquic_typedef.h>
+#include "src/transport/xqc_defs.h"
+
+/*
+ * arithmetic over GF(2^16), generated by the primitive polynomial x^16 + x^5 + x^3 + x^2 + 1.
+ *
+ * regions of symbols are taken as little endian 16 bit words. the last byte of a region of odd
+ * length is taken as a word with a zero high byte, and only the low byte of its product is
+ * written, so nothing past the region is touched.
+ *
+ * the log and exp tables are built once, on first use from whichever thread.
+ */
+
+#define XQC_GF16_ORDER          65535       /* number of nonzero elements */
+#define XQC_GF16_POLYNOMIAL     0x1002d
+
+typedef uint16_t xqc_gf16_t;
+
+void xqc_gf16_init(void);
+
+xqc_gf16_t xqc_gf16_multiply(xqc_gf16_t a, xqc_gf16_t b);
+
+/* inverse of a nonzero element, 0 for 0 */
+xqc_gf16_t xqc_gf16_inverse(xqc_gf16_t a);
+
+xqc_int_t xqc_gf16_divide(xqc_gf16_t a, xqc_gf16_t b, xqc_gf16_t *res);
+
+/* dst += coef * src */
+void xqc_gf16_region_muladd(unsigned char *dst, const unsigned char *src, xqc_gf16_t coef, size_t len);
+
+/* the same as xqc_gf16_region_muladd, without simd */
+void xqc_gf16_region_muladd_ref(unsigned char *dst, const unsigned char *src, xqc_gf16_t coef, size_t len);
+
+/**
+ * @brief invert the n x n cauchy matrix c[i][j] = 1 / (x[i] + y[j]) in O(n^2). x and y must be
+ * n distinct elements each, with no element in both.
+ * @param output row major n x n inverse
+ */
+xqc_int_t xqc_gf16_invert_cauchy(const xqc_gf16_t *x, const xqc_gf16_t *y, xqc_int_t n,
+    xqc_gf16_t *output);
+
+#endif
@@ -101,7 +101,7 @@ void xqc_packet_mask_init_one(xqc_connection_t *conn, uint8_t bm_idx)
     k = xqc_get_fec_blk_size(conn, bm_idx);
     increment = k > 16 ? 6 : 2;
 
-    if (k > 48 || repair_num <= 0 || repair_num > xqc_min(k, XQC_REPAIR_LEN))
+    if (k > 48 || repair_num <= 0 || repair_num > xqc_min(k, xqc_fec_max_repair_num_pblock(XQC_PACKET_MASK_CODE)))
     {
         conn->conn_settings.enable_encode_fec = 0;
         conn->local_settings.enable_encode_fec = 0;
@@ -138,7 +138,7 @@ void xqc_packet_mask_init(xqc_connection_t *conn)
         k = xqc_get_fec_blk_size(conn, i);
         increment = k > 16 ? 6 : 2;
 
-        if (k > 48 || repair_num <= 0 || repair_num > xqc_min(k, XQC_REPAIR_LEN))
+        if (k > 48 || repair_num <= 0 || repair_num > xqc_min(k, xqc_fec_max_repair_num_pblock(XQC_PACKET_MASK_CODE)))
         {
             conn->conn_settings.enable_encode_fec = 0;
             conn->local_settings.enable_encode_fec = 0;
@@ -181,9 +181,9 @@ xqc_pm_code_symbols(xqc_connection_t *conn, unsigned char *input, size_t in_size
     pm_offset = symbol_idx / 8;
     pm_size = src_syb_num > 16 ? 6 : 2;
 
-    if (repair_num > XQC_REPAIR_LEN)
+    if (repair_num > xqc_fec_max_repair_num_pblock(XQC_PACKET_MASK_CODE))
     {
-        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|repair number exceeds buff size");
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|repair number exceeds the cap of scheme");
         return -XQC_EPARAM;
     }
 
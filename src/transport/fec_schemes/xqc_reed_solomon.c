@@ -7,6 +7,8 @@
 #include "src/transport/fec_schemes/xqc_reed_solomon.h"
 #include "src/transport/fec_schemes/xqc_galois_calculation.h"
 #include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_fec.h"
+#include "src/transport/xqc_fec_scheme.h"
 
 
 void
@@ -38,34 +40,13 @@ xqc_reed_solomon_init_one(xqc_connection_t *conn, uint8_t bm_idx)
 void
 xqc_reed_solomon_init(xqc_connection_t *conn)
 {
-    xqc_int_t           i, j, ret, max_src_symbol_num, repair_symbol_num, symbol_idx;
-    unsigned char       *key_p;
-
-    max_src_symbol_num = xqc_get_fec_blk_size(conn, XQC_DEFAULT_SIZE_REQ);
-    repair_symbol_num = conn->fec_ctl->fec_send_required_repair_num[XQC_DEFAULT_SIZE_REQ];
-
-    if (max_src_symbol_num > XQC_REPAIR_LEN) {
+    /* a repair key is a row of the generator matrix, of one byte for each source symbol */
+    if (xqc_get_fec_blk_size(conn, XQC_DEFAULT_SIZE_REQ) > XQC_MAX_RPR_KEY_SIZE) {
         conn->conn_settings.enable_encode_fec = 0;
         conn->local_settings.enable_encode_fec = 0;
         conn->conn_settings.fec_params.fec_encoder_scheme = 0;
         xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec| reed-solomon code init error");
-        return;
     }
-
-    xqc_build_generator_matrix(max_src_symbol_num, max_src_symbol_num + repair_symbol_num, conn->fec_ctl->decode_matrix);
-
-    /* If it's the last symbol in block, save it's key; */
-    for (i = 0 ; i < repair_symbol_num; i++) {
-        key_p = conn->fec_ctl->fec_send_repair_key[XQC_DEFAULT_SIZE_REQ][i].payload;
-        if (key_p == NULL) {
-            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_reed_solomon_encode|malloc key failed");
-            return;
-        }
-        xqc_memset(key_p, 0, max_src_symbol_num);
-        xqc_memcpy(key_p, conn->fec_ctl->decode_matrix[max_src_symbol_num + i], max_src_symbol_num);
-        xqc_set_object_value(&conn->fec_ctl->fec_send_repair_key[XQC_DEFAULT_SIZE_REQ][i], 1, key_p, max_src_symbol_num);
-    }
-
 }
 
 xqc_int_t
@@ -124,147 +105,141 @@ xqc_rs_code_symbols(unsigned char (*GM_rows)[XQC_RSM_COL], unsigned char **input
     return XQC_OK;
 }
 
-xqc_int_t
-xqc_reed_solomon_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size, unsigned char **outputs,
-    uint8_t fec_bm_mode)
+typedef struct xqc_rs_codec_ctx_s {
+    /* rows K .. K + R - 1 are the coefficients of repair symbols */
+    unsigned char       gm[2 * XQC_RSM_COL][XQC_RSM_COL];
+    unsigned char       dm[XQC_RSM_COL][XQC_RSM_COL];
+    unsigned char       rows[XQC_RSM_COL][XQC_RSM_COL];
+    unsigned char      *inputs[XQC_RSM_COL];
+    unsigned char      *outputs[XQC_RSM_COL];
+} xqc_rs_codec_ctx_t;
+
+static xqc_int_t
+xqc_rs_codec_create(xqc_fec_codec_t *codec)
 {
-    size_t              tmp_size;
-    xqc_int_t           i, ret, max_src_symbol_num, repair_symbol_num, symbol_idx;
-    unsigned char       *key_p, *output_p;
-    /* Record multiplication result in galois field. */
-
-    max_src_symbol_num = xqc_get_fec_blk_size(conn, XQC_DEFAULT_SIZE_REQ);
-    symbol_idx = conn->fec_ctl->fec_send_symbol_num[fec_bm_mode];
-    repair_symbol_num = conn->fec_ctl->fec_send_required_repair_num[fec_bm_mode];
+    xqc_rs_codec_ctx_t *ctx;
 
-    ret = xqc_rs_code_one_symbol(conn->fec_ctl->decode_matrix + max_src_symbol_num, stream, outputs,
-                                 repair_symbol_num, st_size, symbol_idx);
-    for (i = 0; i < repair_symbol_num; i++) {
-        // set validation and payload size of fec_send_repair_symbols_buff object
-        tmp_size = xqc_max(st_size, conn->fec_ctl->fec_send_repair_symbols_buff[fec_bm_mode][i].payload_size);
-        if (tmp_size > XQC_MAX_SYMBOL_SIZE) {
-            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|repair symbol payload exceeds the buffer size");
-            ret = -XQC_EFEC_SCHEME_ERROR;
-        }
-        output_p = outputs[i];
-        // have to set fec_send_repair_symbols_buff, otherwise the payload won't be set to 0 after encode process
-        xqc_set_object_value(&conn->fec_ctl->fec_send_repair_symbols_buff[fec_bm_mode][i], 1, output_p,
-                             tmp_size);
-    }
-    if (ret != XQC_OK) {
-        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_reed_solomon_encode|xqc_rs_code_one_symbol failed");
-        return -XQC_EFEC_SCHEME_ERROR;
+    if (codec->src_num > XQC_RSM_COL || codec->rpr_num > XQC_RSM_COL) {
+        return -XQC_EPARAM;
     }
 
+    ctx = xqc_calloc(1, sizeof(xqc_rs_codec_ctx_t));
+    if (ctx == NULL) {
+        return -XQC_EMALLOC;
+    }
+    xqc_build_generator_matrix(codec->src_num, codec->src_num + codec->rpr_num, ctx->gm);
+    codec->scheme_ctx = ctx;
     return XQC_OK;
 }
 
-void
-xqc_gen_invert_GM(xqc_connection_t *conn, int row, int col, unsigned char (*GM)[XQC_RSM_COL], xqc_int_t block_idx, xqc_int_t symbol_flag)
+static void
+xqc_rs_codec_destroy(xqc_fec_codec_t *codec)
 {
-    xqc_int_t i, j, k, symbol_num, repair_symbol_num, src_symbol_num, symbol_idx, ret;
-    xqc_list_head_t *pos, *next;
-    xqc_fec_rpr_syb_t *rpr_symbol;
-
-    src_symbol_num = xqc_cnt_src_symbols_num(conn->fec_ctl, block_idx);
-    repair_symbol_num = xqc_cnt_rpr_symbols_num(conn->fec_ctl, block_idx);
-    symbol_num = src_symbol_num + repair_symbol_num;
-    symbol_idx = 0;
-    rpr_symbol = NULL;
-
-    xqc_memset(GM, 0, col * sizeof(*GM));
-
-    for (i = 0; i < row; i++) {
-        for (k = symbol_idx; k < col; k++) {
-            if (symbol_flag & (1 << k)) {
-                symbol_idx = k;
-                GM[i][symbol_idx] = 1;
-                symbol_idx++;
-                break;
-            }
-        }
-    }
+    xqc_free(codec->scheme_ctx);
+    codec->scheme_ctx = NULL;
+}
 
-    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_rpr_syb_list) {
-        xqc_fec_rpr_syb_t *rpr_symbol = xqc_list_entry(pos, xqc_fec_rpr_syb_t, fec_list);
-        if (rpr_symbol->block_id > block_idx) {
-            break;
-        }
-        if (rpr_symbol->block_id == block_idx) {
-            xqc_memcpy(GM[i], rpr_symbol->repair_key, rpr_symbol->repair_key_size);
-            i++;
-        }
-    }
+static xqc_int_t
+xqc_rs_codec_encode(xqc_fec_codec_t *codec)
+{
+    xqc_rs_codec_ctx_t *ctx = codec->scheme_ctx;
 
-    xqc_invert_matrix(col, col, GM);
+    return xqc_rs_code_symbols(ctx->gm + codec->src_num, codec->src, codec->src_num,
+                               codec->rpr, codec->rpr_num, codec->size);
 }
 
-xqc_int_t
-xqc_reed_solomon_decode(xqc_connection_t *conn, unsigned char **outputs, size_t *output_size, xqc_int_t block_idx)
+static xqc_int_t
+xqc_rs_codec_decode(xqc_fec_codec_t *codec)
 {
-    /**
-     * 根据fec_recv_symbols_buff和fec_recv_repair_key复原丢失的srcsymbol：
-     * 1. 生成GM的逆矩阵
-     * 2. 将recv symbols格式化
-     * 3. 逆矩阵 * recv symbols
-     */
-    xqc_int_t           i, j, ret, recv_symbols_num, recv_source_symbols_num, symbol_flag, max_src_symbol_num, loss_src_num;
-    unsigned char       GM[XQC_RSM_COL][XQC_RSM_COL] = {{0}}, *recv_symbols_buff[XQC_RSM_COL], *recovered_symbols_buff[XQC_FEC_MAX_SYMBOL_NUM_PBLOCK];
-    xqc_int_t           loss_symbol_idx[XQC_RSM_COL] = {-1};
-
-    *output_size = loss_src_num = 0;
-    recv_source_symbols_num = xqc_cnt_src_symbols_num(conn->fec_ctl, block_idx);
-    recv_symbols_num =  recv_source_symbols_num + xqc_cnt_rpr_symbols_num(conn->fec_ctl, block_idx);
-    symbol_flag = xqc_get_symbol_flag(conn, block_idx);
-    max_src_symbol_num = conn->remote_settings.fec_max_symbols_num;
-
-    for (i = 0; i < recv_symbols_num; i++) {
-        recv_symbols_buff[i] = xqc_calloc(XQC_MAX_SYMBOL_SIZE, sizeof(unsigned char));
-        recovered_symbols_buff[i] = xqc_calloc(XQC_MAX_SYMBOL_SIZE, sizeof(unsigned char));
-    }
+    xqc_int_t i, n, lost, K;
+    xqc_rs_codec_ctx_t *ctx = codec->scheme_ctx;
+
+    /* rows of the first K symbols received, which are unit rows for source symbols */
+    K = codec->src_num;
+    xqc_memset(ctx->dm, 0, sizeof(ctx->dm));
+    for (i = 0, n = 0; i < K + codec->rpr_num && n < K; i++) {
+        if (!codec->src_valid[i]) {
+            continue;
+        }
+        if (i < K) {
+            ctx->dm[n][i] = 1;
 
-    for (i = 0; i < max_src_symbol_num; i++) {
-        if ((symbol_flag & (1 << i)) == 0) {
-            loss_symbol_idx[loss_src_num] = i;
-            loss_src_num++;
+        } else {
+            xqc_memcpy(ctx->dm[n], ctx->gm[i], K);
         }
+        ctx->inputs[n++] = codec->src[i];
     }
-
-    xqc_gen_invert_GM(conn, recv_source_symbols_num, recv_symbols_num, GM, block_idx, symbol_flag);
-
-    // get symbols and make them into matrix according to block idx;
-    i = xqc_get_symbols_buff(recv_symbols_buff, conn->fec_ctl, block_idx, output_size);
-    if (i < 0) {
-        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_get_symbols_buff|recv invalid symbols");
+    if (n < K || xqc_invert_matrix(K, K, ctx->dm) != XQC_OK) {
         return -XQC_EFEC_SCHEME_ERROR;
     }
-    if (i != recv_symbols_num) {
-        xqc_log(conn->log, XQC_LOG_WARN, "|quic_fec|xqc_reed_solomon_decode|recv symbols not enouph to recover lost symbols");
-        return -XQC_EFEC_SCHEME_ERROR;
+
+    for (i = 0, lost = 0; i < K; i++) {
+        if (!codec->src_valid[i]) {
+            xqc_memcpy(ctx->rows[lost], ctx->dm[i], K);
+            ctx->outputs[lost++] = codec->src[i];
+        }
     }
+    return xqc_rs_code_symbols(ctx->rows, ctx->inputs, K, ctx->outputs, lost, codec->size);
+}
+
 
-    ret = xqc_rs_code_symbols(GM, recv_symbols_buff, recv_symbols_num, 
-                              recovered_symbols_buff, recv_symbols_num,
-                              *output_size);
+xqc_int_t
+xqc_reed_solomon_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size, unsigned char **outputs,
+    uint8_t fec_bm_mode)
+{
+    xqc_int_t           i, ret, src_num, repair_symbol_num;
+    xqc_fec_object_t   *key_obj;
+    xqc_rs_codec_ctx_t *ctx;
 
+    ret = xqc_fec_block_encode(conn, XQC_REED_SOLOMON_CODE, stream, st_size, outputs, fec_bm_mode);
     if (ret != XQC_OK) {
-        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_reed_solomon_decode|reed solomon decode symbols failed");
+        return ret == -XQC_EAGAIN ? XQC_OK : ret;
+    }
+
+    /* the key of repair symbol i is row K + i of the generator matrix */
+    src_num = xqc_get_fec_blk_size(conn, fec_bm_mode);
+    repair_symbol_num = conn->fec_ctl->fec_send_required_repair_num[fec_bm_mode];
+    if (src_num > XQC_MAX_RPR_KEY_SIZE) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_reed_solomon_encode|block too large for repair key|K:%d|", src_num);
+        return -XQC_EFEC_SCHEME_ERROR;
     }
 
-    for (i = 0; i < loss_src_num; i++) {
-        xqc_fec_ctl_save_symbol(&outputs[i], recovered_symbols_buff[loss_symbol_idx[i]], *output_size);
+    ctx = conn->fec_ctl->fec_encoders[fec_bm_mode]->scheme_ctx;
+    for (i = 0; i < repair_symbol_num; i++) {
+        key_obj = &conn->fec_ctl->fec_send_repair_key[fec_bm_mode][i];
+        if (key_obj->payload == NULL) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_reed_solomon_encode|malloc key failed");
+            return -XQC_EMALLOC;
+        }
+        xqc_memcpy(key_obj->payload, ctx->gm[src_num + i], src_num);
+        xqc_set_object_value(key_obj, 1, key_obj->payload, src_num);
     }
 
-    for (i = 0; i < recv_symbols_num; i++) {
-        if (recv_symbols_buff[i] != NULL) {
-            xqc_free(recv_symbols_buff[i]);
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_reed_solomon_decode(xqc_connection_t *conn, unsigned char **outputs, size_t *output_size, xqc_int_t block_idx)
+{
+    xqc_int_t           src_num;
+    xqc_list_head_t    *pos, *next;
+
+    /* repair keys are rows of the generator matrix of the block size */
+    src_num = conn->remote_settings.fec_max_symbols_num;
+    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_rpr_syb_list) {
+        xqc_fec_rpr_syb_t *rpr_symbol = xqc_list_entry(pos, xqc_fec_rpr_syb_t, fec_list);
+        if (rpr_symbol->block_id > block_idx) {
+            break;
         }
-        if (recovered_symbols_buff[i] != NULL) {
-            xqc_free(recovered_symbols_buff[i]);
+        if (rpr_symbol->block_id == block_idx && rpr_symbol->repair_key_size != src_num) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_reed_solomon_decode|invalid repair key|block:%d|", block_idx);
+            *output_size = 0;
+            return -XQC_EFEC_SCHEME_ERROR;
         }
     }
 
-    return ret;
+    return xqc_fec_block_decode(conn, XQC_REED_SOLOMON_CODE, src_num, xqc_fec_max_repair_num_pblock(XQC_REED_SOLOMON_CODE),
+                                block_idx, outputs, output_size);
 }
 
 
@@ -274,4 +249,12 @@ const xqc_fec_code_callback_t xqc_reed_solomon_code_cb = {
     .xqc_fec_decode         = xqc_reed_solomon_decode,
     .xqc_fec_encode         = xqc_reed_solomon_encode,
     // .destroy = xqc_rs_destroy,
+};
+
+const xqc_fec_codec_ops_t xqc_reed_solomon_codec_ops = {
+    .align                  = 1,
+    .create                 = xqc_rs_codec_create,
+    .destroy                = xqc_rs_codec_destroy,
+    .encode                 = xqc_rs_codec_encode,
+    .decode                 = xqc_rs_codec_decode,
 };
\ No newline at end of file
@@ -12,8 +12,10 @@
 #include <xquic/xqc_errno.h>
 #include <xquic/xquic_typedef.h>
 #include "src/transport/xqc_defs.h"
+#include "src/transport/xqc_fec_codec.h"
 
 extern const xqc_fec_code_callback_t xqc_reed_solomon_code_cb;
+extern const xqc_fec_codec_ops_t xqc_reed_solomon_codec_ops;
 
 xqc_int_t xqc_rs_code_one_symbol(unsigned char (*GM_rows)[XQC_RSM_COL], unsigned char *input, unsigned char **outputs,
     xqc_int_t outputs_rows_num, xqc_int_t item_size, xqc_int_t input_idx);
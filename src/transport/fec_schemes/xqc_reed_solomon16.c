@@ -0,0 +1,353 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+
+#include "src/transport/fec_schemes/xqc_reed_solomon16.h"
+#include "src/transport/xqc_fec.h"
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_fec_scheme.h"
+
+#define XQC_RS16_EVEN(size)         (((size) + 1) & ~(size_t)1)
+
+
+/*
+ * dst += coef * src, where src of odd size is taken as padded with a zero byte, and dst holds
+ * the even size. the high byte of the last word shall be coded too, or it can not be recovered.
+ */
+static void
+xqc_rs16_muladd(unsigned char *dst, const unsigned char *src, xqc_gf16_t coef, size_t size)
+{
+    size_t even = size & ~(size_t)1;
+    unsigned char tail[2];
+
+    xqc_gf16_region_muladd(dst, src, coef, even);
+    if (size & 1) {
+        tail[0] = src[even];
+        tail[1] = 0;
+        xqc_gf16_region_muladd(dst + even, tail, coef, 2);
+    }
+}
+
+xqc_gf16_t
+xqc_rs16_coef(xqc_int_t row, xqc_int_t src_idx)
+{
+    return xqc_gf16_inverse((xqc_gf16_t)row ^ (xqc_gf16_t)(XQC_RS16_MAX_REPAIR + src_idx));
+}
+
+xqc_int_t
+xqc_rs16_code_one_symbol(const unsigned char *input, size_t size, xqc_int_t input_idx,
+    unsigned char **outputs, xqc_int_t rpr_num)
+{
+    xqc_int_t j;
+
+    if (input_idx < 0 || input_idx >= XQC_RS16_MAX_SRC || rpr_num > XQC_RS16_MAX_REPAIR) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    for (j = 0; j < rpr_num; j++) {
+        if (outputs[j] == NULL) {
+            return -XQC_EMALLOC;
+        }
+        xqc_rs16_muladd(outputs[j], input, xqc_rs16_coef(j, input_idx), size);
+    }
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_rs16_decode_symbols(unsigned char **src, xqc_int_t src_num, unsigned char **rpr,
+    const xqc_int_t *rpr_rows, xqc_int_t rpr_num, unsigned char **outputs, size_t size)
+{
+    xqc_int_t i, a, b, lost, used, ret;
+    size_t even_size;
+    xqc_int_t *lost_idx, *rpr_sel;
+    xqc_gf16_t *x, *y, *inv;
+    unsigned char *mem, *tmp;
+
+    if (src_num <= 0 || src_num > XQC_RS16_MAX_SRC || rpr_num < 0) {
+        return -XQC_EPARAM;
+    }
+
+    lost = 0;
+    for (i = 0; i < src_num; i++) {
+        lost += src[i] == NULL;
+    }
+    if (lost == 0) {
+        return XQC_OK;
+    }
+    if (lost > rpr_num) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    even_size = XQC_RS16_EVEN(size);
+    mem = xqc_malloc(2 * lost * sizeof(xqc_int_t) + (2 * lost + lost * lost) * sizeof(xqc_gf16_t)
+                     + lost * even_size);
+    if (mem == NULL) {
+        return -XQC_EMALLOC;
+    }
+    lost_idx = (xqc_int_t *)mem;
+    rpr_sel = lost_idx + lost;
+    x = (xqc_gf16_t *)(rpr_sel + lost);
+    y = x + lost;
+    inv = y + lost;
+    tmp = (unsigned char *)(inv + lost * lost);
+
+    for (i = 0, b = 0; i < src_num; i++) {
+        if (src[i] == NULL) {
+            lost_idx[b] = i;
+            y[b++] = XQC_RS16_MAX_REPAIR + i;
+        }
+    }
+
+    /* one repair symbol for each lost source symbol, rows must be distinct */
+    for (i = 0, used = 0; i < rpr_num && used < lost; i++) {
+        if (rpr[i] == NULL || rpr_rows[i] < 0 || rpr_rows[i] >= XQC_RS16_MAX_REPAIR) {
+            continue;
+        }
+        for (a = 0; a < used; a++) {
+            if (x[a] == rpr_rows[i]) {
+                break;
+            }
+        }
+        if (a == used) {
+            rpr_sel[used] = i;
+            x[used++] = rpr_rows[i];
+        }
+    }
+    if (used < lost) {
+        ret = -XQC_EFEC_SCHEME_ERROR;
+        goto rs16_decode_end;
+    }
+
+    /* take the received source symbols out of the repair symbols */
+    for (a = 0; a < lost; a++) {
+        xqc_memcpy(tmp + a * even_size, rpr[rpr_sel[a]], even_size);
+        for (i = 0; i < src_num; i++) {
+            if (src[i] != NULL) {
+                xqc_rs16_muladd(tmp + a * even_size, src[i], xqc_rs16_coef(x[a], i), size);
+            }
+        }
+    }
+
+    ret = xqc_gf16_invert_cauchy(x, y, lost, inv);
+    if (ret != XQC_OK) {
+        goto rs16_decode_end;
+    }
+
+    for (b = 0; b < lost; b++) {
+        if (outputs[b] == NULL) {
+            ret = -XQC_EMALLOC;
+            goto rs16_decode_end;
+        }
+        xqc_memset(outputs[b], 0, even_size);
+        for (a = 0; a < lost; a++) {
+            xqc_gf16_region_muladd(outputs[b], tmp + a * even_size, inv[b * lost + a], even_size);
+        }
+    }
+
+rs16_decode_end:
+    xqc_free(mem);
+    return ret;
+}
+
+void
+xqc_rs16_write_key(unsigned char *key, xqc_int_t row, xqc_int_t src_num)
+{
+    key[0] = (row >> 8) & 0xff;
+    key[1] = row & 0xff;
+    key[2] = (src_num >> 8) & 0xff;
+    key[3] = src_num & 0xff;
+}
+
+xqc_int_t
+xqc_rs16_parse_key(const unsigned char *key, size_t key_size, xqc_int_t *row, xqc_int_t *src_num)
+{
+    if (key_size != XQC_RS16_KEY_SIZE) {
+        return -XQC_EFEC_SYMBOL_ERROR;
+    }
+
+    *row = (xqc_int_t)key[0] << 8 | key[1];
+    *src_num = (xqc_int_t)key[2] << 8 | key[3];
+    if (*row >= XQC_RS16_MAX_REPAIR || *src_num == 0 || *src_num > XQC_RS16_MAX_SRC) {
+        return -XQC_EFEC_SYMBOL_ERROR;
+    }
+    return XQC_OK;
+}
+
+void
+xqc_reed_solomon16_init(xqc_connection_t *conn)
+{
+    xqc_gf16_init();
+}
+
+void
+xqc_reed_solomon16_init_one(xqc_connection_t *conn, uint8_t bm_idx)
+{
+    /* coefficients are computed as symbols are coded, keys are written with repair symbols */
+    return;
+}
+
+xqc_int_t
+xqc_reed_solomon16_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size,
+    unsigned char **outputs, uint8_t fec_bm_mode)
+{
+    xqc_int_t           i, ret, src_num, repair_symbol_num;
+    xqc_fec_object_t   *key_obj;
+
+    ret = xqc_fec_block_encode(conn, XQC_REED_SOLOMON_16_CODE, stream, st_size, outputs, fec_bm_mode);
+    if (ret != XQC_OK) {
+        return ret == -XQC_EAGAIN ? XQC_OK : ret;
+    }
+
+    src_num = xqc_get_fec_blk_size(conn, fec_bm_mode);
+    repair_symbol_num = conn->fec_ctl->fec_send_required_repair_num[fec_bm_mode];
+    for (i = 0; i < repair_symbol_num; i++) {
+        key_obj = &conn->fec_ctl->fec_send_repair_key[fec_bm_mode][i];
+        if (key_obj->payload == NULL) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_reed_solomon16_encode|malloc key failed");
+            return -XQC_EMALLOC;
+        }
+        xqc_rs16_write_key(key_obj->payload, i, src_num);
+        xqc_set_object_value(key_obj, 1, key_obj->payload, XQC_RS16_KEY_SIZE);
+    }
+
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_reed_solomon16_decode(xqc_connection_t *conn, unsigned char **outputs, size_t *output_size,
+    xqc_int_t block_idx)
+{
+    xqc_int_t           ret, src_num, key_src_num, row;
+    xqc_list_head_t    *pos, *next;
+
+    *output_size = 0;
+
+    /* repair symbols of a block must agree on the number of source symbols, and carry their row */
+    src_num = 0;
+    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_rpr_syb_list) {
+        xqc_fec_rpr_syb_t *rpr_symbol = xqc_list_entry(pos, xqc_fec_rpr_syb_t, fec_list);
+        if (rpr_symbol->block_id > block_idx) {
+            break;
+        }
+        if (rpr_symbol->block_id != block_idx) {
+            continue;
+        }
+        ret = xqc_rs16_parse_key(rpr_symbol->repair_key, rpr_symbol->repair_key_size, &row, &key_src_num);
+        if (ret != XQC_OK || row != rpr_symbol->symbol_idx || (src_num != 0 && key_src_num != src_num)) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_reed_solomon16_decode|invalid repair symbol|block:%d|", block_idx);
+            return -XQC_EFEC_SCHEME_ERROR;
+        }
+        src_num = key_src_num;
+    }
+    if (src_num == 0) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    return xqc_fec_block_decode(conn, XQC_REED_SOLOMON_16_CODE, src_num, xqc_fec_max_repair_num_pblock(XQC_REED_SOLOMON_16_CODE),
+                                block_idx, outputs, output_size);
+}
+
+
+typedef struct xqc_rs16_codec_ctx_s {
+    /* NULL for symbols not received */
+    unsigned char     **src;
+    unsigned char     **rpr;
+    xqc_int_t          *rows;
+    unsigned char     **outputs;
+} xqc_rs16_codec_ctx_t;
+
+static void
+xqc_rs16_codec_destroy(xqc_fec_codec_t *codec)
+{
+    xqc_rs16_codec_ctx_t *ctx = codec->scheme_ctx;
+
+    xqc_free(ctx->src);
+    xqc_free(ctx->rows);
+    xqc_free(ctx);
+    codec->scheme_ctx = NULL;
+}
+
+static xqc_int_t
+xqc_rs16_codec_create(xqc_fec_codec_t *codec)
+{
+    xqc_int_t i;
+    xqc_rs16_codec_ctx_t *ctx;
+
+    if (codec->src_num > XQC_RS16_MAX_SRC || codec->rpr_num > XQC_RS16_MAX_REPAIR) {
+        return -XQC_EPARAM;
+    }
+    xqc_gf16_init();
+
+    ctx = xqc_calloc(1, sizeof(xqc_rs16_codec_ctx_t));
+    if (ctx == NULL) {
+        return -XQC_EMALLOC;
+    }
+    codec->scheme_ctx = ctx;
+
+    ctx->src = xqc_calloc(2 * codec->src_num + codec->rpr_num, sizeof(unsigned char *));
+    ctx->rows = xqc_calloc(codec->rpr_num, sizeof(xqc_int_t));
+    if (ctx->src == NULL || ctx->rows == NULL) {
+        xqc_rs16_codec_destroy(codec);
+        return -XQC_EMALLOC;
+    }
+    ctx->rpr = ctx->src + codec->src_num;
+    ctx->outputs = ctx->rpr + codec->rpr_num;
+    for (i = 0; i < codec->rpr_num; i++) {
+        ctx->rows[i] = i;
+    }
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_rs16_codec_encode(xqc_fec_codec_t *codec)
+{
+    xqc_int_t i, ret;
+
+    for (i = 0; i < codec->rpr_num; i++) {
+        xqc_memset(codec->rpr[i], 0, codec->size);
+    }
+    for (i = 0; i < codec->src_num; i++) {
+        ret = xqc_rs16_code_one_symbol(codec->src[i], codec->size, i, codec->rpr, codec->rpr_num);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+    }
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_rs16_codec_decode(xqc_fec_codec_t *codec)
+{
+    xqc_int_t i, lost;
+    xqc_rs16_codec_ctx_t *ctx = codec->scheme_ctx;
+
+    for (i = 0, lost = 0; i < codec->src_num; i++) {
+        ctx->src[i] = codec->src_valid[i] ? codec->src[i] : NULL;
+        if (!codec->src_valid[i]) {
+            ctx->outputs[lost++] = codec->src[i];
+        }
+    }
+    for (i = 0; i < codec->rpr_num; i++) {
+        ctx->rpr[i] = codec->rpr_valid[i] ? codec->rpr[i] : NULL;
+    }
+
+    return xqc_rs16_decode_symbols(ctx->src, codec->src_num, ctx->rpr, ctx->rows, codec->rpr_num,
+                                   ctx->outputs, codec->size);
+}
+
+
+const xqc_fec_code_callback_t xqc_reed_solomon16_code_cb = {
+    .xqc_fec_init           = xqc_reed_solomon16_init,
+    .xqc_fec_init_one       = xqc_reed_solomon16_init_one,
+    .xqc_fec_decode         = xqc_reed_solomon16_decode,
+    .xqc_fec_encode         = xqc_reed_solomon16_encode,
+};
+
+const xqc_fec_codec_ops_t xqc_reed_solomon16_codec_ops = {
+    .align                  = 2,
+    .create                 = xqc_rs16_codec_create,
+    .destroy                = xqc_rs16_codec_destroy,
+    .encode                 = xqc_rs16_codec_encode,
+    .decode                 = xqc_rs16_codec_decode,
+};
@@ -0,0 +1,65 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+
+#ifndef _XQC_FEC_REED_SOLOMON16_H_
+#define _XQC_FEC_REED_SOLOMON16_H_
+
+
+#include <xquic/xquic.h>
+#include <xquic/xqc_errno.h>
+#include <xquic/xquic_typedef.h>
+#include "src/transport/xqc_defs.h"
+#include "src/transport/fec_schemes/xqc_galois16.h"
+#include "src/transport/xqc_fec_codec.h"
+
+/*
+ * systematic reed-solomon code over GF(2^16) with a cauchy generator matrix: repair symbol j
+ * is sum_i s_i / (x_j + y_i), with x_j = j and y_i = XQC_RS16_MAX_REPAIR + i, so that the two
+ * sets never meet. any square submatrix of a cauchy matrix is invertible, so any src_num
+ * symbols of a block recover it, and the inverse of the rows of the lost symbols is computed
+ * in O(e^2) for e lost symbols. matrices are sized at decoding, so the code itself is only
+ * bounded by the field, the fec framework bounds a block further.
+ *
+ * the repair key is the row of the repair symbol and the number of source symbols it covers,
+ * 16 bits each.
+ */
+
+#define XQC_RS16_MAX_REPAIR         32768
+#define XQC_RS16_MAX_SRC            32768
+#define XQC_RS16_KEY_SIZE           4
+
+extern const xqc_fec_code_callback_t xqc_reed_solomon16_code_cb;
+extern const xqc_fec_codec_ops_t xqc_reed_solomon16_codec_ops;
+
+xqc_gf16_t xqc_rs16_coef(xqc_int_t row, xqc_int_t src_idx);
+
+/**
+ * @brief outputs[j] += coef(j, input_idx) * input for the first rpr_num rows, outputs must be
+ * zeroed before the first source symbol of a block, and hold size rounded up to even
+ */
+xqc_int_t xqc_rs16_code_one_symbol(const unsigned char *input, size_t size, xqc_int_t input_idx,
+    unsigned char **outputs, xqc_int_t rpr_num);
+
+/**
+ * @brief recover the lost source symbols of a block
+ * @param src source symbols of size bytes, NULL for a lost one
+ * @param rpr received repair symbols of size rounded up to even, of rows rpr_rows
+ * @param outputs lost source symbols in ascending order of index, of size rounded up to even
+ */
+xqc_int_t xqc_rs16_decode_symbols(unsigned char **src, xqc_int_t src_num, unsigned char **rpr,
+    const xqc_int_t *rpr_rows, xqc_int_t rpr_num, unsigned char **outputs, size_t size);
+
+void xqc_rs16_write_key(unsigned char *key, xqc_int_t row, xqc_int_t src_num);
+xqc_int_t xqc_rs16_parse_key(const unsigned char *key, size_t key_size, xqc_int_t *row,
+    xqc_int_t *src_num);
+
+void xqc_reed_solomon16_init(xqc_connection_t *conn);
+void xqc_reed_solomon16_init_one(xqc_connection_t *conn, uint8_t bm_idx);
+xqc_int_t xqc_reed_solomon16_decode(xqc_connection_t *conn, unsigned char **outputs, size_t *output_size,
+    xqc_int_t block_idx);
+xqc_int_t xqc_reed_solomon16_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size,
+    unsigned char **outputs, uint8_t fec_bm_mode);
+
+#endif
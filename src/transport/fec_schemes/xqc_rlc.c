@@ -0,0 +1,746 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+
+#include "src/transport/fec_schemes/xqc_rlc.h"
+#include "src/transport/fec_schemes/xqc_galois_calculation.h"
+#include "src/transport/xqc_fec.h"
+#include "src/transport/xqc_conn.h"
+
+
+/* dst += coef * src over GF(256) */
+static void
+xqc_rlc_region_muladd(unsigned char *dst, const unsigned char *src, uint8_t coef, size_t len)
+{
+    size_t i;
+    unsigned int log_coef;
+
+    if (coef == 0) {
+        return;
+    }
+
+    if (coef == 1) {
+        for (i = 0; i < len; i++) {
+            dst[i] ^= src[i];
+        }
+        return;
+    }
+
+    log_coef = xqc_rs_log_table[coef];
+    for (i = 0; i < len; i++) {
+        if (src[i] != 0) {
+            dst[i] ^= xqc_rs_exp_table[xqc_rs_log_table[src[i]] + log_coef];
+        }
+    }
+}
+
+static void
+xqc_rlc_region_mul(unsigned char *dst, uint8_t coef, size_t len)
+{
+    size_t i;
+    unsigned int log_coef;
+
+    if (coef == 1) {
+        return;
+    }
+
+    log_coef = xqc_rs_log_table[coef];
+    for (i = 0; i < len; i++) {
+        if (dst[i] != 0) {
+            dst[i] = xqc_rs_exp_table[xqc_rs_log_table[dst[i]] + log_coef];
+        }
+    }
+}
+
+void
+xqc_rlc_gen_coefs(uint16_t seed, uint8_t *coefs, xqc_int_t num)
+{
+    xqc_int_t i;
+    uint32_t state;
+
+    /* xorshift32, coefficients are never zero so that every symbol in window is covered */
+    state = 0x9e3779b9 ^ ((uint32_t)seed * 0x85ebca6b);
+    if (state == 0) {
+        state = 1;
+    }
+
+    for (i = 0; i < num; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        coefs[i] = 1 + (state >> 24) % 255;
+    }
+}
+
+void
+xqc_rlc_write_key(unsigned char *key, const xqc_rlc_window_t *win)
+{
+    key[0] = win->seed >> 8;
+    key[1] = win->seed & 0xff;
+    key[2] = (win->prev_block_id >> 16) & 0xff;
+    key[3] = (win->prev_block_id >> 8) & 0xff;
+    key[4] = win->prev_block_id & 0xff;
+    key[5] = win->prev_first;
+    key[6] = win->prev_num;
+    key[7] = win->cur_first;
+    key[8] = win->cur_num;
+}
+
+xqc_int_t
+xqc_rlc_parse_key(const unsigned char *key, size_t key_size, xqc_rlc_window_t *win)
+{
+    if (key_size != XQC_RLC_KEY_SIZE) {
+        return -XQC_EFEC_SYMBOL_ERROR;
+    }
+
+    win->seed = (uint16_t)key[0] << 8 | key[1];
+    win->prev_block_id = (uint32_t)key[2] << 16 | (uint32_t)key[3] << 8 | key[4];
+    win->prev_first = key[5];
+    win->prev_num = key[6];
+    win->cur_first = key[7];
+    win->cur_num = key[8];
+
+    if (win->prev_num + win->cur_num == 0
+        || win->prev_num + win->cur_num > XQC_RLC_MAX_WINDOW
+        || win->prev_first + win->prev_num > XQC_FEC_MAX_SYMBOL_NUM
+        || win->cur_first + win->cur_num > XQC_FEC_MAX_SYMBOL_NUM)
+    {
+        return -XQC_EFEC_SYMBOL_ERROR;
+    }
+
+    return XQC_OK;
+}
+
+static xqc_rlc_ctx_t *
+xqc_rlc_get_ctx(xqc_connection_t *conn)
+{
+    if (conn->fec_ctl->fec_rlc_ctx == NULL) {
+        conn->fec_ctl->fec_rlc_ctx = xqc_calloc(1, sizeof(xqc_rlc_ctx_t));
+    }
+    return conn->fec_ctl->fec_rlc_ctx;
+}
+
+static xqc_rlc_encoder_t *
+xqc_rlc_get_encoder(xqc_connection_t *conn, uint8_t bm_idx)
+{
+    xqc_int_t i;
+    xqc_rlc_ctx_t *ctx;
+    xqc_rlc_encoder_t *enc;
+
+    ctx = xqc_rlc_get_ctx(conn);
+    if (ctx == NULL) {
+        return NULL;
+    }
+    if (ctx->encoders[bm_idx] != NULL) {
+        return ctx->encoders[bm_idx];
+    }
+
+    enc = xqc_calloc(1, sizeof(xqc_rlc_encoder_t));
+    if (enc == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < XQC_RLC_MAX_WINDOW; i++) {
+        enc->window[i].payload = xqc_malloc(XQC_MAX_SYMBOL_SIZE);
+        if (enc->window[i].payload == NULL) {
+            goto enc_emalloc;
+        }
+    }
+
+    ctx->encoders[bm_idx] = enc;
+    return enc;
+
+enc_emalloc:
+    for (i = 0; i < XQC_RLC_MAX_WINDOW; i++) {
+        if (enc->window[i].payload != NULL) {
+            xqc_free(enc->window[i].payload);
+        }
+    }
+    xqc_free(enc);
+    return NULL;
+}
+
+void
+xqc_rlc_init_one(xqc_connection_t *conn, uint8_t bm_idx)
+{
+    /* the repair number is read at each window step, the window is kept across blocks */
+    if (xqc_rlc_get_encoder(conn, bm_idx) == NULL) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|sliding window encoder init error|bm_idx:%d|", bm_idx);
+    }
+}
+
+void
+xqc_rlc_init(xqc_connection_t *conn)
+{
+    xqc_rlc_init_one(conn, XQC_DEFAULT_SIZE_REQ);
+}
+
+static xqc_int_t
+xqc_rlc_gen_repair(xqc_connection_t *conn, xqc_rlc_encoder_t *enc, unsigned char *output,
+    uint8_t bm_idx, uint32_t block_id, xqc_int_t window_size)
+{
+    size_t size;
+    xqc_int_t i, num, pos;
+    uint32_t other_block_id;
+    uint8_t coefs[XQC_RLC_MAX_WINDOW];
+    xqc_rlc_src_t *members[XQC_RLC_MAX_WINDOW], *src;
+    xqc_rlc_window_t win;
+    xqc_fec_object_t *key_obj, *rpr_obj;
+
+    key_obj = &conn->fec_ctl->fec_send_repair_key[bm_idx][enc->rpr_cnt];
+    rpr_obj = &conn->fec_ctl->fec_send_repair_symbols_buff[bm_idx][enc->rpr_cnt];
+    if (output == NULL || key_obj->payload == NULL) {
+        return -XQC_EMALLOC;
+    }
+
+    /* walk back from the newest source symbol, over the current block and the previous one */
+    xqc_memset(&win, 0, sizeof(win));
+    other_block_id = block_id;
+    num = 0;
+    for (i = 0; i < xqc_min(window_size, enc->count); i++) {
+        pos = (enc->head + XQC_RLC_MAX_WINDOW - 1 - i) % XQC_RLC_MAX_WINDOW;
+        src = &enc->window[pos];
+
+        if (src->block_id != block_id) {
+            if (other_block_id == block_id) {
+                other_block_id = src->block_id;
+
+            } else if (src->block_id != other_block_id) {
+                break;
+            }
+        }
+        /* symbols of a block in window must be consecutive */
+        if (num > 0 && members[num - 1]->block_id == src->block_id
+            && members[num - 1]->symbol_idx != src->symbol_idx + 1)
+        {
+            break;
+        }
+        members[num++] = src;
+    }
+
+    win.seed = enc->seed++;
+    win.prev_block_id = other_block_id;
+    for (i = num - 1; i >= 0; i--) {
+        if (members[i]->block_id == block_id) {
+            if (win.cur_num++ == 0) {
+                win.cur_first = members[i]->symbol_idx;
+            }
+
+        } else if (win.prev_num++ == 0) {
+            win.prev_first = members[i]->symbol_idx;
+        }
+    }
+
+    /* coefficients are assigned from the oldest source symbol */
+    xqc_rlc_gen_coefs(win.seed, coefs, num);
+    size = 0;
+    for (i = 0; i < num; i++) {
+        size = xqc_max(size, members[i]->payload_size);
+    }
+    xqc_memset(output, 0, size);
+    for (i = 0; i < num; i++) {
+        src = members[num - 1 - i];
+        xqc_rlc_region_muladd(output, src->payload, coefs[i], src->payload_size);
+    }
+
+    xqc_set_object_value(rpr_obj, 1, output, size);
+    xqc_rlc_write_key(key_obj->payload, &win);
+    xqc_set_object_value(key_obj, 1, key_obj->payload, XQC_RLC_KEY_SIZE);
+    enc->rpr_cnt++;
+
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_rlc_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size, unsigned char **outputs,
+    uint8_t fec_bm_mode)
+{
+    uint32_t block_id, symbol_idx, src_symbol_num, repair_num;
+    xqc_rlc_encoder_t *enc;
+    xqc_rlc_src_t *src;
+
+    if (fec_bm_mode >= XQC_BLOCK_MODE_LEN || st_size > XQC_MAX_SYMBOL_SIZE) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_rlc_encode|invalid params|bm:%d|size:%zu|", fec_bm_mode, st_size);
+        return -XQC_EPARAM;
+    }
+
+    enc = xqc_rlc_get_encoder(conn, fec_bm_mode);
+    if (enc == NULL) {
+        return -XQC_EMALLOC;
+    }
+
+    block_id = conn->fec_ctl->fec_send_block_num[fec_bm_mode];
+    symbol_idx = conn->fec_ctl->fec_send_symbol_num[fec_bm_mode];
+    src_symbol_num = xqc_get_fec_blk_size(conn, fec_bm_mode);
+    repair_num = conn->fec_ctl->fec_send_required_repair_num[fec_bm_mode];
+    if (symbol_idx == 0) {
+        enc->rpr_cnt = 0;
+    }
+
+    src = &enc->window[enc->head];
+    xqc_memcpy(src->payload, stream, st_size);
+    src->payload_size = st_size;
+    src->block_id = block_id;
+    src->symbol_idx = symbol_idx;
+    enc->head = (enc->head + 1) % XQC_RLC_MAX_WINDOW;
+    enc->count = xqc_min(enc->count + 1, XQC_RLC_MAX_WINDOW);
+
+    /* repair symbols are spread evenly along the block, the j-th one after ceil(j * k / r) symbols */
+    if (repair_num == 0 || enc->rpr_cnt >= xqc_min(repair_num, xqc_fec_max_repair_num_pblock(XQC_RLC_CODE))
+        || (uint64_t)(symbol_idx + 1) * repair_num < (uint64_t)(enc->rpr_cnt + 1) * src_symbol_num)
+    {
+        return XQC_OK;
+    }
+
+    return xqc_rlc_gen_repair(conn, enc, outputs[enc->rpr_cnt], fec_bm_mode, block_id,
+                              xqc_min(src_symbol_num, XQC_RLC_MAX_WINDOW));
+}
+
+static xqc_fec_src_syb_t *
+xqc_rlc_find_src(xqc_connection_t *conn, uint32_t block_id, uint8_t symbol_idx)
+{
+    xqc_list_head_t *pos, *next;
+
+    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_src_syb_list) {
+        xqc_fec_src_syb_t *src_symbol = xqc_list_entry(pos, xqc_fec_src_syb_t, fec_list);
+        if (src_symbol->block_id > block_id) {
+            break;
+        }
+        if (src_symbol->block_id == block_id && src_symbol->symbol_idx == symbol_idx) {
+            return src_symbol;
+        }
+    }
+    return NULL;
+}
+
+static xqc_int_t
+xqc_rlc_find_unknown(xqc_rlc_decoder_t *dec, uint32_t block_id, uint8_t symbol_idx)
+{
+    xqc_int_t i;
+
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (dec->unknowns[i].in_use && dec->unknowns[i].block_id == block_id
+            && dec->unknowns[i].symbol_idx == symbol_idx)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static xqc_int_t
+xqc_rlc_alloc_unknown(xqc_rlc_decoder_t *dec, uint32_t block_id, uint8_t symbol_idx)
+{
+    xqc_int_t i;
+
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (!dec->unknowns[i].in_use) {
+            dec->unknowns[i].block_id = block_id;
+            dec->unknowns[i].symbol_idx = symbol_idx;
+            dec->unknowns[i].in_use = 1;
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void
+xqc_rlc_remove_eq(xqc_rlc_equation_t *eq)
+{
+    xqc_memset(eq->coefs, 0, sizeof(eq->coefs));
+    xqc_memset(eq->payload, 0, eq->payload_size);
+    eq->payload_size = 0;
+    eq->recv_time = 0;
+    eq->in_use = 0;
+}
+
+/* release unknowns which no equation refers to */
+static void
+xqc_rlc_release_unknowns(xqc_rlc_decoder_t *dec)
+{
+    xqc_int_t i, j;
+
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (!dec->unknowns[i].in_use) {
+            continue;
+        }
+        for (j = 0; j < XQC_RLC_MAX_UNKNOWN; j++) {
+            if (dec->eqs[j].in_use && dec->eqs[j].coefs[i] != 0) {
+                break;
+            }
+        }
+        if (j == XQC_RLC_MAX_UNKNOWN) {
+            dec->unknowns[i].in_use = 0;
+        }
+    }
+}
+
+/* give up the oldest lost source symbol, with the equations it appears in */
+static void
+xqc_rlc_evict_oldest(xqc_connection_t *conn, xqc_rlc_decoder_t *dec)
+{
+    xqc_int_t i, oldest;
+
+    oldest = -1;
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (!dec->unknowns[i].in_use) {
+            continue;
+        }
+        if (oldest == -1 || dec->unknowns[i].block_id < dec->unknowns[oldest].block_id
+            || (dec->unknowns[i].block_id == dec->unknowns[oldest].block_id
+                && dec->unknowns[i].symbol_idx < dec->unknowns[oldest].symbol_idx))
+        {
+            oldest = i;
+        }
+    }
+    if (oldest == -1) {
+        return;
+    }
+
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (dec->eqs[i].in_use && dec->eqs[i].coefs[oldest] != 0) {
+            xqc_rlc_remove_eq(&dec->eqs[i]);
+        }
+    }
+    dec->unknowns[oldest].in_use = 0;
+    xqc_rlc_release_unknowns(dec);
+    conn->fec_ctl->fec_recover_failed_cnt++;
+}
+
+/* new -= coef * eq, on both coefficients and payload */
+static void
+xqc_rlc_eq_muladd(xqc_rlc_equation_t *dst, const xqc_rlc_equation_t *src, uint8_t coef)
+{
+    xqc_int_t i;
+
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (src->coefs[i] != 0) {
+            dst->coefs[i] ^= xqc_galois_multiply(coef, src->coefs[i]);
+        }
+    }
+    xqc_rlc_region_muladd(dst->payload, src->payload, coef, src->payload_size);
+    dst->payload_size = xqc_max(dst->payload_size, src->payload_size);
+    dst->recv_time = xqc_max(dst->recv_time, src->recv_time);
+}
+
+/*
+ * insert the scratch equation, keeping the equations in reduced row echelon form: a pivot
+ * unknown appears in its own equation only, with coefficient 1.
+ */
+static void
+xqc_rlc_add_scratch(xqc_rlc_decoder_t *dec)
+{
+    xqc_int_t i, pivot, slot;
+    uint8_t inv;
+    unsigned char *payload;
+    xqc_rlc_equation_t *eq, *new_eq = &dec->scratch;
+
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        eq = &dec->eqs[i];
+        if (eq->in_use && new_eq->coefs[eq->pivot] != 0) {
+            xqc_rlc_eq_muladd(new_eq, eq, new_eq->coefs[eq->pivot]);
+        }
+    }
+
+    pivot = -1;
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (new_eq->coefs[i] != 0) {
+            pivot = i;
+            break;
+        }
+    }
+    if (pivot == -1) {
+        /* linearly dependent on known equations */
+        xqc_rlc_remove_eq(new_eq);
+        return;
+    }
+
+    xqc_galois_divide(1, new_eq->coefs[pivot], &inv);
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (new_eq->coefs[i] != 0) {
+            new_eq->coefs[i] = xqc_galois_multiply(new_eq->coefs[i], inv);
+        }
+    }
+    xqc_rlc_region_mul(new_eq->payload, inv, new_eq->payload_size);
+
+    slot = -1;
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        eq = &dec->eqs[i];
+        if (!eq->in_use) {
+            if (slot == -1) {
+                slot = i;
+            }
+            continue;
+        }
+        if (eq->coefs[pivot] != 0) {
+            xqc_rlc_eq_muladd(eq, new_eq, eq->coefs[pivot]);
+        }
+    }
+
+    /* there is always a free slot, as pivots are distinct unknowns */
+    eq = &dec->eqs[slot];
+    payload = eq->payload;
+    *eq = *new_eq;
+    eq->pivot = pivot;
+    eq->in_use = 1;
+
+    new_eq->payload = payload;
+    new_eq->payload_size = XQC_MAX_SYMBOL_SIZE;
+    xqc_rlc_remove_eq(new_eq);
+}
+
+static xqc_rlc_decoder_t *
+xqc_rlc_get_decoder(xqc_connection_t *conn)
+{
+    xqc_int_t i;
+    xqc_rlc_ctx_t *ctx;
+    xqc_rlc_decoder_t *dec;
+
+    ctx = xqc_rlc_get_ctx(conn);
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    dec = &ctx->decoder;
+    if (dec->scratch.payload == NULL) {
+        dec->scratch.payload = xqc_calloc(XQC_MAX_SYMBOL_SIZE, sizeof(unsigned char));
+        if (dec->scratch.payload == NULL) {
+            return NULL;
+        }
+    }
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (dec->eqs[i].payload == NULL) {
+            dec->eqs[i].payload = xqc_calloc(XQC_MAX_SYMBOL_SIZE, sizeof(unsigned char));
+            if (dec->eqs[i].payload == NULL) {
+                return NULL;
+            }
+        }
+    }
+    return dec;
+}
+
+xqc_int_t
+xqc_rlc_decode_one(xqc_connection_t *conn, unsigned char *recovered_symbols_buff,
+    xqc_int_t block_id, xqc_int_t symbol_idx)
+{
+    xqc_int_t i, ret, num, missing, free_num, col, has_unknown;
+    uint32_t member_block;
+    uint8_t member_idx, coefs[XQC_RLC_MAX_WINDOW];
+    xqc_rlc_window_t win;
+    xqc_rlc_decoder_t *dec;
+    xqc_rlc_equation_t *new_eq;
+    xqc_fec_rpr_syb_t *rpr_symbol;
+    xqc_fec_src_syb_t *src_symbol;
+    xqc_fec_src_syb_t *members_src[XQC_RLC_MAX_WINDOW];
+
+    rpr_symbol = xqc_get_rpr_symbol(&conn->fec_ctl->fec_recv_rpr_syb_list, block_id, symbol_idx);
+    if (rpr_symbol == NULL) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|no such repair symbol|");
+        return -XQC_EPARAM;
+    }
+    if (rpr_symbol->payload_size > XQC_MAX_SYMBOL_SIZE) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    ret = xqc_rlc_parse_key(rpr_symbol->repair_key, rpr_symbol->repair_key_size, &win);
+    if (ret != XQC_OK) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|invalid sliding window repair key|size:%zu|", rpr_symbol->repair_key_size);
+        return ret;
+    }
+
+    dec = xqc_rlc_get_decoder(conn);
+    if (dec == NULL) {
+        return -XQC_EMALLOC;
+    }
+
+    num = win.prev_num + win.cur_num;
+    xqc_rlc_gen_coefs(win.seed, coefs, num);
+
+    /* make room for the lost source symbols of window before building the equation */
+    while (1) {
+        missing = free_num = 0;
+        for (i = 0; i < num; i++) {
+            member_block = i < win.prev_num ? win.prev_block_id : block_id;
+            member_idx = i < win.prev_num ? win.prev_first + i : win.cur_first + i - win.prev_num;
+            members_src[i] = xqc_rlc_find_src(conn, member_block, member_idx);
+            if (members_src[i] == NULL && xqc_rlc_find_unknown(dec, member_block, member_idx) < 0) {
+                missing++;
+            }
+        }
+        for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+            if (!dec->unknowns[i].in_use) {
+                free_num++;
+            }
+        }
+        if (missing <= free_num) {
+            break;
+        }
+        xqc_rlc_evict_oldest(conn, dec);
+    }
+
+    new_eq = &dec->scratch;
+    xqc_memcpy(new_eq->payload, rpr_symbol->payload, rpr_symbol->payload_size);
+    new_eq->payload_size = rpr_symbol->payload_size;
+    new_eq->recv_time = rpr_symbol->recv_time;
+    has_unknown = 0;
+
+    for (i = 0; i < num; i++) {
+        src_symbol = members_src[i];
+        if (src_symbol != NULL) {
+            xqc_rlc_region_muladd(new_eq->payload, src_symbol->payload, coefs[i],
+                                  xqc_min(src_symbol->payload_size, XQC_MAX_SYMBOL_SIZE));
+            new_eq->payload_size = xqc_max(new_eq->payload_size, src_symbol->payload_size);
+            continue;
+        }
+
+        member_block = i < win.prev_num ? win.prev_block_id : block_id;
+        member_idx = i < win.prev_num ? win.prev_first + i : win.cur_first + i - win.prev_num;
+        col = xqc_rlc_find_unknown(dec, member_block, member_idx);
+        if (col < 0) {
+            col = xqc_rlc_alloc_unknown(dec, member_block, member_idx);
+        }
+        new_eq->coefs[col] = coefs[i];
+        has_unknown = 1;
+    }
+
+    if (!has_unknown) {
+        /* every source symbol of window is received */
+        xqc_rlc_remove_eq(new_eq);
+        return XQC_OK;
+    }
+
+    xqc_rlc_add_scratch(dec);
+    xqc_rlc_release_unknowns(dec);
+    return XQC_OK;
+}
+
+xqc_bool_t
+xqc_rlc_pop_recovered(xqc_connection_t *conn, unsigned char *output, size_t *output_size,
+    xqc_int_t *block_id, xqc_int_t *symbol_idx, xqc_usec_t *recv_time)
+{
+    xqc_int_t i, j;
+    xqc_rlc_ctx_t *ctx;
+    xqc_rlc_decoder_t *dec;
+    xqc_rlc_equation_t *eq;
+
+    ctx = conn->fec_ctl->fec_rlc_ctx;
+    if (ctx == NULL) {
+        return XQC_FALSE;
+    }
+    dec = &ctx->decoder;
+
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        eq = &dec->eqs[i];
+        if (!eq->in_use) {
+            continue;
+        }
+        for (j = 0; j < XQC_RLC_MAX_UNKNOWN; j++) {
+            if (j != eq->pivot && eq->coefs[j] != 0) {
+                break;
+            }
+        }
+        if (j != XQC_RLC_MAX_UNKNOWN) {
+            continue;
+        }
+
+        /* the pivot unknown is solved, and appears in no other equation */
+        xqc_memcpy(output, eq->payload, eq->payload_size);
+        *output_size = eq->payload_size;
+        *block_id = dec->unknowns[eq->pivot].block_id;
+        *symbol_idx = dec->unknowns[eq->pivot].symbol_idx;
+        *recv_time = eq->recv_time;
+
+        dec->unknowns[eq->pivot].in_use = 0;
+        xqc_rlc_remove_eq(eq);
+        return XQC_TRUE;
+    }
+
+    return XQC_FALSE;
+}
+
+void
+xqc_rlc_on_src_symbol(xqc_connection_t *conn, uint64_t block_id, uint64_t symbol_idx,
+    unsigned char *symbol, xqc_int_t symbol_size)
+{
+    xqc_int_t i, col;
+    unsigned char *payload;
+    xqc_rlc_ctx_t *ctx;
+    xqc_rlc_decoder_t *dec;
+    xqc_rlc_equation_t *eq, *pivot_eq;
+
+    ctx = conn->fec_ctl->fec_rlc_ctx;
+    if (ctx == NULL || symbol_size > XQC_MAX_SYMBOL_SIZE) {
+        return;
+    }
+    dec = &ctx->decoder;
+
+    col = xqc_rlc_find_unknown(dec, block_id, symbol_idx);
+    if (col < 0) {
+        return;
+    }
+
+    pivot_eq = NULL;
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        eq = &dec->eqs[i];
+        if (!eq->in_use || eq->coefs[col] == 0) {
+            continue;
+        }
+        xqc_rlc_region_muladd(eq->payload, symbol, eq->coefs[col], symbol_size);
+        eq->payload_size = xqc_max(eq->payload_size, symbol_size);
+        eq->coefs[col] = 0;
+        if (eq->pivot == col) {
+            pivot_eq = eq;
+        }
+    }
+    dec->unknowns[col].in_use = 0;
+
+    /* the equation lost its pivot, pick another one for it */
+    if (pivot_eq != NULL) {
+        payload = dec->scratch.payload;
+        dec->scratch = *pivot_eq;
+        pivot_eq->payload = payload;
+        pivot_eq->payload_size = XQC_MAX_SYMBOL_SIZE;
+        xqc_rlc_remove_eq(pivot_eq);
+        xqc_rlc_add_scratch(dec);
+    }
+    xqc_rlc_release_unknowns(dec);
+}
+
+void
+xqc_rlc_destroy(xqc_fec_ctl_t *fec_ctl)
+{
+    xqc_int_t i, j;
+    xqc_rlc_ctx_t *ctx = fec_ctl->fec_rlc_ctx;
+
+    if (ctx == NULL) {
+        return;
+    }
+
+    for (i = 0; i < XQC_BLOCK_MODE_LEN; i++) {
+        if (ctx->encoders[i] == NULL) {
+            continue;
+        }
+        for (j = 0; j < XQC_RLC_MAX_WINDOW; j++) {
+            xqc_free(ctx->encoders[i]->window[j].payload);
+        }
+        xqc_free(ctx->encoders[i]);
+    }
+    for (i = 0; i < XQC_RLC_MAX_UNKNOWN; i++) {
+        if (ctx->decoder.eqs[i].payload != NULL) {
+            xqc_free(ctx->decoder.eqs[i].payload);
+        }
+    }
+    if (ctx->decoder.scratch.payload != NULL) {
+        xqc_free(ctx->decoder.scratch.payload);
+    }
+
+    xqc_free(ctx);
+    fec_ctl->fec_rlc_ctx = NULL;
+}
+
+const xqc_fec_code_callback_t xqc_rlc_code_cb = {
+    .xqc_fec_init           = xqc_rlc_init,
+    .xqc_fec_init_one       = xqc_rlc_init_one,
+    .xqc_fec_encode         = xqc_rlc_encode,
+    .xqc_fec_decode_one     = xqc_rlc_decode_one,
+};
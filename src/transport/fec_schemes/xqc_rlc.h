@@ -0,0 +1,120 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+
+#ifndef _XQC_FEC_RLC_H_
+#define _XQC_FEC_RLC_H_
+
+#include <xquic/xquic.h>
+#include <xquic/xqc_errno.h>
+#include <xquic/xquic_typedef.h>
+#include "src/transport/xqc_fec.h"
+
+/*
+ * sliding window random linear code (RFC 8681 style) over GF(256).
+ *
+ * each repair symbol is a random linear combination of the most recent source symbols of a
+ * block mode, the window may reach back into the previous block, and repair symbols are spread
+ * along the block instead of following its last source symbol. the repair key carries the seed
+ * of the coefficients and the window:
+ *
+ *   seed (16) | previous block id (24) | first idx in previous block (8) |
+ *   symbols in previous block (8) | first idx in current block (8) | symbols in current block (8)
+ *
+ * where the current block is the block id of the repair frame. the decoder keeps the equations
+ * of lost source symbols in reduced row echelon form, updates them as source and repair symbols
+ * arrive, and releases a source symbol as soon as its equation is solved.
+ */
+
+#define XQC_RLC_MAX_WINDOW          16          /* max source symbols covered by a repair symbol */
+#define XQC_RLC_MAX_UNKNOWN         (2 * XQC_RLC_MAX_WINDOW)    /* lost source symbols tracked */
+#define XQC_RLC_KEY_SIZE            9
+
+typedef struct xqc_rlc_window_s {
+    uint16_t                    seed;
+    uint32_t                    prev_block_id;
+    uint8_t                     prev_first;
+    uint8_t                     prev_num;
+    uint8_t                     cur_first;
+    uint8_t                     cur_num;
+} xqc_rlc_window_t;
+
+typedef struct xqc_rlc_src_s {
+    unsigned char              *payload;
+    size_t                      payload_size;
+    uint32_t                    block_id;
+    uint8_t                     symbol_idx;
+} xqc_rlc_src_t;
+
+/* encoder of a block mode, the window is a ring of the latest source symbols */
+typedef struct xqc_rlc_encoder_s {
+    xqc_rlc_src_t               window[XQC_RLC_MAX_WINDOW];
+    uint32_t                    head;
+    uint32_t                    count;
+    uint32_t                    rpr_cnt;    /* repair symbols generated in current block */
+    uint16_t                    seed;
+} xqc_rlc_encoder_t;
+
+typedef struct xqc_rlc_unknown_s {
+    uint32_t                    block_id;
+    uint8_t                     symbol_idx;
+    uint8_t                     in_use;
+} xqc_rlc_unknown_t;
+
+typedef struct xqc_rlc_equation_s {
+    uint8_t                     coefs[XQC_RLC_MAX_UNKNOWN];
+    unsigned char              *payload;
+    size_t                      payload_size;
+    xqc_usec_t                  recv_time;
+    uint8_t                     pivot;
+    uint8_t                     in_use;
+} xqc_rlc_equation_t;
+
+typedef struct xqc_rlc_decoder_s {
+    xqc_rlc_unknown_t           unknowns[XQC_RLC_MAX_UNKNOWN];
+    /* each equation has a distinct pivot unknown, so there are no more equations than unknowns */
+    xqc_rlc_equation_t          eqs[XQC_RLC_MAX_UNKNOWN];
+    xqc_rlc_equation_t          scratch;
+} xqc_rlc_decoder_t;
+
+typedef struct xqc_rlc_ctx_s {
+    xqc_rlc_encoder_t          *encoders[XQC_BLOCK_MODE_LEN];
+    xqc_rlc_decoder_t           decoder;
+} xqc_rlc_ctx_t;
+
+extern const xqc_fec_code_callback_t xqc_rlc_code_cb;
+
+void xqc_rlc_gen_coefs(uint16_t seed, uint8_t *coefs, xqc_int_t num);
+
+void xqc_rlc_write_key(unsigned char *key, const xqc_rlc_window_t *win);
+
+xqc_int_t xqc_rlc_parse_key(const unsigned char *key, size_t key_size, xqc_rlc_window_t *win);
+
+void xqc_rlc_init(xqc_connection_t *conn);
+void xqc_rlc_init_one(xqc_connection_t *conn, uint8_t bm_idx);
+xqc_int_t xqc_rlc_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size, unsigned char **outputs,
+    uint8_t fec_bm_mode);
+
+/**
+ * @brief fold the repair symbol (block_id, symbol_idx) of the repair symbol list into the
+ * decoder, recovered source symbols are fetched with xqc_rlc_pop_recovered, so
+ * recovered_symbols_buff is not used
+ */
+xqc_int_t xqc_rlc_decode_one(xqc_connection_t *conn, unsigned char *recovered_symbols_buff,
+    xqc_int_t block_id, xqc_int_t symbol_idx);
+
+/**
+ * @brief take a source symbol solved by the decoder
+ * @return XQC_TRUE if a source symbol is written to output
+ */
+xqc_bool_t xqc_rlc_pop_recovered(xqc_connection_t *conn, unsigned char *output, size_t *output_size,
+    xqc_int_t *block_id, xqc_int_t *symbol_idx, xqc_usec_t *recv_time);
+
+/* eliminate a received or recovered source symbol from the pending equations */
+void xqc_rlc_on_src_symbol(xqc_connection_t *conn, uint64_t block_id, uint64_t symbol_idx,
+    unsigned char *symbol, xqc_int_t symbol_size);
+
+void xqc_rlc_destroy(xqc_fec_ctl_t *fec_ctl);
+
+#endif
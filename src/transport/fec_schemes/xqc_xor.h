@@ -1,30 +1,3 @@
-
-// /**
-//  * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
-//  */
-
-
-// #ifndef _XQC_FEC_XOR_H_
-// #define _XQC_FEC_XOR_H_
-
-
-// #include "src/transport/fec_schemes/xqc_galois_calculation.h"
-// #include <xquic/xquic.h>
-// #include <xquic/xqc_errno.h>
-// #include <xquic/xquic_typedef.h>
-
-// extern const xqc_fec_code_callback_t xqc_xor_code_cb;
-
-// xqc_int_t xqc_xor_code_one_symbol(unsigned char *input, unsigned char *outputs, xqc_int_t item_size);
-
-// void xqc_xor_init(xqc_connection_t *conn);
-// void xqc_xor_init_one(xqc_connection_t *conn, uint8_t bm_idx);
-// xqc_int_t xqc_xor_decode(xqc_connection_t *conn, unsigned char **outputs, size_t *output_size, xqc_int_t block_idx);
-// xqc_int_t xqc_xor_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size, unsigned char **outputs,
-//     uint8_t fec_bm_mode);
-
-// #endif
-
 /**
  * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
  */
@@ -33,23 +6,18 @@
 #ifndef _XQC_FEC_XOR_H_
 #define _XQC_FEC_XOR_H_
 
-#include <xquic/xquic.h>
-#include <xquic/xqc_errno.h>
-#include <xquic/xquic_typedef.h>
-#include <stdbool.h>
 
-#include "src/transport/xqc_conn.h"
-#include "src/transport/fec_schemes/xqc_fountain.h"
-#include "src/transport/fec_schemes/xqc_galois_calculation.h"
 #include <xquic/xquic.h>
 #include <xquic/xqc_errno.h>
 #include <xquic/xquic_typedef.h>
+#include "src/transport/xqc_fec_codec.h"
 
-extern const xqc_fec_code_callback_t xqc_xor_code_cb;
+/*
+ * parity of all source symbols of a block, which recovers a single lost source symbol.
+ */
 
-typedef struct Encoder Encoder;
-typedef struct Decoder Decoder;
-typedef struct Symbol Symbol;
+extern const xqc_fec_code_callback_t xqc_xor_code_cb;
+extern const xqc_fec_codec_ops_t xqc_xor_codec_ops;
 
 xqc_int_t xqc_xor_code_one_symbol(unsigned char *input, unsigned char *outputs, xqc_int_t item_size);
 
@@ -59,4 +27,4 @@ xqc_int_t xqc_xor_decode(xqc_connection_t *conn, unsigned char **outputs, size_t
 xqc_int_t xqc_xor_encode(xqc_connection_t *conn, unsigned char *stream, size_t st_size, unsigned char **outputs,
     uint8_t fec_bm_mode);
 
-#endif
\ No newline at end of file
+#endif
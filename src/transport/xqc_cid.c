@@ -6,6 +6,7 @@
 #include "src/transport/xqc_cid.h"
 #include "src/transport/xqc_engine.h"
 #include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_shard.h"
 #include "src/common/xqc_random.h"
 
 xqc_int_t
@@ -21,7 +22,16 @@ xqc_generate_cid(xqc_engine_t *engine, xqc_cid_t *ori_cid, xqc_cid_t *cid,
     buf = cid->cid_buf;
     len = cid->cid_len;
 
-    if (engine->eng_callback.cid_generate_cb) {
+    if (engine->shard_dispatcher) {
+        /* cid of sharded engine is fully generated by shard, to encode the shard id */
+        if (xqc_shard_generate_cid(engine, buf, len) != XQC_OK) {
+            xqc_log(engine->log, XQC_LOG_ERROR, "|generate shard cid failed|shard_id:%ud|",
+                    engine->shard_id);
+            return -XQC_EGENERATE_CID;
+        }
+        len = 0;
+
+    } else if (engine->eng_callback.cid_generate_cb) {
         written = engine->eng_callback.cid_generate_cb(ori_cid, buf, len, engine->user_data);
         if (written < XQC_OK) {
             xqc_log(engine->log, XQC_LOG_ERROR, "|generate cid failed [ret=%z]|", written);
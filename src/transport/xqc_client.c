@@ -12,6 +12,7 @@
 #include "src/transport/xqc_stream.h"
 #include "src/transport/xqc_multipath.h"
 #include "src/transport/xqc_utils.h"
+#include "src/common/xqc_memory_pool.h"
 #include "src/transport/xqc_defs.h"
 #include "src/tls/xqc_tls.h"
 #include "src/transport/xqc_datagram.h"
@@ -65,6 +66,8 @@ xqc_client_connect(xqc_engine_t *engine, const xqc_conn_settings_t *conn_setting
         memcpy(xc->peer_addr, peer_addr, peer_addrlen);
     }
 
+    xqc_engine_log_override_select(engine, xc);
+
     if (xqc_conn_client_init_path_addr(xc) != XQC_OK) {
         return NULL;
     }
@@ -182,7 +185,9 @@ xqc_client_create_tls(xqc_connection_t *conn, const xqc_conn_ssl_config_t *conn_
     }
 
     /* create tls instance */
+    xqc_perf_timing_begin(tls_begin);
     conn->tls = xqc_tls_create(conn->engine->tls_ctx, &cfg, conn->log, conn);
+    xqc_perf_timing_end(tls_begin, conn->engine->perf_stats.tls_create_ticks);
     if (NULL == conn->tls) {
         xqc_log(conn->log, XQC_LOG_ERROR, "|create tls instance error");
         ret = -XQC_EMALLOC;
@@ -190,7 +195,9 @@ xqc_client_create_tls(xqc_connection_t *conn, const xqc_conn_ssl_config_t *conn_
     }
 
     /* start handshake */
+    xqc_perf_timing_begin(init_begin);
     ret = xqc_tls_init(conn->tls, conn->version, &conn->original_dcid);
+    xqc_perf_timing_end(init_begin, conn->engine->perf_stats.tls_init_ticks);
     if (ret != XQC_OK) {
         xqc_log(conn->log, XQC_LOG_ERROR, "|init tls error");
         goto end;
@@ -213,6 +220,74 @@ end:
 }
 
 
+/*
+ * look up session ticket and transport parameters of server from session store, if the
+ * application provides no session ticket. returns the buffer referred by ssl_cfg, which
+ * shall be freed after tls instance is created
+ */
+static char *
+xqc_client_load_session(xqc_connection_t *conn, const char *server_host, const char *alpn,
+    xqc_conn_ssl_config_t *ssl_cfg)
+{
+    xqc_engine_t   *engine = conn->engine;
+    char           *buf;
+    size_t          ticket_len, tp_len;
+    size_t          host_len = strlen(server_host);
+    size_t          alpn_len = strlen(alpn);
+
+    if (engine->session_store == NULL) {
+        return NULL;
+    }
+
+    /* servers are distinguished by host and alpn, as the transport parameters may differ */
+    conn->session_store_key_len = host_len + 1 + alpn_len;
+    conn->session_store_key = xqc_palloc(conn->conn_pool, conn->session_store_key_len);
+    if (conn->session_store_key == NULL) {
+        conn->session_store_key_len = 0;
+        return NULL;
+    }
+    xqc_memcpy(conn->session_store_key, server_host, host_len);
+    conn->session_store_key[host_len] = '|';
+    xqc_memcpy(conn->session_store_key + host_len + 1, alpn, alpn_len);
+
+    if (ssl_cfg->session_ticket_data && ssl_cfg->session_ticket_len > 0) {
+        return NULL;
+    }
+
+    buf = xqc_malloc(2 * XQC_SESSION_STORE_DATA_MAX_LEN);
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    engine->perf_stats.session_store_lookups++;
+    ticket_len = engine->session_store_cbs.get(engine->session_store, conn->session_store_key,
+                                               conn->session_store_key_len,
+                                               XQC_SESSION_DATA_TICKET, buf,
+                                               XQC_SESSION_STORE_DATA_MAX_LEN);
+    if (ticket_len == 0) {
+        xqc_free(buf);
+        return NULL;
+    }
+
+    engine->perf_stats.session_store_hits++;
+    ssl_cfg->session_ticket_data = buf;
+    ssl_cfg->session_ticket_len = ticket_len;
+
+    tp_len = engine->session_store_cbs.get(engine->session_store, conn->session_store_key,
+                                           conn->session_store_key_len, XQC_SESSION_DATA_TP,
+                                           buf + XQC_SESSION_STORE_DATA_MAX_LEN,
+                                           XQC_SESSION_STORE_DATA_MAX_LEN);
+    if (tp_len > 0) {
+        ssl_cfg->transport_parameter_data = buf + XQC_SESSION_STORE_DATA_MAX_LEN;
+        ssl_cfg->transport_parameter_data_len = tp_len;
+    }
+
+    xqc_log(conn->log, XQC_LOG_DEBUG, "|session loaded from store|ticket_len:%uz|tp_len:%uz|",
+            ticket_len, tp_len);
+    return buf;
+}
+
+
 xqc_connection_t *
 xqc_client_create_connection(xqc_engine_t *engine, xqc_cid_t dcid, xqc_cid_t scid,
     const xqc_conn_settings_t *settings, const char *server_host, int no_crypto_flag,
@@ -223,6 +298,8 @@ xqc_client_create_connection(xqc_engine_t *engine, xqc_cid_t dcid, xqc_cid_t sci
     xqc_int_t               ret;
     xqc_transport_params_t  tp;
     xqc_trans_settings_t   *local_settings;
+    xqc_conn_ssl_config_t   ssl_cfg = *conn_ssl_config;
+    char                   *session_buf = NULL;
 
     xqc_connection_t *xc = xqc_conn_create(engine, &dcid, &scid, settings, user_data,
                                            XQC_CONN_TYPE_CLIENT);
@@ -230,6 +307,8 @@ xqc_client_create_connection(xqc_engine_t *engine, xqc_cid_t dcid, xqc_cid_t sci
         return NULL;
     }
 
+    session_buf = xqc_client_load_session(xc, server_host, alpn, &ssl_cfg);
+
     /* save odcid */
     xqc_cid_copy(&(xc->original_dcid), &(xc->dcid_set.current_dcid));
 
@@ -249,17 +328,15 @@ xqc_client_create_connection(xqc_engine_t *engine, xqc_cid_t dcid, xqc_cid_t sci
     }
 
     /* create and init tls, startup ClientHello */
-    if (xqc_client_create_tls(xc, conn_ssl_config, server_host, no_crypto_flag, alpn) != XQC_OK) {
+    if (xqc_client_create_tls(xc, &ssl_cfg, server_host, no_crypto_flag, alpn) != XQC_OK) {
         goto fail;
     }
 
     /* recover server's transport parameter */
-    if (conn_ssl_config->transport_parameter_data
-        && conn_ssl_config->transport_parameter_data_len > 0)
-    {
+    if (ssl_cfg.transport_parameter_data && ssl_cfg.transport_parameter_data_len > 0) {
         xqc_init_transport_params(&tp);
-        ret = xqc_read_transport_params(conn_ssl_config->transport_parameter_data,
-                                        conn_ssl_config->transport_parameter_data_len, &tp);
+        ret = xqc_read_transport_params(ssl_cfg.transport_parameter_data,
+                                        ssl_cfg.transport_parameter_data_len, &tp);
         if (ret == XQC_OK) {
             xqc_conn_set_early_remote_transport_params(xc, &tp);
             xqc_log(xc->log, XQC_LOG_DEBUG, "|0RTT_transport_params|max_datagram_frame_size:%ud|",
@@ -267,6 +344,11 @@ xqc_client_create_connection(xqc_engine_t *engine, xqc_cid_t dcid, xqc_cid_t sci
         }
     }
 
+    if (session_buf) {
+        xqc_free(session_buf);
+        session_buf = NULL;
+    }
+
     if (xqc_conn_client_on_alpn(xc, alpn, strlen(alpn)) != XQC_OK) {
         goto fail;
     }
@@ -276,6 +358,10 @@ xqc_client_create_connection(xqc_engine_t *engine, xqc_cid_t dcid, xqc_cid_t sci
     return xc;
 
 fail:
+    if (session_buf) {
+        xqc_free(session_buf);
+    }
+
     xqc_log(xc->log, XQC_LOG_INFO, "|destroy conn as create failure|conn:%p|%s",
             xc, xqc_conn_addr_str(xc));
     xqc_conn_destroy(xc);
@@ -37,6 +37,11 @@
 
 xqc_conn_settings_t internal_default_conn_settings = {
     .pacing_on                  = 0,
+    .pacing_mode                = XQC_PACING_MODE_BUDGET,
+    .ecn_on                     = 0,
+    .ecn_l4s                    = 0,
+    .min_ack_delay              = 0,
+    .ack_frequency_on           = 0,
     .ping_on                    = 0,
     .so_sndbuf                  = 0,
     .sndq_packets_used_max      = 0,
@@ -168,6 +173,10 @@ xqc_server_set_conn_settings(xqc_engine_t *engine, const xqc_conn_settings_t *se
     engine->default_conn_settings.cong_ctrl_callback = settings->cong_ctrl_callback;
     engine->default_conn_settings.cc_params = settings->cc_params;
     engine->default_conn_settings.pacing_on = settings->pacing_on;
+    engine->default_conn_settings.pacing_mode = settings->pacing_mode;
+    engine->default_conn_settings.ecn_on = settings->ecn_on;
+    engine->default_conn_settings.ecn_l4s = settings->ecn_l4s;
+    engine->default_conn_settings.ack_frequency_on = settings->ack_frequency_on;
     engine->default_conn_settings.ping_on   = settings->ping_on;
     engine->default_conn_settings.so_sndbuf = settings->so_sndbuf;
     engine->default_conn_settings.sndq_packets_used_max = settings->sndq_packets_used_max;
@@ -208,6 +217,9 @@ xqc_server_set_conn_settings(xqc_engine_t *engine, const xqc_conn_settings_t *se
         engine->default_conn_settings.max_ack_delay = xqc_min(settings->max_ack_delay, XQC_DEFAULT_MAX_ACK_DELAY);
     }
 
+    engine->default_conn_settings.min_ack_delay = xqc_min(settings->min_ack_delay,
+                                                          engine->default_conn_settings.max_ack_delay * 1000);
+
     if (settings->datagram_redundant_probe) {
         engine->default_conn_settings.datagram_redundant_probe = xqc_max(settings->datagram_redundant_probe, 
                                                                  XQC_MIN_DATAGRAM_REDUNDANT_PROBE_INTERVAL);
@@ -295,7 +307,7 @@ xqc_server_set_conn_settings(xqc_engine_t *engine, const xqc_conn_settings_t *se
         /* if no fec scheme was negotiated succesfully, set enable_decode_fec to 0 */
         engine->default_conn_settings.enable_decode_fec = engine->default_conn_settings.fec_params.fec_decoder_schemes_num == 0 ? 0 : settings->enable_decode_fec;
         if (settings->fec_params.fec_max_window_size) {
-            engine->default_conn_settings.fec_params.fec_max_window_size = xqc_min(settings->fec_params.fec_max_window_size, XQC_SYMBOL_CACHE_LEN);
+            engine->default_conn_settings.fec_params.fec_max_window_size = xqc_min(settings->fec_params.fec_max_window_size, XQC_MAX_SYMBOL_CACHE_LEN);
         }
         if (settings->fec_params.fec_blk_log_mod) {
             engine->default_conn_settings.fec_params.fec_blk_log_mod = settings->fec_params.fec_blk_log_mod;
@@ -536,6 +548,7 @@ xqc_conn_init_trans_settings(xqc_connection_t *conn)
     ls->disable_active_migration = ls->enable_multipath ? 0 : 1;
 
     ls->max_ack_delay = conn->conn_settings.max_ack_delay;
+    ls->min_ack_delay = conn->conn_settings.min_ack_delay;
 
     /* init local conn options */
     for (i = 0, co_bytes = 0; i < XQC_CO_STR_MAX_LEN; i++) {
@@ -646,30 +659,96 @@ xqc_conn_set_ack_ext_local_settings(xqc_trans_settings_t *local_settings, const
     }
 }
 
-xqc_connection_t *
-xqc_conn_create(xqc_engine_t *engine, xqc_cid_t *dcid, xqc_cid_t *scid,
-    const xqc_conn_settings_t *settings, void *user_data, xqc_conn_type_t type)
+/*
+ * xqc_connection_t is allocated apart from its memory pool. after destroyed, both are kept in
+ * engine's conn_cache with the pool reset, and reused by new connections, which saves several
+ * allocations of each handshake when connections come and go rapidly.
+ */
+static xqc_connection_t *
+xqc_conn_alloc(xqc_engine_t *engine, const xqc_conn_settings_t *settings)
 {
-    printf("________________________xqc_conn_create() triggered");
+    xqc_connection_t       *xc;
+    xqc_memory_pool_t      *pool;
+    xqc_conn_cache_node_t  *node = engine->conn_cache;
 
-    xqc_connection_t *xc = NULL;
+    if (node != NULL) {
+        engine->conn_cache = node->next;
+        engine->conn_cache_cnt--;
+        engine->perf_stats.conns_reused++;
+
+        pool = node->pool;
+        xc = (xqc_connection_t *)node;
+
+    } else {
 #ifdef XQC_PROTECT_POOL_MEM
-    xqc_memory_pool_t *pool = xqc_create_pool(engine->config->conn_pool_size, settings->protect_pool_mem);
+        pool = xqc_create_pool(engine->config->conn_pool_size, settings->protect_pool_mem);
 #else
-    xqc_memory_pool_t *pool = xqc_create_pool(engine->config->conn_pool_size);
+        pool = xqc_create_pool(engine->config->conn_pool_size);
 #endif
-    if (pool == NULL) {
-        return NULL;
-    }
+        if (pool == NULL) {
+            return NULL;
+        }
 
 #ifdef XQC_PROTECT_POOL_MEM
-    xqc_log(engine->log, XQC_LOG_DEBUG, "|mempool|protect:%d|page_sz:%z|",
-            pool->protect_block, pool->page_size);
+        xqc_log(engine->log, XQC_LOG_DEBUG, "|mempool|protect:%d|page_sz:%z|",
+                pool->protect_block, pool->page_size);
+#endif
+
+        xc = xqc_malloc(sizeof(xqc_connection_t));
+        if (xc == NULL) {
+            xqc_destroy_pool(pool);
+            return NULL;
+        }
+    }
+
+    xqc_memzero(xc, sizeof(xqc_connection_t));
+    xc->conn_pool = pool;
+    return xc;
+}
+
+
+static void
+xqc_conn_free(xqc_connection_t *xc)
+{
+    xqc_memory_pool_t      *pool = xc->conn_pool;
+
+#ifndef XQC_PROTECT_POOL_MEM
+    /* pool memory protection is per connection, never reuse it */
+    xqc_engine_t           *engine = xc->engine;
+    xqc_conn_cache_node_t  *node;
+
+    if (engine && engine->config && pool
+        && engine->conn_cache_cnt < engine->config->conn_cache_size)
+    {
+        xqc_reset_pool(pool);
+
+        node = (xqc_conn_cache_node_t *)xc;
+        node->pool = pool;
+        node->next = engine->conn_cache;
+        engine->conn_cache = node;
+        engine->conn_cache_cnt++;
+        return;
+    }
 #endif
 
-    xc = xqc_pcalloc(pool, sizeof(xqc_connection_t));
+    if (pool) {
+        xqc_destroy_pool(pool);
+    }
+    xqc_free(xc);
+}
+
+
+xqc_connection_t *
+xqc_conn_create(xqc_engine_t *engine, xqc_cid_t *dcid, xqc_cid_t *scid,
+    const xqc_conn_settings_t *settings, void *user_data, xqc_conn_type_t type)
+{
+    printf("________________________xqc_conn_create() triggered");
+
+    xqc_perf_timing_begin(create_begin);
+
+    xqc_connection_t *xc = xqc_conn_alloc(engine, settings);
     if (xc == NULL) {
-        goto fail;
+        return NULL;
     }
 
     xc->conn_settings = *settings;
@@ -689,6 +768,8 @@ xqc_conn_create(xqc_engine_t *engine, xqc_cid_t *dcid, xqc_cid_t *scid,
         xc->conn_settings.max_ack_delay = XQC_DEFAULT_MAX_ACK_DELAY;
     }
     xc->conn_settings.max_ack_delay = xqc_min(xc->conn_settings.max_ack_delay, XQC_DEFAULT_MAX_ACK_DELAY);
+    xc->conn_settings.min_ack_delay = xqc_min(xc->conn_settings.min_ack_delay,
+                                              xc->conn_settings.max_ack_delay * 1000);
 
     if (xc->conn_settings.datagram_redundant_probe) {
         xc->conn_settings.datagram_redundant_probe = xqc_max(xc->conn_settings.datagram_redundant_probe,                    
@@ -824,7 +905,7 @@ xqc_conn_create(xqc_engine_t *engine, xqc_cid_t *dcid, xqc_cid_t *scid,
     }
     if (xc->conn_settings.enable_decode_fec) {
         if (xc->conn_settings.fec_params.fec_max_window_size) {
-            xc->conn_settings.fec_params.fec_max_window_size = xqc_min(xc->conn_settings.fec_params.fec_max_window_size, XQC_SYMBOL_CACHE_LEN);
+            xc->conn_settings.fec_params.fec_max_window_size = xqc_min(xc->conn_settings.fec_params.fec_max_window_size, XQC_MAX_SYMBOL_CACHE_LEN);
 
         } else {
             xc->conn_settings.fec_params.fec_max_window_size = engine->default_conn_settings.fec_params.fec_max_window_size;
@@ -873,8 +954,6 @@ xqc_conn_create(xqc_engine_t *engine, xqc_cid_t *dcid, xqc_cid_t *scid,
     xqc_conn_init_flow_ctl(xc);
     xqc_conn_init_key_update_ctx(xc);
 
-    xc->conn_pool = pool;
-
     xqc_init_cid_set(&xc->dcid_set);
     xqc_init_cid_set(&xc->scid_set);
 
@@ -912,9 +991,11 @@ xqc_conn_create(xqc_engine_t *engine, xqc_cid_t *dcid, xqc_cid_t *scid,
     xqc_cid_copy(&(xc->initial_scid), scid);
 
     xc->engine = engine;
+    engine->perf_stats.conns_created++;
     xc->log = xqc_log_init(engine->log->log_level, engine->log->log_event, engine->log->qlog_importance, engine->log->log_timestamp,
                            engine->log->log_level_name, engine, engine->log->log_callbacks, engine->log->user_data);
     xc->log->scid = xc->scid_set.original_scid_str;
+    xqc_memcpy(&xc->log->binlog_cid, scid->cid_buf, xqc_min(scid->cid_len, sizeof(uint64_t)));
     xc->transport_cbs = engine->transport_cbs;
     xc->user_data = user_data;
     xc->discard_vn_flag = 0;
@@ -965,7 +1046,9 @@ xqc_conn_create(xqc_engine_t *engine, xqc_cid_t *dcid, xqc_cid_t *scid,
         }
     }
 
-    xqc_init_list_head(&xc->conn_write_streams);
+    for (int i = 0; i < XQC_STREAM_URGENCY_LEVELS; i++) {
+        xqc_init_list_head(&xc->conn_write_streams[i]);
+    }
     xqc_init_list_head(&xc->conn_read_streams);
     xqc_init_list_head(&xc->conn_closing_streams);
     xqc_init_list_head(&xc->conn_all_streams);
@@ -1051,6 +1134,7 @@ xqc_conn_create(xqc_engine_t *engine, xqc_cid_t *dcid, xqc_cid_t *scid,
             xqc_scid_str(engine, &xc->scid_set.user_scid), xqc_dcid_str(engine, &xc->dcid_set.current_dcid), xc);
     xqc_log_event(xc->log, TRA_PARAMETERS_SET, xc, XQC_LOG_LOCAL_EVENT);
 
+    xqc_perf_timing_end(create_begin, engine->perf_stats.conn_create_ticks);
     return xc;
 
 fail:
@@ -1105,7 +1189,9 @@ xqc_conn_create_server_tls(xqc_connection_t *conn)
     }
 
     /* create tls instance */
+    xqc_perf_timing_begin(tls_begin);
     conn->tls = xqc_tls_create(conn->engine->tls_ctx, &cfg, conn->log, conn);
+    xqc_perf_timing_end(tls_begin, conn->engine->perf_stats.tls_create_ticks);
     if (NULL == conn->tls) {
         xqc_log(conn->log, XQC_LOG_ERROR, "|create tls instance error");
         return -XQC_EMALLOC;
@@ -1189,6 +1275,7 @@ xqc_conn_server_create(xqc_engine_t *engine, const struct sockaddr *local_addr,
                               peer_addr, peer_addrlen);
     if (ret == XQC_OK) {
         conn->peer_addrlen = peer_addrlen;
+        xqc_engine_log_override_select(engine, conn);
 
     } else {
         xqc_log(conn->log, XQC_LOG_ERROR, 
@@ -1473,6 +1560,10 @@ xqc_conn_destroy(xqc_connection_t *xc)
         return;
     }
 
+    if (xc->engine) {
+        xc->engine->perf_stats.conns_destroyed++;
+    }
+
     if (xc->conn_flag & XQC_CONN_FLAG_TICKING) {
         xqc_log(xc->log, XQC_LOG_ERROR, "|in XQC_CONN_FLAG_TICKING|%p|", xc);
         xc->conn_state = XQC_CONN_STATE_CLOSED;
@@ -1654,10 +1745,8 @@ xqc_conn_destroy(xqc_connection_t *xc)
         xqc_free(xc->alpn);
     }
 
-    /* free pool, must be the last thing to do */
-    if (xc->conn_pool) {
-        xqc_destroy_pool(xc->conn_pool);
-    }
+    /* free pool and connection, must be the last thing to do */
+    xqc_conn_free(xc);
 }
 
 void
@@ -1889,7 +1978,8 @@ xqc_conn_try_to_update_mss(xqc_connection_t *conn)
 
 
 ssize_t
-xqc_send_burst(xqc_connection_t *conn, xqc_path_ctx_t *path, struct iovec *iov, int cnt)
+xqc_send_burst(xqc_connection_t *conn, xqc_path_ctx_t *path, struct iovec *iov,
+    const xqc_usec_t *txtimes, int cnt)
 {
     ssize_t sent_size = 0;
     int sent_cnt = 0;
@@ -1921,6 +2011,25 @@ xqc_send_burst(xqc_connection_t *conn, xqc_path_ctx_t *path, struct iovec *iov,
             sent_cnt = -XQC_EPACKET_FILETER_CALLBACK;
         }
 
+    } else if (conn->transport_cbs.write_mmsg_txtime) {
+        sent_cnt = conn->transport_cbs.write_mmsg_txtime(path->path_id, iov, txtimes, cnt,
+                                                         (struct sockaddr *)path->peer_addr,
+                                                         path->peer_addrlen,
+                                                         xqc_conn_get_user_data(conn));
+        if (sent_cnt < 0) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|error send mmsg with txtime|");
+            if (sent_cnt == XQC_SOCKET_ERROR) {
+                path->path_flag |= XQC_PATH_FLAG_SOCKET_ERROR;
+                if (xqc_conn_should_close(conn, path)) {
+                    xqc_log(conn->log, XQC_LOG_ERROR, "|socket exception, close connection|");
+                    conn->conn_state = XQC_CONN_STATE_CLOSED;
+                    xqc_log_event(conn->log, CON_CONNECTION_STATE_UPDATED, conn);
+                }
+            }
+
+            sent_cnt = sent_cnt == XQC_SOCKET_EAGAIN ? -XQC_EAGAIN : -XQC_ESOCKET;
+        }
+
     } else if (conn->transport_cbs.write_mmsg_ex) {
         sent_cnt = conn->transport_cbs.write_mmsg_ex(path->path_id, iov, cnt,
                                                 (struct sockaddr *)path->peer_addr,
@@ -1958,6 +2067,13 @@ xqc_send_burst(xqc_connection_t *conn, xqc_path_ctx_t *path, struct iovec *iov,
         }
     }
 
+    for (int i = 0; i < sent_cnt; i++) {
+        conn->engine->perf_stats.bytes_sent += iov[i].iov_len;
+    }
+    if (sent_cnt > 0) {
+        conn->engine->perf_stats.datagrams_sent += sent_cnt;
+    }
+
     return sent_cnt;
 }
 
@@ -2019,6 +2135,7 @@ xqc_conn_schedule_packets(xqc_connection_t *conn,  xqc_list_head_t *head,
                                           conn, packet_out, 
                                           packets_are_limited_by_cc, 
                                           0, &cc_blocked);
+            conn->engine->perf_stats.scheduler_calls++;
             if (path == NULL) {
                 if (cc_blocked) {
                     conn->sched_cc_blocked++;
@@ -2079,6 +2196,26 @@ xqc_conn_log_sent_packet(xqc_connection_t *c, xqc_packet_out_t *po,
     c->snd_pkt_stats.curr_index = (index + 1) % 3;
 }
 
+static inline void
+xqc_conn_pacing_on_packet_sent(xqc_send_ctl_t *send_ctl, xqc_packet_out_t *packet_out,
+    xqc_usec_t now)
+{
+    xqc_pacing_t *pacing = &send_ctl->ctl_pacing;
+
+    if (XQC_CAN_IN_FLIGHT(packet_out->po_frame_types) && xqc_pacing_is_on(pacing)) {
+        if (xqc_pacing_is_edt(pacing)) {
+            /* packets not limited by pacer are taken as released now */
+            xqc_pacing_edt_on_packet_sent(pacing, packet_out->po_used_size,
+                                          packet_out->po_release_time ? packet_out->po_release_time : now);
+
+        } else {
+            xqc_pacing_on_packet_sent(pacing, packet_out->po_used_size);
+        }
+    }
+
+    packet_out->po_release_time = 0;
+}
+
 void
 xqc_on_packets_send_burst(xqc_connection_t *conn, xqc_path_ctx_t *path, ssize_t sent, xqc_usec_t now, xqc_send_type_t send_type)
 {
@@ -2101,11 +2238,7 @@ xqc_on_packets_send_burst(xqc_connection_t *conn, xqc_path_ctx_t *path, ssize_t
 
         if (xqc_has_packet_number(&packet_out->po_pkt)) {
             /* count packets with pkt_num in the send control */
-            if (XQC_CAN_IN_FLIGHT(packet_out->po_frame_types 
-                && xqc_pacing_is_on(&send_ctl->ctl_pacing)))
-            {
-                xqc_pacing_on_packet_sent(&send_ctl->ctl_pacing, packet_out->po_used_size);
-            }
+            xqc_conn_pacing_on_packet_sent(send_ctl, packet_out, now);
 
             xqc_send_ctl_on_packet_sent(send_ctl, pn_ctl, packet_out, now);
             xqc_path_send_buffer_remove(path, packet_out);
@@ -2191,6 +2324,7 @@ xqc_path_send_burst_packets(xqc_connection_t *conn, xqc_path_ctx_t *path,
 {
     ssize_t           ret;
     struct iovec      iov_array[XQC_MAX_SEND_MSG_ONCE];
+    xqc_usec_t        txtime_array[XQC_MAX_SEND_MSG_ONCE];
     char              enc_pkt_array[XQC_MAX_SEND_MSG_ONCE][XQC_CONN_MAX_UDP_PAYLOAD_SIZE];
     int               burst_cnt = 0;
     xqc_packet_out_t *packet_out;
@@ -2205,6 +2339,7 @@ xqc_path_send_burst_packets(xqc_connection_t *conn, xqc_path_ctx_t *path,
         packet_out = xqc_list_entry(pos, xqc_packet_out_t, po_list);
         iov_array[burst_cnt].iov_base = enc_pkt_array[burst_cnt];
         iov_array[burst_cnt].iov_len = XQC_CONN_MAX_UDP_PAYLOAD_SIZE;
+        txtime_array[burst_cnt] = 0;
 
         if (xqc_has_packet_number(&packet_out->po_pkt)) {
             if (xqc_check_acked_or_dropped_pkt(conn, packet_out, send_type)) {
@@ -2242,6 +2377,7 @@ xqc_path_send_burst_packets(xqc_connection_t *conn, xqc_path_ctx_t *path,
             }
 
             total_bytes_to_send += packet_out->po_used_size;
+            txtime_array[burst_cnt] = packet_out->po_release_time;
 
         } else {
             xqc_memcpy(iov_array[burst_cnt].iov_base, packet_out->po_buf, packet_out->po_used_size);
@@ -2262,7 +2398,7 @@ xqc_path_send_burst_packets(xqc_connection_t *conn, xqc_path_ctx_t *path,
     }
 
     /* burst send packets */
-    ret = xqc_send_burst(conn, path, iov_array, burst_cnt);
+    ret = xqc_send_burst(conn, path, iov_array, txtime_array, burst_cnt);
     if (ret < 0) {
         return ret;
 
@@ -2363,11 +2499,7 @@ xqc_path_send_packets(xqc_connection_t *conn, xqc_path_ctx_t *path,
             break;
         }
 
-        if (XQC_CAN_IN_FLIGHT(packet_out->po_frame_types)
-            && xqc_pacing_is_on(&send_ctl->ctl_pacing))
-        {
-            xqc_pacing_on_packet_sent(&send_ctl->ctl_pacing, packet_out->po_used_size);
-        }
+        xqc_conn_pacing_on_packet_sent(send_ctl, packet_out, now);
 
         if (packet_out->po_frame_types & XQC_FRAME_BIT_DATAGRAM) {
             xqc_log(conn->log, XQC_LOG_DEBUG, "|dgram_id:%ui|", packet_out->po_dgram_id);
@@ -2497,7 +2629,8 @@ xqc_conn_enc_packet(xqc_connection_t *conn,
 
 /* send data with callback, and process callback errors */
 ssize_t
-xqc_send(xqc_connection_t *conn, xqc_path_ctx_t *path, unsigned char *data, unsigned int len)
+xqc_send(xqc_connection_t *conn, xqc_path_ctx_t *path, unsigned char *data, unsigned int len,
+    xqc_usec_t txtime, uint8_t ecn)
 {
     ssize_t sent;
 
@@ -2512,6 +2645,59 @@ xqc_send(xqc_connection_t *conn, xqc_path_ctx_t *path, unsigned char *data, unsi
         }
         sent = len;
 
+    } else if (conn->conn_settings.ecn_on && conn->transport_cbs.write_socket_ecn) {
+        /*
+         * write_socket_ecn takes the place of write_socket_txtime, hence the release time of edt
+         * pacing goes along with the codepoint, if the socket layer takes release times at all
+         */
+        if (!conn->transport_cbs.write_socket_txtime && !conn->transport_cbs.write_mmsg_txtime) {
+            txtime = 0;
+        }
+        sent = conn->transport_cbs.write_socket_ecn(path->path_id, data, len,
+                                                    (struct sockaddr *)path->peer_addr,
+                                                    path->peer_addrlen, ecn, txtime,
+                                                    xqc_conn_get_user_data(conn));
+        if (sent != len) {
+            xqc_log(conn->log, XQC_LOG_ERROR,
+                    "|write_socket_ecn error|conn:%p|path:%ui|size:%ud|sent:%z|ecn:%d|txtime:%ui|",
+                    conn, path->path_id, len, sent, (int)ecn, txtime);
+
+            /* if callback return XQC_SOCKET_ERROR, close the connection */
+            if (sent == XQC_SOCKET_ERROR) {
+                path->path_flag |= XQC_PATH_FLAG_SOCKET_ERROR;
+                if (xqc_conn_should_close(conn, path)) {
+                    xqc_log(conn->log, XQC_LOG_ERROR, "|conn:%p|socket exception, close connection|", conn);
+                    conn->conn_state = XQC_CONN_STATE_CLOSED;
+                    xqc_log_event(conn->log, CON_CONNECTION_STATE_UPDATED, conn);
+                }
+            }
+
+            return sent == XQC_SOCKET_EAGAIN ? -XQC_EAGAIN : -XQC_ESOCKET;
+        }
+
+    } else if (conn->transport_cbs.write_socket_txtime) {
+        sent = conn->transport_cbs.write_socket_txtime(path->path_id, data, len,
+                                                       (struct sockaddr *)path->peer_addr,
+                                                       path->peer_addrlen, txtime,
+                                                       xqc_conn_get_user_data(conn));
+        if (sent != len) {
+            xqc_log(conn->log, XQC_LOG_ERROR,
+                    "|write_socket_txtime error|conn:%p|path:%ui|size:%ud|sent:%z|txtime:%ui|",
+                    conn, path->path_id, len, sent, txtime);
+
+            /* if callback return XQC_SOCKET_ERROR, close the connection */
+            if (sent == XQC_SOCKET_ERROR) {
+                path->path_flag |= XQC_PATH_FLAG_SOCKET_ERROR;
+                if (xqc_conn_should_close(conn, path)) {
+                    xqc_log(conn->log, XQC_LOG_ERROR, "|conn:%p|socket exception, close connection|", conn);
+                    conn->conn_state = XQC_CONN_STATE_CLOSED;
+                    xqc_log_event(conn->log, CON_CONNECTION_STATE_UPDATED, conn);
+                }
+            }
+
+            return sent == XQC_SOCKET_EAGAIN ? -XQC_EAGAIN : -XQC_ESOCKET;
+        }
+
     } else if (conn->transport_cbs.write_socket_ex) {
         sent = conn->transport_cbs.write_socket_ex(path->path_id, data, len,
                                                    (struct sockaddr *)path->peer_addr,
@@ -2559,6 +2745,8 @@ xqc_send(xqc_connection_t *conn, xqc_path_ctx_t *path, unsigned char *data, unsi
 
     xqc_log_event(conn->log, TRA_DATAGRAMS_SENT, sent, path->path_id);
 
+    conn->engine->perf_stats.datagrams_sent++;
+    conn->engine->perf_stats.bytes_sent += sent;
     return sent;
 }
 
@@ -2567,7 +2755,8 @@ ssize_t
 xqc_process_packet_without_pn(xqc_connection_t *conn, xqc_path_ctx_t *path, xqc_packet_out_t *packet_out)
 {
     /* directly send to peer */
-    ssize_t sent = xqc_send(conn, path, packet_out->po_buf, packet_out->po_used_size);
+    ssize_t sent = xqc_send(conn, path, packet_out->po_buf, packet_out->po_used_size, 0,
+                            XQC_ECN_NOT_ECT);
     xqc_log(conn->log, XQC_LOG_INFO, "|<==|conn:%p|size:%ud|sent:%z|pkt_type:%s|",
             conn, packet_out->po_used_size, sent, xqc_pkt_type_2_str(packet_out->po_pkt.pkt_type));
     xqc_log_event(conn->log, TRA_PACKET_SENT, conn, packet_out, path, 0, sent, 0);
@@ -2587,7 +2776,9 @@ xqc_send_packet_with_pn(xqc_connection_t *conn, xqc_path_ctx_t *path, xqc_packet
     packet_out->po_sent_time = now;
 
     /* send data */
-    ssize_t sent = xqc_send(conn, path, conn->enc_pkt, conn->enc_pkt_len);
+    uint8_t ecn = xqc_send_ctl_ecn_codepoint(path->path_send_ctl, packet_out);
+    ssize_t sent = xqc_send(conn, path, conn->enc_pkt, conn->enc_pkt_len,
+                            packet_out->po_release_time, ecn);
     if (sent != conn->enc_pkt_len) {
         xqc_log(conn->log, XQC_LOG_ERROR,
                 "|write_socket error|conn:%p|path:%ui|pkt_num:%ui|size:%ud|sent:%z|pkt_type:%s|frame:%s|now:%ui|",
@@ -3071,6 +3262,11 @@ xqc_path_send_one_or_two_ack_elicit_pkts(xqc_path_ctx_t *path,
         }
     }
 
+    /* peer might delay the ack of probes as asked by ACK_FREQUENCY */
+    if (pns == XQC_PNS_APP_DATA && c->ack_freq.send_seq > 0) {
+        xqc_write_immediate_ack_to_probe(c, path);
+    }
+
     if (has_reinjection) {
         xqc_path_ctx_t *path;
         xqc_list_for_each_safe(pos, next, &c->conn_paths_list) {
@@ -3082,6 +3278,102 @@ xqc_path_send_one_or_two_ack_elicit_pkts(xqc_path_ctx_t *path,
 }
 
 
+/* about 1 / 4 of the change in threshold or delay is worth a new ACK_FREQUENCY */
+static xqc_bool_t
+xqc_conn_ack_freq_changed(uint64_t prev, uint64_t cur)
+{
+    return cur * 4 < prev * 3 || cur * 3 > prev * 4;
+}
+
+/*
+ * ask peer for about XQC_ACK_FREQ_ACKS_PER_RTT acks per round trip on bulk flows. the threshold
+ * follows the smallest congestion window of active paths, and the ack rate of RFC 9000 is kept
+ * in slow start, where the window grows with acks. at most one ACK_FREQUENCY is sent per srtt.
+ */
+void
+xqc_conn_update_ack_frequency(xqc_connection_t *conn, xqc_usec_t now)
+{
+    xqc_list_head_t *pos, *next;
+    xqc_path_ctx_t *path;
+    xqc_send_ctl_t *send_ctl;
+    uint64_t threshold, pkts_per_ack;
+    uint32_t prev_threshold;
+    xqc_bool_t slow_start = XQC_FALSE;
+    xqc_usec_t srtt, max_ack_delay, prev_max_ack_delay;
+    xqc_usec_t peer_max_ack_delay = conn->remote_settings.max_ack_delay * 1000;
+
+    if (!conn->conn_settings.ack_frequency_on
+        || conn->remote_settings.min_ack_delay == 0
+        || !xqc_conn_is_handshake_confirmed(conn)
+        || conn->conn_state >= XQC_CONN_STATE_CLOSING)
+    {
+        return;
+    }
+
+    threshold = XQC_ACK_FREQ_MAX_THRESHOLD;
+    srtt = 0;
+    xqc_list_for_each_safe(pos, next, &conn->conn_paths_list) {
+        path = xqc_list_entry(pos, xqc_path_ctx_t, path_list);
+        if (path->path_state != XQC_PATH_STATE_ACTIVE) {
+            continue;
+        }
+
+        send_ctl = path->path_send_ctl;
+        if (send_ctl->ctl_cong_callback->xqc_cong_ctl_in_slow_start(send_ctl->ctl_cong)) {
+            pkts_per_ack = XQC_ACK_FREQ_DEFAULT_THRESHOLD + 1;
+            slow_start = XQC_TRUE;
+
+        } else {
+            pkts_per_ack = send_ctl->ctl_cong_callback->xqc_cong_ctl_get_cwnd(send_ctl->ctl_cong)
+                           / conn->pkt_out_size / XQC_ACK_FREQ_ACKS_PER_RTT;
+        }
+
+        threshold = xqc_min(threshold, pkts_per_ack > 0 ? pkts_per_ack - 1 : 0);
+        srtt = srtt == 0 ? send_ctl->ctl_srtt : xqc_min(srtt, send_ctl->ctl_srtt);
+    }
+
+    if (srtt == 0) {
+        return;
+    }
+
+    threshold = xqc_max(threshold, XQC_ACK_FREQ_DEFAULT_THRESHOLD);
+    max_ack_delay = slow_start ? peer_max_ack_delay
+                               : xqc_min(srtt / XQC_ACK_FREQ_ACKS_PER_RTT, peer_max_ack_delay);
+    max_ack_delay = xqc_max(max_ack_delay, conn->remote_settings.min_ack_delay);
+
+    if (conn->ack_freq.send_seq == 0) {
+        prev_threshold = XQC_ACK_FREQ_DEFAULT_THRESHOLD;
+        prev_max_ack_delay = peer_max_ack_delay;
+
+    } else {
+        if (now < conn->ack_freq.sent_time + srtt) {
+            return;
+        }
+        prev_threshold = conn->ack_freq.sent_threshold;
+        prev_max_ack_delay = conn->ack_freq.sent_max_ack_delay;
+    }
+
+    if (!xqc_conn_ack_freq_changed(prev_threshold, threshold)
+        && !xqc_conn_ack_freq_changed(prev_max_ack_delay, max_ack_delay))
+    {
+        return;
+    }
+
+    if (xqc_write_ack_frequency_to_packet(conn, conn->ack_freq.send_seq, threshold, max_ack_delay,
+                                          XQC_ACK_FREQ_REORDERING_THRESHOLD) != XQC_OK)
+    {
+        return;
+    }
+
+    xqc_log(conn->log, XQC_LOG_DEBUG, "|ack_frequency|seq:%ui|threshold:%ui|max_ack_delay:%ui|srtt:%ui|",
+            conn->ack_freq.send_seq, threshold, max_ack_delay, srtt);
+
+    conn->ack_freq.send_seq++;
+    conn->ack_freq.sent_threshold = threshold;
+    conn->ack_freq.sent_max_ack_delay = max_ack_delay;
+    conn->ack_freq.sent_time = now;
+}
+
 /* used by client to break amplification limit at server, or to prove address ownership */
 void
 xqc_conn_send_one_ack_eliciting_pkt(xqc_connection_t *conn, xqc_pkt_num_space_t pns)
@@ -3297,7 +3589,9 @@ xqc_conn_version_check(xqc_connection_t *c, uint32_t version)
             if (xqc_proto_version_value[i] == version) {
                 c->version = i;
 
+                xqc_perf_timing_begin(init_begin);
                 xqc_int_t ret = xqc_tls_init(c->tls, c->version, &c->original_dcid);
+                xqc_perf_timing_end(init_begin, c->engine->perf_stats.tls_init_ticks);
                 if (ret != XQC_OK) {
                     xqc_log(c->log, XQC_LOG_ERROR, "|init tls error|");
                     return ret;
@@ -3703,6 +3997,26 @@ xqc_conn_get_stats(xqc_engine_t *engine, const xqc_cid_t *cid)
     return conn_stats;
 }
 
+xqc_int_t
+xqc_conn_set_log_level(xqc_engine_t *engine, const xqc_cid_t *cid,
+    xqc_log_level_t log_level, qlog_event_importance_t qlog_importance)
+{
+    xqc_connection_t *conn = xqc_engine_conns_hash_find(engine, cid, 's');
+    if (!conn) {
+        xqc_log(engine->log, XQC_LOG_ERROR, "|can not find connection|cid:%s",
+                xqc_scid_str(engine, cid));
+        return -XQC_ECONN_NFOUND;
+    }
+
+    conn->log->log_level = log_level;
+    conn->log->qlog_importance = qlog_importance;
+    conn->log->log_event = 1;
+
+    xqc_log(conn->log, XQC_LOG_INFO, "|log level updated|log_level:%d|qlog_importance:%d|",
+            log_level, qlog_importance);
+    return XQC_OK;
+}
+
 xqc_conn_qos_stats_t 
 xqc_conn_get_qos_stats(xqc_engine_t *engine, const xqc_cid_t *cid)
 {
@@ -3925,6 +4239,7 @@ xqc_conn_early_data_reject(xqc_connection_t *conn)
     xqc_log(conn->log, XQC_LOG_DEBUG, "|reject|");
 
     conn->conn_flag |= XQC_CONN_FLAG_0RTT_REJ;
+    conn->engine->perf_stats.early_data_rejected++;
     if (conn->conn_type == XQC_CONN_TYPE_SERVER) {
         xqc_packet_in_t *packet_in;
         xqc_list_for_each_safe(pos, next, &conn->undecrypt_packet_in[XQC_ENC_LEV_0RTT]) {
@@ -3968,6 +4283,7 @@ xqc_conn_early_data_accept(xqc_connection_t *conn)
     xqc_log(conn->log, XQC_LOG_DEBUG, "|accept|");
 
     conn->conn_flag |= XQC_CONN_FLAG_0RTT_OK;
+    conn->engine->perf_stats.early_data_accepted++;
     if (conn->conn_type == XQC_CONN_TYPE_SERVER) {
         return XQC_OK;
     }
@@ -4084,6 +4400,11 @@ xqc_conn_handshake_complete(xqc_connection_t *conn)
     /* conn's handshake is complete when TLS stack has reported handshake complete */
     conn->conn_flag |= XQC_CONN_FLAG_HANDSHAKE_COMPLETED;
 
+    conn->engine->perf_stats.handshakes_completed++;
+    if (conn->tls && xqc_tls_is_session_resumed(conn->tls)) {
+        conn->engine->perf_stats.handshakes_resumed++;
+    }
+
     if (conn->conn_type == XQC_CONN_TYPE_SERVER) {
         /* the TLS handshake is considered confirmed at the server when the handshake completes */
         xqc_conn_handshake_confirmed(conn);
@@ -4170,6 +4491,7 @@ xqc_conn_buff_undecrypt_packet_in(xqc_packet_in_t *packet_in,
     new_packet->pos = (unsigned char *)new_packet->buf + (packet_in->pos - packet_in->buf);
     new_packet->last = (unsigned char *)new_packet->buf + (packet_in->last - packet_in->buf);
     new_packet->pkt_recv_time = packet_in->pkt_recv_time;
+    new_packet->pi_ecn = packet_in->pi_ecn;
 
     xqc_list_add_tail(&new_packet->pi_list, &conn->undecrypt_packet_in[encrypt_level]);
     conn->undecrypt_count[encrypt_level]++;
@@ -4196,7 +4518,8 @@ xqc_conn_process_undecrypt_packet_in(xqc_connection_t *conn, xqc_encrypt_level_t
         xqc_log_event(conn->log, TRA_DATAGRAMS_RECEIVED, packet_in->buf_size, packet_in->pi_path_id);
         xqc_log(conn->log, XQC_LOG_DEBUG, "|delay|undecrypt_count:%ud|encrypt_level:%d|",
                 conn->undecrypt_count[encrypt_level], encrypt_level);
-        ret = xqc_conn_process_packet(conn, packet_in->buf, packet_in->buf_size, packet_in->pkt_recv_time);       
+        ret = xqc_conn_process_packet(conn, packet_in->buf, packet_in->buf_size,
+                                      packet_in->pkt_recv_time, packet_in->pi_ecn);
         if (ret) {
             xqc_log(conn->log, XQC_LOG_ERROR, "|xqc_packet_process error|ret:%d|", ret);
             return ret;
@@ -4265,25 +4588,15 @@ xqc_conn_next_wakeup_time(xqc_connection_t *conn)
 {
     xqc_usec_t min_time = XQC_MAX_UINT64_VALUE;
     xqc_usec_t wakeup_time;
-    xqc_timer_t *timer;
+    xqc_usec_t expire_time;
 
-    for (xqc_timer_type_t type = 0; type < XQC_TIMER_N; ++type) {
-        timer = &conn->conn_timer_manager.timer[type];
-        if (timer->timer_is_set) {
-            min_time = xqc_min(min_time, timer->expire_time);
-        }
+    /* includes gp timers */
+    expire_time = xqc_timer_next_expire_time(&conn->conn_timer_manager);
+    if (expire_time != 0) {
+        min_time = expire_time;
     }
 
     xqc_list_head_t *pos, *next;
-    xqc_gp_timer_t *gp_timer;
-    /* gp timer */
-    xqc_list_for_each_safe(pos, next, &conn->conn_timer_manager.gp_timer_list) {
-        gp_timer = xqc_list_entry(pos, xqc_gp_timer_t, list);
-        if (gp_timer->timer_is_set) {
-            min_time = xqc_min(min_time, gp_timer->expire_time);
-        }
-    } 
-
     xqc_path_ctx_t *path;
     
     xqc_list_for_each_safe(pos, next, &conn->conn_paths_list) {
@@ -4292,11 +4605,9 @@ xqc_conn_next_wakeup_time(xqc_connection_t *conn)
             continue;
         }
 
-        for (xqc_timer_type_t type = 0; type < XQC_TIMER_N; ++type) {
-            timer = &path->path_send_ctl->path_timer_manager.timer[type];
-            if (timer->timer_is_set) {
-                min_time = xqc_min(min_time, timer->expire_time);
-            }
+        expire_time = xqc_timer_next_expire_time(&path->path_send_ctl->path_timer_manager);
+        if (expire_time != 0) {
+            min_time = xqc_min(min_time, expire_time);
         }
     }
 
@@ -4440,6 +4751,7 @@ xqc_conn_record_single(xqc_connection_t *c, xqc_packet_in_t *packet_in)
     int out_of_order = 0;
     xqc_pkt_num_space_t pns = packet_in->pi_pkt.pkt_pns;
     xqc_packet_number_t pkt_num = packet_in->pi_pkt.pkt_num;
+    xqc_packet_number_t largest;
 
     /* only recording the receive timestamp of pkt in app data space */
     if ((c->conn_settings.extended_ack_features & XQC_ACK_EXT_FEATURE_BIT_RECV_TS)
@@ -4459,8 +4771,38 @@ xqc_conn_record_single(xqc_connection_t *c, xqc_packet_in_t *packet_in)
             }
         }
 
-        if (pkt_num != xqc_recv_record_largest(&pn_ctl->ctl_recv_record[pns])) {
+        largest = xqc_recv_record_largest(&pn_ctl->ctl_recv_record[pns]);
+        if (pkt_num != largest) {
+            out_of_order = 1;
+
+            /* [ACK-FREQUENCY] reordering below the threshold asked by peer doesn't elicit an ack */
+            if (c->ack_freq.recv_on && pns == XQC_PNS_APP_DATA
+                && (c->ack_freq.reordering_threshold == 0
+                    || largest - pkt_num < c->ack_freq.reordering_threshold))
+            {
+                out_of_order = 0;
+            }
+        }
+
+        /* peer asks for an ack without delay */
+        if (packet_in->pi_frame_types & XQC_FRAME_BIT_IMMEDIATE_ACK) {
+            out_of_order = 1;
+        }
+
+        /* count ECN codepoints, CE marked packets are acknowledged immediately */
+        switch (packet_in->pi_ecn) {
+        case XQC_ECN_ECT0:
+            pn_ctl->ctl_ecn_recv[pns].ect0++;
+            break;
+        case XQC_ECN_ECT1:
+            pn_ctl->ctl_ecn_recv[pns].ect1++;
+            break;
+        case XQC_ECN_CE:
+            pn_ctl->ctl_ecn_recv[pns].ce++;
             out_of_order = 1;
+            break;
+        default:
+            break;
         }
 
         xqc_maybe_should_ack(c, path, pn_ctl, pns, out_of_order, packet_in->pkt_recv_time);
@@ -4729,7 +5071,7 @@ xqc_conn_log_recvd_packet(xqc_connection_t *c, xqc_packet_in_t *pi,
 xqc_int_t
 xqc_conn_process_packet(xqc_connection_t *c,
     const unsigned char *packet_in_buf, size_t packet_in_size, 
-    xqc_usec_t recv_time)
+    xqc_usec_t recv_time, uint8_t ecn)
 {
     xqc_int_t ret = XQC_OK;
     const unsigned char *last_pos = NULL;
@@ -4748,6 +5090,7 @@ xqc_conn_process_packet(xqc_connection_t *c,
         xqc_packet_in_init(packet_in, pos, end - pos, decrypt_payload, XQC_MAX_PACKET_IN_LEN, recv_time);
 
         packet_in->pi_path_id = XQC_UNKNOWN_PATH_ID;
+        packet_in->pi_ecn = ecn;
 
         /* packet_in->pos will update inside */
         ret = xqc_packet_process_single(c, packet_in);
@@ -5472,6 +5815,7 @@ xqc_conn_set_remote_transport_params(xqc_connection_t *conn,
     settings->extended_ack_features = params->extended_ack_features;
     settings->max_receive_timestamps_per_ack = params->max_receive_timestamps_per_ack;
     settings->receive_timestamps_exponent = params->receive_timestamps_exponent;
+    settings->min_ack_delay = params->min_ack_delay;
 
     if (conn->conn_type == XQC_CONN_TYPE_SERVER
         && settings->max_udp_payload_size >= XQC_PACKET_OUT_SIZE) {
@@ -5575,6 +5919,7 @@ xqc_conn_get_local_transport_params(xqc_connection_t *conn, xqc_transport_params
     params->extended_ack_features = settings->extended_ack_features;
     params->max_receive_timestamps_per_ack = settings->max_receive_timestamps_per_ack;
     params->receive_timestamps_exponent = settings->receive_timestamps_exponent;
+    params->min_ack_delay = settings->min_ack_delay;
 
     return XQC_OK;
 }
@@ -5615,6 +5960,11 @@ xqc_conn_check_transport_params(xqc_connection_t *conn, const xqc_transport_para
         }
     }
 
+    /* [ACK-FREQUENCY] min_ack_delay MUST NOT be greater than max_ack_delay */
+    if (params->min_ack_delay > params->max_ack_delay * 1000) {
+        return -XQC_TLS_TRANSPORT_PARAM;
+    }
+
     return XQC_OK;
 }
 
@@ -5639,8 +5989,16 @@ xqc_update_neg_info(xqc_connection_t *conn, xqc_transport_params_t params)
 void
 xqc_check_fec_trans_param(xqc_connection_t *conn, xqc_transport_params_t params)
 {
+    xqc_int_t i, max_symbols_num = 0;
+
+    /* the decoder scheme is not chosen yet, the chosen one is checked on negotiation */
+    for (i = 0; i < conn->local_settings.fec_decoder_schemes_num; i++) {
+        max_symbols_num = xqc_max(max_symbols_num,
+                                  xqc_fec_max_symbol_num_pblock(conn->local_settings.fec_decoder_schemes[i]));
+    }
+
     if (params.enable_encode_fec) {
-        if (params.fec_max_symbols_num > XQC_FEC_MAX_SYMBOL_NUM_PBLOCK) {
+        if (params.fec_max_symbols_num > max_symbols_num) {
             conn->conn_settings.enable_decode_fec = 0;
             conn->local_settings.enable_decode_fec = 0;
             conn->fec_neg_fail_reason |= XQC_REMOTE_PARAM_ERR;
@@ -5853,7 +6211,7 @@ xqc_conn_tls_transport_params_cb(const uint8_t *tp, size_t len, void *user_data)
     }
 
     /* notify application layer to save transport parameter */
-    if (conn->transport_cbs.save_tp_cb) {
+    if (conn->transport_cbs.save_tp_cb || conn->session_store_key) {
         char tp_buf[8192] = {0};
         ssize_t written = xqc_write_transport_params(tp_buf, sizeof(tp_buf), &params);
         if (written < 0) {
@@ -5861,7 +6219,16 @@ xqc_conn_tls_transport_params_cb(const uint8_t *tp, size_t len, void *user_data)
             return;
         }
 
-        conn->transport_cbs.save_tp_cb(tp_buf, written, conn->user_data);
+        if (conn->session_store_key) {
+            conn->engine->session_store_cbs.put(conn->engine->session_store,
+                                                conn->session_store_key,
+                                                conn->session_store_key_len,
+                                                XQC_SESSION_DATA_TP, tp_buf, written);
+        }
+
+        if (conn->transport_cbs.save_tp_cb) {
+            conn->transport_cbs.save_tp_cb(tp_buf, written, conn->user_data);
+        }
     }
 }
 
@@ -6005,7 +6372,17 @@ void
 xqc_conn_tls_session_cb(const char *data, size_t data_len, void *user_data)
 {
     xqc_connection_t *conn = (xqc_connection_t *)user_data;
-    conn->transport_cbs.save_session_cb(data, data_len, conn->user_data);
+    xqc_engine_t *engine = conn->engine;
+
+    if (conn->session_store_key) {
+        engine->session_store_cbs.put(engine->session_store, conn->session_store_key,
+                                      conn->session_store_key_len, XQC_SESSION_DATA_TICKET,
+                                      data, data_len);
+    }
+
+    if (conn->transport_cbs.save_session_cb) {
+        conn->transport_cbs.save_session_cb(data, data_len, conn->user_data);
+    }
 }
 
 void
@@ -6327,16 +6704,18 @@ xqc_conn_get_max_srtt(xqc_connection_t *conn)
 void
 xqc_conn_timer_expire(xqc_connection_t *conn, xqc_usec_t now)
 {
-    xqc_timer_expire(&conn->conn_timer_manager, now);
+    xqc_uint_t fired = xqc_timer_expire(&conn->conn_timer_manager, now);
 
     xqc_path_ctx_t *path = NULL;
     xqc_list_head_t *pos, *next;
     xqc_list_for_each_safe(pos, next, &conn->conn_paths_list) {
         path = xqc_list_entry(pos, xqc_path_ctx_t, path_list);
         if (path->path_state < XQC_PATH_STATE_CLOSED) {
-            xqc_timer_expire(&path->path_send_ctl->path_timer_manager, now);
+            fired += xqc_timer_expire(&path->path_send_ctl->path_timer_manager, now);
         }
     }
+
+    conn->engine->perf_stats.timer_fires += fired;
 }
 
 void xqc_conn_check_app_limit(xqc_connection_t *conn)
@@ -38,6 +38,12 @@
 
 #define XQC_MAX_RECV_WINDOW (16 * 1024 * 1024)
 
+/* ack frequency extension, ack rate asked for by sender */
+#define XQC_ACK_FREQ_ACKS_PER_RTT           4
+#define XQC_ACK_FREQ_DEFAULT_THRESHOLD      1   /* RFC 9000, ack every other ack-eliciting pkt */
+#define XQC_ACK_FREQ_MAX_THRESHOLD          64
+#define XQC_ACK_FREQ_REORDERING_THRESHOLD   1   /* ack out of order pkts immediately as RFC 9000 */
+
 #define XQC_MP_SETTINGS_STR_LEN (30)
 
 static const uint32_t MAX_RSP_CONN_CLOSE_CNT = 3;
@@ -225,6 +231,9 @@ typedef struct {
     uint64_t                max_receive_timestamps_per_ack;
     uint64_t                receive_timestamps_exponent;
     uint64_t                enable_pmtud;
+
+    /* draft-ietf-quic-ack-frequency, in us, 0 if not supported */
+    xqc_usec_t              min_ack_delay;
 } xqc_trans_settings_t;
  
 
@@ -316,8 +325,9 @@ struct xqc_connection_s {
 
     xqc_id_hash_table_t            *streams_hash;
     xqc_id_hash_table_t            *passive_streams_hash;
-    xqc_list_head_t                 conn_write_streams,
-                                    conn_read_streams, /* xqc_stream_t */
+    /* writable streams bucketed by urgency, xqc_stream_t */
+    xqc_list_head_t                 conn_write_streams[XQC_STREAM_URGENCY_LEVELS];
+    xqc_list_head_t                 conn_read_streams, /* xqc_stream_t */
                                     conn_closing_streams,
                                     conn_all_streams;
     xqc_stream_t                   *crypto_stream[XQC_ENC_LEV_MAX];
@@ -341,6 +351,10 @@ struct xqc_connection_s {
     /* callback function and user_data to application-layer-protocol layer */
     char                           *alpn;
     size_t                          alpn_len;
+
+    /* key of server in session store of engine, NULL if session store is disabled */
+    char                           *session_store_key;
+    size_t                          session_store_key_len;
     xqc_app_proto_callbacks_t       app_proto_cbs;
     void                           *proto_data;
 
@@ -494,6 +508,22 @@ struct xqc_connection_s {
     xqc_usec_t                      conn_avg_recv_delay;
     xqc_usec_t                      conn_latest_close_delay;
     uint32_t                        conn_video_frames;
+
+    /* ack frequency extension (draft-ietf-quic-ack-frequency) */
+    struct {
+        /* received ACK_FREQUENCY, valid if recv_on */
+        uint8_t                     recv_on;
+        uint64_t                    recv_seq;
+        uint32_t                    ack_eliciting_threshold;
+        xqc_usec_t                  max_ack_delay;
+        uint64_t                    reordering_threshold;
+
+        /* sent ACK_FREQUENCY, send_seq is the sequence number of the next one */
+        uint64_t                    send_seq;
+        uint32_t                    sent_threshold;
+        xqc_usec_t                  sent_max_ack_delay;
+        xqc_usec_t                  sent_time;
+    } ack_freq;
 };
 
 extern const xqc_h3_conn_settings_t default_local_h3_conn_settings;
@@ -514,6 +544,8 @@ void xqc_conn_destroy(xqc_connection_t *xc);
 xqc_int_t xqc_conn_client_on_alpn(xqc_connection_t *conn, const unsigned char *alpn, size_t alpn_len);
 xqc_int_t xqc_conn_server_on_alpn(xqc_connection_t *conn, const unsigned char *alpn, size_t alpn_len);
 
+ssize_t xqc_send(xqc_connection_t *conn, xqc_path_ctx_t *path, unsigned char *data, unsigned int len,
+    xqc_usec_t txtime, uint8_t ecn);
 ssize_t xqc_path_send_one_packet(xqc_connection_t *conn, xqc_path_ctx_t *path, xqc_packet_out_t *packet_out);
 void xqc_conn_send_packets(xqc_connection_t *conn);
 void xqc_conn_send_packets_batch(xqc_connection_t *conn);
@@ -533,6 +565,9 @@ xqc_int_t xqc_path_send_ping_to_probe(xqc_path_ctx_t *path, xqc_pkt_num_space_t
 void xqc_path_send_one_or_two_ack_elicit_pkts(xqc_path_ctx_t *path, xqc_pkt_num_space_t pns);
 void xqc_conn_send_one_ack_eliciting_pkt(xqc_connection_t *conn, xqc_pkt_num_space_t pns);
 
+/* send ACK_FREQUENCY if the ack rate needed by congestion windows changed, see ack_frequency_on */
+void xqc_conn_update_ack_frequency(xqc_connection_t *conn, xqc_usec_t now);
+
 xqc_int_t xqc_conn_check_handshake_completed(xqc_connection_t *conn);
 xqc_int_t xqc_conn_is_handshake_confirmed(xqc_connection_t *conn);
 xqc_int_t xqc_conn_immediate_close(xqc_connection_t *conn);
@@ -594,7 +629,7 @@ xqc_conn_has_undecrypt_packets(xqc_connection_t *conn)
 
 /* process an UDP datagram */
 xqc_int_t xqc_conn_process_packet(xqc_connection_t *c, const unsigned char *packet_in_buf,
-    size_t packet_in_size, xqc_usec_t recv_time);
+    size_t packet_in_size, xqc_usec_t recv_time, uint8_t ecn);
 
 void xqc_conn_process_packet_recved_path(xqc_connection_t *conn, xqc_cid_t *scid, 
     size_t packet_in_size, xqc_usec_t recv_time);
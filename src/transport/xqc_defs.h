@@ -36,6 +36,9 @@
 /* the value of max_streams transport parameter or MAX_STREAMS frame must <= 2^60 */
 #define XQC_MAX_STREAMS                 ((uint64_t)1 << 60)
 
+/* number of urgency levels (RFC 9218) served by the stream write scheduler */
+#define XQC_STREAM_URGENCY_LEVELS       (XQC_LOWEST_HTTP_PRIORITY_URGENCY + 1)
+
 #define XQC_CONN_MAX_CRYPTO_DATA_TOTAL_LEN (10*1024*1024)
 
 
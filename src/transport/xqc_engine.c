@@ -7,7 +7,7 @@
 #include "src/common/xqc_str.h"
 #include "src/common/xqc_random.h"
 #include "src/common/xqc_priority_q.h"
-#include "src/common/xqc_str_hash.h"
+#include "src/common/utils/oa_hash/xqc_oa_hash.h"
 #include "src/common/xqc_hash.h"
 #include "src/transport/xqc_defs.h"
 #include "src/transport/xqc_conn.h"
@@ -39,7 +39,7 @@ xqc_config_t default_client_config = {
     .conn_pool_size            = 4096,
     .streams_hash_bucket_size  = 1024,
     .conns_hash_bucket_size    = 1024,
-    .hash_conflict_threshold   = XQC_HASH_DEFAULT_CONFLICT_THRESHOLD,
+    .hash_conflict_threshold   = XQC_OA_HASH_DEFAULT_PROBE_THRESHOLD,
     .conns_active_pq_capacity  = 128,
     .conns_wakeup_pq_capacity  = 128,
     .support_version_count     = 1,
@@ -51,6 +51,8 @@ xqc_config_t default_client_config = {
     .sendmmsg_on               = 0,
     .enable_h3_ext             = 0,
     .manually_triggered_send   = 0,
+    .conn_cache_size           = 0,
+    .ssl_prewarm_cnt           = 0,
 };
 
 
@@ -62,8 +64,8 @@ xqc_config_t default_server_config = {
     .cfg_log_level_name        = 1,
     .conn_pool_size            = 4096,
     .streams_hash_bucket_size  = 1024,
-    .conns_hash_bucket_size    = 1024*1024, /* too many connections will affect lookup performance */
-    .hash_conflict_threshold   = XQC_HASH_DEFAULT_CONFLICT_THRESHOLD,
+    .conns_hash_bucket_size    = XQC_OA_HASH_MAX_INIT_CAPACITY, /* grows incrementally with connections */
+    .hash_conflict_threshold   = XQC_OA_HASH_DEFAULT_PROBE_THRESHOLD,
     .conns_active_pq_capacity  = 1024,
     .conns_wakeup_pq_capacity  = 16*1024,
     .support_version_count     = 2,
@@ -75,6 +77,8 @@ xqc_config_t default_server_config = {
     .sendmmsg_on               = 0,
     .enable_h3_ext             = 0,
     .manually_triggered_send   = 0,
+    .conn_cache_size           = 256,
+    .ssl_prewarm_cnt           = 16,
 };
 
 
@@ -141,6 +145,8 @@ xqc_set_config(xqc_config_t *dst, const xqc_config_t *src)
     dst->cfg_log_level_name = src->cfg_log_level_name;
     dst->sendmmsg_on = src->sendmmsg_on;
     dst->enable_h3_ext = src->enable_h3_ext;
+    dst->conn_cache_size = src->conn_cache_size;
+    dst->ssl_prewarm_cnt = src->ssl_prewarm_cnt;
 
     return XQC_OK;
 }
@@ -200,15 +206,195 @@ xqc_engine_set_log_level(xqc_engine_t *engine, xqc_log_level_t log_level)
 }
 
 
-xqc_str_hash_table_t *
+xqc_int_t
+xqc_engine_enable_binlog(xqc_engine_t *engine, size_t capacity)
+{
+    xqc_binlog_t *binlog = NULL;
+
+    if (capacity > 0) {
+        binlog = xqc_binlog_create(capacity);
+        if (binlog == NULL) {
+            xqc_log(engine->log, XQC_LOG_ERROR, "|create binlog error|capacity:%uz|", capacity);
+            return -XQC_EMALLOC;
+        }
+    }
+
+    xqc_binlog_destroy(engine->binlog);
+    engine->binlog = binlog;
+    return XQC_OK;
+}
+
+size_t
+xqc_engine_read_binlog(xqc_engine_t *engine, uint8_t *buf, size_t buf_len)
+{
+    if (engine->binlog == NULL) {
+        return 0;
+    }
+
+    return xqc_binlog_read(engine->binlog, buf, buf_len);
+}
+
+void
+xqc_engine_get_perf_stats(xqc_engine_t *engine, xqc_engine_perf_stats_t *stats)
+{
+    *stats = engine->perf_stats;
+    stats->ssl_prewarm_hits = xqc_tls_ctx_get_prewarm_hits(engine->tls_ctx);
+}
+
+void
+xqc_engine_set_session_store(xqc_engine_t *engine, const xqc_session_store_callbacks_t *cbs,
+    void *store)
+{
+    if (cbs == NULL || cbs->get == NULL || cbs->put == NULL) {
+        xqc_memzero(&engine->session_store_cbs, sizeof(xqc_session_store_callbacks_t));
+        engine->session_store = NULL;
+        return;
+    }
+
+    engine->session_store_cbs = *cbs;
+    engine->session_store = store;
+}
+
+xqc_int_t
+xqc_engine_rotate_session_ticket_key(xqc_engine_t *engine, const char *key_data, size_t key_len)
+{
+    xqc_int_t ret;
+
+    if (engine->eng_type != XQC_ENGINE_SERVER || engine->tls_ctx == NULL) {
+        return -XQC_EPARAM;
+    }
+
+    ret = xqc_tls_ctx_rotate_session_ticket_key(engine->tls_ctx, key_data, key_len);
+    if (ret != XQC_OK) {
+        xqc_log(engine->log, XQC_LOG_ERROR, "|rotate session ticket key error|ret:%d|", ret);
+        return ret;
+    }
+
+    xqc_log(engine->log, XQC_LOG_INFO, "|session ticket key rotated|");
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_engine_add_log_override(xqc_engine_t *engine, const xqc_log_override_t *rule)
+{
+    xqc_log_override_rule_t *ovr;
+
+    if (engine->log_override_cnt >= XQC_LOG_OVERRIDE_MAX) {
+        xqc_log(engine->log, XQC_LOG_ERROR, "|too many log override rules|");
+        return -XQC_ELIMIT;
+    }
+
+    ovr = &engine->log_overrides[engine->log_override_cnt];
+    xqc_memzero(ovr, sizeof(xqc_log_override_rule_t));
+
+    if (rule->peer_addr != NULL) {
+        if (xqc_memcpy_with_cap(ovr->peer_addr, sizeof(ovr->peer_addr),
+                                rule->peer_addr, rule->peer_addrlen) != XQC_OK)
+        {
+            xqc_log(engine->log, XQC_LOG_ERROR, "|peer addr too large|addr_len:%d|",
+                    (int)rule->peer_addrlen);
+            return -XQC_EPARAM;
+        }
+        ovr->peer_addrlen = rule->peer_addrlen;
+        ovr->prefix_len = rule->prefix_len;
+    }
+
+    ovr->sample_rate = rule->sample_rate;
+    ovr->log_level = rule->log_level;
+    ovr->qlog_importance = rule->qlog_importance;
+
+    engine->log_override_cnt++;
+    return XQC_OK;
+}
+
+void
+xqc_engine_clear_log_overrides(xqc_engine_t *engine)
+{
+    engine->log_override_cnt = 0;
+}
+
+static xqc_bool_t
+xqc_engine_log_override_match_addr(xqc_log_override_rule_t *ovr, const struct sockaddr *peer_addr)
+{
+    const struct sockaddr *rule_addr = (const struct sockaddr *)ovr->peer_addr;
+    const unsigned char *a, *b;
+    uint32_t bits, prefix_len;
+
+    if (ovr->peer_addrlen == 0) {
+        return XQC_TRUE;
+    }
+
+    if (rule_addr->sa_family != peer_addr->sa_family) {
+        return XQC_FALSE;
+    }
+
+    if (rule_addr->sa_family == AF_INET) {
+        a = (const unsigned char *)&((const struct sockaddr_in *)rule_addr)->sin_addr;
+        b = (const unsigned char *)&((const struct sockaddr_in *)peer_addr)->sin_addr;
+        bits = sizeof(struct in_addr) * 8;
+
+    } else if (rule_addr->sa_family == AF_INET6) {
+        a = (const unsigned char *)&((const struct sockaddr_in6 *)rule_addr)->sin6_addr;
+        b = (const unsigned char *)&((const struct sockaddr_in6 *)peer_addr)->sin6_addr;
+        bits = sizeof(struct in6_addr) * 8;
+
+    } else {
+        return XQC_FALSE;
+    }
+
+    prefix_len = xqc_min(ovr->prefix_len, bits);
+    if (memcmp(a, b, prefix_len / 8) != 0) {
+        return XQC_FALSE;
+    }
+
+    if (prefix_len % 8 != 0) {
+        unsigned char mask = (unsigned char)(0xff << (8 - prefix_len % 8));
+        if ((a[prefix_len / 8] & mask) != (b[prefix_len / 8] & mask)) {
+            return XQC_FALSE;
+        }
+    }
+
+    return XQC_TRUE;
+}
+
+void
+xqc_engine_log_override_select(xqc_engine_t *engine, xqc_connection_t *conn)
+{
+    xqc_log_override_rule_t *ovr;
+
+    for (uint32_t i = 0; i < engine->log_override_cnt; i++) {
+        ovr = &engine->log_overrides[i];
+        if (ovr->peer_addrlen > 0
+            && (conn->peer_addrlen == 0
+                || !xqc_engine_log_override_match_addr(ovr, (struct sockaddr *)conn->peer_addr)))
+        {
+            continue;
+        }
+
+        if (ovr->sample_rate > 1 && ovr->matched_cnt++ % ovr->sample_rate != 0) {
+            continue;
+        }
+
+        conn->log->log_level = ovr->log_level;
+        conn->log->qlog_importance = ovr->qlog_importance;
+        conn->log->log_event = 1;
+
+        xqc_log(conn->log, XQC_LOG_INFO, "|log override selected|rule:%ud|log_level:%d|"
+                "qlog_importance:%d|", i, ovr->log_level, ovr->qlog_importance);
+        return;
+    }
+}
+
+
+xqc_oa_hash_table_t *
 xqc_engine_conns_hash_create(xqc_config_t *config, uint8_t *key, size_t key_len, xqc_log_t *log)
 {
-    xqc_str_hash_table_t *hash_table = xqc_malloc(sizeof(xqc_str_hash_table_t));
+    xqc_oa_hash_table_t *hash_table = xqc_malloc(sizeof(xqc_oa_hash_table_t));
     if (hash_table == NULL) {
         return NULL;
     }
 
-    if (xqc_str_hash_init(hash_table, xqc_default_allocator,
+    if (xqc_oa_hash_init(hash_table, xqc_default_allocator,
             config->conns_hash_bucket_size, config->hash_conflict_threshold,
             key, key_len, log))
     {
@@ -224,9 +410,9 @@ fail:
 
 
 void
-xqc_engine_conns_hash_destroy(xqc_str_hash_table_t *hash_table)
+xqc_engine_conns_hash_destroy(xqc_oa_hash_table_t *hash_table)
 {
-    xqc_str_hash_release(hash_table);
+    xqc_oa_hash_release(hash_table);
     xqc_free(hash_table);
 }
 
@@ -279,19 +465,16 @@ xqc_engine_conns_hash_find(xqc_engine_t *engine, const xqc_cid_t *cid, char type
     }
 
     uint64_t hash;
-    xqc_str_t str;
-    str.data = (unsigned char *)cid->cid_buf;
-    str.len = cid->cid_len;
 
     if (type == 's') {
         /* search by endpoint's cid */
-        hash = xqc_siphash_get_hash(&engine->conns_hash->siphash_ctx, cid->cid_buf, cid->cid_len);
-        return xqc_str_hash_find(engine->conns_hash, hash, str);
+        hash = xqc_oa_hash_get_hash(engine->conns_hash, cid->cid_buf, cid->cid_len);
+        return xqc_oa_hash_find(engine->conns_hash, hash, cid->cid_buf, cid->cid_len);
 
     } else {
         /* search by peer's cid */
-        hash = xqc_siphash_get_hash(&engine->conns_hash_dcid->siphash_ctx, cid->cid_buf, cid->cid_len);
-        xqc_conn = xqc_str_hash_find(engine->conns_hash_dcid, hash, str);
+        hash = xqc_oa_hash_get_hash(engine->conns_hash_dcid, cid->cid_buf, cid->cid_len);
+        xqc_conn = xqc_oa_hash_find(engine->conns_hash_dcid, hash, cid->cid_buf, cid->cid_len);
         if (xqc_conn == NULL) {
             xqc_log(engine->log, XQC_LOG_ERROR, "|xquic find dcid error|dcid:%s|",
                     xqc_dcid_str(engine, cid));
@@ -385,8 +568,10 @@ xqc_bool_t
 xqc_engine_check_config(xqc_engine_type_t engine_type, const xqc_config_t *engine_config,
     const xqc_engine_ssl_config_t *ssl_config, const xqc_transport_callbacks_t *transport_cbs)
 {
-    /* mismatch of sendmmsg_on enable and write_mmsg & write_mmsg_ex callback function */
-    if (engine_config && engine_config->sendmmsg_on && transport_cbs->write_mmsg == NULL && transport_cbs->write_mmsg_ex == NULL) {
+    /* mismatch of sendmmsg_on enable and write_mmsg & write_mmsg_ex & write_mmsg_txtime callback function */
+    if (engine_config && engine_config->sendmmsg_on && transport_cbs->write_mmsg == NULL
+        && transport_cbs->write_mmsg_ex == NULL && transport_cbs->write_mmsg_txtime == NULL)
+    {
         return XQC_FALSE;
     }
 
@@ -494,6 +679,14 @@ xqc_engine_create(xqc_engine_type_t engine_type,
         goto fail;
     }
 
+    if (engine->config->ssl_prewarm_cnt > 0
+        && xqc_tls_ctx_prewarm_ssl(engine->tls_ctx, engine->config->ssl_prewarm_cnt,
+                                   engine->config->ssl_prewarm_cnt) != XQC_OK)
+    {
+        xqc_log(engine->log, XQC_LOG_ERROR, "|prewarm ssl error|");
+        goto fail;
+    }
+
     engine->default_conn_settings = internal_default_conn_settings;
 
     return engine;
@@ -504,6 +697,22 @@ fail:
 }
 
 
+static void
+xqc_engine_free_conn_cache(xqc_engine_t *engine)
+{
+    xqc_conn_cache_node_t *node;
+
+    while (engine->conn_cache) {
+        node = engine->conn_cache;
+        engine->conn_cache = node->next;
+        xqc_destroy_pool(node->pool);
+        xqc_free(node);
+    }
+
+    engine->conn_cache_cnt = 0;
+}
+
+
 void
 xqc_engine_destroy(xqc_engine_t *engine)
 {
@@ -561,6 +770,8 @@ xqc_engine_destroy(xqc_engine_t *engine)
         engine->conns_wait_wakeup_pq = NULL;
     }
 
+    xqc_engine_free_conn_cache(engine);
+
     if (engine->tls_ctx) {
         xqc_tls_ctx_destroy(engine->tls_ctx);
         engine->tls_ctx = NULL;
@@ -599,6 +810,8 @@ xqc_engine_destroy(xqc_engine_t *engine)
         xqc_log_release(engine->log);
     }
 
+    xqc_binlog_destroy(engine->binlog);
+
     xqc_free(engine);
 }
 
@@ -889,6 +1102,7 @@ xqc_engine_main_logic(xqc_engine_t *engine)
         return;
     }
     engine->eng_flag |= XQC_ENG_FLAG_RUNNING;
+    engine->perf_stats.main_logic_calls++;
 
     xqc_usec_t now = xqc_monotonic_timestamp();
     xqc_connection_t *conn;
@@ -972,6 +1186,12 @@ xqc_engine_main_logic(xqc_engine_t *engine)
         }
     }
 
+    /* refill pre-warmed SSL objects taken by new connections, a few at a time */
+    if (engine->config->ssl_prewarm_cnt > 0) {
+        xqc_tls_ctx_prewarm_ssl(engine->tls_ctx, engine->config->ssl_prewarm_cnt,
+                                XQC_SSL_PREWARM_BATCH);
+    }
+
     xqc_usec_t wake_after = xqc_engine_wakeup_after(engine);
     if (wake_after > 0) {
         engine->eng_callback.set_event_timer(wake_after, engine->user_data);
@@ -993,7 +1213,6 @@ xqc_engine_handle_stateless_reset(xqc_engine_t *engine,
     const uint8_t     *sr_token;
     xqc_connection_t  *conn;
     uint64_t           hash;
-    xqc_str_t          str;
 
     ret = -XQC_ERROR;
 
@@ -1009,13 +1228,12 @@ xqc_engine_handle_stateless_reset(xqc_engine_t *engine,
         return -XQC_ERROR;
     }
 
-    hash = xqc_siphash_get_hash(&engine->conns_hash_sr_token->siphash_ctx,
-                                sr_token, XQC_STATELESS_RESET_TOKENLEN); 
-    str.data = (unsigned char *)sr_token;
-    str.len = XQC_STATELESS_RESET_TOKENLEN;
+    hash = xqc_oa_hash_get_hash(engine->conns_hash_sr_token,
+                                sr_token, XQC_STATELESS_RESET_TOKENLEN);
 
     /* try to find connection with sr_token */
-    conn = xqc_str_hash_find(engine->conns_hash_sr_token, hash, str);
+    conn = xqc_oa_hash_find(engine->conns_hash_sr_token, hash,
+                            sr_token, XQC_STATELESS_RESET_TOKENLEN);
     if (NULL == conn) {
         /* can't find connection with sr_token */
         xqc_log(engine->log, XQC_LOG_DEBUG, "|can't find conn with sr|sr:%s",
@@ -1101,6 +1319,22 @@ xqc_engine_packet_process(xqc_engine_t *engine,
     const struct sockaddr *local_addr, socklen_t local_addrlen,
     const struct sockaddr *peer_addr, socklen_t peer_addrlen,
     xqc_usec_t recv_time, void *user_data)
+{
+    return xqc_engine_packet_process_ecn(engine, packet_in_buf, packet_in_size,
+                                         local_addr, local_addrlen, peer_addr, peer_addrlen,
+                                         recv_time, XQC_ECN_NOT_ECT, user_data);
+}
+
+/**
+ * Pass received UDP packet payload into xquic engine, with ECN codepoint of IP header.
+ * @param ecn   ECN codepoint of the UDP packet
+ */
+xqc_int_t
+xqc_engine_packet_process_ecn(xqc_engine_t *engine,
+    const unsigned char *packet_in_buf, size_t packet_in_size,
+    const struct sockaddr *local_addr, socklen_t local_addrlen,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+    xqc_usec_t recv_time, uint8_t ecn, void *user_data)
 {
     xqc_int_t ret;
     xqc_connection_t *conn = NULL;
@@ -1110,6 +1344,9 @@ xqc_engine_packet_process(xqc_engine_t *engine,
     xqc_cid_init_zero(&dcid);
     xqc_cid_init_zero(&scid);
 
+    engine->perf_stats.datagrams_recv++;
+    engine->perf_stats.bytes_recv += packet_in_size;
+
     /* reverse packet's dcid/scid to endpoint's scid/dcid */
     ret = xqc_packet_parse_cid(&scid, &dcid, engine->config->cid_len,
                                (unsigned char *)packet_in_buf, packet_in_size);
@@ -1246,7 +1483,7 @@ process:
     }
 
     /* process packets */
-    ret = xqc_conn_process_packet(conn, packet_in_buf, packet_in_size, recv_time);
+    ret = xqc_conn_process_packet(conn, packet_in_buf, packet_in_size, recv_time, ecn);
 
     conn->rcv_pkt_stats.conn_udp_pkts++;
 
@@ -1478,8 +1715,11 @@ xqc_bool_t
 xqc_engine_is_sendmmsg_on(xqc_engine_t *engine, xqc_connection_t *conn)
 {
     return engine->config->sendmmsg_on
-        && (engine->transport_cbs.write_mmsg || engine->transport_cbs.write_mmsg_ex)
-        && (!conn->conn_settings.disable_send_mmsg);
+        && (engine->transport_cbs.write_mmsg || engine->transport_cbs.write_mmsg_ex
+            || engine->transport_cbs.write_mmsg_txtime)
+        && (!conn->conn_settings.disable_send_mmsg)
+        /* ECN codepoint is set packet by packet with write_socket_ecn */
+        && !(conn->conn_settings.ecn_on && engine->transport_cbs.write_socket_ecn);
 }
 
 
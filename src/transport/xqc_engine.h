@@ -11,9 +11,15 @@
 #include <xquic/xquic.h>
 #include "src/tls/xqc_tls.h"
 #include "src/common/xqc_list.h"
+#include "src/common/xqc_binlog.h"
+#include "src/common/xqc_perf.h"
+#include "src/common/xqc_memory_pool.h"
 
 #define XQC_RESET_CNT_ARRAY_LEN 16384
 
+/* max SSL objects pre-warmed in one xqc_engine_main_logic */
+#define XQC_SSL_PREWARM_BATCH   4
+
 
 typedef enum {
     XQC_ENG_FLAG_RUNNING    = 1 << 0,
@@ -38,6 +44,27 @@ typedef struct xqc_alpn_registration_s {
 } xqc_alpn_registration_t;
 
 
+/* log override rule, with peer address copied from xqc_log_override_t */
+typedef struct xqc_log_override_rule_s {
+    unsigned char                   peer_addr[sizeof(struct sockaddr_in6)];
+    socklen_t                       peer_addrlen;
+    uint8_t                         prefix_len;
+    uint32_t                        sample_rate;
+    xqc_log_level_t                 log_level;
+    qlog_event_importance_t         qlog_importance;
+
+    /* count of connections matched peer address, for sampling */
+    uint64_t                        matched_cnt;
+} xqc_log_override_rule_t;
+
+
+/* node of connection cache, overlaid on the memory of a destroyed xqc_connection_t */
+typedef struct xqc_conn_cache_node_s {
+    struct xqc_conn_cache_node_s   *next;
+    xqc_memory_pool_t              *pool;
+} xqc_conn_cache_node_t;
+
+
 typedef struct xqc_engine_s {
     /* for engine itself */
     xqc_engine_type_t               eng_type;
@@ -46,11 +73,13 @@ typedef struct xqc_engine_s {
 
     /* for connections */
     xqc_config_t                   *config;
-    xqc_str_hash_table_t           *conns_hash;             /* scid */
-    xqc_str_hash_table_t           *conns_hash_dcid;        /* For reset packet */
-    xqc_str_hash_table_t           *conns_hash_sr_token;    /* For stateless reset */
+    xqc_oa_hash_table_t           *conns_hash;             /* scid */
+    xqc_oa_hash_table_t           *conns_hash_dcid;        /* For reset packet */
+    xqc_oa_hash_table_t           *conns_hash_sr_token;    /* For stateless reset */
     xqc_pq_t                       *conns_active_pq;        /* In process */
     xqc_pq_t                       *conns_wait_wakeup_pq;   /* Need wakeup after next tick time */
+    xqc_conn_cache_node_t          *conn_cache;             /* Memory of destroyed conns */
+    uint32_t                        conn_cache_cnt;
     uint8_t                         reset_sent_cnt[XQC_RESET_CNT_ARRAY_LEN]; /* remote addr hash */
     xqc_usec_t                      reset_sent_cnt_cleared;
 
@@ -60,6 +89,20 @@ typedef struct xqc_engine_s {
     xqc_log_t                      *log;
     xqc_random_generator_t         *rand_generator;
 
+    /* binary event log, NULL if disabled */
+    xqc_binlog_t                   *binlog;
+
+    /* engine-wide performance counters */
+    xqc_engine_perf_stats_t         perf_stats;
+
+    /* per-connection log override rules */
+    xqc_log_override_rule_t         log_overrides[XQC_LOG_OVERRIDE_MAX];
+    uint32_t                        log_override_cnt;
+
+    /* session store of client, NULL if disabled */
+    xqc_session_store_callbacks_t   session_store_cbs;
+    void                           *session_store;
+
     /* for user */
     void                           *user_data;
 
@@ -81,12 +124,22 @@ typedef struct xqc_engine_s {
 
     void                           *priv_ctx;
 
+    /* dispatcher and shard id in sharded engine mode, NULL if not sharded */
+    xqc_shard_dispatcher_t         *shard_dispatcher;
+    uint32_t                        shard_id;
+
 } xqc_engine_t;
 
 
 
 xqc_usec_t xqc_engine_wakeup_after(xqc_engine_t *engine);
 
+/**
+ * apply the first matched log override rule to a new created connection, shall be called
+ * after peer address of connection is set
+ */
+void xqc_engine_log_override_select(xqc_engine_t *engine, xqc_connection_t *conn);
+
 
 /**
  * Create engine config.
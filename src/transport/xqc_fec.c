@@ -5,9 +5,12 @@
 
 #include "src/transport/xqc_fec.h"
 #include "src/transport/xqc_fec_scheme.h"
+#include "src/transport/xqc_fec_codec.h"
 #include "src/transport/xqc_conn.h"
 #include "src/transport/xqc_send_queue.h"
 #include "src/transport/xqc_packet_out.h"
+#include "src/transport/fec_schemes/xqc_rlc.h"
+#include "src/transport/fec_schemes/xqc_reed_solomon16.h"
 
 #define XQC_FEC_MAX_SCHEME_VAL 32
 #define MAX_FEC_CODE_RATE (20)
@@ -45,6 +48,20 @@ xqc_set_valid_encoder_scheme_cb(xqc_fec_code_callback_t *callback, xqc_int_t sch
         callback->xqc_fec_init_one = xqc_fountain_code_cb.xqc_fec_init_one;
         callback->xqc_fec_encode = xqc_fountain_code_cb.xqc_fec_encode;
         return XQC_OK;
+#endif
+#ifdef XQC_ENABLE_RLC
+    case XQC_RLC_CODE:
+        callback->xqc_fec_init = xqc_rlc_code_cb.xqc_fec_init;
+        callback->xqc_fec_init_one = xqc_rlc_code_cb.xqc_fec_init_one;
+        callback->xqc_fec_encode = xqc_rlc_code_cb.xqc_fec_encode;
+        return XQC_OK;
+#endif
+#ifdef XQC_ENABLE_RS16
+    case XQC_REED_SOLOMON_16_CODE:
+        callback->xqc_fec_init = xqc_reed_solomon16_code_cb.xqc_fec_init;
+        callback->xqc_fec_init_one = xqc_reed_solomon16_code_cb.xqc_fec_init_one;
+        callback->xqc_fec_encode = xqc_reed_solomon16_code_cb.xqc_fec_encode;
+        return XQC_OK;
 #endif
     }
 
@@ -75,6 +92,16 @@ xqc_set_valid_decoder_scheme_cb(xqc_fec_code_callback_t *callback, xqc_int_t sch
     case XQC_RAPTORQ_CODE:
         callback->xqc_fec_decode = xqc_fountain_code_cb.xqc_fec_decode;
         return XQC_OK;
+#endif
+#ifdef XQC_ENABLE_RLC
+    case XQC_RLC_CODE:
+        callback->xqc_fec_decode_one = xqc_rlc_code_cb.xqc_fec_decode_one;
+        return XQC_OK;
+#endif
+#ifdef XQC_ENABLE_RS16
+    case XQC_REED_SOLOMON_16_CODE:
+        callback->xqc_fec_decode = xqc_reed_solomon16_code_cb.xqc_fec_decode;
+        return XQC_OK;
 #endif
     }
 
@@ -94,6 +121,10 @@ xqc_get_fec_scheme_str(xqc_fec_schemes_e scheme)
         return "Packet-Mask";
     case XQC_RAPTORQ_CODE:
         return "Fountain";
+    case XQC_RLC_CODE:
+        return "Sliding-Window-RLC";
+    case XQC_REED_SOLOMON_16_CODE:
+        return "Reed-Solomon-GF16";
     default:
         return "NO_FEC";
     }
@@ -189,6 +220,12 @@ xqc_set_fec_scheme(uint64_t in, xqc_fec_schemes_e *out)
     case XQC_RAPTORQ_CODE:
         *out = XQC_RAPTORQ_CODE;
         return XQC_OK;
+    case XQC_RLC_CODE:
+        *out = XQC_RLC_CODE;
+        return XQC_OK;
+    case XQC_REED_SOLOMON_16_CODE:
+        *out = XQC_REED_SOLOMON_16_CODE;
+        return XQC_OK;
     default:
         break;
     }
@@ -228,6 +265,14 @@ xqc_set_fec_schemes(const xqc_fec_schemes_e *schemes, xqc_int_t schemes_len,
             fec_schemes_buff[j] = XQC_RAPTORQ_CODE;
             j++;
             break;
+        case XQC_RLC_CODE:
+            fec_schemes_buff[j] = XQC_RLC_CODE;
+            j++;
+            break;
+        case XQC_REED_SOLOMON_16_CODE:
+            fec_schemes_buff[j] = XQC_REED_SOLOMON_16_CODE;
+            j++;
+            break;
         default:
             break;
         }
@@ -329,12 +374,13 @@ xqc_send_repair_packets(xqc_connection_t *conn, xqc_fec_schemes_e scheme, xqc_li
     fss_esi = conn->fec_ctl->fec_send_block_num[fec_bm_mode];
     tmp_repair_num = 0;
 
-    if (repair_num > XQC_REPAIR_LEN)
+    if (repair_num > xqc_fec_max_repair_num_pblock(scheme))
     {
-        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|repair number exceeds buff size");
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|repair number exceeds the cap of scheme|%d|", repair_num);
         return -XQC_EFEC_SYMBOL_ERROR;
     }
-    if (repair_num > conn->fec_ctl->fec_send_symbol_num[fec_bm_mode])
+    /* sliding window repair symbols are sent along the block, before all source symbols are encoded */
+    if (scheme != XQC_RLC_CODE && repair_num > conn->fec_ctl->fec_send_symbol_num[fec_bm_mode])
     {
         xqc_log(conn->log, XQC_LOG_ERROR, "|source symbols number or repair symbol number invalid|src:%d|rpr:%d|", conn->fec_ctl->fec_send_symbol_num[fec_bm_mode], repair_num);
         return -XQC_EFEC_SYMBOL_ERROR;
@@ -344,6 +390,7 @@ xqc_send_repair_packets(xqc_connection_t *conn, xqc_fec_schemes_e scheme, xqc_li
     switch (scheme)
     {
     case XQC_REED_SOLOMON_CODE:
+    case XQC_REED_SOLOMON_16_CODE:
     case XQC_XOR_CODE:
     case XQC_RAPTORQ_CODE:
         /* Generate repair packets */
@@ -373,6 +420,29 @@ xqc_send_repair_packets(xqc_connection_t *conn, xqc_fec_schemes_e scheme, xqc_li
             }
         }
         break;
+    case XQC_RLC_CODE:
+        for (i = 0; i < repair_num; i++)
+        {
+            /* send the repair symbols generated since last call, then release them */
+            if (!conn->fec_ctl->fec_send_repair_symbols_buff[fec_bm_mode][i].is_valid)
+            {
+                continue;
+            }
+            xqc_packet_out_t *packet_out = xqc_write_one_repair_packet(conn, fss_esi, i, fec_bm_mode);
+            conn->fec_ctl->fec_send_repair_symbols_buff[fec_bm_mode][i].payload_size = XQC_MAX_SYMBOL_SIZE;
+            xqc_init_object_value(&conn->fec_ctl->fec_send_repair_symbols_buff[fec_bm_mode][i]);
+            conn->fec_ctl->fec_send_repair_key[fec_bm_mode][i].payload_size = XQC_MAX_RPR_KEY_SIZE;
+            xqc_init_object_value(&conn->fec_ctl->fec_send_repair_key[fec_bm_mode][i]);
+            if (packet_out == NULL)
+            {
+                xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|generate one repair packet error");
+                continue;
+            }
+
+            xqc_send_queue_move_to_head(&packet_out->po_list, prev);
+            prev = &packet_out->po_list;
+        }
+        break;
     default:
         xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|error type of fec scheme");
         return -XQC_EFEC_SCHEME_ERROR;
@@ -392,11 +462,41 @@ xqc_is_packet_fec_protected(xqc_connection_t *conn, xqc_packet_out_t *packet_out
     return -XQC_EFEC_NOT_SUPPORT_FEC;
 }
 
+xqc_int_t
+xqc_fec_max_symbol_num_pblock(xqc_fec_schemes_e scheme)
+{
+    switch (scheme)
+    {
+    /* codes over GF(2^16) are not bounded by the field of 2^8 elements */
+    case XQC_REED_SOLOMON_16_CODE:
+        return XQC_FEC_RS16_MAX_SYMBOL_NUM_PBLOCK;
+    default:
+        return XQC_FEC_MAX_SYMBOL_NUM_PBLOCK;
+    }
+}
+
+xqc_int_t
+xqc_fec_max_repair_num_pblock(xqc_fec_schemes_e scheme)
+{
+    switch (scheme)
+    {
+    case XQC_XOR_CODE:
+        return 1;
+    /* blocks of codes over GF(2^16) are larger, and so is their share of repair symbols */
+    case XQC_REED_SOLOMON_16_CODE:
+        return XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK;
+    default:
+        return XQC_FEC_MAX_REPAIR_NUM_PBLOCK;
+    }
+}
+
 xqc_int_t
 xqc_check_fec_params(xqc_connection_t *conn, xqc_int_t src_symbol_num, xqc_int_t repair_symbol_num,
                      xqc_int_t max_window_size, xqc_int_t symbol_size)
 {
-    if (repair_symbol_num < 0 || repair_symbol_num > XQC_REPAIR_LEN || repair_symbol_num > src_symbol_num)
+    if (repair_symbol_num < 0
+        || repair_symbol_num > xqc_fec_max_repair_num_pblock(conn->conn_settings.fec_params.fec_encoder_scheme)
+        || repair_symbol_num > src_symbol_num)
     {
         xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|invalid fec repair symbol:%d|src_num:%d|", repair_symbol_num, src_symbol_num);
         return -XQC_EFEC_SCHEME_ERROR;
@@ -406,12 +506,13 @@ xqc_check_fec_params(xqc_connection_t *conn, xqc_int_t src_symbol_num, xqc_int_t
         xqc_log(conn->log, XQC_LOG_WARN, "|quic_fec|xqc_fec_encoder|current code rate is too low to generate repair packets.");
         return -XQC_EFEC_SYMBOL_ERROR;
     }
-    if (src_symbol_num <= 0 || src_symbol_num > XQC_FEC_MAX_SYMBOL_NUM_PBLOCK)
+    if (src_symbol_num <= 0
+        || src_symbol_num > xqc_fec_max_symbol_num_pblock(conn->conn_settings.fec_params.fec_encoder_scheme))
     {
         xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|src_symbol_num invalid|%d|", src_symbol_num);
         return -XQC_EFEC_SYMBOL_ERROR;
     }
-    if (max_window_size <= 0 || max_window_size > XQC_SYMBOL_CACHE_LEN)
+    if (max_window_size <= 0 || max_window_size > XQC_MAX_SYMBOL_CACHE_LEN)
     {
         xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|max_window_size invalid|%d|", max_window_size);
         return -XQC_EFEC_SYMBOL_ERROR;
@@ -471,6 +572,21 @@ xqc_process_fec_protected_packet(xqc_connection_t *conn, xqc_packet_out_t *packe
     }
 
     conn->fec_ctl->fec_send_symbol_num[fec_bm_mode] += 1;
+    if (encoder_scheme == XQC_RLC_CODE)
+    {
+        /* sliding window repair symbols follow the source symbol closing their window step */
+        ret = xqc_send_repair_packets(conn, encoder_scheme, &packet_out->po_list, fec_bm_mode);
+        if (ret != XQC_OK)
+        {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_send_repair_packets error: %d|", ret);
+        }
+        if (conn->fec_ctl->fec_send_symbol_num[fec_bm_mode] == max_src_symbol_num)
+        {
+            xqc_fec_ctl_init_send_params(conn, fec_bm_mode);
+        }
+        return XQC_OK;
+    }
+
     /* Try to generate repair packets, only succeed when send_symbol_numbers satisfy the limits */
     // 3. 当源符号数量达到阈值时，生成修复包
     if (conn->fec_ctl->fec_send_symbol_num[fec_bm_mode] == max_src_symbol_num)
@@ -647,7 +763,8 @@ xqc_fec_ctl_create(xqc_connection_t *conn)
     else
     {
         repair_num = xqc_max(1, conn->conn_settings.fec_params.fec_max_symbol_num_per_block * conn->conn_settings.fec_params.fec_code_rate);
-        fec_ctl->fec_send_required_repair_num[XQC_DEFAULT_SIZE_REQ] = xqc_min(repair_num, XQC_REPAIR_LEN);
+        fec_ctl->fec_send_required_repair_num[XQC_DEFAULT_SIZE_REQ] = xqc_min(repair_num,
+            xqc_fec_max_repair_num_pblock(conn->conn_settings.fec_params.fec_encoder_scheme));
     }
 
     if (conn->conn_settings.enable_multipath)
@@ -656,14 +773,9 @@ xqc_fec_ctl_create(xqc_connection_t *conn)
     }
     fec_ctl->fec_rep_path_id = XQC_MAX_UINT64_VALUE;
 
-    for (i = 0; i < XQC_REPAIR_LEN; i++)
+    if (xqc_fec_ctl_alloc_gen_repair_buff(fec_ctl, XQC_FEC_MAX_REPAIR_NUM_PBLOCK) != XQC_OK)
     {
-        unsigned char *recv_syb_p = xqc_calloc(XQC_MAX_SYMBOL_SIZE, sizeof(unsigned char));
-        if (recv_syb_p == NULL)
-        {
-            goto process_emalloc;
-        }
-        xqc_set_object_value(&fec_ctl->fec_gen_repair_symbols_buff[i], 0, recv_syb_p, 0);
+        goto process_emalloc;
     }
 
     for (i = 0; i < XQC_BLOCK_MODE_LEN; i++)
@@ -673,21 +785,9 @@ xqc_fec_ctl_create(xqc_connection_t *conn)
             continue;
         }
         fec_ctl->fec_send_block_num[i] = i;
-        for (j = 0; j < XQC_REPAIR_LEN; j++)
+        if (xqc_fec_ctl_alloc_send_repair_buff(fec_ctl, i, XQC_FEC_MAX_REPAIR_NUM_PBLOCK) != XQC_OK)
         {
-            unsigned char *key_p = xqc_calloc(XQC_MAX_RPR_KEY_SIZE, sizeof(unsigned char));
-            if (key_p == NULL)
-            {
-                goto process_emalloc;
-            }
-            xqc_set_object_value(&fec_ctl->fec_send_repair_key[i][j], 0, key_p, 0);
-
-            unsigned char *syb_p = xqc_calloc(XQC_MAX_SYMBOL_SIZE, sizeof(unsigned char));
-            if (syb_p == NULL)
-            {
-                goto process_emalloc;
-            }
-            xqc_set_object_value(&fec_ctl->fec_send_repair_symbols_buff[i][j], 0, syb_p, 0);
+            goto process_emalloc;
         }
     }
 
@@ -711,6 +811,71 @@ process_emalloc:
     return NULL;
 }
 
+xqc_int_t
+xqc_fec_ctl_alloc_send_repair_buff(xqc_fec_ctl_t *fec_ctl, uint8_t bm_idx, xqc_int_t repair_num)
+{
+    xqc_int_t j;
+    unsigned char *key_p, *syb_p;
+
+    /* slim block mode never encodes repair symbols */
+    if (bm_idx >= XQC_BLOCK_MODE_LEN || bm_idx == XQC_SLIM_SIZE_REQ || repair_num > XQC_REPAIR_LEN)
+    {
+        return -XQC_EPARAM;
+    }
+
+    for (j = 0; j < repair_num; j++)
+    {
+        if (fec_ctl->fec_send_repair_key[bm_idx][j].payload == NULL)
+        {
+            key_p = xqc_calloc(XQC_MAX_RPR_KEY_SIZE, sizeof(unsigned char));
+            if (key_p == NULL)
+            {
+                return -XQC_EMALLOC;
+            }
+            xqc_set_object_value(&fec_ctl->fec_send_repair_key[bm_idx][j], 0, key_p, 0);
+        }
+
+        if (fec_ctl->fec_send_repair_symbols_buff[bm_idx][j].payload == NULL)
+        {
+            syb_p = xqc_calloc(XQC_MAX_SYMBOL_SIZE, sizeof(unsigned char));
+            if (syb_p == NULL)
+            {
+                return -XQC_EMALLOC;
+            }
+            xqc_set_object_value(&fec_ctl->fec_send_repair_symbols_buff[bm_idx][j], 0, syb_p, 0);
+        }
+    }
+
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_fec_ctl_alloc_gen_repair_buff(xqc_fec_ctl_t *fec_ctl, xqc_int_t repair_num)
+{
+    xqc_int_t i;
+    unsigned char *recv_syb_p;
+
+    if (repair_num > XQC_REPAIR_LEN)
+    {
+        return -XQC_EPARAM;
+    }
+
+    for (i = 0; i < repair_num; i++)
+    {
+        if (fec_ctl->fec_gen_repair_symbols_buff[i].payload == NULL)
+        {
+            recv_syb_p = xqc_calloc(XQC_MAX_SYMBOL_SIZE, sizeof(unsigned char));
+            if (recv_syb_p == NULL)
+            {
+                return -XQC_EMALLOC;
+            }
+            xqc_set_object_value(&fec_ctl->fec_gen_repair_symbols_buff[i], 0, recv_syb_p, 0);
+        }
+    }
+
+    return XQC_OK;
+}
+
 void xqc_fec_ctl_destroy(xqc_fec_ctl_t *fec_ctl)
 {
     xqc_int_t i, j;
@@ -779,6 +944,22 @@ void xqc_fec_ctl_destroy(xqc_fec_ctl_t *fec_ctl)
         xqc_free(symbol);
     }
 
+#ifdef XQC_ENABLE_RLC
+    xqc_rlc_destroy(fec_ctl);
+#endif
+
+    for (i = 0; i < XQC_BLOCK_MODE_LEN; i++)
+    {
+        if (fec_ctl->fec_encoders[i] != NULL)
+        {
+            xqc_fec_encoder_destroy(fec_ctl->fec_encoders[i]);
+        }
+    }
+    if (fec_ctl->fec_decoder != NULL)
+    {
+        xqc_fec_decoder_destroy(fec_ctl->fec_decoder);
+    }
+
     xqc_free(fec_ctl);
 }
 
@@ -800,7 +981,8 @@ xqc_get_fec_blk_size(xqc_connection_t *conn, uint8_t blk_md)
 {
     if (blk_md == XQC_DEFAULT_SIZE_REQ)
     {
-        return xqc_min(XQC_FEC_MAX_SYMBOL_NUM_PBLOCK, xqc_max(0, conn->conn_settings.fec_params.fec_max_symbol_num_per_block));
+        return xqc_min(xqc_fec_max_symbol_num_pblock(conn->conn_settings.fec_params.fec_encoder_scheme),
+                       xqc_max(0, conn->conn_settings.fec_params.fec_max_symbol_num_per_block));
     }
     return conn->fec_ctl->fec_send_block_mode_size[blk_md];
 }
@@ -858,7 +1040,8 @@ xqc_fec_ctl_init_send_params(xqc_connection_t *conn, uint8_t bm_idx)
     if (conn->conn_settings.fec_params.fec_code_rate == 0 && conn->conn_settings.fec_params.fec_encoder_scheme != XQC_XOR_CODE)
     {
         loss_rate = xqc_conn_recent_loss_rate(conn);
-        send_repair_num = xqc_min(XQC_REPAIR_LEN, xqc_max(1, (int)(loss_rate * xqc_get_fec_blk_size(conn, bm_idx) / 100)));
+        send_repair_num = xqc_min(xqc_fec_max_repair_num_pblock(conn->conn_settings.fec_params.fec_encoder_scheme),
+                                  xqc_max(1, (int)(loss_rate * xqc_get_fec_blk_size(conn, bm_idx) / 100)));
         if (conn->fec_ctl->fec_send_required_repair_num[bm_idx] != send_repair_num)
         {
             // edit encode repair key
@@ -1036,6 +1219,15 @@ set_decoder:
             xqc_log(conn->log, XQC_LOG_DEBUG, "|quic_fec|negotiate fec decoder schemes failed.");
             goto end;
         }
+        if (params.fec_max_symbols_num > xqc_fec_max_symbol_num_pblock(decode_scheme))
+        {
+            ls->enable_decode_fec = 0;
+            conn->conn_settings.enable_decode_fec = 0;
+            conn->fec_neg_fail_reason |= XQC_REMOTE_PARAM_ERR;
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|remote max_symbol_number:%ui is too large for decoder scheme: %d",
+                    params.fec_max_symbols_num, decode_scheme);
+            goto end;
+        }
         // set valid encoder scheme
         ret = xqc_set_valid_decoder_scheme_cb(&conn->conn_settings.fec_callback, decode_scheme);
         if (ret != XQC_OK)
@@ -1518,6 +1710,13 @@ xqc_process_src_symbol(xqc_connection_t *conn, uint64_t block_id, uint64_t symbo
         rpr_list = &conn->fec_ctl->fec_recv_rpr_syb_list;
         xqc_update_rpr_symbol_mask_on_src(rpr_list, block_id, symbol_idx);
     }
+#ifdef XQC_ENABLE_RLC
+    // eliminate the source symbol from pending sliding window equations
+    if (conn->conn_settings.fec_params.fec_decoder_scheme == XQC_RLC_CODE)
+    {
+        xqc_rlc_on_src_symbol(conn, block_id, symbol_idx, symbol, symbol_size);
+    }
+#endif
 
     return XQC_OK;
 }
@@ -1577,82 +1776,6 @@ xqc_process_rpr_symbol(xqc_connection_t *conn, xqc_fec_rpr_syb_t *tmp_rpr_symbol
     return XQC_OK;
 }
 
-xqc_int_t
-xqc_get_symbol_flag(xqc_connection_t *conn, uint64_t block_id)
-{
-    xqc_list_head_t *pos, *next;
-    xqc_int_t symbol_flag, max_src_symbol_num;
-
-    symbol_flag = 0;
-    max_src_symbol_num = conn->remote_settings.fec_max_symbols_num;
-
-    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_src_syb_list)
-    {
-        xqc_fec_src_syb_t *src_symbol = xqc_list_entry(pos, xqc_fec_src_syb_t, fec_list);
-        if (src_symbol->block_id > block_id)
-        {
-            break;
-        }
-        if (src_symbol->block_id == block_id)
-        {
-            symbol_flag |= (1 << src_symbol->symbol_idx);
-        }
-    }
-    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_rpr_syb_list)
-    {
-        xqc_fec_rpr_syb_t *rpr_symbol = xqc_list_entry(pos, xqc_fec_rpr_syb_t, fec_list);
-        if (rpr_symbol->block_id > block_id)
-        {
-            break;
-        }
-        if (rpr_symbol->block_id == block_id)
-        {
-            symbol_flag |= (1 << (rpr_symbol->symbol_idx + max_src_symbol_num));
-        }
-    }
-    return symbol_flag;
-}
-
-xqc_int_t
-xqc_get_symbols_buff(unsigned char **output, xqc_fec_ctl_t *fec_ctl, uint64_t block_id, size_t *size)
-{
-    xqc_list_head_t *pos, *next, *fec_recv_src_syb_list, *fec_recv_rpr_syb_list;
-    xqc_int_t i = 0;
-
-    fec_recv_src_syb_list = &fec_ctl->fec_recv_src_syb_list;
-    fec_recv_rpr_syb_list = &fec_ctl->fec_recv_rpr_syb_list;
-    *size = 0;
-
-    // check 一下当前block idx能否成功被flush
-
-    xqc_list_for_each_safe(pos, next, fec_recv_src_syb_list)
-    {
-        xqc_fec_src_syb_t *src_syb = xqc_list_entry(pos, xqc_fec_src_syb_t, fec_list);
-        if (src_syb->block_id == block_id)
-        {
-            xqc_memcpy(output[i++], src_syb->payload, xqc_min(XQC_MAX_SYMBOL_SIZE, src_syb->payload_size));
-        }
-    }
-
-    xqc_list_for_each_safe(pos, next, fec_recv_rpr_syb_list)
-    {
-        xqc_fec_rpr_syb_t *rpr_syb = xqc_list_entry(pos, xqc_fec_rpr_syb_t, fec_list);
-        if (rpr_syb->block_id == block_id)
-        {
-            if (rpr_syb->payload_size > XQC_MAX_SYMBOL_SIZE)
-            {
-                return -XQC_EPARAM;
-            }
-            xqc_memcpy(output[i++], rpr_syb->payload, xqc_min(XQC_MAX_SYMBOL_SIZE, rpr_syb->payload_size));
-            if (rpr_syb->payload_size > *size)
-            {
-                *size = rpr_syb->payload_size;
-            }
-        }
-    }
-    return i;
-}
-
 xqc_int_t
 xqc_cnt_src_symbols_num(xqc_fec_ctl_t *fec_ctl, uint64_t block_id)
 {
@@ -1711,7 +1834,8 @@ void xqc_on_fec_negotiate_success(xqc_connection_t *conn, xqc_transport_params_t
                 }
                 else
                 {
-                    conn->fec_ctl->fec_send_required_repair_num[i] = xqc_min(xqc_max(1, conn->fec_ctl->fec_send_block_mode_size[i] * conn->conn_settings.fec_params.fec_code_rate), XQC_REPAIR_LEN);
+                    conn->fec_ctl->fec_send_required_repair_num[i] = xqc_min(xqc_max(1, conn->fec_ctl->fec_send_block_mode_size[i] * conn->conn_settings.fec_params.fec_code_rate),
+                                                                              xqc_fec_max_repair_num_pblock(conn->conn_settings.fec_params.fec_encoder_scheme));
                 }
             }
         }
@@ -1725,7 +1849,7 @@ void xqc_on_fec_negotiate_success(xqc_connection_t *conn, xqc_transport_params_t
 xqc_int_t
 xqc_get_fec_rpr_num(float fec_code_rate, xqc_int_t src_syb_num)
 {
-    return xqc_min(XQC_REPAIR_LEN, xqc_max(1, xqc_min(src_syb_num, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK) * fec_code_rate + 1));
+    return xqc_min(XQC_FEC_MAX_REPAIR_NUM_PBLOCK, xqc_max(1, xqc_min(src_syb_num, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK) * fec_code_rate + 1));
 }
 
 void xqc_fec_on_stream_size_changed(xqc_stream_t *quic_stream)
@@ -25,10 +25,14 @@
 #define XQC_FEC_MAX_BLOCK_NUM           0x00ffffff
 #define XQC_FEC_MAX_SYMBOL_NUM          0x000000ff
 #define XQC_FEC_MAX_SYMBOL_NUM_PBLOCK   48          /* 2^XQC_FEC_ELE_BIT_SIZE_DEFAULT */
+#define XQC_FEC_RS16_MAX_SYMBOL_NUM_PBLOCK  XQC_FEC_MAX_SYMBOL_NUM  /* bounded by the 8 bit symbol index of sid frame */
 #define XQC_FEC_CODE_RATE_DEFAULT       0.95
-#define XQC_REPAIR_LEN                  10         /* (1-XQC_FEC_CODE_RATE_DEFAULT) * XQC_FEC_MAX_SYMBOL_NUM_PBLOCK */
+#define XQC_FEC_MAX_REPAIR_NUM_PBLOCK   10         /* (1-XQC_FEC_CODE_RATE_DEFAULT) * XQC_FEC_MAX_SYMBOL_NUM_PBLOCK */
+#define XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK  64     /* a quarter of XQC_FEC_RS16_MAX_SYMBOL_NUM_PBLOCK */
+#define XQC_REPAIR_LEN                  XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK  /* repair buffers of the scheme with the largest cap */
 #define XQC_BLOCK_MODE_LEN              5
 #define XQC_SYMBOL_CACHE_LEN            96
+#define XQC_MAX_SYMBOL_CACHE_LEN        (2 * XQC_FEC_RS16_MAX_SYMBOL_NUM_PBLOCK)  /* a block and the next */
 #define XQC_MAX_RPR_KEY_SIZE            10
 #define XQC_MAX_SYMBOL_SIZE             XQC_MAX_PACKET_OUT_SIZE + XQC_ACK_SPACE - XQC_FEC_SPACE
 #define XQC_MAX_PM_SIZE                 288
@@ -107,7 +111,6 @@ typedef struct xqc_fec_ctl_s {
     xqc_fec_object_t             fec_send_repair_key[XQC_BLOCK_MODE_LEN][XQC_REPAIR_LEN];
     xqc_fec_object_t             fec_send_repair_symbols_buff[XQC_BLOCK_MODE_LEN][XQC_REPAIR_LEN];
     uint8_t                      fec_send_decode_matrix[XQC_BLOCK_MODE_LEN][XQC_REPAIR_LEN][XQC_MAX_RPR_KEY_SIZE];
-    unsigned char                decode_matrix[2 * XQC_RSM_COL][XQC_RSM_COL];
 
     // FEC 2.0 params
     xqc_list_head_t              fec_free_src_list;
@@ -118,6 +121,9 @@ typedef struct xqc_fec_ctl_s {
     xqc_int_t                    fec_src_syb_num;
     xqc_int_t                    fec_rpr_syb_num;
     xqc_fec_object_t             fec_gen_repair_symbols_buff[XQC_REPAIR_LEN];
+    struct xqc_rlc_ctx_s        *fec_rlc_ctx;                   /* sliding window code state, created on first use */
+    struct xqc_fec_codec_s      *fec_encoders[XQC_BLOCK_MODE_LEN];  /* block code encoders of the schemes built on xqc_fec_codec */
+    struct xqc_fec_codec_s      *fec_decoder;
 
     xqc_int_t                    fec_enable_stream_num;         /* number of stream that enables fec */
     xqc_msec_t                   conn_avg_recv_delay;         /* fec averaged one way receive delay time */
@@ -149,6 +155,14 @@ xqc_fec_ctl_t *xqc_fec_ctl_create(xqc_connection_t *conn);
 
 void xqc_fec_ctl_destroy(xqc_fec_ctl_t *fec_ctl);
 
+/*
+ * repair buffers past the first XQC_FEC_MAX_REPAIR_NUM_PBLOCK are allocated when a block first
+ * needs them, so that only connections with larger caps pay for them.
+ */
+xqc_int_t xqc_fec_ctl_alloc_send_repair_buff(xqc_fec_ctl_t *fec_ctl, uint8_t bm_idx, xqc_int_t repair_num);
+
+xqc_int_t xqc_fec_ctl_alloc_gen_repair_buff(xqc_fec_ctl_t *fec_ctl, xqc_int_t repair_num);
+
 xqc_int_t xqc_gen_src_payload_id(xqc_fec_ctl_t *fec_ctl, uint64_t *payload_id, uint8_t bm_idx);
 
 xqc_int_t xqc_fec_ctl_save_symbol(unsigned char **symbol_buff, const unsigned char *data,
@@ -177,8 +191,6 @@ xqc_int_t xqc_process_src_symbol(xqc_connection_t *conn, uint64_t block_id, uint
 xqc_int_t xqc_process_rpr_symbol(xqc_connection_t *conn, xqc_fec_rpr_syb_t *tmp_rpr_symbol);
 
 
-xqc_int_t xqc_get_symbols_buff(unsigned char **output, xqc_fec_ctl_t *fec_ctl, uint64_t block_idx, size_t *size);
-
 xqc_fec_rpr_syb_t *xqc_get_rpr_symbol(xqc_list_head_t *head, uint64_t block_id, uint64_t symbol_id);
 
 
@@ -186,8 +198,6 @@ xqc_int_t xqc_cnt_src_symbols_num(xqc_fec_ctl_t *fec_ctl, uint64_t block_id);
 
 xqc_int_t xqc_cnt_rpr_symbols_num(xqc_fec_ctl_t *fec_ctl, uint64_t block_id);
 
-xqc_int_t xqc_get_symbol_flag(xqc_connection_t *conn, uint64_t block_id);
-
 xqc_fec_src_syb_t *xqc_build_src_symbol(xqc_connection_t *conn, uint64_t block_id, uint64_t symbol_idx,
     unsigned char *symbol, xqc_int_t symbol_size);
 
@@ -200,6 +210,12 @@ xqc_int_t xqc_insert_rpr_symbol_by_seq(xqc_connection_t *conn, xqc_list_head_t *
 
 void xqc_remove_rpr_symbol_from_list(xqc_fec_ctl_t *fec_ctl, xqc_fec_rpr_syb_t *rpr_symbol);
 
+/* max number of source symbols in a block coded by the scheme */
+xqc_int_t xqc_fec_max_symbol_num_pblock(xqc_fec_schemes_e scheme);
+
+/* the most repair symbols a block of the scheme may carry */
+xqc_int_t xqc_fec_max_repair_num_pblock(xqc_fec_schemes_e scheme);
+
 xqc_int_t xqc_check_fec_params(xqc_connection_t *conn, xqc_int_t src_symbol_num, xqc_int_t total_symbol_num,
     xqc_int_t max_window_size, xqc_int_t symbol_size);
 
@@ -0,0 +1,311 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+
+#include "src/transport/xqc_fec_codec.h"
+#include "src/common/xqc_malloc.h"
+#include "src/common/xqc_str.h"
+#include "src/common/xqc_config.h"
+#ifdef XQC_ENABLE_XOR
+#include "src/transport/fec_schemes/xqc_xor.h"
+#endif
+#ifdef XQC_ENABLE_RSC
+#include "src/transport/fec_schemes/xqc_reed_solomon.h"
+#endif
+#ifdef XQC_ENABLE_RS16
+#include "src/transport/fec_schemes/xqc_reed_solomon16.h"
+#endif
+#ifdef XQC_ENABLE_FOUNTAIN
+#include "src/transport/fec_schemes/xqc_fountain.h"
+#endif
+
+
+const xqc_fec_codec_ops_t *
+xqc_fec_codec_get_ops(xqc_fec_schemes_e scheme)
+{
+    switch (scheme) {
+#ifdef XQC_ENABLE_XOR
+    case XQC_XOR_CODE:
+        return &xqc_xor_codec_ops;
+#endif
+#ifdef XQC_ENABLE_RSC
+    case XQC_REED_SOLOMON_CODE:
+        return &xqc_reed_solomon_codec_ops;
+#endif
+#ifdef XQC_ENABLE_RS16
+    case XQC_REED_SOLOMON_16_CODE:
+        return &xqc_reed_solomon16_codec_ops;
+#endif
+#ifdef XQC_ENABLE_FOUNTAIN
+    case XQC_RAPTORQ_CODE:
+        return &xqc_fountain_codec_ops;
+#endif
+    default:
+        /* packet mask and sliding window repair symbols are not defined by their index alone */
+        return NULL;
+    }
+}
+
+static void
+xqc_fec_codec_destroy(xqc_fec_codec_t *codec)
+{
+    if (codec == NULL) {
+        return;
+    }
+
+    if (codec->scheme_ctx != NULL) {
+        codec->ops->destroy(codec);
+    }
+    if (codec->src != NULL && codec->src[0] != NULL) {
+        xqc_free(codec->src[0]);
+    }
+    xqc_free(codec->src);
+    xqc_free(codec->src_size);
+    xqc_free(codec->src_valid);
+    xqc_free(codec);
+}
+
+static xqc_fec_codec_t *
+xqc_fec_codec_create(xqc_fec_schemes_e scheme, xqc_int_t K, size_t T, xqc_int_t R,
+    xqc_bool_t is_decoder)
+{
+    xqc_int_t i;
+    unsigned char *data;
+    xqc_fec_codec_t *codec;
+    const xqc_fec_codec_ops_t *ops;
+
+    ops = xqc_fec_codec_get_ops(scheme);
+    if (ops == NULL || K <= 0 || R <= 0 || T == 0) {
+        return NULL;
+    }
+
+    codec = xqc_calloc(1, sizeof(xqc_fec_codec_t));
+    if (codec == NULL) {
+        return NULL;
+    }
+    codec->ops = ops;
+    codec->scheme = scheme;
+    codec->is_decoder = is_decoder;
+    codec->src_num = K;
+    codec->rpr_num = R;
+    codec->max_size = (T + ops->align - 1) / ops->align * ops->align;
+
+    /* all symbols of a block live in one buffer, allocated once for the life of the codec */
+    codec->src = xqc_calloc(K + R, sizeof(unsigned char *));
+    codec->src_size = xqc_calloc(K, sizeof(size_t));
+    codec->src_valid = xqc_calloc(K + R, sizeof(uint8_t));
+    if (codec->src == NULL || codec->src_size == NULL || codec->src_valid == NULL) {
+        goto create_failed;
+    }
+    codec->rpr = codec->src + K;
+    codec->rpr_valid = codec->src_valid + K;
+
+    data = xqc_calloc(K + R, codec->max_size);
+    if (data == NULL) {
+        goto create_failed;
+    }
+    for (i = 0; i < K + R; i++) {
+        codec->src[i] = data + i * codec->max_size;
+    }
+
+    if (ops->create(codec) != XQC_OK) {
+        goto create_failed;
+    }
+    return codec;
+
+create_failed:
+    xqc_fec_codec_destroy(codec);
+    return NULL;
+}
+
+static void
+xqc_fec_codec_reset(xqc_fec_codec_t *codec)
+{
+    codec->size = 0;
+    codec->src_cnt = 0;
+    codec->rpr_cnt = 0;
+    codec->coded = XQC_FALSE;
+    xqc_memset(codec->src_valid, 0, codec->src_num + codec->rpr_num);
+}
+
+static void
+xqc_fec_codec_set_size(xqc_fec_codec_t *codec, size_t size)
+{
+    size = (size + codec->ops->align - 1) / codec->ops->align * codec->ops->align;
+    codec->size = xqc_max(codec->size, size);
+}
+
+/* zero the tails of the symbols added, up to the size of the block */
+static void
+xqc_fec_codec_pad(xqc_fec_codec_t *codec)
+{
+    xqc_int_t i;
+
+    for (i = 0; i < codec->src_num; i++) {
+        if (codec->src_valid[i] && codec->src_size[i] < codec->size) {
+            xqc_memset(codec->src[i] + codec->src_size[i], 0, codec->size - codec->src_size[i]);
+        }
+    }
+}
+
+
+xqc_fec_encoder_t *
+xqc_fec_encoder_create(xqc_fec_schemes_e scheme, xqc_int_t K, size_t T, xqc_int_t R)
+{
+    return xqc_fec_codec_create(scheme, K, T, R, XQC_FALSE);
+}
+
+void
+xqc_fec_encoder_destroy(xqc_fec_encoder_t *enc)
+{
+    xqc_fec_codec_destroy(enc);
+}
+
+void
+xqc_fec_encoder_reset(xqc_fec_encoder_t *enc)
+{
+    xqc_fec_codec_reset(enc);
+}
+
+xqc_int_t
+xqc_fec_encoder_add_source(xqc_fec_encoder_t *enc, const unsigned char *data, size_t size)
+{
+    xqc_int_t idx = enc->src_cnt;
+
+    if (idx >= enc->src_num || size > enc->max_size || enc->coded) {
+        return -XQC_EPARAM;
+    }
+
+    xqc_memcpy(enc->src[idx], data, size);
+    enc->src_size[idx] = size;
+    enc->src_valid[idx] = XQC_FEC_CODEC_RECEIVED;
+    enc->src_cnt++;
+    xqc_fec_codec_set_size(enc, size);
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_fec_encoder_get_repair(xqc_fec_encoder_t *enc, xqc_int_t idx, const unsigned char **data,
+    size_t *size)
+{
+    xqc_int_t ret;
+
+    if (idx < 0 || idx >= enc->rpr_num) {
+        return -XQC_EPARAM;
+    }
+    if (enc->src_cnt < enc->src_num) {
+        return -XQC_EAGAIN;
+    }
+
+    if (!enc->coded) {
+        xqc_fec_codec_pad(enc);
+        ret = enc->ops->encode(enc);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+        enc->coded = XQC_TRUE;
+    }
+
+    *data = enc->rpr[idx];
+    *size = enc->size;
+    return XQC_OK;
+}
+
+
+xqc_fec_decoder_t *
+xqc_fec_decoder_create(xqc_fec_schemes_e scheme, xqc_int_t K, size_t T, xqc_int_t R)
+{
+    return xqc_fec_codec_create(scheme, K, T, R, XQC_TRUE);
+}
+
+void
+xqc_fec_decoder_destroy(xqc_fec_decoder_t *dec)
+{
+    xqc_fec_codec_destroy(dec);
+}
+
+void
+xqc_fec_decoder_reset(xqc_fec_decoder_t *dec)
+{
+    xqc_fec_codec_reset(dec);
+}
+
+xqc_int_t
+xqc_fec_decoder_add_received(xqc_fec_decoder_t *dec, xqc_int_t esi, const unsigned char *data,
+    size_t size)
+{
+    if (esi < 0 || esi >= dec->src_num + dec->rpr_num || size > dec->max_size) {
+        return -XQC_EPARAM;
+    }
+    if (dec->src_valid[esi] || dec->coded) {
+        return XQC_OK;
+    }
+
+    xqc_memcpy(dec->src[esi], data, size);
+    dec->src_valid[esi] = XQC_FEC_CODEC_RECEIVED;
+    if (esi < dec->src_num) {
+        dec->src_size[esi] = size;
+        dec->src_cnt++;
+
+    } else {
+        /* repair symbols are as large as the block, pad a truncated one right away */
+        if (size < dec->max_size) {
+            xqc_memset(dec->src[esi] + size, 0, dec->max_size - size);
+        }
+        dec->rpr_cnt++;
+    }
+    xqc_fec_codec_set_size(dec, size);
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_fec_decoder_try_decode(xqc_fec_decoder_t *dec)
+{
+    xqc_int_t i, ret;
+
+    if (dec->coded || dec->src_cnt == dec->src_num) {
+        return XQC_OK;
+    }
+    if (dec->src_num - dec->src_cnt > dec->rpr_cnt) {
+        return -XQC_EAGAIN;
+    }
+
+    xqc_fec_codec_pad(dec);
+    ret = dec->ops->decode(dec);
+    if (ret != XQC_OK) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    for (i = 0; i < dec->src_num; i++) {
+        if (!dec->src_valid[i]) {
+            dec->src_valid[i] = XQC_FEC_CODEC_RECOVERED;
+            dec->src_size[i] = dec->size;
+        }
+    }
+    dec->src_cnt = dec->src_num;
+    dec->coded = XQC_TRUE;
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_fec_decoder_get_source(xqc_fec_decoder_t *dec, xqc_int_t idx, const unsigned char **data,
+    size_t *size)
+{
+    if (idx < 0 || idx >= dec->src_num) {
+        return -XQC_EPARAM;
+    }
+    if (!dec->src_valid[idx]) {
+        return -XQC_EAGAIN;
+    }
+
+    *data = dec->src[idx];
+    *size = dec->src_size[idx];
+    return XQC_OK;
+}
+
+xqc_bool_t
+xqc_fec_decoder_is_lost(xqc_fec_decoder_t *dec, xqc_int_t idx)
+{
+    return idx >= 0 && idx < dec->src_num && dec->src_valid[idx] != XQC_FEC_CODEC_RECEIVED;
+}
@@ -0,0 +1,119 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+
+#ifndef _XQC_FEC_CODEC_H_INCLUDED_
+#define _XQC_FEC_CODEC_H_INCLUDED_
+
+
+#include <xquic/xquic.h>
+#include <xquic/xqc_errno.h>
+#include <xquic/xquic_typedef.h>
+
+/*
+ * block fec encoders and decoders as standalone objects. an instance codes blocks of K source
+ * symbols and R repair symbols of at most T bytes, owns the buffers of all its symbols and the
+ * state of its scheme, and is reset between blocks without allocating. nothing is shared
+ * between instances, so they work without a connection and from several threads at once.
+ *
+ * symbols of a block are zero padded to the size of the largest one, rounded up to the
+ * alignment of the scheme, which is the size of repair symbols and of recovered symbols.
+ * symbols are identified by their esi, 0 .. K - 1 for source symbols and K .. K + R - 1 for
+ * repair symbols.
+ */
+
+/* values of src_valid and rpr_valid */
+#define XQC_FEC_CODEC_RECEIVED      1
+#define XQC_FEC_CODEC_RECOVERED     2
+
+typedef struct xqc_fec_codec_s xqc_fec_codec_t;
+typedef struct xqc_fec_codec_s xqc_fec_encoder_t;
+typedef struct xqc_fec_codec_s xqc_fec_decoder_t;
+
+typedef struct xqc_fec_codec_ops_s {
+    /* symbol sizes are rounded up to a multiple of it */
+    size_t              align;
+
+    /* check K and R, and create the scheme state of an encoder or a decoder */
+    xqc_int_t         (*create)(xqc_fec_codec_t *codec);
+    void              (*destroy)(xqc_fec_codec_t *codec);
+
+    /* fill all repair symbols from all source symbols */
+    xqc_int_t         (*encode)(xqc_fec_codec_t *codec);
+
+    /* recover lost source symbols in place, called with no more lost than received repairs */
+    xqc_int_t         (*decode)(xqc_fec_codec_t *codec);
+} xqc_fec_codec_ops_t;
+
+struct xqc_fec_codec_s {
+    const xqc_fec_codec_ops_t  *ops;
+    xqc_fec_schemes_e           scheme;
+    xqc_bool_t                  is_decoder;
+
+    xqc_int_t                   src_num;        /* K */
+    xqc_int_t                   rpr_num;        /* R */
+    size_t                      max_size;       /* T, rounded up to align */
+
+    /* current block */
+    size_t                      size;
+    unsigned char             **src;
+    unsigned char             **rpr;
+    size_t                     *src_size;
+    uint8_t                    *src_valid;
+    uint8_t                    *rpr_valid;
+    xqc_int_t                   src_cnt;
+    xqc_int_t                   rpr_cnt;
+    xqc_bool_t                  coded;          /* repair symbols encoded, or source symbols recovered */
+
+    void                       *scheme_ctx;
+};
+
+
+const xqc_fec_codec_ops_t *xqc_fec_codec_get_ops(xqc_fec_schemes_e scheme);
+
+/**
+ * @brief create an encoder of K source symbols and R repair symbols of at most T bytes
+ * @return NULL if the scheme is not built or does not support K and R
+ */
+xqc_fec_encoder_t *xqc_fec_encoder_create(xqc_fec_schemes_e scheme, xqc_int_t K, size_t T, xqc_int_t R);
+void xqc_fec_encoder_destroy(xqc_fec_encoder_t *enc);
+
+/* start a new block */
+void xqc_fec_encoder_reset(xqc_fec_encoder_t *enc);
+
+/* append the next source symbol of the block */
+xqc_int_t xqc_fec_encoder_add_source(xqc_fec_encoder_t *enc, const unsigned char *data, size_t size);
+
+/**
+ * @brief get repair symbol idx of the block, repair symbols are encoded at the first call
+ * after all K source symbols are added. the symbol stays valid until the encoder is reset.
+ * @return -XQC_EAGAIN if source symbols are missing
+ */
+xqc_int_t xqc_fec_encoder_get_repair(xqc_fec_encoder_t *enc, xqc_int_t idx, const unsigned char **data,
+    size_t *size);
+
+
+xqc_fec_decoder_t *xqc_fec_decoder_create(xqc_fec_schemes_e scheme, xqc_int_t K, size_t T, xqc_int_t R);
+void xqc_fec_decoder_destroy(xqc_fec_decoder_t *dec);
+void xqc_fec_decoder_reset(xqc_fec_decoder_t *dec);
+
+/* add a received symbol of the block, duplicates are ignored */
+xqc_int_t xqc_fec_decoder_add_received(xqc_fec_decoder_t *dec, xqc_int_t esi, const unsigned char *data,
+    size_t size);
+
+/**
+ * @brief recover the lost source symbols of the block
+ * @return XQC_OK if all source symbols are available, -XQC_EAGAIN if more symbols are needed,
+ * -XQC_EFEC_SCHEME_ERROR if the symbols received failed to decode
+ */
+xqc_int_t xqc_fec_decoder_try_decode(xqc_fec_decoder_t *dec);
+
+/* get a received or recovered source symbol, -XQC_EAGAIN if it is still lost */
+xqc_int_t xqc_fec_decoder_get_source(xqc_fec_decoder_t *dec, xqc_int_t idx, const unsigned char **data,
+    size_t *size);
+
+/* whether source symbol idx was not received, recovered or not */
+xqc_bool_t xqc_fec_decoder_is_lost(xqc_fec_decoder_t *dec, xqc_int_t idx);
+
+#endif /* _XQC_FEC_CODEC_H_INCLUDED_ */
@@ -7,15 +7,16 @@
 #include "src/transport/xqc_fec_scheme.h"
 #include "src/transport/xqc_fec.h"
 #include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_engine.h"
+#include "src/transport/fec_schemes/xqc_rlc.h"
 
 xqc_int_t
 xqc_fec_encoder_check_params(xqc_connection_t *conn, xqc_int_t repair_symbol_num, xqc_fec_schemes_e encoder_scheme, size_t st_size)
 {
-    if (encoder_scheme == XQC_XOR_CODE) {
-        if (repair_symbol_num > 1) {
-            xqc_log(conn->log, XQC_LOG_WARN, "|quic_fec|xqc_fec_encoder|xor fec scheme can only maintain one repair symbol");
-            return -XQC_EPARAM;
-        }
+    if (repair_symbol_num > xqc_fec_max_repair_num_pblock(encoder_scheme)) {
+        xqc_log(conn->log, XQC_LOG_WARN, "|quic_fec|xqc_fec_encoder|repair symbol number exceeds the cap of scheme|scheme:%d|rpr:%d|max:%d|",
+                encoder_scheme, repair_symbol_num, xqc_fec_max_repair_num_pblock(encoder_scheme));
+        return -XQC_EPARAM;
     }
 
     if (st_size > XQC_MAX_SYMBOL_SIZE) {
@@ -43,6 +44,11 @@ xqc_fec_encoder(xqc_connection_t *conn, unsigned char *input, size_t st_size, ui
     }
 
     if (conn->conn_settings.fec_callback.xqc_fec_encode) {
+        ret = xqc_fec_ctl_alloc_send_repair_buff(conn->fec_ctl, fec_bm_mode, repair_symbol_num);
+        if (ret != XQC_OK) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|fail to malloc memory for fec_send_repair_symbols_buff|ret:%d|", ret);
+            return ret;
+        }
         // encode stream value into fec_send_repair_symbols_buff
         for (i = 0; i < repair_symbol_num; i++) {
             repair_symbols_payload_buff[i] = conn->fec_ctl->fec_send_repair_symbols_buff[fec_bm_mode][i].payload;
@@ -55,11 +61,14 @@ xqc_fec_encoder(xqc_connection_t *conn, unsigned char *input, size_t st_size, ui
         // 对于 XOR：实际调用 xqc_xor_encode
         // 对于 Reed-Solomon：实际调用 xqc_reed_solomon_encode
         // 对于 Packet-Mask：实际调用 xqc_packet_mask_encode
+        xqc_perf_timing_begin(fec_begin);
         ret = conn->conn_settings.fec_callback.xqc_fec_encode(conn, input, st_size, repair_symbols_payload_buff, fec_bm_mode);
+        xqc_perf_timing_end(fec_begin, conn->engine->perf_stats.fec_encode_ticks);
         if (ret != XQC_OK) {
             xqc_log(conn->log, XQC_LOG_WARN, "|quic_fec|xqc_fec_encoder|fec scheme encode_uni error");
             return -XQC_EFEC_SCHEME_ERROR;
         }
+        conn->engine->perf_stats.fec_encodes++;
 
     } else {
         xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_encoder|fec encode_uni callback is NULL");
@@ -69,6 +78,160 @@ xqc_fec_encoder(xqc_connection_t *conn, unsigned char *input, size_t st_size, ui
     return XQC_OK;
 }
 
+/* the encoder of a block mode is kept across blocks of the same size */
+static xqc_fec_encoder_t *
+xqc_fec_get_block_encoder(xqc_connection_t *conn, xqc_fec_schemes_e scheme, uint8_t fec_bm_mode,
+    xqc_int_t src_num, xqc_int_t repair_symbol_num)
+{
+    xqc_fec_encoder_t *enc = conn->fec_ctl->fec_encoders[fec_bm_mode];
+
+    if (enc != NULL && (enc->scheme != scheme || enc->src_num != src_num
+                        || enc->rpr_num != repair_symbol_num))
+    {
+        xqc_fec_encoder_destroy(enc);
+        enc = conn->fec_ctl->fec_encoders[fec_bm_mode] = NULL;
+    }
+    if (enc == NULL) {
+        enc = xqc_fec_encoder_create(scheme, src_num, XQC_MAX_SYMBOL_SIZE, repair_symbol_num);
+        conn->fec_ctl->fec_encoders[fec_bm_mode] = enc;
+    }
+    return enc;
+}
+
+xqc_int_t
+xqc_fec_block_encode(xqc_connection_t *conn, xqc_fec_schemes_e scheme, unsigned char *stream,
+    size_t st_size, unsigned char **outputs, uint8_t fec_bm_mode)
+{
+    size_t               size;
+    xqc_int_t            i, ret, symbol_idx, src_num, repair_symbol_num;
+    xqc_fec_encoder_t   *enc;
+    const unsigned char *repair;
+
+    symbol_idx = conn->fec_ctl->fec_send_symbol_num[fec_bm_mode];
+    src_num = xqc_get_fec_blk_size(conn, fec_bm_mode);
+    repair_symbol_num = conn->fec_ctl->fec_send_required_repair_num[fec_bm_mode];
+    if (repair_symbol_num <= 0 || repair_symbol_num > xqc_fec_max_repair_num_pblock(scheme)
+        || symbol_idx >= src_num) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_encode|invalid params|scheme:%d|idx:%d|rpr:%d|", scheme, symbol_idx, repair_symbol_num);
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    if (symbol_idx == 0) {
+        enc = xqc_fec_get_block_encoder(conn, scheme, fec_bm_mode, src_num, repair_symbol_num);
+        if (enc == NULL) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_encode|create encoder failed|scheme:%d|K:%d|R:%d|", scheme, src_num, repair_symbol_num);
+            return -XQC_EMALLOC;
+        }
+        xqc_fec_encoder_reset(enc);
+    }
+
+    enc = conn->fec_ctl->fec_encoders[fec_bm_mode];
+    if (enc == NULL || enc->scheme != scheme || enc->src_cnt != symbol_idx) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_encode|encoder out of sync|idx:%d|", symbol_idx);
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    ret = xqc_fec_encoder_add_source(enc, stream, st_size);
+    if (ret != XQC_OK) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_encode|invalid symbol|size:%zu|", st_size);
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+    if (symbol_idx + 1 < src_num) {
+        return -XQC_EAGAIN;
+    }
+
+    /* the block is complete, repair symbols are sent with it */
+    for (i = 0; i < repair_symbol_num; i++) {
+        ret = xqc_fec_encoder_get_repair(enc, i, &repair, &size);
+        if (ret != XQC_OK) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_encode|encode failed|ret:%d|", ret);
+            return -XQC_EFEC_SCHEME_ERROR;
+        }
+        xqc_memcpy(outputs[i], repair, size);
+        xqc_set_object_value(&conn->fec_ctl->fec_send_repair_symbols_buff[fec_bm_mode][i], 1, outputs[i], size);
+    }
+
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_fec_block_decode(xqc_connection_t *conn, xqc_fec_schemes_e scheme, xqc_int_t src_num,
+    xqc_int_t repair_symbol_num, xqc_int_t block_idx, unsigned char **outputs, size_t *output_size)
+{
+    size_t               size;
+    xqc_int_t            i, ret;
+    xqc_list_head_t     *pos, *next;
+    xqc_fec_decoder_t   *dec;
+    const unsigned char *data;
+
+    *output_size = 0;
+    if (src_num <= 0 || repair_symbol_num <= 0) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_decode|invalid params|K:%d|R:%d|", src_num, repair_symbol_num);
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    /* the decoder is kept across blocks of the same size */
+    dec = conn->fec_ctl->fec_decoder;
+    if (dec != NULL && (dec->scheme != scheme || dec->src_num != src_num
+                        || dec->rpr_num != repair_symbol_num))
+    {
+        xqc_fec_decoder_destroy(dec);
+        dec = conn->fec_ctl->fec_decoder = NULL;
+    }
+    if (dec == NULL) {
+        dec = xqc_fec_decoder_create(scheme, src_num, XQC_MAX_SYMBOL_SIZE, repair_symbol_num);
+        if (dec == NULL) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_decode|create decoder failed|scheme:%d|K:%d|R:%d|", scheme, src_num, repair_symbol_num);
+            return -XQC_EMALLOC;
+        }
+        conn->fec_ctl->fec_decoder = dec;
+    }
+    xqc_fec_decoder_reset(dec);
+
+    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_src_syb_list) {
+        xqc_fec_src_syb_t *src_symbol = xqc_list_entry(pos, xqc_fec_src_syb_t, fec_list);
+        if (src_symbol->block_id > block_idx) {
+            break;
+        }
+        if (src_symbol->block_id == block_idx && src_symbol->symbol_idx < src_num
+            && xqc_fec_decoder_add_received(dec, src_symbol->symbol_idx, src_symbol->payload,
+                                            src_symbol->payload_size) != XQC_OK)
+        {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_decode|invalid source symbol|size:%zu|", src_symbol->payload_size);
+            return -XQC_EFEC_SCHEME_ERROR;
+        }
+    }
+    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_rpr_syb_list) {
+        xqc_fec_rpr_syb_t *rpr_symbol = xqc_list_entry(pos, xqc_fec_rpr_syb_t, fec_list);
+        if (rpr_symbol->block_id > block_idx) {
+            break;
+        }
+        if (rpr_symbol->block_id == block_idx && rpr_symbol->symbol_idx < repair_symbol_num
+            && xqc_fec_decoder_add_received(dec, src_num + rpr_symbol->symbol_idx, rpr_symbol->payload,
+                                            rpr_symbol->payload_size) != XQC_OK)
+        {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_block_decode|invalid repair symbol|size:%zu|", rpr_symbol->payload_size);
+            return -XQC_EFEC_SCHEME_ERROR;
+        }
+    }
+
+    ret = xqc_fec_decoder_try_decode(dec);
+    if (ret != XQC_OK) {
+        xqc_log(conn->log, XQC_LOG_WARN, "|quic_fec|xqc_fec_block_decode|recover failed|scheme:%d|ret:%d|block:%d|", scheme, ret, block_idx);
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    /* lost source symbols in ascending order of index */
+    for (i = 0, size = 0; i < src_num; i++) {
+        if (xqc_fec_decoder_is_lost(dec, i)) {
+            xqc_fec_decoder_get_source(dec, i, &data, &size);
+            xqc_memcpy(*outputs++, data, size);
+        }
+    }
+    *output_size = size;
+    return XQC_OK;
+}
+
 xqc_int_t
 xqc_process_recovered_packet(xqc_connection_t *conn, unsigned char *recovered_payload, size_t symbol_size, xqc_usec_t rpr_recv_time)
 {
@@ -97,6 +260,7 @@ xqc_process_recovered_packet(xqc_connection_t *conn, unsigned char *recovered_pa
 
     } else {
         conn->fec_ctl->fec_recover_pkt_cnt++;
+        conn->engine->perf_stats.fec_recovered_packets++;
     }
     return res;
 }
@@ -122,12 +286,15 @@ xqc_fec_cc_decoder(xqc_connection_t *conn, xqc_fec_rpr_syb_t *rpr_symbol, uint8_
         goto cc_decoder_end;
     }
 
+    xqc_perf_timing_begin(fec_begin);
     ret = conn->conn_settings.fec_callback.xqc_fec_decode_one(conn, payload_p, block_id, symbol_idx);
+    xqc_perf_timing_end(fec_begin, conn->engine->perf_stats.fec_decode_ticks);
     xqc_set_object_value(&conn->fec_ctl->fec_gen_repair_symbols_buff[0], 1, payload_p, rpr_symbol->payload_size);
     if (ret != XQC_OK) {
         xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_decode_one error");
         goto cc_decoder_end;
     }
+    conn->engine->perf_stats.fec_decodes++;
     ret = xqc_process_recovered_packet(conn, payload_p, rpr_symbol->payload_size, rpr_symbol->recv_time);
     if (ret == XQC_OK) {
         xqc_log(conn->log, XQC_LOG_DEBUG, "|process packet of block %d successfully.", block_id);
@@ -158,6 +325,70 @@ cc_decoder_end:
     return ret;
 }
 
+/**
+ * @brief fec sliding window decoder, folds every buffered repair symbol into the decoding
+ * equations, then processes the source symbols solved so far, whatever block they belong to.
+ *
+ * @param conn
+ * @return xqc_int_t
+ */
+xqc_int_t
+xqc_fec_sw_decoder(xqc_connection_t *conn)
+{
+    size_t              symbol_size;
+    xqc_int_t           ret, res, block_id, symbol_idx;
+    xqc_usec_t          rpr_time;
+    unsigned char      *payload_p;
+    xqc_list_head_t    *pos, *next;
+
+    res = XQC_OK;
+    payload_p = conn->fec_ctl->fec_gen_repair_symbols_buff[0].payload;
+    if (payload_p == NULL) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|fec_gen_repair_symbols_buff is NULL");
+        return -XQC_EMALLOC;
+    }
+    if (conn->conn_settings.fec_callback.xqc_fec_decode_one == NULL) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_decode_one doesn't exists");
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    xqc_list_for_each_safe(pos, next, &conn->fec_ctl->fec_recv_rpr_syb_list) {
+        xqc_fec_rpr_syb_t *rpr_symbol = xqc_list_entry(pos, xqc_fec_rpr_syb_t, fec_list);
+
+        xqc_perf_timing_begin(fec_begin);
+        ret = conn->conn_settings.fec_callback.xqc_fec_decode_one(conn, payload_p, rpr_symbol->block_id,
+                                                                 rpr_symbol->symbol_idx);
+        xqc_perf_timing_end(fec_begin, conn->engine->perf_stats.fec_decode_ticks);
+        if (ret != XQC_OK) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_decode_one error|ret:%d|", ret);
+            res = ret;
+
+        } else {
+            conn->engine->perf_stats.fec_decodes++;
+        }
+        xqc_remove_rpr_symbol_from_list(conn->fec_ctl, rpr_symbol);
+    }
+
+#ifdef XQC_ENABLE_RLC
+    while (xqc_rlc_pop_recovered(conn, payload_p, &symbol_size, &block_id, &symbol_idx, &rpr_time)) {
+        ret = xqc_process_recovered_packet(conn, payload_p, symbol_size, rpr_time);
+        if (ret != XQC_OK) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|process recovered packet error|ret:%d|bid:%d|sid:%d|", ret, block_id, symbol_idx);
+            conn->fec_ctl->fec_recover_failed_cnt++;
+            res = ret;
+            continue;
+        }
+        ret = xqc_process_src_symbol(conn, block_id, symbol_idx, payload_p, symbol_size);
+        if (ret != XQC_OK && ret != -XQC_EFEC_TOLERABLE_ERROR) {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|process source symbol error|ret:%d", ret);
+        }
+    }
+#endif
+
+    xqc_memset(payload_p, 0, XQC_MAX_SYMBOL_SIZE);
+    return res;
+}
+
 /**
  * @brief fec block code decoder;
  * 
@@ -180,6 +411,19 @@ xqc_fec_bc_decoder(xqc_connection_t *conn, xqc_int_t block_id, xqc_int_t loss_sr
         goto bc_decoder_end;
     }
 
+    /* a block can not recover more symbols than it has repair symbols */
+    if (loss_src_num > xqc_fec_max_repair_num_pblock(conn->conn_settings.fec_params.fec_decoder_scheme)) {
+        xqc_log(conn->log, XQC_LOG_WARN, "|quic_fec|too many lost source symbols|block:%d|lost:%d|", block_id, loss_src_num);
+        ret = -XQC_EFEC_SYMBOL_ERROR;
+        goto bc_decoder_end;
+    }
+
+    ret = xqc_fec_ctl_alloc_gen_repair_buff(conn->fec_ctl, loss_src_num);
+    if (ret != XQC_OK) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|fail to malloc memory for fec_gen_repair_symbols_buff|ret:%d|", ret);
+        goto bc_decoder_end;
+    }
+
     for (i = 0; i < loss_src_num; i++) {
         recovered_symbols_buff[i] = conn->fec_ctl->fec_gen_repair_symbols_buff[i].payload;
         if (recovered_symbols_buff[i] == NULL) {
@@ -191,7 +435,9 @@ xqc_fec_bc_decoder(xqc_connection_t *conn, xqc_int_t block_id, xqc_int_t loss_sr
 
     /* generate loss packets payload */
     if (conn->conn_settings.fec_callback.xqc_fec_decode) {
+        xqc_perf_timing_begin(fec_begin);
         ret = conn->conn_settings.fec_callback.xqc_fec_decode(conn, recovered_symbols_buff, &symbol_size, block_id);
+        xqc_perf_timing_end(fec_begin, conn->engine->perf_stats.fec_decode_ticks);
         for (i = 0; i < loss_src_num; i++) {
             xqc_set_object_value(&conn->fec_ctl->fec_gen_repair_symbols_buff[i], 1, recovered_symbols_buff[i],
                                  symbol_size);
@@ -201,6 +447,7 @@ xqc_fec_bc_decoder(xqc_connection_t *conn, xqc_int_t block_id, xqc_int_t loss_sr
             ret = -XQC_EFEC_SCHEME_ERROR;
             goto bc_decoder_end;
         }
+        conn->engine->perf_stats.fec_decodes++;
 
     } else {
         xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|xqc_fec_bc_decoder|fec decode callback is NULL");
@@ -222,7 +469,7 @@ xqc_fec_bc_decoder(xqc_connection_t *conn, xqc_int_t block_id, xqc_int_t loss_sr
 bc_decoder_end:
     conn->fec_ctl->fec_processed_blk_num++;
     /* free recovered symbols buff */
-    for (i = 0; i < loss_src_num; i++) {
+    for (i = 0; i < xqc_min(loss_src_num, XQC_REPAIR_LEN); i++) {
         if (conn->fec_ctl->fec_gen_repair_symbols_buff[i].is_valid) {
             conn->fec_ctl->fec_gen_repair_symbols_buff[i].payload_size = XQC_MAX_SYMBOL_SIZE;
             xqc_init_object_value(&conn->fec_ctl->fec_gen_repair_symbols_buff[i]);
@@ -11,6 +11,7 @@
 #include <xquic/xquic_typedef.h>
 #include <xquic/xqc_errno.h>
 #include "src/transport/xqc_fec.h"
+#include "src/transport/xqc_fec_codec.h"
 #include "src/transport/fec_schemes/xqc_reed_solomon.h"
 
 
@@ -22,10 +23,29 @@ typedef enum {
 
 xqc_int_t xqc_fec_encoder(xqc_connection_t *conn, unsigned char *input, size_t st_size, uint8_t fec_bm_mode);
 
+/**
+ * @brief encode the next source symbol of a block with the block code encoder of fec_bm_mode,
+ * which is kept in fec_ctl across blocks of the same size. repair symbols are encoded into
+ * outputs when the block is complete, and their keys are left to the scheme.
+ * @return XQC_OK if the block is complete, -XQC_EAGAIN if more source symbols are needed
+ */
+xqc_int_t xqc_fec_block_encode(xqc_connection_t *conn, xqc_fec_schemes_e scheme, unsigned char *stream,
+    size_t st_size, unsigned char **outputs, uint8_t fec_bm_mode);
+
+/**
+ * @brief recover the lost source symbols of block block_idx of src_num source symbols, with the
+ * block code decoder kept in fec_ctl. repair symbols with index repair_symbol_num or above are
+ * ignored. recovered symbols are written to outputs in ascending order of index.
+ */
+xqc_int_t xqc_fec_block_decode(xqc_connection_t *conn, xqc_fec_schemes_e scheme, xqc_int_t src_num,
+    xqc_int_t repair_symbol_num, xqc_int_t block_idx, unsigned char **outputs, size_t *output_size);
+
 xqc_int_t xqc_fec_bc_decoder(xqc_connection_t *conn, xqc_int_t block_id, xqc_int_t loss_src_num, xqc_usec_t rpr_time);
 
 xqc_int_t xqc_fec_cc_decoder(xqc_connection_t *conn, xqc_fec_rpr_syb_t *rpr_symbol, uint8_t lack_syb_id);
 
+xqc_int_t xqc_fec_sw_decoder(xqc_connection_t *conn);
+
 xqc_int_t xqc_process_recovered_packet(xqc_connection_t *conn, unsigned char *recovered_payload, size_t symbol_size, xqc_usec_t rpr_recv_time);
 
 xqc_int_t xqc_fec_encoder_check_params(xqc_connection_t *conn, xqc_int_t repair_symbol_num, xqc_fec_schemes_e encoder_scheme, size_t st_size);
@@ -55,6 +55,8 @@ static const char * const frame_type_2_str[XQC_FRAME_NUM] = {
     [XQC_FRAME_Extension]            = "Extension",
     [XQC_FRAME_SID]                  = "FEC_SID",
     [XQC_FRAME_REPAIR_SYMBOL]        = "FEC_REPAIR",
+    [XQC_FRAME_ACK_FREQUENCY]        = "ACK_FREQUENCY",
+    [XQC_FRAME_IMMEDIATE_ACK]        = "IMMEDIATE_ACK",
 };
 
 const char *
@@ -292,6 +294,12 @@ xqc_process_frames(xqc_connection_t *conn, xqc_packet_in_t *packet_in)
         case XQC_TRANS_FRAME_TYPE_ACK_EXT:
             ret = xqc_process_ack_ext_frame(conn, packet_in);
             break;
+        case XQC_TRANS_FRAME_TYPE_ACK_FREQUENCY:
+            ret = xqc_process_ack_frequency_frame(conn, packet_in);
+            break;
+        case XQC_TRANS_FRAME_TYPE_IMMEDIATE_ACK:
+            ret = xqc_process_immediate_ack_frame(conn, packet_in);
+            break;
         case XQC_TRANS_FRAME_TYPE_MP_ACK0:
         case XQC_TRANS_FRAME_TYPE_MP_ACK1:
             if (conn->conn_settings.multipath_version >= XQC_MULTIPATH_10) {
@@ -409,6 +417,11 @@ xqc_process_frames(xqc_connection_t *conn, xqc_packet_in_t *packet_in)
         XQC_CONN_ERR(conn, TRA_PROTOCOL_VIOLATION);
     }
 
+    /* congestion windows move with acks, adjust the ack rate of peer */
+    if (packet_in->pi_frame_types & (XQC_FRAME_BIT_ACK | XQC_FRAME_BIT_ACK_MP)) {
+        xqc_conn_update_ack_frequency(conn, packet_in->pkt_recv_time);
+    }
+
     xqc_path_ctx_t *path = xqc_conn_find_path_by_path_id(conn, packet_in->pi_path_id);
     if (path != NULL 
         && (packet_in->pi_frame_types & XQC_FRAME_BIT_DATAGRAM)) 
@@ -2149,6 +2162,69 @@ xqc_process_max_path_id_frame(xqc_connection_t *conn, xqc_packet_in_t *packet_in
     return ret;
 }
 
+xqc_int_t
+xqc_process_ack_frequency_frame(xqc_connection_t *conn, xqc_packet_in_t *packet_in)
+{
+    xqc_int_t ret;
+    uint64_t seq_num, threshold, max_ack_delay, reordering_threshold;
+
+    ret = xqc_parse_ack_frequency_frame(packet_in, &seq_num, &threshold, &max_ack_delay,
+                                        &reordering_threshold);
+    if (ret != XQC_OK) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|xqc_parse_ack_frequency_frame error|");
+        return ret;
+    }
+
+    /* [ACK-FREQUENCY] only allowed in 0-RTT and 1-RTT packets if min_ack_delay was sent, and not below it */
+    if (conn->local_settings.min_ack_delay == 0
+        || packet_in->pi_pkt.pkt_pns != XQC_PNS_APP_DATA
+        || max_ack_delay < conn->local_settings.min_ack_delay)
+    {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|invalid ACK_FREQUENCY|max_ack_delay:%ui|min_ack_delay:%ui|",
+                max_ack_delay, conn->local_settings.min_ack_delay);
+        XQC_CONN_ERR(conn, TRA_PROTOCOL_VIOLATION);
+        return -XQC_EPROTO;
+    }
+
+    xqc_log_event(conn->log, TRA_FRAMES_PROCESSED, XQC_FRAME_ACK_FREQUENCY, seq_num, threshold,
+                  max_ack_delay, reordering_threshold);
+
+    /* frames might be reordered or retransmitted, only the largest sequence number takes effect */
+    if (conn->ack_freq.recv_on && seq_num <= conn->ack_freq.recv_seq) {
+        xqc_log(conn->log, XQC_LOG_DEBUG, "|stale ACK_FREQUENCY|seq:%ui|recv_seq:%ui|",
+                seq_num, conn->ack_freq.recv_seq);
+        return XQC_OK;
+    }
+
+    conn->ack_freq.recv_on = 1;
+    conn->ack_freq.recv_seq = seq_num;
+    conn->ack_freq.ack_eliciting_threshold = xqc_min(threshold, UINT32_MAX - 1);
+    conn->ack_freq.max_ack_delay = max_ack_delay;
+    conn->ack_freq.reordering_threshold = reordering_threshold;
+
+    xqc_log(conn->log, XQC_LOG_DEBUG, "|seq:%ui|ack_eliciting_threshold:%ui|max_ack_delay:%ui|"
+            "reordering_threshold:%ui|", seq_num, threshold, max_ack_delay, reordering_threshold);
+
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_process_immediate_ack_frame(xqc_connection_t *conn, xqc_packet_in_t *packet_in)
+{
+    if (conn->local_settings.min_ack_delay == 0
+        || packet_in->pi_pkt.pkt_pns != XQC_PNS_APP_DATA)
+    {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|invalid IMMEDIATE_ACK|");
+        XQC_CONN_ERR(conn, TRA_PROTOCOL_VIOLATION);
+        return -XQC_EPROTO;
+    }
+
+    xqc_log_event(conn->log, TRA_FRAMES_PROCESSED, XQC_FRAME_IMMEDIATE_ACK);
+
+    /* the packet is acknowledged immediately when recorded, see xqc_conn_record_single */
+    return xqc_parse_immediate_ack_frame(packet_in);
+}
+
 #ifdef XQC_ENABLE_FEC
 
 uint32_t
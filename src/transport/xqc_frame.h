@@ -49,6 +49,8 @@ typedef enum {
     XQC_FRAME_Extension,
     XQC_FRAME_SID,
     XQC_FRAME_REPAIR_SYMBOL,
+    XQC_FRAME_ACK_FREQUENCY,
+    XQC_FRAME_IMMEDIATE_ACK,
     XQC_FRAME_NUM,
 } xqc_frame_type_t;
 
@@ -86,6 +88,8 @@ typedef enum {
     XQC_FRAME_BIT_Extension             = 1ULL << XQC_FRAME_Extension,
     XQC_FRAME_BIT_SID                   = 1ULL << XQC_FRAME_SID,
     XQC_FRAME_BIT_REPAIR_SYMBOL         = 1ULL << XQC_FRAME_REPAIR_SYMBOL,
+    XQC_FRAME_BIT_ACK_FREQUENCY         = 1ULL << XQC_FRAME_ACK_FREQUENCY,
+    XQC_FRAME_BIT_IMMEDIATE_ACK         = 1ULL << XQC_FRAME_IMMEDIATE_ACK,
     XQC_FRAME_BIT_NUM                   = 1ULL << XQC_FRAME_NUM,
 } xqc_frame_type_bit_t;
 
@@ -115,9 +119,10 @@ typedef enum {
 
 /*
  * PING and PADDING frames contain no information, so lost PING or
- *     PADDING frames do not require repair
+ *     PADDING frames do not require repair. IMMEDIATE_ACK is not
+ *     retransmitted either, as the ack it elicits is stale by then.
  */
-#define XQC_NEED_REPAIR(types) ((types) & ~(XQC_FRAME_BIT_ACK| XQC_FRAME_BIT_PADDING | XQC_FRAME_BIT_PING | XQC_FRAME_BIT_CONNECTION_CLOSE | XQC_FRAME_BIT_DATAGRAM | XQC_FRAME_BIT_SID | XQC_FRAME_BIT_REPAIR_SYMBOL))
+#define XQC_NEED_REPAIR(types) ((types) & ~(XQC_FRAME_BIT_ACK| XQC_FRAME_BIT_PADDING | XQC_FRAME_BIT_PING | XQC_FRAME_BIT_CONNECTION_CLOSE | XQC_FRAME_BIT_DATAGRAM | XQC_FRAME_BIT_SID | XQC_FRAME_BIT_REPAIR_SYMBOL | XQC_FRAME_BIT_IMMEDIATE_ACK))
 
 
 const char *xqc_frame_type_2_str(xqc_engine_t *engine, xqc_frame_type_bit_t type_bit);
@@ -191,4 +196,9 @@ xqc_int_t xqc_process_mp_retire_conn_id_frame(xqc_connection_t *conn, xqc_packet
 
 xqc_int_t xqc_process_max_path_id_frame(xqc_connection_t *conn, xqc_packet_in_t *packet_in);
 
+/* draft-ietf-quic-ack-frequency */
+xqc_int_t xqc_process_ack_frequency_frame(xqc_connection_t *conn, xqc_packet_in_t *packet_in);
+
+xqc_int_t xqc_process_immediate_ack_frame(xqc_connection_t *conn, xqc_packet_in_t *packet_in);
+
 #endif /* _XQC_FRAME_H_INCLUDED_ */
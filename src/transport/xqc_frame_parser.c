@@ -659,6 +659,7 @@ void xqc_try_process_fec_decode(xqc_connection_t *conn, xqc_int_t block_id)
     switch (fec_scheme)
     {
     case XQC_REED_SOLOMON_CODE:
+    case XQC_REED_SOLOMON_16_CODE:
     case XQC_XOR_CODE:
     case XQC_RAPTORQ_CODE:
         if (recv_src_num + recv_rpr_num >= max_src_symbol_num)
@@ -725,6 +726,19 @@ void xqc_try_process_fec_decode(xqc_connection_t *conn, xqc_int_t block_id)
             }
         }
         return;
+    case XQC_RLC_CODE:
+        /*
+         * no block is finished with the sliding window code. repair symbols of a block also
+         * cover the previous block, and the decoder keeps unknown symbols across blocks, so late
+         * symbols of older blocks are still of use and fec_max_fin_blk_id is left unchanged.
+         * symbols kept are bounded by fec_max_window_size as with the other schemes.
+         */
+        ret = xqc_fec_sw_decoder(conn);
+        if (ret != XQC_OK)
+        {
+            xqc_log(conn->log, XQC_LOG_ERROR, "|quic_fec|fec xqc_fec_sw_decoder error|ret:%d|", ret);
+        }
+        return;
     default:
         return;
     }
@@ -1034,6 +1048,69 @@ end_parse_repair:
     return ret;
 }
 #endif
+/*
+ * ECN Counts {
+ *   ECT0 Count (i),
+ *   ECT1 Count (i),
+ *   ECN-CE Count (i),
+ * }
+ */
+static ssize_t
+xqc_gen_ecn_counts(unsigned char *dst_buf, const unsigned char *end, const xqc_ecn_counts_t *ecn_counts)
+{
+    unsigned ect0_bits = xqc_vint_get_2bit(ecn_counts->ect0);
+    unsigned ect1_bits = xqc_vint_get_2bit(ecn_counts->ect1);
+    unsigned ce_bits = xqc_vint_get_2bit(ecn_counts->ce);
+    size_t need = xqc_vint_len(ect0_bits) + xqc_vint_len(ect1_bits) + xqc_vint_len(ce_bits);
+
+    if (dst_buf + need > end)
+    {
+        return -XQC_ENOBUF;
+    }
+
+    xqc_vint_write(dst_buf, ecn_counts->ect0, ect0_bits, xqc_vint_len(ect0_bits));
+    dst_buf += xqc_vint_len(ect0_bits);
+
+    xqc_vint_write(dst_buf, ecn_counts->ect1, ect1_bits, xqc_vint_len(ect1_bits));
+    dst_buf += xqc_vint_len(ect1_bits);
+
+    xqc_vint_write(dst_buf, ecn_counts->ce, ce_bits, xqc_vint_len(ce_bits));
+
+    return need;
+}
+
+static xqc_int_t
+xqc_parse_ecn_counts(unsigned char **pos, const unsigned char *end, xqc_ack_info_t *ack_info)
+{
+    unsigned char *p = *pos;
+    int vlen;
+
+    vlen = xqc_vint_read(p, end, &ack_info->ecn_counts.ect0);
+    if (vlen < 0)
+    {
+        return -XQC_EVINTREAD;
+    }
+    p += vlen;
+
+    vlen = xqc_vint_read(p, end, &ack_info->ecn_counts.ect1);
+    if (vlen < 0)
+    {
+        return -XQC_EVINTREAD;
+    }
+    p += vlen;
+
+    vlen = xqc_vint_read(p, end, &ack_info->ecn_counts.ce);
+    if (vlen < 0)
+    {
+        return -XQC_EVINTREAD;
+    }
+    p += vlen;
+
+    ack_info->has_ecn = 1;
+    *pos = p;
+    return XQC_OK;
+}
+
 /*
  *
     0                   1                   2                   3
@@ -1067,7 +1144,7 @@ end_parse_repair:
 ssize_t
 xqc_gen_ack_frame(xqc_connection_t *conn, xqc_packet_out_t *packet_out, xqc_usec_t now,
                   int ack_delay_exponent, xqc_recv_record_t *recv_record, xqc_usec_t largest_pkt_recv_time,
-                  int *has_gap, xqc_packet_number_t *largest_ack)
+                  int *has_gap, xqc_packet_number_t *largest_ack, const xqc_ecn_counts_t *ecn_counts)
 {
     unsigned char *dst_buf = packet_out->po_buf + packet_out->po_used_size;
     size_t dst_buf_len = xqc_get_po_remained_size_with_ack_spc(packet_out);
@@ -1119,7 +1196,9 @@ xqc_gen_ack_frame(xqc_connection_t *conn, xqc_packet_out_t *packet_out, xqc_usec
         return -XQC_ENOBUF;
     }
 
-    *dst_buf++ = 0x02;
+    /* ACK frame with ECN counts is of type 0x03 */
+    int has_ecn = ecn_counts != NULL && !xqc_ecn_counts_is_zero(ecn_counts);
+    *dst_buf++ = has_ecn ? 0x03 : 0x02;
 
     xqc_vint_write(dst_buf, largest_recv, largest_recv_bits, xqc_vint_len(largest_recv_bits));
     dst_buf += xqc_vint_len(largest_recv_bits);
@@ -1185,6 +1264,16 @@ xqc_gen_ack_frame(xqc_connection_t *conn, xqc_packet_out_t *packet_out, xqc_usec
     }
     xqc_vint_write(p_range_count, range_count, 0, 1);
 
+    if (has_ecn)
+    {
+        ssize_t ecn_len = xqc_gen_ecn_counts(dst_buf, end, ecn_counts);
+        if (ecn_len < 0)
+        {
+            return ecn_len;
+        }
+        dst_buf += ecn_len;
+    }
+
     packet_out->po_frame_types |= XQC_FRAME_BIT_ACK;
     return dst_buf - begin;
 }
@@ -1220,6 +1309,7 @@ xqc_parse_ack_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn, xqc_ack_
      */
     ack_info->path_id = 0;
     ack_info->pns = packet_in->pi_pkt.pkt_pns;
+    ack_info->has_ecn = 0;
 
     vlen = xqc_vint_read(p, end, &largest_acked);
     if (vlen < 0)
@@ -1290,6 +1380,16 @@ xqc_parse_ack_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn, xqc_ack_
         xqc_log(conn->log, XQC_LOG_ERROR, "|ACK range exceed XQC_MAX_ACK_RANGE_CNT|");
     }
 
+    /* ECN counts follow ack ranges in ACK frame of type 0x03 */
+    if (frame_type == 0x03)
+    {
+        xqc_int_t ret = xqc_parse_ecn_counts(&p, end, ack_info);
+        if (ret != XQC_OK)
+        {
+            return ret;
+        }
+    }
+
     ack_info->n_ranges = n_ranges;
     packet_in->pos = p;
     packet_in->pi_frame_types |= XQC_FRAME_BIT_ACK;
@@ -2347,13 +2447,15 @@ ssize_t
 xqc_gen_ack_mp_frame(xqc_connection_t *conn, uint64_t path_id,
                      xqc_packet_out_t *packet_out, xqc_usec_t now, int ack_delay_exponent,
                      xqc_recv_record_t *recv_record, xqc_usec_t largest_pkt_recv_time,
-                     int *has_gap, xqc_packet_number_t *largest_ack)
+                     int *has_gap, xqc_packet_number_t *largest_ack, const xqc_ecn_counts_t *ecn_counts)
 {
     uint64_t frame_type;
+    int has_ecn = ecn_counts != NULL && !xqc_ecn_counts_is_zero(ecn_counts);
 
     if (conn->conn_settings.multipath_version >= XQC_MULTIPATH_10)
     {
-        frame_type = XQC_TRANS_FRAME_TYPE_MP_ACK0;
+        /* MP_ACK frame with ECN counts is of type MP_ACK1 */
+        frame_type = has_ecn ? XQC_TRANS_FRAME_TYPE_MP_ACK1 : XQC_TRANS_FRAME_TYPE_MP_ACK0;
     }
     else
     {
@@ -2493,6 +2595,16 @@ xqc_gen_ack_mp_frame(xqc_connection_t *conn, uint64_t path_id,
     }
     xqc_vint_write(p_range_count, range_count, 0, 1);
 
+    if (has_ecn)
+    {
+        ssize_t ecn_len = xqc_gen_ecn_counts(dst_buf, end, ecn_counts);
+        if (ecn_len < 0)
+        {
+            return ecn_len;
+        }
+        dst_buf += ecn_len;
+    }
+
     packet_out->po_frame_types |= XQC_FRAME_BIT_ACK_MP;
     return dst_buf - begin;
 }
@@ -2529,6 +2641,7 @@ xqc_parse_ack_mp_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn,
 
     ack_info->path_id = *path_id;
     ack_info->pns = packet_in->pi_pkt.pkt_pns;
+    ack_info->has_ecn = 0;
 
     vlen = xqc_vint_read(p, end, &largest_acked);
     if (vlen < 0)
@@ -2598,6 +2711,15 @@ xqc_parse_ack_mp_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn,
         xqc_log(conn->log, XQC_LOG_ERROR, "|ACK range exceed XQC_MAX_ACK_RANGE_CNT|");
     }
 
+    if (frame_type == XQC_TRANS_FRAME_TYPE_MP_ACK1)
+    {
+        xqc_int_t ret = xqc_parse_ecn_counts(&p, end, ack_info);
+        if (ret != XQC_OK)
+        {
+            return ret;
+        }
+    }
+
     ack_info->n_ranges = n_ranges;
     packet_in->pos = p;
     packet_in->pi_frame_types |= XQC_FRAME_BIT_ACK_MP;
@@ -3138,6 +3260,105 @@ xqc_parse_max_path_id_frame(xqc_packet_in_t *packet_in, uint64_t *max_path_id)
     return XQC_OK;
 }
 
+/*
+ * https://datatracker.ietf.org/doc/html/draft-ietf-quic-ack-frequency
+ *
+ * ACK_FREQUENCY Frame {
+ *   Type (i) = 0xaf,
+ *   Sequence Number (i),
+ *   Ack-Eliciting Threshold (i),
+ *   Request Max Ack Delay (i),
+ *   Reordering Threshold (i),
+ * }
+ *
+ *               Figure: ACK_FREQUENCY Frame Format
+ * */
+ssize_t
+xqc_gen_ack_frequency_frame(xqc_packet_out_t *packet_out, uint64_t seq_num,
+    uint64_t ack_eliciting_threshold, uint64_t request_max_ack_delay, uint64_t reordering_threshold)
+{
+    unsigned char *dst_buf = packet_out->po_buf + packet_out->po_used_size;
+    const unsigned char *begin = dst_buf;
+    uint64_t fields[] = {XQC_TRANS_FRAME_TYPE_ACK_FREQUENCY, seq_num, ack_eliciting_threshold,
+                         request_max_ack_delay, reordering_threshold};
+    size_t need = 0;
+    unsigned bits;
+    int i;
+
+    for (i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        need += xqc_vint_len_by_val(fields[i]);
+    }
+
+    if (need > xqc_get_po_remained_size(packet_out)) {
+        return -XQC_ENOBUF;
+    }
+
+    for (i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        bits = xqc_vint_get_2bit(fields[i]);
+        xqc_vint_write(dst_buf, fields[i], bits, xqc_vint_len(bits));
+        dst_buf += xqc_vint_len(bits);
+    }
+
+    packet_out->po_frame_types |= XQC_FRAME_BIT_ACK_FREQUENCY;
+
+    return dst_buf - begin;
+}
+
+xqc_int_t
+xqc_parse_ack_frequency_frame(xqc_packet_in_t *packet_in, uint64_t *seq_num,
+    uint64_t *ack_eliciting_threshold, uint64_t *request_max_ack_delay, uint64_t *reordering_threshold)
+{
+    unsigned char *p = packet_in->pos;
+    const unsigned char *end = packet_in->last;
+    uint64_t frame_type = 0;
+    uint64_t *fields[] = {&frame_type, seq_num, ack_eliciting_threshold,
+                          request_max_ack_delay, reordering_threshold};
+    int i, vlen;
+
+    for (i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        vlen = xqc_vint_read(p, end, fields[i]);
+        if (vlen < 0) {
+            return -XQC_EVINTREAD;
+        }
+        p += vlen;
+    }
+
+    packet_in->pos = p;
+
+    packet_in->pi_frame_types |= XQC_FRAME_BIT_ACK_FREQUENCY;
+
+    return XQC_OK;
+}
+
+/*
+ * IMMEDIATE_ACK Frame {
+ *   Type (i) = 0x1f,
+ * }
+ * */
+ssize_t
+xqc_gen_immediate_ack_frame(xqc_packet_out_t *packet_out)
+{
+    unsigned char *dst_buf = packet_out->po_buf + packet_out->po_used_size;
+
+    if (xqc_get_po_remained_size(packet_out) < 1) {
+        return -XQC_ENOBUF;
+    }
+
+    *dst_buf = XQC_TRANS_FRAME_TYPE_IMMEDIATE_ACK;
+    packet_out->po_frame_types |= XQC_FRAME_BIT_IMMEDIATE_ACK;
+
+    return 1;
+}
+
+xqc_int_t
+xqc_parse_immediate_ack_frame(xqc_packet_in_t *packet_in)
+{
+    ++packet_in->pos;
+    packet_in->pi_frame_types |= XQC_FRAME_BIT_IMMEDIATE_ACK;
+
+    return XQC_OK;
+}
+
 /*
  *
     0                   1                   2                   3
@@ -3167,7 +3388,8 @@ xqc_parse_max_path_id_frame(xqc_packet_in_t *packet_in, uint64_t *max_path_id)
 ssize_t
 xqc_gen_ack_ext_frame(xqc_connection_t *conn, xqc_packet_out_t *packet_out, xqc_usec_t now,
                       int ack_delay_exponent, xqc_recv_record_t *recv_record, xqc_usec_t largest_pkt_recv_time,
-                      int *has_gap, xqc_packet_number_t *largest_ack, xqc_recv_timestamps_info_t *recv_ts_info)
+                      int *has_gap, xqc_packet_number_t *largest_ack, xqc_recv_timestamps_info_t *recv_ts_info,
+                      const xqc_ecn_counts_t *ecn_counts)
 {
     unsigned char *dst_buf = packet_out->po_buf + packet_out->po_used_size;
     size_t dst_buf_len = xqc_get_po_remained_size_with_ack_spc(packet_out);
@@ -3298,22 +3520,34 @@ xqc_gen_ack_ext_frame(xqc_connection_t *conn, xqc_packet_out_t *packet_out, xqc_
      * value indicates which optional fields are included in the ACK. Bit 0
      * indicates whether ECN count fields are included in the frame.
      * Bit 1 indicates whether Receive Timestamps are included in the frame.
-     * XQUIC doesn't send ECN count currently, But Receive Timestamps is enabled
+     * ECN counts are included once any ECN codepoint is received.
      */
-    int64_t ext_ack_features = 2;
+    int has_ecn = ecn_counts != NULL && !xqc_ecn_counts_is_zero(ecn_counts);
+    int64_t ext_ack_features = XQC_ACK_EXT_FEATURE_BIT_RECV_TS
+                               | (has_ecn ? XQC_ACK_EXT_FEATURE_BIT_ENC_COUNT : 0);
     if (dst_buf + 1 > end)
     {
         return -XQC_ENOBUF;
     }
-    /* if write ack ext features fail, set ext_ack_features = 0 */
+    /* if write ack ext features fail, clear XQC_ACK_EXT_FEATURE_BIT_RECV_TS */
     unsigned char *ext_ack_features_pos = dst_buf;
     xqc_vint_write(dst_buf, ext_ack_features, 0, 1);
     dst_buf += 1;
 
+    if (has_ecn)
+    {
+        ssize_t ecn_len = xqc_gen_ecn_counts(dst_buf, end, ecn_counts);
+        if (ecn_len < 0)
+        {
+            return ecn_len;
+        }
+        dst_buf += ecn_len;
+    }
+
     size_t left_buf_len = end - dst_buf;
     if (left_buf_len < ts_range_need)
     {
-        xqc_vint_write(ext_ack_features_pos, 0, 0, 1);
+        xqc_vint_write(ext_ack_features_pos, ext_ack_features & ~XQC_ACK_EXT_FEATURE_BIT_RECV_TS, 0, 1);
         xqc_recv_timestamps_info_set_nobuf_flag(recv_ts_info, 1);
         return dst_buf - begin;
     }
@@ -3574,12 +3808,17 @@ xqc_parse_ack_ext_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn,
     }
     p += vlen;
     packet_in->pos = p;
-    /* parse ENC count */
-    /*
-     * if (ack_ext_feature & XQC_ACK_EXT_FEATURE_BIT_ENC_COUNT) {
-     *     xqc_parse_enc_count_in_ack_ext(packet_in, conn, ack_ts_info, ack_info->largest_acked);
-     * }
-     */
+
+    /* parse ECN counts */
+    if (ack_ext_feature & XQC_ACK_EXT_FEATURE_BIT_ENC_COUNT)
+    {
+        int ecn_parse_ret = xqc_parse_ecn_counts(&p, end, ack_info);
+        if (ecn_parse_ret != XQC_OK)
+        {
+            return ecn_parse_ret;
+        }
+        packet_in->pos = p;
+    }
 
     /* parse timestamps */
     if (ack_ext_feature & XQC_ACK_EXT_FEATURE_BIT_RECV_TS)
@@ -29,6 +29,10 @@
 
 #define XQC_TRANS_FRAME_TYPE_ACK_EXT                    0xB1
 
+/* draft-ietf-quic-ack-frequency */
+#define XQC_TRANS_FRAME_TYPE_ACK_FREQUENCY              0xaf
+#define XQC_TRANS_FRAME_TYPE_IMMEDIATE_ACK              0x1f
+
 /**
  * generate datagram frame
  */
@@ -67,7 +71,8 @@ ssize_t xqc_gen_ping_frame(xqc_packet_out_t *packet_out);
 xqc_int_t xqc_parse_ping_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn);
 
 ssize_t xqc_gen_ack_frame(xqc_connection_t *conn, xqc_packet_out_t *packet_out, xqc_usec_t now, int ack_delay_exponent,
-    xqc_recv_record_t *recv_record, xqc_usec_t largest_pkt_recv_time, int *has_gap, xqc_packet_number_t *largest_ack);
+    xqc_recv_record_t *recv_record, xqc_usec_t largest_pkt_recv_time, int *has_gap, xqc_packet_number_t *largest_ack,
+    const xqc_ecn_counts_t *ecn_counts);
 
 xqc_int_t xqc_parse_ack_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn, xqc_ack_info_t *ack_info);
 
@@ -137,7 +142,8 @@ ssize_t xqc_gen_path_response_frame(xqc_packet_out_t *packet_out, unsigned char
 xqc_int_t xqc_parse_path_response_frame(xqc_packet_in_t *packet_in, unsigned char *data);
 
 ssize_t xqc_gen_ack_mp_frame(xqc_connection_t *conn, uint64_t path_id, xqc_packet_out_t *packet_out, xqc_usec_t now, 
-    int ack_delay_exponent, xqc_recv_record_t *recv_record, xqc_usec_t largest_pkt_recv_time, int *has_gap, xqc_packet_number_t *largest_ack);
+    int ack_delay_exponent, xqc_recv_record_t *recv_record, xqc_usec_t largest_pkt_recv_time, int *has_gap, xqc_packet_number_t *largest_ack,
+    const xqc_ecn_counts_t *ecn_counts);
 
 xqc_int_t xqc_parse_ack_mp_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn,
     uint64_t *path_id, xqc_ack_info_t *ack_info);
@@ -181,6 +187,16 @@ xqc_int_t xqc_parse_mp_retire_conn_id_frame(xqc_packet_in_t *packet_in, uint64_t
 ssize_t xqc_gen_max_path_id_frame(xqc_packet_out_t *packet_out, uint64_t max_path_id);
 xqc_int_t xqc_parse_max_path_id_frame(xqc_packet_in_t *packet_in, uint64_t *max_path_id);
 
+ssize_t xqc_gen_ack_frequency_frame(xqc_packet_out_t *packet_out, uint64_t seq_num,
+    uint64_t ack_eliciting_threshold, uint64_t request_max_ack_delay, uint64_t reordering_threshold);
+
+xqc_int_t xqc_parse_ack_frequency_frame(xqc_packet_in_t *packet_in, uint64_t *seq_num,
+    uint64_t *ack_eliciting_threshold, uint64_t *request_max_ack_delay, uint64_t *reordering_threshold);
+
+ssize_t xqc_gen_immediate_ack_frame(xqc_packet_out_t *packet_out);
+
+xqc_int_t xqc_parse_immediate_ack_frame(xqc_packet_in_t *packet_in);
+
 void xqc_try_process_fec_decode(xqc_connection_t *conn, xqc_int_t block_id);
 
 
@@ -189,7 +205,7 @@ void xqc_get_lack_src_syb(unsigned char* pm, unsigned char* recv_mask, xqc_int_t
 
 ssize_t xqc_gen_ack_ext_frame(xqc_connection_t *conn, xqc_packet_out_t *packet_out, xqc_usec_t now,
     int ack_delay_exponent, xqc_recv_record_t *recv_record, xqc_usec_t largest_pkt_recv_time, int *has_gap, 
-    xqc_packet_number_t *largest_ack, xqc_recv_timestamps_info_t *recv_ts_info);
+    xqc_packet_number_t *largest_ack, xqc_recv_timestamps_info_t *recv_ts_info, const xqc_ecn_counts_t *ecn_counts);
 
 xqc_int_t xqc_parse_ack_ext_frame(xqc_packet_in_t *packet_in, xqc_connection_t *conn,
     xqc_ack_info_t *ack_info, xqc_ack_timestamp_info_t *ack_ts_info);
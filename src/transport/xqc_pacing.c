@@ -26,6 +26,13 @@ xqc_pacing_init(xqc_pacing_t *pacing, int pacing_on, xqc_send_ctl_t *send_ctl)
     if (send_ctl->ctl_cong_callback->xqc_cong_ctl_on_ack_multiple_pkts) {
         pacing->pacing_on = 1;
     }
+
+    pacing->edt_on = send_ctl->ctl_conn->conn_settings.pacing_mode == XQC_PACING_MODE_EDT;
+    pacing->edt_txtime = send_ctl->ctl_conn->transport_cbs.write_socket_txtime != NULL
+                         || send_ctl->ctl_conn->transport_cbs.write_mmsg_txtime != NULL;
+    pacing->edt_horizon = pacing->edt_txtime ? XQC_PACING_EDT_TXTIME_HORIZON_US
+                                             : XQC_PACING_EDT_HORIZON_US;
+    pacing->edt_next_release = 0;
 }
 
 uint64_t
@@ -95,6 +102,11 @@ xqc_pacing_calc_budget(xqc_pacing_t *pacing, xqc_usec_t now)
 void
 xqc_pacing_on_timeout(xqc_pacing_t *pacing)
 {
+    if (pacing->edt_on) {
+        /* release times are kept by edt_next_release, nothing to refill */
+        return;
+    }
+
     xqc_usec_t now = xqc_monotonic_timestamp();
     uint32_t budget = xqc_pacing_calc_budget(pacing, now);
     pacing->bytes_budget = xqc_max(budget, pacing->bytes_budget + pacing->pending_budget);
@@ -163,3 +175,65 @@ int
 xqc_pacing_is_on(xqc_pacing_t *pacing) {
     return pacing->pacing_on;
 }
+
+/* time to send bytes at rate, in nanoseconds */
+static inline uint64_t
+xqc_pacing_edt_interval(uint64_t bytes, uint64_t rate)
+{
+    return rate ? bytes * 1000000000ULL / rate : 0;
+}
+
+int
+xqc_pacing_edt_can_write(xqc_pacing_t *pacing, uint32_t schedule_bytes, xqc_usec_t now,
+    xqc_usec_t *release_time)
+{
+    xqc_send_ctl_t *send_ctl = pacing->ctl_ctx;
+    uint64_t release_ns;
+    xqc_usec_t release, delay;
+
+    if (xqc_timer_is_set(&send_ctl->path_timer_manager, XQC_TIMER_PACING)) {
+        xqc_log(send_ctl->ctl_conn->log, XQC_LOG_DEBUG, "|waiting for pacing timer to expire!|");
+        return FALSE;
+    }
+
+    /* no credit is accumulated while idle */
+    release_ns = xqc_max(pacing->edt_next_release, now * 1000)
+                 + xqc_pacing_edt_interval(schedule_bytes, xqc_pacing_rate_calc(pacing));
+    release = release_ns / 1000;
+
+    if (release > now + pacing->edt_horizon) {
+        /*
+         * with SO_TXTIME, wake up when the packet is half a horizon ahead, and refill the horizon
+         * with one batch. without it, wake up at the release time, and packets released within
+         * the horizon after it are sent together
+         */
+        delay = release - now;
+        if (pacing->edt_txtime) {
+            delay -= pacing->edt_horizon / 2;
+        }
+
+        xqc_timer_update(&send_ctl->path_timer_manager, XQC_TIMER_PACING, now, delay);
+        xqc_log(send_ctl->ctl_conn->log, XQC_LOG_DEBUG, "|EDT pacing timer update|delay:%ui|",
+                delay);
+        return FALSE;
+    }
+
+    *release_time = release;
+    return TRUE;
+}
+
+void
+xqc_pacing_edt_on_packet_sent(xqc_pacing_t *pacing, uint32_t bytes, xqc_usec_t release_time)
+{
+    uint64_t release_ns = release_time * 1000;
+
+    /*
+     * release_time is truncated to microseconds, and is behind edt_next_release for the packets
+     * following the first one in a batch, which keeps the sub-microsecond intervals
+     */
+    if (pacing->edt_next_release < release_ns) {
+        pacing->edt_next_release = release_ns;
+    }
+
+    pacing->edt_next_release += xqc_pacing_edt_interval(bytes, xqc_pacing_rate_calc(pacing));
+}
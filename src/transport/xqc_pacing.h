@@ -7,12 +7,27 @@
 
 #include <xquic/xquic_typedef.h>
 
+/*
+ * in earliest departure time (EDT) mode, packets whose release time is within the horizon are
+ * sent in one batch. without SO_TXTIME they leave the host early by at most the horizon, with
+ * SO_TXTIME the socket layer holds them until the release time, hence a longer horizon is used
+ * to save wakeups.
+ */
+#define XQC_PACING_EDT_HORIZON_US           250
+#define XQC_PACING_EDT_TXTIME_HORIZON_US    2000
+
 typedef struct xqc_pacing_s {
     int             pacing_on;
     uint32_t        bytes_budget;
     xqc_usec_t      last_sent_time;
     xqc_send_ctl_t *ctl_ctx;
     uint32_t        pending_budget;
+
+    /* EDT mode */
+    uint8_t         edt_on;
+    uint8_t         edt_txtime;         /* release times are handed to socket */
+    xqc_usec_t      edt_horizon;
+    uint64_t        edt_next_release;   /* release time of next packet, in nanoseconds */
 } xqc_pacing_t;
 
 int xqc_pacing_is_on(xqc_pacing_t *pacing);
@@ -29,4 +44,26 @@ int xqc_pacing_can_write(xqc_pacing_t *pacing, uint32_t total_bytes);
 
 uint64_t xqc_pacing_rate_calc(xqc_pacing_t *pacing);
 
+static inline int
+xqc_pacing_is_edt(xqc_pacing_t *pacing)
+{
+    return pacing->edt_on;
+}
+
+/**
+ * @brief EDT mode, check whether a packet could be sent now, and stamp it with release time
+ * @param schedule_bytes bytes of packets scheduled before this packet in the same batch
+ * @param release_time output, the release time of packet
+ * @return TRUE if the release time is within the horizon, otherwise FALSE and pacing timer is
+ * set to wake up when it is
+ */
+int xqc_pacing_edt_can_write(xqc_pacing_t *pacing, uint32_t schedule_bytes, xqc_usec_t now,
+    xqc_usec_t *release_time);
+
+/**
+ * @brief EDT mode, advance the release time of next packet after a packet was sent
+ * @param release_time the release time stamped by xqc_pacing_edt_can_write
+ */
+void xqc_pacing_edt_on_packet_sent(xqc_pacing_t *pacing, uint32_t bytes, xqc_usec_t release_time);
+
 #endif /* _XQC_PACING_H_INCLUDED_ */
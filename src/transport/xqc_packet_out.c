@@ -175,6 +175,7 @@ xqc_packet_out_copy(xqc_packet_out_t *dst, xqc_packet_out_t *src)
 
     dst->po_flag &= ~XQC_POF_IN_UNACK_LIST;
     dst->po_flag &= ~XQC_POF_IN_PATH_BUF_LIST;
+    dst->po_flag &= ~XQC_POF_ECN_ECT;
 
     dst->po_pr = src->po_pr;
 
@@ -207,6 +208,7 @@ xqc_packet_out_get(xqc_send_queue_t *send_queue)
         packet_out->po_buf = tmp;
         packet_out->po_buf_size = buf_size;
         packet_out->po_buf_cap = buf_cap;
+        send_queue->sndq_conn->engine->perf_stats.packet_out_reuses++;
         goto return_po;
     }
 
@@ -214,6 +216,7 @@ xqc_packet_out_get(xqc_send_queue_t *send_queue)
     if (!packet_out) {
         return NULL;
     }
+    send_queue->sndq_conn->engine->perf_stats.packet_out_allocs++;
 
 return_po:
     reserved_size = 0;
@@ -408,7 +411,7 @@ xqc_write_ack_to_one_packet(xqc_connection_t *conn, xqc_packet_out_t *packet_out
 
     ret = xqc_gen_ack_frame(conn, packet_out, now, conn->local_settings.ack_delay_exponent,
                             &pn_ctl->ctl_recv_record[pns], path->path_send_ctl->ctl_largest_recv_time[pns],
-                            &has_gap, &largest_ack);
+                            &has_gap, &largest_ack, &pn_ctl->ctl_ecn_recv[pns]);
     if (ret < 0) {
         goto error;
     }
@@ -1583,7 +1586,7 @@ xqc_write_ack_mp_to_one_packet(xqc_connection_t *conn, xqc_path_ctx_t *path,
 	                           conn->local_settings.ack_delay_exponent,
                                &pn_ctl->ctl_recv_record[packet_out->po_pkt.pkt_pns],
 							   path->path_send_ctl->ctl_largest_recv_time[pns],
-                               &has_gap, &largest_ack);
+                               &has_gap, &largest_ack, &pn_ctl->ctl_ecn_recv[pns]);
     if (ret < 0) {
         goto error;
     }
@@ -1874,6 +1877,90 @@ error:
     return -XQC_EWRITE_PKT;
 }
 
+xqc_int_t
+xqc_write_ack_frequency_to_packet(xqc_connection_t *conn, uint64_t seq_num,
+    uint64_t ack_eliciting_threshold, xqc_usec_t request_max_ack_delay, uint64_t reordering_threshold)
+{
+    ssize_t ret;
+    xqc_packet_out_t *packet_out;
+
+    packet_out = xqc_write_new_packet(conn, XQC_PTYPE_SHORT_HEADER);
+    if (packet_out == NULL) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|xqc_write_new_packet error|");
+        return -XQC_EWRITE_PKT;
+    }
+
+    ret = xqc_gen_ack_frequency_frame(packet_out, seq_num, ack_eliciting_threshold,
+                                      request_max_ack_delay, reordering_threshold);
+    if (ret < 0) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|xqc_gen_ack_frequency_frame error|");
+        goto error;
+    }
+
+    packet_out->po_used_size += ret;
+    xqc_send_queue_move_to_high_pri(&packet_out->po_list, conn->conn_send_queue);
+    xqc_log(conn->log, XQC_LOG_DEBUG, "|seq:%ui|ack_eliciting_threshold:%ui|request_max_ack_delay:%ui|"
+            "reordering_threshold:%ui|", seq_num, ack_eliciting_threshold, request_max_ack_delay,
+            reordering_threshold);
+    return XQC_OK;
+
+error:
+    xqc_maybe_recycle_packet_out(packet_out, conn);
+    return -XQC_EWRITE_PKT;
+}
+
+/*
+ * on PTO, IMMEDIATE_ACK is carried by the newest probe of path, which is also the one most likely
+ * to be delivered. it takes a probe of its own only if there is no room left in the others.
+ */
+xqc_int_t
+xqc_write_immediate_ack_to_probe(xqc_connection_t *conn, xqc_path_ctx_t *path)
+{
+    ssize_t ret;
+    xqc_list_head_t *pos;
+    xqc_packet_out_t *packet_out;
+
+    xqc_list_for_each_reverse(pos, &conn->conn_send_queue->sndq_pto_probe_packets) {
+        packet_out = xqc_list_entry(pos, xqc_packet_out_t, po_list);
+        if (packet_out->po_path_id != path->path_id
+            || packet_out->po_pkt.pkt_type != XQC_PTYPE_SHORT_HEADER)
+        {
+            continue;
+        }
+
+        if (packet_out->po_frame_types & XQC_FRAME_BIT_IMMEDIATE_ACK) {
+            return XQC_OK;
+        }
+
+        ret = xqc_gen_immediate_ack_frame(packet_out);
+        if (ret > 0) {
+            packet_out->po_used_size += ret;
+            return XQC_OK;
+        }
+    }
+
+    packet_out = xqc_write_new_packet(conn, XQC_PTYPE_SHORT_HEADER);
+    if (packet_out == NULL) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|xqc_write_new_packet error|");
+        return -XQC_EWRITE_PKT;
+    }
+
+    ret = xqc_gen_immediate_ack_frame(packet_out);
+    if (ret < 0) {
+        xqc_log(conn->log, XQC_LOG_ERROR, "|xqc_gen_immediate_ack_frame error|");
+        xqc_maybe_recycle_packet_out(packet_out, conn);
+        return -XQC_EWRITE_PKT;
+    }
+
+    packet_out->po_used_size += ret;
+    packet_out->po_path_flag |= XQC_PATH_SPECIFIED_BY_PTO;
+    packet_out->po_path_id = path->path_id;
+
+    xqc_send_queue_remove_send(&packet_out->po_list);
+    xqc_send_queue_insert_probe(&packet_out->po_list, &conn->conn_send_queue->sndq_pto_probe_packets);
+    return XQC_OK;
+}
+
 int
 xqc_write_ack_ext_to_one_packet(xqc_connection_t *conn, xqc_packet_out_t *packet_out,
     xqc_pkt_num_space_t pns, xqc_bool_t is_new_pkt)
@@ -1892,7 +1979,7 @@ xqc_write_ack_ext_to_one_packet(xqc_connection_t *conn, xqc_packet_out_t *packet
 
     ret = xqc_gen_ack_ext_frame(conn, packet_out, now, conn->local_settings.ack_delay_exponent,
                             &pn_ctl->ctl_recv_record[pns], path->path_send_ctl->ctl_largest_recv_time[pns],
-                            &has_gap, &largest_ack, path->recv_ts_info);
+                            &has_gap, &largest_ack, path->recv_ts_info, &pn_ctl->ctl_ecn_recv[pns]);
     if (ret < 0) {
         goto error;
     }
@@ -47,6 +47,7 @@ typedef enum {
     XQC_POF_SPURIOUS_LOSS       = 1 << 20,
     XQC_POF_USE_FEC             = 1 << 21,
     XQC_POF_STREAM_NO_LEN       = 1 << 22,  /* for stream without LEN bit, shouldn't attach different frame to it */
+    XQC_POF_ECN_ECT             = 1 << 23,  /* FIXED: reset when copy, sent with ECT codepoint of path */
 } xqc_packet_out_flag_t;
 
 typedef struct xqc_po_stream_frame_s {
@@ -81,6 +82,8 @@ typedef struct xqc_packet_out_s {
     /* Largest Acknowledged in ACK frame, initiated to be 0 */
     xqc_packet_number_t     po_largest_ack;
     xqc_usec_t              po_sent_time;
+    /* release time stamped by EDT pacing, 0 if not paced */
+    xqc_usec_t              po_release_time;
     xqc_frame_type_bit_t    po_frame_types;
 
     /* the stream related to stream frame */
@@ -233,6 +236,11 @@ xqc_int_t xqc_write_mp_retire_conn_id_frame_to_packet(xqc_connection_t *conn, ui
 
 int xqc_write_max_path_id_to_packet(xqc_connection_t *conn, uint64_t max_path_id);
 
+xqc_int_t xqc_write_ack_frequency_to_packet(xqc_connection_t *conn, uint64_t seq_num,
+    uint64_t ack_eliciting_threshold, xqc_usec_t request_max_ack_delay, uint64_t reordering_threshold);
+
+xqc_int_t xqc_write_immediate_ack_to_probe(xqc_connection_t *conn, xqc_path_ctx_t *path);
+
 /**
  * @brief Get remained space size in packet out buff.
  * 
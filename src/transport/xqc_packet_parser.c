@@ -626,10 +626,12 @@ xqc_packet_encrypt_buf(xqc_connection_t *conn, xqc_packet_out_t *packet_out,
                              (uint32_t)path->path_id : 0;
 
     xqc_log(conn->log, XQC_LOG_DEBUG, "|encryption nonce|path_id:%ui|pn:%ui|", nonce_path_id, packet_out->po_pkt.pkt_num);
+    xqc_perf_timing_begin(enc_begin);
     ret = xqc_tls_encrypt_payload(conn->tls, level,
                                   packet_out->po_pkt.pkt_num, nonce_path_id,
                                   dst_header, header_len, payload, payload_len,
                                   dst_payload, enc_pkt_cap - header_len, &enc_payload_len);
+    xqc_perf_timing_end(enc_begin, conn->engine->perf_stats.encrypt_ticks);
     if (ret != XQC_OK) {
         XQC_CONN_ERR(conn, TRA_CRYPTO_ERROR);
         xqc_log(conn->log, XQC_LOG_ERROR, "|packet protection error|pkt_type:%d|pkt_num:%ui",
@@ -680,6 +682,7 @@ xqc_packet_encrypt_buf(xqc_connection_t *conn, xqc_packet_out_t *packet_out,
     }
 
     packet_out->po_enc_size = *enc_pkt_len;
+    conn->engine->perf_stats.packets_encrypted++;
     return XQC_OK;
 }
 
@@ -777,10 +780,12 @@ xqc_packet_decrypt(xqc_connection_t *conn, xqc_packet_in_t *packet_in)
                              (uint32_t)packet_in->pi_path_id : 0;
 
     xqc_log(conn->log, XQC_LOG_DEBUG, "|decryption nonce|path_id:%ui|pn:%ui|", nonce_path_id, packet_in->pi_pkt.pkt_num);
+    xqc_perf_timing_begin(dec_begin);
     ret = xqc_tls_decrypt_payload(conn->tls, level,
                                   packet_in->pi_pkt.pkt_num, nonce_path_id,
                                   header, header_len, payload, payload_len,
                                   dst, dst_cap, &packet_in->decode_payload_len);
+    xqc_perf_timing_end(dec_begin, conn->engine->perf_stats.decrypt_ticks);
     if (ret != XQC_OK) {
         if (!xqc_tls_is_key_update_confirmed(conn->tls)) {
             xqc_log(conn->log, XQC_LOG_WARN, "|xqc_tls_decrypt_payload error when keyupdate|");
@@ -794,6 +799,7 @@ xqc_packet_decrypt(xqc_connection_t *conn, xqc_packet_in_t *packet_in)
 
     packet_in->pos = dst;
     packet_in->last = dst + packet_in->decode_payload_len;
+    conn->engine->perf_stats.packets_decrypted++;
 
     /* update write keys, apply key update */
     if (packet_in->pi_pkt.pkt_type == XQC_PTYPE_SHORT_HEADER && level == XQC_ENC_LEV_1RTT) {
@@ -2,14 +2,13 @@
 #include <openssl/ssl.h>
 #include <xquic/xquic.h>
 #include "src/transport/xqc_engine.h"
+#include "src/transport/xqc_quic_lb.h"
 
 
 #define XQC_MAX_TRUNCATE_LEN 128
-#define XQC_EN_SINGLE_PASS_ENCRYPTION_LEN 16
 
 #define XQC_HALF_CID_CIPHER_LEN 16
 #define XQC_TMP_CIPHER_LEN 16
-#define XQC_FIRST_OCTET 1
 
 /* Each encrypted CID creates and releases a cipher ctx, which may occupies cpu resources a lot. It should be optimaized in the future.*/
 xqc_int_t
@@ -361,4 +360,61 @@ xqc_lb_cid_encryption(uint8_t *cid_buf, size_t enc_len, uint8_t *out_buf, size_t
     xqc_log(log, XQC_LOG_INFO, "|lb cid encrypted|ori:%s|new:%s|", 
                     tmp_cid_buf, tmp_out_buf);
     return XQC_OK;
-}
\ No newline at end of file
+}
+
+void *
+xqc_lb_cid_decryption_ctx_create(const uint8_t *lb_cid_key, size_t lb_cid_key_len)
+{
+    EVP_CIPHER_CTX *cipher_ctx;
+
+    if (lb_cid_key_len != XQC_LB_CID_KEY_LEN) {
+        return NULL;
+    }
+
+    cipher_ctx = EVP_CIPHER_CTX_new();
+    if (!cipher_ctx) {
+        return NULL;
+    }
+
+    if (!EVP_DecryptInit_ex(cipher_ctx, EVP_aes_128_ecb(), NULL, lb_cid_key, NULL)) {
+        EVP_CIPHER_CTX_free(cipher_ctx);
+        return NULL;
+    }
+
+    EVP_CIPHER_CTX_set_padding(cipher_ctx, 0);
+    return cipher_ctx;
+}
+
+void
+xqc_lb_cid_decryption_ctx_destroy(void *dec_ctx)
+{
+    if (dec_ctx) {
+        EVP_CIPHER_CTX_free((EVP_CIPHER_CTX *)dec_ctx);
+    }
+}
+
+xqc_int_t
+xqc_lb_cid_decryption_single_pass(void *dec_ctx, const uint8_t *cid_buf, size_t cid_len,
+    uint8_t *out_buf, size_t out_buf_len)
+{
+    EVP_CIPHER_CTX *cipher_ctx = (EVP_CIPHER_CTX *)dec_ctx;
+    xqc_int_t update_len = 0, final_len = 0;
+
+    if (cipher_ctx == NULL || cid_len != XQC_EN_SINGLE_PASS_ENCRYPTION_LEN + XQC_FIRST_OCTET
+        || out_buf_len < cid_len)
+    {
+        return -XQC_EPARAM;
+    }
+
+    /* keep cipher and key schedule, only reset the state left by last datagram */
+    if (!EVP_DecryptInit_ex(cipher_ctx, NULL, NULL, NULL, NULL)
+        || !EVP_DecryptUpdate(cipher_ctx, out_buf + XQC_FIRST_OCTET, &update_len,
+                              cid_buf + XQC_FIRST_OCTET, XQC_EN_SINGLE_PASS_ENCRYPTION_LEN)
+        || !EVP_DecryptFinal_ex(cipher_ctx, out_buf + XQC_FIRST_OCTET + update_len, &final_len))
+    {
+        return -XQC_EENCRYPT_AES_128_ECB;
+    }
+
+    out_buf[0] = cid_buf[0];
+    return XQC_OK;
+}
@@ -0,0 +1,38 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_QUIC_LB_H_INCLUDED_
+#define _XQC_QUIC_LB_H_INCLUDED_
+
+#include <xquic/xquic_typedef.h>
+
+/* the first octet of load balance cid, which is never encrypted */
+#define XQC_FIRST_OCTET 1
+
+/* encrypted part of this length is encrypted with single-pass aes_128_ecb, others with four-pass */
+#define XQC_EN_SINGLE_PASS_ENCRYPTION_LEN 16
+
+/**
+ * @brief create the cipher context for decrypting single-pass load balance cids with
+ * lb_cid_key. the key schedule is done once here, the context shall be reused for every
+ * datagram, and never be shared between threads.
+ * @return cipher context, NULL for failure
+ */
+void *xqc_lb_cid_decryption_ctx_create(const uint8_t *lb_cid_key, size_t lb_cid_key_len);
+
+void xqc_lb_cid_decryption_ctx_destroy(void *dec_ctx);
+
+/**
+ * @brief decrypt a load balance cid encrypted with single-pass aes_128_ecb, which is the
+ * case when the length of encrypted part is exactly 16 bytes. the first octet is copied
+ * to out_buf unchanged. no log is printed, as this might be called on packet dispatching
+ * path, out of any engine.
+ * @param dec_ctx cipher context created by xqc_lb_cid_decryption_ctx_create
+ * @param cid_len length of the whole cid, including the first octet, MUST be 17
+ * @return XQC_OK for success, others for failure
+ */
+xqc_int_t xqc_lb_cid_decryption_single_pass(void *dec_ctx, const uint8_t *cid_buf,
+    size_t cid_len, uint8_t *out_buf, size_t out_buf_len);
+
+#endif
@@ -244,6 +244,11 @@ xqc_recv_record_largest(xqc_recv_record_t *recv_record)
 uint32_t
 xqc_get_ack_frequency(xqc_connection_t *conn, xqc_path_ctx_t *path)
 {
+    /* the ack rate asked by peer with ACK_FREQUENCY, ack after more than threshold pkts */
+    if (conn->ack_freq.recv_on) {
+        return conn->ack_freq.ack_eliciting_threshold + 1;
+    }
+
     if(xqc_conn_is_handshake_confirmed(conn)
        && conn->conn_settings.adaptive_ack_frequency
        && path->path_send_ctl->ctl_ack_sent_cnt >= 100)
@@ -280,6 +285,11 @@ xqc_maybe_should_ack(xqc_connection_t *conn, xqc_path_ctx_t *path, xqc_pn_ctl_t
 
     xqc_send_ctl_t *send_ctl = path->path_send_ctl;
     uint32_t ack_frequency = xqc_get_ack_frequency(conn, path);
+    xqc_usec_t max_ack_delay = conn->local_settings.max_ack_delay * 1000;
+
+    if (conn->ack_freq.recv_on && pns == XQC_PNS_APP_DATA) {
+        max_ack_delay = conn->ack_freq.max_ack_delay;
+    }
 
     if (send_ctl->ctl_ack_eliciting_pkt[pns] >= ack_frequency
         || (pns <= XQC_PNS_HSK && send_ctl->ctl_ack_eliciting_pkt[pns] >= 1)
@@ -301,13 +311,13 @@ xqc_maybe_should_ack(xqc_connection_t *conn, xqc_path_ctx_t *path, xqc_pn_ctl_t
                && !xqc_timer_is_set(&send_ctl->path_timer_manager, XQC_TIMER_ACK_INIT + pns))
     {
         xqc_timer_set(&send_ctl->path_timer_manager, XQC_TIMER_ACK_INIT + pns,
-                      now, conn->local_settings.max_ack_delay * 1000);
+                      now, max_ack_delay);
 
         xqc_log(conn->log, XQC_LOG_DEBUG,
                 "|path:%ui|set ack timer|ack_eliciting_pkt:%ud|pns:%d|flag:%s|now:%ui|max_ack_delay:%ui|",
                 path->path_id,
                 send_ctl->ctl_ack_eliciting_pkt[pns], pns, xqc_conn_flag_2_str(conn, conn->conn_flag),
-                now, conn->local_settings.max_ack_delay * 1000);
+                now, max_ack_delay);
     }
 }
 
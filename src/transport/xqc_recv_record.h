@@ -31,6 +31,15 @@ typedef struct xqc_recv_record_s {
 
 #define XQC_MAX_ACK_RANGE_CNT 64
 
+/* ECN counts of a packet number space, RFC 9000 Section 19.3.2 */
+typedef struct xqc_ecn_counts_s {
+    uint64_t                ect0;
+    uint64_t                ect1;
+    uint64_t                ce;
+} xqc_ecn_counts_t;
+
+#define xqc_ecn_counts_is_zero(c) ((c)->ect0 == 0 && (c)->ect1 == 0 && (c)->ce == 0)
+
 typedef struct xqc_ack_info_s {
     xqc_pkt_num_space_t     pns;
     uint64_t                path_id;
@@ -38,6 +47,10 @@ typedef struct xqc_ack_info_s {
     xqc_pktno_range_t       ranges[XQC_MAX_ACK_RANGE_CNT];
     xqc_usec_t              ack_delay;
     xqc_packet_number_t     largest_acked;
+
+    /* ECN counts, only valid if has_ecn is set */
+    uint8_t                 has_ecn;
+    xqc_ecn_counts_t        ecn_counts;
 } xqc_ack_info_t;
 
 typedef struct xqc_ack_sent_entry_s {
@@ -64,6 +77,8 @@ xqc_pkt_range_status xqc_recv_record_add(xqc_recv_record_t *recv_record, xqc_pac
 
 xqc_packet_number_t xqc_recv_record_largest(xqc_recv_record_t *recv_record);
 
+uint32_t xqc_get_ack_frequency(xqc_connection_t *conn, xqc_path_ctx_t *path);
+
 void xqc_maybe_should_ack(xqc_connection_t *conn, xqc_path_ctx_t *path, xqc_pn_ctl_t *pn_ctl, xqc_pkt_num_space_t pns, int out_of_order, xqc_usec_t now);
 
 int xqc_ack_sent_record_init(xqc_ack_sent_record_t *record);
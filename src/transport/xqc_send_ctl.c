@@ -174,6 +174,12 @@ xqc_send_ctl_create(xqc_path_ctx_t *path)
 
     xqc_pacing_init(&send_ctl->ctl_pacing, conn->conn_settings.pacing_on, send_ctl);
 
+    /* packets could be marked only if the socket layer is able to set ECN codepoint */
+    if (conn->conn_settings.ecn_on && conn->transport_cbs.write_socket_ecn) {
+        send_ctl->ctl_ecn_state = XQC_ECN_STATE_TESTING;
+    }
+    send_ctl->ctl_ecn_codepoint = conn->conn_settings.ecn_l4s ? XQC_ECN_ECT1 : XQC_ECN_ECT0;
+
     send_ctl->ctl_info.record_interval = XQC_DEFAULT_RECORD_INTERVAL;
     send_ctl->ctl_info.last_record_time = 0;
     send_ctl->ctl_info.last_rtt_time = 0;
@@ -466,13 +472,21 @@ xqc_send_packet_pacer_allows(xqc_send_ctl_t *send_ctl,
     xqc_packet_out_t *packet_out, uint32_t schedule_bytes, xqc_usec_t now)
 {
     xqc_connection_t *conn = send_ctl->ctl_conn;
+    int can_write;
 
     if (XQC_CAN_IN_FLIGHT(packet_out->po_frame_types)) {
 
         if (xqc_pacing_is_on(&send_ctl->ctl_pacing)) {
-            if (!xqc_pacing_can_write(&send_ctl->ctl_pacing, 
-                    schedule_bytes + packet_out->po_used_size)) 
-            {
+            if (xqc_pacing_is_edt(&send_ctl->ctl_pacing)) {
+                can_write = xqc_pacing_edt_can_write(&send_ctl->ctl_pacing, schedule_bytes, now,
+                                                     &packet_out->po_release_time);
+
+            } else {
+                can_write = xqc_pacing_can_write(&send_ctl->ctl_pacing,
+                                                 schedule_bytes + packet_out->po_used_size);
+            }
+
+            if (!can_write) {
                 xqc_log(conn->log, XQC_LOG_DEBUG, "|pacing blocked|");
                 if (packet_out->po_send_pacing_blk_ts == 0) {
                     packet_out->po_send_pacing_blk_ts = now;
@@ -809,11 +823,8 @@ xqc_send_ctl_detect_optimistic_ack_attack(xqc_send_ctl_t *send_ctl,
 }
 
 
-/**
- * OnAckReceived
- */
-int
-xqc_send_ctl_on_ack_received(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl, xqc_send_queue_t *send_queue, xqc_ack_info_t *const ack_info, xqc_usec_t ack_recv_time, xqc_bool_t ack_on_same_path)
+static int
+xqc_send_ctl_process_ack(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl, xqc_send_queue_t *send_queue, xqc_ack_info_t *const ack_info, xqc_usec_t ack_recv_time, xqc_bool_t ack_on_same_path)
 {
     xqc_connection_t *conn = send_ctl->ctl_conn;
 
@@ -830,6 +841,7 @@ xqc_send_ctl_on_ack_received(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl, xqc
     xqc_usec_t spurious_loss_sent_time = 0;
     unsigned char need_del_record = 0;
     int stream_frame_acked = 0;
+    uint64_t newly_acked_ect = 0;
 
     if (xqc_send_ctl_detect_optimistic_ack_attack(send_ctl, pn_ctl, ack_info, ack_recv_time) < 0) {
         XQC_CONN_ERR(conn, TRA_PROTOCOL_VIOLATION);
@@ -949,6 +961,10 @@ xqc_send_ctl_on_ack_received(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl, xqc
             if (XQC_IS_ACK_ELICITING(packet_out->po_frame_types)) {
                 has_ack_eliciting = 1;
             }
+
+            if (packet_out->po_flag & XQC_POF_ECN_ECT) {
+                newly_acked_ect++;
+            }
         }
     }
 
@@ -970,7 +986,11 @@ xqc_send_ctl_on_ack_received(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl, xqc
 
     }
 
-    /* TODO: ECN */
+    /* ECN validation only processes ACK frames that increase the largest acknowledged */
+    if (update_largest_ack) {
+        xqc_send_ctl_on_ecn_counts(send_ctl, pn_ctl, ack_info, newly_acked_ect,
+                                   send_ctl->ctl_largest_acked_sent_time[pns]);
+    }
 
     /* spurious loss */
     if (spurious_loss_detected) {
@@ -1092,6 +1112,24 @@ xqc_send_ctl_on_ack_received(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl, xqc
     return XQC_OK;
 }
 
+/**
+ * OnAckReceived
+ */
+int
+xqc_send_ctl_on_ack_received(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl, xqc_send_queue_t *send_queue, xqc_ack_info_t *const ack_info, xqc_usec_t ack_recv_time, xqc_bool_t ack_on_same_path)
+{
+    int ret;
+    xqc_engine_t *engine = send_ctl->ctl_conn->engine;
+
+    xqc_perf_timing_begin(ack_begin);
+    ret = xqc_send_ctl_process_ack(send_ctl, pn_ctl, send_queue, ack_info, ack_recv_time,
+                                   ack_on_same_path);
+    xqc_perf_timing_end(ack_begin, engine->perf_stats.ack_process_ticks);
+
+    engine->perf_stats.acks_processed++;
+    return ret;
+}
+
 /**
  * OnDatagramReceived
  */
@@ -1339,6 +1377,16 @@ xqc_send_ctl_detect_lost(xqc_send_ctl_t *send_ctl, xqc_send_queue_t *send_queue,
                 conn->detected_loss_cnt++;
                 lost_n++;
 
+                if ((po->po_flag & XQC_POF_ECN_ECT)
+                    && send_ctl->ctl_ecn_state == XQC_ECN_STATE_UNKNOWN
+                    && ++send_ctl->ctl_ecn_testing_lost >= send_ctl->ctl_ecn_testing_cnt)
+                {
+                    /* all packets marked in testing are lost, ECT packets might be dropped */
+                    send_ctl->ctl_ecn_state = XQC_ECN_STATE_FAILED;
+                    xqc_log(conn->log, XQC_LOG_INFO, "|ecn validation failed|path:%ui|reason:lost|",
+                            send_ctl->ctl_path->path_id);
+                }
+
                 xqc_log(conn->log, XQC_LOG_DEBUG, "|mark lost|pns:%d|pkt_num:%ui|"
                         "lost_pn:%ui|po_sent_time:%ui|lost_send_time:%ui|loss_delay:%ui|frame:%s|repair:%d|",
                         pns, po->po_pkt.pkt_num, lost_pn, po->po_sent_time, lost_send_time, loss_delay,
@@ -1457,6 +1505,118 @@ xqc_send_ctl_congestion_event(xqc_send_ctl_t *send_ctl, xqc_usec_t sent_time)
 }
 
 
+
+uint8_t
+xqc_send_ctl_ecn_codepoint(xqc_send_ctl_t *send_ctl, xqc_packet_out_t *packet_out)
+{
+    packet_out->po_flag &= ~XQC_POF_ECN_ECT;
+
+    switch (send_ctl->ctl_ecn_state) {
+    case XQC_ECN_STATE_TESTING:
+        if (++send_ctl->ctl_ecn_testing_cnt >= XQC_ECN_TESTING_PKTS) {
+            send_ctl->ctl_ecn_state = XQC_ECN_STATE_UNKNOWN;
+        }
+        break;
+    case XQC_ECN_STATE_CAPABLE:
+        break;
+    default:
+        return XQC_ECN_NOT_ECT;
+    }
+
+    packet_out->po_flag |= XQC_POF_ECN_ECT;
+    return send_ctl->ctl_ecn_codepoint;
+}
+
+
+static void
+xqc_send_ctl_ecn_validation_failed(xqc_send_ctl_t *send_ctl, const char *reason)
+{
+    send_ctl->ctl_ecn_state = XQC_ECN_STATE_FAILED;
+    xqc_log(send_ctl->ctl_conn->log, XQC_LOG_INFO, "|ecn validation failed|path:%ui|reason:%s|",
+            send_ctl->ctl_path->path_id, reason);
+}
+
+/**
+ * ECN validation, RFC 9000 Section 13.4.2
+ */
+void
+xqc_send_ctl_on_ecn_counts(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl,
+    xqc_ack_info_t *const ack_info, uint64_t newly_acked_ect, xqc_usec_t largest_acked_sent_time)
+{
+    xqc_ecn_counts_t *prev = &pn_ctl->ctl_ecn_acked[ack_info->pns];
+    xqc_ecn_counts_t *cur = &ack_info->ecn_counts;
+    uint64_t cur_ect, prev_ect, cur_other, prev_other, ect_delta, ce_delta;
+
+    if (send_ctl->ctl_ecn_state == XQC_ECN_STATE_DISABLED
+        || send_ctl->ctl_ecn_state == XQC_ECN_STATE_FAILED)
+    {
+        return;
+    }
+
+    if (!ack_info->has_ecn) {
+        /* peer or network erases ECN codepoints of the newly acknowledged packets */
+        if (newly_acked_ect > 0) {
+            xqc_send_ctl_ecn_validation_failed(send_ctl, "no_counts");
+        }
+        return;
+    }
+
+    if (send_ctl->ctl_ecn_codepoint == XQC_ECN_ECT1) {
+        cur_ect = cur->ect1;
+        prev_ect = prev->ect1;
+        cur_other = cur->ect0;
+        prev_other = prev->ect0;
+
+    } else {
+        cur_ect = cur->ect0;
+        prev_ect = prev->ect0;
+        cur_other = cur->ect1;
+        prev_other = prev->ect1;
+    }
+
+    /* counts are cumulative, and only one ECT codepoint is used to mark packets */
+    if (cur_ect < prev_ect || cur->ce < prev->ce || cur_other > prev_other) {
+        xqc_send_ctl_ecn_validation_failed(send_ctl, "invalid_counts");
+        return;
+    }
+
+    ect_delta = cur_ect - prev_ect;
+    ce_delta = cur->ce - prev->ce;
+    *prev = *cur;
+
+    /* the codepoint of some ECT packets is bleached or remarked to the other ECT codepoint */
+    if (ect_delta + ce_delta < newly_acked_ect) {
+        xqc_send_ctl_ecn_validation_failed(send_ctl, "counts_too_small");
+        return;
+    }
+
+    if (newly_acked_ect > 0 && send_ctl->ctl_ecn_state != XQC_ECN_STATE_CAPABLE) {
+        send_ctl->ctl_ecn_state = XQC_ECN_STATE_CAPABLE;
+        xqc_log(send_ctl->ctl_conn->log, XQC_LOG_INFO, "|ecn capable|path:%ui|",
+                send_ctl->ctl_path->path_id);
+    }
+
+    if (ce_delta == 0) {
+        return;
+    }
+
+    send_ctl->ctl_ecn_ce_cnt += ce_delta;
+    xqc_log(send_ctl->ctl_conn->log, XQC_LOG_DEBUG, "|ecn ce|path:%ui|pns:%d|ce_delta:%ui|"
+            "ect_delta:%ui|ce:%ui|", send_ctl->ctl_path->path_id, ack_info->pns, ce_delta,
+            ect_delta, cur->ce);
+
+    /* a CE mark is a congestion signal as a loss, the largest acked packet starts the epoch */
+    if (send_ctl->ctl_cong_callback->xqc_cong_ctl_on_ecn_ce) {
+        send_ctl->ctl_cong_callback->xqc_cong_ctl_on_ecn_ce(send_ctl->ctl_cong,
+                                                            largest_acked_sent_time,
+                                                            ce_delta, ect_delta + ce_delta);
+
+    } else {
+        xqc_send_ctl_congestion_event(send_ctl, largest_acked_sent_time);
+    }
+}
+
+
 /**
  * IsAppLimited
  */
@@ -47,6 +47,18 @@ typedef struct {
     uint64_t    last_send_count;      /* number of packets sent in the last record */
 }xqc_send_ctl_info_t;
 
+/* number of packets marked with ECT before ECN counts of peer are validated */
+#define XQC_ECN_TESTING_PKTS                10
+
+/* ECN validation state of a path, RFC 9000 Appendix A.4 */
+typedef enum {
+    XQC_ECN_STATE_DISABLED = 0,     /* ECN is not enabled */
+    XQC_ECN_STATE_TESTING,          /* marking the first XQC_ECN_TESTING_PKTS packets */
+    XQC_ECN_STATE_UNKNOWN,          /* stop marking and wait for validation of the testing packets */
+    XQC_ECN_STATE_CAPABLE,          /* ECN counts validated, all packets are marked */
+    XQC_ECN_STATE_FAILED,           /* validation failed, packets are not marked anymore */
+} xqc_ecn_state_t;
+
 typedef struct xqc_pn_ctl_s {
 
     xqc_packet_number_t         ctl_packet_number[XQC_PNS_N];
@@ -65,6 +77,12 @@ typedef struct xqc_pn_ctl_s {
     /* record ack sent */
     xqc_ack_sent_record_t       ack_sent_record[XQC_PNS_N];
 
+    /* ECN codepoints of received packets, reported to peer in ACK frames */
+    xqc_ecn_counts_t            ctl_ecn_recv[XQC_PNS_N];
+
+    /* largest ECN counts reported by peer */
+    xqc_ecn_counts_t            ctl_ecn_acked[XQC_PNS_N];
+
 
     /* fields are used for detecting optimistic ack attacks */
     /* we skip pn in [ctl_skipped_pn_low, ctl_skipped_pn_high] */
@@ -172,6 +190,13 @@ typedef struct xqc_send_ctl_s {
 
     uint64_t                    ctl_ack_sent_cnt;
 
+    /* ECN validation */
+    xqc_ecn_state_t             ctl_ecn_state;
+    uint8_t                     ctl_ecn_codepoint;      /* ECT(0), or ECT(1) for L4S */
+    uint32_t                    ctl_ecn_testing_cnt;    /* packets marked in testing state */
+    uint32_t                    ctl_ecn_testing_lost;   /* marked packets lost before validation */
+    uint64_t                    ctl_ecn_ce_cnt;         /* CE marks reported by peer */
+
 } xqc_send_ctl_t;
 
 
@@ -236,6 +261,19 @@ xqc_bool_t xqc_send_ctl_in_persistent_congestion(xqc_send_ctl_t *send_ctl, xqc_p
 
 void xqc_send_ctl_congestion_event(xqc_send_ctl_t *send_ctl, xqc_usec_t sent_time);
 
+/**
+ * ECN codepoint of a packet to be sent, marks the packet with XQC_POF_ECN_ECT if it is ECT
+ */
+uint8_t xqc_send_ctl_ecn_codepoint(xqc_send_ctl_t *send_ctl, xqc_packet_out_t *packet_out);
+
+/**
+ * validate ECN counts of an ACK frame which increases the largest acknowledged packet, and
+ * react to CE marks
+ * @param newly_acked_ect number of newly acknowledged packets sent with ECT
+ */
+void xqc_send_ctl_on_ecn_counts(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl,
+    xqc_ack_info_t *const ack_info, uint64_t newly_acked_ect, xqc_usec_t largest_acked_sent_time);
+
 int xqc_send_ctl_in_recovery(xqc_send_ctl_t *send_ctl, xqc_usec_t sent_time);
 
 int xqc_send_ctl_is_app_limited(xqc_send_ctl_t *send_ctl);
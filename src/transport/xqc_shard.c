@@ -0,0 +1,323 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <xquic/xquic.h>
+#include "src/transport/xqc_shard.h"
+#include "src/transport/xqc_engine.h"
+#include "src/transport/xqc_packet.h"
+#include "src/transport/xqc_quic_lb.h"
+#include "src/common/xqc_random.h"
+#include "src/common/xqc_hash.h"
+#include "src/common/xqc_malloc.h"
+
+
+xqc_shard_dispatcher_t *
+xqc_shard_dispatcher_create(const xqc_shard_config_t *config)
+{
+    xqc_shard_dispatcher_t *dispatcher;
+    size_t capacity;
+    uint8_t sid_len;
+
+    if (config == NULL || config->shard_count == 0
+        || config->shard_count > XQC_SHARD_MAX_COUNT)
+    {
+        return NULL;
+    }
+
+    sid_len = config->shard_count > XQC_SHARD_ONE_BYTE_ID_COUNT ? 2 : 1;
+
+    /* cid must hold the first octet and shard id */
+    if (config->cid_len < XQC_FIRST_OCTET + sid_len || config->cid_len > XQC_MAX_CID_LEN) {
+        return NULL;
+    }
+
+    /* only single-pass encrypted cid could be decrypted */
+    if (config->lb_cid_enc_on
+        && config->cid_len != XQC_FIRST_OCTET + XQC_EN_SINGLE_PASS_ENCRYPTION_LEN)
+    {
+        return NULL;
+    }
+
+    dispatcher = xqc_calloc(1, sizeof(xqc_shard_dispatcher_t));
+    if (dispatcher == NULL) {
+        return NULL;
+    }
+
+    dispatcher->config = *config;
+    dispatcher->sid_len = sid_len;
+
+    if (config->lb_cid_enc_on) {
+        dispatcher->lb_cid_dec_ctx = xqc_lb_cid_decryption_ctx_create(config->lb_cid_key,
+                                                                      XQC_LB_CID_KEY_LEN);
+        if (dispatcher->lb_cid_dec_ctx == NULL) {
+            goto error;
+        }
+    }
+
+    dispatcher->shards = xqc_calloc(config->shard_count, sizeof(xqc_shard_t));
+    if (dispatcher->shards == NULL) {
+        goto error;
+    }
+
+    capacity = config->queue_capacity ? config->queue_capacity : XQC_SHARD_DEFAULT_QUEUE_CAPACITY;
+    for (uint32_t i = 0; i < config->shard_count; i++) {
+        dispatcher->shards[i].queue = xqc_spsc_queue_create(capacity, sizeof(xqc_shard_packet_t));
+        if (dispatcher->shards[i].queue == NULL) {
+            goto error;
+        }
+    }
+
+    return dispatcher;
+
+error:
+    xqc_shard_dispatcher_destroy(dispatcher);
+    return NULL;
+}
+
+void
+xqc_shard_dispatcher_destroy(xqc_shard_dispatcher_t *dispatcher)
+{
+    if (dispatcher == NULL) {
+        return;
+    }
+
+    if (dispatcher->shards) {
+        for (uint32_t i = 0; i < dispatcher->config.shard_count; i++) {
+            xqc_spsc_queue_destroy(dispatcher->shards[i].queue);
+        }
+        xqc_free(dispatcher->shards);
+    }
+
+    xqc_lb_cid_decryption_ctx_destroy(dispatcher->lb_cid_dec_ctx);
+
+    xqc_free(dispatcher);
+}
+
+xqc_int_t
+xqc_shard_dispatcher_bind_engine(xqc_shard_dispatcher_t *dispatcher, uint32_t shard_id,
+    xqc_engine_t *engine)
+{
+    if (shard_id >= dispatcher->config.shard_count || engine->eng_type != XQC_ENGINE_SERVER) {
+        return -XQC_EPARAM;
+    }
+
+    if (engine->config->cid_len != dispatcher->config.cid_len) {
+        xqc_log(engine->log, XQC_LOG_ERROR, "|cid_len mismatch|engine:%ud|shard:%ud|",
+                (unsigned int)engine->config->cid_len, (unsigned int)dispatcher->config.cid_len);
+        return -XQC_EPARAM;
+    }
+
+    dispatcher->shards[shard_id].engine = engine;
+    engine->shard_dispatcher = dispatcher;
+    engine->shard_id = shard_id;
+
+    xqc_log(engine->log, XQC_LOG_INFO, "|bind engine to shard|shard_id:%ud|shard_count:%ud|",
+            shard_id, dispatcher->config.shard_count);
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_shard_generate_cid(xqc_engine_t *engine, uint8_t *cid_buf, size_t cid_len)
+{
+    xqc_shard_dispatcher_t *dispatcher = engine->shard_dispatcher;
+    uint8_t plain[XQC_MAX_CID_LEN];
+    size_t pos = 0;
+    xqc_int_t ret;
+
+    if (cid_len != dispatcher->config.cid_len) {
+        return -XQC_EPARAM;
+    }
+
+    plain[pos++] = dispatcher->config.conf_id;
+    if (dispatcher->sid_len == 2) {
+        plain[pos++] = (uint8_t)(engine->shard_id >> 8);
+    }
+    plain[pos++] = (uint8_t)engine->shard_id;
+
+    if (pos < cid_len
+        && xqc_get_random(engine->rand_generator, plain + pos, cid_len - pos) != XQC_OK)
+    {
+        return -XQC_EGENERATE_CID;
+    }
+
+    if (!dispatcher->config.lb_cid_enc_on) {
+        xqc_memcpy(cid_buf, plain, cid_len);
+        return XQC_OK;
+    }
+
+    ret = xqc_lb_cid_encryption(plain, cid_len - XQC_FIRST_OCTET, cid_buf, cid_len,
+                                dispatcher->config.lb_cid_key, XQC_LB_CID_KEY_LEN, engine);
+    if (ret != XQC_OK) {
+        return ret;
+    }
+
+    /* first octet is not encrypted */
+    cid_buf[0] = plain[0];
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_shard_parse_dcid(xqc_shard_dispatcher_t *dispatcher, const unsigned char *buf, size_t size,
+    const unsigned char **dcid, size_t *dcid_len)
+{
+    size_t pos;
+
+    if (size < 1) {
+        return -XQC_EPARAM;
+    }
+
+    if (XQC_PACKET_IS_LONG_HEADER(buf)) {
+        /* first byte | version | dcid len | dcid */
+        pos = XQC_PACKET_LONG_HEADER_PREFIX_LENGTH;
+        if (size < pos + 1) {
+            return -XQC_EPARAM;
+        }
+
+        *dcid_len = buf[pos++];
+        if (*dcid_len > XQC_MAX_CID_LEN || size < pos + *dcid_len) {
+            return -XQC_EPARAM;
+        }
+
+    } else {
+        /* short header dcid is always generated by this server */
+        pos = 1;
+        *dcid_len = dispatcher->config.cid_len;
+        if (size < pos + *dcid_len) {
+            return -XQC_EPARAM;
+        }
+    }
+
+    *dcid = buf + pos;
+    return XQC_OK;
+}
+
+xqc_int_t
+xqc_shard_get_shard_id(xqc_shard_dispatcher_t *dispatcher, const unsigned char *packet_in_buf,
+    size_t packet_in_size)
+{
+    const xqc_shard_config_t *config = &dispatcher->config;
+    const unsigned char *dcid;
+    uint8_t plain[XQC_MAX_CID_LEN];
+    size_t dcid_len;
+    uint32_t shard_id;
+    xqc_int_t ret;
+
+    ret = xqc_shard_parse_dcid(dispatcher, packet_in_buf, packet_in_size, &dcid, &dcid_len);
+    if (ret != XQC_OK) {
+        return ret;
+    }
+
+    if (dcid_len == config->cid_len && dcid[0] == config->conf_id) {
+        if (config->lb_cid_enc_on) {
+            ret = xqc_lb_cid_decryption_single_pass(dispatcher->lb_cid_dec_ctx, dcid, dcid_len,
+                                                    plain, sizeof(plain));
+            if (ret == XQC_OK) {
+                dcid = plain;
+            }
+        }
+
+        if (ret == XQC_OK) {
+            shard_id = dcid[1];
+            if (dispatcher->sid_len == 2) {
+                shard_id = (shard_id << 8) | dcid[2];
+            }
+
+            if (shard_id < config->shard_count) {
+                return shard_id;
+            }
+        }
+
+        /* not generated by any shard, take it as a random cid */
+        ret = xqc_shard_parse_dcid(dispatcher, packet_in_buf, packet_in_size, &dcid, &dcid_len);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+    }
+
+    /*
+     * dcid chosen by client, which is used by client Initial and 0-RTT packets before a
+     * server cid is received. the same dcid always leads to the same shard, and the engine
+     * of that shard will generate cids with its own shard id for the connection
+     */
+    return xqc_murmur_hash2((u_char *)dcid, dcid_len) % config->shard_count;
+}
+
+xqc_int_t
+xqc_shard_dispatch(xqc_shard_dispatcher_t *dispatcher,
+    const unsigned char *packet_in_buf, size_t packet_in_size,
+    const struct sockaddr *local_addr, socklen_t local_addrlen,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+    xqc_usec_t recv_time)
+{
+    xqc_shard_packet_t *pkt;
+    xqc_int_t shard_id;
+
+    if (packet_in_size > XQC_MAX_PACKET_IN_LEN
+        || local_addrlen > sizeof(pkt->local_addr) || peer_addrlen > sizeof(pkt->peer_addr))
+    {
+        return -XQC_EPARAM;
+    }
+
+    shard_id = xqc_shard_get_shard_id(dispatcher, packet_in_buf, packet_in_size);
+    if (shard_id < 0) {
+        return shard_id;
+    }
+
+    pkt = xqc_spsc_queue_reserve(dispatcher->shards[shard_id].queue);
+    if (pkt == NULL) {
+        return -XQC_EAGAIN;
+    }
+
+    pkt->recv_time = recv_time;
+    pkt->len = packet_in_size;
+    pkt->local_addrlen = local_addrlen;
+    pkt->peer_addrlen = peer_addrlen;
+    if (local_addr) {
+        xqc_memcpy(pkt->local_addr, local_addr, local_addrlen);
+    }
+    if (peer_addr) {
+        xqc_memcpy(pkt->peer_addr, peer_addr, peer_addrlen);
+    }
+    xqc_memcpy(pkt->buf, packet_in_buf, packet_in_size);
+
+    xqc_spsc_queue_commit(dispatcher->shards[shard_id].queue);
+    return shard_id;
+}
+
+xqc_int_t
+xqc_shard_process(xqc_shard_dispatcher_t *dispatcher, uint32_t shard_id, size_t max_count)
+{
+    xqc_shard_t *shard;
+    xqc_shard_packet_t *pkt;
+    xqc_int_t ret;
+    size_t count = 0;
+
+    if (shard_id >= dispatcher->config.shard_count
+        || dispatcher->shards[shard_id].engine == NULL)
+    {
+        return -XQC_EPARAM;
+    }
+
+    shard = &dispatcher->shards[shard_id];
+    while ((max_count == 0 || count < max_count)
+           && (pkt = xqc_spsc_queue_front(shard->queue)) != NULL)
+    {
+        ret = xqc_engine_packet_process(shard->engine, pkt->buf, pkt->len,
+                                        (struct sockaddr *)pkt->local_addr, pkt->local_addrlen,
+                                        (struct sockaddr *)pkt->peer_addr, pkt->peer_addrlen,
+                                        pkt->recv_time, NULL);
+        if (ret != XQC_OK) {
+            xqc_log(shard->engine->log, XQC_LOG_DEBUG, "|packet process error|ret:%d|", ret);
+        }
+
+        xqc_spsc_queue_pop(shard->queue);
+        count++;
+    }
+
+    if (count > 0) {
+        xqc_engine_finish_recv(shard->engine);
+    }
+
+    return (xqc_int_t)count;
+}
@@ -0,0 +1,61 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_SHARD_H_INCLUDED_
+#define _XQC_SHARD_H_INCLUDED_
+
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/common/utils/spsc/xqc_spsc_queue.h"
+#include "src/transport/xqc_packet_in.h"
+
+#define XQC_SHARD_DEFAULT_QUEUE_CAPACITY    4096
+#define XQC_SHARD_MAX_COUNT                 65535
+
+/* shard id takes 1 byte in cid if shard count is not more than this, 2 bytes otherwise */
+#define XQC_SHARD_ONE_BYTE_ID_COUNT         256
+
+/* a datagram waiting in the queue of shard */
+typedef struct xqc_shard_packet_s {
+    xqc_usec_t                  recv_time;
+    size_t                      len;
+    socklen_t                   local_addrlen;
+    socklen_t                   peer_addrlen;
+    unsigned char               local_addr[sizeof(struct sockaddr_in6)];
+    unsigned char               peer_addr[sizeof(struct sockaddr_in6)];
+    unsigned char               buf[XQC_MAX_PACKET_IN_LEN];
+} xqc_shard_packet_t;
+
+typedef struct xqc_shard_s {
+    /* datagrams from dispatcher thread to shard thread */
+    xqc_spsc_queue_t           *queue;
+
+    /* engine running on shard thread */
+    xqc_engine_t               *engine;
+} xqc_shard_t;
+
+struct xqc_shard_dispatcher_s {
+    xqc_shard_config_t          config;
+
+    /* bytes of shard id in cid */
+    uint8_t                     sid_len;
+
+    /*
+     * cipher context for decrypting cids, created once if lb_cid_enc_on is set. decryption
+     * changes its state, so it is used on the dispatcher thread only
+     */
+    void                       *lb_cid_dec_ctx;
+
+    xqc_shard_t                *shards;
+};
+
+
+/**
+ * @brief generate a cid of cid_len bytes encoding the shard id of engine, in the layout of
+ * load balance cid, and encrypted if lb_cid_enc_on is set
+ * @return XQC_OK for success, others for failure
+ */
+xqc_int_t xqc_shard_generate_cid(xqc_engine_t *engine, uint8_t *cid_buf, size_t cid_len);
+
+#endif /* _XQC_SHARD_H_INCLUDED_ */
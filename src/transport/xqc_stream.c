@@ -33,12 +33,68 @@ xqc_gen_stream_id(xqc_connection_t *conn, xqc_stream_type_t type)
     return sid;
 }
 
+/* unidirectional streams go ahead of bidirectional ones, then lower stream ids go first */
+static xqc_bool_t
+xqc_stream_write_precedes(xqc_stream_t *a, xqc_stream_t *b)
+{
+    if (xqc_stream_is_bidi(a->stream_id) != xqc_stream_is_bidi(b->stream_id)) {
+        return !xqc_stream_is_bidi(a->stream_id);
+    }
+    return a->stream_id < b->stream_id;
+}
+
+/*
+ * insert stream into the write bucket of its urgency. non-incremental streams
+ * are kept ahead of incremental ones and ordered by stream id, so that they are
+ * served sequentially; incremental streams are appended and take turns.
+ */
+static void
+xqc_stream_write_queue_insert(xqc_stream_t *stream)
+{
+    xqc_list_head_t *head = &stream->stream_conn->conn_write_streams[stream->stream_urgency];
+    xqc_list_head_t *pos;
+    xqc_stream_t *s;
+
+    if (stream->stream_incremental) {
+        xqc_list_add_tail(&stream->write_stream_list, head);
+        return;
+    }
+
+    /* newer streams usually have larger ids, search from tail */
+    xqc_list_for_each_reverse(pos, head) {
+        s = xqc_list_entry(pos, xqc_stream_t, write_stream_list);
+        if (!s->stream_incremental && xqc_stream_write_precedes(s, stream)) {
+            break;
+        }
+    }
+    xqc_list_add(&stream->write_stream_list, pos);
+}
+
+/* move the first incremental stream to the tail, for round-robin among them */
+static void
+xqc_stream_write_queue_rotate(xqc_list_head_t *head)
+{
+    xqc_list_head_t *pos;
+    xqc_stream_t *s;
+
+    xqc_list_for_each(pos, head) {
+        s = xqc_list_entry(pos, xqc_stream_t, write_stream_list);
+        if (s->stream_incremental) {
+            if (pos->next != head) {
+                xqc_list_del(pos);
+                xqc_list_add_tail(pos, head);
+            }
+            return;
+        }
+    }
+}
+
 void
 xqc_stream_ready_to_write(xqc_stream_t *stream)
 {
     if (!(stream->stream_flag & XQC_STREAM_FLAG_READY_TO_WRITE)) {
         if (stream->stream_encrypt_level == XQC_ENC_LEV_1RTT) {
-            xqc_list_add_tail(&stream->write_stream_list, &stream->stream_conn->conn_write_streams);
+            xqc_stream_write_queue_insert(stream);
         }
         stream->stream_flag |= XQC_STREAM_FLAG_READY_TO_WRITE;
     }
@@ -606,6 +662,7 @@ xqc_create_stream_with_conn(xqc_connection_t *conn, xqc_stream_id_t stream_id,
     xqc_list_add_tail(&stream->all_stream_list, &conn->conn_all_streams);
 
     stream->stream_encrypt_level = XQC_ENC_LEV_1RTT;
+    stream->stream_incremental = XQC_FALSE;
 
     stream->stream_conn = conn;
     stream->stream_if = &conn->app_proto_cbs.stream_cbs;
@@ -637,6 +694,14 @@ xqc_create_stream_with_conn(xqc_connection_t *conn, xqc_stream_id_t stream_id,
         stream->stream_type = xqc_get_stream_type(stream_id);
     }
 
+    /*
+     * unidirectional streams carry control data of application protocol, e.g. h3 control and
+     * qpack encoder/decoder streams, which requests are blocked on. put them in the most urgent
+     * bucket, so that they are never starved by requests.
+     */
+    stream->stream_urgency = xqc_stream_is_bidi(stream->stream_id)
+                             ? XQC_DEFAULT_HTTP_PRIORITY_URGENCY : XQC_HIGHEST_HTTP_PRIORITY_URGENCY;
+
     xqc_id_hash_element_t e = {stream->stream_id, stream};
     if (xqc_id_hash_add(conn->streams_hash, e)) {
         xqc_log(conn->log, XQC_LOG_ERROR, "|xqc_id_hash_add error|");
@@ -681,6 +746,34 @@ xqc_stream_set_priority(xqc_stream_t *stream, xqc_stream_priority_t priority)
     stream->stream_priority = priority;
 }
 
+void
+xqc_stream_set_urgency(xqc_stream_t *stream, uint8_t urgency, uint8_t incremental)
+{
+    urgency = xqc_min(urgency, XQC_LOWEST_HTTP_PRIORITY_URGENCY);
+    incremental = incremental ? XQC_TRUE : XQC_FALSE;
+
+    if (stream->stream_urgency == urgency && stream->stream_incremental == incremental) {
+        return;
+    }
+
+    xqc_log(stream->stream_conn->log, XQC_LOG_DEBUG, "|stream_id:%ui|urgency:%ud->%ud|incremental:%ud->%ud|",
+            stream->stream_id, (unsigned int)stream->stream_urgency, (unsigned int)urgency,
+            (unsigned int)stream->stream_incremental, (unsigned int)incremental);
+
+    if ((stream->stream_flag & XQC_STREAM_FLAG_READY_TO_WRITE)
+        && stream->stream_encrypt_level == XQC_ENC_LEV_1RTT)
+    {
+        xqc_list_del_init(&stream->write_stream_list);
+        stream->stream_urgency = urgency;
+        stream->stream_incremental = incremental;
+        xqc_stream_write_queue_insert(stream);
+
+    } else {
+        stream->stream_urgency = urgency;
+        stream->stream_incremental = incremental;
+    }
+}
+
 void
 xqc_stream_set_user_data(xqc_stream_t *stream, void *user_data)
 {
@@ -1045,7 +1138,9 @@ xqc_read_crypto_stream(xqc_stream_t *stream)
 
         stream->stream_data_in.next_read_offset = stream->stream_data_in.next_read_offset + data_len;
 
+        xqc_perf_timing_begin(tls_begin);
         xqc_int_t ret = xqc_tls_process_crypto_data(conn->tls, stream->stream_encrypt_level, data_start, data_len);
+        xqc_perf_timing_end(tls_begin, conn->engine->perf_stats.tls_process_ticks);
 
         xqc_list_del(pos);
         xqc_destroy_stream_frame(stream_frame);
@@ -1709,31 +1804,56 @@ xqc_process_write_streams(xqc_connection_t *conn)
     XQC_DEBUG_PRINT
     xqc_int_t ret;
     xqc_stream_t *stream;
-    xqc_list_head_t *pos, *next;
+    xqc_list_head_t *pos, *next, *head;
+    xqc_bool_t served;
     int cnt = 0;
 
-    xqc_list_for_each_safe(pos, next, &conn->conn_write_streams) {
-        stream = xqc_list_entry(pos, xqc_stream_t, write_stream_list);
-        if (stream->stream_flag & XQC_STREAM_FLAG_DATA_BLOCKED
-            || conn->conn_flag & XQC_CONN_FLAG_DATA_BLOCKED) 
-        {
-            xqc_log(conn->log, XQC_LOG_DEBUG, "|DATA_BLOCKED|stream_id:%ui|conn:%p|",
-                    stream->stream_id, stream->stream_conn);
-            continue;
-        }
-        xqc_log(conn->log, XQC_LOG_DEBUG, "|stream_write_notify|flag:%d|stream_id:%ui|conn:%p|cnt:%d|",
-                stream->stream_flag, stream->stream_id, stream->stream_conn, cnt++);
-        if (stream->stream_if->stream_write_notify == NULL) {
-            xqc_log(conn->log, XQC_LOG_ERROR, "|stream_write_notify is NULL|flag:%d|stream_id:%ui|conn:%p|",
-                    stream->stream_flag, stream->stream_id, stream->stream_conn);
-            XQC_CONN_ERR(conn, TRA_INTERNAL_ERROR);
-            return;
+    /*
+     * serve urgency buckets from the most urgent one, and stop as soon as the connection can't
+     * take more data, so that less urgent streams are not notified before more urgent ones
+     * have been given all the room they can use.
+     */
+    for (int urgency = 0; urgency < XQC_STREAM_URGENCY_LEVELS; urgency++) {
+        head = &conn->conn_write_streams[urgency];
+        served = XQC_FALSE;
+
+        xqc_list_for_each_safe(pos, next, head) {
+            stream = xqc_list_entry(pos, xqc_stream_t, write_stream_list);
+            if (conn->conn_flag & XQC_CONN_FLAG_DATA_BLOCKED
+                || !xqc_send_queue_can_write(conn->conn_send_queue))
+            {
+                xqc_log(conn->log, XQC_LOG_DEBUG, "|stop write notify|urgency:%d|conn_flag:%s|sndq_packets_used:%ud|",
+                        urgency, xqc_conn_flag_2_str(conn, conn->conn_flag), conn->conn_send_queue->sndq_packets_used);
+                if (served) {
+                    xqc_stream_write_queue_rotate(head);
+                }
+                return;
+            }
+            if (stream->stream_flag & XQC_STREAM_FLAG_DATA_BLOCKED) {
+                xqc_log(conn->log, XQC_LOG_DEBUG, "|DATA_BLOCKED|stream_id:%ui|conn:%p|",
+                        stream->stream_id, stream->stream_conn);
+                continue;
+            }
+            xqc_log(conn->log, XQC_LOG_DEBUG, "|stream_write_notify|flag:%d|stream_id:%ui|conn:%p|"
+                    "cnt:%d|urgency:%d|incremental:%ud|", stream->stream_flag, stream->stream_id,
+                    stream->stream_conn, cnt++, urgency, (unsigned int)stream->stream_incremental);
+            if (stream->stream_if->stream_write_notify == NULL) {
+                xqc_log(conn->log, XQC_LOG_ERROR, "|stream_write_notify is NULL|flag:%d|stream_id:%ui|conn:%p|",
+                        stream->stream_flag, stream->stream_id, stream->stream_conn);
+                XQC_CONN_ERR(conn, TRA_INTERNAL_ERROR);
+                return;
+            }
+            served = XQC_TRUE;
+            ret = stream->stream_if->stream_write_notify(stream, stream->user_data);
+            if (ret < 0) {
+                xqc_log(conn->log, XQC_LOG_ERROR, "|stream_write_notify err:%d|flag:%d|stream_id:%ui|conn:%p|",
+                        ret, stream->stream_flag, stream->stream_id, stream->stream_conn);
+                XQC_CONN_ERR(conn, TRA_INTERNAL_ERROR);
+            }
         }
-        ret = stream->stream_if->stream_write_notify(stream, stream->user_data);
-        if (ret < 0) {
-            xqc_log(conn->log, XQC_LOG_ERROR, "|stream_write_notify err:%d|flag:%d|stream_id:%ui|conn:%p|",
-                    ret, stream->stream_flag, stream->stream_id, stream->stream_conn);
-            XQC_CONN_ERR(conn, TRA_INTERNAL_ERROR);
+
+        if (served) {
+            xqc_stream_write_queue_rotate(head);
         }
     }
 }
@@ -184,6 +184,11 @@ struct xqc_stream_s {
     char                    end_trans_state[XQC_STREAM_TRANSPORT_STATE_SZ];
     
     xqc_stream_priority_t   stream_priority;
+
+    /* RFC 9218 urgency and incremental flag, used by write scheduler */
+    uint8_t                 stream_urgency;
+    uint8_t                 stream_incremental;
+
     struct {
         xqc_flag_t          enable_fec;
 
@@ -220,6 +225,13 @@ xqc_stream_is_uni(xqc_stream_id_t stream_id)
 
 void xqc_stream_set_priority(xqc_stream_t *stream, xqc_stream_priority_t priority);
 
+/**
+ * set the urgency (0 is the most urgent) and incremental flag of stream. streams with
+ * lower urgency value are written first; within the same urgency, non-incremental
+ * streams are written sequentially by stream id, incremental ones in round-robin.
+ */
+void xqc_stream_set_urgency(xqc_stream_t *stream, uint8_t urgency, uint8_t incremental);
+
 xqc_stream_t *xqc_create_stream_with_conn (xqc_connection_t *conn, xqc_stream_id_t stream_id,
     xqc_stream_type_t stream_type, xqc_stream_settings_t *settings, void *user_data);
 
@@ -356,6 +356,8 @@ xqc_timer_init(xqc_timer_manager_t *manager, xqc_log_t *log, void *user_data)
 {
     memset(manager->timer, 0, XQC_TIMER_N * sizeof(xqc_timer_t));
     manager->log = log;
+    manager->next_expire_time = 0;
+    manager->next_expire_dirty = XQC_FALSE;
 
     xqc_timer_t *timer;
     for (xqc_timer_type_t type = 0; type < XQC_TIMER_N; ++type) {
@@ -421,9 +423,45 @@ xqc_timer_init(xqc_timer_manager_t *manager, xqc_log_t *log, void *user_data)
         }
     }
 
-    /* init gp timer list */
-    xqc_init_list_head(&manager->gp_timer_list);
+    /* init gp timer */
+    manager->gp_timers = NULL;
+    manager->gp_timers_cap = 0;
     manager->next_gp_timer_id = 0;
+    manager->gp_timer_wheel = NULL;
+}
+
+static xqc_int_t
+xqc_timer_gp_timers_reserve(xqc_timer_manager_t *manager)
+{
+    xqc_gp_timer_t **gp_timers;
+    xqc_gp_timer_id_t cap;
+
+    if (manager->gp_timer_wheel == NULL) {
+        manager->gp_timer_wheel = xqc_timer_wheel_create(xqc_monotonic_timestamp());
+        if (manager->gp_timer_wheel == NULL) {
+            return -XQC_EMALLOC;
+        }
+    }
+
+    if (manager->next_gp_timer_id < manager->gp_timers_cap) {
+        return XQC_OK;
+    }
+
+    cap = manager->gp_timers_cap == 0 ? XQC_GP_TIMER_INIT_CAP : manager->gp_timers_cap;
+    while (cap <= manager->next_gp_timer_id && cap < XQC_GP_TIMER_ID_MAX / 2) {
+        cap *= 2;
+    }
+
+    gp_timers = (xqc_gp_timer_t **)xqc_realloc(manager->gp_timers, cap * sizeof(xqc_gp_timer_t *));
+    if (gp_timers == NULL) {
+        return -XQC_EMALLOC;
+    }
+
+    memset(gp_timers + manager->gp_timers_cap, 0,
+           (cap - manager->gp_timers_cap) * sizeof(xqc_gp_timer_t *));
+    manager->gp_timers = gp_timers;
+    manager->gp_timers_cap = cap;
+    return XQC_OK;
 }
 
 xqc_gp_timer_id_t xqc_timer_register_gp_timer(xqc_timer_manager_t *manager, 
@@ -440,6 +478,10 @@ xqc_gp_timer_id_t xqc_timer_register_gp_timer(xqc_timer_manager_t *manager,
         return XQC_ERROR;
     }
 
+    if (xqc_timer_gp_timers_reserve(manager) != XQC_OK) {
+        return -XQC_EMALLOC;
+    }
+
     xqc_gp_timer_t *timer = (xqc_gp_timer_t*)xqc_calloc(1, sizeof(xqc_gp_timer_t));
     if (timer == NULL) {
         return -XQC_EMALLOC;
@@ -453,39 +495,40 @@ xqc_gp_timer_id_t xqc_timer_register_gp_timer(xqc_timer_manager_t *manager,
     }
     xqc_memcpy(timer->name, timer_name, name_len);
     
+    xqc_timer_wheel_node_init(&timer->node);
     timer->timer_is_set = XQC_FALSE;
     timer->id = manager->next_gp_timer_id++;
     timer->timeout_cb = cb;
     timer->user_data = user_data;
 
-    xqc_list_add_tail(&timer->list, &manager->gp_timer_list);
+    manager->gp_timers[timer->id] = timer;
     return timer->id;
 }
 
 xqc_int_t 
 xqc_timer_unregister_gp_timer(xqc_timer_manager_t *manager, xqc_gp_timer_id_t gp_timer_id)
 {
-    if (!manager || gp_timer_id >= manager->next_gp_timer_id) {
+    if (!manager || gp_timer_id < 0 || gp_timer_id >= manager->next_gp_timer_id) {
         return -XQC_EPARAM;
     }
 
-    xqc_list_head_t *pos, *next;
-    xqc_gp_timer_t *gp_timer;
-
-    xqc_list_for_each_safe(pos, next, &manager->gp_timer_list) {
-        gp_timer = xqc_list_entry(pos, xqc_gp_timer_t, list);
-        if (gp_timer->id == gp_timer_id) {
-            xqc_timer_destroy_gp_timer(gp_timer);
-            return XQC_OK;
-        }
+    xqc_gp_timer_t *gp_timer = xqc_timer_find_gp_timer(manager, gp_timer_id);
+    if (gp_timer == NULL) {
+        return XQC_ERROR;
     }
-    return XQC_ERROR;
+
+    xqc_timer_destroy_gp_timer(manager, gp_timer);
+    return XQC_OK;
 }
 
 void 
-xqc_timer_destroy_gp_timer(xqc_gp_timer_t *gp_timer)
+xqc_timer_destroy_gp_timer(xqc_timer_manager_t *manager, xqc_gp_timer_t *gp_timer)
 {
-    xqc_list_del_init(&gp_timer->list);
+    if (gp_timer->timer_is_set) {
+        xqc_timer_wheel_del(manager->gp_timer_wheel, &gp_timer->node);
+    }
+
+    manager->gp_timers[gp_timer->id] = NULL;
     xqc_free(gp_timer->name);
     xqc_free(gp_timer);
 }
@@ -493,13 +536,23 @@ xqc_timer_destroy_gp_timer(xqc_gp_timer_t *gp_timer)
 void 
 xqc_timer_destroy_gp_timer_list(xqc_timer_manager_t *manager)
 {
-    xqc_list_head_t *pos, *next;
     xqc_gp_timer_t *gp_timer;
 
-    xqc_list_for_each_safe(pos, next, &manager->gp_timer_list) {
-        gp_timer = xqc_list_entry(pos, xqc_gp_timer_t, list);
-        xqc_timer_destroy_gp_timer(gp_timer);
+    for (xqc_gp_timer_id_t id = 0; id < manager->next_gp_timer_id; id++) {
+        gp_timer = manager->gp_timers[id];
+        if (gp_timer) {
+            xqc_timer_destroy_gp_timer(manager, gp_timer);
+        }
     }
+
+    if (manager->gp_timer_wheel) {
+        xqc_timer_wheel_destroy(manager->gp_timer_wheel);
+        manager->gp_timer_wheel = NULL;
+    }
+
+    xqc_free(manager->gp_timers);
+    manager->gp_timers = NULL;
+    manager->gp_timers_cap = 0;
 }
 
 /*
@@ -5,6 +5,7 @@
 #include "src/transport/xqc_packet.h"
 #include "src/transport/xqc_packet_in.h"
 #include "src/common/xqc_list.h"
+#include "src/common/utils/timer_wheel/xqc_timer_wheel.h"
 
 /*
  * A connection will time out if no packets are sent or received for a
@@ -56,6 +57,8 @@ typedef int32_t xqc_gp_timer_id_t;
 
 #define XQC_GP_TIMER_ID_MAX (0x7fffffff)
 
+#define XQC_GP_TIMER_INIT_CAP (4)
+
 /* timer timeout callback */
 typedef void (*xqc_timer_timeout_pt)(xqc_timer_type_t type, xqc_usec_t now, void *user_data);
 
@@ -72,7 +75,7 @@ typedef struct xqc_timer_s {
 
 /* general purpose timer */
 typedef struct xqc_gp_timer_s {
-    xqc_list_head_t             list;
+    xqc_timer_wheel_node_t      node;
     xqc_gp_timer_id_t           id;
     xqc_bool_t                  timer_is_set;
     xqc_usec_t                  expire_time;
@@ -86,9 +89,21 @@ typedef struct xqc_gp_timer_s {
 typedef struct xqc_timer_manager_s {
     xqc_timer_t                 timer[XQC_TIMER_N];
     xqc_log_t                  *log;
-    /* general purpose timer */
-    xqc_list_head_t             gp_timer_list;
+
+    /*
+     * the earliest expire time of timer[], 0 if no timer is set. it is
+     * recalculated lazily only when the earliest timer is unset or postponed
+     */
+    xqc_usec_t                  next_expire_time;
+    xqc_bool_t                  next_expire_dirty;
+
+    /* general purpose timer, indexed by timer id */
+    xqc_gp_timer_t            **gp_timers;
+    xqc_gp_timer_id_t           gp_timers_cap;
     xqc_gp_timer_id_t           next_gp_timer_id;
+
+    /* wheel of gp timers which are set, created when the first gp timer is registered */
+    xqc_timer_wheel_t          *gp_timer_wheel;
 } xqc_timer_manager_t;
 
 /* APIs for gp timer */
@@ -97,77 +112,80 @@ xqc_gp_timer_id_t xqc_timer_register_gp_timer(xqc_timer_manager_t *manager,
 
 xqc_int_t xqc_timer_unregister_gp_timer(xqc_timer_manager_t *manager, xqc_gp_timer_id_t gp_timer_id);
 
-void xqc_timer_destroy_gp_timer(xqc_gp_timer_t *gp_timer);
+void xqc_timer_destroy_gp_timer(xqc_timer_manager_t *manager, xqc_gp_timer_t *gp_timer);
 
 void xqc_timer_destroy_gp_timer_list(xqc_timer_manager_t *manager);
 
+static inline xqc_gp_timer_t *
+xqc_timer_find_gp_timer(xqc_timer_manager_t *manager, xqc_gp_timer_id_t gp_timer_id)
+{
+    return manager->gp_timers[gp_timer_id];
+}
+
 static inline xqc_int_t
 xqc_timer_gp_timer_set(xqc_timer_manager_t *manager, xqc_gp_timer_id_t gp_timer_id, xqc_usec_t expire_time)
 {
-    if (!manager || gp_timer_id >= manager->next_gp_timer_id) {
+    if (!manager || gp_timer_id < 0 || gp_timer_id >= manager->next_gp_timer_id) {
         return -XQC_EPARAM;
     }
 
-    xqc_list_head_t *pos, *next;
-    xqc_gp_timer_t *gp_timer;
+    xqc_gp_timer_t *gp_timer = xqc_timer_find_gp_timer(manager, gp_timer_id);
+    if (gp_timer == NULL) {
+        return XQC_ERROR;
+    }
 
-    xqc_list_for_each_safe(pos, next, &manager->gp_timer_list) {
-        gp_timer = xqc_list_entry(pos, xqc_gp_timer_t, list);
-        if (gp_timer->id == gp_timer_id) {
-            gp_timer->expire_time = expire_time;
-            gp_timer->timer_is_set = XQC_TRUE;
-            xqc_log(manager->log, XQC_LOG_DEBUG, "|gp_timer_set|id:%d|name:%s|expire_time:%ui|", 
-                    gp_timer->id, gp_timer->name, gp_timer->expire_time);
-            return XQC_OK;
-        }
+    if (gp_timer->timer_is_set) {
+        xqc_timer_wheel_del(manager->gp_timer_wheel, &gp_timer->node);
     }
-    return XQC_ERROR;
+
+    gp_timer->expire_time = expire_time;
+    gp_timer->timer_is_set = XQC_TRUE;
+    xqc_timer_wheel_add(manager->gp_timer_wheel, &gp_timer->node, expire_time);
+    xqc_log(manager->log, XQC_LOG_DEBUG, "|gp_timer_set|id:%d|name:%s|expire_time:%ui|", 
+            gp_timer->id, gp_timer->name, gp_timer->expire_time);
+    return XQC_OK;
 }
 
 static inline xqc_int_t
 xqc_timer_gp_timer_unset(xqc_timer_manager_t *manager, xqc_gp_timer_id_t gp_timer_id)
 {
-    if (!manager || gp_timer_id >= manager->next_gp_timer_id) {
+    if (!manager || gp_timer_id < 0 || gp_timer_id >= manager->next_gp_timer_id) {
         return -XQC_EPARAM;
     }
 
-    xqc_list_head_t *pos, *next;
-    xqc_gp_timer_t *gp_timer;
+    xqc_gp_timer_t *gp_timer = xqc_timer_find_gp_timer(manager, gp_timer_id);
+    if (gp_timer == NULL) {
+        return XQC_ERROR;
+    }
 
-    xqc_list_for_each_safe(pos, next, &manager->gp_timer_list) {
-        gp_timer = xqc_list_entry(pos, xqc_gp_timer_t, list);
-        if (gp_timer->id == gp_timer_id) {
-            gp_timer->expire_time = 0;
-            gp_timer->timer_is_set = XQC_FALSE;
-            xqc_log(manager->log, XQC_LOG_DEBUG, "|gp_timer_unset|id:%d|name:%s|expire_time:%ui|", 
-                    gp_timer->id, gp_timer->name, gp_timer->expire_time);
-            return XQC_OK;
-        }
+    if (gp_timer->timer_is_set) {
+        xqc_timer_wheel_del(manager->gp_timer_wheel, &gp_timer->node);
     }
-    return XQC_ERROR;
+
+    gp_timer->expire_time = 0;
+    gp_timer->timer_is_set = XQC_FALSE;
+    xqc_log(manager->log, XQC_LOG_DEBUG, "|gp_timer_unset|id:%d|name:%s|expire_time:%ui|", 
+            gp_timer->id, gp_timer->name, gp_timer->expire_time);
+    return XQC_OK;
 }
 
 static inline xqc_int_t
 xqc_timer_gp_timer_get_info(xqc_timer_manager_t *manager, xqc_gp_timer_id_t gp_timer_id, xqc_bool_t *is_set, xqc_usec_t *expire_time)
 {
-    if (!manager || gp_timer_id >= manager->next_gp_timer_id) {
+    if (!manager || gp_timer_id < 0 || gp_timer_id >= manager->next_gp_timer_id) {
         return -XQC_EPARAM;
     }
 
-    xqc_list_head_t *pos, *next;
-    xqc_gp_timer_t *gp_timer;
-
-    xqc_list_for_each_safe(pos, next, &manager->gp_timer_list) {
-        gp_timer = xqc_list_entry(pos, xqc_gp_timer_t, list);
-        if (gp_timer->id == gp_timer_id) {
-            *is_set = gp_timer->timer_is_set;
-            *expire_time = gp_timer->expire_time;
-            xqc_log(manager->log, XQC_LOG_DEBUG, "|gp_timer_get_info|id:%d|name:%s|is_set:%d|expire_time:%ui|", 
-                    gp_timer->id, gp_timer->name, gp_timer->timer_is_set, gp_timer->expire_time);
-            return XQC_OK;
-        }
+    xqc_gp_timer_t *gp_timer = xqc_timer_find_gp_timer(manager, gp_timer_id);
+    if (gp_timer == NULL) {
+        return XQC_ERROR;
     }
-    return XQC_ERROR;
+
+    *is_set = gp_timer->timer_is_set;
+    *expire_time = gp_timer->expire_time;
+    xqc_log(manager->log, XQC_LOG_DEBUG, "|gp_timer_get_info|id:%d|name:%s|is_set:%d|expire_time:%ui|", 
+            gp_timer->id, gp_timer->name, gp_timer->timer_is_set, gp_timer->expire_time);
+    return XQC_OK;
 }
 
 const char *xqc_timer_type_2_str(xqc_timer_type_t timer_type);
@@ -180,11 +198,78 @@ xqc_timer_is_set(xqc_timer_manager_t *manager, xqc_timer_type_t type)
     return manager->timer[type].timer_is_set;
 }
 
+/* shall be called before a set timer is unset or its expire time is changed */
+static inline void
+xqc_timer_next_expire_remove(xqc_timer_manager_t *manager, xqc_timer_type_t type)
+{
+    if (manager->timer[type].timer_is_set
+        && manager->timer[type].expire_time == manager->next_expire_time)
+    {
+        manager->next_expire_dirty = XQC_TRUE;
+    }
+}
+
+static inline void
+xqc_timer_next_expire_add(xqc_timer_manager_t *manager, xqc_usec_t expire_time)
+{
+    if (!manager->next_expire_dirty
+        && (manager->next_expire_time == 0 || expire_time < manager->next_expire_time))
+    {
+        manager->next_expire_time = expire_time;
+    }
+}
+
+/**
+ * the earliest expire time of timer[], 0 if no timer is set
+ */
+static inline xqc_usec_t
+xqc_timer_earliest_expire_time(xqc_timer_manager_t *manager)
+{
+    xqc_timer_t *timer;
+    xqc_usec_t min_time = XQC_MAX_UINT64_VALUE;
+
+    if (manager->next_expire_dirty) {
+        for (xqc_timer_type_t type = 0; type < XQC_TIMER_N; ++type) {
+            timer = &manager->timer[type];
+            if (timer->timer_is_set) {
+                min_time = xqc_min(min_time, timer->expire_time);
+            }
+        }
+
+        manager->next_expire_time = (min_time == XQC_MAX_UINT64_VALUE) ? 0 : min_time;
+        manager->next_expire_dirty = XQC_FALSE;
+    }
+
+    return manager->next_expire_time;
+}
+
+/**
+ * the earliest expire time of all timers and gp timers, 0 if no timer is set
+ */
+static inline xqc_usec_t
+xqc_timer_next_expire_time(xqc_timer_manager_t *manager)
+{
+    xqc_usec_t expire_time = xqc_timer_earliest_expire_time(manager);
+    xqc_usec_t gp_expire_time = 0;
+
+    if (manager->gp_timer_wheel) {
+        gp_expire_time = xqc_timer_wheel_next_expire_time(manager->gp_timer_wheel);
+    }
+
+    if (expire_time == 0 || (gp_expire_time != 0 && gp_expire_time < expire_time)) {
+        expire_time = gp_expire_time;
+    }
+
+    return expire_time;
+}
+
 static inline void
 xqc_timer_set(xqc_timer_manager_t *manager, xqc_timer_type_t type, xqc_usec_t now, xqc_usec_t inter_time)
 {
+    xqc_timer_next_expire_remove(manager, type);
     manager->timer[type].timer_is_set = 1;
     manager->timer[type].expire_time = now + inter_time;
+    xqc_timer_next_expire_add(manager, manager->timer[type].expire_time);
     xqc_log(manager->log, XQC_LOG_DEBUG, "|type:%s|expire:%ui|now:%ui|interv:%ui|",
             xqc_timer_type_2_str(type), manager->timer[type].expire_time, now, inter_time);
     xqc_log_event(manager->log, REC_LOSS_TIMER_UPDATED, manager, inter_time, (xqc_int_t) type, (xqc_int_t) XQC_LOG_TIMER_SET);
@@ -193,6 +278,7 @@ xqc_timer_set(xqc_timer_manager_t *manager, xqc_timer_type_t type, xqc_usec_t no
 static inline void
 xqc_timer_unset(xqc_timer_manager_t *manager, xqc_timer_type_t type)
 {
+    xqc_timer_next_expire_remove(manager, type);
     manager->timer[type].timer_is_set = 0;
     manager->timer[type].expire_time = 0;
     xqc_log(manager->log, XQC_LOG_DEBUG, "|type:%s|",
@@ -212,7 +298,9 @@ xqc_timer_update(xqc_timer_manager_t *manager, xqc_timer_type_t type, xqc_usec_t
 
     if (was_set) {
         /* update */
+        xqc_timer_next_expire_remove(manager, type);
         manager->timer[type].expire_time = new_expire;
+        xqc_timer_next_expire_add(manager, new_expire);
         xqc_log(manager->log, XQC_LOG_DEBUG, "|type:%s|new_expire:%ui|now:%ui|",
                 xqc_timer_type_2_str(type), new_expire, xqc_monotonic_timestamp());
 
@@ -222,11 +310,18 @@ xqc_timer_update(xqc_timer_manager_t *manager, xqc_timer_type_t type, xqc_usec_t
 }
 
 
-static inline void
+/**
+ * @return count of timers fired
+ */
+static inline xqc_uint_t
 xqc_timer_expire(xqc_timer_manager_t *manager, xqc_usec_t now)
 {
+    xqc_uint_t fired = 0;
     xqc_timer_t *timer;
-    for (xqc_timer_type_t type = 0; type < XQC_TIMER_N; ++type) {
+    xqc_usec_t expire_time = xqc_timer_earliest_expire_time(manager);
+
+    /* skip the scan of timer[] if none of them is due */
+    for (xqc_timer_type_t type = 0; expire_time != 0 && expire_time <= now && type < XQC_TIMER_N; ++type) {
         timer = &manager->timer[type];
         if (timer->timer_is_set && timer->expire_time <= now) {
             if (type == XQC_TIMER_CONN_IDLE) {
@@ -243,6 +338,7 @@ xqc_timer_expire(xqc_timer_manager_t *manager, xqc_usec_t now)
             xqc_log_event(manager->log, REC_LOSS_TIMER_UPDATED, manager, 0, (xqc_int_t) type, (xqc_int_t) XQC_LOG_TIMER_EXPIRE);
 
             timer->timeout_cb(type, now, timer->user_data);
+            fired++;
 
             /* unset timer if it is not updated in timeout_cb */
             if (timer->expire_time <= now) {
@@ -255,20 +351,33 @@ xqc_timer_expire(xqc_timer_manager_t *manager, xqc_usec_t now)
     }
 
     /* expire gp timer */
-    xqc_list_head_t *pos, *next;
+    if (manager->gp_timer_wheel == NULL
+        || xqc_timer_wheel_count(manager->gp_timer_wheel) == 0)
+    {
+        return fired;
+    }
+
+    xqc_list_head_t expired;
     xqc_gp_timer_t *gp_timer;
 
-    xqc_list_for_each_safe(pos, next, &manager->gp_timer_list) {
-        gp_timer = xqc_list_entry(pos, xqc_gp_timer_t, list);
-        if (gp_timer->timer_is_set && gp_timer->expire_time <= now) {
-            xqc_log(manager->log, XQC_LOG_DEBUG, "|gp_timer_expire|id:%d|name:%s|expire_time:%ui|now:%ui|", 
-                    gp_timer->id, gp_timer->name, gp_timer->expire_time, now);
-            gp_timer->timeout_cb(gp_timer->id, now, gp_timer->user_data);
-            if (gp_timer->expire_time <= now) {
-                xqc_timer_gp_timer_unset(manager, gp_timer->id);
-            }
+    xqc_init_list_head(&expired);
+    xqc_timer_wheel_advance(manager->gp_timer_wheel, now, &expired);
+
+    /* gp timers might be set or unset in timeout_cb, take them out one by one */
+    while (!xqc_list_empty(&expired)) {
+        gp_timer = xqc_list_entry(expired.next, xqc_gp_timer_t, node.list);
+        xqc_list_del_init(&gp_timer->node.list);
+
+        xqc_log(manager->log, XQC_LOG_DEBUG, "|gp_timer_expire|id:%d|name:%s|expire_time:%ui|now:%ui|", 
+                gp_timer->id, gp_timer->name, gp_timer->expire_time, now);
+        gp_timer->timeout_cb(gp_timer->id, now, gp_timer->user_data);
+        fired++;
+        if (gp_timer->expire_time <= now) {
+            xqc_timer_gp_timer_unset(manager, gp_timer->id);
         }
     }
+
+    return fired;
 }
 
 /*
@@ -25,6 +25,9 @@
 #define XQC_MAX_RECEIVE_TIMESTAMPS_EXPONENT     20
 #define XQC_MAX_RECEIVE_TIMESTAMPS_PER_ACK      63
 
+/* draft-ietf-quic-ack-frequency: min_ack_delay of 2^24 microseconds or greater is invalid */
+#define XQC_MAX_MIN_ACK_DELAY               (1 << 24)
+
 static inline uint16_t
 xqc_get_uint16(const uint8_t *p)
 {
@@ -239,6 +242,12 @@ xqc_transport_params_calc_length(const xqc_transport_params_t *params,
         }
     }
 
+    if (params->min_ack_delay) {
+        len += xqc_put_varint_len(XQC_TRANSPORT_PARAM_MIN_ACK_DELAY) +
+               xqc_put_varint_len(xqc_put_varint_len(params->min_ack_delay)) +
+               xqc_put_varint_len(params->min_ack_delay);
+    }
+
     if (params->max_datagram_frame_size) {
         len += xqc_put_varint_len(XQC_TRANSPORT_PARAM_MAX_DATAGRAM_FRAME_SIZE) +
                xqc_put_varint_len(xqc_put_varint_len(params->max_datagram_frame_size)) +
@@ -497,6 +506,10 @@ xqc_encode_transport_params(const xqc_transport_params_t *params,
         }
     }
 
+    if (params->min_ack_delay) {
+        p = xqc_put_varint_param(p, XQC_TRANSPORT_PARAM_MIN_ACK_DELAY, params->min_ack_delay);
+    }
+
     if ((size_t)(p - out) != len) {
         return -XQC_TLS_MALFORMED_TRANSPORT_PARAM;
     }
@@ -892,6 +905,18 @@ static xqc_int_t xqc_decode_receive_timestamps_exponent(xqc_transport_params_t *
     return XQC_OK;
 }
 
+static xqc_int_t
+xqc_decode_min_ack_delay(xqc_transport_params_t *params, xqc_transport_params_type_t exttype,
+    const uint8_t *p, const uint8_t *end, uint64_t param_type, uint64_t param_len)
+{
+    ssize_t nread = xqc_vint_read(p, end, &params->min_ack_delay);
+    /* [ACK-FREQUENCY] values of 2^24 or greater are invalid */
+    if (nread < 0 || params->min_ack_delay >= XQC_MAX_MIN_ACK_DELAY) {
+        return -XQC_TLS_MALFORMED_TRANSPORT_PARAM;
+    }
+    return XQC_OK;
+}
+
 static xqc_int_t
 xqc_decode_max_datagram_frame_size(xqc_transport_params_t *params, xqc_transport_params_type_t exttype,
     const uint8_t *p, const uint8_t *end, uint64_t param_type, uint64_t param_len)
@@ -933,6 +958,7 @@ typedef enum {
     XQC_TP_EXTENDED_ACK_FEATURES_PARSER                ,
     XQC_TP_MAX_RECEIVE_TIMESTAMPS_PER_ACK_PARSER       ,
     XQC_TP_RECEIVE_TIMESTAMPS_EXPONENT_PARSER          ,
+    XQC_TP_DECODER_MIN_ACK_DELAY                       ,
     XQC_TP_DECODER_NO_CRYPTO                           ,
     XQC_TP_DECODER_PMTUD_OPTIONS                       ,
     XQC_TP_DECODER_UNKNOWN                             
@@ -973,6 +999,7 @@ xqc_trans_param_decode_func xqc_trans_param_decode_func_list[] = {
     xqc_decode_extended_ack_features,
     xqc_decode_max_receive_timestamps_per_ack,
     xqc_decode_receive_timestamps_exponent,
+    xqc_decode_min_ack_delay,
     xqc_decode_no_crypto,
     xqc_decode_enable_pmtud,
 };
@@ -1037,6 +1064,9 @@ xqc_trans_param_get_index(uint64_t param_type)
     case XQC_TRANSPORT_PARAM_RECEIVE_TIMESTAMPS_EXPONENT:
         return XQC_TP_RECEIVE_TIMESTAMPS_EXPONENT_PARSER;
 
+    case XQC_TRANSPORT_PARAM_MIN_ACK_DELAY:
+        return XQC_TP_DECODER_MIN_ACK_DELAY;
+
     case XQC_TRANSPORT_PARAM_NO_CRYPTO:
         return XQC_TP_DECODER_NO_CRYPTO;
 
@@ -1148,6 +1178,7 @@ xqc_decode_transport_params(xqc_transport_params_t *params,
     params->extended_ack_features = 0;
     params->max_receive_timestamps_per_ack = 0;
     params->receive_timestamps_exponent = 0;
+    params->min_ack_delay = 0;
 
     params->close_dgram_redundancy = XQC_RED_NOT_USE;
     params->enable_pmtud = 0;
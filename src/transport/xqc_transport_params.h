@@ -91,6 +91,9 @@ typedef enum {
     XQC_TRANSPORT_PARAM_EXTENDED_ACK_FEATURES               = 0xff0a004,
     XQC_TRANSPORT_PARAM_MAX_RECEIVE_TIMESTAMPS_PER_ACK      = 0xff0a002,
     XQC_TRANSPORT_PARAM_RECEIVE_TIMESTAMPS_EXPONENT         = 0xff0a003,
+
+    /* draft-ietf-quic-ack-frequency */
+    XQC_TRANSPORT_PARAM_MIN_ACK_DELAY                       = 0xff04de1b,
 } xqc_transport_param_id_t;
 
 
@@ -191,6 +194,13 @@ typedef struct {
     uint64_t                 extended_ack_features;
     uint64_t                 max_receive_timestamps_per_ack;
     uint64_t                 receive_timestamps_exponent;
+
+    /*
+     * draft-ietf-quic-ack-frequency: the minimum ack delay in microseconds the endpoint is able
+     * to use, and the advertisement of which allows the peer to send ACK_FREQUENCY frames.
+     * 0 if the extension is not supported.
+     */
+    uint64_t                 min_ack_delay;
 } xqc_transport_params_t;
 
 /**
@@ -4,7 +4,7 @@
 
 #include "src/common/xqc_common.h"
 #include "src/common/xqc_malloc.h"
-#include "src/common/xqc_str_hash.h"
+#include "src/common/utils/oa_hash/xqc_oa_hash.h"
 #include "src/common/xqc_hash.h"
 #include "src/common/xqc_log.h"
 #include "src/transport/xqc_utils.h"
@@ -56,20 +56,12 @@ xqc_conns_pq_remove(xqc_pq_t *pq, xqc_connection_t *conn)
 }
 
 int
-xqc_insert_conns_hash(xqc_str_hash_table_t *conns_hash, xqc_connection_t *conn,
+xqc_insert_conns_hash(xqc_oa_hash_table_t *conns_hash, xqc_connection_t *conn,
     const uint8_t *data, size_t len)
 {
-    uint64_t hash = xqc_siphash_get_hash(&conns_hash->siphash_ctx, data, len); 
-    xqc_str_hash_element_t c = {
-        .str    = {
-            .data = (unsigned char *)data,
-            .len = len
-        },
-        .hash   = hash,
-        .value  = conn
-    };
-    
-    if (xqc_str_hash_add(conns_hash, c) != XQC_OK) {
+    uint64_t hash = xqc_oa_hash_get_hash(conns_hash, data, len);
+
+    if (xqc_oa_hash_add(conns_hash, hash, data, len, conn) != XQC_OK) {
         return -XQC_EMALLOC;
     }
 
@@ -77,52 +69,24 @@ xqc_insert_conns_hash(xqc_str_hash_table_t *conns_hash, xqc_connection_t *conn,
 }
 
 int
-xqc_remove_conns_hash(xqc_str_hash_table_t *conns_hash, xqc_connection_t *conn,
+xqc_remove_conns_hash(xqc_oa_hash_table_t *conns_hash, xqc_connection_t *conn,
     const uint8_t *data, size_t len)
 {
-    uint64_t hash = xqc_siphash_get_hash(&conns_hash->siphash_ctx, data, len); 
-    xqc_str_t str = {
-        .data   = (unsigned char *)data,
-        .len    = len,
-    };
+    uint64_t hash = xqc_oa_hash_get_hash(conns_hash, data, len);
 
-    if (xqc_str_hash_delete(conns_hash, hash, str)) {
-        xqc_log(conn->log, XQC_LOG_DEBUG, "|xqc_str_hash_delete error|");
+    if (xqc_oa_hash_delete(conns_hash, hash, data, len)) {
+        xqc_log(conn->log, XQC_LOG_DEBUG, "|xqc_oa_hash_delete error|");
         return -XQC_ECONN_NFOUND;
     }
     return 0;
 }
 
-int
-xqc_insert_conns_addr_hash(xqc_str_hash_table_t *conns_hash, xqc_connection_t *conn,
-    const struct sockaddr *addr, socklen_t addrlen)
-{
-    uint64_t hash = xqc_siphash_get_hash(&conns_hash->siphash_ctx, (const uint8_t *)addr, addrlen); 
-    xqc_str_hash_element_t c = {
-        .str    = {
-            .data = (unsigned char *)addr,
-            .len = addrlen
-        },
-        .hash   = hash,
-        .value  = conn
-    };
-
-    if (xqc_str_hash_add(conns_hash, c) != XQC_OK) {
-        return -XQC_EMALLOC;
-    }
-    return 0;
-}
-
 
 void *
-xqc_find_conns_hash(xqc_str_hash_table_t *conns_hash, xqc_connection_t *conn,
+xqc_find_conns_hash(xqc_oa_hash_table_t *conns_hash, xqc_connection_t *conn,
     const uint8_t *data, size_t len)
 {
-    uint64_t hash = xqc_siphash_get_hash(&conns_hash->siphash_ctx, data, len); 
-    xqc_str_t str = {
-        .data   = (unsigned char *)data,
-        .len    = len,
-    };
+    uint64_t hash = xqc_oa_hash_get_hash(conns_hash, data, len);
 
-    return xqc_str_hash_find(conns_hash, hash, str);
+    return xqc_oa_hash_find(conns_hash, hash, data, len);
 }
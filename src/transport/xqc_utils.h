@@ -23,13 +23,13 @@ xqc_connection_t *xqc_conns_pq_pop_top_conn(xqc_pq_t *pq);
 
 void xqc_conns_pq_remove(xqc_pq_t *pq, xqc_connection_t *conn);
 
-int xqc_insert_conns_hash(xqc_str_hash_table_t *conns_hash,
+int xqc_insert_conns_hash(xqc_oa_hash_table_t *conns_hash,
     xqc_connection_t *conn, const uint8_t *data, size_t len);
 
-int xqc_remove_conns_hash(xqc_str_hash_table_t *conns_hash,
+int xqc_remove_conns_hash(xqc_oa_hash_table_t *conns_hash,
     xqc_connection_t *conn, const uint8_t *data, size_t len);
 
-void *xqc_find_conns_hash(xqc_str_hash_table_t *conns_hash,
+void *xqc_find_conns_hash(xqc_oa_hash_table_t *conns_hash,
     xqc_connection_t *conn, const uint8_t *data, size_t len);
 
 #endif /* _XQC_UTILS_H_INCLUDED_ */
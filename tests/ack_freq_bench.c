@@ -0,0 +1,441 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+/*
+ * in-process bulk transfer benchmark of the ack frequency extension. a server engine sends a
+ * single stream to a client engine through the network emulator, the downlink of which is a
+ * drop-tail bottleneck of the given rate and buffer, and both directions delay datagrams by
+ * half of the rtt. the transfer is run once with the ack rate of RFC 9000, and once with server
+ * asking client for about 4 acks per round trip with ACK_FREQUENCY frames.
+ *
+ * acks are counted as datagrams from client, which carry nothing but ACK frames after the
+ * request. server cpu is the time spent in server engine processing datagrams and timers, which
+ * is dominated by ack processing on a bulk flow. time and goodput are in virtual time.
+ *
+ * usage: ack_freq_bench -s <transfer size in MB> -r <bottleneck rate in Mbps> -t <rtt in ms>
+ *                       -b <bottleneck buffer in packets> -c <cert file> -k <key file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "platform.h"
+#include "xqc_netsim.h"
+
+#ifndef XQC_SYS_WINDOWS
+#include <getopt.h>
+#else
+#include "getopt.h"
+#endif
+
+#define XQC_BENCH_ALPN              "transport"
+#define XQC_BENCH_HOST              "bench.xquic.test"
+#define XQC_BENCH_PKT_SIZE          1500
+#define XQC_BENCH_SEND_BUF_SIZE     (64 * 1024)
+
+/* min_ack_delay advertised by client, and give up a transfer after this virtual time */
+#define XQC_BENCH_MIN_ACK_DELAY     1000
+#define XQC_BENCH_TIMEOUT           600000000
+
+
+typedef struct xqc_bench_ctx_s {
+    xqc_netsim_t           *sim;
+    xqc_engine_t           *cli_engine;
+    xqc_engine_t           *svr_engine;
+
+    /* state of the transfer in progress */
+    uint64_t                size;
+    uint64_t                sent;
+    uint64_t                recvd;
+    int                     requested;
+    int                     done;
+
+    unsigned char           send_buf[XQC_BENCH_SEND_BUF_SIZE];
+    unsigned char           recv_buf[XQC_BENCH_SEND_BUF_SIZE];
+} xqc_bench_ctx_t;
+
+static xqc_bench_ctx_t g_bench;
+
+
+static void
+xqc_bench_write_log(xqc_log_level_t lvl, const void *buf, size_t size, void *user_data)
+{
+}
+
+static int
+xqc_bench_server_accept(xqc_engine_t *engine, xqc_connection_t *conn, const xqc_cid_t *cid,
+    void *user_data)
+{
+    return 0;
+}
+
+static void
+xqc_bench_server_refuse(xqc_engine_t *engine, xqc_connection_t *conn, const xqc_cid_t *cid,
+    void *user_data)
+{
+}
+
+static void
+xqc_bench_save_token(const unsigned char *token, uint32_t token_len, void *user_data)
+{
+}
+
+static void
+xqc_bench_save_string(const char *data, size_t data_len, void *user_data)
+{
+}
+
+static int
+xqc_bench_cert_verify(const unsigned char *certs[], const size_t cert_len[], size_t certs_len,
+    void *user_data)
+{
+    return 0;
+}
+
+static void
+xqc_bench_update_cid(xqc_connection_t *conn, const xqc_cid_t *retire_cid,
+    const xqc_cid_t *new_cid, void *user_data)
+{
+}
+
+static int
+xqc_bench_conn_notify(xqc_connection_t *conn, const xqc_cid_t *cid, void *user_data,
+    void *conn_proto_data)
+{
+    return 0;
+}
+
+
+/* server sends the response until blocked by flow or congestion control */
+static int
+xqc_bench_svr_send(xqc_stream_t *stream)
+{
+    ssize_t ret;
+    size_t size;
+    uint8_t fin;
+
+    while (g_bench.requested && g_bench.sent < g_bench.size) {
+        size = g_bench.size - g_bench.sent;
+        size = size < XQC_BENCH_SEND_BUF_SIZE ? size : XQC_BENCH_SEND_BUF_SIZE;
+        fin = g_bench.sent + size == g_bench.size;
+
+        ret = xqc_stream_send(stream, g_bench.send_buf, size, fin);
+        if (ret == -XQC_EAGAIN) {
+            break;
+
+        } else if (ret < 0) {
+            printf("xqc_stream_send error:%zd\n", ret);
+            return (int)ret;
+        }
+
+        g_bench.sent += ret;
+    }
+
+    return 0;
+}
+
+static int
+xqc_bench_svr_stream_create(xqc_stream_t *stream, void *user_data)
+{
+    xqc_stream_set_user_data(stream, &g_bench);
+    return 0;
+}
+
+static int
+xqc_bench_svr_stream_read(xqc_stream_t *stream, void *user_data)
+{
+    ssize_t ret;
+    uint8_t fin = 0;
+
+    do {
+        ret = xqc_stream_recv(stream, g_bench.recv_buf, sizeof(g_bench.recv_buf), &fin);
+    } while (ret > 0 && !fin);
+
+    if (fin && !g_bench.requested) {
+        g_bench.requested = 1;
+        return xqc_bench_svr_send(stream);
+    }
+
+    return 0;
+}
+
+static int
+xqc_bench_svr_stream_write(xqc_stream_t *stream, void *user_data)
+{
+    return xqc_bench_svr_send(stream);
+}
+
+static int
+xqc_bench_cli_stream_read(xqc_stream_t *stream, void *user_data)
+{
+    ssize_t ret;
+    uint8_t fin = 0;
+
+    do {
+        ret = xqc_stream_recv(stream, g_bench.recv_buf, sizeof(g_bench.recv_buf), &fin);
+        if (ret > 0) {
+            g_bench.recvd += ret;
+        }
+    } while (ret > 0 && !fin);
+
+    if (fin) {
+        g_bench.done = 1;
+        xqc_netsim_stop(g_bench.sim);
+    }
+
+    return 0;
+}
+
+static int
+xqc_bench_stream_notify(xqc_stream_t *stream, void *user_data)
+{
+    return 0;
+}
+
+
+static xqc_engine_t *
+xqc_bench_create_engine(xqc_engine_type_t type, const char *cert_file, const char *key_file)
+{
+    xqc_config_t config;
+    xqc_engine_ssl_config_t ssl_config;
+    xqc_engine_t *engine;
+
+    if (xqc_engine_get_default_config(&config, type) < 0) {
+        return NULL;
+    }
+    config.cfg_log_level = XQC_LOG_ERROR;
+
+    memset(&ssl_config, 0, sizeof(ssl_config));
+    ssl_config.ciphers = XQC_TLS_CIPHERS;
+    ssl_config.groups = XQC_TLS_GROUPS;
+    if (type == XQC_ENGINE_SERVER) {
+        ssl_config.private_key_file = (char *)key_file;
+        ssl_config.cert_file = (char *)cert_file;
+    }
+
+    xqc_engine_callback_t callback = {
+        .log_callbacks = {
+            .xqc_log_write_err = xqc_bench_write_log,
+            .xqc_log_write_stat = xqc_bench_write_log,
+        },
+    };
+
+    xqc_transport_callbacks_t tcbs = {
+        .server_accept = xqc_bench_server_accept,
+        .server_refuse = xqc_bench_server_refuse,
+        .conn_update_cid_notify = xqc_bench_update_cid,
+        .save_token = xqc_bench_save_token,
+        .save_session_cb = xqc_bench_save_string,
+        .save_tp_cb = xqc_bench_save_string,
+        .cert_verify_cb = xqc_bench_cert_verify,
+    };
+
+    /* timers, timestamps and sockets are emulated */
+    xqc_netsim_engine_callbacks(type == XQC_ENGINE_SERVER ? XQC_NETSIM_SERVER : XQC_NETSIM_CLIENT,
+                                &callback, &tcbs);
+
+    engine = xqc_engine_create(type, &config, &ssl_config, &callback, &tcbs, NULL);
+    if (engine == NULL) {
+        return NULL;
+    }
+
+    xqc_app_proto_callbacks_t ap_cbs = {
+        .conn_cbs = {
+            .conn_create_notify = xqc_bench_conn_notify,
+            .conn_close_notify = xqc_bench_conn_notify,
+        },
+        .stream_cbs = {
+            .stream_read_notify = type == XQC_ENGINE_SERVER
+                ? xqc_bench_svr_stream_read : xqc_bench_cli_stream_read,
+            .stream_write_notify = type == XQC_ENGINE_SERVER
+                ? xqc_bench_svr_stream_write : xqc_bench_stream_notify,
+            .stream_create_notify = type == XQC_ENGINE_SERVER
+                ? xqc_bench_svr_stream_create : xqc_bench_stream_notify,
+            .stream_close_notify = xqc_bench_stream_notify,
+        },
+    };
+
+    if (xqc_engine_register_alpn(engine, XQC_BENCH_ALPN, strlen(XQC_BENCH_ALPN),
+                                 &ap_cbs, NULL) != XQC_OK)
+    {
+        xqc_engine_destroy(engine);
+        return NULL;
+    }
+
+    return engine;
+}
+
+/* run a transfer to completion, and close the connection */
+static void
+xqc_bench_run(const char *name, const xqc_conn_settings_t *cli_settings,
+    const xqc_conn_settings_t *svr_settings)
+{
+    const xqc_cid_t *cid;
+    xqc_cid_t cid_copy;
+    xqc_conn_ssl_config_t ssl_cfg;
+    xqc_stream_t *stream;
+    const struct sockaddr *svr_addr;
+    socklen_t svr_addrlen;
+    xqc_netsim_link_stats_t up, down;
+    xqc_usec_t begin, elapsed, svr_us;
+    double mbytes;
+
+    memset(&ssl_cfg, 0, sizeof(ssl_cfg));
+    g_bench.sent = 0;
+    g_bench.recvd = 0;
+    g_bench.requested = 0;
+    g_bench.done = 0;
+    xqc_server_set_conn_settings(g_bench.svr_engine, svr_settings);
+    svr_addr = xqc_netsim_addr(g_bench.sim, XQC_NETSIM_SERVER, 0, &svr_addrlen);
+
+    /* statistics of the emulator accumulate over runs */
+    up = *xqc_netsim_link_stats(g_bench.sim, 0, XQC_NETSIM_UPLINK);
+    down = *xqc_netsim_link_stats(g_bench.sim, 0, XQC_NETSIM_DOWNLINK);
+    svr_us = xqc_netsim_cpu_time(g_bench.sim, XQC_NETSIM_SERVER);
+
+    begin = xqc_netsim_now();
+    cid = xqc_connect(g_bench.cli_engine, cli_settings, NULL, 0, XQC_BENCH_HOST, 0, &ssl_cfg,
+                      svr_addr, svr_addrlen, XQC_BENCH_ALPN, &g_bench);
+    if (cid == NULL) {
+        printf("%-8s xqc_connect error\n", name);
+        return;
+    }
+    memcpy(&cid_copy, cid, sizeof(xqc_cid_t));
+
+    stream = xqc_stream_create(g_bench.cli_engine, &cid_copy, NULL, &g_bench);
+    if (stream == NULL || xqc_stream_send(stream, (unsigned char *)"GET", 3, 1) < 0) {
+        printf("%-8s request error\n", name);
+        return;
+    }
+
+    if (!xqc_netsim_run(g_bench.sim, begin + XQC_BENCH_TIMEOUT)) {
+        printf("%-8s timeout\n", name);
+    }
+
+    elapsed = xqc_netsim_now() - begin;
+    svr_us = xqc_netsim_cpu_time(g_bench.sim, XQC_NETSIM_SERVER) - svr_us;
+    mbytes = g_bench.recvd / 1e6;
+    up.sent = xqc_netsim_link_stats(g_bench.sim, 0, XQC_NETSIM_UPLINK)->sent - up.sent;
+    down.sent = xqc_netsim_link_stats(g_bench.sim, 0, XQC_NETSIM_DOWNLINK)->sent - down.sent;
+    down.queue_dropped = xqc_netsim_link_stats(g_bench.sim, 0, XQC_NETSIM_DOWNLINK)->queue_dropped
+                         - down.queue_dropped;
+
+    printf("%-8s bytes:%"PRIu64" elapsed:%.3fs goodput:%.1fMbps data_pkts:%"PRIu64
+           " dropped:%"PRIu64"\n",
+           name, g_bench.recvd, elapsed / 1e6,
+           elapsed > 0 ? g_bench.recvd * 8.0 / elapsed : 0.0,
+           down.sent, down.queue_dropped);
+
+    printf("%-8s acks:%"PRIu64" acks/s:%.0f data_pkts/ack:%.1f server_cpu:%.1fms"
+           " server_cpu/MB:%.1fus\n",
+           name, up.sent, elapsed > 0 ? up.sent * 1e6 / elapsed : 0.0,
+           up.sent > 0 ? (double)down.sent / up.sent : 0.0,
+           svr_us / 1e3, mbytes > 0 ? svr_us / mbytes : 0.0);
+
+    /* let both engines drain the connection */
+    xqc_conn_close(g_bench.cli_engine, &cid_copy);
+    xqc_netsim_run(g_bench.sim, xqc_netsim_now() + 10000000);
+}
+
+
+static void
+xqc_bench_usage(const char *prog)
+{
+    printf("usage: %s [-s transfer size in MB] [-r bottleneck rate in Mbps] [-t rtt in ms]\n"
+           "    [-b bottleneck buffer in packets, default bdp] [-c cert file] [-k key file]\n",
+           prog);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ch;
+    uint64_t size_mb = 50, rate_mbps = 100, rtt_ms = 40, buffer = 0;
+    const char *cert_file = "./server.crt";
+    const char *key_file = "./server.key";
+
+    memset(&g_bench, 0, sizeof(g_bench));
+
+    while ((ch = getopt(argc, argv, "s:r:t:b:c:k:h")) != -1) {
+        switch (ch) {
+        case 's':
+            size_mb = strtoull(optarg, NULL, 10);
+            break;
+        case 'r':
+            rate_mbps = strtoull(optarg, NULL, 10);
+            break;
+        case 't':
+            rtt_ms = strtoull(optarg, NULL, 10);
+            break;
+        case 'b':
+            buffer = strtoull(optarg, NULL, 10);
+            break;
+        case 'c':
+            cert_file = optarg;
+            break;
+        case 'k':
+            key_file = optarg;
+            break;
+        default:
+            xqc_bench_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    if (buffer == 0) {
+        buffer = rate_mbps * rtt_ms * 1000 / 8 / XQC_BENCH_PKT_SIZE;
+    }
+
+    xqc_netsim_link_conf_t up = {
+        .delay = rtt_ms * 1000 / 2,
+    };
+    xqc_netsim_link_conf_t down = {
+        .rate = rate_mbps * 1000000,
+        .delay = rtt_ms * 1000 / 2,
+        .queue_limit = buffer * XQC_BENCH_PKT_SIZE,
+    };
+
+    g_bench.size = size_mb * 1000000;
+    g_bench.sim = xqc_netsim_create(1);
+    if (g_bench.sim == NULL || xqc_netsim_add_path(g_bench.sim, &up, &down) < 0) {
+        printf("create network emulator error\n");
+        return -1;
+    }
+
+    g_bench.svr_engine = xqc_bench_create_engine(XQC_ENGINE_SERVER, cert_file, key_file);
+    g_bench.cli_engine = xqc_bench_create_engine(XQC_ENGINE_CLIENT, NULL, NULL);
+    if (g_bench.svr_engine == NULL || g_bench.cli_engine == NULL) {
+        printf("create engine error\n");
+        return -1;
+    }
+    xqc_netsim_set_engine(g_bench.sim, XQC_NETSIM_SERVER, g_bench.svr_engine, &g_bench);
+    xqc_netsim_set_engine(g_bench.sim, XQC_NETSIM_CLIENT, g_bench.cli_engine, &g_bench);
+
+    printf("transfer:%"PRIu64"MB rate:%"PRIu64"Mbps rtt:%"PRIu64"ms buffer:%"PRIu64"pkts\n",
+           size_mb, rate_mbps, rtt_ms, buffer);
+
+    xqc_conn_settings_t cli_settings, svr_settings;
+    memset(&cli_settings, 0, sizeof(cli_settings));
+    cli_settings.cong_ctrl_callback = xqc_cubic_cb;
+    cli_settings.proto_version = XQC_VERSION_V1;
+    svr_settings = cli_settings;
+
+    /* ack every other packet as RFC 9000 */
+    xqc_bench_run("default", &cli_settings, &svr_settings);
+
+    /* client supports the extension, and server asks for fewer acks */
+    cli_settings.min_ack_delay = XQC_BENCH_MIN_ACK_DELAY;
+    svr_settings.ack_frequency_on = 1;
+    xqc_bench_run("ack_freq", &cli_settings, &svr_settings);
+
+    xqc_engine_destroy(g_bench.cli_engine);
+    xqc_engine_destroy(g_bench.svr_engine);
+    xqc_netsim_destroy(g_bench.sim);
+    return 0;
+}
@@ -0,0 +1,371 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+/*
+ * packet level simulation of flows through a single bottleneck, comparing the queue delay of
+ * classic congestion control behind a drop-tail buffer with L4S Prague behind a step marking
+ * AQM. packets are serialized at the bottleneck rate, wait in a buffer of -b ms, and are acked
+ * one base rtt after leaving it. the AQM marks ECN capable packets CE if they have to wait
+ * longer than -k us. a dropped packet is declared lost when a later packet of the same flow is
+ * acked. the queue delay of every packet is sampled after a warmup of a quarter of the run.
+ *
+ * usage: aqm_bench -r <rate in Mbps> -t <base rtt in ms> -d <duration in s>
+ *                  -k <marking threshold in us> -b <buffer in ms>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/congestion_control/xqc_prague.h"
+#include "src/congestion_control/xqc_cubic.h"
+#include "src/transport/xqc_send_ctl.h"
+#include "src/transport/xqc_packet_out.h"
+#include "src/transport/xqc_packet.h"
+#include "src/common/xqc_time.h"
+#include "src/common/xqc_malloc.h"
+
+#ifndef XQC_SYS_WINDOWS
+#include <getopt.h>
+#else
+#include "getopt.h"
+#endif
+
+#define XQC_AQM_MSS             XQC_MSS
+#define XQC_AQM_MAX_FLOWS       4
+#define XQC_AQM_MAX_PKTS        65536
+
+
+typedef struct xqc_aqm_pkt_s {
+    xqc_usec_t                      sent_time;
+    xqc_usec_t                      ack_time;
+    uint8_t                         dropped;
+    uint8_t                         ce;
+} xqc_aqm_pkt_t;
+
+typedef struct xqc_aqm_flow_s {
+    const xqc_cong_ctrl_callback_t *cb;
+    void                           *cc;
+    xqc_send_ctl_t                  ctl;        /* only the ECN state is read by controllers */
+    xqc_usec_t                      rtt;
+    uint8_t                         ecn;
+
+    xqc_aqm_pkt_t                  *pkts;
+    uint64_t                        head;
+    uint64_t                        tail;
+    xqc_usec_t                      recovery_start;
+
+    uint64_t                        delivered;
+    uint64_t                        lost;
+    uint64_t                        ce;
+} xqc_aqm_flow_t;
+
+typedef struct xqc_aqm_link_s {
+    double                          tx_time;    /* serialization time of a packet in us */
+    double                          departure;  /* the time the queue drains */
+    uint64_t                        buf_pkts;
+    xqc_usec_t                      mark_thresh;
+
+    uint32_t                       *samples;    /* queue delay of packets in us */
+    uint64_t                        sample_cnt;
+    uint64_t                        sample_max;
+} xqc_aqm_link_t;
+
+typedef struct xqc_aqm_conf_s {
+    uint64_t                        rate_mbps;
+    xqc_usec_t                      rtt;
+    xqc_usec_t                      duration;
+    xqc_usec_t                      mark_thresh;
+    xqc_usec_t                      buf_time;
+} xqc_aqm_conf_t;
+
+
+static void
+xqc_aqm_flow_init(xqc_aqm_flow_t *flow, const xqc_cong_ctrl_callback_t *cb, uint8_t ecn,
+    xqc_usec_t rtt)
+{
+    xqc_cc_params_t params;
+
+    memset(flow, 0, sizeof(xqc_aqm_flow_t));
+    memset(&params, 0, sizeof(params));
+
+    flow->cb = cb;
+    flow->ecn = ecn;
+    flow->rtt = rtt;
+    flow->ctl.ctl_ecn_state = ecn ? XQC_ECN_STATE_CAPABLE : XQC_ECN_STATE_DISABLED;
+    flow->cc = xqc_calloc(1, cb->xqc_cong_ctl_size());
+    flow->pkts = xqc_calloc(XQC_AQM_MAX_PKTS, sizeof(xqc_aqm_pkt_t));
+    cb->xqc_cong_ctl_init(flow->cc, &flow->ctl, params);
+}
+
+static void
+xqc_aqm_flow_destroy(xqc_aqm_flow_t *flow)
+{
+    xqc_free(flow->cc);
+    xqc_free(flow->pkts);
+}
+
+static void
+xqc_aqm_send(xqc_aqm_link_t *link, xqc_aqm_flow_t *flow, xqc_usec_t now, uint8_t sampled)
+{
+    xqc_aqm_pkt_t *pkt;
+    double qdelay;
+
+    while ((flow->tail - flow->head) * XQC_AQM_MSS < flow->cb->xqc_cong_ctl_get_cwnd(flow->cc)
+           && flow->tail - flow->head < XQC_AQM_MAX_PKTS)
+    {
+        pkt = &flow->pkts[flow->tail++ % XQC_AQM_MAX_PKTS];
+        pkt->sent_time = now;
+        pkt->ce = 0;
+
+        qdelay = link->departure > now ? link->departure - now : 0;
+        pkt->dropped = qdelay / link->tx_time >= link->buf_pkts;
+        if (pkt->dropped) {
+            continue;
+        }
+
+        pkt->ce = flow->ecn && link->mark_thresh > 0 && qdelay > link->mark_thresh;
+        link->departure = (link->departure > now ? link->departure : now) + link->tx_time;
+        pkt->ack_time = (xqc_usec_t)link->departure + flow->rtt;
+
+        if (sampled && link->sample_cnt < link->sample_max) {
+            link->samples[link->sample_cnt++] = (uint32_t)qdelay;
+        }
+    }
+}
+
+/* the first packet which is not dropped, or tail if none */
+static uint64_t
+xqc_aqm_next_ack(xqc_aqm_flow_t *flow)
+{
+    uint64_t next;
+    for (next = flow->head;
+         next < flow->tail && flow->pkts[next % XQC_AQM_MAX_PKTS].dropped;
+         next++);
+    return next;
+}
+
+static void
+xqc_aqm_on_ack(xqc_aqm_flow_t *flow, uint64_t next, xqc_usec_t now, uint8_t sampled)
+{
+    xqc_aqm_pkt_t *pkt;
+    xqc_packet_out_t po;
+
+    memset(&po, 0, sizeof(po));
+    po.po_used_size = XQC_AQM_MSS;
+
+    /*
+     * cubic detects recovery by comparing sent time with the wall clock, which is far behind
+     * the simulated one, hence packets sent before recovery are filtered out here.
+     */
+    for (; flow->head <= next; flow->head++) {
+        pkt = &flow->pkts[flow->head % XQC_AQM_MAX_PKTS];
+        if (pkt->dropped) {
+            flow->lost++;
+            if (pkt->sent_time > flow->recovery_start) {
+                flow->cb->xqc_cong_ctl_on_lost(flow->cc, pkt->sent_time);
+                flow->recovery_start = now;
+            }
+            continue;
+        }
+
+        if (sampled) {
+            flow->delivered += XQC_AQM_MSS;
+        }
+
+        if (pkt->sent_time > flow->recovery_start) {
+            po.po_sent_time = pkt->sent_time;
+            flow->cb->xqc_cong_ctl_on_ack(flow->cc, &po, now);
+        }
+
+        if (pkt->ce) {
+            flow->ce++;
+            if (flow->cb->xqc_cong_ctl_on_ecn_ce) {
+                flow->cb->xqc_cong_ctl_on_ecn_ce(flow->cc, pkt->sent_time, 1, 1);
+            }
+        }
+    }
+}
+
+static int
+xqc_aqm_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static uint32_t
+xqc_aqm_percentile(xqc_aqm_link_t *link, uint32_t pct)
+{
+    if (link->sample_cnt == 0) {
+        return 0;
+    }
+    return link->samples[(link->sample_cnt - 1) * pct / 100];
+}
+
+static void
+xqc_aqm_run(const char *name, const xqc_aqm_conf_t *conf, xqc_aqm_flow_t *flows, int flow_cnt)
+{
+    xqc_aqm_link_t link;
+    xqc_usec_t start, now, warmup, next_time;
+    uint64_t next, next_pkt = 0, delivered = 0, lost = 0, ce = 0;
+    xqc_aqm_flow_t *next_flow;
+    uint8_t sampled;
+    int i;
+
+    memset(&link, 0, sizeof(link));
+    link.tx_time = (double)XQC_AQM_MSS * 8 / conf->rate_mbps;
+    link.buf_pkts = xqc_max((uint64_t)(conf->buf_time / link.tx_time), 1);
+    link.mark_thresh = conf->mark_thresh;
+    link.sample_max = (uint64_t)(conf->duration / link.tx_time) + XQC_AQM_MAX_PKTS * flow_cnt;
+    link.samples = xqc_calloc(link.sample_max, sizeof(uint32_t));
+
+    start = now = xqc_monotonic_timestamp();
+    warmup = start + conf->duration / 4;
+    link.departure = now;
+
+    while (now - start < conf->duration) {
+        sampled = now >= warmup;
+        for (i = 0; i < flow_cnt; i++) {
+            xqc_aqm_send(&link, &flows[i], now, sampled);
+        }
+
+        /* move to the earliest ack of all flows */
+        next_flow = NULL;
+        next_time = 0;
+        for (i = 0; i < flow_cnt; i++) {
+            next = xqc_aqm_next_ack(&flows[i]);
+            if (next == flows[i].tail) {
+                continue;
+            }
+
+            if (next_flow == NULL
+                || flows[i].pkts[next % XQC_AQM_MAX_PKTS].ack_time < next_time)
+            {
+                next_flow = &flows[i];
+                next_pkt = next;
+                next_time = flows[i].pkts[next % XQC_AQM_MAX_PKTS].ack_time;
+            }
+        }
+
+        if (next_flow == NULL) {
+            break;
+        }
+
+        now = next_time;
+        xqc_aqm_on_ack(next_flow, next_pkt, now, now >= warmup);
+    }
+
+    qsort(link.samples, link.sample_cnt, sizeof(uint32_t), xqc_aqm_cmp);
+
+    printf("%-24s qdelay p50:%"PRIu32"us p90:%"PRIu32"us p99:%"PRIu32"us max:%"PRIu32"us",
+           name, xqc_aqm_percentile(&link, 50), xqc_aqm_percentile(&link, 90),
+           xqc_aqm_percentile(&link, 99), xqc_aqm_percentile(&link, 100));
+
+    for (i = 0; i < flow_cnt; i++) {
+        delivered += flows[i].delivered;
+        lost += flows[i].lost;
+        ce += flows[i].ce;
+    }
+
+    printf(" utilization:%.3f lost:%"PRIu64" ce:%"PRIu64"\n",
+           (double)delivered * 8 / conf->rate_mbps / (conf->duration - conf->duration / 4),
+           lost, ce);
+
+    if (flow_cnt > 1) {
+        printf("%-24s", "");
+        for (i = 0; i < flow_cnt; i++) {
+            printf(" rtt:%"PRIu64"ms rate:%.2fMbps", flows[i].rtt / 1000,
+                   (double)flows[i].delivered * 8 / (conf->duration - conf->duration / 4));
+        }
+        printf("\n");
+    }
+
+    for (i = 0; i < flow_cnt; i++) {
+        xqc_aqm_flow_destroy(&flows[i]);
+    }
+    xqc_free(link.samples);
+}
+
+static void
+xqc_aqm_run_single(const char *name, const xqc_aqm_conf_t *conf,
+    const xqc_cong_ctrl_callback_t *cb, uint8_t ecn)
+{
+    xqc_aqm_flow_t flow;
+    xqc_aqm_flow_init(&flow, cb, ecn, conf->rtt);
+    xqc_aqm_run(name, conf, &flow, 1);
+}
+
+/* a flow with the base rtt and one with a quarter of it share the bottleneck */
+static void
+xqc_aqm_run_mixed_rtt(const char *name, const xqc_aqm_conf_t *conf,
+    const xqc_cong_ctrl_callback_t *cb, uint8_t ecn)
+{
+    xqc_aqm_flow_t flows[2];
+    xqc_aqm_flow_init(&flows[0], cb, ecn, conf->rtt);
+    xqc_aqm_flow_init(&flows[1], cb, ecn, xqc_max(conf->rtt / 4, 1));
+    xqc_aqm_run(name, conf, flows, 2);
+}
+
+
+static void
+xqc_aqm_usage(const char *prog)
+{
+    printf("usage: %s [-r rate in Mbps] [-t base rtt in ms] [-d duration in s]\n"
+           "    [-k marking threshold in us] [-b buffer in ms]\n", prog);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ch;
+    xqc_aqm_conf_t conf = {
+        .rate_mbps      = 50,
+        .rtt            = 20000,
+        .duration       = 30000000,
+        .mark_thresh    = 1000,
+        .buf_time       = 100000,
+    };
+    xqc_aqm_conf_t droptail;
+
+    while ((ch = getopt(argc, argv, "r:t:d:k:b:h")) != -1) {
+        switch (ch) {
+        case 'r':
+            conf.rate_mbps = xqc_max(strtoull(optarg, NULL, 10), 1);
+            break;
+        case 't':
+            conf.rtt = strtoull(optarg, NULL, 10) * 1000;
+            break;
+        case 'd':
+            conf.duration = xqc_max(strtoull(optarg, NULL, 10), 1) * 1000000;
+            break;
+        case 'k':
+            conf.mark_thresh = strtoull(optarg, NULL, 10);
+            break;
+        case 'b':
+            conf.buf_time = strtoull(optarg, NULL, 10) * 1000;
+            break;
+        default:
+            xqc_aqm_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    printf("rate:%"PRIu64"Mbps rtt:%"PRIu64"ms buffer:%"PRIu64"ms marking threshold:%"PRIu64"us\n",
+           conf.rate_mbps, conf.rtt / 1000, conf.buf_time / 1000, conf.mark_thresh);
+
+    droptail = conf;
+    droptail.mark_thresh = 0;
+
+    xqc_aqm_run_single("cubic droptail", &droptail, &xqc_cubic_cb, 0);
+    xqc_aqm_run_single("prague no-ecn droptail", &droptail, &xqc_prague_cb, 0);
+    xqc_aqm_run_single("prague l4s step", &conf, &xqc_prague_cb, 1);
+
+    xqc_aqm_run_mixed_rtt("cubic droptail x2", &droptail, &xqc_cubic_cb, 0);
+    xqc_aqm_run_mixed_rtt("prague l4s step x2", &conf, &xqc_prague_cb, 1);
+
+    return 0;
+}
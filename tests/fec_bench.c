@@ -0,0 +1,918 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+/*
+ * benchmark of the fec schemes. blocks of K random source symbols of T bytes are encoded into
+ * R repair symbols, sent through an erasure channel, and decoded if any source symbol is lost.
+ * every combination of K, R and T which a scheme supports, within the block caps of the scheme,
+ * is run for -n blocks with random loss and with Gilbert-Elliott burst loss of the same average
+ * rate. the channel is seeded alike for every scheme, so all schemes see the same losses for the
+ * same K and R.
+ *
+ * schemes are driven by the coding they are built on rather than by their callbacks, which
+ * keep the blocks of a connection and pass recovered symbols to frame processing:
+ *   xor        parity of xqc_xor_code_one_symbol, one repair symbol
+ *   rs         reed-solomon with the generator matrix of xqc_build_generator_matrix, decoded
+ *              by inverting the rows received as xqc_reed_solomon_decode does, K <= 10
+ *   rs16       reed-solomon over GF(2^16) of xqc_rs16_code_one_symbol and
+ *              xqc_rs16_decode_symbols, T is even, K <= 255 and R <= 64
+ *   pkm        masks of xqc_packet_mask_init_one from the random table, decoded by peeling
+ *              one symbol per repair symbol as the cc decoder does, R <= K
+ *   pkm_burst  the same with the burst table
+ *   raptorq    encoder and decoder objects of xqc_fec_codec over raptorQ_impl_c, kept
+ *              across the blocks of a run as xqc_fountain.c does, T is a multiple of 4
+ *
+ * throughput is of source bytes, latency is per block, and decode figures only cover blocks
+ * with source loss. allocations per block are those made through xqc_malloc, counted when xquic
+ * is built with XQC_ENABLE_ALLOC_COUNT, and not reported for raptorq whose library allocates
+ * with libc directly.
+ * recovery is the share of blocks with source loss that are fully recovered, residual loss is
+ * the share of source symbols still lost after decoding. with -o, each run is also appended to
+ * the file as a line of json, so that results can be tracked over time.
+ *
+ * usage: fec_bench -k <K list> -r <R list> -t <T list> -l <loss rate> -b <mean burst length>
+ *                  -n <blocks> -s <scheme> -e <seed> -o <json file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_fec.h"
+#include "src/transport/fec_schemes/xqc_galois_calculation.h"
+#include "src/common/xqc_malloc.h"
+
+#ifdef XQC_ENABLE_XOR
+#include "src/transport/fec_schemes/xqc_xor.h"
+#endif
+#ifdef XQC_ENABLE_RSC
+#include "src/transport/fec_schemes/xqc_reed_solomon.h"
+#endif
+#ifdef XQC_ENABLE_RS16
+#include "src/transport/fec_schemes/xqc_reed_solomon16.h"
+#endif
+#ifdef XQC_ENABLE_PKM
+#include "src/transport/fec_schemes/xqc_packet_mask.h"
+#endif
+#ifdef XQC_ENABLE_FOUNTAIN
+#include "src/transport/xqc_fec_codec.h"
+#endif
+
+#ifndef XQC_SYS_WINDOWS
+#include <getopt.h>
+#else
+#include "getopt.h"
+#endif
+
+/* room for the largest block of any scheme, each scheme is held to its own caps */
+#define XQC_FEC_BENCH_MAX_K         XQC_FEC_RS16_MAX_SYMBOL_NUM_PBLOCK
+#define XQC_FEC_BENCH_MAX_R         XQC_REPAIR_LEN
+#define XQC_FEC_BENCH_MAX_LIST      16
+
+
+typedef struct xqc_fec_bench_blk_s {
+    int                 K;
+    int                 R;
+    size_t              T;
+    unsigned char      *src[XQC_FEC_BENCH_MAX_K];
+    unsigned char      *rpr[XQC_FEC_BENCH_MAX_R];
+
+    /* source symbols at receiver, lost ones are zeroed and recovered in place */
+    unsigned char      *recv[XQC_FEC_BENCH_MAX_K];
+
+    /* a byte for each lost symbol, K + i for repair symbol i */
+    uint8_t             lost[XQC_FEC_BENCH_MAX_K + XQC_FEC_BENCH_MAX_R];
+} xqc_fec_bench_blk_t;
+
+typedef struct xqc_fec_bench_scheme_s {
+    const char         *name;
+    xqc_fec_schemes_e   scheme;
+    xqc_bool_t        (*support)(int K, int R, size_t T);
+
+    /* called once for each run, before the first block */
+    xqc_int_t         (*init)(xqc_fec_bench_blk_t *blk, int param);
+    xqc_int_t         (*encode)(xqc_fec_bench_blk_t *blk);
+
+    /* XQC_OK if all lost source symbols are recovered */
+    xqc_int_t         (*decode)(xqc_fec_bench_blk_t *blk);
+    int                 param;
+
+    /* allocations are made inside a library with libc, out of sight of xqc_alloc_count */
+    xqc_bool_t          libc_allocs;
+} xqc_fec_bench_scheme_t;
+
+typedef struct xqc_fec_bench_channel_s {
+    uint64_t            rand;
+    double              loss;
+
+    /* Gilbert-Elliott burst loss with certain loss in bad state, enabled if ge_p is not 0 */
+    double              ge_p;
+    double              ge_r;
+    xqc_bool_t          bad;
+} xqc_fec_bench_channel_t;
+
+typedef struct xqc_fec_bench_result_s {
+    uint64_t            blocks;
+    uint64_t            decoded;        /* blocks with source loss */
+    uint64_t            recovered;
+    uint64_t            corrupted;      /* reported recovered, but not equal to the source */
+    uint64_t            src_lost;
+    uint64_t            src_residual;
+    uint64_t            enc_ns;
+    uint64_t            dec_ns;
+    uint64_t            enc_allocs;
+    uint64_t            dec_allocs;
+    uint64_t           *dec_samples;
+} xqc_fec_bench_result_t;
+
+
+#ifdef XQC_ENABLE_ALLOC_COUNT
+#define xqc_fec_bench_allocs()      ((uint64_t)xqc_alloc_count)
+#else
+#define xqc_fec_bench_allocs()      0
+#endif
+
+
+static uint64_t
+xqc_fec_bench_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* splitmix64 */
+static uint64_t
+xqc_fec_bench_rand(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static double
+xqc_fec_bench_uniform(uint64_t *state)
+{
+    return (xqc_fec_bench_rand(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void
+xqc_fec_bench_fill(uint64_t *state, unsigned char *buf, size_t size)
+{
+    uint64_t r;
+    size_t i;
+
+    for (i = 0; i < size; i += sizeof(r)) {
+        r = xqc_fec_bench_rand(state);
+        memcpy(buf + i, &r, xqc_min(sizeof(r), size - i));
+    }
+}
+
+static xqc_bool_t
+xqc_fec_bench_drop(xqc_fec_bench_channel_t *ch)
+{
+    if (ch->ge_p > 0) {
+        if (xqc_fec_bench_uniform(&ch->rand) < (ch->bad ? ch->ge_r : ch->ge_p)) {
+            ch->bad = !ch->bad;
+        }
+        return ch->bad;
+    }
+    return xqc_fec_bench_uniform(&ch->rand) < ch->loss;
+}
+
+static xqc_bool_t
+xqc_fec_bench_is_lost(xqc_fec_bench_blk_t *blk, int i)
+{
+    return blk->lost[i];
+}
+
+
+#ifdef XQC_ENABLE_XOR
+
+static xqc_bool_t
+xqc_fec_bench_xor_support(int K, int R, size_t T)
+{
+    return R == 1;
+}
+
+static xqc_int_t
+xqc_fec_bench_xor_init(xqc_fec_bench_blk_t *blk, int param)
+{
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_xor_encode(xqc_fec_bench_blk_t *blk)
+{
+    xqc_memset(blk->rpr[0], 0, blk->T);
+    for (int i = 0; i < blk->K; i++) {
+        xqc_xor_code_one_symbol(blk->src[i], blk->rpr[0], blk->T);
+    }
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_xor_decode(xqc_fec_bench_blk_t *blk)
+{
+    int i, miss = -1;
+
+    for (i = 0; i < blk->K; i++) {
+        if (xqc_fec_bench_is_lost(blk, i)) {
+            if (miss >= 0) {
+                return -XQC_EFEC_SCHEME_ERROR;
+            }
+            miss = i;
+        }
+    }
+    if (xqc_fec_bench_is_lost(blk, blk->K)) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    xqc_memcpy(blk->recv[miss], blk->rpr[0], blk->T);
+    for (i = 0; i < blk->K; i++) {
+        if (i != miss) {
+            xqc_xor_code_one_symbol(blk->recv[i], blk->recv[miss], blk->T);
+        }
+    }
+    return XQC_OK;
+}
+
+#endif
+
+#ifdef XQC_ENABLE_RSC
+
+static unsigned char g_rs_gm[2 * XQC_RSM_COL][XQC_RSM_COL];
+
+static xqc_bool_t
+xqc_fec_bench_rs_support(int K, int R, size_t T)
+{
+    /* the same limit as xqc_reed_solomon_init */
+    return K <= XQC_MAX_RPR_KEY_SIZE;
+}
+
+static xqc_int_t
+xqc_fec_bench_rs_init(xqc_fec_bench_blk_t *blk, int param)
+{
+    xqc_build_generator_matrix(blk->K, blk->K + blk->R, g_rs_gm);
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_rs_encode(xqc_fec_bench_blk_t *blk)
+{
+    xqc_int_t ret;
+
+    /* source symbols are coded one by one as they are sent */
+    for (int i = 0; i < blk->K; i++) {
+        ret = xqc_rs_code_one_symbol(g_rs_gm + blk->K, blk->src[i], blk->rpr, blk->R, blk->T, i);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+    }
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_rs_decode(xqc_fec_bench_blk_t *blk)
+{
+    unsigned char gm[XQC_RSM_COL][XQC_RSM_COL], rows[XQC_RSM_COL][XQC_RSM_COL];
+    unsigned char *inputs[XQC_RSM_COL], *outputs[XQC_RSM_COL];
+    int i, n, lost;
+
+    /* rows of the first K symbols received, which are unit rows for source symbols */
+    xqc_memset(gm, 0, sizeof(gm));
+    for (i = 0, n = 0; i < blk->K + blk->R && n < blk->K; i++) {
+        if (xqc_fec_bench_is_lost(blk, i)) {
+            continue;
+        }
+        if (i < blk->K) {
+            gm[n][i] = 1;
+            inputs[n] = blk->recv[i];
+
+        } else {
+            xqc_memcpy(gm[n], g_rs_gm[i], blk->K);
+            inputs[n] = blk->rpr[i - blk->K];
+        }
+        n++;
+    }
+    if (n < blk->K || xqc_invert_matrix(blk->K, blk->K, gm) != XQC_OK) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    for (i = 0, lost = 0; i < blk->K; i++) {
+        if (xqc_fec_bench_is_lost(blk, i)) {
+            xqc_memcpy(rows[lost], gm[i], blk->K);
+            outputs[lost++] = blk->recv[i];
+        }
+    }
+    return xqc_rs_code_symbols(rows, inputs, blk->K, outputs, lost, blk->T);
+}
+
+#endif
+
+#ifdef XQC_ENABLE_RS16
+
+static xqc_bool_t
+xqc_fec_bench_rs16_support(int K, int R, size_t T)
+{
+    /* odd symbols would take one more byte for repair symbols */
+    return T % 2 == 0;
+}
+
+static xqc_int_t
+xqc_fec_bench_rs16_init(xqc_fec_bench_blk_t *blk, int param)
+{
+    xqc_gf16_init();
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_rs16_encode(xqc_fec_bench_blk_t *blk)
+{
+    xqc_int_t ret;
+
+    for (int j = 0; j < blk->R; j++) {
+        xqc_memset(blk->rpr[j], 0, blk->T);
+    }
+    for (int i = 0; i < blk->K; i++) {
+        ret = xqc_rs16_code_one_symbol(blk->src[i], blk->T, i, blk->rpr, blk->R);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+    }
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_rs16_decode(xqc_fec_bench_blk_t *blk)
+{
+    unsigned char *src[XQC_FEC_BENCH_MAX_K], *rpr[XQC_FEC_BENCH_MAX_R], *outputs[XQC_FEC_BENCH_MAX_R];
+    xqc_int_t rows[XQC_FEC_BENCH_MAX_R];
+    int i, lost;
+
+    for (i = 0, lost = 0; i < blk->K; i++) {
+        src[i] = xqc_fec_bench_is_lost(blk, i) ? NULL : blk->recv[i];
+        if (src[i] == NULL) {
+            if (lost == blk->R) {
+                return -XQC_EFEC_SCHEME_ERROR;
+            }
+            outputs[lost++] = blk->recv[i];
+        }
+    }
+    for (i = 0; i < blk->R; i++) {
+        rpr[i] = xqc_fec_bench_is_lost(blk, blk->K + i) ? NULL : blk->rpr[i];
+        rows[i] = i;
+    }
+    return xqc_rs16_decode_symbols(src, blk->K, rpr, rows, blk->R, outputs, blk->T);
+}
+
+#endif
+
+#ifdef XQC_ENABLE_PKM
+
+static uint8_t g_pkm_mask[XQC_REPAIR_LEN][XQC_MAX_RPR_KEY_SIZE];
+
+static xqc_bool_t
+xqc_fec_bench_pkm_support(int K, int R, size_t T)
+{
+    /* the same limits as xqc_packet_mask_init_one */
+    return K <= XQC_MAX_MASK_SIZE && R <= K;
+}
+
+static xqc_int_t
+xqc_fec_bench_pkm_init(xqc_fec_bench_blk_t *blk, int param)
+{
+    xqc_connection_t *conn;
+    xqc_int_t ret = XQC_OK;
+
+    /* masks are built from the settings and fec_ctl of a connection, a stub does */
+    conn = xqc_calloc(1, sizeof(xqc_connection_t));
+    if (conn == NULL) {
+        return -XQC_EMALLOC;
+    }
+    conn->fec_ctl = xqc_calloc(1, sizeof(xqc_fec_ctl_t));
+    if (conn->fec_ctl == NULL) {
+        xqc_free(conn);
+        return -XQC_EMALLOC;
+    }
+
+    conn->conn_settings.enable_encode_fec = 1;
+    conn->conn_settings.fec_params.fec_max_symbol_num_per_block = blk->K;
+    conn->conn_settings.fec_params.fec_packet_mask_mode = param;
+    conn->fec_ctl->fec_send_required_repair_num[XQC_DEFAULT_SIZE_REQ] = blk->R;
+    xqc_packet_mask_init_one(conn, XQC_DEFAULT_SIZE_REQ);
+
+    if (!conn->conn_settings.enable_encode_fec) {
+        ret = -XQC_EPARAM;
+
+    } else {
+        xqc_memcpy(g_pkm_mask, conn->fec_ctl->fec_send_decode_matrix[XQC_DEFAULT_SIZE_REQ],
+                   sizeof(g_pkm_mask));
+    }
+
+    xqc_free(conn->fec_ctl);
+    xqc_free(conn);
+    return ret;
+}
+
+static xqc_bool_t
+xqc_fec_bench_pkm_covers(int rpr, int src)
+{
+    return (g_pkm_mask[rpr][src / 8] >> (7 - src % 8)) & 1;
+}
+
+static xqc_int_t
+xqc_fec_bench_pkm_encode(xqc_fec_bench_blk_t *blk)
+{
+    int i, j;
+
+    for (j = 0; j < blk->R; j++) {
+        xqc_memset(blk->rpr[j], 0, blk->T);
+    }
+    for (i = 0; i < blk->K; i++) {
+        for (j = 0; j < blk->R; j++) {
+            if (xqc_fec_bench_pkm_covers(j, i)) {
+                xqc_xor_code_one_symbol(blk->src[i], blk->rpr[j], blk->T);
+            }
+        }
+    }
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_pkm_decode(xqc_fec_bench_blk_t *blk)
+{
+    uint8_t src_lost[XQC_FEC_BENCH_MAX_K];
+    xqc_bool_t progress;
+    int i, j, cnt, miss, remain;
+
+    remain = 0;
+    for (i = 0; i < blk->K; i++) {
+        src_lost[i] = blk->lost[i];
+        remain += src_lost[i];
+    }
+
+    /* a repair symbol recovers the source symbol it covers if the others are there */
+    do {
+        progress = XQC_FALSE;
+        for (j = 0; j < blk->R && remain; j++) {
+            if (xqc_fec_bench_is_lost(blk, blk->K + j)) {
+                continue;
+            }
+
+            cnt = 0;
+            miss = -1;
+            for (i = 0; i < blk->K; i++) {
+                if (xqc_fec_bench_pkm_covers(j, i) && src_lost[i]) {
+                    cnt++;
+                    miss = i;
+                }
+            }
+            if (cnt != 1) {
+                continue;
+            }
+
+            xqc_memcpy(blk->recv[miss], blk->rpr[j], blk->T);
+            for (i = 0; i < blk->K; i++) {
+                if (i != miss && xqc_fec_bench_pkm_covers(j, i)) {
+                    xqc_xor_code_one_symbol(blk->recv[i], blk->recv[miss], blk->T);
+                }
+            }
+            src_lost[miss] = 0;
+            remain--;
+            progress = XQC_TRUE;
+        }
+    } while (progress && remain);
+
+    return remain ? -XQC_EFEC_SCHEME_ERROR : XQC_OK;
+}
+
+#endif
+
+#ifdef XQC_ENABLE_FOUNTAIN
+
+static xqc_fec_encoder_t *g_raptorq_enc;
+static xqc_fec_decoder_t *g_raptorq_dec;
+
+static xqc_bool_t
+xqc_fec_bench_raptorq_support(int K, int R, size_t T)
+{
+    /* symbols are arrays of int */
+    return T % sizeof(int) == 0;
+}
+
+static xqc_int_t
+xqc_fec_bench_raptorq_init(xqc_fec_bench_blk_t *blk, int param)
+{
+    /* generator matrices are built once for each run, as for a connection */
+    xqc_fec_encoder_destroy(g_raptorq_enc);
+    xqc_fec_decoder_destroy(g_raptorq_dec);
+    g_raptorq_enc = xqc_fec_encoder_create(XQC_RAPTORQ_CODE, blk->K, blk->T, blk->R);
+    g_raptorq_dec = xqc_fec_decoder_create(XQC_RAPTORQ_CODE, blk->K, blk->T, blk->R);
+    if (g_raptorq_enc == NULL || g_raptorq_dec == NULL) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_raptorq_encode(xqc_fec_bench_blk_t *blk)
+{
+    size_t size;
+    xqc_int_t ret;
+    const unsigned char *data;
+
+    xqc_fec_encoder_reset(g_raptorq_enc);
+    for (int i = 0; i < blk->K; i++) {
+        ret = xqc_fec_encoder_add_source(g_raptorq_enc, blk->src[i], blk->T);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+    }
+
+    for (int i = 0; i < blk->R; i++) {
+        ret = xqc_fec_encoder_get_repair(g_raptorq_enc, i, &data, &size);
+        if (ret != XQC_OK) {
+            return ret;
+        }
+        xqc_memcpy(blk->rpr[i], data, size);
+    }
+    return XQC_OK;
+}
+
+static xqc_int_t
+xqc_fec_bench_raptorq_decode(xqc_fec_bench_blk_t *blk)
+{
+    size_t size;
+    xqc_int_t ret;
+    const unsigned char *data;
+
+    xqc_fec_decoder_reset(g_raptorq_dec);
+    for (int i = 0; i < blk->K + blk->R; i++) {
+        if (!xqc_fec_bench_is_lost(blk, i)) {
+            xqc_fec_decoder_add_received(g_raptorq_dec, i,
+                                         i < blk->K ? blk->recv[i] : blk->rpr[i - blk->K], blk->T);
+        }
+    }
+
+    ret = xqc_fec_decoder_try_decode(g_raptorq_dec);
+    if (ret != XQC_OK) {
+        return -XQC_EFEC_SCHEME_ERROR;
+    }
+
+    for (int i = 0; i < blk->K; i++) {
+        if (xqc_fec_bench_is_lost(blk, i)) {
+            xqc_fec_decoder_get_source(g_raptorq_dec, i, &data, &size);
+            xqc_memcpy(blk->recv[i], data, blk->T);
+        }
+    }
+    return XQC_OK;
+}
+
+#endif
+
+
+static const xqc_fec_bench_scheme_t xqc_fec_bench_schemes[] = {
+#ifdef XQC_ENABLE_XOR
+    {.name = "xor", .scheme = XQC_XOR_CODE, .support = xqc_fec_bench_xor_support,
+        .init = xqc_fec_bench_xor_init, .encode = xqc_fec_bench_xor_encode,
+        .decode = xqc_fec_bench_xor_decode, .param = 0, .libc_allocs = XQC_FALSE},
+#endif
+#ifdef XQC_ENABLE_RSC
+    {.name = "rs", .scheme = XQC_REED_SOLOMON_CODE, .support = xqc_fec_bench_rs_support,
+        .init = xqc_fec_bench_rs_init, .encode = xqc_fec_bench_rs_encode,
+        .decode = xqc_fec_bench_rs_decode, .param = 0, .libc_allocs = XQC_FALSE},
+#endif
+#ifdef XQC_ENABLE_RS16
+    {.name = "rs16", .scheme = XQC_REED_SOLOMON_16_CODE, .support = xqc_fec_bench_rs16_support,
+        .init = xqc_fec_bench_rs16_init, .encode = xqc_fec_bench_rs16_encode,
+        .decode = xqc_fec_bench_rs16_decode, .param = 0, .libc_allocs = XQC_FALSE},
+#endif
+#ifdef XQC_ENABLE_PKM
+    {.name = "pkm", .scheme = XQC_PACKET_MASK_CODE, .support = xqc_fec_bench_pkm_support,
+        .init = xqc_fec_bench_pkm_init, .encode = xqc_fec_bench_pkm_encode,
+        .decode = xqc_fec_bench_pkm_decode, .param = XQC_FEC_RANDOM_TBL, .libc_allocs = XQC_FALSE},
+    {.name = "pkm_burst", .scheme = XQC_PACKET_MASK_CODE, .support = xqc_fec_bench_pkm_support,
+        .init = xqc_fec_bench_pkm_init, .encode = xqc_fec_bench_pkm_encode,
+        .decode = xqc_fec_bench_pkm_decode, .param = XQC_FEC_BURST_TBL, .libc_allocs = XQC_FALSE},
+#endif
+#ifdef XQC_ENABLE_FOUNTAIN
+    {.name = "raptorq", .scheme = XQC_RAPTORQ_CODE, .support = xqc_fec_bench_raptorq_support,
+        .init = xqc_fec_bench_raptorq_init, .encode = xqc_fec_bench_raptorq_encode,
+        .decode = xqc_fec_bench_raptorq_decode, .param = 0, .libc_allocs = XQC_TRUE},
+#endif
+    {.name = NULL},
+};
+
+
+static int
+xqc_fec_bench_cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : (x > y);
+}
+
+static void
+xqc_fec_bench_block(const xqc_fec_bench_scheme_t *scheme, xqc_fec_bench_blk_t *blk,
+    xqc_fec_bench_channel_t *ch, uint64_t *data_rand, xqc_fec_bench_result_t *res)
+{
+    uint64_t t, allocs;
+    xqc_int_t ret;
+    int i, lost, residual;
+
+    for (i = 0; i < blk->K; i++) {
+        xqc_fec_bench_fill(data_rand, blk->src[i], blk->T);
+    }
+
+    allocs = xqc_fec_bench_allocs();
+    t = xqc_fec_bench_ns();
+    ret = scheme->encode(blk);
+    res->enc_ns += xqc_fec_bench_ns() - t;
+    res->enc_allocs += xqc_fec_bench_allocs() - allocs;
+    res->blocks++;
+    if (ret != XQC_OK) {
+        printf("%s encode error:%d\n", scheme->name, (int)ret);
+    }
+
+    /* source symbols are sent first, then repair symbols */
+    lost = 0;
+    for (i = 0; i < blk->K + blk->R; i++) {
+        blk->lost[i] = xqc_fec_bench_drop(ch);
+        lost += blk->lost[i] && i < blk->K;
+        if (i < blk->K) {
+            if (xqc_fec_bench_is_lost(blk, i)) {
+                xqc_memset(blk->recv[i], 0, blk->T);
+
+            } else {
+                xqc_memcpy(blk->recv[i], blk->src[i], blk->T);
+            }
+        }
+    }
+    if (lost == 0) {
+        return;
+    }
+
+    allocs = xqc_fec_bench_allocs();
+    t = xqc_fec_bench_ns();
+    ret = scheme->decode(blk);
+    t = xqc_fec_bench_ns() - t;
+    res->dec_allocs += xqc_fec_bench_allocs() - allocs;
+    res->dec_ns += t;
+    res->dec_samples[res->decoded++] = t;
+    res->src_lost += lost;
+
+    residual = 0;
+    for (i = 0; i < blk->K; i++) {
+        if (xqc_fec_bench_is_lost(blk, i) && memcmp(blk->recv[i], blk->src[i], blk->T) != 0) {
+            residual++;
+        }
+    }
+    res->src_residual += residual;
+
+    if (ret == XQC_OK && residual == 0) {
+        res->recovered++;
+
+    } else if (ret == XQC_OK) {
+        res->corrupted++;
+    }
+}
+
+static void
+xqc_fec_bench_report(const xqc_fec_bench_scheme_t *scheme, xqc_fec_bench_blk_t *blk,
+    const char *pattern, double loss, double burst, xqc_fec_bench_result_t *res, FILE *json)
+{
+    double src_bytes = (double)blk->K * blk->T;
+    double enc_mbps, dec_mbps, enc_us, dec_us, p99_us, enc_allocs, dec_allocs;
+    double recovery, residual;
+
+    enc_mbps = res->enc_ns ? src_bytes * res->blocks * 1000 / res->enc_ns : 0;
+    dec_mbps = res->dec_ns ? src_bytes * res->decoded * 1000 / res->dec_ns : 0;
+    enc_us = (double)res->enc_ns / res->blocks / 1000;
+    dec_us = res->decoded ? (double)res->dec_ns / res->decoded / 1000 : 0;
+    p99_us = 0;
+    if (res->decoded) {
+        qsort(res->dec_samples, res->decoded, sizeof(uint64_t), xqc_fec_bench_cmp_u64);
+        p99_us = res->dec_samples[(res->decoded - 1) * 99 / 100] / 1000.0;
+    }
+
+#ifdef XQC_ENABLE_ALLOC_COUNT
+    if (!scheme->libc_allocs) {
+        enc_allocs = (double)res->enc_allocs / res->blocks;
+        dec_allocs = res->decoded ? (double)res->dec_allocs / res->decoded : 0;
+
+    } else {
+        enc_allocs = dec_allocs = -1;
+    }
+#else
+    enc_allocs = dec_allocs = -1;
+#endif
+
+    recovery = res->decoded ? (double)res->recovered / res->decoded : 1;
+    residual = (double)res->src_residual / (res->blocks * blk->K);
+
+    printf("%-10s %3d %3d %5zu %-7s %9.1f %9.1f %8.2f %8.2f %8.2f %7.1f %7.1f %8.4f %9.6f",
+           scheme->name, blk->K, blk->R, blk->T, pattern, enc_mbps, dec_mbps, enc_us, dec_us,
+           p99_us, enc_allocs, dec_allocs, recovery, residual);
+    if (res->corrupted) {
+        printf(" corrupted:%"PRIu64, res->corrupted);
+    }
+    printf("\n");
+
+    if (json == NULL) {
+        return;
+    }
+    fprintf(json, "{\"bench\":\"fec\",\"time\":%"PRIu64",\"scheme\":\"%s\",\"k\":%d,\"r\":%d,"
+            "\"t\":%zu,\"loss_pattern\":\"%s\",\"loss\":%.4f,\"burst\":%.2f,\"blocks\":%"PRIu64","
+            "\"decoded\":%"PRIu64",\"enc_mbps\":%.2f,\"dec_mbps\":%.2f,\"enc_us\":%.3f,"
+            "\"dec_us\":%.3f,\"dec_p99_us\":%.3f,\"enc_allocs\":%.2f,\"dec_allocs\":%.2f,"
+            "\"recovery\":%.6f,\"residual_loss\":%.6f,\"corrupted\":%"PRIu64"}\n",
+            (uint64_t)time(NULL), scheme->name, blk->K, blk->R, blk->T, pattern, loss, burst,
+            res->blocks, res->decoded, enc_mbps, dec_mbps, enc_us, dec_us, p99_us, enc_allocs,
+            dec_allocs, recovery, residual, res->corrupted);
+    fflush(json);
+}
+
+static void
+xqc_fec_bench_run(const xqc_fec_bench_scheme_t *scheme, int K, int R, size_t T, uint64_t blocks,
+    uint64_t seed, double loss, double burst, FILE *json)
+{
+    xqc_fec_bench_blk_t blk;
+    xqc_fec_bench_result_t res;
+    xqc_fec_bench_channel_t ch;
+    uint64_t data_rand, n;
+    int i;
+
+    memset(&blk, 0, sizeof(blk));
+    blk.K = K;
+    blk.R = R;
+    blk.T = T;
+    for (i = 0; i < K; i++) {
+        blk.src[i] = xqc_malloc(T);
+        blk.recv[i] = xqc_malloc(T);
+    }
+    for (i = 0; i < R; i++) {
+        blk.rpr[i] = xqc_malloc(T);
+    }
+
+    for (int pattern = 0; pattern < 2; pattern++) {
+        memset(&res, 0, sizeof(res));
+        res.dec_samples = xqc_calloc(blocks, sizeof(uint64_t));
+
+        /* the same losses for every scheme */
+        memset(&ch, 0, sizeof(ch));
+        ch.rand = seed;
+        ch.loss = loss;
+        if (pattern == 1) {
+            /* stationary loss rate p / (p + r) is the same as random loss */
+            ch.ge_r = 1.0 / burst;
+            ch.ge_p = loss * ch.ge_r / (1 - loss);
+        }
+        data_rand = seed ^ 0x5bd1e995;
+
+        if (scheme->init(&blk, scheme->param) != XQC_OK) {
+            printf("%-10s %3d %3d %5zu init error\n", scheme->name, K, R, T);
+            xqc_free(res.dec_samples);
+            break;
+        }
+        for (n = 0; n < blocks; n++) {
+            xqc_fec_bench_block(scheme, &blk, &ch, &data_rand, &res);
+        }
+        xqc_fec_bench_report(scheme, &blk, pattern ? "burst" : "random", loss, burst, &res,
+                             json);
+        xqc_free(res.dec_samples);
+    }
+
+    for (i = 0; i < K; i++) {
+        xqc_free(blk.src[i]);
+        xqc_free(blk.recv[i]);
+    }
+    for (i = 0; i < R; i++) {
+        xqc_free(blk.rpr[i]);
+    }
+}
+
+
+static int
+xqc_fec_bench_parse_list(char *arg, int *list, int max)
+{
+    int n = 0;
+
+    for (char *p = strtok(arg, ","); p != NULL && n < max; p = strtok(NULL, ",")) {
+        list[n++] = atoi(p);
+    }
+    return n;
+}
+
+static void
+xqc_fec_bench_usage(const char *prog)
+{
+    printf("usage: %s [-k K list, default 4,10,20,48] [-r R list, default 1,2,4]\n"
+           "    [-t T list in bytes, default 256,1200] [-l loss rate, default 0.05]\n"
+           "    [-b mean burst length of burst loss, default 4] [-n blocks per run, default 1000]\n"
+           "    [-s scheme] [-e seed] [-o json file to append results]\n"
+           "schemes:", prog);
+    for (const xqc_fec_bench_scheme_t *s = xqc_fec_bench_schemes; s->name; s++) {
+        printf(" %s", s->name);
+    }
+    printf("\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ch, nk = 4, nr = 3, nt = 2;
+    int klist[XQC_FEC_BENCH_MAX_LIST] = {4, 10, 20, 48};
+    int rlist[XQC_FEC_BENCH_MAX_LIST] = {1, 2, 4};
+    int tlist[XQC_FEC_BENCH_MAX_LIST] = {256, 1200};
+    double loss = 0.05, burst = 4;
+    uint64_t blocks = 1000, seed = 1;
+    const char *only = NULL, *json_file = NULL;
+    FILE *json = NULL;
+
+    while ((ch = getopt(argc, argv, "k:r:t:l:b:n:s:e:o:h")) != -1) {
+        switch (ch) {
+        case 'k':
+            nk = xqc_fec_bench_parse_list(optarg, klist, XQC_FEC_BENCH_MAX_LIST);
+            break;
+        case 'r':
+            nr = xqc_fec_bench_parse_list(optarg, rlist, XQC_FEC_BENCH_MAX_LIST);
+            break;
+        case 't':
+            nt = xqc_fec_bench_parse_list(optarg, tlist, XQC_FEC_BENCH_MAX_LIST);
+            break;
+        case 'l':
+            loss = atof(optarg);
+            break;
+        case 'b':
+            burst = atof(optarg);
+            break;
+        case 'n':
+            blocks = strtoull(optarg, NULL, 10);
+            break;
+        case 's':
+            only = optarg;
+            break;
+        case 'e':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'o':
+            json_file = optarg;
+            break;
+        default:
+            xqc_fec_bench_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    if (loss <= 0 || loss >= 1 || burst < 1 || blocks == 0) {
+        xqc_fec_bench_usage(argv[0]);
+        return -1;
+    }
+
+    if (json_file) {
+        json = fopen(json_file, "a");
+        if (json == NULL) {
+            printf("open %s error\n", json_file);
+            return -1;
+        }
+    }
+
+    printf("blocks:%"PRIu64" loss:%.4f burst:%.2f seed:%"PRIu64"\n", blocks, loss, burst, seed);
+    printf("%-10s %3s %3s %5s %-7s %9s %9s %8s %8s %8s %7s %7s %8s %9s\n",
+           "scheme", "K", "R", "T", "loss", "enc_MB/s", "dec_MB/s", "enc_us", "dec_us",
+           "p99_us", "e_alloc", "d_alloc", "recovery", "residual");
+
+    for (const xqc_fec_bench_scheme_t *s = xqc_fec_bench_schemes; s->name; s++) {
+        if (only && strcmp(only, s->name) != 0) {
+            continue;
+        }
+
+        for (int k = 0; k < nk; k++) {
+            for (int r = 0; r < nr; r++) {
+                for (int t = 0; t < nt; t++) {
+                    /* caps of the fec framework for the scheme, and limits of its coding */
+                    if (klist[k] < 1 || klist[k] > xqc_fec_max_symbol_num_pblock(s->scheme)
+                        || rlist[r] < 1 || rlist[r] > xqc_fec_max_repair_num_pblock(s->scheme)
+                        || tlist[t] < 1 || tlist[t] > XQC_MAX_SYMBOL_SIZE
+                        || !s->support(klist[k], rlist[r], tlist[t]))
+                    {
+                        continue;
+                    }
+                    xqc_fec_bench_run(s, klist[k], rlist[r], tlist[t], blocks, seed, loss,
+                                      burst, json);
+                }
+            }
+        }
+    }
+
+    if (json) {
+        fclose(json);
+    }
+    return 0;
+}
@@ -0,0 +1,512 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+/*
+ * in-process handshake benchmark. a client engine and a server engine exchange datagrams
+ * through memory queues instead of sockets and event loop, hence handshakes per second only
+ * reflects the cost of xquic and tls. full handshakes are measured with session store of
+ * client disabled, and resumed ones with the built-in lru session store.
+ *
+ * time of each handshake is split into xqc_connect of client and datagram processing of both
+ * endpoints, and the handshake phases in xqc_engine_perf_stats_t are reported per handshake
+ * when xquic is built with XQC_ENABLE_PERF_TIMING. fast paths of server, the connection cache
+ * and pre-warmed SSL objects, could be turned off with -m 0 -p 0 for comparison.
+ *
+ * usage: handshake_bench -n <handshakes> -c <cert file> -k <key file>
+ *                        -m <conn cache size> -p <ssl prewarm count>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "platform.h"
+
+#ifndef XQC_SYS_WINDOWS
+#include <unistd.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <getopt.h>
+#else
+#include "getopt.h"
+#endif
+
+#define XQC_BENCH_ALPN              "transport"
+#define XQC_BENCH_HOST              "bench.xquic.test"
+#define XQC_BENCH_QUEUE_SIZE        256
+#define XQC_BENCH_PKT_SIZE          1500
+
+/* pump rounds of a single handshake before giving up */
+#define XQC_BENCH_MAX_ROUNDS        256
+
+#define XQC_BENCH_SESSION_TICKET_KEY "\xa8\x6d\x19\x70\x06\x08\x9b\x2d" \
+"\xa7\x17\x50\xf7\x97\x78\xf7\xe8\x3c\x5a\xc4\x9d\x61\x34\xe3\xa1\xfa" \
+"\x62\x7b\x66\xf0\x2f\x5b\xdc\x63\x12\x8d\x10\x9a\x57\x5c\xdd\x1b\xc3" \
+"\x8f\x13\x93\x3c\x85"
+
+
+typedef struct xqc_bench_pkt_s {
+    unsigned char           buf[XQC_BENCH_PKT_SIZE];
+    size_t                  len;
+} xqc_bench_pkt_t;
+
+/* datagrams to an endpoint */
+typedef struct xqc_bench_queue_s {
+    xqc_bench_pkt_t         pkts[XQC_BENCH_QUEUE_SIZE];
+    size_t                  head;
+    size_t                  tail;
+    uint64_t                dropped;
+} xqc_bench_queue_t;
+
+typedef struct xqc_bench_endpoint_s {
+    xqc_engine_t           *engine;
+    xqc_bench_queue_t       in;
+    struct sockaddr_in      addr;
+
+    /* time spent in processing datagrams */
+    xqc_usec_t              process_us;
+} xqc_bench_endpoint_t;
+
+typedef struct xqc_bench_ctx_s {
+    xqc_bench_endpoint_t    cli;
+    xqc_bench_endpoint_t    svr;
+
+    xqc_session_lru_t      *session_lru;
+
+    /* state of the handshake in progress */
+    int                     hsk_done;
+
+    /* time spent in xqc_connect */
+    xqc_usec_t              connect_us;
+
+    /* fast paths of server, negative for default config */
+    int                     conn_cache_size;
+    int                     ssl_prewarm_cnt;
+} xqc_bench_ctx_t;
+
+static xqc_bench_ctx_t g_bench;
+
+
+static xqc_usec_t
+xqc_bench_now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (xqc_usec_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static ssize_t
+xqc_bench_enqueue(xqc_bench_queue_t *q, const unsigned char *buf, size_t size)
+{
+    xqc_bench_pkt_t *pkt;
+
+    if (size > XQC_BENCH_PKT_SIZE) {
+        return XQC_SOCKET_ERROR;
+    }
+
+    /* full queue behaves like a lossy link */
+    if (q->tail - q->head >= XQC_BENCH_QUEUE_SIZE) {
+        q->dropped++;
+        return size;
+    }
+
+    pkt = &q->pkts[q->tail % XQC_BENCH_QUEUE_SIZE];
+    memcpy(pkt->buf, buf, size);
+    pkt->len = size;
+    q->tail++;
+    return size;
+}
+
+/* deliver all datagrams queued to endpoint, returns count of datagrams */
+static size_t
+xqc_bench_deliver(xqc_bench_endpoint_t *to, xqc_bench_endpoint_t *from)
+{
+    size_t cnt = 0;
+    xqc_bench_pkt_t *pkt;
+    xqc_usec_t begin = xqc_bench_now();
+
+    while (to->in.head != to->in.tail) {
+        pkt = &to->in.pkts[to->in.head % XQC_BENCH_QUEUE_SIZE];
+        xqc_engine_packet_process(to->engine, pkt->buf, pkt->len,
+                                  (struct sockaddr *)&to->addr, sizeof(to->addr),
+                                  (struct sockaddr *)&from->addr, sizeof(from->addr),
+                                  xqc_bench_now(), &g_bench);
+        to->in.head++;
+        cnt++;
+    }
+
+    if (cnt > 0) {
+        xqc_engine_finish_recv(to->engine);
+    }
+
+    to->process_us += xqc_bench_now() - begin;
+    return cnt;
+}
+
+static size_t
+xqc_bench_pump()
+{
+    return xqc_bench_deliver(&g_bench.svr, &g_bench.cli)
+        + xqc_bench_deliver(&g_bench.cli, &g_bench.svr);
+}
+
+
+static ssize_t
+xqc_bench_cli_write_socket(const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, void *user_data)
+{
+    return xqc_bench_enqueue(&g_bench.svr.in, buf, size);
+}
+
+static ssize_t
+xqc_bench_svr_write_socket(const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, void *user_data)
+{
+    return xqc_bench_enqueue(&g_bench.cli.in, buf, size);
+}
+
+/* timers are driven by xqc_engine_main_logic in the pump loop */
+static void
+xqc_bench_set_event_timer(xqc_usec_t wake_after, void *user_data)
+{
+}
+
+static void
+xqc_bench_write_log(xqc_log_level_t lvl, const void *buf, size_t size, void *user_data)
+{
+}
+
+static int
+xqc_bench_server_accept(xqc_engine_t *engine, xqc_connection_t *conn, const xqc_cid_t *cid,
+    void *user_data)
+{
+    return 0;
+}
+
+static void
+xqc_bench_server_refuse(xqc_engine_t *engine, xqc_connection_t *conn, const xqc_cid_t *cid,
+    void *user_data)
+{
+}
+
+static void
+xqc_bench_save_token(const unsigned char *token, uint32_t token_len, void *user_data)
+{
+}
+
+static void
+xqc_bench_save_string(const char *data, size_t data_len, void *user_data)
+{
+}
+
+static int
+xqc_bench_cert_verify(const unsigned char *certs[], const size_t cert_len[], size_t certs_len,
+    void *user_data)
+{
+    return 0;
+}
+
+static void
+xqc_bench_update_cid(xqc_connection_t *conn, const xqc_cid_t *retire_cid,
+    const xqc_cid_t *new_cid, void *user_data)
+{
+}
+
+static int
+xqc_bench_conn_notify(xqc_connection_t *conn, const xqc_cid_t *cid, void *user_data,
+    void *conn_proto_data)
+{
+    return 0;
+}
+
+static void
+xqc_bench_handshake_finished(xqc_connection_t *conn, void *user_data, void *conn_proto_data)
+{
+    g_bench.hsk_done = 1;
+}
+
+
+static xqc_engine_t *
+xqc_bench_create_engine(xqc_engine_type_t type, const char *cert_file, const char *key_file)
+{
+    xqc_config_t config;
+    xqc_engine_ssl_config_t ssl_config;
+    xqc_engine_t *engine;
+
+    if (xqc_engine_get_default_config(&config, type) < 0) {
+        return NULL;
+    }
+    config.cfg_log_level = XQC_LOG_ERROR;
+
+    if (type == XQC_ENGINE_SERVER) {
+        if (g_bench.conn_cache_size >= 0) {
+            config.conn_cache_size = g_bench.conn_cache_size;
+        }
+
+        if (g_bench.ssl_prewarm_cnt >= 0) {
+            config.ssl_prewarm_cnt = g_bench.ssl_prewarm_cnt;
+        }
+    }
+
+    memset(&ssl_config, 0, sizeof(ssl_config));
+    ssl_config.ciphers = XQC_TLS_CIPHERS;
+    ssl_config.groups = XQC_TLS_GROUPS;
+    if (type == XQC_ENGINE_SERVER) {
+        ssl_config.private_key_file = (char *)key_file;
+        ssl_config.cert_file = (char *)cert_file;
+        ssl_config.session_ticket_key_data = XQC_BENCH_SESSION_TICKET_KEY;
+        ssl_config.session_ticket_key_len = sizeof(XQC_BENCH_SESSION_TICKET_KEY) - 1;
+    }
+
+    xqc_engine_callback_t callback = {
+        .set_event_timer = xqc_bench_set_event_timer,
+        .log_callbacks = {
+            .xqc_log_write_err = xqc_bench_write_log,
+            .xqc_log_write_stat = xqc_bench_write_log,
+        },
+    };
+
+    xqc_transport_callbacks_t tcbs = {
+        .server_accept = xqc_bench_server_accept,
+        .server_refuse = xqc_bench_server_refuse,
+        .write_socket = type == XQC_ENGINE_SERVER
+            ? xqc_bench_svr_write_socket : xqc_bench_cli_write_socket,
+        .conn_update_cid_notify = xqc_bench_update_cid,
+        .save_token = xqc_bench_save_token,
+        .save_session_cb = xqc_bench_save_string,
+        .save_tp_cb = xqc_bench_save_string,
+        .cert_verify_cb = xqc_bench_cert_verify,
+    };
+
+    engine = xqc_engine_create(type, &config, &ssl_config, &callback, &tcbs, &g_bench);
+    if (engine == NULL) {
+        return NULL;
+    }
+
+    xqc_app_proto_callbacks_t ap_cbs = {
+        .conn_cbs = {
+            .conn_create_notify = xqc_bench_conn_notify,
+            .conn_close_notify = xqc_bench_conn_notify,
+            .conn_handshake_finished = xqc_bench_handshake_finished,
+        },
+    };
+
+    /* only handshakes of client are observed */
+    if (type == XQC_ENGINE_SERVER) {
+        ap_cbs.conn_cbs.conn_handshake_finished = NULL;
+    }
+
+    if (xqc_engine_register_alpn(engine, XQC_BENCH_ALPN, strlen(XQC_BENCH_ALPN),
+                                 &ap_cbs, NULL) != XQC_OK)
+    {
+        xqc_engine_destroy(engine);
+        return NULL;
+    }
+
+    return engine;
+}
+
+
+/* run a handshake to completion, and close the connection */
+static int
+xqc_bench_handshake(const xqc_conn_settings_t *settings)
+{
+    int rounds;
+    const xqc_cid_t *cid;
+    xqc_cid_t cid_copy;
+    xqc_conn_ssl_config_t ssl_cfg;
+    xqc_usec_t begin;
+
+    memset(&ssl_cfg, 0, sizeof(ssl_cfg));
+    g_bench.hsk_done = 0;
+
+    begin = xqc_bench_now();
+    cid = xqc_connect(g_bench.cli.engine, settings, NULL, 0, XQC_BENCH_HOST, 0, &ssl_cfg,
+                      (struct sockaddr *)&g_bench.svr.addr, sizeof(g_bench.svr.addr),
+                      XQC_BENCH_ALPN, &g_bench);
+    g_bench.connect_us += xqc_bench_now() - begin;
+    if (cid == NULL) {
+        return -1;
+    }
+    memcpy(&cid_copy, cid, sizeof(xqc_cid_t));
+
+    /*
+     * keep pumping after handshake until link is idle, for the session ticket is sent by
+     * server after client's Finished
+     */
+    for (rounds = 0; rounds < XQC_BENCH_MAX_ROUNDS; rounds++) {
+        if (xqc_bench_pump() == 0) {
+            if (g_bench.hsk_done) {
+                break;
+            }
+
+            /* nothing in flight, let timers fire */
+            xqc_engine_main_logic(g_bench.cli.engine);
+            xqc_engine_main_logic(g_bench.svr.engine);
+        }
+    }
+
+    xqc_conn_close(g_bench.cli.engine, &cid_copy);
+    xqc_bench_pump();
+
+    /* connections closed earlier are destroyed when their draining timer expires */
+    xqc_engine_main_logic(g_bench.cli.engine);
+    xqc_engine_main_logic(g_bench.svr.engine);
+
+    return g_bench.hsk_done ? 0 : -1;
+}
+
+/* average of a counter of both engines per handshake */
+#define XQC_BENCH_PER_HSK(field) (count > 0 ? \
+    (double)(cli_after.field - cli_before.field + svr_after.field - svr_before.field) / count : 0.0)
+
+static void
+xqc_bench_run(const char *name, const xqc_conn_settings_t *settings, int count)
+{
+    int i, failed = 0;
+    xqc_usec_t begin, elapsed, connect_us, cli_us, svr_us;
+    xqc_engine_perf_stats_t cli_before, cli_after, svr_before, svr_after;
+
+    xqc_engine_get_perf_stats(g_bench.cli.engine, &cli_before);
+    xqc_engine_get_perf_stats(g_bench.svr.engine, &svr_before);
+    connect_us = g_bench.connect_us;
+    cli_us = g_bench.cli.process_us;
+    svr_us = g_bench.svr.process_us;
+
+    begin = xqc_bench_now();
+    for (i = 0; i < count; i++) {
+        if (xqc_bench_handshake(settings) != 0) {
+            failed++;
+        }
+    }
+    elapsed = xqc_bench_now() - begin;
+
+    xqc_engine_get_perf_stats(g_bench.cli.engine, &cli_after);
+    xqc_engine_get_perf_stats(g_bench.svr.engine, &svr_after);
+    connect_us = g_bench.connect_us - connect_us;
+    cli_us = g_bench.cli.process_us - cli_us;
+    svr_us = g_bench.svr.process_us - svr_us;
+
+    printf("%-8s handshakes:%d failed:%d elapsed:%.3fs rate:%.1f/s avg:%.1fus "
+           "resumed:%"PRIu64" store_hits:%"PRIu64"/%"PRIu64"\n",
+           name, count, failed, elapsed / 1e6,
+           elapsed > 0 ? count * 1e6 / elapsed : 0.0,
+           count > 0 ? (double)elapsed / count : 0.0,
+           cli_after.handshakes_resumed - cli_before.handshakes_resumed,
+           cli_after.session_store_hits - cli_before.session_store_hits,
+           cli_after.session_store_lookups - cli_before.session_store_lookups);
+
+    if (count <= 0) {
+        return;
+    }
+
+    printf("%-8s per handshake: connect:%.1fus client_process:%.1fus server_process:%.1fus\n",
+           name, (double)connect_us / count, (double)cli_us / count, (double)svr_us / count);
+
+    /* 0 unless built with XQC_ENABLE_PERF_TIMING */
+    printf("%-8s per handshake ticks: conn_create:%.0f tls_create:%.0f tls_init:%.0f "
+           "tls_process:%.0f encrypt:%.0f decrypt:%.0f\n",
+           name, XQC_BENCH_PER_HSK(conn_create_ticks), XQC_BENCH_PER_HSK(tls_create_ticks),
+           XQC_BENCH_PER_HSK(tls_init_ticks), XQC_BENCH_PER_HSK(tls_process_ticks),
+           XQC_BENCH_PER_HSK(encrypt_ticks), XQC_BENCH_PER_HSK(decrypt_ticks));
+
+    printf("%-8s server fast path: conns_reused:%"PRIu64"/%"PRIu64" ssl_prewarm_hits:%"PRIu64"\n",
+           name, svr_after.conns_reused - svr_before.conns_reused,
+           svr_after.conns_created - svr_before.conns_created,
+           svr_after.ssl_prewarm_hits - svr_before.ssl_prewarm_hits);
+}
+
+
+static void
+xqc_bench_usage(const char *prog)
+{
+    printf("usage: %s [-n handshakes] [-c cert file] [-k key file]\n"
+           "    [-m conn cache size of server] [-p ssl prewarm count of server]\n", prog);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ch, count = 1000;
+    const char *cert_file = "./server.crt";
+    const char *key_file = "./server.key";
+    xqc_session_lru_stats_t lru_stats;
+
+    memset(&g_bench, 0, sizeof(g_bench));
+    g_bench.conn_cache_size = -1;
+    g_bench.ssl_prewarm_cnt = -1;
+
+    while ((ch = getopt(argc, argv, "n:c:k:m:p:h")) != -1) {
+        switch (ch) {
+        case 'n':
+            count = atoi(optarg);
+            break;
+        case 'c':
+            cert_file = optarg;
+            break;
+        case 'k':
+            key_file = optarg;
+            break;
+        case 'm':
+            g_bench.conn_cache_size = atoi(optarg);
+            break;
+        case 'p':
+            g_bench.ssl_prewarm_cnt = atoi(optarg);
+            break;
+        default:
+            xqc_bench_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    g_bench.cli.addr.sin_family = AF_INET;
+    g_bench.cli.addr.sin_port = htons(50000);
+    g_bench.cli.addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    g_bench.svr.addr.sin_family = AF_INET;
+    g_bench.svr.addr.sin_port = htons(8443);
+    g_bench.svr.addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    g_bench.svr.engine = xqc_bench_create_engine(XQC_ENGINE_SERVER, cert_file, key_file);
+    g_bench.cli.engine = xqc_bench_create_engine(XQC_ENGINE_CLIENT, NULL, NULL);
+    if (g_bench.svr.engine == NULL || g_bench.cli.engine == NULL) {
+        printf("create engine error\n");
+        return -1;
+    }
+
+    g_bench.session_lru = xqc_session_lru_create(1, 0);
+    if (g_bench.session_lru == NULL) {
+        printf("create session store error\n");
+        return -1;
+    }
+
+    xqc_conn_settings_t settings;
+    memset(&settings, 0, sizeof(settings));
+    settings.cong_ctrl_callback = xqc_cubic_cb;
+    settings.proto_version = XQC_VERSION_V1;
+
+    /* full handshakes, without session store */
+    xqc_bench_run("full", &settings, count);
+
+    /* resumed handshakes, the first one fills the session store */
+    xqc_engine_set_session_store(g_bench.cli.engine, xqc_session_lru_callbacks(),
+                                 g_bench.session_lru);
+    xqc_bench_handshake(&settings);
+    xqc_bench_run("resumed", &settings, count);
+
+    xqc_session_lru_get_stats(g_bench.session_lru, &lru_stats);
+    printf("session store lookups:%"PRIu64" hits:%"PRIu64" inserts:%"PRIu64
+           " evictions:%"PRIu64" dropped datagrams:%"PRIu64"\n",
+           lru_stats.lookups, lru_stats.hits, lru_stats.inserts, lru_stats.evictions,
+           g_bench.cli.in.dropped + g_bench.svr.in.dropped);
+
+    xqc_engine_destroy(g_bench.cli.engine);
+    xqc_engine_destroy(g_bench.svr.engine);
+    xqc_session_lru_destroy(g_bench.session_lru);
+    return 0;
+}
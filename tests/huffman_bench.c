@@ -0,0 +1,430 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+/*
+ * throughput of the QPACK huffman decoder and encoder on a corpus of header values seen in
+ * API traffic. the multi-symbol decoder of xquic is compared with the nibble-driven state
+ * machine it replaced, which decodes 4 bits per lookup and emits at most one symbol each time.
+ * the state machine is generated from xqc_huffman_enc_code_table on start. the encoder, which
+ * sizes and encodes in one pass through a 64 bits accumulator, is compared with a separate
+ * sizing pass followed by the byte by byte encoder it replaced.
+ *
+ * usage: huffman_bench -r <rounds>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/common/utils/huffman/xqc_huffman.h"
+#include "src/common/utils/huffman/xqc_huffman_code.h"
+#include "src/common/xqc_config.h"
+
+#ifndef XQC_SYS_WINDOWS
+#include <getopt.h>
+#else
+#include "getopt.h"
+#endif
+
+/* header values seen in API traffic */
+static const char *xqc_huffman_bench_corpus[] = {
+    "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/537.36 (KHTML, like Gecko) "
+    "Chrome/120.0.0.0 Safari/537.36",
+    "text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;"
+    "q=0.8,application/signed-exchange;v=b3;q=0.7",
+    "gzip, deflate, br",
+    "en-US,en;q=0.9,zh-CN;q=0.8,zh;q=0.7",
+    "https://www.example.com/search?q=http3+qpack+huffman&source=hp&ei=Xk2TZc3gJ4aP0PEP2Ia5-A0",
+    "_ga=GA1.2.1803612341.1701867762; _gid=GA1.2.1293826472.1703246712; "
+    "session_id=8f3a2b1c9d4e5f60718293a4b5c6d7e8; csrftoken=Yx7Qp2LmN9vB4kR8sT1wZ3aC6dF0gH5j; "
+    "_fbp=fb.1.1701867762873.1957234410; theme=dark; lang=en-US",
+    "Bearer eyJhbGciOiJSUzI1NiIsInR5cCI6IkpXVCIsImtpZCI6IjFlOWdkazcifQ.eyJpc3MiOiJodHRwczovL2F1dGgu"
+    "ZXhhbXBsZS5jb20iLCJzdWIiOiIyNDg4OTQzNTQ1OTMiLCJhdWQiOiJhcGkuZXhhbXBsZS5jb20iLCJleHAiOjE3MDMy"
+    "NTA0MTIsImlhdCI6MTcwMzI0NjgxMiwic2NvcGUiOiJyZWFkIHdyaXRlIn0.kX9b2ZqkN3Wf0sJ8n7bP5sQ2v1L4rT6y"
+    "H8mC0eA3dG5jK7lM9oP1qR2sU4wY6zB8xD0fF2hJ4kL6nN8pQ0rS2tU4vW6xY8z",
+    "max-age=31536000; includeSubDomains; preload",
+    "W/\"5e15153d-120f\"",
+    "Wed, 21 Oct 2015 07:28:00 GMT",
+    "application/json; charset=utf-8",
+    "no-cache, no-store, must-revalidate",
+    "/api/v2/users/248894354593/orders?status=pending&limit=50&cursor=dXNlcjoyNDg4OTQzNTQ1OTM6MTcwMzI0NjgxMg",
+};
+
+#define XQC_HUFFMAN_BENCH_CORPUS_CNT \
+    (sizeof(xqc_huffman_bench_corpus) / sizeof(xqc_huffman_bench_corpus[0]))
+
+
+/*
+ * nibble-driven decoder. the states are the internal nodes of the code tree, and a transition
+ * walks 4 bits of input from a state. as the shortest code has 5 bits, a transition completes
+ * one symbol at most.
+ */
+typedef enum {
+    /* the pending bits are a valid padding */
+    XQC_HUFFMAN_BENCH_END   = 0x01,
+
+    /* symbol is available */
+    XQC_HUFFMAN_BENCH_SYM   = 0x02,
+
+    /* EOS is decoded */
+    XQC_HUFFMAN_BENCH_FAIL  = 0x04,
+} xqc_huffman_bench_flag_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t flags;
+    uint8_t sym;
+} xqc_huffman_bench_nibble_t;
+
+#define XQC_HUFFMAN_BENCH_LEAF  0x8000
+
+static xqc_huffman_bench_nibble_t xqc_huffman_bench_nibble_table[256][16];
+
+static void
+xqc_huffman_bench_nibble_init()
+{
+    uint16_t tree[256][2] = {{0}};
+    uint8_t depth[256] = {0}, ones[256] = {1};
+    uint16_t node, next, nnodes = 1;
+    uint32_t bit;
+
+    /* code tree, internal nodes are numbered from the root 0 */
+    for (uint16_t sym = 0; sym <= 256; sym++) {
+        const xqc_huffman_enc_code_t *code = &xqc_huffman_enc_code_table[sym];
+        node = 0;
+        for (int i = code->bits - 1; i > 0; i--) {
+            bit = (code->lsb >> i) & 1;
+            if (tree[node][bit] == 0) {
+                depth[nnodes] = depth[node] + 1;
+                ones[nnodes] = ones[node] && bit;
+                tree[node][bit] = nnodes++;
+            }
+            node = tree[node][bit];
+        }
+        tree[node][code->lsb & 1] = XQC_HUFFMAN_BENCH_LEAF | sym;
+    }
+
+    for (uint16_t state = 0; state < nnodes; state++) {
+        for (uint8_t nibble = 0; nibble < 16; nibble++) {
+            xqc_huffman_bench_nibble_t *t = &xqc_huffman_bench_nibble_table[state][nibble];
+            node = state;
+            for (int b = 3; b >= 0; b--) {
+                next = tree[node][(nibble >> b) & 1];
+                if (!(next & XQC_HUFFMAN_BENCH_LEAF)) {
+                    node = next;
+                    continue;
+                }
+
+                if ((next & ~XQC_HUFFMAN_BENCH_LEAF) == 256) {
+                    t->flags |= XQC_HUFFMAN_BENCH_FAIL;
+                    break;
+                }
+                t->flags |= XQC_HUFFMAN_BENCH_SYM;
+                t->sym = (uint8_t)(next & ~XQC_HUFFMAN_BENCH_LEAF);
+                node = 0;
+            }
+
+            t->state = (uint8_t)node;
+            if (ones[node] && depth[node] < 8) {
+                t->flags |= XQC_HUFFMAN_BENCH_END;
+            }
+        }
+    }
+}
+
+static ssize_t
+xqc_huffman_bench_nibble_dec(uint8_t *dest, size_t dstlen, const uint8_t *src, size_t srclen)
+{
+    const xqc_huffman_bench_nibble_t *t;
+    uint8_t *p = dest, *end = dest + dstlen;
+    uint8_t state = 0, flags = XQC_HUFFMAN_BENCH_END;
+
+    for (size_t i = 0; i < srclen; ++i) {
+        t = &xqc_huffman_bench_nibble_table[state][src[i] >> 4];
+        if (t->flags & XQC_HUFFMAN_BENCH_FAIL) {
+            return -1;
+        }
+        if (t->flags & XQC_HUFFMAN_BENCH_SYM) {
+            if (p == end) {
+                return -XQC_ENOBUF;
+            }
+            *p++ = t->sym;
+        }
+
+        t = &xqc_huffman_bench_nibble_table[t->state][src[i] & 0xf];
+        if (t->flags & XQC_HUFFMAN_BENCH_FAIL) {
+            return -1;
+        }
+        if (t->flags & XQC_HUFFMAN_BENCH_SYM) {
+            if (p == end) {
+                return -XQC_ENOBUF;
+            }
+            *p++ = t->sym;
+        }
+
+        state = t->state;
+        flags = t->flags;
+    }
+
+    return (flags & XQC_HUFFMAN_BENCH_END) ? p - dest : -1;
+}
+
+
+/* bytewise encoder, writes each code into dest byte by byte */
+static uint8_t *
+xqc_huffman_bench_encode_sym(uint8_t *dest, size_t *prembits, const xqc_huffman_enc_code_t *sym)
+{
+    size_t nbits = sym->bits;
+    size_t rembits = *prembits;
+    uint32_t code = sym->lsb;
+
+    if (rembits > nbits) {
+        *dest |= (uint8_t)(code << (rembits - nbits));
+        *prembits = rembits - nbits;
+        return dest;
+    }
+
+    if (rembits == nbits) {
+        *dest++ |= (uint8_t)code;
+        *prembits = 8;
+        return dest;
+    }
+
+    *dest++ |= (uint8_t)(code >> (nbits - rembits));
+
+    nbits -= rembits;
+    if (nbits & 0x7) {
+        /* align code to MSB byte boundary */
+        code <<= 8 - (nbits & 0x7);
+    }
+
+    if (nbits < 8) {
+        *dest = (uint8_t)code;
+        *prembits = 8 - nbits;
+        return dest;
+    }
+
+    if (nbits > 24) {
+        *dest++ = (uint8_t)(code >> 24);
+        nbits -= 8;
+    }
+
+    if (nbits > 16) {
+        *dest++ = (uint8_t)(code >> 16);
+        nbits -= 8;
+    }
+
+    if (nbits > 8) {
+        *dest++ = (uint8_t)(code >> 8);
+        nbits -= 8;
+    }
+
+    if (nbits == 8) {
+        *dest++ = (uint8_t)code;
+        *prembits = 8;
+        return dest;
+    }
+
+    *dest = (uint8_t)code;
+    *prembits = 8 - nbits;
+    return dest;
+}
+
+static size_t
+xqc_huffman_bench_bytewise_len(const uint8_t *src, size_t len)
+{
+    size_t nbits = 0;
+
+    for (size_t i = 0; i < len; ++i) {
+        nbits += xqc_huffman_enc_code_table[src[i]].bits;
+    }
+    return (nbits + 7) / 8;
+}
+
+static uint8_t *
+xqc_huffman_bench_bytewise_enc(uint8_t *dest, const uint8_t *src, size_t srclen)
+{
+    size_t rembits = 8;
+    const xqc_huffman_enc_code_t *sym;
+
+    for (size_t i = 0; i < srclen; ++i) {
+        sym = &xqc_huffman_enc_code_table[src[i]];
+        if (rembits == 8) {
+            *dest = 0;
+        }
+        dest = xqc_huffman_bench_encode_sym(dest, &rembits, sym);
+    }
+
+    /* pad with the prefix of EOS */
+    if (rembits < 8) {
+        sym = &xqc_huffman_enc_code_table[256];
+        *dest++ |= (uint8_t)(sym->lsb >> (sym->bits - rembits));
+    }
+
+    return dest;
+}
+
+static double
+xqc_huffman_bench_elapsed_ns(const struct timespec *ts)
+{
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (te.tv_sec - ts->tv_sec) * 1e9 + (te.tv_nsec - ts->tv_nsec);
+}
+
+static int
+xqc_huffman_bench_dec(size_t rounds)
+{
+    size_t elen[XQC_HUFFMAN_BENCH_CORPUS_CNT];
+    uint8_t ebuf[XQC_HUFFMAN_BENCH_CORPUS_CNT][1024];
+    uint8_t dbuf[1024];
+    size_t i, r, len, processed, total = 0, plain = 0, old_out = 0, new_out = 0;
+    ssize_t ret;
+    xqc_huffman_dec_ctx ctx;
+    struct timespec ts;
+    double old_ns, new_ns;
+
+    /* both decoders shall restore the corpus before timing */
+    for (i = 0; i < XQC_HUFFMAN_BENCH_CORPUS_CNT; i++) {
+        len = strlen(xqc_huffman_bench_corpus[i]);
+        elen[i] = xqc_huffman_enc(ebuf[i], (const uint8_t *)xqc_huffman_bench_corpus[i], len)
+                  - ebuf[i];
+        total += elen[i];
+        plain += len;
+
+        xqc_huffman_dec_ctx_init(&ctx);
+        ret = xqc_huffman_dec(&ctx, dbuf, sizeof(dbuf), ebuf[i], elen[i], 1, &processed);
+        if (ret != elen[i] || processed != len
+            || memcmp(dbuf, xqc_huffman_bench_corpus[i], len) != 0)
+        {
+            printf("huffman decode|corpus %zu|multi-symbol decoder mismatch\n", i);
+            return -1;
+        }
+
+        ret = xqc_huffman_bench_nibble_dec(dbuf, sizeof(dbuf), ebuf[i], elen[i]);
+        if (ret != len || memcmp(dbuf, xqc_huffman_bench_corpus[i], len) != 0) {
+            printf("huffman decode|corpus %zu|nibble decoder mismatch\n", i);
+            return -1;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < XQC_HUFFMAN_BENCH_CORPUS_CNT; i++) {
+            old_out += xqc_huffman_bench_nibble_dec(dbuf, sizeof(dbuf), ebuf[i], elen[i]);
+        }
+    }
+    old_ns = xqc_huffman_bench_elapsed_ns(&ts);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < XQC_HUFFMAN_BENCH_CORPUS_CNT; i++) {
+            xqc_huffman_dec_ctx_init(&ctx);
+            xqc_huffman_dec(&ctx, dbuf, sizeof(dbuf), ebuf[i], elen[i], 1, &processed);
+            new_out += processed;
+        }
+    }
+    new_ns = xqc_huffman_bench_elapsed_ns(&ts);
+
+    printf("huffman decode|corpus:%zu bytes|nibble:%.1f MB/s|multi-symbol:%.1f MB/s|"
+           "speedup:%.2fx\n", total, total * rounds * 1e3 / old_ns,
+           total * rounds * 1e3 / new_ns, old_ns / new_ns);
+    return old_out == plain * rounds && new_out == plain * rounds ? 0 : -1;
+}
+
+
+static int
+xqc_huffman_bench_enc(size_t rounds)
+{
+    uint8_t ebuf[1024], obuf[1024], *end;
+    size_t i, r, len, elen, total = 0, old_out = 0, new_out = 0, expect = 0;
+    struct timespec ts;
+    double old_ns, new_ns;
+
+    /* both encoders shall produce the same bytes before timing */
+    for (i = 0; i < XQC_HUFFMAN_BENCH_CORPUS_CNT; i++) {
+        len = strlen(xqc_huffman_bench_corpus[i]);
+        total += len;
+
+        elen = xqc_huffman_enc_if_shorter(ebuf, (const uint8_t *)xqc_huffman_bench_corpus[i], len);
+        end = xqc_huffman_bench_bytewise_enc(obuf, (const uint8_t *)xqc_huffman_bench_corpus[i],
+                                             len);
+        if (elen == 0 || elen != end - obuf || memcmp(ebuf, obuf, elen) != 0) {
+            printf("huffman encode|corpus %zu|encoder mismatch\n", i);
+            return -1;
+        }
+        expect += elen;
+    }
+
+    /* size with a separate pass, then encode byte by byte */
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < XQC_HUFFMAN_BENCH_CORPUS_CNT; i++) {
+            len = strlen(xqc_huffman_bench_corpus[i]);
+            elen = xqc_huffman_bench_bytewise_len((const uint8_t *)xqc_huffman_bench_corpus[i],
+                                                  len);
+            if (elen < len) {
+                end = xqc_huffman_bench_bytewise_enc(ebuf,
+                    (const uint8_t *)xqc_huffman_bench_corpus[i], len);
+                old_out += end - ebuf;
+            }
+        }
+    }
+    old_ns = xqc_huffman_bench_elapsed_ns(&ts);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < XQC_HUFFMAN_BENCH_CORPUS_CNT; i++) {
+            len = strlen(xqc_huffman_bench_corpus[i]);
+            new_out += xqc_huffman_enc_if_shorter(ebuf,
+                (const uint8_t *)xqc_huffman_bench_corpus[i], len);
+        }
+    }
+    new_ns = xqc_huffman_bench_elapsed_ns(&ts);
+
+    printf("huffman encode|corpus:%zu bytes|bytewise:%.1f MB/s|accumulator:%.1f MB/s|"
+           "speedup:%.2fx\n", total, total * rounds * 1e3 / old_ns,
+           total * rounds * 1e3 / new_ns, old_ns / new_ns);
+    return old_out == expect * rounds && new_out == expect * rounds ? 0 : -1;
+}
+
+
+static void
+xqc_huffman_bench_usage(const char *prog)
+{
+    printf("usage: %s [-r rounds]\n", prog);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ch, ret = 0;
+    size_t rounds = 20000;
+
+    while ((ch = getopt(argc, argv, "r:h")) != -1) {
+        switch (ch) {
+        case 'r':
+            rounds = xqc_max(strtoull(optarg, NULL, 10), 1);
+            break;
+        default:
+            xqc_huffman_bench_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    xqc_huffman_bench_nibble_init();
+
+    if (xqc_huffman_bench_dec(rounds) != 0) {
+        ret = -1;
+    }
+
+    if (xqc_huffman_bench_enc(rounds) != 0) {
+        ret = -1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,167 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+/*
+ * lookup microbenchmark of the open addressing hash table used for the cid lookup of the
+ * engine, compared with the chained str hash table it replaced. every table is filled with n
+ * scattered 8 bytes cids, then -l lookups are timed on each, 1/8 of which are misses.
+ *
+ * usage: oa_hash_bench -n <number of cids, may be repeated> -l <lookups>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/common/utils/oa_hash/xqc_oa_hash.h"
+#include "src/common/xqc_str_hash.h"
+#include "src/common/xqc_log.h"
+#include "src/common/xqc_time.h"
+
+#ifndef XQC_SYS_WINDOWS
+#include <getopt.h>
+#else
+#include "getopt.h"
+#endif
+
+#define XQC_OA_BENCH_CID_LEN        8
+#define XQC_OA_BENCH_MAX_SIZES      16
+
+static uint8_t xqc_oa_bench_sipkey[XQC_SIPHASH_KEY_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static void
+xqc_oa_bench_write_log(xqc_log_level_t lvl, const void *buf, size_t size, void *user_data)
+{
+    fprintf(stderr, "%.*s\n", (int)size, (const char *)buf);
+}
+
+static xqc_log_callbacks_t xqc_oa_bench_log_cbs = {
+    .xqc_log_write_err = xqc_oa_bench_write_log,
+};
+
+static void
+xqc_oa_bench_gen_cid(uint8_t *cid, uint64_t i)
+{
+    /* distinct and scattered cids */
+    uint64_t v = (i + 1) * 0x9e3779b97f4a7c15ULL;
+    memcpy(cid, &v, XQC_OA_BENCH_CID_LEN);
+}
+
+static int
+xqc_oa_bench_run(size_t n, uint64_t lookups, xqc_log_t *log)
+{
+    uint64_t hash;
+    uint8_t cid[XQC_OA_BENCH_CID_LEN];
+    xqc_usec_t start, oa_cost, str_cost;
+    uint64_t oa_found = 0, str_found = 0;
+    xqc_oa_hash_table_t oa;
+    xqc_str_hash_table_t sh;
+
+    if (xqc_oa_hash_init(&oa, xqc_default_allocator, 1024, 0, xqc_oa_bench_sipkey,
+                         sizeof(xqc_oa_bench_sipkey), log) != XQC_OK)
+    {
+        return -1;
+    }
+
+    if (xqc_str_hash_init(&sh, xqc_default_allocator, 1024 * 1024, 0, xqc_oa_bench_sipkey,
+                          sizeof(xqc_oa_bench_sipkey), log) != XQC_OK)
+    {
+        xqc_oa_hash_release(&oa);
+        return -1;
+    }
+
+    for (uint64_t i = 0; i < n; i++) {
+        xqc_oa_bench_gen_cid(cid, i);
+        hash = xqc_oa_hash_get_hash(&oa, cid, sizeof(cid));
+        xqc_oa_hash_add(&oa, hash, cid, sizeof(cid), (void *)(uintptr_t)(i + 1));
+
+        xqc_str_hash_element_t e = {
+            .hash = hash,
+            .str = {.data = cid, .len = sizeof(cid)},
+            .value = (void *)(uintptr_t)(i + 1),
+        };
+        xqc_str_hash_add(&sh, e);
+    }
+
+    /* 1/8 of lookups are misses */
+    start = xqc_monotonic_timestamp();
+    for (uint64_t i = 0; i < lookups; i++) {
+        xqc_oa_bench_gen_cid(cid, (i & 7) ? (i * 7919) % n : n + i);
+        hash = xqc_oa_hash_get_hash(&oa, cid, sizeof(cid));
+        oa_found += xqc_oa_hash_find(&oa, hash, cid, sizeof(cid)) != NULL;
+    }
+    oa_cost = xqc_monotonic_timestamp() - start;
+
+    start = xqc_monotonic_timestamp();
+    for (uint64_t i = 0; i < lookups; i++) {
+        xqc_oa_bench_gen_cid(cid, (i & 7) ? (i * 7919) % n : n + i);
+        hash = xqc_siphash_get_hash(&sh.siphash_ctx, cid, sizeof(cid));
+        xqc_str_t str = {.data = cid, .len = sizeof(cid)};
+        str_found += xqc_str_hash_find(&sh, hash, str) != NULL;
+    }
+    str_cost = xqc_monotonic_timestamp() - start;
+
+    printf("conns:%zu|oa_hash:%.1f ns/lookup|str_hash:%.1f ns/lookup|capacity:%zu|"
+           "found:%"PRIu64"/%"PRIu64"\n", n, oa_cost * 1000.0 / lookups,
+           str_cost * 1000.0 / lookups, oa.cur.capacity, oa_found, str_found);
+
+    xqc_oa_hash_release(&oa);
+    xqc_str_hash_release(&sh);
+    return oa_found == str_found ? 0 : -1;
+}
+
+
+static void
+xqc_oa_bench_usage(const char *prog)
+{
+    printf("usage: %s [-n number of cids, may be repeated] [-l lookups]\n", prog);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ch, ret = 0;
+    size_t sizes[XQC_OA_BENCH_MAX_SIZES] = {1000, 10000, 100000, 1000000};
+    size_t size_cnt = 4, user_cnt = 0;
+    uint64_t lookups = 1 << 20;
+    xqc_log_t *log;
+
+    while ((ch = getopt(argc, argv, "n:l:h")) != -1) {
+        switch (ch) {
+        case 'n':
+            if (user_cnt < XQC_OA_BENCH_MAX_SIZES) {
+                sizes[user_cnt++] = xqc_max(strtoull(optarg, NULL, 10), 1);
+                size_cnt = user_cnt;
+            }
+            break;
+        case 'l':
+            lookups = xqc_max(strtoull(optarg, NULL, 10), 1);
+            break;
+        default:
+            xqc_oa_bench_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    log = xqc_log_init(XQC_LOG_WARN, XQC_FALSE, EVENT_IMPORTANCE_SELECTED, XQC_FALSE, XQC_TRUE,
+                       NULL, &xqc_oa_bench_log_cbs, NULL);
+    if (log == NULL) {
+        return -1;
+    }
+
+    for (size_t k = 0; k < size_cnt; k++) {
+        if (xqc_oa_bench_run(sizes[k], lookups, log) != 0) {
+            printf("conns:%zu|lookup mismatch\n", sizes[k]);
+            ret = -1;
+        }
+    }
+
+    xqc_log_release(log);
+    return ret;
+}
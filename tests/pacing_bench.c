@@ -0,0 +1,257 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+/*
+ * pacing accuracy of the budget pacer and the earliest departure time pacer, with and without
+ * SO_TXTIME. a backlogged sender writes to a loopback sink which records the time each packet
+ * leaves the host: the time of the wakeup which sent the packet, or its release time if the
+ * socket holds packets until then with SO_TXTIME. the ideal departure of k-th packet is
+ * first + k * size / rate. the sender is driven by the pacing timer on a virtual clock, as
+ * jitter of a real clock on a shared cpu would hide the accuracy of pacer itself.
+ *
+ * usage: pacing_bench -r <rate in Mbps, may be repeated> -s <packet size> -d <duration in ms>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/transport/xqc_pacing.h"
+#include "src/transport/xqc_send_ctl.h"
+#include "src/transport/xqc_conn.h"
+#include "src/common/xqc_log.h"
+#include "src/common/xqc_time.h"
+#include "src/common/xqc_malloc.h"
+
+#ifndef XQC_SYS_WINDOWS
+#include <getopt.h>
+#else
+#include "getopt.h"
+#endif
+
+#define XQC_PACING_BENCH_START_TIME     1000000000
+#define XQC_PACING_BENCH_MAX_RATES      16
+
+typedef enum {
+    XQC_PACING_BENCH_BUDGET,
+    XQC_PACING_BENCH_EDT,
+    XQC_PACING_BENCH_EDT_TXTIME,
+} xqc_pacing_bench_mode_t;
+
+static const char *xqc_pacing_bench_mode_str[] = {"budget", "edt", "edt+txtime"};
+
+typedef struct xqc_pacing_bench_result_s {
+    uint64_t    wakeups;
+    uint64_t    pkts;
+    double      avg_err;        /* mean absolute deviation from the ideal departure time, us */
+    double      max_err;
+    double      rate;           /* achieved rate, bytes per second */
+} xqc_pacing_bench_result_t;
+
+/* virtual clock, pacing is driven by the simulated timer events only */
+static xqc_usec_t xqc_pacing_bench_clock;
+static uint32_t xqc_pacing_bench_rate;
+
+static xqc_usec_t
+xqc_pacing_bench_now()
+{
+    return xqc_pacing_bench_clock;
+}
+
+static uint32_t
+xqc_pacing_bench_get_rate(void *cong)
+{
+    return xqc_pacing_bench_rate;
+}
+
+static ssize_t
+xqc_pacing_bench_write_txtime(uint64_t path_id, const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, xqc_usec_t txtime, void *user_data)
+{
+    return size;
+}
+
+static void
+xqc_pacing_bench_write_log(xqc_log_level_t lvl, const void *buf, size_t size, void *user_data)
+{
+    fprintf(stderr, "%.*s\n", (int)size, (const char *)buf);
+}
+
+static xqc_log_callbacks_t xqc_pacing_bench_log_cbs = {
+    .xqc_log_write_err = xqc_pacing_bench_write_log,
+};
+
+static int
+xqc_pacing_bench_run(xqc_log_t *log, xqc_pacing_bench_mode_t mode, uint64_t rate_bps,
+    uint32_t pkt_size, xqc_usec_t duration, xqc_pacing_bench_result_t *res)
+{
+    xqc_connection_t *conn = xqc_calloc(1, sizeof(xqc_connection_t));
+    xqc_send_ctl_t *send_ctl = xqc_calloc(1, sizeof(xqc_send_ctl_t));
+    xqc_cong_ctrl_callback_t cong_cb = {
+        .xqc_cong_ctl_get_pacing_rate = xqc_pacing_bench_get_rate,
+    };
+    xqc_timer_manager_t *manager;
+    xqc_pacing_t *pacing;
+    xqc_usec_t now, release, first = 0, departure = 0;
+    xqc_usec_t releases[XQC_MAX_SEND_MSG_ONCE];
+    double ideal, err, sum_err = 0;
+    uint32_t schedule_bytes;
+    int batch, ret = 0;
+
+    if (conn == NULL || send_ctl == NULL) {
+        xqc_free(send_ctl);
+        xqc_free(conn);
+        return -1;
+    }
+
+    memset(res, 0, sizeof(*res));
+    xqc_pacing_bench_rate = rate_bps / 8;
+    manager = &send_ctl->path_timer_manager;
+    pacing = &send_ctl->ctl_pacing;
+
+    conn->log = log;
+    conn->conn_settings.pacing_mode = mode == XQC_PACING_BENCH_BUDGET
+                                      ? XQC_PACING_MODE_BUDGET : XQC_PACING_MODE_EDT;
+    if (mode == XQC_PACING_BENCH_EDT_TXTIME) {
+        conn->transport_cbs.write_socket_txtime = xqc_pacing_bench_write_txtime;
+    }
+    send_ctl->ctl_conn = conn;
+    send_ctl->ctl_cong_callback = &cong_cb;
+
+    now = XQC_PACING_BENCH_START_TIME;
+    xqc_pacing_bench_clock = now;
+    xqc_timer_init(manager, log, send_ctl);
+    xqc_pacing_init(pacing, 1, send_ctl);
+
+    while (now < XQC_PACING_BENCH_START_TIME + duration) {
+        xqc_pacing_bench_clock = now;
+        xqc_timer_expire(manager, now);
+        res->wakeups++;
+
+        /* send as many batches as pacer allows */
+        do {
+            batch = 0;
+            schedule_bytes = 0;
+            while (batch < XQC_MAX_SEND_MSG_ONCE) {
+                if (mode == XQC_PACING_BENCH_BUDGET) {
+                    if (!xqc_pacing_can_write(pacing, pkt_size)) {
+                        break;
+                    }
+                    xqc_pacing_on_packet_sent(pacing, pkt_size);
+                    release = now;
+
+                } else if (!xqc_pacing_edt_can_write(pacing, schedule_bytes, now, &release)) {
+                    break;
+                }
+
+                releases[batch++] = release;
+                schedule_bytes += pkt_size;
+            }
+
+            for (int i = 0; i < batch; i++) {
+                if (mode != XQC_PACING_BENCH_BUDGET) {
+                    xqc_pacing_edt_on_packet_sent(pacing, pkt_size, releases[i]);
+                }
+
+                departure = mode == XQC_PACING_BENCH_EDT_TXTIME ? releases[i] : now;
+                if (res->pkts == 0) {
+                    first = departure;
+                }
+
+                ideal = first + res->pkts * (pkt_size * 1000000.0 / xqc_pacing_bench_rate);
+                err = fabs((double)departure - ideal);
+                sum_err += err;
+                res->max_err = xqc_max(res->max_err, err);
+                res->pkts++;
+            }
+        } while (batch == XQC_MAX_SEND_MSG_ONCE);
+
+        if (!xqc_timer_is_set(manager, XQC_TIMER_PACING)) {
+            /* a backlogged sender shall always be woken up by pacer */
+            ret = -1;
+            break;
+        }
+        now = manager->timer[XQC_TIMER_PACING].expire_time;
+    }
+
+    res->avg_err = res->pkts ? sum_err / res->pkts : 0;
+    res->rate = departure > first
+                ? (res->pkts - 1) * pkt_size * 1000000.0 / (departure - first) : 0;
+
+    xqc_free(send_ctl);
+    xqc_free(conn);
+    return ret;
+}
+
+
+static void
+xqc_pacing_bench_usage(const char *prog)
+{
+    printf("usage: %s [-r rate in Mbps, may be repeated] [-s packet size] [-d duration in ms]\n",
+           prog);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ch, ret = 0;
+    uint64_t rates[XQC_PACING_BENCH_MAX_RATES] = {1000, 10000};
+    size_t rate_cnt = 2, user_cnt = 0;
+    uint32_t pkt_size = 1200;
+    xqc_usec_t duration = 1000000;
+    xqc_pacing_bench_result_t res;
+    xqc_log_t *log;
+
+    while ((ch = getopt(argc, argv, "r:s:d:h")) != -1) {
+        switch (ch) {
+        case 'r':
+            if (user_cnt < XQC_PACING_BENCH_MAX_RATES) {
+                rates[user_cnt++] = xqc_max(strtoull(optarg, NULL, 10), 1);
+                rate_cnt = user_cnt;
+            }
+            break;
+        case 's':
+            pkt_size = xqc_min(xqc_max(strtoul(optarg, NULL, 10), 64), XQC_MAX_PACKET_OUT_SIZE);
+            break;
+        case 'd':
+            duration = xqc_max(strtoull(optarg, NULL, 10), 1) * 1000;
+            break;
+        default:
+            xqc_pacing_bench_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    log = xqc_log_init(XQC_LOG_WARN, XQC_FALSE, EVENT_IMPORTANCE_SELECTED, XQC_FALSE, XQC_TRUE,
+                       NULL, &xqc_pacing_bench_log_cbs, NULL);
+    if (log == NULL) {
+        return -1;
+    }
+
+    xqc_monotonic_timestamp = xqc_pacing_bench_now;
+
+    for (size_t i = 0; i < rate_cnt; i++) {
+        for (int mode = XQC_PACING_BENCH_BUDGET; mode <= XQC_PACING_BENCH_EDT_TXTIME; mode++) {
+            if (xqc_pacing_bench_run(log, mode, rates[i] * 1000000, pkt_size, duration,
+                                     &res) != 0)
+            {
+                printf("rate:%"PRIu64"Mbps|mode:%s|pacing timer not set\n", rates[i],
+                       xqc_pacing_bench_mode_str[mode]);
+                ret = -1;
+                continue;
+            }
+
+            printf("rate:%6"PRIu64"Mbps|mode:%-10s|avg_err:%8.2f us|max_err:%8.2f us"
+                   "|wakeups:%6"PRIu64"/s|achieved:%.3f Gbps\n",
+                   rates[i], xqc_pacing_bench_mode_str[mode], res.avg_err, res.max_err,
+                   res.wakeups * 1000000 / duration, res.rate * 8 / 1e9);
+        }
+    }
+
+    xqc_log_release(log);
+    return ret;
+}
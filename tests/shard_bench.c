@@ -0,0 +1,823 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+/*
+ * multi-core throughput of the sharded engine mode, with a server engine running on each
+ * shard. client threads open connections to a server socket on 127.0.0.1, each connection
+ * makes one request and is closed by client after the response. the dispatcher thread reads
+ * the server socket and dispatches datagrams to shards by dcid, and each shard thread passes
+ * its queue into its own engine and runs the timers of it. every connection takes a full
+ * handshake, so the run is dominated by handshakes and packet processing of server engines.
+ *
+ * the number of shards is doubled from 1 up to -w, as long as there are enough cpus for the
+ * clients, the dispatcher and all shards. connections and datagrams per second are reported
+ * for each shard count, along with the spread of connections over shards. with -e, cids are
+ * encrypted with single-pass load balance cid encryption, and decrypted by the dispatcher.
+ *
+ * usage: shard_bench -n <connections> -w <max shards> -l <client threads>
+ *                    -p <concurrent connections per client> -s <response size> -e
+ *                    -c <cert file> -k <key file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+#include "src/transport/xqc_shard.h"
+#include "src/transport/xqc_quic_lb.h"
+#include "src/common/xqc_time.h"
+
+#define XQC_SHARD_BENCH_ALPN            "transport"
+#define XQC_SHARD_BENCH_HOST            "bench.xquic.test"
+#define XQC_SHARD_BENCH_MAX_SHARDS      64
+#define XQC_SHARD_BENCH_MAX_CLIENTS     16
+#define XQC_SHARD_BENCH_MAX_RESP        (64 * 1024)
+#define XQC_SHARD_BENCH_CONF_ID         0x5a
+
+/* give up a run after this time */
+#define XQC_SHARD_BENCH_TIMEOUT         60000000
+
+typedef struct xqc_shard_bench_conf_s {
+    uint64_t                    conns;
+    uint32_t                    max_shards;
+    uint32_t                    clients;
+    uint32_t                    concurrency;
+    size_t                      resp_size;
+    int                         enc;
+    const char                 *cert_file;
+    const char                 *key_file;
+} xqc_shard_bench_conf_t;
+
+typedef struct xqc_shard_bench_shard_s {
+    const xqc_shard_bench_conf_t *conf;
+    xqc_shard_dispatcher_t     *dispatcher;
+    uint32_t                    shard_id;
+    xqc_engine_t               *engine;
+    xqc_usec_t                  wake_time;      /* 0 if no timer is set */
+    volatile int               *done;
+    int                         ready;          /* 1 if engine is bound, -1 for error */
+
+    uint64_t                    conns;
+    uint64_t                    pkts;
+} xqc_shard_bench_shard_t;
+
+typedef struct xqc_shard_bench_client_s {
+    const xqc_shard_bench_conf_t *conf;
+    int                         fd;
+    struct sockaddr_in          svr_addr;
+    xqc_engine_t               *engine;
+    xqc_usec_t                  wake_time;
+    volatile int               *stop;
+    int                         finished;
+
+    uint64_t                    conns;          /* connections to make */
+    uint64_t                    started;
+    uint64_t                    completed;
+    uint64_t                    closed;
+    uint32_t                    active;         /* requests in progress */
+
+    /* connections to close after their responses, closed out of engine callbacks */
+    xqc_cid_t                  *to_close;
+    uint32_t                    to_close_cnt;
+
+    unsigned char               buf[XQC_MAX_PACKET_IN_LEN];
+} xqc_shard_bench_client_t;
+
+/* a connection of client, which makes a single request */
+typedef struct xqc_shard_bench_req_s {
+    xqc_shard_bench_client_t   *cli;
+    xqc_cid_t                   cid;
+    int                         done;
+} xqc_shard_bench_req_t;
+
+/* a request stream of server */
+typedef struct xqc_shard_bench_resp_s {
+    const xqc_shard_bench_conf_t *conf;
+    size_t                      sent;
+    int                         requested;
+} xqc_shard_bench_resp_t;
+
+/* server engines write to the socket read by dispatcher */
+static int xqc_shard_bench_svr_fd = -1;
+static uint64_t xqc_shard_bench_svr_sent;
+
+static xqc_shard_bench_shard_t xqc_shard_bench_shards[XQC_SHARD_BENCH_MAX_SHARDS];
+static uint32_t xqc_shard_bench_shard_cnt;
+
+static const unsigned char xqc_shard_bench_resp_buf[XQC_SHARD_BENCH_MAX_RESP];
+
+
+static void
+xqc_shard_bench_write_log(xqc_log_level_t lvl, const void *buf, size_t size, void *user_data)
+{
+}
+
+static void
+xqc_shard_bench_set_event_timer(xqc_usec_t wake_after, void *user_data)
+{
+    /* engine user_data is the shard or the client which runs the engine */
+    *(xqc_usec_t *)user_data = xqc_monotonic_timestamp() + wake_after;
+}
+
+static ssize_t
+xqc_shard_bench_sendto(int fd, const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen)
+{
+    ssize_t ret = sendto(fd, buf, size, 0, peer_addr, peer_addrlen);
+    if (ret < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? XQC_SOCKET_EAGAIN : XQC_SOCKET_ERROR;
+    }
+    return ret;
+}
+
+static ssize_t
+xqc_shard_bench_svr_write_socket(const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, void *user_data)
+{
+    __atomic_fetch_add(&xqc_shard_bench_svr_sent, 1, __ATOMIC_RELAXED);
+    return xqc_shard_bench_sendto(xqc_shard_bench_svr_fd, buf, size, peer_addr, peer_addrlen);
+}
+
+static ssize_t
+xqc_shard_bench_svr_stateless_reset(const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+    const struct sockaddr *local_addr, socklen_t local_addrlen, void *user_data)
+{
+    return xqc_shard_bench_sendto(xqc_shard_bench_svr_fd, buf, size, peer_addr, peer_addrlen);
+}
+
+static ssize_t
+xqc_shard_bench_cli_write_socket(const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, void *user_data)
+{
+    xqc_shard_bench_req_t *req = user_data;
+    return xqc_shard_bench_sendto(req->cli->fd, buf, size, peer_addr, peer_addrlen);
+}
+
+static int
+xqc_shard_bench_server_accept(xqc_engine_t *engine, xqc_connection_t *conn,
+    const xqc_cid_t *cid, void *user_data)
+{
+    for (uint32_t i = 0; i < xqc_shard_bench_shard_cnt; i++) {
+        if (xqc_shard_bench_shards[i].engine == engine) {
+            xqc_conn_set_transport_user_data(conn, &xqc_shard_bench_shards[i]);
+            xqc_shard_bench_shards[i].conns++;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void
+xqc_shard_bench_server_refuse(xqc_engine_t *engine, xqc_connection_t *conn,
+    const xqc_cid_t *cid, void *user_data)
+{
+}
+
+static void
+xqc_shard_bench_save_token(const unsigned char *token, uint32_t token_len, void *user_data)
+{
+}
+
+static void
+xqc_shard_bench_save_string(const char *data, size_t data_len, void *user_data)
+{
+}
+
+static int
+xqc_shard_bench_cert_verify(const unsigned char *certs[], const size_t cert_len[],
+    size_t certs_len, void *user_data)
+{
+    return 0;
+}
+
+static void
+xqc_shard_bench_update_cid(xqc_connection_t *conn, const xqc_cid_t *retire_cid,
+    const xqc_cid_t *new_cid, void *user_data)
+{
+}
+
+static int
+xqc_shard_bench_conn_notify(xqc_connection_t *conn, const xqc_cid_t *cid, void *user_data,
+    void *conn_proto_data)
+{
+    return 0;
+}
+
+static int
+xqc_shard_bench_cli_conn_close(xqc_connection_t *conn, const xqc_cid_t *cid, void *user_data,
+    void *conn_proto_data)
+{
+    xqc_shard_bench_req_t *req = user_data;
+    xqc_shard_bench_client_t *cli = req->cli;
+
+    cli->closed++;
+    if (!req->done) {
+        /* failed before the response */
+        cli->active--;
+    }
+    free(req);
+    return 0;
+}
+
+static int
+xqc_shard_bench_stream_notify(xqc_stream_t *stream, void *user_data)
+{
+    return 0;
+}
+
+
+/* server sends the response until blocked by flow or congestion control */
+static int
+xqc_shard_bench_svr_send(xqc_stream_t *stream, xqc_shard_bench_resp_t *resp)
+{
+    ssize_t ret;
+
+    while (resp->requested && resp->sent < resp->conf->resp_size) {
+        ret = xqc_stream_send(stream, (unsigned char *)xqc_shard_bench_resp_buf + resp->sent,
+                              resp->conf->resp_size - resp->sent, 1);
+        if (ret == -XQC_EAGAIN) {
+            break;
+
+        } else if (ret < 0) {
+            return (int)ret;
+        }
+
+        resp->sent += ret;
+    }
+
+    return 0;
+}
+
+static int
+xqc_shard_bench_svr_stream_create(xqc_stream_t *stream, void *user_data)
+{
+    xqc_shard_bench_shard_t *shard = xqc_get_conn_user_data_by_stream(stream);
+    xqc_shard_bench_resp_t *resp = calloc(1, sizeof(xqc_shard_bench_resp_t));
+
+    if (resp == NULL) {
+        return -1;
+    }
+    resp->conf = shard->conf;
+    xqc_stream_set_user_data(stream, resp);
+    return 0;
+}
+
+static int
+xqc_shard_bench_svr_stream_read(xqc_stream_t *stream, void *user_data)
+{
+    xqc_shard_bench_resp_t *resp = user_data;
+    unsigned char buf[256];
+    ssize_t ret;
+    uint8_t fin = 0;
+
+    do {
+        ret = xqc_stream_recv(stream, buf, sizeof(buf), &fin);
+    } while (ret > 0 && !fin);
+
+    if (fin && !resp->requested) {
+        resp->requested = 1;
+        return xqc_shard_bench_svr_send(stream, resp);
+    }
+
+    return 0;
+}
+
+static int
+xqc_shard_bench_svr_stream_write(xqc_stream_t *stream, void *user_data)
+{
+    return xqc_shard_bench_svr_send(stream, user_data);
+}
+
+static int
+xqc_shard_bench_svr_stream_close(xqc_stream_t *stream, void *user_data)
+{
+    free(user_data);
+    return 0;
+}
+
+static int
+xqc_shard_bench_cli_stream_read(xqc_stream_t *stream, void *user_data)
+{
+    xqc_shard_bench_req_t *req = user_data;
+    xqc_shard_bench_client_t *cli = req->cli;
+    ssize_t ret;
+    uint8_t fin = 0;
+
+    do {
+        ret = xqc_stream_recv(stream, cli->buf, sizeof(cli->buf), &fin);
+    } while (ret > 0 && !fin);
+
+    if (fin && !req->done) {
+        req->done = 1;
+        cli->completed++;
+        cli->active--;
+        cli->to_close[cli->to_close_cnt++] = req->cid;
+    }
+
+    return 0;
+}
+
+
+static xqc_engine_t *
+xqc_shard_bench_create_engine(xqc_engine_type_t type, const xqc_shard_bench_conf_t *conf,
+    void *user_data)
+{
+    xqc_config_t config;
+    xqc_engine_ssl_config_t ssl_config;
+    xqc_engine_t *engine;
+
+    if (xqc_engine_get_default_config(&config, type) < 0) {
+        return NULL;
+    }
+    config.cfg_log_level = XQC_LOG_ERROR;
+    if (type == XQC_ENGINE_SERVER) {
+        config.cid_len = conf->enc ? XQC_FIRST_OCTET + XQC_EN_SINGLE_PASS_ENCRYPTION_LEN : 8;
+    }
+
+    memset(&ssl_config, 0, sizeof(ssl_config));
+    ssl_config.ciphers = XQC_TLS_CIPHERS;
+    ssl_config.groups = XQC_TLS_GROUPS;
+    if (type == XQC_ENGINE_SERVER) {
+        ssl_config.private_key_file = (char *)conf->key_file;
+        ssl_config.cert_file = (char *)conf->cert_file;
+    }
+
+    xqc_engine_callback_t callback = {
+        .set_event_timer = xqc_shard_bench_set_event_timer,
+        .log_callbacks = {
+            .xqc_log_write_err = xqc_shard_bench_write_log,
+            .xqc_log_write_stat = xqc_shard_bench_write_log,
+        },
+    };
+
+    xqc_transport_callbacks_t tcbs = {
+        .server_accept = xqc_shard_bench_server_accept,
+        .server_refuse = xqc_shard_bench_server_refuse,
+        .write_socket = type == XQC_ENGINE_SERVER
+            ? xqc_shard_bench_svr_write_socket : xqc_shard_bench_cli_write_socket,
+        .stateless_reset = xqc_shard_bench_svr_stateless_reset,
+        .conn_update_cid_notify = xqc_shard_bench_update_cid,
+        .save_token = xqc_shard_bench_save_token,
+        .save_session_cb = xqc_shard_bench_save_string,
+        .save_tp_cb = xqc_shard_bench_save_string,
+        .cert_verify_cb = xqc_shard_bench_cert_verify,
+    };
+
+    engine = xqc_engine_create(type, &config, &ssl_config, &callback, &tcbs, user_data);
+    if (engine == NULL) {
+        return NULL;
+    }
+
+    xqc_app_proto_callbacks_t ap_cbs = {
+        .conn_cbs = {
+            .conn_create_notify = xqc_shard_bench_conn_notify,
+            .conn_close_notify = type == XQC_ENGINE_SERVER
+                ? xqc_shard_bench_conn_notify : xqc_shard_bench_cli_conn_close,
+        },
+        .stream_cbs = {
+            .stream_read_notify = type == XQC_ENGINE_SERVER
+                ? xqc_shard_bench_svr_stream_read : xqc_shard_bench_cli_stream_read,
+            .stream_write_notify = type == XQC_ENGINE_SERVER
+                ? xqc_shard_bench_svr_stream_write : xqc_shard_bench_stream_notify,
+            .stream_create_notify = type == XQC_ENGINE_SERVER
+                ? xqc_shard_bench_svr_stream_create : xqc_shard_bench_stream_notify,
+            .stream_close_notify = type == XQC_ENGINE_SERVER
+                ? xqc_shard_bench_svr_stream_close : xqc_shard_bench_stream_notify,
+        },
+    };
+
+    if (xqc_engine_register_alpn(engine, XQC_SHARD_BENCH_ALPN, strlen(XQC_SHARD_BENCH_ALPN),
+                                 &ap_cbs, NULL) != XQC_OK)
+    {
+        xqc_engine_destroy(engine);
+        return NULL;
+    }
+
+    return engine;
+}
+
+/* run the timers of an engine if they are due */
+static void
+xqc_shard_bench_run_timer(xqc_engine_t *engine, xqc_usec_t *wake_time)
+{
+    if (*wake_time != 0 && xqc_monotonic_timestamp() >= *wake_time) {
+        *wake_time = 0;
+        xqc_engine_main_logic(engine);
+    }
+}
+
+static void *
+xqc_shard_bench_shard_main(void *arg)
+{
+    xqc_shard_bench_shard_t *s = arg;
+    xqc_int_t n;
+
+    /* engine lives on the thread of shard */
+    s->engine = xqc_shard_bench_create_engine(XQC_ENGINE_SERVER, s->conf, &s->wake_time);
+    if (s->engine == NULL
+        || xqc_shard_dispatcher_bind_engine(s->dispatcher, s->shard_id, s->engine) != XQC_OK)
+    {
+        __atomic_store_n(&s->ready, -1, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    __atomic_store_n(&s->ready, 1, __ATOMIC_RELEASE);
+
+    while (!__atomic_load_n(s->done, __ATOMIC_ACQUIRE)) {
+        n = xqc_shard_process(s->dispatcher, s->shard_id, 0);
+        if (n > 0) {
+            s->pkts += n;
+        }
+
+        xqc_shard_bench_run_timer(s->engine, &s->wake_time);
+        if (n <= 0) {
+            sched_yield();
+        }
+    }
+
+    xqc_engine_destroy(s->engine);
+    return NULL;
+}
+
+static int
+xqc_shard_bench_connect(xqc_shard_bench_client_t *cli, const xqc_conn_settings_t *settings)
+{
+    xqc_conn_ssl_config_t ssl_cfg;
+    xqc_shard_bench_req_t *req;
+    xqc_stream_t *stream;
+    const xqc_cid_t *cid;
+
+    req = calloc(1, sizeof(xqc_shard_bench_req_t));
+    if (req == NULL) {
+        return -1;
+    }
+    req->cli = cli;
+
+    memset(&ssl_cfg, 0, sizeof(ssl_cfg));
+    cid = xqc_connect(cli->engine, settings, NULL, 0, XQC_SHARD_BENCH_HOST, 0, &ssl_cfg,
+                      (struct sockaddr *)&cli->svr_addr, sizeof(cli->svr_addr),
+                      XQC_SHARD_BENCH_ALPN, req);
+    if (cid == NULL) {
+        free(req);
+        return -1;
+    }
+    req->cid = *cid;
+    cli->started++;
+    cli->active++;
+
+    /* a failed request is closed with its connection */
+    stream = xqc_stream_create(cli->engine, &req->cid, NULL, req);
+    if (stream == NULL || xqc_stream_send(stream, (unsigned char *)"GET", 3, 1) < 0) {
+        xqc_conn_close(cli->engine, &req->cid);
+    }
+    return 0;
+}
+
+static void *
+xqc_shard_bench_client_main(void *arg)
+{
+    xqc_shard_bench_client_t *cli = arg;
+    struct sockaddr_in peer;
+    socklen_t peerlen;
+    struct pollfd pfd = {.fd = cli->fd, .events = POLLIN};
+    xqc_conn_settings_t settings;
+    xqc_usec_t now;
+    ssize_t n;
+    int timeout, failed = 0;
+
+    memset(&settings, 0, sizeof(settings));
+    settings.cong_ctrl_callback = xqc_cubic_cb;
+    settings.proto_version = XQC_VERSION_V1;
+
+    cli->engine = xqc_shard_bench_create_engine(XQC_ENGINE_CLIENT, cli->conf, &cli->wake_time);
+    if (cli->engine == NULL) {
+        __atomic_store_n(&cli->finished, 1, __ATOMIC_RELEASE);
+        return NULL;
+    }
+
+    while (!__atomic_load_n(cli->stop, __ATOMIC_ACQUIRE)
+           && (cli->started < cli->conns || cli->closed < cli->started))
+    {
+        while (cli->started + failed < cli->conns && cli->active < cli->conf->concurrency) {
+            if (xqc_shard_bench_connect(cli, &settings) != 0) {
+                failed++;
+            }
+        }
+        if (cli->started + failed == cli->conns && cli->closed == cli->started) {
+            break;
+        }
+
+        /* wait for datagrams until the next timer */
+        timeout = 1;
+        if (cli->wake_time != 0) {
+            now = xqc_monotonic_timestamp();
+            timeout = cli->wake_time > now ? (int)((cli->wake_time - now + 999) / 1000) : 0;
+            timeout = timeout < 1000 ? timeout : 1000;
+        }
+
+        if (poll(&pfd, 1, timeout) > 0) {
+            for (;;) {
+                peerlen = sizeof(peer);
+                n = recvfrom(cli->fd, cli->buf, sizeof(cli->buf), MSG_DONTWAIT,
+                             (struct sockaddr *)&peer, &peerlen);
+                if (n < 0) {
+                    break;
+                }
+                xqc_engine_packet_process(cli->engine, cli->buf, n,
+                                          (struct sockaddr *)&cli->svr_addr,
+                                          sizeof(cli->svr_addr), (struct sockaddr *)&peer,
+                                          peerlen, xqc_monotonic_timestamp(), NULL);
+            }
+            xqc_engine_finish_recv(cli->engine);
+        }
+
+        xqc_shard_bench_run_timer(cli->engine, &cli->wake_time);
+
+        for (uint32_t i = 0; i < cli->to_close_cnt; i++) {
+            xqc_conn_close(cli->engine, &cli->to_close[i]);
+        }
+        cli->to_close_cnt = 0;
+    }
+
+    xqc_engine_destroy(cli->engine);
+    __atomic_store_n(&cli->finished, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static int
+xqc_shard_bench_udp_socket(struct sockaddr_in *addr)
+{
+    socklen_t addrlen = sizeof(*addr);
+    int fd, buf_size = 8 * 1024 * 1024;
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)addr, sizeof(*addr)) != 0
+        || getsockname(fd, (struct sockaddr *)addr, &addrlen) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buf_size, sizeof(buf_size));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buf_size, sizeof(buf_size));
+    return fd;
+}
+
+static int
+xqc_shard_bench_run(const xqc_shard_bench_conf_t *conf, uint32_t nshards)
+{
+    xqc_shard_config_t config = {
+        .shard_count = nshards,
+        .queue_capacity = 4096,
+        .conf_id = XQC_SHARD_BENCH_CONF_ID,
+        .cid_len = conf->enc ? XQC_FIRST_OCTET + XQC_EN_SINGLE_PASS_ENCRYPTION_LEN : 8,
+        .lb_cid_enc_on = conf->enc,
+    };
+    xqc_shard_bench_client_t clients[XQC_SHARD_BENCH_MAX_CLIENTS];
+    pthread_t shard_threads[XQC_SHARD_BENCH_MAX_SHARDS];
+    pthread_t client_threads[XQC_SHARD_BENCH_MAX_CLIENTS];
+    struct sockaddr_in svr_addr, peer;
+    socklen_t peerlen;
+    struct timeval tv = {.tv_sec = 0, .tv_usec = 10000};
+    unsigned char buf[XQC_MAX_PACKET_IN_LEN];
+    volatile int done = 0, stop = 0;
+    uint64_t received = 0, full = 0, completed = 0, processed = 0;
+    uint64_t min_conns = UINT64_MAX, max_conns = 0;
+    uint32_t started_shards = 0, started_clients = 0, exited;
+    xqc_usec_t start, cost;
+    xqc_int_t ret;
+    ssize_t n;
+    int rc = -1;
+    xqc_shard_dispatcher_t *d;
+
+    memset(clients, 0, sizeof(clients));
+    for (int i = 0; i < XQC_LB_CID_KEY_LEN; i++) {
+        config.lb_cid_key[i] = (uint8_t)(i * 17 + 1);
+    }
+
+    d = xqc_shard_dispatcher_create(&config);
+    if (d == NULL) {
+        printf("shards:%u|create dispatcher error\n", nshards);
+        return -1;
+    }
+
+    xqc_shard_bench_svr_fd = xqc_shard_bench_udp_socket(&svr_addr);
+    if (xqc_shard_bench_svr_fd < 0) {
+        printf("loopback socket unavailable\n");
+        goto end;
+    }
+    setsockopt(xqc_shard_bench_svr_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    xqc_shard_bench_svr_sent = 0;
+
+    /* engines are created and bound on their shard threads before any datagram is read */
+    xqc_shard_bench_shard_cnt = nshards;
+    memset(xqc_shard_bench_shards, 0, sizeof(xqc_shard_bench_shards));
+    for (uint32_t i = 0; i < nshards; i++) {
+        xqc_shard_bench_shards[i] = (xqc_shard_bench_shard_t) {
+            .conf = conf, .dispatcher = d, .shard_id = i, .done = &done,
+        };
+        if (pthread_create(&shard_threads[i], NULL, xqc_shard_bench_shard_main,
+                           &xqc_shard_bench_shards[i]) != 0)
+        {
+            goto stop_shards;
+        }
+        started_shards++;
+    }
+    for (uint32_t i = 0; i < nshards; i++) {
+        while ((ret = __atomic_load_n(&xqc_shard_bench_shards[i].ready, __ATOMIC_ACQUIRE)) == 0) {
+            sched_yield();
+        }
+        if (ret < 0) {
+            printf("shards:%u|create server engine error\n", nshards);
+            goto stop_shards;
+        }
+    }
+
+    start = xqc_monotonic_timestamp();
+    for (uint32_t i = 0; i < conf->clients; i++) {
+        clients[i].conf = conf;
+        clients[i].svr_addr = svr_addr;
+        clients[i].stop = &stop;
+        clients[i].conns = conf->conns / conf->clients + (i < conf->conns % conf->clients);
+        clients[i].to_close = calloc(conf->concurrency, sizeof(xqc_cid_t));
+        clients[i].fd = xqc_shard_bench_udp_socket(&peer);
+        if (clients[i].to_close == NULL || clients[i].fd < 0
+            || pthread_create(&client_threads[i], NULL, xqc_shard_bench_client_main,
+                              &clients[i]) != 0)
+        {
+            printf("shards:%u|create client error\n", nshards);
+            stop = 1;
+            break;
+        }
+        started_clients++;
+    }
+
+    /* dispatcher, until all clients are finished */
+    for (;;) {
+        peerlen = sizeof(peer);
+        n = recvfrom(xqc_shard_bench_svr_fd, buf, sizeof(buf), 0, (struct sockaddr *)&peer,
+                     &peerlen);
+        if (n >= 0) {
+            received++;
+            while ((ret = xqc_shard_dispatch(d, buf, n, (struct sockaddr *)&svr_addr,
+                                             sizeof(svr_addr), (struct sockaddr *)&peer,
+                                             peerlen, xqc_monotonic_timestamp()))
+                   == -XQC_EAGAIN)
+            {
+                full++;
+                sched_yield();
+            }
+            continue;
+        }
+
+        /* no datagram for a while, check whether clients are finished */
+        exited = 0;
+        for (uint32_t i = 0; i < started_clients; i++) {
+            exited += __atomic_load_n(&clients[i].finished, __ATOMIC_ACQUIRE);
+        }
+        if (exited == started_clients) {
+            break;
+        }
+        if (xqc_monotonic_timestamp() - start > XQC_SHARD_BENCH_TIMEOUT) {
+            stop = 1;
+        }
+    }
+    cost = xqc_monotonic_timestamp() - start;
+
+    for (uint32_t i = 0; i < started_clients; i++) {
+        pthread_join(client_threads[i], NULL);
+        completed += clients[i].completed;
+    }
+
+stop_shards:
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    for (uint32_t i = 0; i < started_shards; i++) {
+        pthread_join(shard_threads[i], NULL);
+    }
+
+    if (started_clients == 0) {
+        goto end;
+    }
+
+    for (uint32_t i = 0; i < nshards; i++) {
+        processed += xqc_shard_bench_shards[i].pkts;
+        min_conns = xqc_min(min_conns, xqc_shard_bench_shards[i].conns);
+        max_conns = xqc_max(max_conns, xqc_shard_bench_shards[i].conns);
+    }
+
+    printf("shards:%u|conns:%"PRIu64"/%"PRIu64"|%.0f conn/s|rx:%.1f Kpps|tx:%.1f Kpps"
+           "|conns_per_shard:%"PRIu64"-%"PRIu64"|queue_full_retries:%"PRIu64"\n",
+           nshards, completed, conf->conns, cost ? completed * 1e6 / cost : 0,
+           cost ? processed * 1e3 / cost : 0,
+           cost ? xqc_shard_bench_svr_sent * 1e3 / cost : 0, min_conns, max_conns, full);
+
+    rc = (completed == conf->conns && processed == received) ? 0 : -1;
+
+end:
+    for (uint32_t i = 0; i < conf->clients; i++) {
+        if (clients[i].fd > 0) {
+            close(clients[i].fd);
+        }
+        free(clients[i].to_close);
+    }
+    if (xqc_shard_bench_svr_fd >= 0) {
+        close(xqc_shard_bench_svr_fd);
+        xqc_shard_bench_svr_fd = -1;
+    }
+    xqc_shard_bench_shard_cnt = 0;
+    xqc_shard_dispatcher_destroy(d);
+    return rc;
+}
+
+
+static void
+xqc_shard_bench_usage(const char *prog)
+{
+    printf("usage: %s [-n connections] [-w max shards] [-l client threads]\n"
+           "    [-p concurrent connections per client] [-s response size] [-e encrypt cids]\n"
+           "    [-c cert file] [-k key file]\n", prog);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ch, ret = 0;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    xqc_shard_bench_conf_t conf = {
+        .conns          = 20000,
+        .max_shards     = 8,
+        .clients        = 2,
+        .concurrency    = 64,
+        .resp_size      = 1024,
+        .enc            = 0,
+        .cert_file      = "./server.crt",
+        .key_file       = "./server.key",
+    };
+
+    while ((ch = getopt(argc, argv, "n:w:l:p:s:ec:k:h")) != -1) {
+        switch (ch) {
+        case 'n':
+            conf.conns = xqc_max(strtoull(optarg, NULL, 10), 1);
+            break;
+        case 'w':
+            conf.max_shards = xqc_min(xqc_max(strtoul(optarg, NULL, 10), 1),
+                                      XQC_SHARD_BENCH_MAX_SHARDS);
+            break;
+        case 'l':
+            conf.clients = xqc_min(xqc_max(strtoul(optarg, NULL, 10), 1),
+                                   XQC_SHARD_BENCH_MAX_CLIENTS);
+            break;
+        case 'p':
+            conf.concurrency = xqc_max(strtoul(optarg, NULL, 10), 1);
+            break;
+        case 's':
+            conf.resp_size = xqc_min(strtoul(optarg, NULL, 10), XQC_SHARD_BENCH_MAX_RESP);
+            break;
+        case 'e':
+            conf.enc = 1;
+            break;
+        case 'c':
+            conf.cert_file = optarg;
+            break;
+        case 'k':
+            conf.key_file = optarg;
+            break;
+        default:
+            xqc_shard_bench_usage(argv[0]);
+            return 0;
+        }
+    }
+    conf.clients = xqc_min(conf.clients, conf.conns);
+
+    /* one cpu for each client, one for dispatcher */
+    for (uint32_t n = 1; n <= conf.max_shards; n <<= 1) {
+        if (n > 1 && n + conf.clients + 1 > ncpu) {
+            break;
+        }
+        if (xqc_shard_bench_run(&conf, n) != 0) {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
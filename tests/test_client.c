@@ -4590,6 +4590,12 @@ xqc_client_set_fec_scheme(uint64_t in, xqc_fec_schemes_e *out)
     case XQC_RAPTORQ_CODE:
         *out = XQC_RAPTORQ_CODE;
         return XQC_OK;
+    case XQC_RLC_CODE:
+        *out = XQC_RLC_CODE;
+        return XQC_OK;
+    case XQC_REED_SOLOMON_16_CODE:
+        *out = XQC_REED_SOLOMON_16_CODE;
+        return XQC_OK;
     default:
         break;
     }
@@ -4665,6 +4671,7 @@ void usage(int argc, char *argv[])
         "   -P    Number of Parallel requests per single connection. Default 1.\n"
         "   -n    Total number of requests to send. Defaults 1.\n"
         "   -c    Congestion Control Algorithm. r:reno b:bbr c:cubic B:bbr2 bbr+ bbr2+ P:copa\n"
+        "         L/O/A:coupled multipath LIA/OLIA/BALIA\n"
         "   -C    Pacing on.\n"
         "   -t    Connection timeout. Default 3 seconds.\n"
         "   -T    Transport protocol: 0 H3 (default), 1 Transport layer, 2 H3-ext.\n"
@@ -5177,6 +5184,7 @@ int main(int argc, char *argv[])
     // 拥塞控制相关回调和标志
     xqc_cong_ctrl_callback_t cong_ctrl;
     uint32_t cong_flags = 0;
+    xqc_coupled_algo_t coupled_algo = XQC_COUPLED_LIA;
     if (c_cong_ctl == 'b')
     {
         cong_ctrl = xqc_bbr_cb;
@@ -5198,6 +5206,12 @@ int main(int argc, char *argv[])
     {
         cong_ctrl = xqc_cubic_cb;
     }
+    else if (c_cong_ctl == 'L' || c_cong_ctl == 'O' || c_cong_ctl == 'A')
+    {
+        cong_ctrl = xqc_coupled_cb;
+        coupled_algo = c_cong_ctl == 'O' ? XQC_COUPLED_OLIA
+                       : (c_cong_ctl == 'A' ? XQC_COUPLED_BALIA : XQC_COUPLED_LIA);
+    }
 #ifdef XQC_ENABLE_BBR2
     else if (c_cong_ctl == 'B')
     {
@@ -5226,7 +5240,7 @@ int main(int argc, char *argv[])
 #endif
     else
     {
-        printf("unknown cong_ctrl, option is b, r, c, B, bbr+, bbr2+, u\n");
+        printf("unknown cong_ctrl, option is b, r, c, B, bbr+, bbr2+, u, L, O, A\n");
         return -1;
     }
     printf("congestion control flags: %x\n", cong_flags);
@@ -5242,6 +5256,7 @@ int main(int argc, char *argv[])
             .cc_optimization_flags = cong_flags,
             .copa_delta_ai_unit = g_copa_ai,
             .copa_delta_base = g_copa_delta,
+            .coupled_algo = coupled_algo,
         },
         .spurious_loss_detect_on = 0,
         .keyupdate_pkt_threshold = 0,
@@ -16,6 +16,11 @@
 #include "xqc_recv_record_test.h"
 #include "xqc_reno_test.h"
 #include "xqc_cubic_test.h"
+#include "xqc_coupled_cc_test.h"
+#include "xqc_hystart_test.h"
+#include "xqc_prague_test.h"
+#include "xqc_ack_frequency_test.h"
+#include "xqc_netsim_test.h"
 #include "xqc_packet_test.h"
 #include "xqc_stream_frame_test.h"
 #include "xqc_process_frame_test.h"
@@ -29,10 +34,17 @@
 #include "utils/xqc_ring_array_test.h"
 #include "utils/xqc_ring_mem_test.h"
 #include "utils/xqc_huffman_test.h"
+#include "utils/xqc_timer_wheel_test.h"
+#include "utils/xqc_oa_hash_test.h"
+#include "utils/xqc_cm_sketch_test.h"
 #include "xqc_encoder_test.h"
 #include "xqc_qpack_test.h"
 #include "xqc_prefixed_str_test.h"
 #include "xqc_cid_test.h"
+#include "xqc_shard_test.h"
+#include "xqc_binlog_test.h"
+#include "xqc_session_store_test.h"
+#include "xqc_pacing_test.h"
 #include "xqc_id_hash_test.h"
 #include "xqc_retry_test.h"
 #include "xqc_datagram_test.h"
@@ -40,7 +52,11 @@
 #include "xqc_galois_test.h"
 #include "xqc_fec_scheme_test.h"
 #include "xqc_fec_test.h"
+#include "xqc_fec_rlc_test.h"
+#include "xqc_fec_rs16_test.h"
+#include "xqc_fec_codec_test.h"
 #include "xqc_ack_with_timestamp_test.h"
+#include "xqc_ecn_test.h"
 
 static int xqc_init_suite(void) { return 0; }
 static int xqc_clean_suite(void) { return 0; }
@@ -65,17 +81,26 @@ main()
     if (!CU_add_test(pSuite, "xqc_test_get_random", xqc_test_get_random)
         || !CU_add_test(pSuite, "xqc_test_engine_create", xqc_test_engine_create)
         || !CU_add_test(pSuite, "xqc_test_conn_create", xqc_test_conn_create)
+        || !CU_add_test(pSuite, "xqc_test_conn_log_override", xqc_test_conn_log_override)
         || !CU_add_test(pSuite, "xqc_test_pq", xqc_test_pq)
         || !CU_add_test(pSuite, "xqc_test_common", xqc_test_common)
         || !CU_add_test(pSuite, "xqc_test_vint", xqc_test_vint)
         || !CU_add_test(pSuite, "xqc_test_recv_record", xqc_test_recv_record)
         || !CU_add_test(pSuite, "xqc_test_reno", xqc_test_reno)
         || !CU_add_test(pSuite, "xqc_test_cubic", xqc_test_cubic)
+        || !CU_add_test(pSuite, "xqc_test_coupled_cc", xqc_test_coupled_cc)
+        || !CU_add_test(pSuite, "xqc_test_hystart", xqc_test_hystart)
+        || !CU_add_test(pSuite, "xqc_test_prague", xqc_test_prague)
+        || !CU_add_test(pSuite, "xqc_test_ack_frequency", xqc_test_ack_frequency)
+        || !CU_add_test(pSuite, "xqc_test_netsim", xqc_test_netsim)
         || !CU_add_test(pSuite, "xqc_test_short_header_parse_cid", xqc_test_short_header_packet_parse_cid)
         || !CU_add_test(pSuite, "xqc_test_long_header_parse_cid", xqc_test_long_header_packet_parse_cid)
         || !CU_add_test(pSuite, "xqc_test_empty_pkt", xqc_test_empty_pkt)
         || !CU_add_test(pSuite, "xqc_test_engine_packet_process", xqc_test_engine_packet_process)
+        || !CU_add_test(pSuite, "xqc_test_engine_perf_stats", xqc_test_engine_perf_stats)
+        || !CU_add_test(pSuite, "xqc_test_engine_conn_cache", xqc_test_engine_conn_cache)
         || !CU_add_test(pSuite, "xqc_test_stream_frame", xqc_test_stream_frame)
+        || !CU_add_test(pSuite, "xqc_test_stream_write_schedule", xqc_test_stream_write_schedule)
         || !CU_add_test(pSuite, "xqc_test_process_frame", xqc_test_process_frame)
         || !CU_add_test(pSuite, "xqc_test_parse_padding_frame", xqc_test_parse_padding_frame)
         || !CU_add_test(pSuite, "xqc_test_large_ack_frame", xqc_test_large_ack_frame)
@@ -90,12 +115,20 @@ main()
         || !CU_add_test(pSuite, "test_ring_array", test_ring_array)
         || !CU_add_test(pSuite, "xqc_test_ring_mem", xqc_test_ring_mem)
         || !CU_add_test(pSuite, "xqc_test_huffman", xqc_test_huffman)
+        || !CU_add_test(pSuite, "xqc_test_timer_wheel", xqc_test_timer_wheel)
+        || !CU_add_test(pSuite, "xqc_test_oa_hash", xqc_test_oa_hash)
+        || !CU_add_test(pSuite, "xqc_test_cm_sketch", xqc_test_cm_sketch)
         || !CU_add_test(pSuite, "xqc_test_encoder", xqc_test_encoder)
         || !CU_add_test(pSuite, "xqc_test_h3_ins", xqc_test_ins)
         || !CU_add_test(pSuite, "xqc_test_h3_rep", xqc_test_rep)
+        || !CU_add_test(pSuite, "xqc_test_h3_headers_alloc", xqc_test_h3_headers_alloc)
         || !CU_add_test(pSuite, "xqc_qpack_test", xqc_qpack_test)
         || !CU_add_test(pSuite, "xqc_test_prefixed_str", xqc_test_prefixed_str)
         || !CU_add_test(pSuite, "xqc_cid_test", xqc_test_cid)
+        || !CU_add_test(pSuite, "xqc_test_shard", xqc_test_shard)
+        || !CU_add_test(pSuite, "xqc_test_binlog", xqc_test_binlog)
+        || !CU_add_test(pSuite, "xqc_test_session_store", xqc_test_session_store)
+        || !CU_add_test(pSuite, "xqc_test_pacing", xqc_test_pacing)
         || !CU_add_test(pSuite, "xqc_test_id_hash", xqc_test_id_hash)
         || !CU_add_test(pSuite, "xqc_test_retry", xqc_test_retry)
         || !CU_add_test(pSuite, "xqc_test_receive_invalid_dgram", xqc_test_receive_invalid_dgram)
@@ -104,8 +137,16 @@ main()
         || !CU_add_test(pSuite, "xqc_test_galois_calculation", xqc_test_galois_calculation)
         || !CU_add_test(pSuite, "xqc_test_fec_scheme", xqc_test_fec_scheme)
         || !CU_add_test(pSuite, "xqc_test_fec", xqc_test_fec)
+        || !CU_add_test(pSuite, "xqc_test_fec_codec", xqc_test_fec_codec)
+#endif
+#ifdef XQC_ENABLE_RLC
+        || !CU_add_test(pSuite, "xqc_test_fec_rlc", xqc_test_fec_rlc)
+#endif
+#ifdef XQC_ENABLE_RS16
+        || !CU_add_test(pSuite, "xqc_test_fec_rs16", xqc_test_fec_rs16)
 #endif
         || !CU_add_test(pSuite, "xqc_test_ack_with_timestamp", xqc_test_ack_with_timestamp)
+        || !CU_add_test(pSuite, "xqc_test_ecn", xqc_test_ecn)
         /* ADD TESTS HERE */) 
     {
         CU_cleanup_registry();
@@ -0,0 +1,72 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_cm_sketch_test.h"
+#include "src/common/utils/cm_sketch/xqc_cm_sketch.h"
+
+
+#define XQC_TEST_CM_SKETCH_WIDTH    256
+#define XQC_TEST_CM_SKETCH_KEYS     200
+
+static uint64_t
+xqc_test_cm_sketch_key(uint64_t i)
+{
+    return (i + 1) * 0x9e3779b97f4a7c15ULL;
+}
+
+void
+xqc_test_cm_sketch()
+{
+    xqc_cm_sketch_t *cms;
+    uint32_t est;
+    uint64_t i, over = 0;
+
+    CU_ASSERT(xqc_cm_sketch_create(0) == NULL);
+
+    cms = xqc_cm_sketch_create(XQC_TEST_CM_SKETCH_WIDTH - 1);
+    CU_ASSERT(cms != NULL);
+    CU_ASSERT(cms->mask == XQC_TEST_CM_SKETCH_WIDTH - 1);
+
+    /* a key never seen */
+    CU_ASSERT(xqc_cm_sketch_estimate(cms, xqc_test_cm_sketch_key(0)) == 0);
+
+    /* key i is added (i % 4) times, estimation is never less than the real count */
+    for (i = 0; i < XQC_TEST_CM_SKETCH_KEYS; i++) {
+        for (uint64_t j = 0; j < i % 4; j++) {
+            est = xqc_cm_sketch_add(cms, xqc_test_cm_sketch_key(i));
+            CU_ASSERT(est >= j + 1);
+        }
+    }
+
+    for (i = 0; i < XQC_TEST_CM_SKETCH_KEYS; i++) {
+        est = xqc_cm_sketch_estimate(cms, xqc_test_cm_sketch_key(i));
+        CU_ASSERT(est >= i % 4);
+        over += est > i % 4;
+    }
+    /* with 4 rows and conservative update, overestimation is rare */
+    CU_ASSERT(over < XQC_TEST_CM_SKETCH_KEYS / 20);
+
+    /* aging halves the counters */
+    xqc_cm_sketch_age(cms);
+    est = xqc_cm_sketch_estimate(cms, xqc_test_cm_sketch_key(3));
+    CU_ASSERT(est == 1 || est == 2);
+    CU_ASSERT(cms->additions == 0);
+
+    /* counters saturate */
+    for (i = 0; i < 2 * XQC_CM_SKETCH_COUNTER_MAX; i++) {
+        est = xqc_cm_sketch_add(cms, xqc_test_cm_sketch_key(XQC_TEST_CM_SKETCH_KEYS));
+    }
+    CU_ASSERT(est <= XQC_CM_SKETCH_COUNTER_MAX);
+
+    /* counters are halved automatically after a sample of additions */
+    for (i = 0; i < cms->sample_size; i++) {
+        xqc_cm_sketch_add(cms, xqc_test_cm_sketch_key(XQC_TEST_CM_SKETCH_KEYS + 1 + i));
+    }
+    CU_ASSERT(cms->additions < cms->sample_size);
+    CU_ASSERT(xqc_cm_sketch_estimate(cms, xqc_test_cm_sketch_key(XQC_TEST_CM_SKETCH_KEYS))
+              < XQC_CM_SKETCH_COUNTER_MAX);
+
+    xqc_cm_sketch_destroy(cms);
+}
@@ -0,0 +1,11 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef XQC_CM_SKETCH_TEST_H
+#define XQC_CM_SKETCH_TEST_H
+
+
+void xqc_test_cm_sketch();
+
+#endif
@@ -113,57 +113,85 @@ old_xqc_http3_qpack_huffman_encode(uint8_t *dest, const uint8_t *src, size_t src
     return dest;
 }
 
+/*
+ * reference decoder, walking the code tree built from xqc_huffman_enc_code_table bit by bit.
+ * internal nodes are numbered from the root 0, a child with XQC_TEST_HUFFMAN_LEAF set is a
+ * symbol.
+ */
+#define XQC_TEST_HUFFMAN_LEAF   0x8000
+
+static uint16_t xqc_test_huffman_tree[256][2];
+static uint8_t xqc_test_huffman_depth[256];
+static uint8_t xqc_test_huffman_ones[256];
+
+static void
+xqc_test_huffman_tree_init()
+{
+    uint16_t node, nnodes = 1;
+    uint32_t bit;
+
+    if (xqc_test_huffman_tree[0][0] != 0) {
+        return;
+    }
+
+    xqc_test_huffman_ones[0] = 1;
+    for (uint16_t sym = 0; sym <= 256; sym++) {
+        const xqc_huffman_enc_code_t *code = &xqc_huffman_enc_code_table[sym];
+        node = 0;
+        for (int i = code->bits - 1; i > 0; i--) {
+            bit = (code->lsb >> i) & 1;
+            if (xqc_test_huffman_tree[node][bit] == 0) {
+                xqc_test_huffman_depth[nnodes] = xqc_test_huffman_depth[node] + 1;
+                xqc_test_huffman_ones[nnodes] = xqc_test_huffman_ones[node] && bit;
+                xqc_test_huffman_tree[node][bit] = nnodes++;
+            }
+            node = xqc_test_huffman_tree[node][bit];
+        }
+        xqc_test_huffman_tree[node][code->lsb & 1] = XQC_TEST_HUFFMAN_LEAF | sym;
+    }
+}
+
+typedef struct {
+    uint16_t   node;
+    xqc_bool_t end;
+} xqc_test_huffman_ref_ctx;
+
 void
-old_xqc_http3_qpack_huffman_decode_context_init(xqc_huffman_dec_ctx *ctx)
+xqc_test_huffman_ref_dec_init(xqc_test_huffman_ref_ctx *ctx)
 {
-    ctx->state = 0;
+    xqc_test_huffman_tree_init();
+    ctx->node = 0;
     ctx->end = 1;
 }
 
 ssize_t
-old_xqc_http3_qpack_huffman_decode(xqc_huffman_dec_ctx *ctx, uint8_t *dest, size_t dstlen,
+xqc_test_huffman_ref_dec(xqc_test_huffman_ref_ctx *ctx, uint8_t *dest, size_t dstlen,
     const uint8_t *src, size_t srclen, int fin)
 {
     uint8_t *p = dest;
-    size_t i;
-    size_t dst_sz = dstlen;
-    const xqc_huffman_dec_code_t *t;
-
-    /*
-     * We use the decoding algorithm described in
-     * http://graphics.ics.uci.edu/pub/Prefix.pdf
-     */
-    for (i = 0; i < srclen; ++i) {
-        t = &xqc_huffman_dec_code_table[ctx->state][src[i] >> 4];
-        if (t->flags & XQC_HUFFMAN_FAIL) {
-            return -1;
-        }
-        if (t->flags & XQC_HUFFMAN_SYM) {
-            if (dst_sz > 0) {
-                *p++ = t->sym;
-                dst_sz--;
-
-            } else {
-                return -XQC_ENOBUF;
+    uint16_t next;
+
+    for (size_t i = 0; i < srclen; ++i) {
+        for (int b = 7; b >= 0; b--) {
+            next = xqc_test_huffman_tree[ctx->node][(src[i] >> b) & 1];
+            if (!(next & XQC_TEST_HUFFMAN_LEAF)) {
+                ctx->node = next;
+                continue;
             }
-        }
 
-        t = &xqc_huffman_dec_code_table[t->state][src[i] & 0xf];
-        if (t->flags & XQC_HUFFMAN_FAIL) {
-            return -1;
-        }
-        if (t->flags & XQC_HUFFMAN_SYM) {
-            if (dst_sz > 0) {
-                *p++ = t->sym;
-                dst_sz--;
-
-            } else {
+            /* EOS shall never be decoded */
+            if ((next & ~XQC_TEST_HUFFMAN_LEAF) == 256) {
+                return -1;
+            }
+            if (p == dest + dstlen) {
                 return -XQC_ENOBUF;
             }
+            *p++ = (uint8_t)(next & ~XQC_TEST_HUFFMAN_LEAF);
+            ctx->node = 0;
         }
 
-        ctx->state = t->state;
-        ctx->end = (t->flags & XQC_HUFFMAN_END) != 0;
+        /* pending bits are a valid padding, the prefix of EOS shorter than 8 bits */
+        ctx->end = xqc_test_huffman_ones[ctx->node] && xqc_test_huffman_depth[ctx->node] < 8;
     }
 
     if (fin && !ctx->end) {
@@ -172,7 +200,6 @@ old_xqc_http3_qpack_huffman_decode(xqc_huffman_dec_ctx *ctx, uint8_t *dest, size
     return p - dest;
 }
 
-
 void
 xqc_test_huffman_basic()
 {
@@ -224,10 +251,11 @@ xqc_test_huffman_len()
     uint8_t *ebuf = malloc(40000);
     uint8_t *dbuf = malloc(40000);
     uint8_t *old_ebuf = malloc(40000);
-    uint8_t *old_dbuf = malloc(40000);
+    uint8_t *ref_dbuf = malloc(40000);
     uint8_t *end, *old_end;
-    xqc_huffman_dec_ctx ctx = {0}, old_ctx = {0};
-    ssize_t nwrite = 0, processed, consumed, old_processed, old_consumed;
+    xqc_huffman_dec_ctx ctx = {0};
+    xqc_test_huffman_ref_ctx ref_ctx = {0};
+    ssize_t nwrite = 0, processed, consumed, ref_processed;
 
     srandom(time(NULL));
 
@@ -243,7 +271,7 @@ xqc_test_huffman_len()
         CU_ASSERT(end - ebuf == old_end - old_ebuf);
         CU_ASSERT(0 == memcmp(ebuf, old_ebuf, end - ebuf));
 
-        old_xqc_http3_qpack_huffman_decode_context_init(&old_ctx);
+        xqc_test_huffman_ref_dec_init(&ref_ctx);
         xqc_huffman_dec_ctx_init(&ctx);
         nwrite = 0;
         for (j = 0; j < end - ebuf; ++j) {
@@ -254,23 +282,129 @@ xqc_test_huffman_len()
                 fin = 0;
             }
             consumed = xqc_huffman_dec(&ctx, dbuf + nwrite, 40000 - nwrite, ebuf + j, (size_t) 1, fin, &processed);
-            old_processed = old_xqc_http3_qpack_huffman_decode(&old_ctx, old_dbuf + nwrite, 40000, old_ebuf + j, (size_t) 1, fin);
-            CU_ASSERT(processed == old_processed);
+            ref_processed = xqc_test_huffman_ref_dec(&ref_ctx, ref_dbuf + nwrite, 40000, old_ebuf + j, (size_t) 1, fin);
+            CU_ASSERT(processed == ref_processed);
             CU_ASSERT(processed >= 0);
             CU_ASSERT(consumed == 1);
             nwrite += processed;
         }
-        CU_ASSERT(ctx.high_bits == 1);
+        CU_ASSERT(ctx.end == XQC_TRUE && ctx.nbits < 8);
         CU_ASSERT((len == (size_t) nwrite));
         CU_ASSERT(memcmp(raw, dbuf, len) == 0);
-        CU_ASSERT(memcmp(raw, old_dbuf, len) == 0);
+        CU_ASSERT(memcmp(raw, ref_dbuf, len) == 0);
     }
 
     free(raw);
     free(ebuf);
     free(dbuf);
     free(old_ebuf);
-    free(old_dbuf);
+    free(ref_dbuf);
+}
+
+
+void
+xqc_test_huffman_chunked()
+{
+    size_t i, j, len, chunk, nwrite, processed;
+    ssize_t consumed;
+    uint8_t raw[1024], ebuf[4096], dbuf[1024];
+    uint8_t *end;
+    xqc_huffman_dec_ctx ctx;
+
+    for (i = 0; i < 10000; ++i) {
+        /* mostly printable characters, with some long codes */
+        len = (random() % 1024) + 1;
+        for (j = 0; j < len; ++j) {
+            raw[j] = (random() & 7) ? (uint8_t)(0x20 + random() % 95) : (uint8_t)random();
+        }
+        end = xqc_huffman_enc(ebuf, raw, len);
+
+        /* decode with random chunks, input is always consumed completely */
+        xqc_huffman_dec_ctx_init(&ctx);
+        nwrite = 0;
+        for (j = 0; j < end - ebuf; j += chunk) {
+            chunk = (random() % 64) + 1;
+            chunk = xqc_min(chunk, end - ebuf - j);
+            consumed = xqc_huffman_dec(&ctx, dbuf + nwrite, sizeof(dbuf) - nwrite, ebuf + j, chunk,
+                                       j + chunk == end - ebuf, &processed);
+            CU_ASSERT(consumed == chunk);
+            if (consumed != chunk) {
+                break;
+            }
+            nwrite += processed;
+        }
+        CU_ASSERT(nwrite == len);
+        CU_ASSERT(memcmp(raw, dbuf, len) == 0);
+
+        /* decode into a buffer of exact length, which is filled by slow path at the end */
+        xqc_huffman_dec_ctx_init(&ctx);
+        consumed = xqc_huffman_dec(&ctx, dbuf, len, ebuf, end - ebuf, 1, &processed);
+        CU_ASSERT(consumed == end - ebuf);
+        CU_ASSERT(processed == len);
+        CU_ASSERT(memcmp(raw, dbuf, len) == 0);
+    }
+}
+
+
+void
+xqc_test_huffman_invalid()
+{
+    size_t processed;
+    ssize_t ret;
+    uint8_t dbuf[16];
+    xqc_huffman_dec_ctx ctx;
+
+    /* EOS */
+    uint8_t eos[] = {0xff, 0xff, 0xff, 0xfc};
+    xqc_huffman_dec_ctx_init(&ctx);
+    ret = xqc_huffman_dec(&ctx, dbuf, sizeof(dbuf), eos, sizeof(eos), 1, &processed);
+    CU_ASSERT(ret == -XQC_QPACK_HUFFMAN_DEC_ERROR);
+
+    /* 'a' (00011) padded with 0 */
+    uint8_t pad_zero[] = {0x18};
+    xqc_huffman_dec_ctx_init(&ctx);
+    ret = xqc_huffman_dec(&ctx, dbuf, sizeof(dbuf), pad_zero, sizeof(pad_zero), 1, &processed);
+    CU_ASSERT(ret == -XQC_QPACK_HUFFMAN_DEC_STATE_ERROR);
+
+    /* 'a' padded with 11 bits of 1, padding longer than 7 bits */
+    uint8_t pad_long[] = {0x1f, 0xff};
+    xqc_huffman_dec_ctx_init(&ctx);
+    ret = xqc_huffman_dec(&ctx, dbuf, sizeof(dbuf), pad_long, sizeof(pad_long), 1, &processed);
+    CU_ASSERT(ret == -XQC_QPACK_HUFFMAN_DEC_STATE_ERROR);
+
+    /* 'a' padded with 3 bits of 1 */
+    uint8_t pad_ok[] = {0x1f};
+    xqc_huffman_dec_ctx_init(&ctx);
+    ret = xqc_huffman_dec(&ctx, dbuf, sizeof(dbuf), pad_ok, sizeof(pad_ok), 1, &processed);
+    CU_ASSERT(ret == 1 && processed == 1 && dbuf[0] == 'a');
+}
+
+
+void
+xqc_test_huffman_enc_if_shorter()
+{
+    size_t i, j, len, elen, ret;
+    uint8_t raw[512], ebuf[2048], sbuf[512];
+
+    for (i = 0; i < 10000; ++i) {
+        /* printable characters are shorter after encoding, other bytes are longer */
+        len = random() % 512;
+        for (j = 0; j < len; ++j) {
+            raw[j] = (i & 1) ? (uint8_t)(0x20 + random() % 95) : (uint8_t)random();
+        }
+
+        elen = xqc_huffman_enc(ebuf, raw, len) - ebuf;
+        CU_ASSERT(elen == xqc_huffman_enc_len(raw, len));
+
+        ret = xqc_huffman_enc_if_shorter(sbuf, raw, len);
+        if (elen < len) {
+            CU_ASSERT(ret == elen);
+            CU_ASSERT(memcmp(sbuf, ebuf, elen) == 0);
+
+        } else {
+            CU_ASSERT(ret == 0);
+        }
+    }
 }
 
 
@@ -279,4 +413,7 @@ xqc_test_huffman()
 {
     xqc_test_huffman_basic();
     xqc_test_huffman_len();
+    xqc_test_huffman_chunked();
+    xqc_test_huffman_invalid();
+    xqc_test_huffman_enc_if_shorter();
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include <inttypes.h>
+#include "xqc_oa_hash_test.h"
+#include "src/common/utils/oa_hash/xqc_oa_hash.h"
+#include "src/transport/xqc_engine.h"
+#include "tests/unittest/xqc_common_test.h"
+
+
+#define XQC_TEST_OA_HASH_CID_LEN        8
+
+static uint8_t xqc_test_oa_hash_sipkey[XQC_SIPHASH_KEY_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static void
+xqc_test_oa_hash_gen_cid(uint8_t *cid, uint64_t i)
+{
+    /* distinct and scattered cids */
+    uint64_t v = (i + 1) * 0x9e3779b97f4a7c15ULL;
+    memcpy(cid, &v, XQC_TEST_OA_HASH_CID_LEN);
+}
+
+static void *
+xqc_test_oa_hash_lookup(xqc_oa_hash_table_t *tab, const uint8_t *key, size_t len)
+{
+    uint64_t hash = xqc_oa_hash_get_hash(tab, key, len);
+    return xqc_oa_hash_find(tab, hash, key, len);
+}
+
+void
+xqc_test_oa_hash_basic(xqc_log_t *log)
+{
+    xqc_int_t ret;
+    uint64_t hash;
+    uint8_t cid[XQC_OA_HASH_MAX_KEY_LEN + 1] = {0};
+    xqc_oa_hash_table_t tab;
+    const size_t n = 10000;
+
+    ret = xqc_oa_hash_init(&tab, xqc_default_allocator, 0, 0, xqc_test_oa_hash_sipkey,
+                           sizeof(xqc_test_oa_hash_sipkey), log);
+    CU_ASSERT(ret == XQC_OK);
+    CU_ASSERT(tab.cur.capacity == XQC_OA_HASH_MIN_CAPACITY);
+
+    /* too long key */
+    hash = xqc_oa_hash_get_hash(&tab, cid, sizeof(cid));
+    CU_ASSERT(xqc_oa_hash_add(&tab, hash, cid, sizeof(cid), &tab) == -XQC_EPARAM);
+
+    /* grow from the min capacity, every key shall be found during resizing */
+    for (uint64_t i = 0; i < n; i++) {
+        xqc_test_oa_hash_gen_cid(cid, i);
+        hash = xqc_oa_hash_get_hash(&tab, cid, XQC_TEST_OA_HASH_CID_LEN);
+        ret = xqc_oa_hash_add(&tab, hash, cid, XQC_TEST_OA_HASH_CID_LEN, (void *)(uintptr_t)(i + 1));
+        CU_ASSERT(ret == XQC_OK);
+
+        xqc_test_oa_hash_gen_cid(cid, i / 2);
+        CU_ASSERT(xqc_test_oa_hash_lookup(&tab, cid, XQC_TEST_OA_HASH_CID_LEN)
+                  == (void *)(uintptr_t)(i / 2 + 1));
+    }
+    CU_ASSERT(xqc_oa_hash_size(&tab) == n);
+    CU_ASSERT(tab.cur.capacity >= n);
+
+    /* keys with same prefix but different length */
+    xqc_test_oa_hash_gen_cid(cid, 0);
+    CU_ASSERT(xqc_test_oa_hash_lookup(&tab, cid, XQC_TEST_OA_HASH_CID_LEN - 1) == NULL);
+
+    /* delete half of keys, leave tombstones */
+    for (uint64_t i = 0; i < n; i += 2) {
+        xqc_test_oa_hash_gen_cid(cid, i);
+        hash = xqc_oa_hash_get_hash(&tab, cid, XQC_TEST_OA_HASH_CID_LEN);
+        CU_ASSERT(xqc_oa_hash_delete(&tab, hash, cid, XQC_TEST_OA_HASH_CID_LEN) == XQC_OK);
+        CU_ASSERT(xqc_oa_hash_delete(&tab, hash, cid, XQC_TEST_OA_HASH_CID_LEN) == XQC_ERROR);
+    }
+    CU_ASSERT(xqc_oa_hash_size(&tab) == n / 2);
+
+    for (uint64_t i = 0; i < n; i++) {
+        xqc_test_oa_hash_gen_cid(cid, i);
+        CU_ASSERT(xqc_test_oa_hash_lookup(&tab, cid, XQC_TEST_OA_HASH_CID_LEN)
+                  == ((i & 1) ? (void *)(uintptr_t)(i + 1) : NULL));
+    }
+
+    /* churn, tombstones shall be purged without growing */
+    size_t capacity = tab.cur.capacity;
+    for (uint64_t i = n; i < n * 20; i++) {
+        xqc_test_oa_hash_gen_cid(cid, i);
+        hash = xqc_oa_hash_get_hash(&tab, cid, XQC_TEST_OA_HASH_CID_LEN);
+        CU_ASSERT(xqc_oa_hash_add(&tab, hash, cid, XQC_TEST_OA_HASH_CID_LEN, &tab) == XQC_OK);
+        CU_ASSERT(xqc_oa_hash_delete(&tab, hash, cid, XQC_TEST_OA_HASH_CID_LEN) == XQC_OK);
+    }
+    CU_ASSERT(tab.cur.capacity == capacity);
+    CU_ASSERT(xqc_oa_hash_size(&tab) == n / 2);
+
+    xqc_oa_hash_release(&tab);
+}
+
+void
+xqc_test_oa_hash()
+{
+    xqc_engine_t *engine = test_create_engine();
+    CU_ASSERT(engine != NULL);
+
+    xqc_test_oa_hash_basic(engine->log);
+
+    xqc_engine_destroy(engine);
+}
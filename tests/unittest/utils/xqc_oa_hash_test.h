@@ -0,0 +1,11 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef XQC_OA_HASH_TEST_H
+#define XQC_OA_HASH_TEST_H
+
+
+void xqc_test_oa_hash();
+
+#endif
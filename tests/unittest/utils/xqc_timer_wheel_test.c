@@ -0,0 +1,150 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_timer_wheel_test.h"
+#include "src/common/utils/timer_wheel/xqc_timer_wheel.h"
+#include "src/transport/xqc_timer.h"
+#include "src/transport/xqc_engine.h"
+#include "tests/unittest/xqc_common_test.h"
+
+
+#define XQC_TEST_TW_NODES 64
+
+static size_t
+xqc_test_timer_wheel_advance(xqc_timer_wheel_t *tw, xqc_usec_t now)
+{
+    size_t cnt = 0;
+    xqc_list_head_t expired, *pos, *next;
+    xqc_timer_wheel_node_t *node;
+
+    xqc_init_list_head(&expired);
+    xqc_timer_wheel_advance(tw, now, &expired);
+
+    xqc_list_for_each_safe(pos, next, &expired) {
+        node = xqc_list_entry(pos, xqc_timer_wheel_node_t, list);
+        CU_ASSERT(node->expire_time <= now);
+        xqc_list_del_init(pos);
+        cnt++;
+    }
+
+    return cnt;
+}
+
+void
+xqc_test_timer_wheel_basic()
+{
+    xqc_usec_t now = 1000000;
+    xqc_timer_wheel_node_t nodes[XQC_TEST_TW_NODES];
+
+    xqc_timer_wheel_t *tw = xqc_timer_wheel_create(now);
+    CU_ASSERT(tw != NULL);
+    CU_ASSERT(xqc_timer_wheel_next_expire_time(tw) == 0);
+
+    /* spread nodes over all levels, including the wrapped ones */
+    for (int i = 0; i < XQC_TEST_TW_NODES; i++) {
+        xqc_timer_wheel_node_init(&nodes[i]);
+        xqc_timer_wheel_add(tw, &nodes[i], now + ((xqc_usec_t)1 << (i % 40)) + i);
+    }
+    CU_ASSERT(xqc_timer_wheel_count(tw) == XQC_TEST_TW_NODES);
+    CU_ASSERT(xqc_timer_wheel_next_expire_time(tw) == now + 1);
+
+    /* removal of the earliest node */
+    xqc_timer_wheel_del(tw, &nodes[0]);
+    CU_ASSERT(!xqc_timer_wheel_node_pending(&nodes[0]));
+    CU_ASSERT(xqc_timer_wheel_next_expire_time(tw) == now + 2 + 1);
+
+    /* nothing is due before the earliest expire time */
+    CU_ASSERT(xqc_test_timer_wheel_advance(tw, now + 2) == 0);
+    CU_ASSERT(xqc_test_timer_wheel_advance(tw, now + 3) == 1);
+    CU_ASSERT(xqc_timer_wheel_count(tw) == XQC_TEST_TW_NODES - 2);
+
+    /* a node added in the past is due on next advance */
+    xqc_timer_wheel_add(tw, &nodes[0], now);
+    CU_ASSERT(xqc_timer_wheel_next_expire_time(tw) == now);
+    CU_ASSERT(xqc_test_timer_wheel_advance(tw, now + 3) == 1);
+
+    /* large jumps expire all nodes within range, exactly once */
+    size_t expected = 0;
+    for (int i = 2; i < XQC_TEST_TW_NODES; i++) {
+        if (nodes[i].expire_time <= now + ((xqc_usec_t)1 << 30)) {
+            expected++;
+        }
+    }
+    CU_ASSERT(xqc_test_timer_wheel_advance(tw, now + ((xqc_usec_t)1 << 30)) == expected);
+
+    expected = xqc_timer_wheel_count(tw);
+    CU_ASSERT(xqc_test_timer_wheel_advance(tw, now + ((xqc_usec_t)1 << 41)) == expected);
+    CU_ASSERT(xqc_timer_wheel_count(tw) == 0);
+    CU_ASSERT(xqc_timer_wheel_next_expire_time(tw) == 0);
+
+    xqc_timer_wheel_destroy(tw);
+}
+
+static void
+xqc_test_gp_timer_timeout(xqc_gp_timer_id_t gp_timer_id, xqc_usec_t now, void *user_data)
+{
+    int *cnt = (int *)user_data;
+    (*cnt)++;
+}
+
+void
+xqc_test_timer_wheel_gp_timer()
+{
+    int cnt = 0;
+    xqc_bool_t is_set;
+    xqc_usec_t expire_time, now = xqc_monotonic_timestamp();
+    xqc_gp_timer_id_t ids[8];
+    xqc_timer_manager_t manager;
+
+    xqc_engine_t *engine = test_create_engine();
+    CU_ASSERT(engine != NULL);
+    xqc_timer_init(&manager, engine->log, NULL);
+    CU_ASSERT(xqc_timer_next_expire_time(&manager) == 0);
+
+    for (int i = 0; i < 8; i++) {
+        ids[i] = xqc_timer_register_gp_timer(&manager, "test", xqc_test_gp_timer_timeout, &cnt);
+        CU_ASSERT(ids[i] == i);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        CU_ASSERT(xqc_timer_gp_timer_set(&manager, ids[i], now + (i + 1) * 1000) == XQC_OK);
+    }
+    CU_ASSERT(xqc_timer_next_expire_time(&manager) == now + 1000);
+
+    /* reset and unset by id */
+    CU_ASSERT(xqc_timer_gp_timer_set(&manager, ids[0], now + 100000) == XQC_OK);
+    CU_ASSERT(xqc_timer_gp_timer_unset(&manager, ids[1]) == XQC_OK);
+    CU_ASSERT(xqc_timer_next_expire_time(&manager) == now + 3000);
+
+    CU_ASSERT(xqc_timer_unregister_gp_timer(&manager, ids[2]) == XQC_OK);
+    CU_ASSERT(xqc_timer_gp_timer_set(&manager, ids[2], now) == XQC_ERROR);
+    CU_ASSERT(xqc_timer_gp_timer_set(&manager, 8, now) == -XQC_EPARAM);
+
+    /* the conn level timers are taken into account as well */
+    xqc_timer_set(&manager, XQC_TIMER_PING, now, 500);
+    CU_ASSERT(xqc_timer_next_expire_time(&manager) == now + 500);
+    xqc_timer_unset(&manager, XQC_TIMER_PING);
+    CU_ASSERT(xqc_timer_next_expire_time(&manager) == now + 4000);
+
+    xqc_timer_expire(&manager, now + 5000);
+    CU_ASSERT(cnt == 2);
+    CU_ASSERT(xqc_timer_gp_timer_get_info(&manager, ids[3], &is_set, &expire_time) == XQC_OK);
+    CU_ASSERT(is_set == XQC_FALSE && expire_time == 0);
+    CU_ASSERT(xqc_timer_next_expire_time(&manager) == now + 6000);
+
+    xqc_timer_expire(&manager, now + 100000);
+    CU_ASSERT(cnt == 6);
+    CU_ASSERT(xqc_timer_next_expire_time(&manager) == 0);
+
+    xqc_timer_destroy_gp_timer_list(&manager);
+    xqc_engine_destroy(engine);
+}
+
+void
+xqc_test_timer_wheel()
+{
+    xqc_test_timer_wheel_basic();
+    xqc_test_timer_wheel_gp_timer();
+}
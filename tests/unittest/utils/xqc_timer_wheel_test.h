@@ -0,0 +1,11 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef XQC_TIMER_WHEEL_TEST_H
+#define XQC_TIMER_WHEEL_TEST_H
+
+
+void xqc_test_timer_wheel();
+
+#endif
@@ -0,0 +1,324 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_ack_frequency_test.h"
+#include "xqc_common_test.h"
+#include "src/common/xqc_malloc.h"
+#include "src/congestion_control/xqc_cubic.h"
+#include "src/transport/xqc_frame_parser.h"
+#include "src/transport/xqc_frame.h"
+#include "src/transport/xqc_multipath.h"
+#include "src/transport/xqc_send_ctl.h"
+#include "src/transport/xqc_timer.h"
+#include "src/transport/xqc_transport_params.h"
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_packet_out.h"
+#include "src/transport/xqc_send_queue.h"
+
+static void
+xqc_test_ack_frequency_packet_in(xqc_packet_in_t *packet_in, xqc_packet_out_t *packet_out)
+{
+    xqc_memzero(packet_in, sizeof(xqc_packet_in_t));
+    packet_in->pi_pkt.pkt_pns = XQC_PNS_APP_DATA;
+    packet_in->buf = packet_out->po_buf;
+    packet_in->pos = packet_out->po_buf;
+    packet_in->last = packet_out->po_buf + packet_out->po_used_size;
+}
+
+static void
+xqc_test_ack_frequency_frame()
+{
+    xqc_packet_out_t *packet_out = xqc_packet_out_create(XQC_QUIC_MAX_MSS);
+    xqc_packet_in_t packet_in;
+    uint64_t seq_num, threshold, max_ack_delay, reordering_threshold;
+    ssize_t len;
+
+    packet_out->po_used_size = 0;
+    len = xqc_gen_ack_frequency_frame(packet_out, 70000, 19, 10000, 1);
+    CU_ASSERT(len > 0 && packet_out->po_buf[0] == 0x40 && packet_out->po_buf[1] == 0xaf);
+    packet_out->po_used_size += len;
+    len = xqc_gen_immediate_ack_frame(packet_out);
+    CU_ASSERT(len == 1);
+    packet_out->po_used_size += len;
+    CU_ASSERT(packet_out->po_frame_types == (XQC_FRAME_BIT_ACK_FREQUENCY | XQC_FRAME_BIT_IMMEDIATE_ACK));
+
+    /* lost IMMEDIATE_ACK alone is not retransmitted */
+    CU_ASSERT(XQC_NEED_REPAIR(packet_out->po_frame_types) == XQC_FRAME_BIT_ACK_FREQUENCY);
+    CU_ASSERT(XQC_IS_ACK_ELICITING(XQC_FRAME_BIT_IMMEDIATE_ACK));
+
+    xqc_test_ack_frequency_packet_in(&packet_in, packet_out);
+    CU_ASSERT(xqc_parse_ack_frequency_frame(&packet_in, &seq_num, &threshold, &max_ack_delay,
+                                            &reordering_threshold) == XQC_OK);
+    CU_ASSERT(seq_num == 70000 && threshold == 19 && max_ack_delay == 10000
+              && reordering_threshold == 1);
+    CU_ASSERT(*packet_in.pos == XQC_TRANS_FRAME_TYPE_IMMEDIATE_ACK);
+    CU_ASSERT(xqc_parse_immediate_ack_frame(&packet_in) == XQC_OK);
+    CU_ASSERT(packet_in.pos == packet_in.last);
+    CU_ASSERT(packet_in.pi_frame_types == (XQC_FRAME_BIT_ACK_FREQUENCY | XQC_FRAME_BIT_IMMEDIATE_ACK));
+
+    /* truncated frame */
+    xqc_test_ack_frequency_packet_in(&packet_in, packet_out);
+    packet_in.last = packet_in.pos + 5;
+    CU_ASSERT(xqc_parse_ack_frequency_frame(&packet_in, &seq_num, &threshold, &max_ack_delay,
+                                            &reordering_threshold) == -XQC_EVINTREAD);
+
+    xqc_packet_out_destroy(packet_out);
+}
+
+static void
+xqc_test_ack_frequency_transport_params()
+{
+    uint8_t buf[XQC_MAX_TRANSPORT_PARAM_BUF_LEN];
+    xqc_transport_params_t params, decoded;
+    size_t len = 0;
+
+    xqc_init_transport_params(&params);
+    params.min_ack_delay = 1000;
+    CU_ASSERT(xqc_encode_transport_params(&params, XQC_TP_TYPE_CLIENT_HELLO, buf, sizeof(buf),
+                                          &len) == XQC_OK);
+    CU_ASSERT(xqc_decode_transport_params(&decoded, XQC_TP_TYPE_CLIENT_HELLO, buf, len) == XQC_OK);
+    CU_ASSERT(decoded.min_ack_delay == 1000);
+
+    /* not advertised */
+    params.min_ack_delay = 0;
+    CU_ASSERT(xqc_encode_transport_params(&params, XQC_TP_TYPE_CLIENT_HELLO, buf, sizeof(buf),
+                                          &len) == XQC_OK);
+    CU_ASSERT(xqc_decode_transport_params(&decoded, XQC_TP_TYPE_CLIENT_HELLO, buf, len) == XQC_OK);
+    CU_ASSERT(decoded.min_ack_delay == 0);
+
+    /* 2^24 us or above is invalid */
+    params.min_ack_delay = 1 << 24;
+    CU_ASSERT(xqc_encode_transport_params(&params, XQC_TP_TYPE_CLIENT_HELLO, buf, sizeof(buf),
+                                          &len) == XQC_OK);
+    CU_ASSERT(xqc_decode_transport_params(&decoded, XQC_TP_TYPE_CLIENT_HELLO, buf, len)
+              == -XQC_TLS_MALFORMED_TRANSPORT_PARAM);
+}
+
+static xqc_int_t
+xqc_test_ack_frequency_recv(xqc_connection_t *conn, uint64_t seq_num, uint64_t threshold,
+    uint64_t max_ack_delay, uint64_t reordering_threshold)
+{
+    xqc_packet_out_t *packet_out = xqc_packet_out_create(XQC_QUIC_MAX_MSS);
+    xqc_packet_in_t packet_in;
+    xqc_int_t ret;
+
+    packet_out->po_used_size = xqc_gen_ack_frequency_frame(packet_out, seq_num, threshold,
+                                                           max_ack_delay, reordering_threshold);
+    xqc_test_ack_frequency_packet_in(&packet_in, packet_out);
+    ret = xqc_process_ack_frequency_frame(conn, &packet_in);
+
+    xqc_packet_out_destroy(packet_out);
+    return ret;
+}
+
+static void
+xqc_test_ack_frequency_receiver()
+{
+    xqc_connection_t *conn = test_engine_connect();
+    CU_ASSERT(conn != NULL);
+
+    xqc_path_ctx_t *path = conn->conn_initial_path;
+    xqc_send_ctl_t *send_ctl = path->path_send_ctl;
+    xqc_pn_ctl_t *pn_ctl = xqc_get_pn_ctl(conn, path);
+    xqc_usec_t now = xqc_monotonic_timestamp();
+
+    CU_ASSERT(xqc_get_ack_frequency(conn, path) == conn->conn_settings.ack_frequency);
+
+    /* ack rate asked by peer */
+    conn->local_settings.min_ack_delay = 1000;
+    CU_ASSERT(xqc_test_ack_frequency_recv(conn, 1, 9, 20000, 3) == XQC_OK);
+    CU_ASSERT(xqc_get_ack_frequency(conn, path) == 10);
+    CU_ASSERT(conn->ack_freq.max_ack_delay == 20000 && conn->ack_freq.reordering_threshold == 3);
+
+    /* reordered frames with smaller sequence numbers are ignored */
+    CU_ASSERT(xqc_test_ack_frequency_recv(conn, 0, 1, 1000, 1) == XQC_OK);
+    CU_ASSERT(xqc_get_ack_frequency(conn, path) == 10);
+
+    /* delay acks up to the threshold with the requested max_ack_delay */
+    conn->conn_flag |= XQC_CONN_FLAG_CAN_SEND_1RTT;
+    send_ctl->ctl_ack_eliciting_pkt[XQC_PNS_APP_DATA] = 9;
+    xqc_maybe_should_ack(conn, path, pn_ctl, XQC_PNS_APP_DATA, 0, now);
+    CU_ASSERT(!(path->path_flag & (XQC_PATH_FLAG_SHOULD_ACK_INIT << XQC_PNS_APP_DATA)));
+    CU_ASSERT(xqc_timer_is_set(&send_ctl->path_timer_manager, XQC_TIMER_ACK_INIT + XQC_PNS_APP_DATA));
+    CU_ASSERT(send_ctl->path_timer_manager.timer[XQC_TIMER_ACK_INIT + XQC_PNS_APP_DATA].expire_time
+              == now + 20000);
+
+    send_ctl->ctl_ack_eliciting_pkt[XQC_PNS_APP_DATA] = 10;
+    xqc_maybe_should_ack(conn, path, pn_ctl, XQC_PNS_APP_DATA, 0, now);
+    CU_ASSERT(path->path_flag & (XQC_PATH_FLAG_SHOULD_ACK_INIT << XQC_PNS_APP_DATA));
+    path->path_flag &= ~(XQC_PATH_FLAG_SHOULD_ACK_INIT << XQC_PNS_APP_DATA);
+    send_ctl->ctl_ack_eliciting_pkt[XQC_PNS_APP_DATA] = 0;
+
+    /* requested max_ack_delay below min_ack_delay is a protocol violation */
+    CU_ASSERT(xqc_test_ack_frequency_recv(conn, 2, 9, 999, 3) == -XQC_EPROTO);
+
+    /* and so is the frame if min_ack_delay was not advertised */
+    conn->local_settings.min_ack_delay = 0;
+    CU_ASSERT(xqc_test_ack_frequency_recv(conn, 3, 9, 20000, 3) == -XQC_EPROTO);
+
+    xqc_engine_destroy(conn->engine);
+}
+
+static int      xqc_test_ack_frequency_slow_start;
+static uint64_t xqc_test_ack_frequency_cwnd;
+
+static int
+xqc_test_ack_frequency_in_slow_start(void *cong_ctl)
+{
+    return xqc_test_ack_frequency_slow_start;
+}
+
+static uint64_t
+xqc_test_ack_frequency_get_cwnd(void *cong_ctl)
+{
+    return xqc_test_ack_frequency_cwnd;
+}
+
+static void
+xqc_test_ack_frequency_sender()
+{
+    xqc_connection_t *conn = test_engine_connect();
+    CU_ASSERT(conn != NULL);
+
+    xqc_send_ctl_t *send_ctl = conn->conn_initial_path->path_send_ctl;
+    xqc_cong_ctrl_callback_t cb = xqc_cubic_cb;
+    xqc_usec_t now = xqc_monotonic_timestamp();
+    uint64_t mss = conn->pkt_out_size;
+
+    cb.xqc_cong_ctl_in_slow_start = xqc_test_ack_frequency_in_slow_start;
+    cb.xqc_cong_ctl_get_cwnd = xqc_test_ack_frequency_get_cwnd;
+    send_ctl->ctl_cong_callback = &cb;
+    send_ctl->ctl_srtt = 40000;
+    conn->conn_initial_path->path_state = XQC_PATH_STATE_ACTIVE;
+    conn->conn_flag |= XQC_CONN_FLAG_HANDSHAKE_CONFIRMED;
+    conn->remote_settings.max_ack_delay = 25;
+
+    /* nothing is sent unless enabled and peer supports the extension */
+    xqc_test_ack_frequency_slow_start = 0;
+    xqc_test_ack_frequency_cwnd = 80 * mss;
+    xqc_conn_update_ack_frequency(conn, now);
+    CU_ASSERT(conn->ack_freq.send_seq == 0);
+
+    conn->conn_settings.ack_frequency_on = 1;
+    xqc_conn_update_ack_frequency(conn, now);
+    CU_ASSERT(conn->ack_freq.send_seq == 0);
+
+    /* the default ack rate is kept in slow start */
+    conn->remote_settings.min_ack_delay = 1000;
+    xqc_test_ack_frequency_slow_start = 1;
+    xqc_conn_update_ack_frequency(conn, now);
+    CU_ASSERT(conn->ack_freq.send_seq == 0);
+
+    /* 4 acks per round trip */
+    xqc_test_ack_frequency_slow_start = 0;
+    xqc_conn_update_ack_frequency(conn, now);
+    CU_ASSERT(conn->ack_freq.send_seq == 1);
+    CU_ASSERT(conn->ack_freq.sent_threshold == 19 && conn->ack_freq.sent_max_ack_delay == 10000);
+
+    /* at most once per srtt */
+    xqc_test_ack_frequency_cwnd = 160 * mss;
+    xqc_conn_update_ack_frequency(conn, now + 20000);
+    CU_ASSERT(conn->ack_freq.send_seq == 1);
+
+    /* small changes are not worth a frame */
+    xqc_test_ack_frequency_cwnd = 84 * mss;
+    xqc_conn_update_ack_frequency(conn, now + 40000);
+    CU_ASSERT(conn->ack_freq.send_seq == 1);
+
+    xqc_test_ack_frequency_cwnd = 160 * mss;
+    xqc_conn_update_ack_frequency(conn, now + 40000);
+    CU_ASSERT(conn->ack_freq.send_seq == 2 && conn->ack_freq.sent_threshold == 39);
+
+    /* the requested delay is clamped to the min_ack_delay of peer, threshold to the max */
+    send_ctl->ctl_srtt = 2000;
+    xqc_test_ack_frequency_cwnd = 10000 * mss;
+    xqc_conn_update_ack_frequency(conn, now + 80000);
+    CU_ASSERT(conn->ack_freq.send_seq == 3);
+    CU_ASSERT(conn->ack_freq.sent_threshold == XQC_ACK_FREQ_MAX_THRESHOLD
+              && conn->ack_freq.sent_max_ack_delay == 1000);
+
+    send_ctl->ctl_cong_callback = &xqc_cubic_cb;
+    xqc_engine_destroy(conn->engine);
+}
+
+/* count probes of the initial path, and those with IMMEDIATE_ACK */
+static int
+xqc_test_ack_frequency_probes(xqc_connection_t *conn, int *immediate_ack_cnt,
+    xqc_packet_out_t **last)
+{
+    xqc_list_head_t *pos;
+    xqc_packet_out_t *packet_out;
+    int cnt = 0;
+
+    *immediate_ack_cnt = 0;
+    xqc_list_for_each(pos, &conn->conn_send_queue->sndq_pto_probe_packets) {
+        packet_out = xqc_list_entry(pos, xqc_packet_out_t, po_list);
+        if (packet_out->po_path_id != conn->conn_initial_path->path_id) {
+            continue;
+        }
+
+        cnt++;
+        *last = packet_out;
+        if (packet_out->po_frame_types & XQC_FRAME_BIT_IMMEDIATE_ACK) {
+            (*immediate_ack_cnt)++;
+        }
+    }
+
+    return cnt;
+}
+
+static void
+xqc_test_ack_frequency_pto()
+{
+    xqc_connection_t *conn = test_engine_connect();
+    CU_ASSERT(conn != NULL);
+
+    xqc_path_ctx_t *path = conn->conn_initial_path;
+    xqc_packet_out_t *last = NULL;
+    int immediate_ack_cnt;
+
+    /* no IMMEDIATE_ACK before ACK_FREQUENCY is sent */
+    xqc_path_send_one_or_two_ack_elicit_pkts(path, XQC_PNS_APP_DATA);
+    CU_ASSERT(xqc_test_ack_frequency_probes(conn, &immediate_ack_cnt, &last)
+              == XQC_CONN_PTO_PKT_CNT_MAX);
+    CU_ASSERT(immediate_ack_cnt == 0);
+
+    /* IMMEDIATE_ACK is carried by the newest probe, instead of a packet of its own */
+    conn->ack_freq.send_seq = 1;
+    xqc_path_send_one_or_two_ack_elicit_pkts(path, XQC_PNS_APP_DATA);
+    CU_ASSERT(xqc_test_ack_frequency_probes(conn, &immediate_ack_cnt, &last)
+              == 2 * XQC_CONN_PTO_PKT_CNT_MAX);
+    CU_ASSERT(immediate_ack_cnt == 1);
+    CU_ASSERT(last->po_frame_types & XQC_FRAME_BIT_IMMEDIATE_ACK);
+    CU_ASSERT(last->po_frame_types & XQC_FRAME_BIT_PING);
+
+    /* and takes a probe of its own if there is no room in the others */
+    xqc_list_head_t *pos;
+    xqc_packet_out_t *packet_out;
+    xqc_list_for_each(pos, &conn->conn_send_queue->sndq_pto_probe_packets) {
+        packet_out = xqc_list_entry(pos, xqc_packet_out_t, po_list);
+        packet_out->po_frame_types &= ~XQC_FRAME_BIT_IMMEDIATE_ACK;
+        packet_out->po_used_size = packet_out->po_buf_size;
+    }
+
+    CU_ASSERT(xqc_write_immediate_ack_to_probe(conn, path) == XQC_OK);
+    CU_ASSERT(xqc_test_ack_frequency_probes(conn, &immediate_ack_cnt, &last)
+              == 2 * XQC_CONN_PTO_PKT_CNT_MAX + 1);
+    CU_ASSERT(immediate_ack_cnt == 1);
+    CU_ASSERT(last->po_frame_types == XQC_FRAME_BIT_IMMEDIATE_ACK);
+    CU_ASSERT(last->po_path_flag & XQC_PATH_SPECIFIED_BY_PTO);
+
+    xqc_engine_destroy(conn->engine);
+}
+
+void
+xqc_test_ack_frequency()
+{
+    xqc_test_ack_frequency_frame();
+    xqc_test_ack_frequency_transport_params();
+    xqc_test_ack_frequency_receiver();
+    xqc_test_ack_frequency_sender();
+    xqc_test_ack_frequency_pto();
+}
@@ -0,0 +1,10 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_ACK_FREQUENCY_TEST_H_INCLUDED_
+#define _XQC_ACK_FREQUENCY_TEST_H_INCLUDED_
+
+void xqc_test_ack_frequency();
+
+#endif /* _XQC_ACK_FREQUENCY_TEST_H_INCLUDED_ */
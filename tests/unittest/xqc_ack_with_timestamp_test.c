@@ -121,7 +121,7 @@ xqc_test_ack_with_timestamp_no_buf_space()
 
     ret = xqc_gen_ack_ext_frame(conn, packet_out, now, conn->local_settings.ack_delay_exponent,
                             &pn_ctl->ctl_recv_record[XQC_PNS_APP_DATA], path->path_send_ctl->ctl_largest_recv_time[XQC_PNS_APP_DATA],
-                            &has_gap, &largest_ack, path->recv_ts_info);
+                            &has_gap, &largest_ack, path->recv_ts_info, NULL);
 
     CU_ASSERT(ret == -XQC_ENOBUF);
     xqc_engine_destroy(conn->engine);
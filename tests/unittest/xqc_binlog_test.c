@@ -0,0 +1,61 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_binlog_test.h"
+#include "src/common/xqc_binlog.h"
+#include "src/common/xqc_log.h"
+
+
+void
+xqc_test_binlog()
+{
+    uint8_t buf[8 * sizeof(xqc_binlog_record_t)];
+    xqc_binlog_record_t rec;
+    uint64_t args[] = {1, 2, 3};
+    size_t read;
+
+    CU_ASSERT(sizeof(xqc_binlog_record_t) == XQC_BINLOG_RECORD_SIZE);
+
+    xqc_binlog_t *binlog = xqc_binlog_create(4);
+    CU_ASSERT_FATAL(binlog != NULL);
+
+    /* empty ring */
+    CU_ASSERT(xqc_binlog_read(binlog, buf, sizeof(buf)) == 0);
+
+    /* the ring holds 4 records, the rest are dropped */
+    for (uint64_t i = 0; i < 6; i++) {
+        args[0] = i;
+        xqc_binlog_write(binlog, TRA_PACKET_SENT, 0x1122334455667788, args, 3);
+    }
+
+    /* never move partial records */
+    CU_ASSERT(xqc_binlog_read(binlog, buf, sizeof(xqc_binlog_record_t) + 1)
+              == sizeof(xqc_binlog_record_t));
+    memcpy(&rec, buf, sizeof(rec));
+    CU_ASSERT(rec.event == TRA_PACKET_SENT && rec.cid == 0x1122334455667788);
+    CU_ASSERT(rec.version == XQC_BINLOG_VERSION && rec.argc == 3 && rec.dropped == 0);
+    CU_ASSERT(rec.args[0] == 0 && rec.args[1] == 2 && rec.args[2] == 3 && rec.args[3] == 0);
+    CU_ASSERT(rec.time != 0);
+
+    read = xqc_binlog_read(binlog, buf, sizeof(buf));
+    CU_ASSERT(read == 3 * sizeof(xqc_binlog_record_t));
+    memcpy(&rec, buf + 2 * sizeof(xqc_binlog_record_t), sizeof(rec));
+    CU_ASSERT(rec.args[0] == 3);
+
+    /* the gap is reported by the next record written */
+    xqc_binlog_write(binlog, REC_METRICS_UPDATED, 0, args, 1);
+    read = xqc_binlog_read(binlog, buf, sizeof(buf));
+    CU_ASSERT(read == sizeof(xqc_binlog_record_t));
+    memcpy(&rec, buf, sizeof(rec));
+    CU_ASSERT(rec.event == REC_METRICS_UPDATED && rec.dropped == 2 && rec.argc == 1);
+    CU_ASSERT(rec.args[0] == 5 && rec.args[1] == 0);
+
+    xqc_binlog_write(binlog, REC_METRICS_UPDATED, 0, args, 1);
+    xqc_binlog_read(binlog, buf, sizeof(buf));
+    memcpy(&rec, buf, sizeof(rec));
+    CU_ASSERT(rec.dropped == 0);
+
+    xqc_binlog_destroy(binlog);
+}
@@ -3,6 +3,7 @@
  */
 
 #include <CUnit/CUnit.h>
+#include <arpa/inet.h>
 #include "xquic/xquic.h"
 #include "src/transport/xqc_conn.h"
 #include "src/transport/xqc_client.h"
@@ -24,3 +25,87 @@ xqc_test_conn_create()
     xqc_engine_destroy(engine);
 }
 
+
+static xqc_connection_t *
+test_log_override_connect(xqc_engine_t *engine, const char *ip)
+{
+    struct sockaddr_in addr;
+    xqc_conn_settings_t conn_settings;
+    xqc_conn_ssl_config_t conn_ssl_config;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8443);
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+
+    memset(&conn_settings, 0, sizeof(xqc_conn_settings_t));
+    conn_settings.proto_version = XQC_VERSION_V1;
+    memset(&conn_ssl_config, 0, sizeof(conn_ssl_config));
+
+    const xqc_cid_t *cid = xqc_connect(engine, &conn_settings, NULL, 0, "", 0, &conn_ssl_config,
+                                       (struct sockaddr *)&addr, sizeof(addr), "transport", NULL);
+    if (cid == NULL) {
+        return NULL;
+    }
+    return xqc_engine_conns_hash_find(engine, cid, 's');
+}
+
+void
+xqc_test_conn_log_override()
+{
+    xqc_engine_t *engine = test_create_engine();
+    CU_ASSERT_FATAL(engine != NULL);
+    xqc_log_level_t eng_level = engine->log->log_level;
+
+    struct sockaddr_in prefix;
+    memset(&prefix, 0, sizeof(prefix));
+    prefix.sin_family = AF_INET;
+    inet_pton(AF_INET, "10.1.0.0", &prefix.sin_addr);
+
+    /* peer address prefix 10.1.0.0/16 */
+    xqc_log_override_t rule = {
+        .peer_addr = (struct sockaddr *)&prefix,
+        .peer_addrlen = sizeof(prefix),
+        .prefix_len = 16,
+        .log_level = XQC_LOG_DEBUG,
+        .qlog_importance = EVENT_IMPORTANCE_EXTRA,
+    };
+    CU_ASSERT(xqc_engine_add_log_override(engine, &rule) == XQC_OK);
+
+    /* sampling 1 of every 2 connections from any peer */
+    xqc_log_override_t sample = {
+        .sample_rate = 2,
+        .log_level = XQC_LOG_INFO,
+        .qlog_importance = EVENT_IMPORTANCE_BASE,
+    };
+    CU_ASSERT(xqc_engine_add_log_override(engine, &sample) == XQC_OK);
+
+    xqc_connection_t *conn = test_log_override_connect(engine, "10.1.200.3");
+    CU_ASSERT_FATAL(conn != NULL);
+    CU_ASSERT(conn->log->log_level == XQC_LOG_DEBUG);
+
+    conn = test_log_override_connect(engine, "10.2.0.1");
+    CU_ASSERT_FATAL(conn != NULL);
+    CU_ASSERT(conn->log->log_level == XQC_LOG_INFO);
+
+    conn = test_log_override_connect(engine, "10.2.0.1");
+    CU_ASSERT_FATAL(conn != NULL);
+    CU_ASSERT(conn->log->log_level == eng_level);
+
+    /* runtime override by cid */
+    CU_ASSERT(xqc_conn_set_log_level(engine, &conn->scid_set.user_scid, XQC_LOG_DEBUG,
+                                     EVENT_IMPORTANCE_EXTRA) == XQC_OK);
+    CU_ASSERT(conn->log->log_level == XQC_LOG_DEBUG);
+
+    xqc_engine_clear_log_overrides(engine);
+    conn = test_log_override_connect(engine, "10.1.200.3");
+    CU_ASSERT_FATAL(conn != NULL);
+    CU_ASSERT(conn->log->log_level == eng_level);
+
+    for (int i = 0; i < XQC_LOG_OVERRIDE_MAX; i++) {
+        CU_ASSERT(xqc_engine_add_log_override(engine, &sample) == XQC_OK);
+    }
+    CU_ASSERT(xqc_engine_add_log_override(engine, &sample) == -XQC_ELIMIT);
+
+    xqc_engine_destroy(engine);
+}
@@ -0,0 +1,297 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "xqc_coupled_cc_test.h"
+#include "xqc_common_test.h"
+#include "src/congestion_control/xqc_coupled.h"
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_multipath.h"
+#include "src/transport/xqc_engine.h"
+#include "src/common/xqc_time.h"
+#include "src/common/xqc_malloc.h"
+
+/*
+ * round based simulation of drop-tail bottlenecks. in each round every subflow sends its
+ * window, the round lasts for base rtt plus queueing delay, and when windows exceed bdp plus
+ * buffer, the overflowed packets are dropped from subflows chosen in proportion to window.
+ */
+
+#define XQC_TEST_CC_MSS         XQC_MSS
+#define XQC_TEST_CC_BDP         (100 * XQC_TEST_CC_MSS)
+#define XQC_TEST_CC_BUF         (50 * XQC_TEST_CC_MSS)
+#define XQC_TEST_CC_RTT         50000
+#define XQC_TEST_CC_ROUNDS      6000
+#define XQC_TEST_CC_WARMUP      1000
+#define XQC_TEST_CC_MAX_SUBFLOW 4
+
+typedef struct {
+    xqc_path_ctx_t              path;
+    xqc_send_ctl_t              ctl;
+    xqc_coupled_t               cc;
+    uint64_t                    delivered;
+} xqc_test_cc_subflow_t;
+
+typedef struct {
+    xqc_connection_t           *conn;
+    xqc_cong_ctrl_callback_t    cb;
+    xqc_test_cc_subflow_t       subflows[2];
+} xqc_test_cc_flow_t;
+
+typedef struct {
+    xqc_test_cc_subflow_t      *subflows[XQC_TEST_CC_MAX_SUBFLOW];
+    int                         cnt;
+    xqc_usec_t                  now;
+    xqc_usec_t                  elapsed;
+    uint64_t                    delivered;
+} xqc_test_cc_link_t;
+
+static uint64_t xqc_test_cc_seed;
+
+static uint64_t
+xqc_test_cc_rand(uint64_t range)
+{
+    xqc_test_cc_seed = xqc_test_cc_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (xqc_test_cc_seed >> 33) % range;
+}
+
+static void
+xqc_test_cc_flow_init(xqc_test_cc_flow_t *flow, xqc_engine_t *engine, int path_cnt,
+    xqc_coupled_algo_t algo)
+{
+    xqc_cc_params_t params = {.coupled_algo = algo};
+    xqc_test_cc_subflow_t *sf;
+
+    flow->conn = xqc_calloc(1, sizeof(xqc_connection_t));
+    flow->conn->log = engine->log;
+    xqc_init_list_head(&flow->conn->conn_paths_list);
+    flow->cb = xqc_coupled_cb;
+
+    for (int i = 0; i < path_cnt; i++) {
+        sf = &flow->subflows[i];
+        xqc_memzero(sf, sizeof(xqc_test_cc_subflow_t));
+
+        sf->path.path_id = i;
+        sf->path.path_state = XQC_PATH_STATE_ACTIVE;
+        sf->path.path_send_ctl = &sf->ctl;
+        sf->ctl.ctl_conn = flow->conn;
+        sf->ctl.ctl_path = &sf->path;
+        sf->ctl.ctl_cong = &sf->cc;
+        sf->ctl.ctl_cong_callback = &flow->cb;
+        sf->ctl.ctl_is_cwnd_limited = 1;
+        xqc_list_add_tail(&sf->path.path_list, &flow->conn->conn_paths_list);
+
+        flow->cb.xqc_cong_ctl_init(&sf->cc, &sf->ctl, params);
+    }
+}
+
+static void
+xqc_test_cc_link_round(xqc_test_cc_link_t *link)
+{
+    int i, j, drops[XQC_TEST_CC_MAX_SUBFLOW] = {0};
+    uint64_t total = 0, cwnd, pick, ndrops = 0, sent;
+    xqc_usec_t rtt;
+    xqc_packet_out_t po;
+    xqc_test_cc_subflow_t *sf;
+
+    for (i = 0; i < link->cnt; i++) {
+        total += link->subflows[i]->cc.cwnd;
+    }
+
+    if (total > XQC_TEST_CC_BDP + XQC_TEST_CC_BUF) {
+        ndrops = (total - XQC_TEST_CC_BDP - XQC_TEST_CC_BUF + XQC_TEST_CC_MSS - 1) / XQC_TEST_CC_MSS;
+        for (uint64_t k = 0; k < ndrops; k++) {
+            pick = xqc_test_cc_rand(total);
+            for (j = 0; j < link->cnt - 1 && pick >= link->subflows[j]->cc.cwnd; j++) {
+                pick -= link->subflows[j]->cc.cwnd;
+            }
+            drops[j]++;
+        }
+        total = XQC_TEST_CC_BDP + XQC_TEST_CC_BUF;
+    }
+
+    rtt = XQC_TEST_CC_RTT * xqc_max(total, XQC_TEST_CC_BDP) / XQC_TEST_CC_BDP;
+
+    for (i = 0; i < link->cnt; i++) {
+        sf = link->subflows[i];
+        cwnd = sf->cc.cwnd;
+        sf->ctl.ctl_max_bytes_in_flight = cwnd;
+
+        /* rtt sample of the round, as send_ctl updates it before acked packets are handled */
+        sf->ctl.ctl_srtt = sf->ctl.ctl_first_rtt_sample_time == 0
+                           ? rtt : (7 * sf->ctl.ctl_srtt + rtt) / 8;
+        sf->ctl.ctl_first_rtt_sample_time = link->now;
+
+        sent = cwnd > drops[i] * XQC_TEST_CC_MSS ? cwnd - drops[i] * XQC_TEST_CC_MSS : 0;
+        sf->delivered += sent;
+        link->delivered += sent;
+
+        if (drops[i] > 0) {
+            xqc_coupled_cb.xqc_cong_ctl_on_lost(&sf->cc, link->now);
+            continue;
+        }
+
+        po.po_sent_time = link->now;
+        for (uint64_t acked = 0; acked < cwnd; acked += po.po_used_size) {
+            po.po_used_size = xqc_min(cwnd - acked, XQC_TEST_CC_MSS);
+            xqc_coupled_cb.xqc_cong_ctl_on_ack(&sf->cc, &po, link->now + rtt);
+        }
+    }
+
+    link->now += rtt;
+    link->elapsed += rtt;
+}
+
+static void
+xqc_test_cc_link_run(xqc_test_cc_link_t *links, int link_cnt)
+{
+    for (int r = 0; r < XQC_TEST_CC_ROUNDS; r++) {
+        if (r == XQC_TEST_CC_WARMUP) {
+            for (int l = 0; l < link_cnt; l++) {
+                links[l].elapsed = 0;
+                links[l].delivered = 0;
+                for (int i = 0; i < links[l].cnt; i++) {
+                    links[l].subflows[i]->delivered = 0;
+                }
+            }
+        }
+
+        for (int l = 0; l < link_cnt; l++) {
+            xqc_test_cc_link_round(&links[l]);
+        }
+    }
+}
+
+/* throughput of a 2-path flow on a bottleneck shared with a single-path flow, relative to it */
+static double
+xqc_test_cc_shared_ratio(xqc_engine_t *engine, xqc_coupled_algo_t algo, int coupled,
+    double *utilization)
+{
+    xqc_test_cc_flow_t mp, sp, mp2;
+    xqc_test_cc_link_t link;
+    double ratio;
+
+    xqc_memzero(&link, sizeof(link));
+    link.now = xqc_monotonic_timestamp();
+    xqc_test_cc_seed = 1;
+
+    xqc_test_cc_flow_init(&sp, engine, 1, algo);
+    if (coupled) {
+        xqc_test_cc_flow_init(&mp, engine, 2, algo);
+        link.subflows[link.cnt++] = &mp.subflows[0];
+        link.subflows[link.cnt++] = &mp.subflows[1];
+
+    } else {
+        /* two independent connections, each with a single path */
+        xqc_test_cc_flow_init(&mp, engine, 1, algo);
+        xqc_test_cc_flow_init(&mp2, engine, 1, algo);
+        link.subflows[link.cnt++] = &mp.subflows[0];
+        link.subflows[link.cnt++] = &mp2.subflows[0];
+    }
+    link.subflows[link.cnt++] = &sp.subflows[0];
+
+    xqc_test_cc_link_run(&link, 1);
+
+    ratio = (double)(link.subflows[0]->delivered + link.subflows[1]->delivered)
+            / sp.subflows[0].delivered;
+    *utilization = (double)link.delivered * XQC_TEST_CC_RTT / XQC_TEST_CC_BDP / link.elapsed;
+
+#ifdef DEBUG_PRINT
+    printf("algo:%d, coupled:%d, ratio:%.3f, utilization:%.3f\n", algo, coupled, ratio, *utilization);
+#endif
+
+    xqc_free(sp.conn);
+    xqc_free(mp.conn);
+    if (!coupled) {
+        xqc_free(mp2.conn);
+    }
+
+    return ratio;
+}
+
+/* utilization of a 2-path flow on two disjoint bottlenecks */
+static double
+xqc_test_cc_aggregate_utilization(xqc_engine_t *engine, xqc_coupled_algo_t algo)
+{
+    xqc_test_cc_flow_t mp;
+    xqc_test_cc_link_t links[2];
+    double utilization = 0;
+
+    xqc_memzero(links, sizeof(links));
+    xqc_test_cc_seed = 1;
+    xqc_test_cc_flow_init(&mp, engine, 2, algo);
+
+    for (int l = 0; l < 2; l++) {
+        links[l].now = xqc_monotonic_timestamp();
+        links[l].subflows[links[l].cnt++] = &mp.subflows[l];
+    }
+
+    xqc_test_cc_link_run(links, 2);
+
+    for (int l = 0; l < 2; l++) {
+        utilization += (double)links[l].delivered * XQC_TEST_CC_RTT / XQC_TEST_CC_BDP
+                       / links[l].elapsed / 2;
+    }
+
+#ifdef DEBUG_PRINT
+    printf("algo:%d, aggregate utilization:%.3f\n", algo, utilization);
+#endif
+
+    xqc_free(mp.conn);
+    return utilization;
+}
+
+/* window is cut to the initial window after an idle period longer than pto */
+static void
+xqc_test_cc_restart_from_idle(xqc_engine_t *engine)
+{
+    xqc_test_cc_flow_t flow;
+    xqc_coupled_t *cc = &flow.subflows[0].cc;
+    xqc_send_ctl_t *ctl = &flow.subflows[0].ctl;
+    xqc_usec_t now = xqc_monotonic_timestamp();
+
+    xqc_test_cc_flow_init(&flow, engine, 1, XQC_COUPLED_LIA);
+    ctl->ctl_srtt = XQC_TEST_CC_RTT;
+    ctl->ctl_rttvar = XQC_TEST_CC_RTT / 2;
+    ctl->ctl_first_rtt_sample_time = now;
+    cc->cwnd = 4 * cc->init_cwnd;
+
+    xqc_coupled_cb.xqc_cong_ctl_restart_from_idle(cc, now);
+    CU_ASSERT(cc->cwnd == 4 * cc->init_cwnd);
+
+    xqc_coupled_cb.xqc_cong_ctl_restart_from_idle(cc, now - 10 * xqc_send_ctl_calc_pto(ctl));
+    CU_ASSERT(cc->cwnd == cc->init_cwnd);
+
+    xqc_free(flow.conn);
+}
+
+void
+xqc_test_coupled_cc()
+{
+    double ratio, utilization;
+    xqc_coupled_algo_t algos[] = {XQC_COUPLED_LIA, XQC_COUPLED_OLIA, XQC_COUPLED_BALIA};
+
+    xqc_engine_t *engine = test_create_engine();
+    CU_ASSERT(engine != NULL);
+
+    /* uncoupled paths take about twice as much as the single-path flow */
+    ratio = xqc_test_cc_shared_ratio(engine, XQC_COUPLED_LIA, 0, &utilization);
+    CU_ASSERT(ratio > 1.6);
+
+    for (int i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+        /* coupled paths are fair to the single-path flow at the shared bottleneck */
+        ratio = xqc_test_cc_shared_ratio(engine, algos[i], 1, &utilization);
+        CU_ASSERT(ratio > 0.7 && ratio < 1.3);
+        CU_ASSERT(utilization > 0.9);
+
+        /* and still make use of both paths when they do not share a bottleneck */
+        utilization = xqc_test_cc_aggregate_utilization(engine, algos[i]);
+        CU_ASSERT(utilization > 0.8);
+    }
+
+    xqc_test_cc_restart_from_idle(engine);
+
+    xqc_engine_destroy(engine);
+}
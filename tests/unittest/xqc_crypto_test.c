@@ -8,6 +8,7 @@
 #include "src/tls/xqc_tls_defs.h"
 #include "src/tls/xqc_tls.h"
 #include "src/tls/xqc_crypto.h"
+#include "src/tls/xqc_hkdf.h"
 
 #define XQC_TEST_CLIENT_SECRET "\x75\xf5\xba\x26\xff\x42\x51\x13\x20\x76\x4e\xd7" \
 "\x36\x5c\x20\x8d\x5d\x9c\x8a\xd1\x01\xe5\x0f\xc1\xc3\xc5\xaa\xfb\xd6\x3b\x56\x4a"
@@ -39,6 +40,52 @@ xqc_test_derive_initial_secret()
     xqc_engine_destroy(conn->engine);
 }
 
+void
+xqc_test_derive_initial_secret_with_salt()
+{
+    xqc_int_t ret;
+    xqc_cid_t odcid;
+    xqc_digest_t md;
+    xqc_hkdf_salt_t *salt;
+    const char *salt_v1 = xqc_crypto_initial_salt[XQC_VERSION_V1];
+
+    uint8_t client_initial_secret[INITIAL_SECRET_MAX_LEN] = {0};
+    uint8_t server_initial_secret[INITIAL_SECRET_MAX_LEN] = {0};
+    uint8_t client_secret_salted[INITIAL_SECRET_MAX_LEN] = {0};
+    uint8_t server_secret_salted[INITIAL_SECRET_MAX_LEN] = {0};
+
+    xqc_memzero(&odcid, sizeof(odcid));
+    odcid.cid_len = 8;
+    xqc_memcpy(odcid.cid_buf, "\x83\x94\xc8\xf0\x3e\x51\x57\x08", 8);
+
+    xqc_digest_init_to_sha256(&md);
+    salt = xqc_hkdf_salt_create((const uint8_t *)salt_v1, strlen(salt_v1), &md);
+    CU_ASSERT(salt != NULL);
+
+    ret = xqc_crypto_derive_initial_secret(client_initial_secret, INITIAL_SECRET_MAX_LEN,
+                                           server_initial_secret, INITIAL_SECRET_MAX_LEN,
+                                           &odcid, salt_v1, strlen(salt_v1));
+    CU_ASSERT(ret == XQC_OK);
+
+    /* the keyed state of salt shall be restored for each derivation */
+    for (int i = 0; i < 2; i++) {
+        ret = xqc_crypto_derive_initial_secret_with_salt(client_secret_salted,
+                                                         INITIAL_SECRET_MAX_LEN,
+                                                         server_secret_salted,
+                                                         INITIAL_SECRET_MAX_LEN, &odcid, salt);
+        CU_ASSERT(ret == XQC_OK);
+        CU_ASSERT(memcmp(client_secret_salted, client_initial_secret, INITIAL_SECRET_MAX_LEN) == 0);
+        CU_ASSERT(memcmp(server_secret_salted, server_initial_secret, INITIAL_SECRET_MAX_LEN) == 0);
+    }
+
+    /* dest buffer shorter than digest */
+    ret = xqc_hkdf_extract_with_salt(client_secret_salted, INITIAL_SECRET_MAX_LEN - 1,
+                                     odcid.cid_buf, odcid.cid_len, salt);
+    CU_ASSERT(ret != XQC_OK);
+
+    xqc_hkdf_salt_destroy(salt);
+}
+
 void
 xqc_test_crypto_derive_keys(uint32_t cipher_id)
 {
@@ -87,6 +134,7 @@ void
 xqc_test_crypto()
 {
     xqc_test_derive_initial_secret();
+    xqc_test_derive_initial_secret_with_salt();
     xqc_test_derive_packet_protection_keys();
 }
 
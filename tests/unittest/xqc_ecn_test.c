@@ -0,0 +1,280 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_ecn_test.h"
+#include "xqc_common_test.h"
+#include "src/common/xqc_malloc.h"
+#include "src/congestion_control/xqc_cubic.h"
+#include "src/transport/xqc_recv_timestamps_info.h"
+#include "src/transport/xqc_frame_parser.h"
+#include "src/transport/xqc_multipath.h"
+#include "src/transport/xqc_send_ctl.h"
+#include "src/transport/xqc_conn.h"
+
+static void
+xqc_test_ecn_parse(xqc_connection_t *conn, xqc_packet_out_t *packet_out, ssize_t len,
+    xqc_ack_info_t *ack_info)
+{
+    xqc_packet_in_t packet_in;
+    xqc_ack_timestamp_info_t ack_ts_info;
+    xqc_int_t ret;
+
+    xqc_memzero(&packet_in, sizeof(packet_in));
+    packet_in.pi_pkt.pkt_pns = XQC_PNS_APP_DATA;
+    packet_in.buf = packet_out->po_buf;
+    packet_in.pos = packet_out->po_buf;
+    packet_in.last = packet_out->po_buf + len;
+
+    ack_ts_info.report_num = 0;
+    if (packet_out->po_buf[0] == 0x02 || packet_out->po_buf[0] == 0x03) {
+        ret = xqc_parse_ack_frame(&packet_in, conn, ack_info);
+
+    } else {
+        ret = xqc_parse_ack_ext_frame(&packet_in, conn, ack_info, &ack_ts_info);
+    }
+
+    CU_ASSERT(ret == XQC_OK);
+    CU_ASSERT(packet_in.pos == packet_in.last);
+    CU_ASSERT(ack_info->largest_acked == 15);
+}
+
+static void
+xqc_test_ecn_ack_frame()
+{
+    xqc_connection_t *conn = test_engine_connect();
+    CU_ASSERT(conn != NULL);
+
+    xqc_packet_out_t *packet_out = xqc_packet_out_create(XQC_QUIC_MAX_MSS);
+    xqc_recv_record_t recv_record;
+    xqc_recv_timestamps_info_t *recv_ts_info = xqc_recv_timestamps_info_create();
+    xqc_ecn_counts_t zero = {0, 0, 0}, counts = {100, 0, 70000};
+    xqc_ack_info_t ack_info;
+    xqc_packet_number_t largest_ack;
+    int has_gap;
+    ssize_t len;
+
+    xqc_memzero(&recv_record, sizeof(recv_record));
+    xqc_init_list_head(&recv_record.list_head);
+    for (xqc_packet_number_t pn = 1; pn <= 15; pn++) {
+        if (pn != 8) {
+            xqc_recv_record_add(&recv_record, pn);
+            xqc_recv_timestamps_info_add_pkt(recv_ts_info, pn, pn * 1000);
+        }
+    }
+    conn->conn_settings.receive_timestamps_exponent = 0;
+    conn->remote_settings.receive_timestamps_exponent = 0;
+    conn->local_settings.max_receive_timestamps_per_ack = 30;
+
+    /* ACK frame without ECN counts */
+    len = xqc_gen_ack_frame(conn, packet_out, 15000, 3, &recv_record, 15000,
+                            &has_gap, &largest_ack, &zero);
+    CU_ASSERT(len > 0 && packet_out->po_buf[0] == 0x02);
+    xqc_test_ecn_parse(conn, packet_out, len, &ack_info);
+    CU_ASSERT(ack_info.has_ecn == 0 && ack_info.n_ranges == 2);
+
+    /* ACK frame of type 0x03, ECN counts follow ack ranges */
+    len = xqc_gen_ack_frame(conn, packet_out, 15000, 3, &recv_record, 15000,
+                            &has_gap, &largest_ack, &counts);
+    CU_ASSERT(len > 0 && packet_out->po_buf[0] == 0x03);
+    xqc_test_ecn_parse(conn, packet_out, len, &ack_info);
+    CU_ASSERT(ack_info.has_ecn == 1 && ack_info.n_ranges == 2);
+    CU_ASSERT(ack_info.ecn_counts.ect0 == 100 && ack_info.ecn_counts.ect1 == 0
+              && ack_info.ecn_counts.ce == 70000);
+
+    /* ACK_EXTENDED frame with both ECN counts and receive timestamps */
+    len = xqc_gen_ack_ext_frame(conn, packet_out, 15000, 3, &recv_record, 15000,
+                                &has_gap, &largest_ack, recv_ts_info, &counts);
+    CU_ASSERT(len > 0);
+    xqc_test_ecn_parse(conn, packet_out, len, &ack_info);
+    CU_ASSERT(ack_info.has_ecn == 1 && ack_info.ecn_counts.ce == 70000);
+
+    xqc_recv_record_destroy(&recv_record);
+    xqc_recv_timestamps_info_destroy(recv_ts_info);
+    xqc_packet_out_destroy(packet_out);
+    xqc_engine_destroy(conn->engine);
+}
+
+
+static uint64_t xqc_test_ecn_ce_delta;
+static uint64_t xqc_test_ecn_acked_delta;
+
+static void
+xqc_test_ecn_on_ecn_ce(void *cong_ctl, xqc_usec_t largest_acked_sent_time,
+    uint64_t ce_delta, uint64_t acked_delta)
+{
+    xqc_test_ecn_ce_delta += ce_delta;
+    xqc_test_ecn_acked_delta += acked_delta;
+}
+
+static void
+xqc_test_ecn_ack(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl, uint8_t has_ecn,
+    uint64_t ect0, uint64_t ect1, uint64_t ce, uint64_t newly_acked_ect)
+{
+    xqc_ack_info_t ack_info;
+
+    xqc_memzero(&ack_info, sizeof(ack_info));
+    ack_info.pns = XQC_PNS_APP_DATA;
+    ack_info.has_ecn = has_ecn;
+    ack_info.ecn_counts.ect0 = ect0;
+    ack_info.ecn_counts.ect1 = ect1;
+    ack_info.ecn_counts.ce = ce;
+    xqc_send_ctl_on_ecn_counts(send_ctl, pn_ctl, &ack_info, newly_acked_ect,
+                               xqc_monotonic_timestamp());
+}
+
+static void
+xqc_test_ecn_reset(xqc_send_ctl_t *send_ctl, xqc_pn_ctl_t *pn_ctl)
+{
+    send_ctl->ctl_ecn_state = XQC_ECN_STATE_TESTING;
+    send_ctl->ctl_ecn_testing_cnt = 0;
+    send_ctl->ctl_ecn_testing_lost = 0;
+    xqc_memzero(&pn_ctl->ctl_ecn_acked, sizeof(pn_ctl->ctl_ecn_acked));
+}
+
+static void
+xqc_test_ecn_validation()
+{
+    xqc_connection_t *conn = test_engine_connect();
+    CU_ASSERT(conn != NULL);
+
+    xqc_send_ctl_t *send_ctl = conn->conn_initial_path->path_send_ctl;
+    xqc_pn_ctl_t *pn_ctl = xqc_get_pn_ctl(conn, conn->conn_initial_path);
+    xqc_packet_out_t *packet_out = xqc_packet_out_create(XQC_QUIC_MAX_MSS);
+    xqc_cong_ctrl_callback_t cb = xqc_cubic_cb;
+    uint64_t cwnd;
+
+    /* disabled unless ecn_on and write_socket_ecn are both set */
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_DISABLED);
+    CU_ASSERT(xqc_send_ctl_ecn_codepoint(send_ctl, packet_out) == XQC_ECN_NOT_ECT);
+    CU_ASSERT(!(packet_out->po_flag & XQC_POF_ECN_ECT));
+
+    /* only the testing packets are marked before validation */
+    xqc_test_ecn_reset(send_ctl, pn_ctl);
+    for (int i = 0; i < XQC_ECN_TESTING_PKTS; i++) {
+        CU_ASSERT(xqc_send_ctl_ecn_codepoint(send_ctl, packet_out) == XQC_ECN_ECT0);
+        CU_ASSERT(packet_out->po_flag & XQC_POF_ECN_ECT);
+    }
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_UNKNOWN);
+    CU_ASSERT(xqc_send_ctl_ecn_codepoint(send_ctl, packet_out) == XQC_ECN_NOT_ECT);
+    CU_ASSERT(!(packet_out->po_flag & XQC_POF_ECN_ECT));
+
+    /* counts of testing packets are validated, then all packets are marked */
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 4, 0, 0, 4);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_CAPABLE);
+    CU_ASSERT(xqc_send_ctl_ecn_codepoint(send_ctl, packet_out) == XQC_ECN_ECT0);
+
+    /* CE marks are passed to the congestion controller */
+    cb.xqc_cong_ctl_on_ecn_ce = xqc_test_ecn_on_ecn_ce;
+    send_ctl->ctl_cong_callback = &cb;
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 7, 0, 2, 5);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_CAPABLE);
+    CU_ASSERT(xqc_test_ecn_ce_delta == 2 && xqc_test_ecn_acked_delta == 5);
+    CU_ASSERT(send_ctl->ctl_ecn_ce_cnt == 2);
+
+    /* and reduce the window like a loss if the controller does not handle them */
+    cb.xqc_cong_ctl_on_ecn_ce = NULL;
+    cwnd = cb.xqc_cong_ctl_get_cwnd(send_ctl->ctl_cong);
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 7, 0, 3, 1);
+    CU_ASSERT(cb.xqc_cong_ctl_get_cwnd(send_ctl->ctl_cong) < cwnd);
+    CU_ASSERT(xqc_test_ecn_ce_delta == 2);
+
+    /* ECN counts missing while ECT packets are acknowledged */
+    xqc_test_ecn_reset(send_ctl, pn_ctl);
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 0, 0, 0, 0, 3);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_FAILED);
+    CU_ASSERT(xqc_send_ctl_ecn_codepoint(send_ctl, packet_out) == XQC_ECN_NOT_ECT);
+
+    /* ECT(0) codepoints are bleached */
+    xqc_test_ecn_reset(send_ctl, pn_ctl);
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 1, 0, 0, 3);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_FAILED);
+
+    /* ECT(0) codepoints are remarked to ECT(1) */
+    xqc_test_ecn_reset(send_ctl, pn_ctl);
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 3, 1, 0, 3);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_FAILED);
+
+    /* counts decrease */
+    xqc_test_ecn_reset(send_ctl, pn_ctl);
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 3, 0, 0, 3);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_CAPABLE);
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 2, 0, 0, 0);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_FAILED);
+
+    /* L4S packets are marked with ECT(1), and ECT(0) counts must not increase then */
+    xqc_test_ecn_reset(send_ctl, pn_ctl);
+    send_ctl->ctl_ecn_codepoint = XQC_ECN_ECT1;
+    CU_ASSERT(xqc_send_ctl_ecn_codepoint(send_ctl, packet_out) == XQC_ECN_ECT1);
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 0, 3, 0, 3);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_CAPABLE);
+    xqc_test_ecn_ack(send_ctl, pn_ctl, 1, 1, 5, 0, 2);
+    CU_ASSERT(send_ctl->ctl_ecn_state == XQC_ECN_STATE_FAILED);
+    send_ctl->ctl_ecn_codepoint = XQC_ECN_ECT0;
+
+    send_ctl->ctl_cong_callback = &xqc_cubic_cb;
+    xqc_packet_out_destroy(packet_out);
+    xqc_engine_destroy(conn->engine);
+}
+
+static uint8_t xqc_test_ecn_sent_ecn;
+static xqc_usec_t xqc_test_ecn_sent_txtime;
+static int xqc_test_ecn_txtime_writes;
+
+static ssize_t
+xqc_test_ecn_write_socket_ecn(uint64_t path_id, const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, uint8_t ecn, xqc_usec_t txtime,
+    void *conn_user_data)
+{
+    xqc_test_ecn_sent_ecn = ecn;
+    xqc_test_ecn_sent_txtime = txtime;
+    return size;
+}
+
+static ssize_t
+xqc_test_ecn_write_socket_txtime(uint64_t path_id, const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, xqc_usec_t txtime,
+    void *conn_user_data)
+{
+    xqc_test_ecn_txtime_writes++;
+    return size;
+}
+
+static void
+xqc_test_ecn_send_txtime()
+{
+    xqc_connection_t *conn = test_engine_connect();
+    CU_ASSERT(conn != NULL);
+
+    unsigned char buf[64] = {0};
+
+    conn->conn_settings.ecn_on = 1;
+    conn->transport_cbs.write_socket_ecn = xqc_test_ecn_write_socket_ecn;
+    conn->transport_cbs.write_socket_txtime = xqc_test_ecn_write_socket_txtime;
+    xqc_test_ecn_txtime_writes = 0;
+
+    /* release times of edt pacing go along with the codepoint */
+    CU_ASSERT(xqc_send(conn, conn->conn_initial_path, buf, sizeof(buf), 12345, XQC_ECN_ECT0)
+              == sizeof(buf));
+    CU_ASSERT(xqc_test_ecn_sent_ecn == XQC_ECN_ECT0);
+    CU_ASSERT(xqc_test_ecn_sent_txtime == 12345);
+    CU_ASSERT(xqc_test_ecn_txtime_writes == 0);
+
+    /* and are not handed out if the socket layer does not take them */
+    conn->transport_cbs.write_socket_txtime = NULL;
+    CU_ASSERT(xqc_send(conn, conn->conn_initial_path, buf, sizeof(buf), 12345, XQC_ECN_ECT1)
+              == sizeof(buf));
+    CU_ASSERT(xqc_test_ecn_sent_ecn == XQC_ECN_ECT1);
+    CU_ASSERT(xqc_test_ecn_sent_txtime == 0);
+
+    xqc_engine_destroy(conn->engine);
+}
+
+void
+xqc_test_ecn()
+{
+    xqc_test_ecn_ack_frame();
+    xqc_test_ecn_validation();
+    xqc_test_ecn_send_txtime();
+}
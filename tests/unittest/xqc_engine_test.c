@@ -77,3 +77,71 @@ xqc_test_engine_packet_process()
     xqc_engine_destroy(engine);
 }
 
+
+void
+xqc_test_engine_perf_stats()
+{
+    struct sockaddr local_addr;
+    struct sockaddr peer_addr;
+    xqc_engine_perf_stats_t stats;
+
+    xqc_engine_t *engine = test_create_engine_server();
+    CU_ASSERT_FATAL(engine != NULL);
+
+    xqc_engine_get_perf_stats(engine, &stats);
+    CU_ASSERT(stats.datagrams_recv == 0 && stats.conns_created == 0);
+
+    xqc_engine_packet_process(engine, XQC_TEST_LONG_HEADER_PACKET_B,
+                              sizeof(XQC_TEST_LONG_HEADER_PACKET_B) - 1,
+                              &local_addr, 0, &peer_addr, 0, xqc_monotonic_timestamp(), NULL);
+    xqc_engine_main_logic(engine);
+
+    xqc_engine_get_perf_stats(engine, &stats);
+    CU_ASSERT(stats.datagrams_recv == 1);
+    CU_ASSERT(stats.bytes_recv == sizeof(XQC_TEST_LONG_HEADER_PACKET_B) - 1);
+    /* the initial packet is too small, connection is closed and destroyed in main logic */
+    CU_ASSERT(stats.conns_created == 1 && stats.conns_destroyed == 1);
+    CU_ASSERT(stats.main_logic_calls >= 1);
+
+#ifndef XQC_ENABLE_PERF_TIMING
+    CU_ASSERT(stats.encrypt_ticks == 0 && stats.decrypt_ticks == 0
+              && stats.ack_process_ticks == 0);
+#endif
+
+    xqc_engine_destroy(engine);
+}
+
+void
+xqc_test_engine_conn_cache()
+{
+    struct sockaddr local_addr;
+    struct sockaddr peer_addr;
+    xqc_engine_perf_stats_t stats;
+
+    xqc_engine_t *engine = test_create_engine_server();
+    CU_ASSERT_FATAL(engine != NULL);
+    CU_ASSERT(engine->config->conn_cache_size > 0);
+
+    /* connections created by undersized initial packets are destroyed in main logic */
+    for (int i = 0; i < 3; i++) {
+        xqc_engine_packet_process(engine, XQC_TEST_LONG_HEADER_PACKET_B,
+                                  sizeof(XQC_TEST_LONG_HEADER_PACKET_B) - 1,
+                                  &local_addr, 0, &peer_addr, 0, xqc_monotonic_timestamp(), NULL);
+        xqc_engine_main_logic(engine);
+        CU_ASSERT(engine->conn_cache_cnt == 1);
+    }
+
+    xqc_engine_get_perf_stats(engine, &stats);
+    CU_ASSERT(stats.conns_created == 3 && stats.conns_destroyed == 3);
+    CU_ASSERT(stats.conns_reused == 2);
+
+    /* disabled */
+    engine->config->conn_cache_size = 0;
+    xqc_engine_packet_process(engine, XQC_TEST_LONG_HEADER_PACKET_B,
+                              sizeof(XQC_TEST_LONG_HEADER_PACKET_B) - 1,
+                              &local_addr, 0, &peer_addr, 0, xqc_monotonic_timestamp(), NULL);
+    xqc_engine_main_logic(engine);
+    CU_ASSERT(engine->conn_cache_cnt == 0);
+
+    xqc_engine_destroy(engine);
+}
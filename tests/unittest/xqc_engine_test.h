@@ -7,5 +7,7 @@
 
 void xqc_test_engine_create();
 void xqc_test_engine_packet_process();
+void xqc_test_engine_perf_stats();
+void xqc_test_engine_conn_cache();
 
 #endif
@@ -0,0 +1,234 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_fec_codec_test.h"
+#include "xqc_fec_scheme_test.h"
+#include "include/xquic/xquic.h"
+#include "src/transport/xqc_fec.h"
+#include "src/transport/xqc_fec_codec.h"
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_engine.h"
+#include "src/transport/fec_schemes/xqc_xor.h"
+#include "src/transport/fec_schemes/xqc_reed_solomon.h"
+#include "src/transport/fec_schemes/xqc_reed_solomon16.h"
+#include "src/transport/fec_schemes/xqc_fountain.h"
+#include "xqc_common_test.h"
+
+#define XQC_TEST_CODEC_MAX_K        20
+#define XQC_TEST_CODEC_MAX_R        4
+#define XQC_TEST_CODEC_SYB_SIZE     203
+#define XQC_TEST_CODEC_BLOCKS       3
+#define XQC_TEST_BLOCK_CONN_K      6
+
+
+static uint32_t
+xqc_test_codec_rand(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/* code blocks with one encoder and one decoder, losing the first lost_num symbols after esi 1 */
+static void
+xqc_test_codec_round_trip(xqc_fec_schemes_e scheme, xqc_int_t K, xqc_int_t R, xqc_int_t lost_num)
+{
+    uint32_t state = 3;
+    xqc_int_t i, b, ret;
+    size_t size, sizes[XQC_TEST_CODEC_MAX_K], rpr_size;
+    const unsigned char *data;
+    unsigned char src[XQC_TEST_CODEC_MAX_K][XQC_TEST_CODEC_SYB_SIZE];
+    xqc_fec_encoder_t *enc;
+    xqc_fec_decoder_t *dec;
+
+    enc = xqc_fec_encoder_create(scheme, K, XQC_TEST_CODEC_SYB_SIZE, R);
+    dec = xqc_fec_decoder_create(scheme, K, XQC_TEST_CODEC_SYB_SIZE, R);
+    CU_ASSERT(enc != NULL && dec != NULL);
+    if (enc == NULL || dec == NULL) {
+        xqc_fec_encoder_destroy(enc);
+        xqc_fec_decoder_destroy(dec);
+        return;
+    }
+
+    /* the same objects for all blocks, with source symbols of odd and of different sizes */
+    for (b = 0; b < XQC_TEST_CODEC_BLOCKS; b++) {
+        xqc_fec_encoder_reset(enc);
+        xqc_fec_decoder_reset(dec);
+        for (i = 0; i < K; i++) {
+            sizes[i] = XQC_TEST_CODEC_SYB_SIZE - (i * 7 + b * 13) % 64;
+            for (size = 0; size < sizes[i]; size++) {
+                src[i][size] = xqc_test_codec_rand(&state) & 0xff;
+            }
+            CU_ASSERT(xqc_fec_encoder_get_repair(enc, 0, &data, &size) == -XQC_EAGAIN);
+            CU_ASSERT(xqc_fec_encoder_add_source(enc, src[i], sizes[i]) == XQC_OK);
+            if (i < 1 || i > lost_num) {
+                CU_ASSERT(xqc_fec_decoder_add_received(dec, i, src[i], sizes[i]) == XQC_OK);
+            }
+        }
+        CU_ASSERT(xqc_fec_encoder_add_source(enc, src[0], sizes[0]) == -XQC_EPARAM);
+
+        CU_ASSERT(xqc_fec_decoder_try_decode(dec) == (lost_num > 0 ? -XQC_EAGAIN : XQC_OK));
+        for (i = 0; i < R; i++) {
+            ret = xqc_fec_encoder_get_repair(enc, i, &data, &rpr_size);
+            CU_ASSERT(ret == XQC_OK && rpr_size >= sizes[0] && rpr_size <= enc->max_size);
+            if (ret == XQC_OK) {
+                CU_ASSERT(xqc_fec_decoder_add_received(dec, K + i, data, rpr_size) == XQC_OK);
+            }
+        }
+
+        CU_ASSERT(xqc_fec_decoder_try_decode(dec) == XQC_OK);
+        for (i = 0; i < K; i++) {
+            ret = xqc_fec_decoder_get_source(dec, i, &data, &size);
+            CU_ASSERT(ret == XQC_OK && size >= sizes[i]);
+            CU_ASSERT(ret == XQC_OK && xqc_memcmp(data, src[i], sizes[i]) == 0);
+            CU_ASSERT(xqc_fec_decoder_is_lost(dec, i) == (i >= 1 && i <= lost_num));
+        }
+    }
+
+    /* one more loss than repair symbols */
+    xqc_fec_decoder_reset(dec);
+    for (i = R + 1; i < K + R; i++) {
+        if (i < K) {
+            xqc_fec_decoder_add_received(dec, i, src[i], sizes[i]);
+
+        } else {
+            xqc_fec_encoder_get_repair(enc, i - K, &data, &rpr_size);
+            xqc_fec_decoder_add_received(dec, i, data, rpr_size);
+        }
+    }
+    CU_ASSERT(xqc_fec_decoder_try_decode(dec) == -XQC_EAGAIN);
+    CU_ASSERT(xqc_fec_decoder_get_source(dec, 0, &data, &size) == -XQC_EAGAIN);
+    CU_ASSERT(xqc_fec_decoder_add_received(dec, K + R, src[0], sizes[0]) == -XQC_EPARAM);
+    CU_ASSERT(xqc_fec_decoder_add_received(dec, 0, src[0], dec->max_size + 1) == -XQC_EPARAM);
+
+    xqc_fec_encoder_destroy(enc);
+    xqc_fec_decoder_destroy(dec);
+}
+
+void
+xqc_test_fec_codec_params()
+{
+    /* block codes only, repair symbols of the other schemes depend on more than their index */
+    CU_ASSERT(xqc_fec_encoder_create(XQC_PACKET_MASK_CODE, 4, 100, 1) == NULL);
+    CU_ASSERT(xqc_fec_encoder_create(XQC_RLC_CODE, 4, 100, 1) == NULL);
+#ifdef XQC_ENABLE_XOR
+    CU_ASSERT(xqc_fec_encoder_create(XQC_XOR_CODE, 4, 100, 2) == NULL);
+    CU_ASSERT(xqc_fec_decoder_create(XQC_XOR_CODE, 0, 100, 1) == NULL);
+#endif
+#ifdef XQC_ENABLE_RSC
+    CU_ASSERT(xqc_fec_encoder_create(XQC_REED_SOLOMON_CODE, XQC_RSM_COL + 1, 100, 1) == NULL);
+#endif
+}
+
+/* a block coded through the scheme callbacks of a connection, with symbols lost_a and lost_b lost */
+static void
+xqc_test_block_conn(xqc_fec_schemes_e scheme, const xqc_fec_code_callback_t *cb, xqc_int_t R,
+    xqc_int_t lost_a, xqc_int_t lost_b)
+{
+    uint32_t state = 9;
+    xqc_int_t i, j, ret, lost;
+    size_t size, rpr_size;
+    uint8_t bm = XQC_DEFAULT_SIZE_REQ;
+    unsigned char src[XQC_TEST_BLOCK_CONN_K][XQC_TEST_CODEC_SYB_SIZE];
+    unsigned char *outputs[XQC_REPAIR_LEN];
+    xqc_connection_t *conn = test_engine_connect_fec();
+
+    CU_ASSERT(conn != NULL && conn->fec_ctl != NULL);
+    if (conn == NULL || conn->fec_ctl == NULL) {
+        return;
+    }
+    conn->conn_settings.fec_params.fec_encoder_scheme = scheme;
+    conn->conn_settings.fec_params.fec_decoder_scheme = scheme;
+    conn->conn_settings.fec_params.fec_max_symbol_num_per_block = XQC_TEST_BLOCK_CONN_K;
+    conn->remote_settings.fec_max_symbols_num = XQC_TEST_BLOCK_CONN_K;
+    conn->fec_ctl->fec_send_required_repair_num[bm] = R;
+
+    /* repair symbols are as large as the largest source symbol, rounded up to the alignment */
+    rpr_size = xqc_fec_codec_get_ops(scheme)->align;
+    rpr_size = (XQC_TEST_CODEC_SYB_SIZE + rpr_size - 1) / rpr_size * rpr_size;
+
+    for (j = 0; j < XQC_REPAIR_LEN; j++) {
+        outputs[j] = conn->fec_ctl->fec_send_repair_symbols_buff[bm][j].payload;
+    }
+    for (i = 0; i < XQC_TEST_BLOCK_CONN_K; i++) {
+        for (size = 0; size < XQC_TEST_CODEC_SYB_SIZE; size++) {
+            src[i][size] = xqc_test_codec_rand(&state) & 0xff;
+        }
+        conn->fec_ctl->fec_send_symbol_num[bm] = i;
+        ret = cb->xqc_fec_encode(conn, src[i], XQC_TEST_CODEC_SYB_SIZE - i, outputs, bm);
+        CU_ASSERT(ret == XQC_OK);
+        /* repair symbols are encoded once the block is complete */
+        CU_ASSERT(conn->fec_ctl->fec_send_repair_symbols_buff[bm][0].is_valid
+                  == (i == XQC_TEST_BLOCK_CONN_K - 1));
+    }
+    /* the encoder is kept in the connection */
+    CU_ASSERT(conn->fec_ctl->fec_encoders[bm] != NULL && conn->fec_ctl->fec_encoders[bm]->scheme == scheme);
+
+    for (j = 0; j < R; j++) {
+        xqc_fec_object_t *key = &conn->fec_ctl->fec_send_repair_key[bm][j];
+        xqc_fec_object_t *rpr = &conn->fec_ctl->fec_send_repair_symbols_buff[bm][j];
+        CU_ASSERT(key->is_valid == (scheme != XQC_XOR_CODE));
+        CU_ASSERT(rpr->is_valid && rpr->payload_size == rpr_size);
+
+        xqc_fec_rpr_syb_t tmp_rpr_symbol = {
+            .block_id = 0,
+            .symbol_idx = j,
+            .payload = rpr->payload,
+            .payload_size = rpr->payload_size,
+            .repair_key = key->payload,
+            .repair_key_size = key->is_valid ? key->payload_size : 0,
+        };
+        CU_ASSERT(xqc_process_rpr_symbol(conn, &tmp_rpr_symbol) == XQC_OK);
+    }
+
+    for (i = 0; i < XQC_TEST_BLOCK_CONN_K; i++) {
+        if (i != lost_a && i != lost_b) {
+            ret = xqc_process_src_symbol(conn, 0, i, src[i], XQC_TEST_CODEC_SYB_SIZE - i);
+            CU_ASSERT(ret == XQC_OK);
+        }
+    }
+
+    for (j = 0; j < R; j++) {
+        outputs[j] = conn->fec_ctl->fec_gen_repair_symbols_buff[j].payload;
+    }
+    ret = cb->xqc_fec_decode(conn, outputs, &size, 0);
+    CU_ASSERT(ret == XQC_OK && size == rpr_size);
+    lost = 0;
+    for (i = 0; i < XQC_TEST_BLOCK_CONN_K; i++) {
+        if (i == lost_a || i == lost_b) {
+            CU_ASSERT(xqc_memcmp(outputs[lost], src[i], XQC_TEST_CODEC_SYB_SIZE - i) == 0);
+            /* the rest of a shorter symbol is zero padding */
+            CU_ASSERT(outputs[lost][XQC_TEST_CODEC_SYB_SIZE - i] == 0);
+            lost++;
+        }
+    }
+    CU_ASSERT(conn->fec_ctl->fec_decoder != NULL && conn->fec_ctl->fec_decoder->scheme == scheme);
+
+    xqc_engine_destroy(conn->engine);
+}
+
+void
+xqc_test_fec_codec()
+{
+    xqc_test_fec_codec_params();
+#ifdef XQC_ENABLE_XOR
+    xqc_test_codec_round_trip(XQC_XOR_CODE, 8, 1, 1);
+    xqc_test_block_conn(XQC_XOR_CODE, &xqc_xor_code_cb, 1, 3, -1);
+#endif
+#ifdef XQC_ENABLE_RSC
+    xqc_test_codec_round_trip(XQC_REED_SOLOMON_CODE, 20, 4, 4);
+    xqc_test_block_conn(XQC_REED_SOLOMON_CODE, &xqc_reed_solomon_code_cb, 2, 2, 5);
+#endif
+#ifdef XQC_ENABLE_RS16
+    xqc_test_codec_round_trip(XQC_REED_SOLOMON_16_CODE, 20, 4, 3);
+    xqc_test_block_conn(XQC_REED_SOLOMON_16_CODE, &xqc_reed_solomon16_code_cb, 2, 0, 5);
+#endif
+#ifdef XQC_ENABLE_FOUNTAIN
+    xqc_test_codec_round_trip(XQC_RAPTORQ_CODE, 10, 4, 2);
+    xqc_test_codec_round_trip(XQC_RAPTORQ_CODE, 10, 4, 0);
+    xqc_test_block_conn(XQC_RAPTORQ_CODE, &xqc_fountain_code_cb, 2, 2, 5);
+#endif
+}
@@ -0,0 +1,210 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_fec_rlc_test.h"
+#include "xqc_fec_scheme_test.h"
+#include "include/xquic/xquic.h"
+#include "src/transport/xqc_fec.h"
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_engine.h"
+#include "src/transport/fec_schemes/xqc_rlc.h"
+#include "xqc_common_test.h"
+
+#define XQC_TEST_RLC_BLK_SIZE   8
+#define XQC_TEST_RLC_RPR_NUM    2
+#define XQC_TEST_RLC_SYB_SIZE   20
+#define XQC_TEST_RLC_BLK_NUM    2
+
+typedef struct xqc_test_rlc_repair_s {
+    unsigned char   payload[XQC_TEST_RLC_SYB_SIZE];
+    unsigned char   key[XQC_RLC_KEY_SIZE];
+    size_t          payload_size;
+    xqc_int_t       valid;
+} xqc_test_rlc_repair_t;
+
+static unsigned char xqc_test_rlc_src[XQC_TEST_RLC_BLK_NUM][XQC_TEST_RLC_BLK_SIZE][XQC_TEST_RLC_SYB_SIZE];
+static xqc_test_rlc_repair_t xqc_test_rlc_rpr[XQC_TEST_RLC_BLK_NUM][XQC_TEST_RLC_RPR_NUM];
+
+
+void
+xqc_test_rlc_key()
+{
+    xqc_int_t ret;
+    unsigned char key[XQC_RLC_KEY_SIZE];
+    xqc_rlc_window_t win = {
+        .seed = 0x1234,
+        .prev_block_id = 0x0a0b0c,
+        .prev_first = 28,
+        .prev_num = 4,
+        .cur_first = 0,
+        .cur_num = 12,
+    }, parsed;
+
+    xqc_rlc_write_key(key, &win);
+    ret = xqc_rlc_parse_key(key, XQC_RLC_KEY_SIZE, &parsed);
+    CU_ASSERT(ret == XQC_OK);
+    CU_ASSERT(parsed.seed == win.seed && parsed.prev_block_id == win.prev_block_id);
+    CU_ASSERT(parsed.prev_first == win.prev_first && parsed.prev_num == win.prev_num);
+    CU_ASSERT(parsed.cur_first == win.cur_first && parsed.cur_num == win.cur_num);
+
+    ret = xqc_rlc_parse_key(key, XQC_RLC_KEY_SIZE - 1, &parsed);
+    CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
+
+    /* window wider than XQC_RLC_MAX_WINDOW */
+    win.cur_num = XQC_RLC_MAX_WINDOW;
+    xqc_rlc_write_key(key, &win);
+    ret = xqc_rlc_parse_key(key, XQC_RLC_KEY_SIZE, &parsed);
+    CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
+
+    /* empty window */
+    win.prev_num = win.cur_num = 0;
+    xqc_rlc_write_key(key, &win);
+    ret = xqc_rlc_parse_key(key, XQC_RLC_KEY_SIZE, &parsed);
+    CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
+}
+
+static void
+xqc_test_rlc_encode(xqc_connection_t *conn)
+{
+    xqc_int_t i, j, k, ret;
+    uint8_t bm = XQC_DEFAULT_SIZE_REQ;
+    unsigned char *outputs[XQC_REPAIR_LEN];
+    xqc_fec_ctl_t *fec_ctl = conn->fec_ctl;
+
+    for (k = 0; k < XQC_REPAIR_LEN; k++) {
+        outputs[k] = fec_ctl->fec_send_repair_symbols_buff[bm][k].payload;
+    }
+
+    for (i = 0; i < XQC_TEST_RLC_BLK_NUM; i++) {
+        fec_ctl->fec_send_block_num[bm] = i;
+        for (j = 0; j < XQC_TEST_RLC_BLK_SIZE; j++) {
+            for (k = 0; k < XQC_TEST_RLC_SYB_SIZE; k++) {
+                xqc_test_rlc_src[i][j][k] = (i * 131 + j * 17 + k * 7 + 1) & 0xff;
+            }
+            fec_ctl->fec_send_symbol_num[bm] = j;
+            ret = xqc_rlc_encode(conn, xqc_test_rlc_src[i][j], XQC_TEST_RLC_SYB_SIZE, outputs, bm);
+            CU_ASSERT(ret == XQC_OK);
+
+            /* repair symbols are taken away as soon as they are generated */
+            for (k = 0; k < XQC_TEST_RLC_RPR_NUM; k++) {
+                if (!fec_ctl->fec_send_repair_symbols_buff[bm][k].is_valid) {
+                    continue;
+                }
+                CU_ASSERT(fec_ctl->fec_send_repair_key[bm][k].payload_size == XQC_RLC_KEY_SIZE);
+                xqc_memcpy(xqc_test_rlc_rpr[i][k].payload, fec_ctl->fec_send_repair_symbols_buff[bm][k].payload,
+                           fec_ctl->fec_send_repair_symbols_buff[bm][k].payload_size);
+                xqc_memcpy(xqc_test_rlc_rpr[i][k].key, fec_ctl->fec_send_repair_key[bm][k].payload, XQC_RLC_KEY_SIZE);
+                xqc_test_rlc_rpr[i][k].payload_size = fec_ctl->fec_send_repair_symbols_buff[bm][k].payload_size;
+                xqc_test_rlc_rpr[i][k].valid = 1;
+                fec_ctl->fec_send_repair_symbols_buff[bm][k].is_valid = 0;
+                fec_ctl->fec_send_repair_key[bm][k].is_valid = 0;
+            }
+        }
+    }
+}
+
+static void
+xqc_test_rlc_recv_rpr(xqc_connection_t *conn, xqc_int_t block_id, xqc_int_t rpr_idx)
+{
+    xqc_int_t ret;
+    xqc_fec_rpr_syb_t tmp_rpr_symbol = {
+        .block_id = block_id,
+        .symbol_idx = rpr_idx,
+        .payload = xqc_test_rlc_rpr[block_id][rpr_idx].payload,
+        .payload_size = xqc_test_rlc_rpr[block_id][rpr_idx].payload_size,
+        .repair_key = xqc_test_rlc_rpr[block_id][rpr_idx].key,
+        .repair_key_size = XQC_RLC_KEY_SIZE,
+    };
+
+    ret = xqc_process_rpr_symbol(conn, &tmp_rpr_symbol);
+    CU_ASSERT(ret == XQC_OK);
+    ret = xqc_rlc_decode_one(conn, NULL, block_id, rpr_idx);
+    CU_ASSERT(ret == XQC_OK);
+}
+
+static void
+xqc_test_rlc_recv_src(xqc_connection_t *conn, xqc_int_t block_id, xqc_int_t symbol_idx)
+{
+    xqc_int_t ret;
+
+    ret = xqc_process_src_symbol(conn, block_id, symbol_idx, xqc_test_rlc_src[block_id][symbol_idx],
+                                 XQC_TEST_RLC_SYB_SIZE);
+    CU_ASSERT(ret == XQC_OK);
+}
+
+void
+xqc_test_rlc_decode()
+{
+    xqc_int_t i, block_id, symbol_idx, recovered;
+    size_t size;
+    xqc_usec_t recv_time;
+    unsigned char output[XQC_MAX_SYMBOL_SIZE];
+    xqc_rlc_window_t win;
+    xqc_connection_t *conn = test_engine_connect_fec();
+
+    CU_ASSERT(conn != NULL && conn->fec_ctl != NULL);
+    if (conn == NULL || conn->fec_ctl == NULL) {
+        return;
+    }
+    conn->conn_settings.fec_params.fec_encoder_scheme = XQC_RLC_CODE;
+    conn->conn_settings.fec_params.fec_decoder_scheme = XQC_RLC_CODE;
+    conn->conn_settings.fec_params.fec_max_symbol_num_per_block = XQC_TEST_RLC_BLK_SIZE;
+    conn->fec_ctl->fec_send_required_repair_num[XQC_DEFAULT_SIZE_REQ] = XQC_TEST_RLC_RPR_NUM;
+
+    xqc_test_rlc_encode(conn);
+
+    /* the first repair symbol of a block also covers the tail of the previous block */
+    for (i = 0; i < XQC_TEST_RLC_BLK_NUM; i++) {
+        CU_ASSERT(xqc_test_rlc_rpr[i][0].valid && xqc_test_rlc_rpr[i][1].valid);
+    }
+    CU_ASSERT(xqc_rlc_parse_key(xqc_test_rlc_rpr[1][0].key, XQC_RLC_KEY_SIZE, &win) == XQC_OK);
+    CU_ASSERT(win.prev_block_id == 0 && win.prev_first == 4 && win.prev_num == 4);
+    CU_ASSERT(win.cur_first == 0 && win.cur_num == 4);
+    CU_ASSERT(xqc_rlc_parse_key(xqc_test_rlc_rpr[0][1].key, XQC_RLC_KEY_SIZE, &win) == XQC_OK);
+    CU_ASSERT(win.prev_num == 0 && win.cur_first == 0 && win.cur_num == XQC_TEST_RLC_BLK_SIZE);
+
+    /* symbols 6 and 7 of block 0 are lost, block 0 alone can't recover them */
+    for (i = 0; i < 6; i++) {
+        xqc_test_rlc_recv_src(conn, 0, i);
+    }
+    xqc_test_rlc_recv_rpr(conn, 0, 0);
+    xqc_test_rlc_recv_rpr(conn, 0, 1);
+    CU_ASSERT(!xqc_rlc_pop_recovered(conn, output, &size, &block_id, &symbol_idx, &recv_time));
+
+    /* the repair symbol of block 1 arrives ahead of the source symbols it covers */
+    xqc_test_rlc_recv_rpr(conn, 1, 0);
+    CU_ASSERT(!xqc_rlc_pop_recovered(conn, output, &size, &block_id, &symbol_idx, &recv_time));
+    for (i = 0; i < 4; i++) {
+        xqc_test_rlc_recv_src(conn, 1, i);
+    }
+
+    recovered = 0;
+    while (xqc_rlc_pop_recovered(conn, output, &size, &block_id, &symbol_idx, &recv_time)) {
+        CU_ASSERT(block_id == 0 && (symbol_idx == 6 || symbol_idx == 7));
+        CU_ASSERT(size >= XQC_TEST_RLC_SYB_SIZE);
+        CU_ASSERT(xqc_memcmp(output, xqc_test_rlc_src[0][symbol_idx], XQC_TEST_RLC_SYB_SIZE) == 0);
+        recovered++;
+    }
+    CU_ASSERT(recovered == 2);
+
+    /* single loss in block 1, recovered by the last repair symbol */
+    for (i = 5; i < XQC_TEST_RLC_BLK_SIZE; i++) {
+        xqc_test_rlc_recv_src(conn, 1, i);
+    }
+    xqc_test_rlc_recv_rpr(conn, 1, 1);
+    CU_ASSERT(xqc_rlc_pop_recovered(conn, output, &size, &block_id, &symbol_idx, &recv_time));
+    CU_ASSERT(block_id == 1 && symbol_idx == 4);
+    CU_ASSERT(xqc_memcmp(output, xqc_test_rlc_src[1][4], XQC_TEST_RLC_SYB_SIZE) == 0);
+    CU_ASSERT(!xqc_rlc_pop_recovered(conn, output, &size, &block_id, &symbol_idx, &recv_time));
+
+    xqc_engine_destroy(conn->engine);
+}
+
+void
+xqc_test_fec_rlc()
+{
+    xqc_test_rlc_key();
+    xqc_test_rlc_decode();
+}
@@ -0,0 +1,335 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_fec_rs16_test.h"
+#include "xqc_fec_scheme_test.h"
+#include "include/xquic/xquic.h"
+#include "src/transport/xqc_fec.h"
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_engine.h"
+#include "src/transport/xqc_fec_scheme.h"
+#include "src/transport/fec_schemes/xqc_galois16.h"
+#include "src/transport/fec_schemes/xqc_reed_solomon16.h"
+#include "xqc_common_test.h"
+
+#define XQC_TEST_RS16_LARGE_K       1000
+#define XQC_TEST_RS16_LARGE_R       40
+#define XQC_TEST_RS16_CONN_K        8
+#define XQC_TEST_RS16_CONN_R        3
+#define XQC_TEST_RS16_SYB_SIZE      101
+#define XQC_TEST_RS16_WIDE_K        40
+#define XQC_TEST_RS16_WIDE_R        (XQC_FEC_MAX_REPAIR_NUM_PBLOCK + 6)
+
+
+static uint32_t
+xqc_test_rs16_rand(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void
+xqc_test_rs16_fill(uint32_t *state, unsigned char *buf, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        buf[i] = xqc_test_rs16_rand(state) & 0xff;
+    }
+}
+
+void
+xqc_test_gf16_field()
+{
+    uint32_t a, b, c;
+    xqc_gf16_t q;
+
+    for (a = 1; a <= XQC_GF16_ORDER; a++) {
+        CU_ASSERT(xqc_gf16_multiply(a, xqc_gf16_inverse(a)) == 1);
+    }
+    CU_ASSERT(xqc_gf16_multiply(0, 1234) == 0);
+    CU_ASSERT(xqc_gf16_inverse(0) == 0);
+    CU_ASSERT(xqc_gf16_divide(1, 0, &q) == -XQC_EPARAM);
+
+    for (a = 3; a < XQC_GF16_ORDER; a += 257) {
+        for (b = 5; b < XQC_GF16_ORDER; b += 1031) {
+            c = xqc_gf16_multiply(a, b);
+            CU_ASSERT(xqc_gf16_divide(c, b, &q) == XQC_OK && q == a);
+            /* distributive over the xor addition */
+            CU_ASSERT(xqc_gf16_multiply(a, b ^ 0x8001) == (c ^ xqc_gf16_multiply(a, 0x8001)));
+        }
+    }
+}
+
+void
+xqc_test_gf16_region()
+{
+    uint32_t state = 7;
+    size_t len;
+    xqc_gf16_t coef;
+    unsigned char src[512], dst[514], ref[514], orig[514];
+
+    /* both lengths below and above the simd threshold, odd and even */
+    for (len = 0; len <= sizeof(src); len += 37) {
+        coef = xqc_test_rs16_rand(&state) & 0xffff;
+        xqc_test_rs16_fill(&state, src, len);
+        xqc_test_rs16_fill(&state, dst, sizeof(dst));
+        xqc_memcpy(ref, dst, sizeof(dst));
+        xqc_memcpy(orig, dst, sizeof(dst));
+
+        xqc_gf16_region_muladd(dst, src, coef, len);
+        xqc_gf16_region_muladd_ref(ref, src, coef, len);
+        CU_ASSERT(xqc_memcmp(dst, ref, sizeof(dst)) == 0);
+        /* nothing past the region is written, even for odd lengths */
+        CU_ASSERT(xqc_memcmp(dst + len, orig + len, sizeof(dst) - len) == 0);
+
+        /* adding the same product twice cancels out */
+        xqc_gf16_region_muladd(dst, src, coef, len);
+        xqc_gf16_region_muladd_ref(ref, src, coef, len);
+        CU_ASSERT(xqc_memcmp(dst, ref, sizeof(dst)) == 0);
+    }
+}
+
+void
+xqc_test_gf16_cauchy()
+{
+    xqc_int_t i, j, k, n = 20;
+    xqc_gf16_t x[20], y[20], inv[20 * 20], sum;
+
+    for (i = 0; i < n; i++) {
+        x[i] = 3 * i + 1;
+        y[i] = XQC_RS16_MAX_REPAIR + 7 * i;
+    }
+    CU_ASSERT(xqc_gf16_invert_cauchy(x, y, n, inv) == XQC_OK);
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            sum = 0;
+            for (k = 0; k < n; k++) {
+                sum ^= xqc_gf16_multiply(xqc_gf16_inverse(x[i] ^ y[k]), inv[k * n + j]);
+            }
+            CU_ASSERT(sum == (i == j));
+        }
+    }
+
+    /* x and y must not meet */
+    y[3] = x[5];
+    CU_ASSERT(xqc_gf16_invert_cauchy(x, y, n, inv) == -XQC_EPARAM);
+}
+
+void
+xqc_test_rs16_large_block()
+{
+    uint32_t state = 11;
+    xqc_int_t i, j, ret, lost, rows[XQC_TEST_RS16_LARGE_R];
+    size_t size = XQC_TEST_RS16_SYB_SIZE, buf_size = XQC_TEST_RS16_SYB_SIZE + 1;
+    unsigned char *data, *src[XQC_TEST_RS16_LARGE_K], *recv[XQC_TEST_RS16_LARGE_K];
+    unsigned char *rpr[XQC_TEST_RS16_LARGE_R], *outputs[XQC_TEST_RS16_LARGE_R];
+
+    data = xqc_calloc(XQC_TEST_RS16_LARGE_K + 2 * XQC_TEST_RS16_LARGE_R, buf_size);
+    CU_ASSERT_FATAL(data != NULL);
+    for (i = 0; i < XQC_TEST_RS16_LARGE_K; i++) {
+        src[i] = data + i * buf_size;
+        xqc_test_rs16_fill(&state, src[i], size);
+    }
+    for (j = 0; j < XQC_TEST_RS16_LARGE_R; j++) {
+        rpr[j] = data + (XQC_TEST_RS16_LARGE_K + j) * buf_size;
+        outputs[j] = data + (XQC_TEST_RS16_LARGE_K + XQC_TEST_RS16_LARGE_R + j) * buf_size;
+        rows[j] = j;
+    }
+
+    for (i = 0; i < XQC_TEST_RS16_LARGE_K; i++) {
+        ret = xqc_rs16_code_one_symbol(src[i], size, i, rpr, XQC_TEST_RS16_LARGE_R);
+        CU_ASSERT(ret == XQC_OK);
+    }
+
+    /* a burst of lost source symbols and lost repair symbols, as many as repair symbols left */
+    for (i = 0; i < XQC_TEST_RS16_LARGE_K; i++) {
+        recv[i] = (i >= 500 && i < 530) ? NULL : src[i];
+    }
+    lost = 30;
+    for (i = 0; i < XQC_TEST_RS16_LARGE_K && lost < XQC_TEST_RS16_LARGE_R - 2; i += 97) {
+        if (recv[i] != NULL) {
+            recv[i] = NULL;
+            lost++;
+        }
+    }
+    rpr[0] = rpr[7] = NULL;
+
+    ret = xqc_rs16_decode_symbols(recv, XQC_TEST_RS16_LARGE_K, rpr, rows, XQC_TEST_RS16_LARGE_R,
+                                  outputs, size);
+    CU_ASSERT(ret == XQC_OK);
+    for (i = 0, j = 0; i < XQC_TEST_RS16_LARGE_K; i++) {
+        if (recv[i] == NULL) {
+            CU_ASSERT(xqc_memcmp(outputs[j], src[i], size) == 0);
+            j++;
+        }
+    }
+    CU_ASSERT(j == lost);
+
+    /* one more loss than repair symbols received */
+    recv[1] = NULL;
+    ret = xqc_rs16_decode_symbols(recv, XQC_TEST_RS16_LARGE_K, rpr, rows, XQC_TEST_RS16_LARGE_R,
+                                  outputs, size);
+    CU_ASSERT(ret == -XQC_EFEC_SCHEME_ERROR);
+
+    xqc_free(data);
+}
+
+void
+xqc_test_rs16_conn()
+{
+    uint32_t state = 5;
+    xqc_int_t i, j, ret, row, src_num;
+    size_t size;
+    uint8_t bm = XQC_DEFAULT_SIZE_REQ;
+    unsigned char src[XQC_TEST_RS16_CONN_K][XQC_TEST_RS16_SYB_SIZE];
+    unsigned char *outputs[XQC_REPAIR_LEN];
+    xqc_connection_t *conn = test_engine_connect_fec();
+
+    CU_ASSERT(conn != NULL && conn->fec_ctl != NULL);
+    if (conn == NULL || conn->fec_ctl == NULL) {
+        return;
+    }
+    conn->conn_settings.fec_params.fec_encoder_scheme = XQC_REED_SOLOMON_16_CODE;
+    conn->conn_settings.fec_params.fec_decoder_scheme = XQC_REED_SOLOMON_16_CODE;
+    conn->fec_ctl->fec_send_required_repair_num[bm] = XQC_TEST_RS16_CONN_R;
+    xqc_reed_solomon16_init(conn);
+
+    for (j = 0; j < XQC_REPAIR_LEN; j++) {
+        outputs[j] = conn->fec_ctl->fec_send_repair_symbols_buff[bm][j].payload;
+    }
+    for (i = 0; i < XQC_TEST_RS16_CONN_K; i++) {
+        /* source symbols of odd and of different sizes */
+        xqc_test_rs16_fill(&state, src[i], XQC_TEST_RS16_SYB_SIZE);
+        conn->fec_ctl->fec_send_symbol_num[bm] = i;
+        ret = xqc_reed_solomon16_encode(conn, src[i], XQC_TEST_RS16_SYB_SIZE - i, outputs, bm);
+        CU_ASSERT(ret == XQC_OK);
+    }
+
+    for (j = 0; j < XQC_TEST_RS16_CONN_R; j++) {
+        xqc_fec_object_t *key = &conn->fec_ctl->fec_send_repair_key[bm][j];
+        xqc_fec_object_t *rpr = &conn->fec_ctl->fec_send_repair_symbols_buff[bm][j];
+        CU_ASSERT(key->is_valid && rpr->is_valid && rpr->payload_size == XQC_TEST_RS16_SYB_SIZE + 1);
+        CU_ASSERT(xqc_rs16_parse_key(key->payload, key->payload_size, &row, &src_num) == XQC_OK);
+        CU_ASSERT(row == j && src_num == XQC_TEST_RS16_CONN_K);
+
+        xqc_fec_rpr_syb_t tmp_rpr_symbol = {
+            .block_id = 0,
+            .symbol_idx = j,
+            .payload = rpr->payload,
+            .payload_size = rpr->payload_size,
+            .repair_key = key->payload,
+            .repair_key_size = key->payload_size,
+        };
+        CU_ASSERT(xqc_process_rpr_symbol(conn, &tmp_rpr_symbol) == XQC_OK);
+    }
+
+    /* symbols 1, 4 and 6 are lost */
+    for (i = 0; i < XQC_TEST_RS16_CONN_K; i++) {
+        if (i != 1 && i != 4 && i != 6) {
+            ret = xqc_process_src_symbol(conn, 0, i, src[i], XQC_TEST_RS16_SYB_SIZE - i);
+            CU_ASSERT(ret == XQC_OK);
+        }
+    }
+
+    for (j = 0; j < XQC_TEST_RS16_CONN_R; j++) {
+        outputs[j] = conn->fec_ctl->fec_gen_repair_symbols_buff[j].payload;
+    }
+    ret = xqc_reed_solomon16_decode(conn, outputs, &size, 0);
+    CU_ASSERT(ret == XQC_OK && size == XQC_TEST_RS16_SYB_SIZE + 1);
+    CU_ASSERT(xqc_memcmp(outputs[0], src[1], XQC_TEST_RS16_SYB_SIZE - 1) == 0);
+    CU_ASSERT(xqc_memcmp(outputs[1], src[4], XQC_TEST_RS16_SYB_SIZE - 4) == 0);
+    CU_ASSERT(xqc_memcmp(outputs[2], src[6], XQC_TEST_RS16_SYB_SIZE - 6) == 0);
+    /* the rest of a shorter symbol is zero padding */
+    CU_ASSERT(outputs[2][XQC_TEST_RS16_SYB_SIZE - 6] == 0 && outputs[2][XQC_TEST_RS16_SYB_SIZE] == 0);
+
+    xqc_engine_destroy(conn->engine);
+}
+
+/* more repair symbols than schemes over GF(2^8) may carry, through xqc_fec_encoder */
+static void
+xqc_test_rs16_conn_wide()
+{
+    uint32_t state = 7;
+    xqc_int_t i, j, ret, lost;
+    size_t size;
+    uint8_t bm = XQC_DEFAULT_SIZE_REQ;
+    unsigned char src[XQC_TEST_RS16_WIDE_K][XQC_TEST_RS16_SYB_SIZE];
+    unsigned char *outputs[XQC_REPAIR_LEN];
+    xqc_connection_t *conn = test_engine_connect_fec();
+
+    CU_ASSERT(conn != NULL && conn->fec_ctl != NULL);
+    if (conn == NULL || conn->fec_ctl == NULL) {
+        return;
+    }
+    conn->conn_settings.fec_params.fec_encoder_scheme = XQC_REED_SOLOMON_16_CODE;
+    conn->conn_settings.fec_params.fec_decoder_scheme = XQC_REED_SOLOMON_16_CODE;
+    conn->conn_settings.fec_params.fec_max_symbol_num_per_block = XQC_TEST_RS16_WIDE_K;
+    conn->conn_settings.fec_callback = xqc_reed_solomon16_code_cb;
+    conn->fec_ctl->fec_send_required_repair_num[bm] = XQC_TEST_RS16_WIDE_R;
+    CU_ASSERT(conn->fec_ctl->fec_send_repair_symbols_buff[bm][XQC_FEC_MAX_REPAIR_NUM_PBLOCK].payload == NULL);
+
+    for (i = 0; i < XQC_TEST_RS16_WIDE_K; i++) {
+        xqc_test_rs16_fill(&state, src[i], XQC_TEST_RS16_SYB_SIZE);
+        conn->fec_ctl->fec_send_symbol_num[bm] = i;
+        CU_ASSERT(xqc_fec_encoder(conn, src[i], XQC_TEST_RS16_SYB_SIZE, bm) == XQC_OK);
+    }
+
+    for (j = 0; j < XQC_TEST_RS16_WIDE_R; j++) {
+        xqc_fec_object_t *key = &conn->fec_ctl->fec_send_repair_key[bm][j];
+        xqc_fec_object_t *rpr = &conn->fec_ctl->fec_send_repair_symbols_buff[bm][j];
+        CU_ASSERT(key->is_valid && rpr->is_valid);
+
+        xqc_fec_rpr_syb_t tmp_rpr_symbol = {
+            .block_id = 0,
+            .symbol_idx = j,
+            .payload = rpr->payload,
+            .payload_size = rpr->payload_size,
+            .repair_key = key->payload,
+            .repair_key_size = key->payload_size,
+        };
+        CU_ASSERT(xqc_process_rpr_symbol(conn, &tmp_rpr_symbol) == XQC_OK);
+    }
+
+    /* every other symbol of the first 2 * R is lost */
+    for (i = 0; i < XQC_TEST_RS16_WIDE_K; i++) {
+        if (i >= 2 * XQC_TEST_RS16_WIDE_R || i % 2 == 1) {
+            ret = xqc_process_src_symbol(conn, 0, i, src[i], XQC_TEST_RS16_SYB_SIZE);
+            CU_ASSERT(ret == XQC_OK);
+        }
+    }
+
+    CU_ASSERT(xqc_fec_ctl_alloc_gen_repair_buff(conn->fec_ctl, XQC_TEST_RS16_WIDE_R) == XQC_OK);
+    for (j = 0; j < XQC_TEST_RS16_WIDE_R; j++) {
+        outputs[j] = conn->fec_ctl->fec_gen_repair_symbols_buff[j].payload;
+    }
+    ret = xqc_reed_solomon16_decode(conn, outputs, &size, 0);
+    CU_ASSERT(ret == XQC_OK && size == XQC_TEST_RS16_SYB_SIZE + 1);
+    lost = 0;
+    for (i = 0; i < 2 * XQC_TEST_RS16_WIDE_R; i += 2) {
+        CU_ASSERT(xqc_memcmp(outputs[lost++], src[i], XQC_TEST_RS16_SYB_SIZE) == 0);
+    }
+
+    /* a block of the scheme can not carry more */
+    conn->fec_ctl->fec_send_symbol_num[bm] = 0;
+    conn->fec_ctl->fec_send_required_repair_num[bm] = XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK + 1;
+    CU_ASSERT(xqc_fec_encoder(conn, src[0], XQC_TEST_RS16_SYB_SIZE, bm) == -XQC_EPARAM);
+
+    xqc_engine_destroy(conn->engine);
+}
+
+void
+xqc_test_fec_rs16()
+{
+    xqc_test_gf16_field();
+    xqc_test_gf16_region();
+    xqc_test_gf16_cauchy();
+    xqc_test_rs16_large_block();
+    xqc_test_rs16_conn();
+    xqc_test_rs16_conn_wide();
+}
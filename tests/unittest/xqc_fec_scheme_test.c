@@ -115,11 +115,13 @@ xqc_test_invalid_encoder_params()
     ret = xqc_fec_encoder(conn, XQC_TEST_STREAM, 5, 0);
     CU_ASSERT(ret == -XQC_EFEC_SCHEME_ERROR);
 
-    /** test null repair symbols buffer */
+    /** test null repair symbols buffer, which is allocated again */
     conn->conn_settings.fec_callback = xqc_xor_code_cb;
+    xqc_free(conn->fec_ctl->fec_send_repair_symbols_buff[0][0].payload);
     conn->fec_ctl->fec_send_repair_symbols_buff[0][0].payload = NULL;
     ret = xqc_fec_encoder(conn, XQC_TEST_STREAM, 5, 0);
-    CU_ASSERT(ret == -XQC_EMALLOC);
+    CU_ASSERT(ret != -XQC_EMALLOC && conn->fec_ctl->fec_send_repair_symbols_buff[0][0].payload != NULL);
+    xqc_free(conn->fec_ctl->fec_send_repair_symbols_buff[0][0].payload);
 
     /** test fec encoder processing error */
 
@@ -246,11 +248,16 @@ xqc_test_fec_decode()
 
 
     /** Following tests focus on fec_bc_decoder */
-    /** test invalid repair symbol size */
+    /** test null recovered symbols buffer, which is allocated again */
     conn->fec_ctl->fec_gen_repair_symbols_buff[0].payload = NULL;
     loss_cnt = 1;
     ret = xqc_fec_bc_decoder(conn, 0, loss_cnt, 0);
-    CU_ASSERT(ret == -XQC_EMALLOC);
+    CU_ASSERT(ret != -XQC_EMALLOC && conn->fec_ctl->fec_gen_repair_symbols_buff[0].payload != NULL);
+    xqc_free(conn->fec_ctl->fec_gen_repair_symbols_buff[0].payload);
+
+    /** test more lost symbols than the scheme has repair symbols */
+    ret = xqc_fec_bc_decoder(conn, 0, XQC_REPAIR_LEN + 1, 0);
+    CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
 
     /** test invlid  decode process */
     conn->fec_ctl->fec_gen_repair_symbols_buff[0].payload = test_buffer;
@@ -8,6 +8,7 @@
 #include "include/xquic/xquic.h"
 #include "src/transport/xqc_fec.h"
 #include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_fec_scheme.h"
 #include "src/transport/xqc_packet_out.h"
 #include "xqc_common_test.h"
 
@@ -147,7 +148,7 @@ xqc_test_chk_fec_param()
     xqc_connection_t *conn = test_engine_connect_fec();
 
     /** test invalid repair numbers */
-    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK, XQC_REPAIR_LEN + 1, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE);
+    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK, XQC_FEC_MAX_REPAIR_NUM_PBLOCK + 1, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE);
     CU_ASSERT(ret == -XQC_EFEC_SCHEME_ERROR);
 
     /** test too low repair number */
@@ -155,15 +156,40 @@ xqc_test_chk_fec_param()
     CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
 
     /** test invalid src symbol number */
-    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK + 1, XQC_REPAIR_LEN, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE);
+    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK + 1, XQC_FEC_MAX_REPAIR_NUM_PBLOCK, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE);
     CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
 
+    /** test src symbol number of scheme over GF(2^16) */
+    xqc_fec_schemes_e scheme = conn->conn_settings.fec_params.fec_encoder_scheme;
+    conn->conn_settings.fec_params.fec_encoder_scheme = XQC_REED_SOLOMON_16_CODE;
+    ret = xqc_check_fec_params(conn, XQC_FEC_RS16_MAX_SYMBOL_NUM_PBLOCK, XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE);
+    CU_ASSERT(ret == XQC_OK);
+    ret = xqc_check_fec_params(conn, XQC_FEC_RS16_MAX_SYMBOL_NUM_PBLOCK + 1, XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE);
+    CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
+
+    /** test repair number over the cap of the scheme */
+    ret = xqc_check_fec_params(conn, XQC_FEC_RS16_MAX_SYMBOL_NUM_PBLOCK, XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK + 1, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE);
+    CU_ASSERT(ret == -XQC_EFEC_SCHEME_ERROR);
+    conn->conn_settings.fec_params.fec_encoder_scheme = XQC_REED_SOLOMON_CODE;
+    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK, XQC_FEC_MAX_REPAIR_NUM_PBLOCK + 1, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE);
+    CU_ASSERT(ret == -XQC_EFEC_SCHEME_ERROR);
+    conn->conn_settings.fec_params.fec_encoder_scheme = XQC_XOR_CODE;
+    ret = xqc_fec_encoder_check_params(conn, 2, XQC_XOR_CODE, XQC_MAX_SYMBOL_SIZE);
+    CU_ASSERT(ret == -XQC_EPARAM);
+    ret = xqc_fec_encoder_check_params(conn, XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK, XQC_REED_SOLOMON_16_CODE, XQC_MAX_SYMBOL_SIZE);
+    CU_ASSERT(ret == XQC_OK);
+    ret = xqc_fec_encoder_check_params(conn, XQC_FEC_RS16_MAX_REPAIR_NUM_PBLOCK + 1, XQC_REED_SOLOMON_16_CODE, XQC_MAX_SYMBOL_SIZE);
+    CU_ASSERT(ret == -XQC_EPARAM);
+    ret = xqc_fec_encoder_check_params(conn, XQC_FEC_MAX_REPAIR_NUM_PBLOCK + 1, XQC_REED_SOLOMON_CODE, XQC_MAX_SYMBOL_SIZE);
+    CU_ASSERT(ret == -XQC_EPARAM);
+    conn->conn_settings.fec_params.fec_encoder_scheme = scheme;
+
     /** test invalid symbol window */
-    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK, XQC_REPAIR_LEN, XQC_SYMBOL_CACHE_LEN + 1, XQC_MAX_SYMBOL_SIZE);
+    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK, XQC_FEC_MAX_REPAIR_NUM_PBLOCK, XQC_MAX_SYMBOL_CACHE_LEN + 1, XQC_MAX_SYMBOL_SIZE);
     CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
 
     /** test invalid symbol size */
-    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK, XQC_REPAIR_LEN, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE + 1);
+    ret = xqc_check_fec_params(conn, XQC_FEC_MAX_SYMBOL_NUM_PBLOCK, XQC_FEC_MAX_REPAIR_NUM_PBLOCK, XQC_SYMBOL_CACHE_LEN, XQC_MAX_SYMBOL_SIZE + 1);
     CU_ASSERT(ret == -XQC_EFEC_SYMBOL_ERROR);
 
     xqc_engine_destroy(conn->engine);
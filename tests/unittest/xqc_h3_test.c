@@ -7,15 +7,21 @@
 #include "src/http3/frame/xqc_h3_frame.h"
 #include "src/http3/xqc_h3_conn.h"
 #include "src/http3/xqc_h3_stream.h"
+#include "src/http3/xqc_h3_request.h"
 #include "src/http3/qpack/xqc_qpack.h"
 #include "src/transport/xqc_stream.h"
 #include "src/http3/qpack/stable/xqc_stable.h"
+#include "src/transport/xqc_engine.h"
+#include "src/transport/xqc_send_queue.h"
+#include "src/transport/xqc_packet_out.h"
 
 #include "xqc_common_test.h"
 
 
 ssize_t xqc_h3_stream_write_data_to_buffer(xqc_h3_stream_t *h3s, unsigned char *data, uint64_t data_size, uint8_t fin);
 xqc_int_t xqc_decoder_copy_header(xqc_http_header_t *hdr, xqc_var_buf_t *name, xqc_var_buf_t *value);
+xqc_h3_request_t *xqc_h3_request_create_inner(xqc_h3_conn_t *h3_conn, xqc_h3_stream_t *h3_stream,
+    void *user_data);
 
 
 ssize_t
@@ -86,6 +92,11 @@ xqc_test_frame()
     /* write settings frame */
     ret = xqc_h3_frm_write_settings(&send_buf, &settings, XQC_TRUE);
     CU_ASSERT(ret == XQC_OK);
+    /* write priority_update frame */
+    char prio_field[] = "u=1, i";
+    ret = xqc_h3_frm_write_priority_update(&send_buf, push_id << 2, prio_field,
+                                           strlen(prio_field), XQC_TRUE);
+    CU_ASSERT(ret == XQC_OK);
 
     xqc_var_buf_t *buf = xqc_var_buf_create(XQC_VAR_BUF_INIT_SIZE);
     xqc_list_head_t *pos, *next;
@@ -151,6 +162,19 @@ xqc_test_frame()
     CU_ASSERT(processed > 0);
     CU_ASSERT(pctx.state == XQC_H3_FRM_STATE_END);
     buf->consumed_len += processed;
+    xqc_h3_frm_reset_pctx(&pctx);
+    /* parse priority_update frame */
+    processed = xqc_test_frame_parse(buf->data + buf->consumed_len, buf->data_len - buf->consumed_len, &pctx);
+    CU_ASSERT(processed > 0);
+    CU_ASSERT(pctx.state == XQC_H3_FRM_STATE_END);
+    CU_ASSERT(pctx.frame.type == XQC_H3_FRM_PRIORITY_UPDATE_REQUEST);
+    CU_ASSERT(pctx.frame.frame_payload.priority_update.prioritized_element_id.vi == push_id << 2);
+    xqc_var_buf_t *prio_buf = pctx.frame.frame_payload.priority_update.priority_field_value;
+    CU_ASSERT(prio_buf != NULL && prio_buf->data_len == strlen(prio_field));
+    if (prio_buf != NULL && prio_buf->data_len == strlen(prio_field)) {
+        CU_ASSERT(memcmp(prio_buf->data, prio_field, prio_buf->data_len) == 0);
+    }
+    buf->consumed_len += processed;
     CU_ASSERT(buf->consumed_len == buf->data_len);
     xqc_h3_frm_reset_pctx(&pctx);
 
@@ -461,3 +485,122 @@ xqc_test_stream()
         xqc_free(conn->alpn);
     }
 }
+
+/* recycle packets written by request streams, to keep transport from allocating new ones */
+static void
+xqc_test_recycle_packets(xqc_connection_t *conn)
+{
+    xqc_list_head_t *pos, *next;
+    xqc_send_queue_t *send_queue = conn->conn_send_queue;
+
+    xqc_list_for_each_safe(pos, next, &send_queue->sndq_send_packets) {
+        xqc_packet_out_t *packet_out = xqc_list_entry(pos, xqc_packet_out_t, po_list);
+        xqc_send_queue_remove_send(pos);
+        xqc_send_queue_insert_free(packet_out, &send_queue->sndq_free_packets, send_queue);
+    }
+}
+
+static ssize_t
+xqc_test_send_request_headers(xqc_connection_t *conn, xqc_h3_conn_t *h3c,
+    xqc_http_headers_t *headers, size_t *alloc_cnt)
+{
+    xqc_stream_t *stream = xqc_create_stream_with_conn(conn, XQC_UNDEFINE_STREAM_ID, XQC_CLI_BID,
+                                                       NULL, NULL);
+    CU_ASSERT_FATAL(stream != NULL);
+    stream->stream_flow_ctl.fc_max_stream_data_can_send = XQC_MAX_UINT32_VALUE;
+
+    xqc_h3_stream_t *h3s = xqc_h3_stream_create(h3c, stream, XQC_H3_STREAM_TYPE_REQUEST, NULL);
+    CU_ASSERT_FATAL(h3s != NULL);
+    xqc_h3_request_t *h3r = xqc_h3_request_create_inner(h3c, h3s, NULL);
+    CU_ASSERT_FATAL(h3r != NULL);
+
+#ifdef XQC_ENABLE_ALLOC_COUNT
+    size_t alloc_start = xqc_alloc_count;
+#endif
+
+    ssize_t sent = xqc_h3_request_send_headers(h3r, headers, 1);
+
+    /* allocations are counted by xqc_malloc when built with XQC_ENABLE_TESTING */
+#ifdef XQC_ENABLE_ALLOC_COUNT
+    *alloc_cnt = xqc_alloc_count - alloc_start;
+#else
+    *alloc_cnt = 0;
+#endif
+
+    /* all bytes shall be sent directly */
+    CU_ASSERT(xqc_list_empty(&h3s->send_buf));
+    CU_ASSERT(h3s->flags & XQC_HTTP3_STREAM_FLAG_FIN_SENT);
+
+    xqc_test_recycle_packets(conn);
+    return sent;
+}
+
+void
+xqc_test_h3_headers_alloc()
+{
+    size_t i, alloc_cnt;
+    ssize_t sent;
+
+    xqc_connection_t *conn = test_engine_connect();
+    CU_ASSERT_FATAL(conn != NULL);
+
+    /* set alpn to H3 */
+    if (conn->alpn) {
+        xqc_free(conn->alpn);
+    }
+    conn->alpn_len = strlen(XQC_ALPN_H3);
+    conn->alpn = xqc_calloc(1, conn->alpn_len + 1);
+    xqc_memcpy(conn->alpn, XQC_ALPN_H3, conn->alpn_len);
+
+    /* make connection writable, and leave packets in send queue */
+    conn->conn_flag |= XQC_CONN_FLAG_CAN_SEND_1RTT;
+    conn->conn_flow_ctl.fc_max_data_can_send = XQC_MAX_UINT32_VALUE;
+    conn->conn_flow_ctl.fc_max_streams_bidi_can_send = XQC_MAX_UINT32_VALUE;
+    conn->engine->config->manually_triggered_send = 1;
+
+    xqc_h3_conn_t *h3c = xqc_h3_conn_create(conn, NULL);
+    CU_ASSERT_FATAL(h3c != NULL);
+
+    /* normalized headers, which are sent without being copied */
+    xqc_http_header_t normalized[] = {
+        {.name = {":method", 7}, .value = {"GET", 3}},
+        {.name = {":scheme", 7}, .value = {"https", 5}},
+        {.name = {":authority", 10}, .value = {"test.xquic.com", 14}},
+        {.name = {":path", 5}, .value = {"/index.html", 11}},
+        {.name = {"user-agent", 10}, .value = {"xquic-test", 10}},
+        {.name = {"accept", 6}, .value = {"*/*", 3}},
+    };
+
+    /* uppercase names and disordered pseudo headers, which are normalized in scratch */
+    xqc_http_header_t disordered[] = {
+        {.name = {"User-Agent", 10}, .value = {"xquic-test", 10}},
+        {.name = {":method", 7}, .value = {"GET", 3}},
+        {.name = {":scheme", 7}, .value = {"https", 5}},
+        {.name = {"Accept", 6}, .value = {"*/*", 3}},
+        {.name = {":authority", 10}, .value = {"test.xquic.com", 14}},
+        {.name = {":path", 5}, .value = {"/index.html", 11}},
+    };
+
+    xqc_http_headers_t headers[] = {
+        {.headers = normalized, .count = 6, .capacity = 6},
+        {.headers = disordered, .count = 6, .capacity = 6},
+    };
+
+    for (size_t h = 0; h < 2; h++) {
+        /* the first request warms up the scratch memory of h3 connection */
+        sent = xqc_test_send_request_headers(conn, h3c, &headers[h], &alloc_cnt);
+        CU_ASSERT(sent > 0);
+
+        for (i = 0; i < 16; i++) {
+            sent = xqc_test_send_request_headers(conn, h3c, &headers[h], &alloc_cnt);
+            CU_ASSERT(sent > 0);
+            CU_ASSERT(alloc_cnt == 0);
+        }
+    }
+
+    /* uppercase names are sent in lowercase, the input headers are not modified */
+    CU_ASSERT(memcmp(disordered[0].name.iov_base, "User-Agent", 10) == 0);
+
+    xqc_h3_conn_destroy(h3c);
+    xqc_engine_destroy(conn->engine);
+}
@@ -9,5 +9,6 @@ void xqc_test_frame();
 void xqc_test_stream();
 void xqc_test_ins();
 void xqc_test_rep();
+void xqc_test_h3_headers_alloc();
 
 #endif //XQUIC_XQC_H3_TEST_H
@@ -0,0 +1,197 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <CUnit/CUnit.h>
+#include "xqc_hystart_test.h"
+#include "src/congestion_control/xqc_cubic.h"
+#include "src/congestion_control/xqc_new_reno.h"
+#include "src/transport/xqc_packet.h"
+#include "src/common/xqc_time.h"
+#include "src/common/xqc_malloc.h"
+
+/*
+ * packet level simulation of a single flow through a drop-tail bottleneck. packets are
+ * serialized at the bottleneck rate, wait in a buffer of XQC_TEST_HS_BUF packets, and are
+ * acked one base rtt after leaving it. a dropped packet is declared lost when a packet sent
+ * after it is acked.
+ */
+
+#define XQC_TEST_HS_MSS         XQC_MSS
+#define XQC_TEST_HS_TX_TIME     150         /* 150us per packet */
+#define XQC_TEST_HS_RTT         60000       /* 60ms, bdp is 400 packets */
+#define XQC_TEST_HS_BDP         (XQC_TEST_HS_RTT / XQC_TEST_HS_TX_TIME)
+#define XQC_TEST_HS_BUF         (XQC_TEST_HS_BDP * 2)
+#define XQC_TEST_HS_DURATION    3000000
+#define XQC_TEST_HS_MAX_PKTS    8192
+
+typedef struct {
+    xqc_usec_t      sent_time;
+    xqc_usec_t      ack_time;
+    uint8_t         dropped;
+    uint8_t         in_slow_start;
+} xqc_test_hs_pkt_t;
+
+typedef struct {
+    uint64_t        lost;
+    uint64_t        slow_start_lost;    /* lost packets sent in slow start */
+    xqc_usec_t      time_to_full_bw;
+} xqc_test_hs_result_t;
+
+static void
+xqc_test_hystart_run(const xqc_cong_ctrl_callback_t *cb, uint8_t hystart_enable,
+    xqc_test_hs_result_t *res)
+{
+    xqc_test_hs_pkt_t *pkts, *pkt;
+    uint64_t head = 0, tail = 0, next;
+    xqc_usec_t start, now, departure = 0, recovery_start = 0;
+    xqc_cc_params_t params = {.hystart_enable = hystart_enable};
+    xqc_packet_out_t po;
+
+    void *cc = xqc_calloc(1, cb->xqc_cong_ctl_size());
+    pkts = xqc_calloc(XQC_TEST_HS_MAX_PKTS, sizeof(xqc_test_hs_pkt_t));
+    cb->xqc_cong_ctl_init(cc, NULL, params);
+
+    xqc_memzero(res, sizeof(xqc_test_hs_result_t));
+    xqc_memzero(&po, sizeof(po));
+    po.po_used_size = XQC_TEST_HS_MSS;
+
+    start = now = xqc_monotonic_timestamp();
+    while (now - start < XQC_TEST_HS_DURATION) {
+        /* send as long as cwnd allows */
+        while ((tail - head) * XQC_TEST_HS_MSS < cb->xqc_cong_ctl_get_cwnd(cc)
+               && tail - head < XQC_TEST_HS_MAX_PKTS)
+        {
+            pkt = &pkts[tail++ % XQC_TEST_HS_MAX_PKTS];
+            pkt->sent_time = now;
+            pkt->in_slow_start = cb->xqc_cong_ctl_in_slow_start(cc);
+            departure = xqc_max(departure, now);
+            pkt->dropped = (departure - now) / XQC_TEST_HS_TX_TIME >= XQC_TEST_HS_BUF;
+            if (!pkt->dropped) {
+                departure += XQC_TEST_HS_TX_TIME;
+                pkt->ack_time = departure + XQC_TEST_HS_RTT;
+            }
+        }
+
+        if (res->time_to_full_bw == 0
+            && cb->xqc_cong_ctl_get_cwnd(cc) >= XQC_TEST_HS_BDP * XQC_TEST_HS_MSS)
+        {
+            res->time_to_full_bw = now - start;
+        }
+
+        /* move to the next ack, packets dropped before it are detected lost then */
+        for (next = head; next < tail && pkts[next % XQC_TEST_HS_MAX_PKTS].dropped; next++);
+        if (next == tail) {
+            break;
+        }
+        now = pkts[next % XQC_TEST_HS_MAX_PKTS].ack_time;
+
+        /*
+         * controllers detect recovery by comparing sent time with the wall clock, which is far
+         * behind the simulated one, hence packets sent before recovery are filtered out here.
+         */
+        for (; head <= next; head++) {
+            pkt = &pkts[head % XQC_TEST_HS_MAX_PKTS];
+            if (pkt->dropped) {
+                res->lost++;
+                res->slow_start_lost += pkt->in_slow_start;
+                if (pkt->sent_time > recovery_start) {
+                    cb->xqc_cong_ctl_on_lost(cc, pkt->sent_time);
+                    recovery_start = now;
+                }
+
+            } else if (pkt->sent_time > recovery_start) {
+                po.po_sent_time = pkt->sent_time;
+                cb->xqc_cong_ctl_on_ack(cc, &po, now);
+            }
+        }
+    }
+
+    xqc_free(pkts);
+    xqc_free(cc);
+}
+
+static void
+xqc_test_hystart_cc(const xqc_cong_ctrl_callback_t *cb)
+{
+    xqc_test_hs_result_t classic, hystart;
+
+    xqc_test_hystart_run(cb, 0, &classic);
+    xqc_test_hystart_run(cb, 1, &hystart);
+
+#ifdef DEBUG_PRINT
+    printf("classic lost:%llu, slow_start_lost:%llu, time_to_full_bw:%llu, "
+           "hystart lost:%llu, slow_start_lost:%llu, time_to_full_bw:%llu\n",
+           classic.lost, classic.slow_start_lost, classic.time_to_full_bw,
+           hystart.lost, hystart.slow_start_lost, hystart.time_to_full_bw);
+#endif
+
+    /* doubling the window overshoots even a deep buffer, Conservative Slow Start grows gently */
+    CU_ASSERT(classic.slow_start_lost > XQC_TEST_HS_BDP);
+    CU_ASSERT(hystart.slow_start_lost * 2 < classic.slow_start_lost);
+    CU_ASSERT(hystart.lost < classic.lost);
+
+    /* and HyStart++ does not delay filling the pipe */
+    CU_ASSERT(classic.time_to_full_bw > 0 && hystart.time_to_full_bw > 0);
+    CU_ASSERT(hystart.time_to_full_bw <= classic.time_to_full_bw + XQC_TEST_HS_RTT);
+}
+
+/* two rounds of XQC_TEST_HS_RTT, the second one 25% slower, turn slow start into CSS */
+static void
+xqc_test_hystart_enter_css(xqc_hystart_t *hs)
+{
+    xqc_usec_t now = 1000000;
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        xqc_hystart_on_ack(hs, now - XQC_TEST_HS_RTT, XQC_TEST_HS_RTT, now);
+    }
+    now += XQC_TEST_HS_RTT;
+    for (i = 0; i < 8; i++) {
+        xqc_hystart_on_ack(hs, now - XQC_TEST_HS_RTT, XQC_TEST_HS_RTT * 5 / 4, now);
+    }
+    CU_ASSERT(hs->in_css && hs->window_end > 0);
+}
+
+static void
+xqc_test_hystart_is_reset(xqc_hystart_t *hs)
+{
+    CU_ASSERT(hs->enabled && !hs->in_css && hs->css_rounds == 0 && hs->rtt_sample_cnt == 0);
+    CU_ASSERT(hs->window_end == 0 && hs->last_round_min_rtt == XQC_MAX_UINT64_VALUE
+              && hs->current_round_min_rtt == XQC_MAX_UINT64_VALUE);
+}
+
+/* the rounds of a slow start do not carry over a loss or a collapse of the window */
+static void
+xqc_test_hystart_reset_cc(const xqc_cong_ctrl_callback_t *cb, size_t hystart_offset)
+{
+    xqc_cc_params_t params = {.hystart_enable = 1};
+    void *cc = xqc_calloc(1, cb->xqc_cong_ctl_size());
+    xqc_hystart_t *hs = (xqc_hystart_t *)((char *)cc + hystart_offset);
+
+    cb->xqc_cong_ctl_init(cc, NULL, params);
+
+    xqc_test_hystart_enter_css(hs);
+    cb->xqc_cong_ctl_on_lost(cc, xqc_monotonic_timestamp());
+    xqc_test_hystart_is_reset(hs);
+
+    /* persistent congestion */
+    xqc_test_hystart_enter_css(hs);
+    cb->xqc_cong_ctl_reset_cwnd(cc);
+    xqc_test_hystart_is_reset(hs);
+
+    xqc_free(cc);
+}
+
+void
+xqc_test_hystart()
+{
+    xqc_test_hystart_cc(&xqc_cubic_cb);
+    xqc_test_hystart_reset_cc(&xqc_cubic_cb, offsetof(xqc_cubic_t, hystart));
+#ifdef XQC_ENABLE_RENO
+    xqc_test_hystart_cc(&xqc_reno_cb);
+    xqc_test_hystart_reset_cc(&xqc_reno_cb, offsetof(xqc_new_reno_t, reno_hystart));
+#endif
+}
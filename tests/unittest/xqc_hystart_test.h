@@ -0,0 +1,10 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_HYSTART_TEST_H_INCLUDED_
+#define _XQC_HYSTART_TEST_H_INCLUDED_
+
+void xqc_test_hystart();
+
+#endif /* _XQC_HYSTART_TEST_H_INCLUDED_ */
@@ -0,0 +1,250 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include <string.h>
+#include "xqc_netsim_test.h"
+#include "tests/xqc_netsim.h"
+#include "src/common/xqc_config.h"
+
+#define XQC_TEST_NETSIM_PKT_SIZE    1500
+#define XQC_TEST_NETSIM_SAMPLES     100000
+
+static unsigned char xqc_test_netsim_buf[XQC_TEST_NETSIM_PKT_SIZE];
+
+
+static xqc_netsim_t *
+xqc_test_netsim_create(uint64_t seed, const xqc_netsim_link_conf_t *conf)
+{
+    xqc_netsim_t *sim = xqc_netsim_create(seed);
+    CU_ASSERT_FATAL(sim != NULL);
+    CU_ASSERT(xqc_netsim_add_path(sim, conf, conf) == 0);
+    return sim;
+}
+
+static void
+xqc_test_netsim_send(xqc_netsim_t *sim, int cnt, size_t size)
+{
+    for (int i = 0; i < cnt; i++) {
+        CU_ASSERT(xqc_netsim_send(sim, XQC_NETSIM_CLIENT, 0, xqc_test_netsim_buf, size) == size);
+    }
+}
+
+static void
+xqc_test_netsim_rate_delay()
+{
+    xqc_netsim_link_conf_t conf = {
+        .rate = 12000000,       /* a full datagram every ms */
+        .delay = 10000,
+    };
+    xqc_netsim_t *sim = xqc_test_netsim_create(1, &conf);
+    const xqc_netsim_link_stats_t *stats = xqc_netsim_link_stats(sim, 0, XQC_NETSIM_UPLINK);
+    xqc_usec_t start = xqc_netsim_now();
+
+    CU_ASSERT(start == XQC_NETSIM_EPOCH);
+
+    /* there is only one emulator at a time */
+    CU_ASSERT(xqc_netsim_create(2) == NULL);
+
+    xqc_test_netsim_send(sim, 10, XQC_TEST_NETSIM_PKT_SIZE);
+    CU_ASSERT(stats->max_queue_delay == 9000);
+
+    /* deadline stops the clock with datagrams in flight */
+    CU_ASSERT(xqc_netsim_run(sim, start + 5000) == 0);
+    CU_ASSERT(xqc_netsim_now() == start + 5000);
+    CU_ASSERT(stats->delivered == 0);
+
+    CU_ASSERT(xqc_netsim_run(sim, start + 15000) == 0);
+    CU_ASSERT(stats->delivered == 5);
+
+    /* and without events left, the clock stays at the last one */
+    CU_ASSERT(xqc_netsim_run(sim, XQC_MAX_UINT64_VALUE) == 0);
+    CU_ASSERT(xqc_netsim_now() == start + 20000);
+    CU_ASSERT(stats->delivered == 10);
+    CU_ASSERT(stats->delivered_bytes == 10 * XQC_TEST_NETSIM_PKT_SIZE);
+
+    /* the link is idle again */
+    xqc_test_netsim_send(sim, 1, XQC_TEST_NETSIM_PKT_SIZE);
+    xqc_netsim_run(sim, XQC_MAX_UINT64_VALUE);
+    CU_ASSERT(xqc_netsim_now() == start + 31000);
+
+    xqc_netsim_destroy(sim);
+    CU_ASSERT(xqc_netsim_now() > start + 31000);
+}
+
+static void
+xqc_test_netsim_queue_limit()
+{
+    xqc_netsim_link_conf_t conf = {
+        .rate = 12000000,
+        .delay = 10000,
+        .queue_limit = 4 * XQC_TEST_NETSIM_PKT_SIZE,
+    };
+    xqc_netsim_t *sim = xqc_test_netsim_create(1, &conf);
+    const xqc_netsim_link_stats_t *stats = xqc_netsim_link_stats(sim, 0, XQC_NETSIM_UPLINK);
+
+    xqc_test_netsim_send(sim, 10, XQC_TEST_NETSIM_PKT_SIZE);
+    CU_ASSERT(stats->sent == 10);
+    CU_ASSERT(stats->queue_dropped == 6);
+
+    /* the buffer drains at the link rate */
+    xqc_netsim_run(sim, xqc_netsim_now() + 2000);
+    xqc_test_netsim_send(sim, 10, XQC_TEST_NETSIM_PKT_SIZE);
+    CU_ASSERT(stats->queue_dropped == 14);
+
+    xqc_netsim_run(sim, XQC_MAX_UINT64_VALUE);
+    CU_ASSERT(stats->delivered == 6);
+    xqc_netsim_destroy(sim);
+}
+
+static void
+xqc_test_netsim_random_loss()
+{
+    xqc_netsim_link_conf_t conf = {
+        .delay = 1000,
+        .loss = 0.1,
+    };
+    xqc_netsim_t *sim = xqc_test_netsim_create(1, &conf);
+    const xqc_netsim_link_stats_t *stats = xqc_netsim_link_stats(sim, 0, XQC_NETSIM_UPLINK);
+
+    xqc_test_netsim_send(sim, XQC_TEST_NETSIM_SAMPLES, 100);
+    CU_ASSERT(stats->lost > 9500 && stats->lost < 10500);
+
+    xqc_netsim_run(sim, XQC_MAX_UINT64_VALUE);
+    CU_ASSERT(stats->delivered + stats->lost == XQC_TEST_NETSIM_SAMPLES);
+    xqc_netsim_destroy(sim);
+}
+
+static void
+xqc_test_netsim_burst_loss()
+{
+    xqc_netsim_link_conf_t conf = {
+        .delay = 1000,
+        .ge_p = 0.01,
+        .ge_r = 0.25,
+        .ge_loss_bad = 1.0,
+    };
+    xqc_netsim_t *sim = xqc_test_netsim_create(1, &conf);
+    const xqc_netsim_link_stats_t *stats = xqc_netsim_link_stats(sim, 0, XQC_NETSIM_UPLINK);
+    uint64_t bursts = 0, lost = 0;
+    uint8_t in_burst = 0;
+    double mean;
+
+    for (int i = 0; i < XQC_TEST_NETSIM_SAMPLES; i++) {
+        xqc_test_netsim_send(sim, 1, 100);
+        if (stats->lost > lost) {
+            bursts += in_burst ? 0 : 1;
+            in_burst = 1;
+
+        } else {
+            in_burst = 0;
+        }
+        lost = stats->lost;
+    }
+
+    /* stationary loss rate p / (p + r) */
+    CU_ASSERT(lost > 3300 && lost < 4400);
+
+    /* mean burst length 1 / r */
+    mean = (double)lost / bursts;
+    CU_ASSERT(mean > 3.5 && mean < 4.5);
+    xqc_netsim_destroy(sim);
+}
+
+static void
+xqc_test_netsim_jitter_reorder()
+{
+    xqc_netsim_link_conf_t conf = {
+        .delay = 10000,
+        .jitter = 5000,
+        .reorder = 0.05,
+        .reorder_delay = 2000,
+    };
+    xqc_netsim_t *sim = xqc_test_netsim_create(7, &conf);
+    const xqc_netsim_link_stats_t *stats = xqc_netsim_link_stats(sim, 0, XQC_NETSIM_UPLINK);
+    xqc_usec_t start = xqc_netsim_now(), end[2];
+    uint64_t reordered;
+
+    xqc_test_netsim_send(sim, 1000, 100);
+    CU_ASSERT(stats->reordered > 25 && stats->reordered < 75);
+    reordered = stats->reordered;
+
+    /* delivery is within the jitter, plus the delay of held back datagrams */
+    xqc_netsim_run(sim, start + 9999);
+    CU_ASSERT(stats->delivered == 0);
+    xqc_netsim_run(sim, XQC_MAX_UINT64_VALUE);
+    CU_ASSERT(stats->delivered == 1000);
+    end[0] = xqc_netsim_now();
+    CU_ASSERT(end[0] >= start + 10000 && end[0] <= start + 17000);
+    xqc_netsim_destroy(sim);
+
+    /* the same seed gives the same run, another seed doesn't */
+    sim = xqc_test_netsim_create(7, &conf);
+    stats = xqc_netsim_link_stats(sim, 0, XQC_NETSIM_UPLINK);
+    xqc_test_netsim_send(sim, 1000, 100);
+    xqc_netsim_run(sim, XQC_MAX_UINT64_VALUE);
+    CU_ASSERT(stats->reordered == reordered);
+    CU_ASSERT(xqc_netsim_now() - XQC_NETSIM_EPOCH == end[0] - start);
+    xqc_netsim_destroy(sim);
+
+    sim = xqc_test_netsim_create(8, &conf);
+    stats = xqc_netsim_link_stats(sim, 0, XQC_NETSIM_UPLINK);
+    xqc_test_netsim_send(sim, 1000, 100);
+    end[1] = stats->reordered;
+    CU_ASSERT(end[1] != reordered);
+    xqc_netsim_destroy(sim);
+}
+
+static void
+xqc_test_netsim_routing()
+{
+    xqc_netsim_link_conf_t conf = {
+        .delay = 1000,
+    };
+    xqc_engine_callback_t cb;
+    xqc_transport_callbacks_t tcbs;
+    const struct sockaddr *addr;
+    socklen_t addrlen;
+    xqc_netsim_t *sim = xqc_test_netsim_create(1, &conf);
+
+    CU_ASSERT(xqc_netsim_add_path(sim, &conf, &conf) == 1);
+
+    /* client sends on the path of path_id */
+    memset(&cb, 0, sizeof(cb));
+    memset(&tcbs, 0, sizeof(tcbs));
+    xqc_netsim_engine_callbacks(XQC_NETSIM_CLIENT, &cb, &tcbs);
+    CU_ASSERT(cb.monotonic_ts() == xqc_netsim_now());
+    addr = xqc_netsim_addr(sim, XQC_NETSIM_SERVER, 0, &addrlen);
+    CU_ASSERT(tcbs.write_socket_ex(1, xqc_test_netsim_buf, 100, addr, addrlen, NULL) == 100);
+    CU_ASSERT(tcbs.write_socket_ex(2, xqc_test_netsim_buf, 100, addr, addrlen, NULL)
+              == XQC_SOCKET_ERROR);
+    CU_ASSERT(xqc_netsim_link_stats(sim, 1, XQC_NETSIM_UPLINK)->sent == 1);
+    CU_ASSERT(xqc_netsim_link_stats(sim, 0, XQC_NETSIM_UPLINK)->sent == 0);
+
+    /* server replies on the path of the client address */
+    memset(&tcbs, 0, sizeof(tcbs));
+    xqc_netsim_engine_callbacks(XQC_NETSIM_SERVER, &cb, &tcbs);
+    addr = xqc_netsim_addr(sim, XQC_NETSIM_CLIENT, 1, &addrlen);
+    CU_ASSERT(tcbs.write_socket_ex(0, xqc_test_netsim_buf, 100, addr, addrlen, NULL) == 100);
+    CU_ASSERT(xqc_netsim_link_stats(sim, 1, XQC_NETSIM_DOWNLINK)->sent == 1);
+    CU_ASSERT(xqc_netsim_link_stats(sim, 0, XQC_NETSIM_DOWNLINK)->sent == 0);
+
+    /* timers wake the side up at the requested virtual time */
+    cb.set_event_timer(3000, NULL);
+    CU_ASSERT(xqc_netsim_run(sim, XQC_MAX_UINT64_VALUE) == 0);
+    CU_ASSERT(xqc_netsim_now() == XQC_NETSIM_EPOCH + 3000);
+
+    xqc_netsim_destroy(sim);
+}
+
+void
+xqc_test_netsim()
+{
+    xqc_test_netsim_rate_delay();
+    xqc_test_netsim_queue_limit();
+    xqc_test_netsim_random_loss();
+    xqc_test_netsim_burst_loss();
+    xqc_test_netsim_jitter_reorder();
+    xqc_test_netsim_routing();
+}
@@ -0,0 +1,189 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include <math.h>
+#include "xqc_pacing_test.h"
+#include "src/transport/xqc_pacing.h"
+#include "src/transport/xqc_send_ctl.h"
+#include "src/transport/xqc_conn.h"
+#include "src/transport/xqc_engine.h"
+#include "src/common/xqc_time.h"
+#include "tests/unittest/xqc_common_test.h"
+
+
+#define XQC_TEST_PACING_PKT_SIZE        1200
+#define XQC_TEST_PACING_DURATION        1000000     /* 1s of simulated time */
+#define XQC_TEST_PACING_START_TIME      1000000000
+
+typedef enum {
+    XQC_TEST_PACING_BUDGET,
+    XQC_TEST_PACING_EDT,
+    XQC_TEST_PACING_EDT_TXTIME,
+} xqc_test_pacing_mode_t;
+
+/* virtual clock, pacing is driven by the simulated timer events only */
+static xqc_usec_t xqc_test_pacing_clock;
+static uint32_t xqc_test_pacing_rate;
+
+static xqc_usec_t
+xqc_test_pacing_now()
+{
+    return xqc_test_pacing_clock;
+}
+
+static uint32_t
+xqc_test_pacing_get_rate(void *cong)
+{
+    return xqc_test_pacing_rate;
+}
+
+static ssize_t
+xqc_test_pacing_write_txtime(uint64_t path_id, const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, xqc_usec_t txtime, void *user_data)
+{
+    return size;
+}
+
+typedef struct xqc_test_pacing_result_s {
+    uint64_t    wakeups;
+    uint64_t    pkts;
+    double      avg_err;        /* mean absolute deviation from the ideal departure time, us */
+    double      max_err;
+    double      rate;           /* achieved rate, bytes per second */
+} xqc_test_pacing_result_t;
+
+/*
+ * a backlogged sender on a loopback sink, which records the time each packet leaves the host.
+ * departure is the time of the wakeup which sent the packet, or its release time if the socket
+ * holds packets until then with SO_TXTIME. the ideal departure of k-th packet is
+ * first + k * size / rate.
+ */
+static void
+xqc_test_pacing_run(xqc_log_t *log, xqc_test_pacing_mode_t mode, uint64_t rate_bps,
+    xqc_test_pacing_result_t *res)
+{
+    xqc_connection_t *conn = xqc_calloc(1, sizeof(xqc_connection_t));
+    xqc_send_ctl_t *send_ctl = xqc_calloc(1, sizeof(xqc_send_ctl_t));
+    xqc_cong_ctrl_callback_t cong_cb = {
+        .xqc_cong_ctl_get_pacing_rate = xqc_test_pacing_get_rate,
+    };
+    xqc_timer_manager_t *manager = &send_ctl->path_timer_manager;
+    xqc_pacing_t *pacing = &send_ctl->ctl_pacing;
+    xqc_usec_t now, release, first = 0, departure = 0;
+    xqc_usec_t releases[XQC_MAX_SEND_MSG_ONCE];
+    double ideal, err, sum_err = 0;
+    uint32_t schedule_bytes;
+    int batch;
+
+    memset(res, 0, sizeof(*res));
+    xqc_test_pacing_rate = rate_bps / 8;
+
+    conn->log = log;
+    conn->conn_settings.pacing_mode = mode == XQC_TEST_PACING_BUDGET
+                                      ? XQC_PACING_MODE_BUDGET : XQC_PACING_MODE_EDT;
+    if (mode == XQC_TEST_PACING_EDT_TXTIME) {
+        conn->transport_cbs.write_socket_txtime = xqc_test_pacing_write_txtime;
+    }
+    send_ctl->ctl_conn = conn;
+    send_ctl->ctl_cong_callback = &cong_cb;
+
+    now = XQC_TEST_PACING_START_TIME;
+    xqc_test_pacing_clock = now;
+    xqc_timer_init(manager, log, send_ctl);
+    xqc_pacing_init(pacing, 1, send_ctl);
+
+    while (now < XQC_TEST_PACING_START_TIME + XQC_TEST_PACING_DURATION) {
+        xqc_test_pacing_clock = now;
+        xqc_timer_expire(manager, now);
+        res->wakeups++;
+
+        /* send as many batches as pacer allows */
+        do {
+            batch = 0;
+            schedule_bytes = 0;
+            while (batch < XQC_MAX_SEND_MSG_ONCE) {
+                if (mode == XQC_TEST_PACING_BUDGET) {
+                    if (!xqc_pacing_can_write(pacing, XQC_TEST_PACING_PKT_SIZE)) {
+                        break;
+                    }
+                    xqc_pacing_on_packet_sent(pacing, XQC_TEST_PACING_PKT_SIZE);
+                    release = now;
+
+                } else if (!xqc_pacing_edt_can_write(pacing, schedule_bytes, now, &release)) {
+                    break;
+                }
+
+                releases[batch++] = release;
+                schedule_bytes += XQC_TEST_PACING_PKT_SIZE;
+            }
+
+            for (int i = 0; i < batch; i++) {
+                if (mode != XQC_TEST_PACING_BUDGET) {
+                    xqc_pacing_edt_on_packet_sent(pacing, XQC_TEST_PACING_PKT_SIZE, releases[i]);
+                }
+
+                departure = mode == XQC_TEST_PACING_EDT_TXTIME ? releases[i] : now;
+                if (res->pkts == 0) {
+                    first = departure;
+                }
+
+                ideal = first + res->pkts * (XQC_TEST_PACING_PKT_SIZE * 1000000.0
+                                             / xqc_test_pacing_rate);
+                err = fabs((double)departure - ideal);
+                sum_err += err;
+                res->max_err = xqc_max(res->max_err, err);
+                res->pkts++;
+            }
+        } while (batch == XQC_MAX_SEND_MSG_ONCE);
+
+        CU_ASSERT(xqc_timer_is_set(manager, XQC_TIMER_PACING));
+        if (!xqc_timer_is_set(manager, XQC_TIMER_PACING)) {
+            break;
+        }
+        now = manager->timer[XQC_TIMER_PACING].expire_time;
+    }
+
+    res->avg_err = res->pkts ? sum_err / res->pkts : 0;
+    res->rate = departure > first
+                ? (res->pkts - 1) * XQC_TEST_PACING_PKT_SIZE * 1000000.0 / (departure - first) : 0;
+
+    xqc_free(send_ctl);
+    xqc_free(conn);
+}
+
+void
+xqc_test_pacing_edt(xqc_log_t *log)
+{
+    xqc_test_pacing_result_t res;
+    uint64_t rates[] = {1000000000ULL, 10000000000ULL};
+
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        for (int mode = XQC_TEST_PACING_BUDGET; mode <= XQC_TEST_PACING_EDT_TXTIME; mode++) {
+            xqc_test_pacing_run(log, mode, rates[i], &res);
+            CU_ASSERT(res.pkts > 0);
+
+            if (mode != XQC_TEST_PACING_BUDGET) {
+                /* achieved rate is the pacing rate, and departure never deviates beyond horizon */
+                CU_ASSERT(fabs(res.rate * 8 - rates[i]) < rates[i] / 100);
+                CU_ASSERT(res.max_err <= (mode == XQC_TEST_PACING_EDT_TXTIME
+                                          ? 1 : XQC_PACING_EDT_HORIZON_US + 1));
+            }
+        }
+    }
+}
+
+void
+xqc_test_pacing()
+{
+    xqc_timestamp_pt monotonic_timestamp = xqc_monotonic_timestamp;
+    xqc_engine_t *engine = test_create_engine();
+    CU_ASSERT(engine != NULL);
+
+    xqc_monotonic_timestamp = xqc_test_pacing_now;
+    xqc_test_pacing_edt(engine->log);
+    xqc_monotonic_timestamp = monotonic_timestamp;
+
+    xqc_engine_destroy(engine);
+}
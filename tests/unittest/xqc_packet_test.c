@@ -265,7 +265,7 @@ xqc_test_empty_pkt()
 
     /* server decrypt the Initial pkt */
     ret = xqc_conn_process_packet(svr_tctx.c, cli_tctx.c->enc_pkt,
-                                  cli_tctx.c->enc_pkt_len, xqc_now());
+                                  cli_tctx.c->enc_pkt_len, xqc_now(), XQC_ECN_NOT_ECT);
     CU_ASSERT(svr_tctx.c->conn_err == TRA_PROTOCOL_VIOLATION);
 
 
@@ -0,0 +1,183 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_prague_test.h"
+#include "src/congestion_control/xqc_prague.h"
+#include "src/transport/xqc_packet.h"
+#include "src/transport/xqc_conn.h"
+#include "src/common/xqc_time.h"
+#include "src/common/xqc_malloc.h"
+
+#define XQC_TEST_PRAGUE_RTT     20000
+
+static void
+xqc_test_prague_ack(xqc_prague_t *prague, xqc_usec_t sent_time, xqc_usec_t now)
+{
+    xqc_packet_out_t po;
+
+    xqc_memzero(&po, sizeof(po));
+    po.po_used_size = XQC_MSS;
+    po.po_sent_time = sent_time;
+    xqc_prague_cb.xqc_cong_ctl_on_ack(prague, &po, now);
+}
+
+/* ack a window of packets sent one rtt ago, on a path with srtt of rtt */
+static xqc_usec_t
+xqc_test_prague_round(xqc_prague_t *prague, xqc_usec_t now, xqc_usec_t rtt)
+{
+    uint64_t cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+
+    now += rtt;
+    prague->ctl_ctx->ctl_srtt = rtt;
+    prague->ctl_ctx->ctl_first_rtt_sample_time = now;
+    for (uint64_t acked = 0; acked < cwnd; acked += XQC_MSS) {
+        xqc_test_prague_ack(prague, now - rtt + 1, now);
+    }
+    return now;
+}
+
+static void
+xqc_test_prague_fallback()
+{
+    xqc_send_ctl_t *ctl = xqc_calloc(1, sizeof(xqc_send_ctl_t));
+    xqc_prague_t *prague = xqc_calloc(1, xqc_prague_cb.xqc_cong_ctl_size());
+    xqc_cc_params_t params = {0};
+    xqc_usec_t now = xqc_monotonic_timestamp();
+    uint64_t cwnd;
+
+    xqc_prague_cb.xqc_cong_ctl_init(prague, ctl, params);
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    CU_ASSERT(cwnd > 0 && xqc_prague_cb.xqc_cong_ctl_in_slow_start(prague));
+
+    /* without validated ECN, the window is reduced as cubic */
+    xqc_prague_cb.xqc_cong_ctl_on_lost(prague, now);
+    CU_ASSERT(prague->scalable == 0);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == prague->cubic.cwnd);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) < cwnd
+              && xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) > cwnd / 2);
+
+    /* and taken over when ECN is validated */
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    ctl->ctl_ecn_state = XQC_ECN_STATE_CAPABLE;
+    now += XQC_TEST_PRAGUE_RTT;
+    xqc_test_prague_ack(prague, now - XQC_TEST_PRAGUE_RTT, now);
+    CU_ASSERT(prague->scalable == 1);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == cwnd);
+    CU_ASSERT(!xqc_prague_cb.xqc_cong_ctl_in_slow_start(prague));
+
+    /* the window is handed back to cubic if ECN fails later */
+    xqc_prague_cb.xqc_cong_ctl_on_ecn_ce(prague, now - 1, 1, 1);
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    ctl->ctl_ecn_state = XQC_ECN_STATE_FAILED;
+    now += XQC_TEST_PRAGUE_RTT;
+    xqc_test_prague_ack(prague, now - XQC_TEST_PRAGUE_RTT, now);
+    CU_ASSERT(prague->scalable == 0);
+    CU_ASSERT(prague->cubic.cwnd == cwnd);
+
+    xqc_free(prague);
+    xqc_free(ctl);
+}
+
+static void
+xqc_test_prague_scalable()
+{
+    xqc_connection_t *conn = xqc_calloc(1, sizeof(xqc_connection_t));
+    xqc_send_ctl_t *ctl = xqc_calloc(1, sizeof(xqc_send_ctl_t));
+    xqc_prague_t *prague = xqc_calloc(1, xqc_prague_cb.xqc_cong_ctl_size());
+    xqc_cc_params_t params = {0};
+    xqc_usec_t now = 1000000;
+    uint64_t cwnd, pacing_rate;
+
+    ctl->ctl_conn = conn;
+    ctl->ctl_ecn_state = XQC_ECN_STATE_CAPABLE;
+    xqc_prague_cb.xqc_cong_ctl_init(prague, ctl, params);
+
+    /* slow start grows by acked bytes, and pacing rate doubles the window rate */
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    now = xqc_test_prague_round(prague, now, XQC_TEST_PRAGUE_RTT);
+    CU_ASSERT(prague->scalable == 1);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == cwnd * 2);
+    pacing_rate = xqc_prague_cb.xqc_cong_ctl_get_pacing_rate(prague);
+    CU_ASSERT(pacing_rate == cwnd * 2 * 1000000 / XQC_TEST_PRAGUE_RTT * 2);
+
+    /* the first CE exits slow start, alpha starts from 1 and halves the window */
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    xqc_prague_cb.xqc_cong_ctl_on_ecn_ce(prague, now - 1, 1, 1);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == cwnd - cwnd / 2);
+    CU_ASSERT(!xqc_prague_cb.xqc_cong_ctl_in_slow_start(prague));
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_in_recovery(prague));
+
+    /* at most once per round trip */
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    xqc_prague_cb.xqc_cong_ctl_on_ecn_ce(prague, now - 1, 5, 5);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == cwnd);
+
+    /* no growth for packets sent before the reduction, then 1 MSS per round at the virtual rtt */
+    for (uint64_t acked = 0; acked < cwnd; acked += XQC_MSS) {
+        xqc_test_prague_ack(prague, now - 1, now + 1);
+    }
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == cwnd);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_in_recovery(prague));
+    now = xqc_test_prague_round(prague, now + 1, 25000);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == cwnd + XQC_MSS);
+    CU_ASSERT(!xqc_prague_cb.xqc_cong_ctl_in_recovery(prague));
+
+    /* a short rtt flow grows (R/R_virt)^2 MSS per round */
+    for (int i = 0; i < 8; i++) {
+        now = xqc_test_prague_round(prague, now, 5000);
+    }
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    for (int i = 0; i < 10; i++) {
+        now = xqc_test_prague_round(prague, now, 5000);
+    }
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) <= cwnd + XQC_MSS);
+
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    for (int i = 0; i < 10; i++) {
+        now = xqc_test_prague_round(prague, now, 25000);
+    }
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) >= cwnd + 8 * XQC_MSS);
+
+    /* rounds without CE decay alpha, the next reduction is much smaller than half */
+    for (int i = 0; i < 32; i++) {
+        now = xqc_test_prague_round(prague, now, XQC_TEST_PRAGUE_RTT);
+    }
+    CU_ASSERT(prague->alpha < 256);
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    xqc_prague_cb.xqc_cong_ctl_on_ecn_ce(prague, now - 1, 1, 1);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) < cwnd);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) > cwnd * 7 / 8);
+
+    /* loss is still halving the window */
+    now = xqc_test_prague_round(prague, now, XQC_TEST_PRAGUE_RTT);
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    xqc_prague_cb.xqc_cong_ctl_on_lost(prague, now - 1);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == cwnd - cwnd / 2);
+
+    pacing_rate = xqc_prague_cb.xqc_cong_ctl_get_pacing_rate(prague);
+    CU_ASSERT(pacing_rate > 0 && pacing_rate < cwnd * 1000000 / XQC_TEST_PRAGUE_RTT);
+
+    /* the window is kept after a short pause, and restarts from the initial window after idle */
+    for (int i = 0; i < 8; i++) {
+        now = xqc_test_prague_round(prague, now, XQC_TEST_PRAGUE_RTT);
+    }
+    cwnd = xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague);
+    CU_ASSERT(cwnd > prague->cubic.init_cwnd);
+    xqc_prague_cb.xqc_cong_ctl_restart_from_idle(prague, xqc_monotonic_timestamp());
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == cwnd);
+    xqc_prague_cb.xqc_cong_ctl_restart_from_idle(prague, xqc_monotonic_timestamp() - 1000000);
+    CU_ASSERT(xqc_prague_cb.xqc_cong_ctl_get_cwnd(prague) == prague->cubic.init_cwnd);
+
+    xqc_free(prague);
+    xqc_free(ctl);
+    xqc_free(conn);
+}
+
+void
+xqc_test_prague()
+{
+    xqc_test_prague_fallback();
+    xqc_test_prague_scalable();
+}
@@ -7,6 +7,7 @@
 #include "src/http3/xqc_h3_header.h"
 #include "src/http3/xqc_h3_conn.h"
 #include "src/http3/qpack/xqc_qpack.h"
+#include "src/http3/qpack/xqc_hdr_tmpl.h"
 #include <inttypes.h>
 #include <stdlib.h>
 #include <time.h>
@@ -749,6 +750,327 @@ xqc_test_min_ref()
 
 
 
+#define XQC_TEST_TMPL_BENCH_ROUNDS 20000
+
+static void
+xqc_qpack_test_tmpl_check(xqc_http_headers_t *hdrs_out, xqc_http_header_t *expect, size_t cnt)
+{
+    CU_ASSERT(hdrs_out->count == cnt);
+    for (size_t i = 0; i < cnt && i < hdrs_out->count; i++) {
+        CU_ASSERT(hdrs_out->headers[i].name.iov_len == expect[i].name.iov_len
+                  && memcmp(hdrs_out->headers[i].name.iov_base, expect[i].name.iov_base,
+                            expect[i].name.iov_len) == 0);
+        CU_ASSERT(hdrs_out->headers[i].value.iov_len == expect[i].value.iov_len
+                  && memcmp(hdrs_out->headers[i].value.iov_base, expect[i].value.iov_base,
+                            expect[i].value.iov_len) == 0);
+    }
+}
+
+void
+xqc_qpack_test_tmpl()
+{
+    xqc_int_t ret;
+    ssize_t read;
+    xqc_bool_t blocked = XQC_FALSE;
+    struct timespec ts, te;
+    double full_ns, tmpl_ns;
+
+    xqc_var_buf_t *efs_buf = xqc_var_buf_create(32 * 1024);
+    xqc_var_buf_t *efs_buf_full = xqc_var_buf_create(32 * 1024);
+    xqc_var_buf_t *enc_ins_buf_client = xqc_var_buf_create(16384);
+    xqc_var_buf_t *dec_ins_buf_client = xqc_var_buf_create(16384);
+    xqc_ins_buf_t ins_buf_client = {enc_ins_buf_client, dec_ins_buf_client};
+    xqc_var_buf_t *enc_ins_buf_server = xqc_var_buf_create(16384);
+    xqc_var_buf_t *dec_ins_buf_server = xqc_var_buf_create(16384);
+    xqc_ins_buf_t ins_buf_server = {enc_ins_buf_server, dec_ins_buf_server};
+
+    xqc_http_header_t tmpl_in[] = {
+        {
+            .name   = {.iov_base = "Content-Type", .iov_len = 12},     /* static table, name and value */
+            .value  = {.iov_base = "text/html; charset=utf-8", .iov_len = 24},
+            .flags  = 0,
+        },
+        {
+            .name   = {.iov_base = "server", .iov_len = 6},            /* static table, name only */
+            .value  = {.iov_base = "xquic", .iov_len = 5},
+            .flags  = 0,
+        },
+        {
+            .name   = {.iov_base = "x-tmpl-hdr", .iov_len = 10},       /* literal */
+            .value  = {.iov_base = "template_value", .iov_len = 14},
+            .flags  = 0,
+        },
+        {
+            .name   = {.iov_base = "set-cookie", .iov_len = 10},       /* never indexed */
+            .value  = {.iov_base = "secret", .iov_len = 6},
+            .flags  = XQC_HTTP_HEADER_FLAG_NEVER_INDEX,
+        },
+    };
+    xqc_http_headers_t tmpl_hdrs = {tmpl_in, 4, 4, 0};
+
+    xqc_http_header_t req_in[] = {
+        {
+            .name   = {.iov_base = "content-length", .iov_len = 14},
+            .value  = {.iov_base = "1234", .iov_len = 4},
+            .flags  = 0,
+        },
+        {
+            .name   = {.iov_base = ":status", .iov_len = 7},
+            .value  = {.iov_base = "200", .iov_len = 3},
+            .flags  = 0,
+        },
+    };
+    xqc_http_headers_t req_hdrs = {req_in, 2, 2, 0};
+
+    /* pseudo headers of request, then template, then other headers of request */
+    xqc_http_header_t expect[] = {
+        req_in[1],
+        {
+            .name   = {.iov_base = "content-type", .iov_len = 12},
+            .value  = {.iov_base = "text/html; charset=utf-8", .iov_len = 24},
+            .flags  = 0,
+        },
+        tmpl_in[1], tmpl_in[2], tmpl_in[3], req_in[0],
+    };
+    xqc_http_headers_t expect_hdrs = {expect, 6, 6, 0};
+
+    xqc_http_headers_t hdrs_out;
+    xqc_h3_headers_create_buf(&hdrs_out, XQC_TEST_ENCODER_MAX_HEADERS);
+
+    xqc_engine_t *engine = test_create_engine();
+    CU_ASSERT(engine != NULL);
+
+    xqc_h3_hdr_tmpl_t *tmpl = xqc_h3_hdr_tmpl_create(&tmpl_hdrs);
+    CU_ASSERT(tmpl != NULL && tmpl->count == 4 && tmpl->dtable_cnt == 2);
+    CU_ASSERT(xqc_h3_hdr_tmpl_create(NULL) == NULL);
+
+    xqc_qpack_t *qpk_client = xqc_qpack_create(16384, 16384, engine->log, &ins_cb, &ins_buf_client);
+    xqc_qpack_t *qpk_server = xqc_qpack_create(16384, 16384, engine->log, &ins_cb, &ins_buf_server);
+    CU_ASSERT(qpk_client != NULL && qpk_server != NULL);
+
+    /* without dynamic table, the field section is the same as encoding all headers */
+    ret = xqc_qpack_enc_headers_tmpl(qpk_client, 0, tmpl, &req_hdrs, efs_buf);
+    CU_ASSERT(ret == XQC_OK && enc_ins_buf_client->data_len == 0);
+    ret = xqc_qpack_enc_headers(qpk_client, 4, &expect_hdrs, efs_buf_full);
+    CU_ASSERT(ret == XQC_OK);
+    CU_ASSERT(efs_buf->data_len == efs_buf_full->data_len
+              && memcmp(efs_buf->data, efs_buf_full->data, efs_buf->data_len) == 0);
+
+    void *req_ctx = xqc_qpack_create_req_ctx(0);
+    read = xqc_qpack_dec_headers(qpk_server, req_ctx, efs_buf->data, efs_buf->data_len,
+                                 &hdrs_out, 1, &blocked);
+    CU_ASSERT(read == efs_buf->data_len && blocked == XQC_FALSE);
+    xqc_qpack_test_tmpl_check(&hdrs_out, expect, 6);
+    xqc_qpack_destroy_req_ctx(req_ctx);
+
+    /* template only */
+    xqc_var_buf_clear(efs_buf);
+    xqc_h3_headers_clear(&hdrs_out);
+    ret = xqc_qpack_enc_headers_tmpl(qpk_client, 8, tmpl, NULL, efs_buf);
+    CU_ASSERT(ret == XQC_OK);
+    req_ctx = xqc_qpack_create_req_ctx(8);
+    read = xqc_qpack_dec_headers(qpk_server, req_ctx, efs_buf->data, efs_buf->data_len,
+                                 &hdrs_out, 1, &blocked);
+    CU_ASSERT(read == efs_buf->data_len && blocked == XQC_FALSE);
+    xqc_qpack_test_tmpl_check(&hdrs_out, &expect[1], 4);
+    xqc_qpack_destroy_req_ctx(req_ctx);
+
+    /* compare encoding of all headers with template */
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    for (int r = 0; r < XQC_TEST_TMPL_BENCH_ROUNDS; r++) {
+        xqc_var_buf_clear(efs_buf_full);
+        ret = xqc_qpack_enc_headers(qpk_client, 12, &expect_hdrs, efs_buf_full);
+        CU_ASSERT(ret == XQC_OK);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    full_ns = (te.tv_sec - ts.tv_sec) * 1e9 + (te.tv_nsec - ts.tv_nsec);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    for (int r = 0; r < XQC_TEST_TMPL_BENCH_ROUNDS; r++) {
+        xqc_var_buf_clear(efs_buf);
+        ret = xqc_qpack_enc_headers_tmpl(qpk_client, 12, tmpl, &req_hdrs, efs_buf);
+        CU_ASSERT(ret == XQC_OK);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    tmpl_ns = (te.tv_sec - ts.tv_sec) * 1e9 + (te.tv_nsec - ts.tv_nsec);
+
+    printf("qpack header template|headers:%zu|full:%.0f ns|template:%.0f ns|speedup:%.2fx\n",
+           expect_hdrs.count, full_ns / XQC_TEST_TMPL_BENCH_ROUNDS,
+           tmpl_ns / XQC_TEST_TMPL_BENCH_ROUNDS, full_ns / tmpl_ns);
+
+    /* with dynamic table, the dtable-able lines of template are inserted */
+    ret = xqc_qpack_set_enc_max_dtable_cap(qpk_client, 16 * 1024);
+    CU_ASSERT(ret == XQC_OK);
+    xqc_qpack_set_enc_insert_limit(qpk_client, 0.25, 0.75);
+    ret = xqc_qpack_set_max_blocked_stream(qpk_client, 16);
+    CU_ASSERT(ret == XQC_OK);
+    ret = xqc_qpack_set_dtable_cap(qpk_client, 16384);
+    CU_ASSERT(ret == XQC_OK);
+
+    for (int i = 0; i < 2; i++) {
+        xqc_var_buf_clear(efs_buf);
+        xqc_h3_headers_clear(&hdrs_out);
+        ret = xqc_qpack_enc_headers_tmpl(qpk_client, 16 + i * 4, tmpl, &req_hdrs, efs_buf);
+        CU_ASSERT(ret == XQC_OK);
+        if (i == 0) {
+            CU_ASSERT(enc_ins_buf_client->data_len > 0);
+        }
+
+        read = xqc_qpack_process_encoder(qpk_server, enc_ins_buf_client->data,
+                                         enc_ins_buf_client->data_len);
+        CU_ASSERT(read == enc_ins_buf_client->data_len);
+        xqc_var_buf_clear(enc_ins_buf_client);
+
+        req_ctx = xqc_qpack_create_req_ctx(16 + i * 4);
+        read = xqc_qpack_dec_headers(qpk_server, req_ctx, efs_buf->data, efs_buf->data_len,
+                                     &hdrs_out, 1, &blocked);
+        CU_ASSERT(read == efs_buf->data_len && blocked == XQC_FALSE);
+        xqc_qpack_test_tmpl_check(&hdrs_out, expect, 6);
+        xqc_qpack_destroy_req_ctx(req_ctx);
+    }
+
+    xqc_h3_hdr_tmpl_destroy(tmpl);
+    xqc_h3_headers_free(&hdrs_out);
+    xqc_var_buf_free(efs_buf);
+    xqc_var_buf_free(efs_buf_full);
+    xqc_var_buf_free(enc_ins_buf_client);
+    xqc_var_buf_free(dec_ins_buf_client);
+    xqc_var_buf_free(enc_ins_buf_server);
+    xqc_var_buf_free(dec_ins_buf_server);
+    xqc_qpack_destroy(qpk_client);
+    xqc_qpack_destroy(qpk_server);
+    xqc_engine_destroy(engine);
+}
+
+
+
+#define XQC_TEST_FREQ_REQUESTS      2000
+#define XQC_TEST_FREQ_DTABLE_CAP    1024
+
+/*
+ * replay a corpus of requests through a pair of encoder and decoder with a small dynamic table,
+ * and return the encoded bytes per request, including encoder instructions. each request carries
+ * frequent headers shared by all requests, a few headers shared by requests of the same page,
+ * and headers which are unique to the request.
+ */
+static double
+xqc_qpack_test_freq_replay(xqc_engine_t *engine, uint32_t threshold)
+{
+    xqc_int_t ret;
+    ssize_t read;
+    xqc_bool_t blocked = XQC_FALSE;
+    size_t total = 0;
+    char path[64], reqid[64], etag[64], referer[64];
+
+    xqc_var_buf_t *efs_buf = xqc_var_buf_create(32 * 1024);
+    xqc_var_buf_t *enc_ins_buf_client = xqc_var_buf_create(16384);
+    xqc_var_buf_t *dec_ins_buf_client = xqc_var_buf_create(16384);
+    xqc_ins_buf_t ins_buf_client = {enc_ins_buf_client, dec_ins_buf_client};
+    xqc_var_buf_t *enc_ins_buf_server = xqc_var_buf_create(16384);
+    xqc_var_buf_t *dec_ins_buf_server = xqc_var_buf_create(16384);
+    xqc_ins_buf_t ins_buf_server = {enc_ins_buf_server, dec_ins_buf_server};
+
+    xqc_http_header_t header_in[] = {
+        {.name = {":method", 7}, .value = {"GET", 3}},
+        {.name = {":scheme", 7}, .value = {"https", 5}},
+        {.name = {":authority", 10}, .value = {"api.xquic.test", 14}},
+        {.name = {":path", 5}, .value = {path, 0}},
+        {.name = {"user-agent", 10},
+         .value = {"Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 Chrome/120.0", 64}},
+        {.name = {"accept-language", 15}, .value = {"en-US,en;q=0.9,zh-CN;q=0.8", 26}},
+        {.name = {"cookie", 6}, .value = {"session=5f2b7c1e9a3d4b6f8e0a1c2d3e4f5a6b", 40}},
+        {.name = {"x-client-version", 16}, .value = {"8.4.2-release", 13}},
+        {.name = {"referer", 7}, .value = {referer, 0}},
+        {.name = {"x-request-id", 12}, .value = {reqid, 0}},
+        {.name = {"if-none-match", 13}, .value = {etag, 0}},
+    };
+    xqc_http_headers_t hdrs_in = {header_in, sizeof(header_in) / sizeof(header_in[0]), 0, 0};
+
+    xqc_http_headers_t hdrs_out;
+    xqc_h3_headers_create_buf(&hdrs_out, XQC_TEST_ENCODER_MAX_HEADERS);
+
+    xqc_qpack_t *qpk_client = xqc_qpack_create(16384, 16384, engine->log, &ins_cb, &ins_buf_client);
+    xqc_qpack_t *qpk_server = xqc_qpack_create(16384, 16384, engine->log, &ins_cb, &ins_buf_server);
+    CU_ASSERT(qpk_client != NULL && qpk_server != NULL);
+
+    ret = xqc_qpack_set_enc_insert_threshold(qpk_client, threshold);
+    CU_ASSERT(ret == XQC_OK);
+    ret = xqc_qpack_set_enc_max_dtable_cap(qpk_client, 16384);
+    CU_ASSERT(ret == XQC_OK);
+    ret = xqc_qpack_set_max_blocked_stream(qpk_client, 16);
+    CU_ASSERT(ret == XQC_OK);
+    ret = xqc_qpack_set_dtable_cap(qpk_client, XQC_TEST_FREQ_DTABLE_CAP);
+    CU_ASSERT(ret == XQC_OK);
+
+    for (uint64_t i = 0; i < XQC_TEST_FREQ_REQUESTS; i++) {
+        header_in[3].value.iov_len = sprintf(path, "/api/v1/items/%"PRIu64"?fields=all", i * 7919);
+        header_in[8].value.iov_len = sprintf(referer, "https://www.xquic.test/page/%"PRIu64, i % 5);
+        header_in[9].value.iov_len = sprintf(reqid, "%016"PRIx64,
+                                             (uint64_t)((i + 1) * 0x9e3779b97f4a7c15ULL));
+        header_in[10].value.iov_len = sprintf(etag, "\"%08"PRIx64"\"",
+                                              (uint64_t)((i + 1) * 2654435761ULL));
+
+        xqc_var_buf_clear(efs_buf);
+        ret = xqc_qpack_enc_headers(qpk_client, i * 4, &hdrs_in, efs_buf);
+        CU_ASSERT(ret == XQC_OK);
+        total += efs_buf->data_len + enc_ins_buf_client->data_len;
+
+        /* deliver encoder instructions before the field section, decoder is never blocked */
+        read = xqc_qpack_process_encoder(qpk_server, enc_ins_buf_client->data,
+                                         enc_ins_buf_client->data_len);
+        CU_ASSERT(read == enc_ins_buf_client->data_len);
+        xqc_var_buf_clear(enc_ins_buf_client);
+
+        xqc_h3_headers_clear(&hdrs_out);
+        void *req_ctx = xqc_qpack_create_req_ctx(i * 4);
+        read = xqc_qpack_dec_headers(qpk_server, req_ctx, efs_buf->data, efs_buf->data_len,
+                                     &hdrs_out, 1, &blocked);
+        CU_ASSERT(read == efs_buf->data_len && blocked == XQC_FALSE);
+        xqc_qpack_test_tmpl_check(&hdrs_out, header_in, hdrs_in.count);
+        xqc_qpack_destroy_req_ctx(req_ctx);
+
+        /* section acknowledgement */
+        read = xqc_qpack_process_decoder(qpk_client, dec_ins_buf_server->data,
+                                         dec_ins_buf_server->data_len);
+        CU_ASSERT(read == dec_ins_buf_server->data_len);
+        xqc_var_buf_clear(dec_ins_buf_server);
+    }
+
+    xqc_h3_headers_free(&hdrs_out);
+    xqc_var_buf_free(efs_buf);
+    xqc_var_buf_free(enc_ins_buf_client);
+    xqc_var_buf_free(dec_ins_buf_client);
+    xqc_var_buf_free(enc_ins_buf_server);
+    xqc_var_buf_free(dec_ins_buf_server);
+    xqc_qpack_destroy(qpk_client);
+    xqc_qpack_destroy(qpk_server);
+
+    return (double)total / XQC_TEST_FREQ_REQUESTS;
+}
+
+void
+xqc_qpack_test_insert_threshold()
+{
+    double bytes[4];
+    uint32_t thresholds[] = {0, 2, 3, 4};
+
+    xqc_engine_t *engine = test_create_engine();
+    CU_ASSERT(engine != NULL);
+
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = xqc_qpack_test_freq_replay(engine, thresholds[i]);
+        printf("qpack insert threshold:%u|bytes per request:%.1f|saving:%.1f%%\n",
+               thresholds[i], bytes[i], (bytes[0] - bytes[i]) * 100 / bytes[0]);
+    }
+
+    /* headers seen once no longer evict the frequent ones */
+    CU_ASSERT(bytes[1] < bytes[0]);
+
+    xqc_engine_destroy(engine);
+}
+
+
+
 void
 xqc_qpack_test()
 {
@@ -756,4 +1078,6 @@ xqc_qpack_test()
     xqc_qpack_test_duplicate();
     xqc_qpack_test_robust();
     xqc_test_min_ref();
+    xqc_qpack_test_tmpl();
+    xqc_qpack_test_insert_threshold();
 }
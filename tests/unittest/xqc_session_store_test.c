@@ -0,0 +1,133 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include "xqc_session_store_test.h"
+#include "src/tls/xqc_session_store.h"
+
+#define XQC_TEST_KEY_A "a.test.com|h3"
+#define XQC_TEST_KEY_B "b.test.com|h3"
+#define XQC_TEST_KEY_C "c.test.com|h3"
+
+
+void
+xqc_test_session_store()
+{
+    char buf[64], ticket[16];
+    size_t len;
+    xqc_session_lru_stats_t stats;
+    const xqc_session_store_callbacks_t *cbs = xqc_session_lru_callbacks();
+
+    /* one shard with 2 entries, to make eviction predictable */
+    xqc_session_lru_t *lru = xqc_session_lru_create(1, 2);
+    CU_ASSERT(lru != NULL);
+
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 0);
+
+    /* ticket and transport parameters are kept separately */
+    CU_ASSERT(cbs->put(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                       "ticket_a", 8) == XQC_OK);
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 8 && memcmp(buf, "ticket_a", 8) == 0);
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TP,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 0);
+
+    /* a ticket is handed out only once */
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 0);
+
+    /* while transport parameters are reused */
+    CU_ASSERT(cbs->put(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TP,
+                       "tp_a", 4) == XQC_OK);
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TP,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 4 && memcmp(buf, "tp_a", 4) == 0);
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TP,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 4 && memcmp(buf, "tp_a", 4) == 0);
+
+    /* several tickets are kept, the newest is handed out first */
+    CU_ASSERT(cbs->put(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                       "ticket_a2", 9) == XQC_OK);
+    CU_ASSERT(cbs->put(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                       "ticket_a3", 9) == XQC_OK);
+
+    /* buffer not enough, and the ticket is not taken away */
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                   buf, 4);
+    CU_ASSERT(len == 0);
+
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 9 && memcmp(buf, "ticket_a3", 9) == 0);
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 9 && memcmp(buf, "ticket_a2", 9) == 0);
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 0);
+
+    /* the oldest ticket is dropped if there is no room */
+    for (int i = 0; i <= XQC_SESSION_LRU_TICKET_NUM; i++) {
+        snprintf(ticket, sizeof(ticket), "ticket_%d", i);
+        CU_ASSERT(cbs->put(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                           ticket, strlen(ticket)) == XQC_OK);
+    }
+    for (int i = XQC_SESSION_LRU_TICKET_NUM; i > 0; i--) {
+        snprintf(ticket, sizeof(ticket), "ticket_%d", i);
+        len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                       buf, sizeof(buf));
+        CU_ASSERT(len == strlen(ticket) && memcmp(buf, ticket, len) == 0);
+    }
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 0);
+
+    /* B is the least recently used one after A is looked up, and evicted by C */
+    CU_ASSERT(cbs->put(lru, XQC_TEST_KEY_B, strlen(XQC_TEST_KEY_B), XQC_SESSION_DATA_TICKET,
+                       "ticket_b", 8) == XQC_OK);
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TP,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 4);
+    CU_ASSERT(cbs->put(lru, XQC_TEST_KEY_C, strlen(XQC_TEST_KEY_C), XQC_SESSION_DATA_TICKET,
+                       "ticket_c", 8) == XQC_OK);
+
+    len = cbs->get(lru, XQC_TEST_KEY_B, strlen(XQC_TEST_KEY_B), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 0);
+    len = cbs->get(lru, XQC_TEST_KEY_A, strlen(XQC_TEST_KEY_A), XQC_SESSION_DATA_TP,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 4);
+    len = cbs->get(lru, XQC_TEST_KEY_C, strlen(XQC_TEST_KEY_C), XQC_SESSION_DATA_TICKET,
+                   buf, sizeof(buf));
+    CU_ASSERT(len == 8 && memcmp(buf, "ticket_c", 8) == 0);
+
+    xqc_session_lru_get_stats(lru, &stats);
+    CU_ASSERT(stats.count == 2);
+    CU_ASSERT(stats.inserts == 3);
+    CU_ASSERT(stats.evictions == 1);
+    CU_ASSERT(stats.lookups == 19);
+    CU_ASSERT(stats.hits == 12);
+
+    xqc_session_lru_destroy(lru);
+
+    /* entries are spread over shards */
+    lru = xqc_session_lru_create(3, 64);
+    CU_ASSERT(lru != NULL);
+    for (int i = 0; i < 32; i++) {
+        snprintf(buf, sizeof(buf), "%d.test.com|h3", i);
+        CU_ASSERT(cbs->put(lru, buf, strlen(buf), XQC_SESSION_DATA_TICKET, "t", 1) == XQC_OK);
+    }
+
+    xqc_session_lru_get_stats(lru, &stats);
+    CU_ASSERT(stats.inserts == 32);
+    CU_ASSERT(stats.count + stats.evictions == 32);
+
+    xqc_session_lru_destroy(lru);
+}
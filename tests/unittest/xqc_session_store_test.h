@@ -0,0 +1,10 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef XQC_SESSION_STORE_TEST_H
+#define XQC_SESSION_STORE_TEST_H
+
+void xqc_test_session_store();
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <CUnit/CUnit.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "xqc_shard_test.h"
+#include "src/transport/xqc_shard.h"
+#include "src/transport/xqc_engine.h"
+#include "src/transport/xqc_cid.h"
+#include "src/transport/xqc_quic_lb.h"
+#include "tests/unittest/xqc_common_test.h"
+
+
+static uint8_t xqc_test_shard_key[XQC_LB_CID_KEY_LEN] = {
+    0x8f, 0x95, 0xf0, 0x92, 0x45, 0x76, 0x5f, 0x80,
+    0x25, 0x69, 0x34, 0xe5, 0x0c, 0x66, 0x20, 0x7f
+};
+
+/* build a short header packet with dcid */
+static size_t
+xqc_test_shard_short_pkt(uint8_t *pkt, const uint8_t *dcid, size_t dcid_len)
+{
+    pkt[0] = 0x40;
+    memcpy(pkt + 1, dcid, dcid_len);
+    memset(pkt + 1 + dcid_len, 0xab, 32);
+    return 1 + dcid_len + 32;
+}
+
+/* build a long header Initial packet with dcid */
+static size_t
+xqc_test_shard_long_pkt(uint8_t *pkt, const uint8_t *dcid, size_t dcid_len)
+{
+    pkt[0] = 0xc0;
+    pkt[1] = 0x00;
+    pkt[2] = 0x00;
+    pkt[3] = 0x00;
+    pkt[4] = 0x01;
+    pkt[5] = dcid_len;
+    memcpy(pkt + 6, dcid, dcid_len);
+    memset(pkt + 6 + dcid_len, 0xcd, 64);
+    return 6 + dcid_len + 64;
+}
+
+void
+xqc_test_spsc_queue()
+{
+    xqc_spsc_queue_t *q = xqc_spsc_queue_create(5, sizeof(uint32_t));
+    CU_ASSERT(q != NULL);
+    CU_ASSERT(xqc_spsc_queue_capacity(q) == 8);
+    CU_ASSERT(xqc_spsc_queue_front(q) == NULL);
+
+    /* wrap around several times */
+    uint32_t in = 0, out = 0;
+    for (int round = 0; round < 5; round++) {
+        uint32_t *e;
+        while ((e = xqc_spsc_queue_reserve(q)) != NULL) {
+            *e = in++;
+            xqc_spsc_queue_commit(q);
+        }
+        CU_ASSERT(xqc_spsc_queue_size(q) == 8);
+
+        for (int i = 0; i < 5; i++) {
+            e = xqc_spsc_queue_front(q);
+            CU_ASSERT(e != NULL && *e == out);
+            out++;
+            xqc_spsc_queue_pop(q);
+        }
+        CU_ASSERT(xqc_spsc_queue_size(q) == 3);
+    }
+
+    xqc_spsc_queue_destroy(q);
+}
+
+void
+xqc_test_shard_route()
+{
+    xqc_engine_t *engine = test_create_engine_server();
+    CU_ASSERT(engine != NULL);
+
+    uint8_t pkt[XQC_MAX_PACKET_IN_LEN];
+    uint8_t cid[XQC_MAX_CID_LEN], enc[XQC_MAX_CID_LEN];
+    size_t len;
+
+    xqc_shard_config_t config = {
+        .shard_count = 4,
+        .conf_id = 0x5a,
+        .cid_len = engine->config->cid_len,
+    };
+
+    /* illegal configs */
+    xqc_shard_config_t bad = config;
+    bad.shard_count = 0;
+    CU_ASSERT(xqc_shard_dispatcher_create(&bad) == NULL);
+    bad = config;
+    bad.lb_cid_enc_on = 1;
+    CU_ASSERT(xqc_shard_dispatcher_create(&bad) == NULL);
+    bad = config;
+    bad.shard_count = 1000;
+    bad.cid_len = 2;
+    CU_ASSERT(xqc_shard_dispatcher_create(&bad) == NULL);
+
+    xqc_shard_dispatcher_t *d = xqc_shard_dispatcher_create(&config);
+    CU_ASSERT(d != NULL);
+    CU_ASSERT(xqc_shard_dispatcher_bind_engine(d, 4, engine) == -XQC_EPARAM);
+    CU_ASSERT(xqc_shard_dispatcher_bind_engine(d, 2, engine) == XQC_OK);
+
+    /* cids generated by a bound engine are routed back to its shard */
+    for (int i = 0; i < 16; i++) {
+        xqc_cid_t scid;
+        CU_ASSERT(xqc_generate_cid(engine, NULL, &scid, i) == XQC_OK);
+        CU_ASSERT(scid.cid_buf[0] == 0x5a && scid.cid_buf[1] == 2);
+
+        len = xqc_test_shard_short_pkt(pkt, scid.cid_buf, scid.cid_len);
+        CU_ASSERT(xqc_shard_get_shard_id(d, pkt, len) == 2);
+
+        len = xqc_test_shard_long_pkt(pkt, scid.cid_buf, scid.cid_len);
+        CU_ASSERT(xqc_shard_get_shard_id(d, pkt, len) == 2);
+    }
+
+    /* client chosen dcids are routed by hash, deterministically */
+    for (int i = 0; i < 64; i++) {
+        memset(cid, i, sizeof(cid));
+        cid[0] = 0x11;
+        len = xqc_test_shard_long_pkt(pkt, cid, 16);
+        xqc_int_t sid = xqc_shard_get_shard_id(d, pkt, len);
+        CU_ASSERT(sid >= 0 && sid < 4);
+        CU_ASSERT(xqc_shard_get_shard_id(d, pkt, len) == sid);
+    }
+
+    /* shard id out of range falls back to hash */
+    memset(cid, 0, sizeof(cid));
+    cid[0] = 0x5a;
+    cid[1] = 9;
+    len = xqc_test_shard_short_pkt(pkt, cid, config.cid_len);
+    CU_ASSERT(xqc_shard_get_shard_id(d, pkt, len) >= 0);
+    CU_ASSERT(xqc_shard_get_shard_id(d, pkt, len) < 4);
+
+    /* truncated packets */
+    CU_ASSERT(xqc_shard_get_shard_id(d, pkt, 0) == -XQC_EPARAM);
+    CU_ASSERT(xqc_shard_get_shard_id(d, pkt, config.cid_len) == -XQC_EPARAM);
+    len = xqc_test_shard_long_pkt(pkt, cid, 8);
+    CU_ASSERT(xqc_shard_get_shard_id(d, pkt, 10) == -XQC_EPARAM);
+    pkt[5] = XQC_MAX_CID_LEN + 1;
+    CU_ASSERT(xqc_shard_get_shard_id(d, pkt, len) == -XQC_EPARAM);
+
+    /* dispatch copies datagram and address into the queue of shard */
+    struct sockaddr_in peer = {.sin_family = AF_INET, .sin_port = htons(4433)};
+    cid[1] = 3;
+    len = xqc_test_shard_short_pkt(pkt, cid, config.cid_len);
+    CU_ASSERT(xqc_shard_dispatch(d, pkt, len, NULL, 0, (struct sockaddr *)&peer,
+                                 sizeof(peer), 100) == 3);
+    xqc_shard_packet_t *qp = xqc_spsc_queue_front(d->shards[3].queue);
+    CU_ASSERT(qp != NULL && qp->len == len && memcmp(qp->buf, pkt, len) == 0);
+    CU_ASSERT(qp != NULL && qp->peer_addrlen == sizeof(peer) && qp->recv_time == 100);
+    CU_ASSERT(xqc_shard_process(d, 3, 0) == -XQC_EPARAM);
+    CU_ASSERT(xqc_shard_dispatch(d, pkt, XQC_MAX_PACKET_IN_LEN + 1, NULL, 0, NULL, 0, 0)
+              == -XQC_EPARAM);
+
+    /* datagrams of shard 2 are fed into the bound engine */
+    cid[1] = 2;
+    len = xqc_test_shard_short_pkt(pkt, cid, config.cid_len);
+    for (int i = 0; i < 3; i++) {
+        CU_ASSERT(xqc_shard_dispatch(d, pkt, len, NULL, 0, (struct sockaddr *)&peer,
+                                     sizeof(peer), 0) == 2);
+    }
+    CU_ASSERT(xqc_shard_process(d, 2, 2) == 2);
+    CU_ASSERT(xqc_shard_process(d, 2, 0) == 1);
+    CU_ASSERT(xqc_shard_process(d, 2, 0) == 0);
+
+    xqc_engine_destroy(engine);
+    xqc_shard_dispatcher_destroy(d);
+
+    /* encrypted shard id, single-pass only */
+    engine = test_create_engine_server();
+    config.cid_len = XQC_FIRST_OCTET + XQC_EN_SINGLE_PASS_ENCRYPTION_LEN;
+    config.lb_cid_enc_on = 1;
+    memcpy(config.lb_cid_key, xqc_test_shard_key, XQC_LB_CID_KEY_LEN);
+    d = xqc_shard_dispatcher_create(&config);
+    CU_ASSERT(d != NULL);
+
+    for (int s = 0; s < 4; s++) {
+        memset(cid, 0x77, sizeof(cid));
+        cid[0] = 0x5a;
+        cid[1] = s;
+        CU_ASSERT(xqc_lb_cid_encryption(cid, config.cid_len - 1, enc, sizeof(enc),
+                                        xqc_test_shard_key, XQC_LB_CID_KEY_LEN, engine) == XQC_OK);
+        enc[0] = cid[0];
+        len = xqc_test_shard_short_pkt(pkt, enc, config.cid_len);
+        CU_ASSERT(xqc_shard_get_shard_id(d, pkt, len) == s);
+
+        /* the cipher context of dispatcher is reused by the next datagram */
+        CU_ASSERT(xqc_shard_get_shard_id(d, pkt, len) == s);
+    }
+
+    xqc_engine_destroy(engine);
+    xqc_shard_dispatcher_destroy(d);
+}
+
+void
+xqc_test_shard()
+{
+    xqc_test_spsc_queue();
+    xqc_test_shard_route();
+}
@@ -0,0 +1,10 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef XQC_SHARD_TEST_H
+#define XQC_SHARD_TEST_H
+
+void xqc_test_shard();
+
+#endif
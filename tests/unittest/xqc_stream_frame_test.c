@@ -8,6 +8,7 @@
 #include "src/transport/xqc_engine.h"
 #include "src/transport/xqc_frame.h"
 #include "src/transport/xqc_stream.h"
+#include "src/transport/xqc_send_queue.h"
 #include "xqc_common_test.h"
 
 void
@@ -78,4 +79,113 @@ xqc_test_stream_frame()
     }
 
     xqc_engine_destroy(conn->engine);
-}
\ No newline at end of file
+}
+
+#define XQC_TEST_SCHED_STREAMS  6
+
+static xqc_stream_t *g_sched_order[XQC_TEST_SCHED_STREAMS];
+static int g_sched_cnt;
+static xqc_stream_t *g_sched_fill_at;
+
+static xqc_int_t
+xqc_test_sched_write_notify(xqc_stream_t *stream, void *user_data)
+{
+    if (g_sched_cnt < XQC_TEST_SCHED_STREAMS) {
+        g_sched_order[g_sched_cnt] = stream;
+    }
+    g_sched_cnt++;
+
+    /* the stream takes all the room of the send queue */
+    if (stream == g_sched_fill_at) {
+        stream->stream_conn->conn_send_queue->sndq_packets_used =
+            stream->stream_conn->conn_send_queue->sndq_packets_used_max;
+    }
+    return XQC_OK;
+}
+
+static void
+xqc_test_sched_run(xqc_connection_t *conn)
+{
+    g_sched_cnt = 0;
+    xqc_memzero(g_sched_order, sizeof(g_sched_order));
+    xqc_process_write_streams(conn);
+}
+
+void
+xqc_test_stream_write_schedule()
+{
+    static xqc_stream_callbacks_t cbs = {
+        .stream_write_notify = xqc_test_sched_write_notify,
+    };
+    /* urgency and incremental flag of streams, in the order they are created */
+    static const uint8_t prio[XQC_TEST_SCHED_STREAMS][2] = {
+        {3, 0}, {1, 1}, {1, 0}, {3, 1}, {1, 1}, {0, 0},
+    };
+    xqc_stream_t *s[XQC_TEST_SCHED_STREAMS], *u;
+    uint32_t used;
+    int i;
+
+    xqc_connection_t *conn = test_engine_connect();
+    CU_ASSERT_FATAL(conn != NULL);
+
+    for (i = 0; i < XQC_TEST_SCHED_STREAMS; i++) {
+        s[i] = xqc_stream_create_with_direction(conn, XQC_STREAM_BIDI, NULL);
+        CU_ASSERT_FATAL(s[i] != NULL);
+        s[i]->stream_if = &cbs;
+        xqc_stream_set_urgency(s[i], prio[i][0], prio[i][1]);
+        xqc_stream_ready_to_write(s[i]);
+    }
+    used = conn->conn_send_queue->sndq_packets_used;
+
+    /*
+     * most urgent bucket first. inside a bucket, non-incremental streams go first in stream id
+     * order, then incremental streams in round-robin order
+     */
+    xqc_test_sched_run(conn);
+    CU_ASSERT(g_sched_cnt == 6);
+    CU_ASSERT(g_sched_order[0] == s[5]);
+    CU_ASSERT(g_sched_order[1] == s[2]);
+    CU_ASSERT(g_sched_order[2] == s[1]);
+    CU_ASSERT(g_sched_order[3] == s[4]);
+    CU_ASSERT(g_sched_order[4] == s[0]);
+    CU_ASSERT(g_sched_order[5] == s[3]);
+
+    /* incremental streams of urgency 1 take turns */
+    xqc_test_sched_run(conn);
+    CU_ASSERT(g_sched_cnt == 6);
+    CU_ASSERT(g_sched_order[1] == s[2]);
+    CU_ASSERT(g_sched_order[2] == s[4]);
+    CU_ASSERT(g_sched_order[3] == s[1]);
+
+    /* less urgent streams are not notified once the send queue is full */
+    g_sched_fill_at = s[2];
+    xqc_test_sched_run(conn);
+    CU_ASSERT(g_sched_cnt == 2);
+    CU_ASSERT(g_sched_order[0] == s[5]);
+    CU_ASSERT(g_sched_order[1] == s[2]);
+    g_sched_fill_at = NULL;
+    conn->conn_send_queue->sndq_packets_used = used;
+
+    /* a stream moves to the bucket of its new urgency, ahead of later non-incremental streams */
+    xqc_stream_set_urgency(s[0], 0, 0);
+    xqc_test_sched_run(conn);
+    CU_ASSERT(g_sched_cnt == 6);
+    CU_ASSERT(g_sched_order[0] == s[0]);
+    CU_ASSERT(g_sched_order[1] == s[5]);
+    CU_ASSERT(g_sched_order[5] == s[3]);
+
+    /* unidirectional streams are served before requests of any urgency */
+    u = xqc_stream_create_with_direction(conn, XQC_STREAM_UNI, NULL);
+    CU_ASSERT_FATAL(u != NULL);
+    u->stream_if = &cbs;
+    xqc_stream_ready_to_write(u);
+    CU_ASSERT(u->stream_urgency == XQC_HIGHEST_HTTP_PRIORITY_URGENCY);
+    g_sched_fill_at = u;
+    xqc_test_sched_run(conn);
+    CU_ASSERT(g_sched_cnt == 1);
+    CU_ASSERT(g_sched_order[0] == u);
+    g_sched_fill_at = NULL;
+    conn->conn_send_queue->sndq_packets_used = used;
+
+    xqc_engine_destroy(conn->engine);
+}
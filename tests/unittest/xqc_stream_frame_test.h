@@ -6,5 +6,6 @@
 #define _XQC_STREAM_FRAME_TEST_H_INCLUDED_
 
 void  xqc_test_stream_frame();
+void  xqc_test_stream_write_schedule();
 
 #endif /* _XQC_STREAM_FRAME_TEST_H_INCLUDED_ */
@@ -349,6 +349,58 @@ xqc_test_create_server_tls_ctx()
     ctx_svr = ctx;
 }
 
+void
+xqc_test_tls_ctx_rotate_session_ticket_key()
+{
+    xqc_int_t ret;
+    xqc_bool_t is_current;
+    xqc_ssl_session_ticket_key_t *key = NULL;
+    char key_data[48];
+    uint8_t first_name[16];
+
+    def_engine_ssl_config_svr;
+    xqc_tls_ctx_t *ctx = xqc_tls_ctx_create(XQC_TLS_TYPE_SERVER, &engine_ssl_config_svr,
+                                            &tls_test_cbs, test_log);
+    CU_ASSERT(ctx != NULL);
+    memcpy(first_name, XQC_TEST_SESSION_TICKET_KEY, 16);
+
+    xqc_tls_ctx_find_session_ticket_key(ctx, first_name, &key, &is_current);
+    CU_ASSERT(key != NULL && is_current);
+
+    /* client and invalid key are refused */
+    ret = xqc_tls_ctx_rotate_session_ticket_key(ctx_cli, XQC_TEST_SESSION_TICKET_KEY, 48);
+    CU_ASSERT(ret != XQC_OK);
+    ret = xqc_tls_ctx_rotate_session_ticket_key(ctx, "test_stk", 8);
+    CU_ASSERT(ret != XQC_OK);
+
+    /* new key is current, the first one is still found */
+    memset(key_data, 1, sizeof(key_data));
+    ret = xqc_tls_ctx_rotate_session_ticket_key(ctx, key_data, sizeof(key_data));
+    CU_ASSERT(ret == XQC_OK);
+
+    xqc_tls_ctx_get_session_ticket_key(ctx, &key);
+    CU_ASSERT(key->size == 48 && memcmp(key->name, key_data, 16) == 0);
+
+    xqc_tls_ctx_find_session_ticket_key(ctx, first_name, &key, &is_current);
+    CU_ASSERT(key != NULL && !is_current);
+
+    /* the first one is dropped after XQC_SESSION_TICKET_KEY_MAX - 1 more rotations */
+    for (int i = 2; i < XQC_SESSION_TICKET_KEY_MAX + 1; i++) {
+        memset(key_data, i, sizeof(key_data));
+        ret = xqc_tls_ctx_rotate_session_ticket_key(ctx, key_data, sizeof(key_data));
+        CU_ASSERT(ret == XQC_OK);
+    }
+
+    xqc_tls_ctx_find_session_ticket_key(ctx, first_name, &key, &is_current);
+    CU_ASSERT(key == NULL);
+
+    memset(first_name, 2, sizeof(first_name));
+    xqc_tls_ctx_find_session_ticket_key(ctx, first_name, &key, &is_current);
+    CU_ASSERT(key != NULL && !is_current);
+
+    xqc_tls_ctx_destroy(ctx);
+}
+
 #define TEST_ALPN_1 "transport"
 #define TEST_ALPN_2 "h3"
 
@@ -890,6 +942,7 @@ xqc_test_tls()
     xqc_test_create_client_tls_ctx();
     xqc_test_create_server_tls_ctx();
     xqc_test_tls_ctx_register_alpn();
+    xqc_test_tls_ctx_rotate_session_ticket_key();
     xqc_test_tls_reset_initial();
     
     xqc_test_tls_multiple_crypto_data();
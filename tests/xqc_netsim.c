@@ -0,0 +1,584 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "xqc_netsim.h"
+#include "src/common/xqc_priority_q.h"
+#include "src/common/xqc_malloc.h"
+#include "src/common/xqc_time.h"
+#include "src/common/xqc_config.h"
+
+#ifndef XQC_SYS_WINDOWS
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+/*
+ * datagrams of a link are ordered by delivery time, with the sequence of writes in the low bits
+ * of the key to keep datagrams delivered at the same time in order
+ */
+#define XQC_NETSIM_SEQ_BITS         24
+#define XQC_NETSIM_SEQ_MASK         ((1ULL << XQC_NETSIM_SEQ_BITS) - 1)
+#define XQC_NETSIM_NO_EVENT         XQC_MAX_UINT64_VALUE
+
+#define XQC_NETSIM_SERVER_PORT      4433
+#define XQC_NETSIM_CLIENT_PORT      50000
+
+
+typedef struct xqc_netsim_pkt_s {
+    xqc_usec_t                  deliver_time;
+    size_t                      len;
+    unsigned char               buf[];
+} xqc_netsim_pkt_t;
+
+typedef struct xqc_netsim_pq_elem_s {
+    xqc_pq_key_t                key;
+    xqc_netsim_pkt_t           *pkt;
+} xqc_netsim_pq_elem_t;
+
+typedef struct xqc_netsim_link_s {
+    xqc_netsim_link_conf_t      conf;
+    xqc_netsim_link_stats_t     stats;
+    xqc_pq_t                    pkts;
+
+    uint64_t                    rng;
+    uint8_t                     ge_bad;         /* Gilbert-Elliott in bad state */
+    xqc_usec_t                  busy_until;     /* end of serialization of the last datagram */
+    xqc_usec_t                  last_deliver;   /* keeps jitter from reordering datagrams */
+} xqc_netsim_link_t;
+
+typedef struct xqc_netsim_path_s {
+    struct sockaddr_in          cli_addr;
+    xqc_netsim_link_t           links[2];       /* indexed by xqc_netsim_dir_t */
+} xqc_netsim_path_t;
+
+typedef struct xqc_netsim_endpoint_s {
+    xqc_engine_t               *engine;
+    void                       *user_data;
+    xqc_usec_t                  wake_time;      /* timer set by engine, 0 if none */
+    xqc_usec_t                  cpu_time;       /* wall-clock time spent in the engine */
+} xqc_netsim_endpoint_t;
+
+struct xqc_netsim_s {
+    xqc_usec_t                  now;
+    uint64_t                    seed;
+    uint64_t                    seq;
+    uint8_t                     stop;
+
+    struct sockaddr_in          svr_addr;
+    xqc_netsim_path_t           paths[XQC_NETSIM_MAX_PATHS];
+    int                         path_cnt;
+    xqc_netsim_endpoint_t       eps[XQC_NETSIM_SIDE_NUM];
+};
+
+/* the timestamp functions of xquic are process-wide, so is the emulator */
+static xqc_netsim_t *xqc_netsim_active = NULL;
+
+
+/* splitmix64, fast and good enough for loss decisions, and stable across platforms */
+static uint64_t
+xqc_netsim_rand(xqc_netsim_link_t *link)
+{
+    uint64_t z = (link->rng += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static xqc_usec_t
+xqc_netsim_wall_time()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (xqc_usec_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/* uniform in [0, 1) */
+static double
+xqc_netsim_rand_real(xqc_netsim_link_t *link)
+{
+    return (xqc_netsim_rand(link) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void
+xqc_netsim_addr_init(struct sockaddr_in *addr, uint32_t ip, uint16_t port)
+{
+    memset(addr, 0, sizeof(struct sockaddr_in));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+    addr->sin_addr.s_addr = htonl(ip);
+}
+
+static int
+xqc_netsim_find_path(xqc_netsim_t *sim, const struct sockaddr *peer_addr, socklen_t peer_addrlen)
+{
+    const struct sockaddr_in *addr = (const struct sockaddr_in *)peer_addr;
+
+    if (peer_addr == NULL || peer_addrlen < sizeof(struct sockaddr_in)
+        || peer_addr->sa_family != AF_INET)
+    {
+        return -XQC_EPARAM;
+    }
+
+    for (int i = 0; i < sim->path_cnt; i++) {
+        if (sim->paths[i].cli_addr.sin_port == addr->sin_port
+            && sim->paths[i].cli_addr.sin_addr.s_addr == addr->sin_addr.s_addr)
+        {
+            return i;
+        }
+    }
+
+    return -XQC_EPARAM;
+}
+
+
+xqc_netsim_t *
+xqc_netsim_create(uint64_t seed)
+{
+    xqc_netsim_t *sim;
+
+    if (xqc_netsim_active != NULL) {
+        return NULL;
+    }
+
+    sim = xqc_calloc(1, sizeof(xqc_netsim_t));
+    if (sim == NULL) {
+        return NULL;
+    }
+
+    sim->now = XQC_NETSIM_EPOCH;
+    sim->seed = seed;
+    xqc_netsim_addr_init(&sim->svr_addr, 0x0a000001, XQC_NETSIM_SERVER_PORT);
+
+    xqc_netsim_active = sim;
+    return sim;
+}
+
+void
+xqc_netsim_destroy(xqc_netsim_t *sim)
+{
+    xqc_netsim_pq_elem_t *e;
+
+    for (int i = 0; i < sim->path_cnt; i++) {
+        for (int dir = XQC_NETSIM_UPLINK; dir <= XQC_NETSIM_DOWNLINK; dir++) {
+            xqc_pq_t *pq = &sim->paths[i].links[dir].pkts;
+            while (!xqc_pq_empty(pq)) {
+                e = (xqc_netsim_pq_elem_t *)xqc_pq_top(pq);
+                xqc_free(e->pkt);
+                xqc_pq_pop(pq);
+            }
+            xqc_pq_destroy(pq);
+        }
+    }
+
+    if (xqc_netsim_active == sim) {
+        xqc_netsim_active = NULL;
+    }
+    xqc_free(sim);
+}
+
+int
+xqc_netsim_add_path(xqc_netsim_t *sim, const xqc_netsim_link_conf_t *up,
+    const xqc_netsim_link_conf_t *down)
+{
+    xqc_netsim_path_t *path;
+    xqc_netsim_link_t *link;
+    int idx = sim->path_cnt;
+
+    if (idx >= XQC_NETSIM_MAX_PATHS) {
+        return -XQC_ELIMIT;
+    }
+
+    path = &sim->paths[idx];
+    memset(path, 0, sizeof(xqc_netsim_path_t));
+
+    /* client is on a different network of each path, as an interface of a multihomed host */
+    xqc_netsim_addr_init(&path->cli_addr, 0x0a000102 + (idx << 8), XQC_NETSIM_CLIENT_PORT + idx);
+
+    for (int dir = XQC_NETSIM_UPLINK; dir <= XQC_NETSIM_DOWNLINK; dir++) {
+        link = &path->links[dir];
+        link->conf = dir == XQC_NETSIM_UPLINK ? *up : *down;
+        link->rng = sim->seed ^ ((uint64_t)(idx * 2 + dir + 1) * 0xd1b54a32d192ed03ULL);
+        if (xqc_pq_init(&link->pkts, sizeof(xqc_netsim_pq_elem_t), xqc_pq_default_capacity,
+                        xqc_default_allocator, xqc_pq_revert_cmp, NULL) != 0)
+        {
+            if (dir == XQC_NETSIM_DOWNLINK) {
+                xqc_pq_destroy(&path->links[XQC_NETSIM_UPLINK].pkts);
+            }
+            return -XQC_EMALLOC;
+        }
+    }
+
+    sim->path_cnt++;
+    return idx;
+}
+
+int
+xqc_netsim_set_link(xqc_netsim_t *sim, int path, xqc_netsim_dir_t dir,
+    const xqc_netsim_link_conf_t *conf)
+{
+    if (path < 0 || path >= sim->path_cnt) {
+        return -XQC_EPARAM;
+    }
+
+    sim->paths[path].links[dir].conf = *conf;
+    return XQC_OK;
+}
+
+const xqc_netsim_link_stats_t *
+xqc_netsim_link_stats(xqc_netsim_t *sim, int path, xqc_netsim_dir_t dir)
+{
+    if (path < 0 || path >= sim->path_cnt) {
+        return NULL;
+    }
+
+    return &sim->paths[path].links[dir].stats;
+}
+
+const struct sockaddr *
+xqc_netsim_addr(xqc_netsim_t *sim, xqc_netsim_side_t side, int path, socklen_t *addrlen)
+{
+    *addrlen = sizeof(struct sockaddr_in);
+    if (side == XQC_NETSIM_SERVER) {
+        return (const struct sockaddr *)&sim->svr_addr;
+    }
+
+    if (path < 0 || path >= sim->path_cnt) {
+        return NULL;
+    }
+    return (const struct sockaddr *)&sim->paths[path].cli_addr;
+}
+
+xqc_usec_t
+xqc_netsim_cpu_time(xqc_netsim_t *sim, xqc_netsim_side_t side)
+{
+    return sim->eps[side].cpu_time;
+}
+
+void
+xqc_netsim_set_engine(xqc_netsim_t *sim, xqc_netsim_side_t side, xqc_engine_t *engine,
+    void *user_data)
+{
+    sim->eps[side].engine = engine;
+    sim->eps[side].user_data = user_data;
+}
+
+
+/* decide whether the datagram is lost before entering the link */
+static int
+xqc_netsim_lose(xqc_netsim_link_t *link)
+{
+    xqc_netsim_link_conf_t *conf = &link->conf;
+    double loss = conf->loss;
+
+    if (conf->ge_p > 0) {
+        if (link->ge_bad) {
+            link->ge_bad = xqc_netsim_rand_real(link) >= conf->ge_r;
+
+        } else {
+            link->ge_bad = xqc_netsim_rand_real(link) < conf->ge_p;
+        }
+
+        if (link->ge_bad) {
+            loss = conf->ge_loss_bad;
+        }
+    }
+
+    return loss > 0 && xqc_netsim_rand_real(link) < loss;
+}
+
+ssize_t
+xqc_netsim_send(xqc_netsim_t *sim, xqc_netsim_side_t side, int path,
+    const unsigned char *buf, size_t size)
+{
+    xqc_netsim_link_t *link;
+    xqc_netsim_link_conf_t *conf;
+    xqc_netsim_pkt_t *pkt;
+    xqc_usec_t start, qdelay, deliver;
+    xqc_pq_key_t key;
+
+    if (path < 0 || path >= sim->path_cnt) {
+        return XQC_SOCKET_ERROR;
+    }
+
+    link = &sim->paths[path].links[side == XQC_NETSIM_CLIENT
+                                   ? XQC_NETSIM_UPLINK : XQC_NETSIM_DOWNLINK];
+    conf = &link->conf;
+    link->stats.sent++;
+
+    if (xqc_netsim_lose(link)) {
+        link->stats.lost++;
+        return size;
+    }
+
+    /* serialization at the bottleneck, behind the datagrams waiting in the buffer */
+    start = xqc_max(sim->now, link->busy_until);
+    qdelay = start - sim->now;
+    if (conf->rate > 0) {
+        if (conf->queue_limit > 0
+            && qdelay * conf->rate / 8000000 + size > conf->queue_limit)
+        {
+            link->stats.queue_dropped++;
+            return size;
+        }
+
+        link->busy_until = start + (size * 8 * 1000000 + conf->rate - 1) / conf->rate;
+        link->stats.max_queue_delay = xqc_max(link->stats.max_queue_delay, qdelay);
+
+    } else {
+        link->busy_until = start;
+    }
+
+    deliver = link->busy_until + conf->delay;
+    if (conf->jitter > 0) {
+        deliver += xqc_netsim_rand(link) % (conf->jitter + 1);
+    }
+
+    if (conf->reorder > 0 && xqc_netsim_rand_real(link) < conf->reorder) {
+        deliver = xqc_max(deliver, link->last_deliver) + conf->reorder_delay;
+        link->stats.reordered++;
+
+    } else {
+        deliver = xqc_max(deliver, link->last_deliver);
+        link->last_deliver = deliver;
+    }
+
+    pkt = xqc_malloc(sizeof(xqc_netsim_pkt_t) + size);
+    if (pkt == NULL) {
+        return XQC_SOCKET_ERROR;
+    }
+    pkt->deliver_time = deliver;
+    pkt->len = size;
+    memcpy(pkt->buf, buf, size);
+
+    key = ((deliver - XQC_NETSIM_EPOCH) << XQC_NETSIM_SEQ_BITS) | (sim->seq++ & XQC_NETSIM_SEQ_MASK);
+    if (xqc_pq_push(&link->pkts, key, &pkt) == NULL) {
+        xqc_free(pkt);
+        return XQC_SOCKET_ERROR;
+    }
+
+    return size;
+}
+
+
+static xqc_usec_t
+xqc_netsim_link_next(xqc_netsim_link_t *link)
+{
+    xqc_netsim_pq_elem_t *e;
+
+    if (xqc_pq_empty(&link->pkts)) {
+        return XQC_NETSIM_NO_EVENT;
+    }
+
+    e = (xqc_netsim_pq_elem_t *)xqc_pq_top(&link->pkts);
+    return e->pkt->deliver_time;
+}
+
+static xqc_usec_t
+xqc_netsim_next_event(xqc_netsim_t *sim)
+{
+    xqc_usec_t next = XQC_NETSIM_NO_EVENT;
+
+    for (int i = 0; i < sim->path_cnt; i++) {
+        next = xqc_min(next, xqc_netsim_link_next(&sim->paths[i].links[XQC_NETSIM_UPLINK]));
+        next = xqc_min(next, xqc_netsim_link_next(&sim->paths[i].links[XQC_NETSIM_DOWNLINK]));
+    }
+
+    for (int side = 0; side < XQC_NETSIM_SIDE_NUM; side++) {
+        if (sim->eps[side].wake_time != 0) {
+            next = xqc_min(next, sim->eps[side].wake_time);
+        }
+    }
+
+    return next;
+}
+
+/* deliver datagrams arrived at the side */
+static void
+xqc_netsim_deliver(xqc_netsim_t *sim, xqc_netsim_side_t side)
+{
+    xqc_netsim_endpoint_t *ep = &sim->eps[side];
+    xqc_netsim_path_t *path;
+    xqc_netsim_link_t *link;
+    xqc_netsim_pq_elem_t *e;
+    xqc_netsim_pkt_t *pkt;
+    const struct sockaddr *local, *peer;
+    xqc_usec_t begin = xqc_netsim_wall_time();
+    int cnt = 0;
+
+    for (int i = 0; i < sim->path_cnt; i++) {
+        path = &sim->paths[i];
+        link = &path->links[side == XQC_NETSIM_SERVER ? XQC_NETSIM_UPLINK : XQC_NETSIM_DOWNLINK];
+        local = (const struct sockaddr *)(side == XQC_NETSIM_SERVER
+                                          ? &sim->svr_addr : &path->cli_addr);
+        peer = (const struct sockaddr *)(side == XQC_NETSIM_SERVER
+                                         ? &path->cli_addr : &sim->svr_addr);
+
+        while (xqc_netsim_link_next(link) <= sim->now) {
+            e = (xqc_netsim_pq_elem_t *)xqc_pq_top(&link->pkts);
+            pkt = e->pkt;
+            xqc_pq_pop(&link->pkts);
+
+            link->stats.delivered++;
+            link->stats.delivered_bytes += pkt->len;
+            if (ep->engine != NULL) {
+                xqc_engine_packet_process(ep->engine, pkt->buf, pkt->len,
+                                          local, sizeof(struct sockaddr_in),
+                                          peer, sizeof(struct sockaddr_in),
+                                          sim->now, ep->user_data);
+                cnt++;
+            }
+            xqc_free(pkt);
+        }
+    }
+
+    if (cnt > 0) {
+        xqc_engine_finish_recv(ep->engine);
+        ep->cpu_time += xqc_netsim_wall_time() - begin;
+    }
+}
+
+static void
+xqc_netsim_run_timer(xqc_netsim_t *sim, xqc_netsim_side_t side)
+{
+    xqc_netsim_endpoint_t *ep = &sim->eps[side];
+    xqc_usec_t begin;
+
+    if (ep->wake_time == 0 || ep->wake_time > sim->now) {
+        return;
+    }
+
+    ep->wake_time = 0;
+    if (ep->engine != NULL) {
+        begin = xqc_netsim_wall_time();
+        xqc_engine_main_logic(ep->engine);
+        ep->cpu_time += xqc_netsim_wall_time() - begin;
+    }
+}
+
+int
+xqc_netsim_run(xqc_netsim_t *sim, xqc_usec_t deadline)
+{
+    xqc_usec_t next;
+
+    sim->stop = 0;
+    while (!sim->stop) {
+        next = xqc_netsim_next_event(sim);
+        if (next == XQC_NETSIM_NO_EVENT) {
+            return 0;
+        }
+
+        if (next > deadline) {
+            sim->now = xqc_max(sim->now, deadline);
+            return 0;
+        }
+
+        /* engines take no virtual time, all events due are processed at the same instant */
+        sim->now = xqc_max(sim->now, next);
+        xqc_netsim_deliver(sim, XQC_NETSIM_SERVER);
+        xqc_netsim_deliver(sim, XQC_NETSIM_CLIENT);
+        xqc_netsim_run_timer(sim, XQC_NETSIM_SERVER);
+        xqc_netsim_run_timer(sim, XQC_NETSIM_CLIENT);
+    }
+
+    return 1;
+}
+
+void
+xqc_netsim_stop(xqc_netsim_t *sim)
+{
+    sim->stop = 1;
+}
+
+xqc_usec_t
+xqc_netsim_now(void)
+{
+    return xqc_netsim_active != NULL ? xqc_netsim_active->now : xqc_netsim_wall_time();
+}
+
+
+static void
+xqc_netsim_cli_set_event_timer(xqc_usec_t wake_after, void *user_data)
+{
+    if (xqc_netsim_active != NULL) {
+        xqc_netsim_active->eps[XQC_NETSIM_CLIENT].wake_time = xqc_netsim_active->now + wake_after;
+    }
+}
+
+static void
+xqc_netsim_svr_set_event_timer(xqc_usec_t wake_after, void *user_data)
+{
+    if (xqc_netsim_active != NULL) {
+        xqc_netsim_active->eps[XQC_NETSIM_SERVER].wake_time = xqc_netsim_active->now + wake_after;
+    }
+}
+
+static ssize_t
+xqc_netsim_cli_write_socket(const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, void *user_data)
+{
+    if (xqc_netsim_active == NULL) {
+        return XQC_SOCKET_ERROR;
+    }
+    return xqc_netsim_send(xqc_netsim_active, XQC_NETSIM_CLIENT, 0, buf, size);
+}
+
+static ssize_t
+xqc_netsim_cli_write_socket_ex(uint64_t path_id, const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, void *user_data)
+{
+    if (xqc_netsim_active == NULL || path_id >= XQC_NETSIM_MAX_PATHS) {
+        return XQC_SOCKET_ERROR;
+    }
+    return xqc_netsim_send(xqc_netsim_active, XQC_NETSIM_CLIENT, (int)path_id, buf, size);
+}
+
+static ssize_t
+xqc_netsim_svr_write_socket(const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, void *user_data)
+{
+    if (xqc_netsim_active == NULL) {
+        return XQC_SOCKET_ERROR;
+    }
+    return xqc_netsim_send(xqc_netsim_active, XQC_NETSIM_SERVER,
+                           xqc_netsim_find_path(xqc_netsim_active, peer_addr, peer_addrlen),
+                           buf, size);
+}
+
+static ssize_t
+xqc_netsim_svr_write_socket_ex(uint64_t path_id, const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen, void *user_data)
+{
+    /* path ids of server are not known to the emulator, route by the address of client */
+    return xqc_netsim_svr_write_socket(buf, size, peer_addr, peer_addrlen, user_data);
+}
+
+static ssize_t
+xqc_netsim_svr_stateless_reset(const unsigned char *buf, size_t size,
+    const struct sockaddr *peer_addr, socklen_t peer_addrlen,
+    const struct sockaddr *local_addr, socklen_t local_addrlen, void *user_data)
+{
+    return xqc_netsim_svr_write_socket(buf, size, peer_addr, peer_addrlen, user_data);
+}
+
+void
+xqc_netsim_engine_callbacks(xqc_netsim_side_t side, xqc_engine_callback_t *cb,
+    xqc_transport_callbacks_t *tcbs)
+{
+    cb->realtime_ts = xqc_netsim_now;
+    cb->monotonic_ts = xqc_netsim_now;
+
+    if (side == XQC_NETSIM_CLIENT) {
+        cb->set_event_timer = xqc_netsim_cli_set_event_timer;
+        tcbs->write_socket = xqc_netsim_cli_write_socket;
+        tcbs->write_socket_ex = xqc_netsim_cli_write_socket_ex;
+
+    } else {
+        cb->set_event_timer = xqc_netsim_svr_set_event_timer;
+        tcbs->write_socket = xqc_netsim_svr_write_socket;
+        tcbs->write_socket_ex = xqc_netsim_svr_write_socket_ex;
+        tcbs->stateless_reset = xqc_netsim_svr_stateless_reset;
+    }
+}
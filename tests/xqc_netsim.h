@@ -0,0 +1,144 @@
+/**
+ * @copyright Copyright (c) 2022, Alibaba Group Holding Limited
+ */
+
+#ifndef _XQC_NETSIM_H_INCLUDED_
+#define _XQC_NETSIM_H_INCLUDED_
+
+#include <xquic/xquic.h>
+#include <xquic/xquic_typedef.h>
+
+/*
+ * deterministic network emulator for in-process performance tests. a client engine and a
+ * server engine exchange datagrams through emulated links in memory, driven by a virtual clock
+ * which jumps from one event to the next, so a run takes only the cpu time of the engines and
+ * gives the same result for the same seed, regardless of machine load.
+ *
+ * a path is a pair of links, uplink from client to server and downlink back. each link is a
+ * drop-tail bottleneck of the given rate and buffer, followed by a propagation delay with
+ * optional jitter. datagrams may be lost at random or in bursts of a Gilbert-Elliott model
+ * before entering the buffer, and may be held back to be overtaken by later ones.
+ *
+ * the virtual clock replaces the timestamp functions of xquic, which are process-wide, hence
+ * only one emulator may exist at a time, and engines must be created after it. engines get the
+ * callbacks of the emulator with xqc_netsim_engine_callbacks, and their user_data of
+ * set_event_timer is not used by the emulator. clients send on the path of the same index as
+ * path_id, servers reply on the path of the peer address.
+ */
+
+#define XQC_NETSIM_MAX_PATHS        8
+
+/* the virtual clock starts at a fixed epoch, as realtime timestamps are also emulated */
+#define XQC_NETSIM_EPOCH            1600000000000000ULL
+
+typedef struct xqc_netsim_s xqc_netsim_t;
+
+typedef enum xqc_netsim_side_e {
+    XQC_NETSIM_CLIENT,
+    XQC_NETSIM_SERVER,
+    XQC_NETSIM_SIDE_NUM,
+} xqc_netsim_side_t;
+
+typedef enum xqc_netsim_dir_e {
+    XQC_NETSIM_UPLINK,              /* client to server */
+    XQC_NETSIM_DOWNLINK,            /* server to client */
+} xqc_netsim_dir_t;
+
+typedef struct xqc_netsim_link_conf_s {
+    uint64_t        rate;           /* bottleneck rate in bits per second, 0 for unlimited */
+    xqc_usec_t      delay;          /* one-way propagation delay */
+    xqc_usec_t      jitter;         /* extra delay drawn from [0, jitter], order is kept */
+    size_t          queue_limit;    /* drop-tail buffer in bytes, 0 for unlimited */
+
+    double          loss;           /* random loss rate, in good state of Gilbert-Elliott */
+
+    /* Gilbert-Elliott burst loss, enabled if ge_p is not 0 */
+    double          ge_p;           /* probability of good to bad state per datagram */
+    double          ge_r;           /* probability of bad to good state per datagram */
+    double          ge_loss_bad;    /* loss rate in bad state */
+
+    double          reorder;        /* probability of holding back a datagram */
+    xqc_usec_t      reorder_delay;  /* extra delay of datagrams held back */
+} xqc_netsim_link_conf_t;
+
+typedef struct xqc_netsim_link_stats_s {
+    uint64_t        sent;           /* datagrams written to the link */
+    uint64_t        delivered;
+    uint64_t        delivered_bytes;
+    uint64_t        lost;           /* random and burst loss */
+    uint64_t        queue_dropped;  /* dropped by the full buffer */
+    uint64_t        reordered;
+    xqc_usec_t      max_queue_delay;
+} xqc_netsim_link_stats_t;
+
+
+/**
+ * @brief create the emulator, there must be no other emulator alive
+ * @param seed seed of random loss, jitter and reordering
+ */
+xqc_netsim_t *xqc_netsim_create(uint64_t seed);
+
+void xqc_netsim_destroy(xqc_netsim_t *sim);
+
+/**
+ * @brief add a path with the given uplink and downlink
+ * @return index of the path, which is the path_id of client, or negative for error
+ */
+int xqc_netsim_add_path(xqc_netsim_t *sim, const xqc_netsim_link_conf_t *up,
+    const xqc_netsim_link_conf_t *down);
+
+/**
+ * @brief change the conditions of a link, datagrams already in flight are not affected
+ */
+int xqc_netsim_set_link(xqc_netsim_t *sim, int path, xqc_netsim_dir_t dir,
+    const xqc_netsim_link_conf_t *conf);
+
+const xqc_netsim_link_stats_t *xqc_netsim_link_stats(xqc_netsim_t *sim, int path,
+    xqc_netsim_dir_t dir);
+
+/**
+ * @brief address of an endpoint on a path, the server has the same address on all paths
+ */
+const struct sockaddr *xqc_netsim_addr(xqc_netsim_t *sim, xqc_netsim_side_t side, int path,
+    socklen_t *addrlen);
+
+/**
+ * @brief fill the timer, timestamp and socket callbacks of an engine of the given side
+ */
+void xqc_netsim_engine_callbacks(xqc_netsim_side_t side, xqc_engine_callback_t *cb,
+    xqc_transport_callbacks_t *tcbs);
+
+/**
+ * @brief attach an engine, which gets datagrams and timers of the side
+ * @param user_data the user_data parameter of xqc_engine_packet_process
+ */
+void xqc_netsim_set_engine(xqc_netsim_t *sim, xqc_netsim_side_t side, xqc_engine_t *engine,
+    void *user_data);
+
+/**
+ * @brief wall-clock time spent in the engine of the side, which is the cpu cost of a run as
+ * the emulator never sleeps
+ */
+xqc_usec_t xqc_netsim_cpu_time(xqc_netsim_t *sim, xqc_netsim_side_t side);
+
+/**
+ * @brief write a datagram to a path from the given side, as the socket callbacks do. datagrams
+ * to a side without an engine are dropped on arrival after being counted as delivered
+ */
+ssize_t xqc_netsim_send(xqc_netsim_t *sim, xqc_netsim_side_t side, int path,
+    const unsigned char *buf, size_t size);
+
+/**
+ * @brief run events until xqc_netsim_stop is called, there is no event left, or the virtual
+ * clock reaches the deadline
+ * @return 1 if stopped, 0 otherwise
+ */
+int xqc_netsim_run(xqc_netsim_t *sim, xqc_usec_t deadline);
+
+/* make xqc_netsim_run return after the current event, usually called from engine callbacks */
+void xqc_netsim_stop(xqc_netsim_t *sim);
+
+/* virtual time of the emulator alive, or wall-clock time if there is none */
+xqc_usec_t xqc_netsim_now(void);
+
+#endif /* _XQC_NETSIM_H_INCLUDED_ */